@@ -13,6 +13,7 @@
 #include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "iothubtransportmqtt.h"
 
 #ifdef MBED_BUILD_TIMESTAMP
@@ -32,6 +33,9 @@ static bool g_continueRunning;
 
 #define MESSAGE_COUNT 0 // Number of telemetry messages to send before exiting, or 0 to keep sending forever
 #define DOWORK_LOOP_NUM     3
+#define SEND_INTERVAL_MS    5000 // Time between two telemetry messages
+#define MAX_SLEEP_MS        1000 // Longest sleep, so cloud-to-device messages are not read too late
+#define ERROR_SLEEP_MS      1    // Sleep after a failed DoWork, so the loop does not spin
 
 
 typedef struct EVENT_INSTANCE_TAG
@@ -126,6 +130,7 @@ void iothub_client_sample_mqtt_run(void)
 {
 	printf("\nFile:%s Compile Time:%s %s\n",__FILE__,__DATE__,__TIME__);
     IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle;
+    TICK_COUNTER_HANDLE tickCounter;
     // bool traceOn = true;
     // IoTHubClient_LL_SetOption(iotHubClientHandle, "logtrace", &traceOn);
 
@@ -168,16 +173,29 @@ void iothub_client_sample_mqtt_run(void)
             {
                 (void)printf("ERROR: IoTHubClient_LL_SetMessageCallback..........FAILED!\r\n");
             }
+            else if ((tickCounter = tickcounter_create()) == NULL)
+            {
+                (void)printf("ERROR: tickcounter_create..........FAILED!\r\n");
+            }
             else
             {
                 (void)printf("IoTHubClient_LL_SetMessageCallback...successful.\r\n");
 
                 /* Now that we are ready to receive commands, let's send some messages */
                 size_t iterator = 0;
+                tickcounter_ms_t now_ms = 0;
+                tickcounter_ms_t next_send_ms = 0;
+                IOTHUB_CLIENT_DOWORK_BUDGET budget = { 100, 1024 }; // wait at most 100 ms for data, read at most 1 KB per call
 
                 do
                 {
-                    if ((!MESSAGE_COUNT || (iterator < MESSAGE_COUNT)) && (iterator<= callbackCounter))
+                    if (tickcounter_get_current_ms(tickCounter, &now_ms) != 0)
+                    {
+                        (void)printf("ERROR: tickcounter_get_current_ms..........FAILED!\r\n");
+                        now_ms = next_send_ms;
+                    }
+
+                    if (now_ms >= next_send_ms && (!MESSAGE_COUNT || (iterator < MESSAGE_COUNT)) && (iterator<= callbackCounter))
                     {
                         (void)printf("MESSAGE_COUNT...successful.\r\n");
                         EVENT_INSTANCE *thisMessage = &messages[MESSAGE_COUNT ? iterator : 0];
@@ -207,12 +225,25 @@ void iothub_client_sample_mqtt_run(void)
                             }
                         }
                         iterator++;
+                        next_send_ms = now_ms + SEND_INTERVAL_MS;
+                    }
+
+                    uint32_t next_call_in_ms;
+                    if (IoTHubClient_LL_DoWorkWithBudget(iotHubClientHandle, &budget, &next_call_in_ms) != IOTHUB_CLIENT_OK)
+                    {
+                        next_call_in_ms = ERROR_SLEEP_MS;
+                    }
+
+                    // Sleep until the client or the next message needs the CPU, counting the time DoWork took
+                    uint32_t sleep_ms = next_call_in_ms < MAX_SLEEP_MS ? next_call_in_ms : MAX_SLEEP_MS;
+                    if (tickcounter_get_current_ms(tickCounter, &now_ms) == 0 && next_send_ms > now_ms && sleep_ms > next_send_ms - now_ms)
+                    {
+                        sleep_ms = (uint32_t)(next_send_ms - now_ms);
+                    }
+                    if (sleep_ms > 0)
+                    {
+                        ThreadAPI_Sleep(sleep_ms);
                     }
-                    (void)printf("IoTHubClient_LL_DoWork excute.\r\n");
-                    IoTHubClient_LL_DoWork(iotHubClientHandle);
-                    (void)printf("IoTHubClient_LL_DoWork excute end.\r\n");
-                    (void)printf("Sleeping for 5\n");
-                    ThreadAPI_Sleep(5000);
 
                     // if (callbackCounter>=MESSAGE_COUNT){
                     //     printf("done sending...\n");
@@ -227,6 +258,7 @@ void iothub_client_sample_mqtt_run(void)
                     IoTHubClient_LL_DoWork(iotHubClientHandle);
                     ThreadAPI_Sleep(1);
                 }
+                tickcounter_destroy(tickCounter);
             }
             IoTHubClient_LL_Destroy(iotHubClientHandle);
         }
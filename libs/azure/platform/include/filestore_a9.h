@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef FILESTORE_A9_H
+#define FILESTORE_A9_H
+
+#include "azure_c_shared_utility/filestore.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+MOCKABLE_FUNCTION(, const FILE_STORE_INTERFACE_DESCRIPTION*, filestore_a9_get_interface_description);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILESTORE_A9_H */
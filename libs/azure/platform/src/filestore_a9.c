@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdint.h>
+#include <api_fs.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "filestore_a9.h"
+
+typedef struct FILE_STORE_INSTANCE_TAG {
+    int32_t fd;
+} FILE_STORE_INSTANCE;
+
+static FILE_STORE_HANDLE filestore_a9_open(const char *path)
+{
+    FILE_STORE_INSTANCE *result = (FILE_STORE_INSTANCE *)malloc(sizeof(FILE_STORE_INSTANCE));
+    if (result == NULL) {
+        LogError("Failure allocating the file instance");
+    } else if ((result->fd = API_FS_Open(path, FS_O_RDWR | FS_O_CREAT, 0)) < 0) {
+        LogError("Failure opening %s: %d", path, (int)result->fd);
+        free(result);
+        result = NULL;
+    }
+    return result;
+}
+
+static void filestore_a9_close(FILE_STORE_HANDLE file)
+{
+    if (file != NULL) {
+        (void)API_FS_Close(((FILE_STORE_INSTANCE *)file)->fd);
+        free(file);
+    }
+}
+
+static int filestore_a9_read(FILE_STORE_HANDLE file, uint32_t offset, unsigned char *buffer, size_t size, size_t *bytes_read)
+{
+    int result;
+    int32_t fd = ((FILE_STORE_INSTANCE *)file)->fd;
+    int64_t file_size;
+    int32_t read_result;
+
+    if ((file_size = API_FS_GetFileSize(fd)) < 0) {
+        LogError("Failure getting the file size: %d", (int)file_size);
+        result = __FAILURE__;
+    } else if ((int64_t)offset >= file_size) {
+        /* past the end of the file */
+        *bytes_read = 0;
+        result = 0;
+    } else if (API_FS_Seek(fd, (int64_t)offset, FS_SEEK_SET) != (int64_t)offset) {
+        LogError("Failure seeking to %lu", (unsigned long)offset);
+        result = __FAILURE__;
+    } else if ((read_result = API_FS_Read(fd, buffer, (uint32_t)size)) < 0) {
+        LogError("Failure reading %lu bytes at %lu", (unsigned long)size, (unsigned long)offset);
+        result = __FAILURE__;
+    } else {
+        *bytes_read = (size_t)read_result;
+        result = 0;
+    }
+    return result;
+}
+
+static int filestore_a9_write(FILE_STORE_HANDLE file, uint32_t offset, const unsigned char *buffer, size_t size)
+{
+    int result;
+    int32_t fd = ((FILE_STORE_INSTANCE *)file)->fd;
+
+    if (API_FS_Seek(fd, (int64_t)offset, FS_SEEK_SET) != (int64_t)offset) {
+        LogError("Failure seeking to %lu", (unsigned long)offset);
+        result = __FAILURE__;
+    } else if (API_FS_Write(fd, (uint8_t *)buffer, (uint32_t)size) != (int32_t)size) {
+        LogError("Failure writing %lu bytes at %lu", (unsigned long)size, (unsigned long)offset);
+        result = __FAILURE__;
+    } else {
+        result = 0;
+    }
+    return result;
+}
+
+static int filestore_a9_flush(FILE_STORE_HANDLE file)
+{
+    return (API_FS_Flush(((FILE_STORE_INSTANCE *)file)->fd) == 0) ? 0 : __FAILURE__;
+}
+
+static bool filestore_a9_exists(const char *path)
+{
+    bool result;
+    int32_t fd = API_FS_Open(path, FS_O_RDONLY, 0);
+    if (fd < 0) {
+        result = false;
+    } else {
+        (void)API_FS_Close(fd);
+        result = true;
+    }
+    return result;
+}
+
+static int filestore_a9_remove(const char *path)
+{
+    return (API_FS_Delete(path) < 0) ? __FAILURE__ : 0;
+}
+
+static int filestore_a9_rename(const char *old_path, const char *new_path)
+{
+    return (API_FS_Rename(old_path, new_path) < 0) ? __FAILURE__ : 0;
+}
+
+static const FILE_STORE_INTERFACE_DESCRIPTION filestore_a9_interface_description = {
+    filestore_a9_open,
+    filestore_a9_close,
+    filestore_a9_read,
+    filestore_a9_write,
+    filestore_a9_flush,
+    filestore_a9_exists,
+    filestore_a9_remove,
+    filestore_a9_rename
+};
+
+const FILE_STORE_INTERFACE_DESCRIPTION *filestore_a9_get_interface_description(void)
+{
+    return &filestore_a9_interface_description;
+}
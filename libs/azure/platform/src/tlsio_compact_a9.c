@@ -8,6 +8,7 @@
 #include "api_socket.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "socket_async.h"
@@ -30,6 +31,11 @@
 // The TLSIO_RECEIVE_BUFFER_SIZE has very little effect on performance, and is kept small
 // to minimize memory consumption.
 #define RECEIVE_BUFFER_SIZE    128
+// How long tlsio_ssl_dowork waits for the first bytes unless OPTION_RECEIVE_TIMEOUT_MS is set
+#define DEFAULT_RECEIVE_TIMEOUT_MS  5000
+// Room for the host name whose address is kept, and for a dotted IPv4 address
+#define MAX_CACHED_HOSTNAME_LENGTH  128
+#define IP_ADDRESS_SIZE             16
 
 #define CallErrorCallback() do { if (tls_io_instance->on_io_error != NULL) (void)tls_io_instance->on_io_error(tls_io_instance->on_io_error_context); } while((void)0,0)
 #define CallOpenCallback(status) do { if (tls_io_instance->on_io_open_complete != NULL) (void)tls_io_instance->on_io_open_complete(tls_io_instance->on_io_open_complete_context, status); } while((void)0,0)
@@ -69,8 +75,44 @@ typedef struct TLS_IO_INSTANCE_TAG
     TLSIO_STATE tlsio_state;
     int countTry;
     TLSIO_OPTIONS options;
+    unsigned int receive_timeout_ms;
+    size_t receive_budget;
 } TLS_IO_INSTANCE;
 
+// The address the host name resolved to last time. A reconnect creates a new tlsio, so this is
+// kept outside of the instance; it lets a reconnect skip the DNS round trip over the radio.
+static char cached_hostname[MAX_CACHED_HOSTNAME_LENGTH];
+static char cached_ip[IP_ADDRESS_SIZE];
+
+static const char* tlsio_ssl_get_server(const char* hostname)
+{
+    const char* result;
+    if (cached_ip[0] != '\0' && strcmp(cached_hostname, hostname) == 0)
+    {
+        result = cached_ip;
+    }
+    else
+    {
+        uint8_t ip[IP_ADDRESS_SIZE];
+        memset(ip, 0, sizeof(ip));
+        cached_ip[0] = '\0';
+        if (strlen(hostname) >= sizeof(cached_hostname) || DNS_GetHostByName2((const uint8_t*)hostname, ip) != 0)
+        {
+            // SSL_Connect resolves the name itself
+            printf("DNS lookup of %s failed, not caching it\n", hostname);
+            result = hostname;
+        }
+        else
+        {
+            ip[sizeof(ip) - 1] = '\0';
+            (void)strcpy(cached_hostname, hostname);
+            (void)strcpy(cached_ip, (const char*)ip);
+            result = cached_ip;
+        }
+    }
+    return result;
+}
+
 static void tlsio_ssl_Init(TLS_IO_INSTANCE* tls_io_instance)
 {
     printf("start tlsio_ssl_Init\n");
@@ -170,6 +212,8 @@ static CONCRETE_IO_HANDLE tlsio_ssl_create(void* io_create_parameters)
             tls_io_instance->on_io_close_complete = NULL;
             tls_io_instance->on_io_close_complete_context = NULL;
             tls_io_instance->tlsio_state = TLSIO_STATE_CLOSED;
+            tls_io_instance->receive_timeout_ms = DEFAULT_RECEIVE_TIMEOUT_MS;
+            tls_io_instance->receive_budget = 0;
             // No options are currently supported
             tlsio_options_initialize(&tls_io_instance->options, TLSIO_OPTION_BIT_NONE);
             /* Codes_SRS_TLSIO_30_016: [ tlsio_create shall make a copy of the hostname member of io_create_parameters to allow deletion of hostname immediately after the call. ]*/
@@ -434,6 +478,8 @@ static void tlsio_ssl_dowork(CONCRETE_IO_HANDLE tlsio_handle)
     else
     {
         int received;
+        size_t received_total = 0;
+        int timeout_ms;
         SSL_Error_t error;
         TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)tlsio_handle;
         /* Codes_SRS_TLSIO_ARDUINO_21_075: [ The tlsio_ssl_dowork shall create a buffer to store the data received from the ssl client. ]*/
@@ -447,9 +493,16 @@ static void tlsio_ssl_dowork(CONCRETE_IO_HANDLE tlsio_handle)
         case TLSIO_STATE_OPENING:
             if ((tls_io_instance->countTry--) >= 0) 
             {
-                error = SSL_Connect(tls_io_instance->config, tls_io_instance->hostname, tls_io_instance->port);
+                // The certificate is still checked against config->hostName, only the lookup is skipped
+                const char* server = tlsio_ssl_get_server(tls_io_instance->hostname);
+                error = SSL_Connect(tls_io_instance->config, server, tls_io_instance->port);
                 if (error != SSL_ERROR_NONE)
                 {
+                    if (server == cached_ip)
+                    {
+                        // The host may have moved, look it up again on the next try
+                        cached_ip[0] = '\0';
+                    }
                     /* Codes_SRS_TLSIO_30_038: [ If tlsio_open fails to enter TLSIO_STATE_EX_OPENING it shall return FAILURE. ]*/
                     printf("TLS failed to start the connection process.\n");
                 } 
@@ -474,8 +527,22 @@ static void tlsio_ssl_dowork(CONCRETE_IO_HANDLE tlsio_handle)
             break;
         case TLSIO_STATE_OPEN:
             /* Codes_SRS_TLSIO_ARDUINO_21_069: [ If the tlsio state is TLSIO_ARDUINO_STATE_OPEN, the tlsio_ssl_dowork shall read data from the ssl client. ]*/
-            while ((received = SSL_Read(tls_io_instance->config, (uint8_t*)RecvBuffer, RECEIVE_BUFFER_SIZE, 5000)) > 0)
+            // Only the first read waits for data, the next ones take what already arrived,
+            // and no more than receive_budget bytes are read so that one call stays short
+            timeout_ms = (int)tls_io_instance->receive_timeout_ms;
+            while (tls_io_instance->receive_budget == 0 || received_total < tls_io_instance->receive_budget)
             {
+                size_t read_size = RECEIVE_BUFFER_SIZE;
+                if (tls_io_instance->receive_budget != 0 && tls_io_instance->receive_budget - received_total < read_size)
+                {
+                    read_size = tls_io_instance->receive_budget - received_total;
+                }
+                if ((received = SSL_Read(tls_io_instance->config, (uint8_t*)RecvBuffer, (int)read_size, timeout_ms)) <= 0)
+                {
+                    break;
+                }
+                received_total += (size_t)received;
+                timeout_ms = 0;
                 /* Codes_SRS_TLSIO_ARDUINO_21_070: [ If the tlsio state is TLSIO_ARDUINO_STATE_OPEN, and there are received data in the ssl client, the tlsio_ssl_dowork shall read this data and call the on_bytes_received with the pointer to the buffer with the data. ]*/
                 if (tls_io_instance->on_bytes_received != NULL)
                 {
@@ -540,28 +607,41 @@ static int tlsio_ssl_setoption(CONCRETE_IO_HANDLE tlsio_handle, const char* opti
         /* Codes_SRS_TLSIO_30_121: [ If the optionName parameter is NULL, tlsio_openssl_compact_setoption shall do nothing except log an error and return FAILURE. ]*/
         /* Codes_SRS_TLSIO_30_122: [ If the value parameter is NULL, tlsio_openssl_compact_setoption shall do nothing except log an error and return FAILURE. ]*/
         /* Codes_SRS_TLSIO_OPENSSL_COMPACT_30_520 [ The tlsio_setoption shall do nothing and return FAILURE. ]*/
-        if (strcmp(OPTION_TRUSTED_CERT, optionName) == 0) {
-            if (tls_io_instance->trusted_certificates != NULL)
-            {
-                // Free the memory if it has been previously allocated
-                free(tls_io_instance->trusted_certificates);
-                tls_io_instance->trusted_certificates = NULL;
-            }
-            if (mallocAndStrcpy_s(&tls_io_instance->trusted_certificates, (const char*)value) != 0)
-            {
-                printf("unable to mallocAndStrcpy_s\n");
-                result = __FAILURE__;
-            }
+        if (strcmp(OPTION_RECEIVE_TIMEOUT_MS, optionName) == 0)
+        {
+            tls_io_instance->receive_timeout_ms = *(const unsigned int*)value;
+            result = 0;
         }
-        TLSIO_OPTIONS_RESULT options_result = tlsio_options_set(&tls_io_instance->options, optionName, value);
-        if (options_result != TLSIO_OPTIONS_RESULT_SUCCESS)
+        else if (strcmp(OPTION_RECEIVE_BUDGET, optionName) == 0)
         {
-            printf("Failed tlsio_options_set\n");
-            result = __FAILURE__;
+            tls_io_instance->receive_budget = *(const size_t*)value;
+            result = 0;
         }
         else
         {
-            result = 0;
+            if (strcmp(OPTION_TRUSTED_CERT, optionName) == 0) {
+                if (tls_io_instance->trusted_certificates != NULL)
+                {
+                    // Free the memory if it has been previously allocated
+                    free(tls_io_instance->trusted_certificates);
+                    tls_io_instance->trusted_certificates = NULL;
+                }
+                if (mallocAndStrcpy_s(&tls_io_instance->trusted_certificates, (const char*)value) != 0)
+                {
+                    printf("unable to mallocAndStrcpy_s\n");
+                    result = __FAILURE__;
+                }
+            }
+            TLSIO_OPTIONS_RESULT options_result = tlsio_options_set(&tls_io_instance->options, optionName, value);
+            if (options_result != TLSIO_OPTIONS_RESULT_SUCCESS)
+            {
+                printf("Failed tlsio_options_set\n");
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
         }
     }
     printf("end tlsio_ssl_setoption\n");
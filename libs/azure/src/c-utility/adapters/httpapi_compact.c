@@ -41,17 +41,48 @@
 
 DEFINE_ENUM_STRINGS(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES)
 
+/*Codes_SRS_HTTPAPI_COMPACT_01_001: [ The HTTPAPI_ExecuteRequest shall parse the response as its bytes are received, without copying the whole message in an intermediate buffer. ]*/
+typedef enum RESPONSE_STATE_TAG
+{
+    RESPONSE_STATE_IDLE,
+    RESPONSE_STATE_STATUS_LINE,
+    RESPONSE_STATE_HEADERS,
+    RESPONSE_STATE_CONTENT,
+    RESPONSE_STATE_CHUNK_SIZE,
+    RESPONSE_STATE_CHUNK_DATA,
+    RESPONSE_STATE_CHUNK_END,
+    RESPONSE_STATE_TRAILERS,
+    RESPONSE_STATE_COMPLETE,
+    RESPONSE_STATE_FAILED
+} RESPONSE_STATE;
+
 typedef struct HTTP_HANDLE_DATA_TAG
 {
     char*           certificate;
     char*           x509ClientCertificate;
     char*           x509ClientPrivateKey;
     XIO_HANDLE      xio_handle;
-    size_t          received_bytes_count;
-    unsigned char*  received_bytes;
+    RESPONSE_STATE  response_state;
+    HTTPAPI_RESULT  response_result;
+    HTTP_HEADERS_HANDLE response_headers;
+    BUFFER_HANDLE   response_content;
+    const unsigned char* content_buffer;
+    size_t          content_received;
+    size_t          content_remaining;
+    size_t          line_length;
+    unsigned int    status_code;
     unsigned int    is_io_error : 1;
     unsigned int    is_connected : 1;
     unsigned int    send_completed : 1;
+    unsigned int    xio_waits_for_data : 1;
+    unsigned int    bytes_were_received : 1;
+    unsigned int    has_status_code : 1;
+    unsigned int    has_content : 1;
+    unsigned int    is_chunked : 1;
+    unsigned int    closes_after_response : 1;
+    unsigned int    failed_on_io_error : 1;
+    /* the status line, header, chunk size or trailer line being received */
+    char            line[TEMP_BUFFER_SIZE];
 } HTTP_HANDLE_DATA;
 
 /*the following function does the same as sscanf(pos2, "%d", &sec)*/
@@ -238,8 +269,10 @@ HTTP_HANDLE HTTPAPI_CreateConnection(const char* hostName)
             {
                 http_instance->is_connected = 0;
                 http_instance->is_io_error = 0;
-                http_instance->received_bytes_count = 0;
-                http_instance->received_bytes = NULL;
+                http_instance->xio_waits_for_data = 0;
+                http_instance->response_state = RESPONSE_STATE_IDLE;
+                http_instance->response_headers = NULL;
+                http_instance->response_content = NULL;
                 http_instance->certificate = NULL;
                 http_instance->x509ClientCertificate = NULL;
                 http_instance->x509ClientPrivateKey = NULL;
@@ -261,50 +294,62 @@ static void on_io_close_complete(void* context)
     }
 }
 
-void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+static void CloseXIOConnection(HTTP_HANDLE_DATA* http_instance)
 {
-    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
+    /*Codes_SRS_HTTPAPI_COMPACT_01_010: [ If the connection reported an error, the HTTPAPI_CloseConnection shall close it without waiting for the SSL close process. ]*/
+    bool is_broken = ((http_instance->is_io_error != 0) && (http_instance->is_connected != 0));
 
-    /*Codes_SRS_HTTPAPI_COMPACT_21_020: [ If the connection handle is NULL, the HTTPAPI_CloseConnection shall not do anything. ]*/
-    if (http_instance != NULL)
+    http_instance->is_io_error = 0;
+    /*Codes_SRS_HTTPAPI_COMPACT_21_017: [ The HTTPAPI_CloseConnection shall close the connection previously created in HTTPAPI_ExecuteRequest. ]*/
+    if (xio_close(http_instance->xio_handle, on_io_close_complete, http_instance) != 0)
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_019: [ If there is no previous connection, the HTTPAPI_CloseConnection shall not do anything. ]*/
-        if (http_instance->xio_handle != NULL)
+        LogError("The SSL got error closing the connection");
+        /*Codes_SRS_HTTPAPI_COMPACT_21_087: [ If the xio return anything different than 0, the HTTPAPI_CloseConnection shall destroy the connection anyway. ]*/
+        http_instance->is_connected = 0;
+    }
+    else if (is_broken)
+    {
+        http_instance->is_connected = 0;
+    }
+    else
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
+        int countRetry = MAX_CLOSE_RETRY;
+        while (http_instance->is_connected == 1)
         {
-            http_instance->is_io_error = 0;
-            /*Codes_SRS_HTTPAPI_COMPACT_21_017: [ The HTTPAPI_CloseConnection shall close the connection previously created in HTTPAPI_ExecuteRequest. ]*/
-            if (xio_close(http_instance->xio_handle, on_io_close_complete, http_instance) != 0)
+            xio_dowork(http_instance->xio_handle);
+            if ((countRetry--) < 0)
+            {
+                /*Codes_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
+                LogError("Close timeout. The SSL didn't close the connection");
+                http_instance->is_connected = 0;
+            }
+            else if (http_instance->is_io_error == 1)
             {
                 LogError("The SSL got error closing the connection");
-                /*Codes_SRS_HTTPAPI_COMPACT_21_087: [ If the xio return anything different than 0, the HTTPAPI_CloseConnection shall destroy the connection anyway. ]*/
                 http_instance->is_connected = 0;
             }
-            else
+            else if (http_instance->is_connected == 1)
             {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-                int countRetry = MAX_CLOSE_RETRY;
-                while (http_instance->is_connected == 1)
-                {
-                    xio_dowork(http_instance->xio_handle);
-                    if ((countRetry--) < 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
-                        LogError("Close timeout. The SSL didn't close the connection");
-                        http_instance->is_connected = 0;
-                    }
-                    else if (http_instance->is_io_error == 1)
-                    {
-                        LogError("The SSL got error closing the connection");
-                        http_instance->is_connected = 0;
-                    }
-                    else if (http_instance->is_connected == 1)
-                    {
-                        LogInfo("Waiting for TLS close connection");
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
-                    }
-                }
+                LogInfo("Waiting for TLS close connection");
+                /*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries. ]*/
+                ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
             }
+        }
+    }
+}
+
+void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+{
+    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_020: [ If the connection handle is NULL, the HTTPAPI_CloseConnection shall not do anything. ]*/
+    if (http_instance != NULL)
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_019: [ If there is no previous connection, the HTTPAPI_CloseConnection shall not do anything. ]*/
+        if (http_instance->xio_handle != NULL)
+        {
+            CloseXIOConnection(http_instance);
             /*Codes_SRS_HTTPAPI_COMPACT_21_076: [ After close the connection, The HTTPAPI_CloseConnection shall destroy the connection previously created in HTTPAPI_CreateConnection. ]*/
             xio_destroy(http_instance->xio_handle);
         }
@@ -396,298 +441,322 @@ static int InternStrnicmp(const char* s1, const char* s2, size_t n)
     return result;
 }
 
-static void on_bytes_received(void* context, const unsigned char* buffer, size_t size)
+static void fail_response(HTTP_HANDLE_DATA* http_instance, HTTPAPI_RESULT result)
 {
-    unsigned char* new_received_bytes;
-    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)context;
+    http_instance->response_state = RESPONSE_STATE_FAILED;
+    http_instance->response_result = result;
+}
 
-    if (http_instance != NULL)
+/*Codes_SRS_HTTPAPI_COMPACT_01_002: [ The status line, the headers, the chunk sizes and the trailers shall be assembled in a buffer of TEMP_BUFFER_SIZE bytes of the connection. ]*/
+/* returns the number of bytes taken from the buffer, and sets is_line_complete once the line feed is found */
+static size_t assemble_line(HTTP_HANDLE_DATA* http_instance, const unsigned char* buffer, size_t size, bool* is_line_complete)
+{
+    size_t used;
+    const unsigned char* end_of_line = (const unsigned char*)memchr(buffer, '\n', size);
+    size_t line_size = (end_of_line == NULL) ? size : (size_t)(end_of_line - buffer);
+
+    *is_line_complete = false;
+    if (line_size >= (TEMP_BUFFER_SIZE - http_instance->line_length))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_01_003: [ If a line does not fit in the buffer, the HTTPAPI_ExecuteRequest shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
+        LogError("Received message is bigger than the http buffer");
+        fail_response(http_instance, HTTPAPI_READ_DATA_FAILED);
+        used = size;
+    }
+    else
     {
+        (void)memcpy(http_instance->line + http_instance->line_length, buffer, line_size);
+        http_instance->line_length += line_size;
+        used = line_size;
 
-        if (buffer == NULL)
-        {
-            http_instance->is_io_error = 1;
-            LogError("NULL pointer error");
-        }
-        else
+        if (end_of_line != NULL)
         {
-            /* Here we got some bytes so we'll buffer them so the receive functions can consumer it */
-            new_received_bytes = (unsigned char*)realloc(http_instance->received_bytes, http_instance->received_bytes_count + size);
-            if (new_received_bytes == NULL)
+            /* the line feed is consumed, and the carriage return before it removed */
+            used++;
+            if ((http_instance->line_length > 0) && (http_instance->line[http_instance->line_length - 1] == '\r'))
             {
-                http_instance->is_io_error = 1;
-                LogError("Error allocating memory for received data");
-            }
-            else
-            {
-                http_instance->received_bytes = new_received_bytes;
-                if (memcpy(http_instance->received_bytes + http_instance->received_bytes_count, buffer, size) == NULL)
-                {
-                    http_instance->is_io_error = 1;
-                    LogError("Error copping received data to the HTTP bufffer");
-                }
-                else
-                {
-                    http_instance->received_bytes_count += size;
-                }
+                http_instance->line_length--;
             }
+            http_instance->line[http_instance->line_length] = '\0';
+            http_instance->line_length = 0;
+            *is_line_complete = true;
         }
     }
+
+    return used;
 }
 
-static void on_io_error(void* context)
+static void begin_content(HTTP_HANDLE_DATA* http_instance, size_t size, RESPONSE_STATE next_state)
 {
-    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)context;
-    if (http_instance != NULL)
+    http_instance->content_remaining = size;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
+    if (http_instance->response_content == NULL)
     {
-        http_instance->is_io_error = 1;
-        LogError("Error signalled by underlying IO");
+        http_instance->response_state = next_state;
+    }
+    else if ((http_instance->response_state == RESPONSE_STATE_HEADERS) &&
+        (BUFFER_pre_build(http_instance->response_content, size) != 0))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+        LogError("Cannot allocate %lu bytes for the response content", (unsigned long)size);
+        fail_response(http_instance, HTTPAPI_ALLOC_FAILED);
+    }
+    else if ((http_instance->response_state != RESPONSE_STATE_HEADERS) &&
+        (BUFFER_enlarge(http_instance->response_content, size) != 0))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+        LogError("Cannot allocate %lu bytes for the response content", (unsigned long)size);
+        (void)BUFFER_unbuild(http_instance->response_content);
+        fail_response(http_instance, HTTPAPI_ALLOC_FAILED);
+    }
+    else if (BUFFER_content(http_instance->response_content, &http_instance->content_buffer) != 0)
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+        (void)BUFFER_unbuild(http_instance->response_content);
+        fail_response(http_instance, HTTPAPI_ALLOC_FAILED);
+    }
+    else
+    {
+        http_instance->response_state = next_state;
     }
 }
 
-static int conn_receive(HTTP_HANDLE_DATA* http_instance, char* buffer, int count)
+static void process_header(HTTP_HANDLE_DATA* http_instance)
 {
-    int result;
+    const char ContentLength[] = "content-length:";
+    const size_t ContentLengthSize = sizeof(ContentLength) - 1;
+    const char TransferEncoding[] = "transfer-encoding:";
+    const size_t TransferEncodingSize = sizeof(TransferEncoding) - 1;
+    const char Chunked[] = "chunked";
+    const size_t ChunkedSize = sizeof(Chunked) - 1;
+    const char Connection[] = "connection:";
+    const size_t ConnectionSize = sizeof(Connection) - 1;
+    const char Close[] = "close";
+    const size_t CloseSize = sizeof(Close) - 1;
+    char* buf = http_instance->line;
 
-    if ((http_instance == NULL) || (buffer == NULL) || (count < 0))
+    if (InternStrnicmp(buf, ContentLength, ContentLengthSize) == 0)
     {
-        LogError("conn_receive: %s", ((http_instance == NULL) ? "Invalid HTTP instance" : "Invalid HTTP buffer"));
-        result = -1;
+        int lengthInMsg;
+        if ((ParseStringToDecimal(buf + ContentLengthSize, &lengthInMsg) != 1) || (lengthInMsg < 0))
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
+            LogError("Invalid content-length in the response");
+            fail_response(http_instance, HTTPAPI_READ_DATA_FAILED);
+        }
+        else
+        {
+            http_instance->content_remaining = (size_t)lengthInMsg;
+        }
     }
-    else
+    else if (InternStrnicmp(buf, TransferEncoding, TransferEncodingSize) == 0)
     {
-        result = 0;
-        while (result < count)
-        {
-            xio_dowork(http_instance->xio_handle);
-
-            /* if any error was detected while receiving then simply break and report it */
-            if (http_instance->is_io_error != 0)
-            {
-                LogError("xio reported error on dowork");
-                result = -1;
-                break;
-            }
+        const char* substr = buf + TransferEncodingSize;
 
-            if (http_instance->received_bytes_count >= (size_t)count)
-            {
-                /* Consuming bytes from the receive buffer */
-                (void)memcpy(buffer, http_instance->received_bytes, count);
-                (void)memmove(http_instance->received_bytes, http_instance->received_bytes + count, http_instance->received_bytes_count - count);
-                http_instance->received_bytes_count -= count;
+        while (isspace(*substr)) substr++;
 
-                /* we're not reallocating at each consumption so that we don't trash due to byte by byte consumption */
-                if (http_instance->received_bytes_count == 0)
-                {
-                    free(http_instance->received_bytes);
-                    http_instance->received_bytes = NULL;
-                }
+        if (InternStrnicmp(substr, Chunked, ChunkedSize) == 0)
+        {
+            http_instance->is_chunked = 1;
+        }
+    }
+    else if (InternStrnicmp(buf, Connection, ConnectionSize) == 0)
+    {
+        const char* substr = buf + ConnectionSize;
 
-                result = count;
-                break;
-            }
+        while (isspace(*substr)) substr++;
 
-            /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-            ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
+        if (InternStrnicmp(substr, Close, CloseSize) == 0)
+        {
+            http_instance->closes_after_response = 1;
         }
     }
 
-    return result;
-}
-
-static void conn_receive_discard_buffer(HTTP_HANDLE_DATA* http_instance)
-{
-    if (http_instance != NULL)
+    if (http_instance->response_state != RESPONSE_STATE_FAILED)
     {
-        if (http_instance->received_bytes != NULL)
+        char* whereIsColon = strchr(buf, ':');
+        /*Codes_SRS_HTTPAPI_COMPACT_21_049: [ If responseHeadersHandle is provide, the HTTPAPI_ExecuteRequest shall prepare a Response Header usign the HTTPHeaders_AddHeaderNameValuePair. ]*/
+        if (whereIsColon && (http_instance->response_headers != NULL))
         {
-            free(http_instance->received_bytes);
-            http_instance->received_bytes = NULL;
+            *whereIsColon = '\0';
+            HTTPHeaders_AddHeaderNameValuePair(http_instance->response_headers, buf, whereIsColon + 1);
         }
-        http_instance->received_bytes_count = 0;
     }
 }
 
-static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t maxBufSize)
+static void process_line(HTTP_HANDLE_DATA* http_instance)
 {
-    int resultLineSize;
-
-    if ((http_instance == NULL) || (buf == NULL) || (maxBufSize == 0))
+    switch (http_instance->response_state)
+    {
+    case RESPONSE_STATE_STATUS_LINE:
     {
-        LogError("%s", ((http_instance == NULL) ? "Invalid HTTP instance" : "Invalid HTTP buffer"));
-        resultLineSize = -1;
+        int status_code;
+        /*Codes_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
+        if (ParseHttpResponse(http_instance->line, &status_code) != 1)
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+            LogInfo("Not a correct HTTP answer");
+            fail_response(http_instance, HTTPAPI_RECEIVE_RESPONSE_FAILED);
+        }
+        else
+        {
+            http_instance->status_code = (unsigned int)status_code;
+            http_instance->has_status_code = 1;
+            http_instance->response_state = RESPONSE_STATE_HEADERS;
+        }
+        break;
     }
-    else
+    case RESPONSE_STATE_HEADERS:
+        /*Codes_SRS_HTTPAPI_COMPACT_21_074: [ After the header, the message received by the HTTPAPI_ExecuteRequest can contain addition information about the content. ]*/
+        if (http_instance->line[0] != '\0')
+        {
+            process_header(http_instance);
+        }
+        /*Codes_SRS_HTTPAPI_COMPACT_42_088: [ The message received by the HTTPAPI_ExecuteRequest should not contain http body. ]*/
+        else if (http_instance->has_content == 0)
+        {
+            http_instance->response_state = RESPONSE_STATE_COMPLETE;
+        }
+        else if (http_instance->is_chunked != 0)
+        {
+            http_instance->response_state = RESPONSE_STATE_CHUNK_SIZE;
+        }
+        /*Codes_SRS_HTTPAPI_COMPACT_21_075: [ The message received by the HTTPAPI_ExecuteRequest can contain a body with the message content. ]*/
+        else if (http_instance->content_remaining > 0)
+        {
+            begin_content(http_instance, http_instance->content_remaining, RESPONSE_STATE_CONTENT);
+        }
+        else
+        {
+            http_instance->response_state = RESPONSE_STATE_COMPLETE;
+        }
+        break;
+    case RESPONSE_STATE_CHUNK_SIZE:
     {
-        char* destByte = buf;
-        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-        int countRetry = MAX_RECEIVE_RETRY;
-        bool endOfSearch = false;
-        resultLineSize = -1;
-        while (!endOfSearch)
+        size_t chunkSize;
+        /*Codes_SRS_HTTPAPI_COMPACT_01_004: [ A chunked content shall be decoded as it arrives, ignoring the chunk extensions and the trailers. ]*/
+        if (ParseStringToHexadecimal(http_instance->line, &chunkSize) != 1)
         {
-            xio_dowork(http_instance->xio_handle);
-
-            /* if any error was detected while receiving then simply break and report it */
-            if (http_instance->is_io_error != 0)
-            {
-                LogError("xio reported error on dowork");
-                endOfSearch = true;
-            }
-            else
-            {
-                unsigned char* receivedByte = http_instance->received_bytes;
-                while (receivedByte < (http_instance->received_bytes + http_instance->received_bytes_count))
-                {
-                    if ((*receivedByte) != '\r')
-                    {
-                        (*destByte) = (*receivedByte);
-                        destByte++;
-                        receivedByte++;
-
-                        if (destByte >= (buf + maxBufSize - 1))
-                        {
-                            LogError("Received message is bigger than the http buffer");
-                            receivedByte = http_instance->received_bytes + http_instance->received_bytes_count;
-                            endOfSearch = true;
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        receivedByte++;
-                        if ((receivedByte < (http_instance->received_bytes + http_instance->received_bytes_count)) && ((*receivedByte) == '\n'))
-                        {
-                            receivedByte++;
-                        }
-                        (*destByte) = '\0';
-                        resultLineSize = (int)(destByte - buf);
-                        endOfSearch = true;
-                        break;
-                    }
-                }
-
-                http_instance->received_bytes_count -= (receivedByte - http_instance->received_bytes);
-                if (http_instance->received_bytes_count != 0)
-                {
-                    (void)memmove(http_instance->received_bytes, receivedByte, http_instance->received_bytes_count);
-                }
-                else
-                {
-                    conn_receive_discard_buffer(http_instance);
-                }
-            }
-
-            if (!endOfSearch)
-            {
-                if ((countRetry--) > 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                    ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
-                }
-                else
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                    LogError("Receive timeout. The HTTP request is incomplete");
-                    endOfSearch = true;
-                }
-            }
+            /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+            LogError("Invalid chunk size in the response");
+            fail_response(http_instance, HTTPAPI_RECEIVE_RESPONSE_FAILED);
+        }
+        else if (chunkSize == 0)
+        {
+            http_instance->response_state = RESPONSE_STATE_TRAILERS;
         }
+        else
+        {
+            begin_content(http_instance, chunkSize, RESPONSE_STATE_CHUNK_DATA);
+        }
+        break;
+    }
+    case RESPONSE_STATE_CHUNK_END:
+        if (http_instance->line[0] != '\0')
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
+            LogError("Chunk data is longer than its size");
+            fail_response(http_instance, HTTPAPI_READ_DATA_FAILED);
+        }
+        else
+        {
+            http_instance->response_state = RESPONSE_STATE_CHUNK_SIZE;
+        }
+        break;
+    case RESPONSE_STATE_TRAILERS:
+        if (http_instance->line[0] == '\0')
+        {
+            http_instance->response_state = RESPONSE_STATE_COMPLETE;
+        }
+        break;
+    default:
+        break;
     }
-
-    return resultLineSize;
 }
 
-static int readChunk(HTTP_HANDLE_DATA* http_instance, char* buf, size_t size)
+/*Codes_SRS_HTTPAPI_COMPACT_01_005: [ The content shall be copied from the received bytes straight to responseContent. ]*/
+static size_t receive_content(HTTP_HANDLE_DATA* http_instance, const unsigned char* buffer, size_t size)
 {
-    int cur, offset;
+    size_t used = (size < http_instance->content_remaining) ? size : http_instance->content_remaining;
 
-    // read content with specified length, even if it is received
-    // only in chunks due to fragmentation in the networking layer.
-    // returns -1 in case of error.
-    offset = 0;
-    while (size > (size_t)0)
+    if (http_instance->response_content != NULL)
     {
-        cur = conn_receive(http_instance, buf + offset, (int)size);
-
-        // end of stream reached
-        if (cur == 0)
-        {
-            break;
-        }
+        (void)memcpy((unsigned char*)http_instance->content_buffer + http_instance->content_received, buffer, used);
+        http_instance->content_received += used;
+    }
 
-        // read cur bytes (might be less than requested)
-        size -= (size_t)cur;
-        offset += cur;
+    http_instance->content_remaining -= used;
+    if (http_instance->content_remaining == 0)
+    {
+        http_instance->response_state = (http_instance->response_state == RESPONSE_STATE_CONTENT) ? RESPONSE_STATE_COMPLETE : RESPONSE_STATE_CHUNK_END;
     }
 
-    return offset;
+    return used;
 }
 
-static int skipN(HTTP_HANDLE_DATA* http_instance, size_t n)
+static bool is_receiving_response(HTTP_HANDLE_DATA* http_instance)
 {
-    // read and abandon response content with specified length
-    // returns -1 in case of error.
+    return ((http_instance->response_state != RESPONSE_STATE_IDLE) &&
+        (http_instance->response_state != RESPONSE_STATE_COMPLETE) &&
+        (http_instance->response_state != RESPONSE_STATE_FAILED));
+}
 
-    int result;
+static void on_bytes_received(void* context, const unsigned char* buffer, size_t size)
+{
+    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)context;
 
-    if (http_instance == NULL)
-    {
-        LogError("Invalid HTTP instance");
-        result = -1;
-    }
-    else
+    if (http_instance != NULL)
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-        int countRetry = MAX_RECEIVE_RETRY;
-        result = (int)n;
-        while (n > 0)
-        {
-            xio_dowork(http_instance->xio_handle);
 
-            /* if any error was detected while receiving then simply break and report it */
-            if (http_instance->is_io_error != 0)
+        if (buffer == NULL)
+        {
+            http_instance->is_io_error = 1;
+            LogError("NULL pointer error");
+        }
+        else
+        {
+            if (size > 0)
             {
-                LogError("xio reported error on dowork");
-                result = -1;
-                n = 0;
+                http_instance->bytes_were_received = 1;
             }
-            else
+
+            /*Codes_SRS_HTTPAPI_COMPACT_01_006: [ The bytes received when no response is expected, or after the end of the response, shall be ignored. ]*/
+            while ((size > 0) && is_receiving_response(http_instance))
             {
-                if (http_instance->received_bytes_count <= n)
+                size_t used;
+
+                if ((http_instance->response_state == RESPONSE_STATE_CONTENT) ||
+                    (http_instance->response_state == RESPONSE_STATE_CHUNK_DATA))
                 {
-                    n -= http_instance->received_bytes_count;
-                    http_instance->received_bytes_count = 0;
+                    used = receive_content(http_instance, buffer, size);
                 }
                 else
                 {
-                    http_instance->received_bytes_count -= n;
-                    (void)memmove(http_instance->received_bytes, http_instance->received_bytes + n, http_instance->received_bytes_count);
-                    n = 0;
-                }
-
-                if (n > 0)
-                {
-                    if ((countRetry--) > 0)
+                    bool is_line_complete;
+                    used = assemble_line(http_instance, buffer, size, &is_line_complete);
+                    if (is_line_complete)
                     {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
-                    }
-                    else
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                        LogError("Receive timeout. The HTTP request is incomplete");
-                        n = 0;
-                        result = -1;
+                        process_line(http_instance);
                     }
                 }
+
+                buffer += used;
+                size -= used;
             }
         }
     }
-
-    return result;
 }
 
+static void on_io_error(void* context)
+{
+    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)context;
+    if (http_instance != NULL)
+    {
+        http_instance->is_io_error = 1;
+        LogError("Error signalled by underlying IO");
+    }
+}
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_021: [ The HTTPAPI_ExecuteRequest shall execute the http communtication with the provided host, sending a request and reciving the response. ]*/
 static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance)
@@ -729,6 +798,10 @@ static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance)
         }
         else
         {
+            /*Codes_SRS_HTTPAPI_COMPACT_01_008: [ Before opening the connection, the HTTPAPI_ExecuteRequest shall set OPTION_RECEIVE_TIMEOUT_MS to 100 milliseconds, so xio_dowork waits for the bytes of the response. ]*/
+            unsigned int receive_timeout_ms = RETRY_INTERVAL_IN_MICROSECONDS;
+            http_instance->xio_waits_for_data = (xio_setoption(http_instance->xio_handle, OPTION_RECEIVE_TIMEOUT_MS, &receive_timeout_ms) == 0) ? 1 : 0;
+
             /*Codes_SRS_HTTPAPI_COMPACT_21_024: [ The HTTPAPI_ExecuteRequest shall open the transport connection with the host to send the request. ]*/
             if (xio_open(http_instance->xio_handle, on_io_open_complete, http_instance, on_bytes_received, http_instance, on_io_error, http_instance) != 0)
             {
@@ -782,6 +855,7 @@ static HTTPAPI_RESULT conn_send_all(HTTP_HANDLE_DATA* http_instance, const unsig
     if (xio_send(http_instance->xio_handle, buf, bufLen, on_send_complete, http_instance) != 0)
     {
         /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+        http_instance->failed_on_io_error = 1;
         result = HTTPAPI_SEND_REQUEST_FAILED;
     }
     else
@@ -796,6 +870,7 @@ static HTTPAPI_RESULT conn_send_all(HTTP_HANDLE_DATA* http_instance, const unsig
             if (http_instance->is_io_error != 0)
             {
                 /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+                http_instance->failed_on_io_error = 1;
                 result = HTTPAPI_SEND_REQUEST_FAILED;
             }
             else if ((countRetry--) <= 0)
@@ -823,11 +898,44 @@ const char* get_request_type(HTTPAPI_REQUEST_TYPE requestType)
     return (const char*)httpapiRequestString[requestType];
 }
 
+/*Codes_SRS_HTTPAPI_COMPACT_01_011: [ The request line and the headers shall be gathered in a buffer of TEMP_BUFFER_SIZE bytes, which is sent when it is full and at the end of the headers. ]*/
+static HTTPAPI_RESULT AppendToHead(HTTP_HANDLE_DATA* http_instance, char* head, size_t* head_length, const char* text, size_t text_length)
+{
+    HTTPAPI_RESULT result;
+
+    if (((*head_length + text_length) <= TEMP_BUFFER_SIZE) || (*head_length == 0))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
+        result = HTTPAPI_OK;
+    }
+    else if ((result = conn_send_all(http_instance, (const unsigned char*)head, *head_length)) == HTTPAPI_OK)
+    {
+        *head_length = 0;
+    }
+
+    if (result == HTTPAPI_OK)
+    {
+        if (text_length > TEMP_BUFFER_SIZE)
+        {
+            /* a header bigger than the buffer is sent by itself */
+            result = conn_send_all(http_instance, (const unsigned char*)text, text_length);
+        }
+        else
+        {
+            (void)memcpy(head + *head_length, text, text_length);
+            *head_length += text_length;
+        }
+    }
+
+    return result;
+}
+
 /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
 static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, size_t headersCount)
 {
     HTTPAPI_RESULT result;
     char    buf[TEMP_BUFFER_SIZE];
+    size_t  bufLen;
     int     ret;
 
     //Send request
@@ -839,12 +947,13 @@ static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_RE
         /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
         result = HTTPAPI_STRING_PROCESSING_ERROR;
     }
-        /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
-    else if ((result = conn_send_all(http_instance, (const unsigned char*)buf, strlen(buf))) == HTTPAPI_OK)
+    else
     {
         size_t i;
+        bufLen = (size_t)ret;
         //Send default headers
         /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
+        result = HTTPAPI_OK;
         for (i = 0; ((i < headersCount) && (result == HTTPAPI_OK)); i++)
         {
             char* header;
@@ -855,18 +964,21 @@ static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_RE
             }
             else
             {
-                if ((result = conn_send_all(http_instance, (const unsigned char*)header, strlen(header))) == HTTPAPI_OK)
+                /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+                if ((result = AppendToHead(http_instance, buf, &bufLen, header, strlen(header))) == HTTPAPI_OK)
                 {
-                    result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
+                    result = AppendToHead(http_instance, buf, &bufLen, "\r\n", (size_t)2);
                 }
                 free(header);
             }
         }
 
         //Close headers
-        if (result == HTTPAPI_OK)
+        if ((result == HTTPAPI_OK) &&
+            ((result = AppendToHead(http_instance, buf, &bufLen, "\r\n", (size_t)2)) == HTTPAPI_OK))
         {
-            result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
+            /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+            result = conn_send_all(http_instance, (const unsigned char*)buf, bufLen);
         }
     }
     return result;
@@ -893,264 +1005,93 @@ static HTTPAPI_RESULT SendContentToXIO(HTTP_HANDLE_DATA* http_instance, const un
     return result;
 }
 
-/*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
-static HTTPAPI_RESULT ReceiveHeaderFromXIO(HTTP_HANDLE_DATA* http_instance, unsigned int* statusCode)
+static void BeginResponse(HTTP_HANDLE_DATA* http_instance, bool has_content, HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
 {
-    HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    int     ret;
-
-    http_instance->is_io_error = 0;
-
-    //Receive response
-    if (readLine(http_instance, buf, TEMP_BUFFER_SIZE) < 0)
-    {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-        result = HTTPAPI_READ_DATA_FAILED;
-    }
-    //Parse HTTP response
-    else if (ParseHttpResponse(buf, &ret) != 1)
-    {
-        //Cannot match string, error
-        /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-        LogInfo("Not a correct HTTP answer");
-        result = HTTPAPI_RECEIVE_RESPONSE_FAILED;
-    }
-    else
-    {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_046: [ The HTTPAPI_ExecuteRequest shall return the http status reported by the host in the received response. ]*/
-        /*Codes_SRS_HTTPAPI_COMPACT_21_048: [ If the statusCode is NULL, the HTTPAPI_ExecuteRequest shall report not report any status. ]*/
-        if (statusCode)
-        {
-            /*Codes_SRS_HTTPAPI_COMPACT_21_047: [ The HTTPAPI_ExecuteRequest shall report the status in the statusCode parameter. ]*/
-            *statusCode = ret;
-        }
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        result = HTTPAPI_OK;
-    }
-
-    return result;
+    http_instance->response_state = RESPONSE_STATE_STATUS_LINE;
+    http_instance->response_result = HTTPAPI_OK;
+    http_instance->response_headers = responseHeadersHandle;
+    http_instance->response_content = responseContent;
+    http_instance->content_buffer = NULL;
+    http_instance->content_received = 0;
+    http_instance->content_remaining = 0;
+    http_instance->line_length = 0;
+    http_instance->has_status_code = 0;
+    http_instance->has_content = has_content ? 1 : 0;
+    http_instance->is_chunked = 0;
+    http_instance->closes_after_response = 0;
+    http_instance->failed_on_io_error = 0;
 }
 
-static HTTPAPI_RESULT ReceiveContentInfoFromXIO(HTTP_HANDLE_DATA* http_instance, HTTP_HEADERS_HANDLE responseHeadersHandle, size_t* bodyLength, bool* chunked)
+static void EndResponse(HTTP_HANDLE_DATA* http_instance)
 {
-    HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    const char* substr;
-    char* whereIsColon;
-    int lengthInMsg;
-    const char ContentLength[] = "content-length:";
-    const size_t ContentLengthSize = sizeof(ContentLength) - 1;
-    const char TransferEncoding[] = "transfer-encoding:";
-    const size_t TransferEncodingSize = sizeof(TransferEncoding) - 1;
-    const char Chunked[] = "chunked";
-    const size_t ChunkedSize = sizeof(Chunked) - 1;
-
-    http_instance->is_io_error = 0;
-
-    //Read HTTP response headers
-    if (readLine(http_instance, buf, sizeof(buf)) < 0)
-    {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-        result = HTTPAPI_READ_DATA_FAILED;
-    }
-    else
-    {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        result = HTTPAPI_OK;
-
-        while (*buf && (result == HTTPAPI_OK))
-        {
-            if (InternStrnicmp(buf, ContentLength, ContentLengthSize) == 0)
-            {
-                substr = buf + ContentLengthSize;
-                if (ParseStringToDecimal(substr, &lengthInMsg) != 1)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-                else
-                {
-                    (*bodyLength) = (size_t)lengthInMsg;
-                }
-            }
-            else if (InternStrnicmp(buf, TransferEncoding, TransferEncodingSize) == 0)
-            {
-                substr = buf + TransferEncodingSize;
-
-                while (isspace(*substr)) substr++;
-
-                if (InternStrnicmp(substr, Chunked, ChunkedSize) == 0)
-                {
-                    (*chunked) = true;
-                }
-            }
-
-            if (result == HTTPAPI_OK)
-            {
-                whereIsColon = strchr((char*)buf, ':');
-                /*Codes_SRS_HTTPAPI_COMPACT_21_049: [ If responseHeadersHandle is provide, the HTTPAPI_ExecuteRequest shall prepare a Response Header usign the HTTPHeaders_AddHeaderNameValuePair. ]*/
-                if (whereIsColon && (responseHeadersHandle != NULL))
-                {
-                    *whereIsColon = '\0';
-                    HTTPHeaders_AddHeaderNameValuePair(responseHeadersHandle, buf, whereIsColon + 1);
-                }
-
-                if (readLine(http_instance, buf, sizeof(buf)) < 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-            }
-        }
-    }
-
-    return result;
+    http_instance->response_state = RESPONSE_STATE_IDLE;
+    http_instance->response_headers = NULL;
+    http_instance->response_content = NULL;
+    http_instance->content_buffer = NULL;
 }
 
-static HTTPAPI_RESULT ReadHTTPResponseBodyFromXIO(HTTP_HANDLE_DATA* http_instance, size_t bodyLength, bool chunked, BUFFER_HANDLE responseContent)
+/*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
+static HTTPAPI_RESULT ReceiveResponseFromXIO(HTTP_HANDLE_DATA* http_instance, unsigned int* statusCode)
 {
     HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    const unsigned char* receivedContent;
+    /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
+    int countRetry = MAX_RECEIVE_RETRY;
 
     http_instance->is_io_error = 0;
 
-    //Read HTTP response body
-    if (!chunked)
+    /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
+    result = HTTPAPI_OK;
+    while ((result == HTTPAPI_OK) && is_receiving_response(http_instance))
     {
-        if (bodyLength)
-        {
-            if (responseContent != NULL)
-            {
-                if (BUFFER_pre_build(responseContent, bodyLength) != 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                    result = HTTPAPI_ALLOC_FAILED;
-                }
-                else if (BUFFER_content(responseContent, &receivedContent) != 0)
-                {
-                    (void)BUFFER_unbuild(responseContent);
+        http_instance->bytes_were_received = 0;
+        xio_dowork(http_instance->xio_handle);
 
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                    result = HTTPAPI_ALLOC_FAILED;
-                }
-                else if (readChunk(http_instance, (char*)receivedContent, bodyLength) < 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-                else
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-                    result = HTTPAPI_OK;
-                }
-            }
-            else
-            {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
-                if (skipN(http_instance, bodyLength) < 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-                else
-                {
-                    result = HTTPAPI_OK;
-                }
-            }
+        /* if any error was detected while receiving then simply break and report it */
+        if (http_instance->is_io_error != 0)
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
+            LogError("xio reported error on dowork");
+            http_instance->failed_on_io_error = 1;
+            result = HTTPAPI_READ_DATA_FAILED;
         }
-        else
+        else if (http_instance->bytes_were_received != 0)
         {
-            /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-            result = HTTPAPI_OK;
+            /*Codes_SRS_HTTPAPI_COMPACT_01_007: [ The time to receive the response shall restart each time bytes are received. ]*/
+            countRetry = MAX_RECEIVE_RETRY;
         }
-    }
-    else
-    {
-        size_t size = 0;
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        result = HTTPAPI_OK;
-        while (result == HTTPAPI_OK)
+        else if (is_receiving_response(http_instance))
         {
-            size_t chunkSize;
-            if (readLine(http_instance, buf, sizeof(buf)) < 0)    // read [length in hex]/r/n
+            if ((countRetry--) <= 0)
             {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
                 /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
+                LogError("Receive timeout. The HTTP request is incomplete");
                 result = HTTPAPI_READ_DATA_FAILED;
             }
-            else if (ParseStringToHexadecimal(buf, &chunkSize) != 1)     // chunkSize is length of next line (/r/n is not counted)
-            {
-                //Cannot match string, error
-                /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-                result = HTTPAPI_RECEIVE_RESPONSE_FAILED;
-            }
-            else if (chunkSize == 0)
-            {
-                // 0 length means next line is just '\r\n' and end of chunks
-                if (readChunk(http_instance, (char*)buf, (size_t)2) < 0
-                    || buf[0] != '\r' || buf[1] != '\n') // skip /r/n
-                {
-                    (void)BUFFER_unbuild(responseContent);
-
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-                break;
-            }
-            else
+            /*Codes_SRS_HTTPAPI_COMPACT_01_009: [ If the xio accepted OPTION_RECEIVE_TIMEOUT_MS, the HTTPAPI_ExecuteRequest shall not sleep between the xio_dowork calls that receive the response. ]*/
+            else if (http_instance->xio_waits_for_data == 0)
             {
-                if (responseContent != NULL)
-                {
-                    if (BUFFER_enlarge(responseContent, chunkSize) != 0)
-                    {
-                        (void)BUFFER_unbuild(responseContent);
-
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                        result = HTTPAPI_ALLOC_FAILED;
-                    }
-                    else if (BUFFER_content(responseContent, &receivedContent) != 0)
-                    {
-                        (void)BUFFER_unbuild(responseContent);
-
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                        result = HTTPAPI_ALLOC_FAILED;
-                    }
-                    else if (readChunk(http_instance, (char*)receivedContent + size, chunkSize) < 0)
-                    {
-                        result = HTTPAPI_READ_DATA_FAILED;
-                    }
-                }
-                else
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
-                    if (skipN(http_instance, chunkSize) < 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                        result = HTTPAPI_READ_DATA_FAILED;
-                    }
-                }
-
-                if (result == HTTPAPI_OK)
-                {
-                    if (readChunk(http_instance, (char*)buf, (size_t)2) < 0
-                        || buf[0] != '\r' || buf[1] != '\n') // skip /r/n
-                    {
-                        result = HTTPAPI_READ_DATA_FAILED;
-                    }
-                    size += chunkSize;
-                }
+                /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
+                ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
             }
         }
+    }
 
+    if ((result == HTTPAPI_OK) && (http_instance->response_state == RESPONSE_STATE_FAILED))
+    {
+        result = http_instance->response_result;
     }
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_046: [ The HTTPAPI_ExecuteRequest shall return the http status reported by the host in the received response. ]*/
+    /*Codes_SRS_HTTPAPI_COMPACT_21_048: [ If the statusCode is NULL, the HTTPAPI_ExecuteRequest shall report not report any status. ]*/
+    if ((statusCode != NULL) && (http_instance->has_status_code != 0))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_047: [ The HTTPAPI_ExecuteRequest shall report the status in the statusCode parameter. ]*/
+        *statusCode = http_instance->status_code;
+    }
+
     return result;
 }
 
-
 /*Codes_SRS_HTTPAPI_COMPACT_21_037: [ If the request type is unknown, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
 static bool validRequestType(HTTPAPI_REQUEST_TYPE requestType)
 {
@@ -1173,6 +1114,48 @@ static bool validRequestType(HTTPAPI_REQUEST_TYPE requestType)
     return result;
 }
 
+static HTTPAPI_RESULT SendRequestAndReceiveResponse(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, size_t headersCount, const unsigned char* content,
+    size_t contentLength, unsigned int* statusCode)
+{
+    HTTPAPI_RESULT result;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_024: [ The HTTPAPI_ExecuteRequest shall open the transport connection with the host to send the request. ]*/
+    if ((result = OpenXIOConnection(http_instance)) != HTTPAPI_OK)
+    {
+        LogError("Open HTTP connection failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
+    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, headersCount)) != HTTPAPI_OK)
+    {
+        LogError("Send heads to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    /*Codes_SRS_HTTPAPI_COMPACT_21_042: [ The request can contain the a content message, provided in content parameter. ]*/
+    else if ((result = SendContentToXIO(http_instance, content, contentLength)) != HTTPAPI_OK)
+    {
+        LogError("Send content to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    /*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
+    else if ((result = ReceiveResponseFromXIO(http_instance, statusCode)) != HTTPAPI_OK)
+    {
+        LogError("Receive response from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+
+    return result;
+}
+
+/* a connection kept alive from a previous request may have been closed by the host, or by a NAT on the way, while it was idle;
+   a timeout says nothing about the connection, and a complete request may have been carried out by the host */
+static bool IsStaleConnection(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, HTTPAPI_RESULT result)
+{
+    return ((http_instance->failed_on_io_error != 0) &&
+        ((result == HTTPAPI_SEND_REQUEST_FAILED) ||
+            ((result == HTTPAPI_READ_DATA_FAILED) &&
+            (requestType != HTTPAPI_REQUEST_POST) && (requestType != HTTPAPI_REQUEST_PATCH) &&
+            (http_instance->response_state == RESPONSE_STATE_STATUS_LINE) &&
+            (http_instance->line_length == 0))));
+}
+
 /*Codes_SRS_HTTPAPI_COMPACT_21_021: [ The HTTPAPI_ExecuteRequest shall execute the http communtication with the provided host, sending a request and reciving the response. ]*/
 /*Codes_SRS_HTTPAPI_COMPACT_21_050: [ If there is a content in the response, the HTTPAPI_ExecuteRequest shall copy it in the responseContent buffer. ]*/
 //Note: This function assumes that "Host:" and "Content-Length:" headers are setup
@@ -1184,8 +1167,6 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
 {
     HTTPAPI_RESULT result = HTTPAPI_ERROR;
     size_t  headersCount;
-    size_t  bodyLength = 0;
-    bool    chunked = false;
     HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
 
     /*Codes_SRS_HTTPAPI_COMPACT_21_034: [ If there is no previous connection, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
@@ -1204,43 +1185,34 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
         result = HTTPAPI_INVALID_ARG;
         LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_024: [ The HTTPAPI_ExecuteRequest shall open the transport connection with the host to send the request. ]*/
-    else if ((result = OpenXIOConnection(http_instance)) != HTTPAPI_OK)
-    {
-        LogError("Open HTTP connection failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, headersCount)) != HTTPAPI_OK)
-    {
-        LogError("Send heads to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_042: [ The request can contain the a content message, provided in content parameter. ]*/
-    else if ((result = SendContentToXIO(http_instance, content, contentLength)) != HTTPAPI_OK)
-    {
-        LogError("Send content to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
-    /*Codes_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
-    else if ((result = ReceiveHeaderFromXIO(http_instance, statusCode)) != HTTPAPI_OK)
-    {
-        LogError("Receive header from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_074: [ After the header, the message received by the HTTPAPI_ExecuteRequest can contain addition information about the content. ]*/
-    else if ((result = ReceiveContentInfoFromXIO(http_instance, responseHeadersHandle, &bodyLength, &chunked)) != HTTPAPI_OK)
-    {
-        LogError("Receive content information from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_42_084: [ The message received by the HTTPAPI_ExecuteRequest should not contain http body. ]*/
-    else if (requestType != HTTPAPI_REQUEST_HEAD)
+    else
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_075: [ The message received by the HTTPAPI_ExecuteRequest can contain a body with the message content. ]*/
-        if ((result = ReadHTTPResponseBodyFromXIO(http_instance, bodyLength, chunked, responseContent)) != HTTPAPI_OK)
+        /*Codes_SRS_HTTPAPI_COMPACT_01_012: [ The HTTPAPI_ExecuteRequest shall send the request on the connection kept open by the previous request, if any. ]*/
+        bool is_kept_alive = (http_instance->is_connected != 0);
+
+        /*Codes_SRS_HTTPAPI_COMPACT_01_001: [ The HTTPAPI_ExecuteRequest shall parse the response as its bytes are received, without copying the whole message in an intermediate buffer. ]*/
+        /*Codes_SRS_HTTPAPI_COMPACT_42_088: [ The message received by the HTTPAPI_ExecuteRequest should not contain http body. ]*/
+        BeginResponse(http_instance, (requestType != HTTPAPI_REQUEST_HEAD), responseHeadersHandle, responseContent);
+        result = SendRequestAndReceiveResponse(http_instance, requestType, relativePath, httpHeadersHandle, headersCount, content, contentLength, statusCode);
+
+        if (is_kept_alive && IsStaleConnection(http_instance, requestType, result))
         {
-            LogError("Read HTTP response body from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+            /*Codes_SRS_HTTPAPI_COMPACT_01_013: [ If the xio reports an error on a kept alive connection while the request is sent, or before any byte of the response is received for a request other than `POST` and `PATCH`, the HTTPAPI_ExecuteRequest shall close the connection, open it again and send the request one more time. ]*/
+            /*Codes_SRS_HTTPAPI_COMPACT_01_015: [ The HTTPAPI_ExecuteRequest shall not send the request again after a send or receive timeout. ]*/
+            LogInfo("The kept alive connection is not working, reopening it");
+            CloseXIOConnection(http_instance);
+            BeginResponse(http_instance, (requestType != HTTPAPI_REQUEST_HEAD), responseHeadersHandle, responseContent);
+            result = SendRequestAndReceiveResponse(http_instance, requestType, relativePath, httpHeadersHandle, headersCount, content, contentLength, statusCode);
+        }
+
+        if ((result == HTTPAPI_OK) && (http_instance->closes_after_response != 0))
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_01_014: [ If the response has the header `Connection: close`, the HTTPAPI_ExecuteRequest shall close the connection, so the next request opens it again. ]*/
+            CloseXIOConnection(http_instance);
         }
-    }
 
-    conn_receive_discard_buffer(http_instance);
+        EndResponse(http_instance);
+    }
 
     return result;
 }
@@ -76,6 +76,59 @@ MOCKABLE_FUNCTION(, STRING_HANDLE, Base64_Encode_Bytes, const unsigned char*, so
  */
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, Base64_Decoder, const char*, source);
 
+/**
+ * @brief    Returns the number of characters in the base64 encoding of @p size bytes.
+ *
+ * @param    size      The number of bytes to be encoded.
+ *
+ * @return    The length of the encoding, not counting the null terminator.
+ */
+MOCKABLE_FUNCTION(, size_t, Base64_Encoded_Length, size_t, size);
+
+/**
+ * @brief    Base64 encodes the buffer pointed to by @p source into @p destination.
+ *
+ * @param    source             The buffer that needs to be base64 encoded.
+ * @param    size               The size of @p source.
+ * @param    destination        The memory receiving the null terminated encoding.
+ * @param    destinationSize    The size of @p destination, at least
+ *                              @c Base64_Encoded_Length(size) + 1.
+ *
+ *             Unlike @c Base64_Encode_Bytes this function does not allocate. If @p destination
+ *             is @c NULL, @p source is @c NULL while @p size is not zero, or @p destinationSize
+ *             is too small then @c Base64_Encode_To_Buffer fails and leaves @p destination
+ *             untouched.
+ *
+ * @return    0 on success, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, Base64_Encode_To_Buffer, const unsigned char*, source, size_t, size, char*, destination, size_t, destinationSize);
+
+/**
+ * @brief    Returns the number of bytes the base64 string @p source decodes to.
+ *
+ * @param    source    A base64 encoded string.
+ *
+ * @return    The decoded size, or 0 if @p source is @c NULL or its length is not a multiple of 4.
+ *             The content of @p source is not validated.
+ */
+MOCKABLE_FUNCTION(, size_t, Base64_Decoded_Length, const char*, source);
+
+/**
+ * @brief    Base64 decodes the string pointed to by @p source into @p destination.
+ *
+ * @param    source             A base64 encoded string.
+ * @param    destination        The memory receiving the decoded bytes.
+ * @param    destinationSize    The size of @p destination, at least
+ *                              @c Base64_Decoded_Length(source).
+ * @param    decodedSize        Receives the number of bytes written to @p destination.
+ *
+ *             Unlike @c Base64_Decoder this function does not allocate, and it rejects any
+ *             @p source that is not made of base64 characters followed by at most two '='.
+ *
+ * @return    0 on success, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, Base64_Decode_To_Buffer, const char*, source, unsigned char*, destination, size_t, destinationSize, size_t*, decodedSize);
+
 #ifdef __cplusplus
 }
 #endif
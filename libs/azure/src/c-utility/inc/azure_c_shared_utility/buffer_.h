@@ -14,6 +14,7 @@ extern "C"
 #endif
 
 #include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/buffer_segment.h"
 
 typedef struct BUFFER_TAG* BUFFER_HANDLE;
 
@@ -34,6 +35,9 @@ MOCKABLE_FUNCTION(, int, BUFFER_fill, BUFFER_HANDLE, handle, unsigned char, fill
 MOCKABLE_FUNCTION(, unsigned char*, BUFFER_u_char, BUFFER_HANDLE, handle);
 MOCKABLE_FUNCTION(, size_t, BUFFER_length, BUFFER_HANDLE, handle);
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, BUFFER_clone, BUFFER_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, BUFFER_reserve, BUFFER_HANDLE, handle, size_t, headroom, size_t, capacity);
+MOCKABLE_FUNCTION(, int, BUFFER_prepend_build, BUFFER_HANDLE, handle, const unsigned char*, source, size_t, size);
+MOCKABLE_FUNCTION(, int, BUFFER_get_segment, BUFFER_HANDLE, handle, BUFFER_SEGMENT*, segment);
 
 #ifdef __cplusplus
 }
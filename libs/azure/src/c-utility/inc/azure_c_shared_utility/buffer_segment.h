@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef BUFFER_SEGMENT_H
+#define BUFFER_SEGMENT_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#endif
+
+/*a borrowed view of a contiguous run of bytes, used to hand several buffers to a gather send without copying them*/
+typedef struct BUFFER_SEGMENT_TAG
+{
+    const unsigned char* data;
+    size_t size;
+} BUFFER_SEGMENT;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* BUFFER_SEGMENT_H */
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef FILESTORE_H
+#define FILESTORE_H
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#endif /* __cplusplus */
+
+/* A file store gives the SDK random access to files of a flash file system. Each platform that
+   wants to persist data provides a FILE_STORE_INTERFACE_DESCRIPTION (see filestore_a9.h). */
+typedef void* FILE_STORE_HANDLE;
+
+/* opens path for reading and writing, creating an empty file if it does not exist; returns NULL on failure */
+typedef FILE_STORE_HANDLE(*FILE_STORE_OPEN)(const char* path);
+typedef void(*FILE_STORE_CLOSE)(FILE_STORE_HANDLE file);
+/* reads up to size bytes at offset; *bytes_read is less than size at the end of the file */
+typedef int(*FILE_STORE_READ)(FILE_STORE_HANDLE file, uint32_t offset, unsigned char* buffer, size_t size, size_t* bytes_read);
+typedef int(*FILE_STORE_WRITE)(FILE_STORE_HANDLE file, uint32_t offset, const unsigned char* buffer, size_t size);
+/* returns once the data written so far is on the media */
+typedef int(*FILE_STORE_FLUSH)(FILE_STORE_HANDLE file);
+typedef bool(*FILE_STORE_EXISTS)(const char* path);
+typedef int(*FILE_STORE_REMOVE)(const char* path);
+/* new_path does not exist when this is called */
+typedef int(*FILE_STORE_RENAME)(const char* old_path, const char* new_path);
+
+typedef struct FILE_STORE_INTERFACE_DESCRIPTION_TAG
+{
+    FILE_STORE_OPEN concrete_file_open;
+    FILE_STORE_CLOSE concrete_file_close;
+    FILE_STORE_READ concrete_file_read;
+    FILE_STORE_WRITE concrete_file_write;
+    FILE_STORE_FLUSH concrete_file_flush;
+    FILE_STORE_EXISTS concrete_file_exists;
+    FILE_STORE_REMOVE concrete_file_remove;
+    FILE_STORE_RENAME concrete_file_rename;
+} FILE_STORE_INTERFACE_DESCRIPTION;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILESTORE_H */
@@ -30,6 +30,62 @@ void gballoc_free(void* ptr);
 #define realloc gballoc_realloc
 #define free gballoc_free
 
+// GB_USE_POOL_HEAP replaces the implementations in gballoc.c with the slab
+// pool allocator in gballoc_pool.c. Small requests are served from fixed size
+// blocks carved out of slabs that are never returned to the heap, which keeps
+// a small heap from fragmenting; everything else goes to the fallback heap.
+// The redirection of the malloc family is always on in this mode.
+#elif defined(GB_USE_POOL_HEAP)
+
+typedef struct GBALLOC_POOL_STATISTICS_TAG
+{
+    /* size of the blocks handed out by this class, 0 for the fallback heap */
+    size_t block_size;
+    /* number of blocks currently allocated */
+    size_t live;
+    /* highest value live has reached since gballoc_init or gballoc_resetMetrics */
+    size_t peak;
+    /* requests the class could not serve (they went to the fallback heap), or for the fallback heap, requests that failed */
+    size_t failures;
+    /* bytes the class holds in slabs, whether the blocks are used or not; for the fallback heap, bytes currently allocated */
+    size_t reserved;
+} GBALLOC_POOL_STATISTICS;
+
+MOCKABLE_FUNCTION(, int, gballoc_init);
+MOCKABLE_FUNCTION(, void, gballoc_deinit);
+MOCKABLE_FUNCTION(, void*, gballoc_malloc, size_t, size);
+MOCKABLE_FUNCTION(, void*, gballoc_calloc, size_t, nmemb, size_t, size);
+MOCKABLE_FUNCTION(, void*, gballoc_realloc, void*, ptr, size_t, size);
+MOCKABLE_FUNCTION(, void, gballoc_free, void*, ptr);
+
+MOCKABLE_FUNCTION(, size_t, gballoc_getMaximumMemoryUsed);
+MOCKABLE_FUNCTION(, size_t, gballoc_getCurrentMemoryUsed);
+MOCKABLE_FUNCTION(, size_t, gballoc_getAllocationCount);
+MOCKABLE_FUNCTION(, void, gballoc_resetMetrics);
+
+/**
+ * @brief   Returns the number of slab size classes. The statistics of the
+ *          fallback heap are reported at index gballoc_getPoolClassCount().
+ */
+MOCKABLE_FUNCTION(, size_t, gballoc_getPoolClassCount);
+
+/**
+ * @brief   Copies the counters of one size class (or of the fallback heap)
+ *          into @p statistics.
+ *
+ * @return  0 on success, non-zero if gballoc is not initialized, @p statistics
+ *          is NULL or @p class_index is greater than gballoc_getPoolClassCount().
+ */
+MOCKABLE_FUNCTION(, int, gballoc_getPoolStatistics, size_t, class_index, GBALLOC_POOL_STATISTICS*, statistics);
+
+/* gballoc_pool.c and its tests define GB_POOL_DO_NOT_REDIRECT to get to the underlying malloc family */
+#ifndef GB_POOL_DO_NOT_REDIRECT
+#define malloc gballoc_malloc
+#define calloc gballoc_calloc
+#define realloc gballoc_realloc
+#define free gballoc_free
+#endif
+
 /* all translation units that need memory measurement need to have GB_MEASURE_MEMORY_FOR_THIS defined */
 /* GB_DEBUG_ALLOC is the switch that turns the measurement on/off, so that it is not on always */
 #elif defined(GB_DEBUG_ALLOC)
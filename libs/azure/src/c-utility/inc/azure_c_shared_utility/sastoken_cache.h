@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef SASTOKEN_CACHE_H
+#define SASTOKEN_CACHE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct SASTOKEN_CACHE_TAG* SASTOKEN_CACHE_HANDLE;
+
+    /* A SAS token generator bound to one key and scope. The key is decoded and the HMAC-SHA256 inner and outer pads are
+       hashed once at create time, and the token lives in a buffer sized at create time, so producing a token does not
+       allocate. A token is reused until it is refresh_interval seconds old; it stays valid for lifetime seconds. */
+    MOCKABLE_FUNCTION(, SASTOKEN_CACHE_HANDLE, SASToken_Cache_Create, const char*, key, const char*, scope, const char*, keyName, size_t, lifetime, size_t, refresh_interval);
+    MOCKABLE_FUNCTION(, void, SASToken_Cache_Destroy, SASTOKEN_CACHE_HANDLE, handle);
+    MOCKABLE_FUNCTION(, const char*, SASToken_Cache_GetToken, SASTOKEN_CACHE_HANDLE, handle);
+    MOCKABLE_FUNCTION(, int, SASToken_Cache_DoWork, SASTOKEN_CACHE_HANDLE, handle);
+    MOCKABLE_FUNCTION(, bool, SASToken_Cache_Matches, SASTOKEN_CACHE_HANDLE, handle, const char*, scope, const char*, keyName, size_t, lifetime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SASTOKEN_CACHE_H */
@@ -44,6 +44,10 @@ extern "C"
 
     static STATIC_VAR_UNUSED const char* const OPTION_TLS_VERSION = "tls_version";
 
+    /* longest time (unsigned int, in ms) xio_dowork waits for incoming data, and most bytes (size_t, 0 for no limit) it reads */
+    static STATIC_VAR_UNUSED const char* const OPTION_RECEIVE_TIMEOUT_MS = "receive_timeout_ms";
+    static STATIC_VAR_UNUSED const char* const OPTION_RECEIVE_BUDGET = "receive_budget";
+
     static STATIC_VAR_UNUSED const char* const OPTION_ADDRESS_TYPE = "ADDRESS_TYPE";
     static STATIC_VAR_UNUSED const char* const OPTION_ADDRESS_TYPE_DOMAIN_SOCKET = "DOMAIN_SOCKET";
     static STATIC_VAR_UNUSED const char* const OPTION_ADDRESS_TYPE_IP_SOCKET = "IP_SOCKET";
@@ -37,6 +37,27 @@ extern "C" {
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_Decode, STRING_HANDLE, input);
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_DecodeString, const char*, textDecode);
 
+    /* @brief   Returns the length of the URL encoding of text, not counting the null terminator,
+    * or 0 if text is NULL.
+    */
+    MOCKABLE_FUNCTION(, size_t, URL_Encoded_Length, const char*, text);
+
+    /* @brief   URL Encode text into destination, which has to hold at least
+    * URL_Encoded_Length(text) + 1 characters. Produces the same encoding as URL_EncodeString
+    * without allocating.
+    *
+    * @return   Returns 0 on success, a non-zero value otherwise.
+    */
+    MOCKABLE_FUNCTION(, int, URL_Encode_To_Buffer, const char*, text, char*, destination, size_t, destinationSize);
+
+    /* @brief   URL Decode text into destination. The decoded string is never longer than text,
+    * so strlen(text) + 1 characters are always enough. Accepts the same input as URL_DecodeString
+    * without allocating.
+    *
+    * @return   Returns 0 on success, a non-zero value otherwise.
+    */
+    MOCKABLE_FUNCTION(, int, URL_Decode_To_Buffer, const char*, text, char*, destination, size_t, destinationSize);
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,9 @@ extern "C" {
 #define RESERVED_2  0x02
 #define RESERVED_3  0x01
 
+/* Largest header RFC6455 allows: 2 bytes, 8 bytes of extended length and 4 bytes of masking key */
+#define UWS_FRAME_ENCODER_MAX_HEADER_SIZE   14
+
 #define WS_FRAME_TYPE_VALUES \
     WS_CONTINUATION_FRAME, \
     WS_TEXT_FRAME, \
@@ -41,6 +44,7 @@ extern "C" {
 DEFINE_ENUM(WS_FRAME_TYPE, WS_FRAME_TYPE_VALUES);
 
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, uws_frame_encoder_encode, WS_FRAME_TYPE, opcode, const unsigned char*, payload, size_t, length, bool, is_masked, bool, is_final, unsigned char, reserved);
+MOCKABLE_FUNCTION(, int, uws_frame_encoder_encode_in_place, WS_FRAME_TYPE, opcode, unsigned char*, frame_buffer, size_t, length, bool, is_masked, bool, is_final, unsigned char, reserved, size_t*, header_length);
 
 #ifdef __cplusplus
 }
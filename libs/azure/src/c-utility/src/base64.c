@@ -5,106 +5,95 @@
 #include "azure_c_shared_utility/gballoc.h"
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
+#define BASE64_INVALID  0xFF
+#define BASE64_PAD      '='
 
-#define splitInt(intVal, bytePos)   (char)((intVal >> (bytePos << 3)) & 0xFF)
-#define joinChars(a, b, c, d) (uint32_t)((uint32_t)a + ((uint32_t)b << 8) + ((uint32_t)c << 16) + ((uint32_t)d << 24))
-
-static char base64char(unsigned char val)
+static const char BASE64_ENCODE_TABLE[64] =
 {
-    char result;
-
-    if (val < 26)
-    {
-        result = 'A' + (char)val;
-    }
-    else if (val < 52)
-    {
-        result = 'a' + ((char)val - 26);
-    }
-    else if (val < 62)
-    {
-        result = '0' + ((char)val - 52);
-    }
-    else if (val == 62)
-    {
-        result = '+';
-    }
-    else
-    {
-        result = '/';
-    }
-
-    return result;
-}
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
 
-static char base64b16(unsigned char val)
+/* 6 bit value of each base64 character, BASE64_INVALID for anything else (including the '=' padding) */
+static const unsigned char BASE64_DECODE_TABLE[256] =
 {
-    const uint32_t base64b16values[4] = {
-        joinChars('A', 'E', 'I', 'M'),
-        joinChars('Q', 'U', 'Y', 'c'),
-        joinChars('g', 'k', 'o', 's'),
-        joinChars('w', '0', '4', '8')
-    };
-    return splitInt(base64b16values[val >> 2], (val & 0x03));
-}
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
 
-static char base64b8(unsigned char val)
-{
-    const uint32_t base64b8values = joinChars('A', 'Q', 'g', 'w');
-    return splitInt(base64b8values, val);
-}
+#define BASE64_VALUE(c) BASE64_DECODE_TABLE[(unsigned char)(c)]
 
-static int base64toValue(char base64character, unsigned char* value)
+/*decodes numberOfEncodedChars base64 characters, which are all known to be valid. Returns the number of bytes written.*/
+static size_t Base64decode(unsigned char* decodedString, const char* base64String, size_t numberOfEncodedChars)
 {
-    int result = 0;
-    if (('A' <= base64character) && (base64character <= 'Z'))
-    {
-        *value = base64character - 'A';
-    }
-    else if (('a' <= base64character) && (base64character <= 'z'))
-    {
-        *value = ('Z' - 'A') + 1 + (base64character - 'a');
-    }
-    else if (('0' <= base64character) && (base64character <= '9'))
-    {
-        *value = ('Z' - 'A') + 1 + ('z' - 'a') + 1 + (base64character - '0');
-    }
-    else if ('+' == base64character)
-    {
-        *value = 62;
-    }
-    else if ('/' == base64character)
-    {
-        *value = 63;
-    }
-    else
+    const unsigned char* source = (const unsigned char*)base64String;
+    unsigned char* destination = decodedString;
+
+    //
+    // We can only operate on individual bytes.  If we attempt to work
+    // on anything larger we could get an alignment fault on some
+    // architectures
+    //
+    while (numberOfEncodedChars >= 4)
     {
-        *value = 0;
-        result = -1;
+        uint32_t quad =
+            ((uint32_t)BASE64_DECODE_TABLE[source[0]] << 18) |
+            ((uint32_t)BASE64_DECODE_TABLE[source[1]] << 12) |
+            ((uint32_t)BASE64_DECODE_TABLE[source[2]] << 6) |
+            (uint32_t)BASE64_DECODE_TABLE[source[3]];
+        destination[0] = (unsigned char)(quad >> 16);
+        destination[1] = (unsigned char)(quad >> 8);
+        destination[2] = (unsigned char)quad;
+        destination += 3;
+        source += 4;
+        numberOfEncodedChars -= 4;
     }
-    return result;
-}
 
-static size_t numberOfBase64Characters(const char* encodedString)
-{
-    size_t length = 0;
-    unsigned char junkChar;
-    while (base64toValue(encodedString[length],&junkChar) != -1)
+    if (numberOfEncodedChars >= 2)
     {
-        length++;
+        uint32_t quad =
+            ((uint32_t)BASE64_DECODE_TABLE[source[0]] << 18) |
+            ((uint32_t)BASE64_DECODE_TABLE[source[1]] << 12);
+        if (numberOfEncodedChars == 3)
+        {
+            quad |= (uint32_t)BASE64_DECODE_TABLE[source[2]] << 6;
+        }
+        *destination++ = (unsigned char)(quad >> 16);
+        if (numberOfEncodedChars == 3)
+        {
+            *destination++ = (unsigned char)(quad >> 8);
+        }
     }
-    return length;
+
+    return (size_t)(destination - decodedString);
 }
 
 /*returns the count of original bytes before being base64 encoded*/
 /*notice NO validation of the content of encodedString. Its length is validated to be a multiple of 4.*/
-static size_t Base64decode_len(const char *encodedString)
+static size_t Base64decode_len(const char* encodedString, size_t sourceLength)
 {
     size_t result;
-    size_t sourceLength = strlen(encodedString);
 
     if (sourceLength == 0)
     {
@@ -113,9 +102,9 @@ static size_t Base64decode_len(const char *encodedString)
     else
     {
         result = sourceLength / 4 * 3;
-        if (encodedString[sourceLength - 1] == '=')
+        if (encodedString[sourceLength - 1] == BASE64_PAD)
         {
-            if (encodedString[sourceLength - 2] == '=')
+            if (encodedString[sourceLength - 2] == BASE64_PAD)
             {
                 result --;
             }
@@ -125,63 +114,79 @@ static size_t Base64decode_len(const char *encodedString)
     return result;
 }
 
-static void Base64decode(unsigned char *decodedString, const char *base64String)
+size_t Base64_Decoded_Length(const char* source)
 {
+    size_t result;
+    size_t sourceLength;
 
-    size_t numberOfEncodedChars;
-    size_t indexOfFirstEncodedChar;
-    size_t decodedIndex;
-
-    //
-    // We can only operate on individual bytes.  If we attempt to work
-    // on anything larger we could get an alignment fault on some
-    // architectures
-    //
-
-    numberOfEncodedChars = numberOfBase64Characters(base64String);
-    indexOfFirstEncodedChar = 0;
-    decodedIndex = 0;
-    while (numberOfEncodedChars >= 4)
+    /*Codes_SRS_BASE64_01_009: [ If source is NULL or its length is not a multiple of 4, Base64_Decoded_Length shall return 0. ]*/
+    if ((source == NULL) ||
+        (((sourceLength = strlen(source)) % 4) != 0))
     {
-        unsigned char c1;
-        unsigned char c2;
-        unsigned char c3;
-        unsigned char c4;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 2], &c3);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 3], &c4);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c2 & 0x0f) << 4) | (c3 >> 2);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c3 & 0x03) << 6) | c4;
-        decodedIndex++;
-        numberOfEncodedChars -= 4;
-        indexOfFirstEncodedChar += 4;
-
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_BASE64_01_010: [ Otherwise Base64_Decoded_Length shall return the number of bytes source decodes to, as given by its length and padding. ]*/
+        result = Base64decode_len(source, sourceLength);
     }
+    return result;
+}
+
+int Base64_Decode_To_Buffer(const char* source, unsigned char* destination, size_t destinationSize, size_t* decodedSize)
+{
+    int result;
 
-    if (numberOfEncodedChars == 2)
+    /*Codes_SRS_BASE64_01_011: [ If source, destination or decodedSize is NULL, Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+    if ((source == NULL) || (destination == NULL) || (decodedSize == NULL))
     {
-        unsigned char c1;
-        unsigned char c2;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
+        LogError("Invalid arguments: source = %p, destination = %p, decodedSize = %p", source, destination, decodedSize);
+        result = __FAILURE__;
     }
-    else if (numberOfEncodedChars == 3)
+    else
     {
-        unsigned char c1;
-        unsigned char c2;
-        unsigned char c3;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 2], &c3);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c2 & 0x0f) << 4) | (c3 >> 2);
+        size_t sourceLength = strlen(source);
+        size_t numberOfEncodedChars = sourceLength;
+        size_t index = 0;
+
+        if ((sourceLength % 4) == 0)
+        {
+            if ((sourceLength > 0) && (source[sourceLength - 1] == BASE64_PAD))
+            {
+                numberOfEncodedChars--;
+                if (source[sourceLength - 2] == BASE64_PAD)
+                {
+                    numberOfEncodedChars--;
+                }
+            }
+
+            while ((index < numberOfEncodedChars) && (BASE64_VALUE(source[index]) != BASE64_INVALID))
+            {
+                index++;
+            }
+        }
+
+        /*Codes_SRS_BASE64_01_012: [ If the length of source is not a multiple of 4, or source contains anything but base64 characters followed by at most 2 '=', Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+        if (((sourceLength % 4) != 0) || (index != numberOfEncodedChars))
+        {
+            LogError("Invalid Base64 string");
+            result = __FAILURE__;
+        }
+        /*Codes_SRS_BASE64_01_013: [ If destinationSize is smaller than the decoded size, Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+        else if (destinationSize < Base64decode_len(source, sourceLength))
+        {
+            LogError("Destination too small: %lu bytes, %lu needed", (unsigned long)destinationSize, (unsigned long)Base64decode_len(source, sourceLength));
+            result = __FAILURE__;
+        }
+        else
+        {
+            /*Codes_SRS_BASE64_01_014: [ Otherwise Base64_Decode_To_Buffer shall decode source into destination, set decodedSize to the number of bytes written and return 0. ]*/
+            *decodedSize = Base64decode(destination, source, numberOfEncodedChars);
+            result = 0;
+        }
     }
+
+    return result;
 }
 
 BUFFER_HANDLE Base64_Decoder(const char* source)
@@ -195,7 +200,8 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
     }
     else
     {
-        if ((strlen(source) % 4) != 0)
+        size_t sourceLength = strlen(source);
+        if ((sourceLength % 4) != 0)
         {
             /*Codes_SRS_BASE64_06_011: [If the source string has an invalid length for a base 64 encoded string then Base64_Decode shall return NULL.]*/
             LogError("Invalid length Base64 string!");
@@ -210,7 +216,7 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
             }
             else
             {
-                size_t sizeOfOutputBuffer = Base64decode_len(source);
+                size_t sizeOfOutputBuffer = Base64decode_len(source, sourceLength);
                 /*Codes_SRS_BASE64_06_009: [If the string pointed to by source is zero length then the handle returned shall refer to a zero length buffer.]*/
                 if (sizeOfOutputBuffer > 0)
                 {
@@ -223,7 +229,13 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
                     }
                     else
                     {
-                        Base64decode(BUFFER_u_char(result), source);
+                        /*decoding stops at the first character that is not base64 (normally the padding)*/
+                        size_t numberOfEncodedChars = 0;
+                        while (BASE64_VALUE(source[numberOfEncodedChars]) != BASE64_INVALID)
+                        {
+                            numberOfEncodedChars++;
+                        }
+                        (void)Base64decode(BUFFER_u_char(result), source, numberOfEncodedChars);
                     }
                 }
             }
@@ -232,21 +244,27 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
     return result;
 }
 
+size_t Base64_Encoded_Length(size_t size)
+{
+    /*Codes_SRS_BASE64_01_001: [ Base64_Encoded_Length shall return the number of characters in the base64 encoding of size bytes, not counting the null terminator. ]*/
+    return (size == 0) ? (0) : ((((size - 1) / 3) + 1) * 4);
+}
 
-static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t size)
+int Base64_Encode_To_Buffer(const unsigned char* source, size_t size, char* destination, size_t destinationSize)
 {
-    STRING_HANDLE result;
-    size_t neededSize = 0;
-    char* encoded;
-    size_t currentPosition = 0;
-    neededSize += (size == 0) ? (0) : ((((size - 1) / 3) + 1) * 4);
-    neededSize += 1; /*+1 because \0 at the end of the string*/
-    /*Codes_SRS_BASE64_06_006: [If when allocating memory to produce the encoding a failure occurs then Base64_Encoder shall return NULL.]*/
-    encoded = (char*)malloc(neededSize);
-    if (encoded == NULL)
+    int result;
+
+    /*Codes_SRS_BASE64_01_002: [ If destination is NULL, or source is NULL and size is not 0, Base64_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+    if (((source == NULL) && (size > 0)) || (destination == NULL))
     {
-        result = NULL;
-        LogError("Base64_Encoder:: Allocation failed.");
+        LogError("Invalid arguments: source = %p, destination = %p", source, destination);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_BASE64_01_003: [ If destinationSize is smaller than Base64_Encoded_Length(size) + 1, Base64_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+    else if (destinationSize < Base64_Encoded_Length(size) + 1)
+    {
+        LogError("Destination too small: %lu bytes, %lu needed", (unsigned long)destinationSize, (unsigned long)(Base64_Encoded_Length(size) + 1));
+        result = __FAILURE__;
     }
     else
     {
@@ -254,54 +272,64 @@ static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t
         7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
         |----c1---| |----c2---| |----c3---| |----c4---|
         */
+        const unsigned char* end = source + (size - (size % 3));
+        char* encoded = destination;
 
-        size_t destinationPosition = 0;
-        while (size - currentPosition >= 3)
+        /*Codes_SRS_BASE64_01_004: [ Base64_Encode_To_Buffer shall write the base64 encoding of the size bytes at source to destination, '=' padded and null terminated, and return 0. ]*/
+        while (source < end)
         {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 3) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64char(
-                ((source[currentPosition + 1] & 0x0F) << 2) |
-                    ((source[currentPosition + 2] >> 6) & 3)
-            );
-            char c4 = base64char(
-                source[currentPosition + 2] & 0x3F
-            );
-            currentPosition += 3;
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = c4;
-
+            uint32_t triple = ((uint32_t)source[0] << 16) | ((uint32_t)source[1] << 8) | (uint32_t)source[2];
+            encoded[0] = BASE64_ENCODE_TABLE[triple >> 18];
+            encoded[1] = BASE64_ENCODE_TABLE[(triple >> 12) & 0x3F];
+            encoded[2] = BASE64_ENCODE_TABLE[(triple >> 6) & 0x3F];
+            encoded[3] = BASE64_ENCODE_TABLE[triple & 0x3F];
+            source += 3;
+            encoded += 4;
         }
-        if (size - currentPosition == 2)
+
+        if ((size % 3) == 2)
         {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 0x03) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64b16(source[currentPosition + 1] & 0x0F);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = '=';
+            uint32_t triple = ((uint32_t)source[0] << 16) | ((uint32_t)source[1] << 8);
+            encoded[0] = BASE64_ENCODE_TABLE[triple >> 18];
+            encoded[1] = BASE64_ENCODE_TABLE[(triple >> 12) & 0x3F];
+            encoded[2] = BASE64_ENCODE_TABLE[(triple >> 6) & 0x3F];
+            encoded[3] = BASE64_PAD;
+            encoded += 4;
         }
-        else if (size - currentPosition == 1)
+        else if ((size % 3) == 1)
         {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64b8(source[currentPosition] & 0x03);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = '=';
-            encoded[destinationPosition++] = '=';
+            uint32_t triple = (uint32_t)source[0] << 16;
+            encoded[0] = BASE64_ENCODE_TABLE[triple >> 18];
+            encoded[1] = BASE64_ENCODE_TABLE[(triple >> 12) & 0x3F];
+            encoded[2] = BASE64_PAD;
+            encoded[3] = BASE64_PAD;
+            encoded += 4;
         }
 
         /*null terminating the string*/
-        encoded[destinationPosition] = '\0';
+        *encoded = '\0';
+        result = 0;
+    }
+
+    return result;
+}
+
+static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t size)
+{
+    STRING_HANDLE result;
+    size_t neededSize = Base64_Encoded_Length(size) + 1; /*+1 because \0 at the end of the string*/
+    char* encoded;
+    /*Codes_SRS_BASE64_06_006: [If when allocating memory to produce the encoding a failure occurs then Base64_Encoder shall return NULL.]*/
+    encoded = (char*)malloc(neededSize);
+    if (encoded == NULL)
+    {
+        result = NULL;
+        LogError("Base64_Encoder:: Allocation failed.");
+    }
+    else
+    {
+        (void)Base64_Encode_To_Buffer(source, size, encoded, neededSize);
+
         /*Codes_SRS_BASE64_06_007: [Otherwise Base64_Encoder shall return a pointer to STRING, that string contains the base 64 encoding of input.]*/
         result = STRING_new_with_memory(encoded);
         if (result == NULL)
@@ -14,8 +14,15 @@ typedef struct BUFFER_TAG
 {
     unsigned char* buffer;
     size_t size;
+    /*allocation is NULL unless BUFFER_reserve or BUFFER_prepend_build was called, in which case buffer points inside allocation*/
+    unsigned char* allocation;
+    size_t capacity;
 } BUFFER;
 
+#define BUFFER_IS_RESERVED(b) ((b)->allocation != NULL)
+#define BUFFER_HEADROOM(b) ((size_t)((b)->buffer - (b)->allocation))
+#define BUFFER_TAILROOM(b) ((b)->capacity - BUFFER_HEADROOM(b) - (b)->size)
+
 /* Codes_SRS_BUFFER_07_001: [BUFFER_new shall allocate a BUFFER_HANDLE that will contain a NULL unsigned char*.] */
 BUFFER_HANDLE BUFFER_new(void)
 {
@@ -25,6 +32,8 @@ BUFFER_HANDLE BUFFER_new(void)
     {
         temp->buffer = NULL;
         temp->size = 0;
+        temp->allocation = NULL;
+        temp->capacity = 0;
     }
     return (BUFFER_HANDLE)temp;
 }
@@ -48,11 +57,88 @@ static int BUFFER_safemalloc(BUFFER* handleptr, size_t size)
     {
         // we still consider the real buffer size is 0
         handleptr->size = size;
+        handleptr->allocation = NULL;
+        handleptr->capacity = 0;
         result = 0;
     }
     return result;
 }
 
+/*makes sure there are at least headroom bytes in front of and tailroom bytes after the content, switching the buffer into reserved mode if needed*/
+/*growth is geometric so that repeated appends/prepends are amortized O(1)*/
+static int BUFFER_ensure_room(BUFFER* b, size_t headroom, size_t tailroom)
+{
+    int result;
+    size_t currentHeadroom = BUFFER_IS_RESERVED(b) ? BUFFER_HEADROOM(b) : 0;
+    size_t currentTailroom = BUFFER_IS_RESERVED(b) ? BUFFER_TAILROOM(b) : 0;
+
+    if (BUFFER_IS_RESERVED(b) && (currentHeadroom >= headroom) && (currentTailroom >= tailroom))
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newHeadroom = (currentHeadroom > headroom) ? currentHeadroom : headroom;
+        size_t neededTailroom = (currentTailroom > tailroom) ? currentTailroom : tailroom;
+        size_t newCapacity = newHeadroom + b->size + neededTailroom;
+        unsigned char* newAllocation;
+
+        if ((newCapacity < b->size) || (newCapacity < newHeadroom))
+        {
+            LogError("Failure: requested capacity overflows size_t.");
+            newAllocation = NULL;
+        }
+        else
+        {
+            if (BUFFER_IS_RESERVED(b) && (newCapacity < b->capacity * 2) && (b->capacity * 2 > b->capacity))
+            {
+                newCapacity = b->capacity * 2;
+            }
+            if (newCapacity == 0)
+            {
+                newCapacity = 1;
+            }
+
+            if (BUFFER_IS_RESERVED(b) && (newHeadroom == currentHeadroom))
+            {
+                /*content does not move inside the allocation, so realloc can keep it in place*/
+                newAllocation = (unsigned char*)realloc(b->allocation, newCapacity);
+                if (newAllocation != NULL)
+                {
+                    b->allocation = newAllocation;
+                    b->buffer = newAllocation + newHeadroom;
+                }
+            }
+            else
+            {
+                newAllocation = (unsigned char*)malloc(newCapacity);
+                if (newAllocation != NULL)
+                {
+                    if (b->size > 0)
+                    {
+                        (void)memcpy(newAllocation + newHeadroom, b->buffer, b->size);
+                    }
+                    free(BUFFER_IS_RESERVED(b) ? b->allocation : b->buffer);
+                    b->allocation = newAllocation;
+                    b->buffer = newAllocation + newHeadroom;
+                }
+            }
+        }
+
+        if (newAllocation == NULL)
+        {
+            LogError("Failure: allocating reserved buffer.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            b->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
 BUFFER_HANDLE BUFFER_create(const unsigned char* source, size_t size)
 {
     BUFFER* result;
@@ -98,7 +184,12 @@ void BUFFER_delete(BUFFER_HANDLE handle)
     if (handle != NULL)
     {
         BUFFER* b = (BUFFER*)handle;
-        if (b->buffer != NULL)
+        if (BUFFER_IS_RESERVED(b))
+        {
+            /* Codes_SRS_BUFFER_01_020: [ If the buffer is in reserved mode, BUFFER_delete shall free the whole reserved allocation. ]*/
+            free(b->allocation);
+        }
+        else if (b->buffer != NULL)
         {
             /* Codes_SRS_BUFFER_07_003: [BUFFER_delete shall delete the data associated with the BUFFER_HANDLE along with the Buffer.] */
             free(b->buffer);
@@ -123,9 +214,17 @@ int BUFFER_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size)
     {
         /* Codes_SRS_BUFFER_01_003: [If size is zero, source can be NULL.] */
         BUFFER* b = (BUFFER*)handle;
-        free(b->buffer);
-        b->buffer = NULL;
-        b->size = 0;
+        if (BUFFER_IS_RESERVED(b))
+        {
+            /* Codes_SRS_BUFFER_01_021: [ If the buffer is in reserved mode, BUFFER_build with size 0 shall keep the reserved storage and only set the size to 0. ]*/
+            b->size = 0;
+        }
+        else
+        {
+            free(b->buffer);
+            b->buffer = NULL;
+            b->size = 0;
+        }
 
         result = 0;
     }
@@ -136,6 +235,26 @@ int BUFFER_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size)
             /* Codes_SRS_BUFFER_01_001: [If size is positive and source is NULL, BUFFER_build shall return nonzero] */
             result = __FAILURE__;
         }
+        else if (BUFFER_IS_RESERVED(handle))
+        {
+            BUFFER* b = (BUFFER*)handle;
+            size_t previousSize = b->size;
+            /* Codes_SRS_BUFFER_01_022: [ If the buffer is in reserved mode, BUFFER_build shall reuse the reserved storage, growing it only when size exceeds the room after the headroom. ]*/
+            /*the previous content is overwritten, so there is no point in moving it around while growing*/
+            b->size = 0;
+            if (BUFFER_ensure_room(b, 0, size) != 0)
+            {
+                LogError("Failure growing reserved buffer");
+                b->size = previousSize;
+                result = __FAILURE__;
+            }
+            else
+            {
+                (void)memcpy(b->buffer, source, size);
+                b->size = size;
+                result = 0;
+            }
+        }
         else
         {
             BUFFER* b = (BUFFER*)handle;
@@ -171,6 +290,21 @@ int BUFFER_append_build(BUFFER_HANDLE handle, const unsigned char* source, size_
         LogError("BUFFER_append_build failed invalid parameter handle: %p, source: %p, size: %lu", handle, source, (unsigned long)size);
         result = __FAILURE__;
     }
+    else if (BUFFER_IS_RESERVED(handle))
+    {
+        /* Codes_SRS_BUFFER_01_023: [ If the buffer is in reserved mode, BUFFER_append_build shall copy source into the tailroom, growing the storage geometrically when the tailroom is too small. ]*/
+        if (BUFFER_ensure_room(handle, 0, size) != 0)
+        {
+            LogError("Failure growing reserved buffer");
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memcpy(&handle->buffer[handle->size], source, size);
+            handle->size += size;
+            result = 0;
+        }
+    }
     else
     {
         if (handle->buffer == NULL)
@@ -234,7 +368,21 @@ int BUFFER_pre_build(BUFFER_HANDLE handle, size_t size)
     else
     {
         BUFFER* b = (BUFFER*)handle;
-        if (b->buffer != NULL)
+        if (BUFFER_IS_RESERVED(b) && (b->size == 0))
+        {
+            /* Codes_SRS_BUFFER_01_024: [ If the buffer is in reserved mode and empty, BUFFER_pre_build shall use the reserved storage, growing it if needed. ]*/
+            if (BUFFER_ensure_room(b, 0, size) != 0)
+            {
+                LogError("Failure growing reserved buffer");
+                result = __FAILURE__;
+            }
+            else
+            {
+                b->size = size;
+                result = 0;
+            }
+        }
+        else if (b->buffer != NULL)
         {
             /* Codes_SRS_BUFFER_07_007: [BUFFER_pre_build shall return nonzero if the buffer has been previously allocated and is not NULL.] */
             LogError("Failure buffer data is NULL");
@@ -289,7 +437,17 @@ extern int BUFFER_unbuild(BUFFER_HANDLE handle)
     else
     {
         BUFFER* b = (BUFFER*)handle;
-        if (b->buffer != NULL)
+        if (BUFFER_IS_RESERVED(b))
+        {
+            /* Codes_SRS_BUFFER_01_025: [ If the buffer is in reserved mode, BUFFER_unbuild shall free the reserved storage and return the buffer to its unallocated state. ]*/
+            free(b->allocation);
+            b->allocation = NULL;
+            b->capacity = 0;
+            b->buffer = NULL;
+            b->size = 0;
+            result = 0;
+        }
+        else if (b->buffer != NULL)
         {
             LogError("Failure buffer data is NULL");
             free(b->buffer);
@@ -322,6 +480,20 @@ int BUFFER_enlarge(BUFFER_HANDLE handle, size_t enlargeSize)
         LogError("Failure: enlargeSize size is 0.");
         result = __FAILURE__;
     }
+    else if (BUFFER_IS_RESERVED(handle))
+    {
+        /* Codes_SRS_BUFFER_01_026: [ If the buffer is in reserved mode, BUFFER_enlarge shall use the tailroom, growing the storage geometrically when the tailroom is too small. ]*/
+        if (BUFFER_ensure_room(handle, 0, enlargeSize) != 0)
+        {
+            LogError("Failure growing reserved buffer");
+            result = __FAILURE__;
+        }
+        else
+        {
+            handle->size += enlargeSize;
+            result = 0;
+        }
+    }
     else
     {
         BUFFER* b = (BUFFER*)handle;
@@ -363,6 +535,16 @@ int BUFFER_shrink(BUFFER_HANDLE handle, size_t decreaseSize, bool fromEnd)
         LogError("Failure: decrease size is less than buffer size.");
         result = __FAILURE__;
     }
+    else if (BUFFER_IS_RESERVED(handle))
+    {
+        /* Codes_SRS_BUFFER_01_027: [ If the buffer is in reserved mode, BUFFER_shrink shall only move the content boundaries; removed bytes at the beginning become headroom and removed bytes at the end become tailroom. ]*/
+        if (!fromEnd)
+        {
+            handle->buffer += decreaseSize;
+        }
+        handle->size -= decreaseSize;
+        result = 0;
+    }
     else
     {
         /* Codes_SRS_BUFFER_07_039: [ BUFFER_shrink shall allocate a temporary buffer of existing buffer size minus decreaseSize. ] */
@@ -458,6 +640,21 @@ int BUFFER_append(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2)
                 // b2->size = 0, whatever b1->size is, do nothing
                 result = 0;
             }
+            else if (BUFFER_IS_RESERVED(b1))
+            {
+                /* Codes_SRS_BUFFER_01_028: [ If handle1 is in reserved mode, BUFFER_append shall copy b2 into the tailroom of handle1, growing it geometrically when needed. ]*/
+                if (BUFFER_ensure_room(b1, 0, b2->size) != 0)
+                {
+                    LogError("Failure growing reserved buffer");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    (void)memcpy(&b1->buffer[b1->size], b2->buffer, b2->size);
+                    b1->size += b2->size;
+                    result = 0;
+                }
+            }
             else
             {
                 // b2->size != 0, whatever b1->size is
@@ -513,6 +710,19 @@ int BUFFER_prepend(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2)
                 // do nothing
                 result = 0;
             }
+            else if (BUFFER_IS_RESERVED(b1))
+            {
+                /* Codes_SRS_BUFFER_01_029: [ If handle1 is in reserved mode, BUFFER_prepend shall copy b2 into the headroom of handle1 without moving the existing content when the headroom is large enough. ]*/
+                if (BUFFER_prepend_build(handle1, b2->buffer, b2->size) != 0)
+                {
+                    LogError("Failure prepending into reserved buffer");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+            }
             else
             {
                 // b2->size != 0
@@ -541,6 +751,87 @@ int BUFFER_prepend(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2)
     return result;
 }
 
+int BUFFER_reserve(BUFFER_HANDLE handle, size_t headroom, size_t capacity)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_BUFFER_01_030: [ If handle is NULL, BUFFER_reserve shall return a non-zero value. ]*/
+        LogError("Invalid parameter specified, handle == NULL.");
+        result = __FAILURE__;
+    }
+    else if ((headroom == 0) && (capacity == 0))
+    {
+        /* Codes_SRS_BUFFER_01_031: [ If both headroom and capacity are 0, BUFFER_reserve shall return a non-zero value. ]*/
+        LogError("Invalid parameter specified, headroom and capacity are both 0.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_BUFFER_01_032: [ BUFFER_reserve shall make sure that at least headroom bytes are available in front of the content and that the content can grow to capacity bytes without reallocating. ]*/
+        /* Codes_SRS_BUFFER_01_033: [ Existing content shall be preserved. ]*/
+        size_t tailroom = (capacity > handle->size) ? (capacity - handle->size) : 0;
+        if (BUFFER_ensure_room(handle, headroom, tailroom) != 0)
+        {
+            /* Codes_SRS_BUFFER_01_034: [ If allocating memory fails, BUFFER_reserve shall return a non-zero value and leave the buffer unchanged. ]*/
+            LogError("Failure reserving buffer storage");
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_BUFFER_01_035: [ On success, BUFFER_reserve shall return 0. ]*/
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int BUFFER_prepend_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size)
+{
+    int result;
+    if (handle == NULL || source == NULL || size == 0)
+    {
+        /* Codes_SRS_BUFFER_01_036: [ If handle or source are NULL or if size is 0, BUFFER_prepend_build shall return a non-zero value. ]*/
+        LogError("BUFFER_prepend_build failed invalid parameter handle: %p, source: %p, size: %lu", handle, source, (unsigned long)size);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_BUFFER_01_037: [ If the headroom is smaller than size, BUFFER_prepend_build shall grow the headroom first, switching the buffer into reserved mode if needed. ]*/
+    else if (BUFFER_ensure_room(handle, size, 0) != 0)
+    {
+        /* Codes_SRS_BUFFER_01_038: [ If allocating memory fails, BUFFER_prepend_build shall return a non-zero value. ]*/
+        LogError("Failure growing buffer headroom");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_BUFFER_01_039: [ BUFFER_prepend_build shall copy size bytes from source right in front of the existing content and return 0. ]*/
+        handle->buffer -= size;
+        handle->size += size;
+        (void)memcpy(handle->buffer, source, size);
+        result = 0;
+    }
+    return result;
+}
+
+int BUFFER_get_segment(BUFFER_HANDLE handle, BUFFER_SEGMENT* segment)
+{
+    int result;
+    if ((handle == NULL) || (segment == NULL))
+    {
+        /* Codes_SRS_BUFFER_01_040: [ If handle or segment are NULL, BUFFER_get_segment shall return a non-zero value. ]*/
+        LogError("Invalid parameter specified, handle: %p, segment: %p.", handle, segment);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_BUFFER_01_041: [ BUFFER_get_segment shall fill segment with a pointer to the content and its length, without copying. ]*/
+        segment->data = (handle->size == 0) ? NULL : handle->buffer;
+        segment->size = handle->size;
+        result = 0;
+    }
+    return result;
+}
+
 int BUFFER_fill(BUFFER_HANDLE handle, unsigned char fill_char)
 {
     int result;
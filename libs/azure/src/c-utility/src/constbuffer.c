@@ -12,6 +12,8 @@ typedef struct CONSTBUFFER_HANDLE_DATA_TAG
 {
     CONSTBUFFER alias;
     COUNT_TYPE count;
+    CONSTBUFFER_CUSTOM_FREE_FUNC custom_free_func;
+    void* custom_free_func_context;
 } CONSTBUFFER_HANDLE_DATA;
 
 static CONSTBUFFER_HANDLE CONSTBUFFER_Create_Internal(const unsigned char* source, size_t size)
@@ -30,6 +32,8 @@ static CONSTBUFFER_HANDLE CONSTBUFFER_Create_Internal(const unsigned char* sourc
     else
     {
         INIT_REF_VAR(result->count);
+        result->custom_free_func = NULL;
+        result->custom_free_func_context = NULL;
 
         /*Codes_SRS_CONSTBUFFER_02_002: [Otherwise, CONSTBUFFER_Create shall create a copy of the memory area pointed to by source having size bytes.]*/
         result->alias.size = size;
@@ -88,6 +92,40 @@ CONSTBUFFER_HANDLE CONSTBUFFER_CreateFromBuffer(BUFFER_HANDLE buffer)
     return result;
 }
 
+CONSTBUFFER_HANDLE CONSTBUFFER_CreateWithCustomFree(const unsigned char* source, size_t size, CONSTBUFFER_CUSTOM_FREE_FUNC customFreeFunc, void* customFreeFuncContext)
+{
+    CONSTBUFFER_HANDLE result;
+    /*Codes_SRS_CONSTBUFFER_01_001: [ If source is NULL and size is different than 0 then CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+    if (
+        (source == NULL) &&
+        (size != 0)
+        )
+    {
+        LogError("invalid arguments passes to CONSTBUFFER_CreateWithCustomFree");
+        result = NULL;
+    }
+    else
+    {
+        result = (CONSTBUFFER_HANDLE)malloc(sizeof(CONSTBUFFER_HANDLE_DATA));
+        if (result == NULL)
+        {
+            /*Codes_SRS_CONSTBUFFER_01_002: [ If allocating the handle fails then CONSTBUFFER_CreateWithCustomFree shall return NULL and shall not call customFreeFunc. ]*/
+            LogError("unable to malloc");
+        }
+        else
+        {
+            /*Codes_SRS_CONSTBUFFER_01_003: [ Otherwise CONSTBUFFER_CreateWithCustomFree shall return a non-NULL handle whose content is source and size, without copying the memory area. ]*/
+            /*Codes_SRS_CONSTBUFFER_01_004: [ The non-NULL handle returned by CONSTBUFFER_CreateWithCustomFree shall have its ref count set to "1". ]*/
+            INIT_REF_VAR(result->count);
+            result->alias.buffer = (size == 0) ? NULL : source;
+            result->alias.size = size;
+            result->custom_free_func = customFreeFunc;
+            result->custom_free_func_context = customFreeFuncContext;
+        }
+    }
+    return result;
+}
+
 CONSTBUFFER_HANDLE CONSTBUFFER_Clone(CONSTBUFFER_HANDLE constbufferHandle)
 {
     if (constbufferHandle == NULL)
@@ -129,6 +167,11 @@ void CONSTBUFFER_Destroy(CONSTBUFFER_HANDLE constbufferHandle)
         if (DEC_REF_VAR(constbufferHandle->count) == DEC_RETURN_ZERO)
         {
             /*Codes_SRS_CONSTBUFFER_02_017: [If the refcount reaches zero, then CONSTBUFFER_Destroy shall deallocate all resources used by the CONSTBUFFER_HANDLE.]*/
+            if (constbufferHandle->custom_free_func != NULL)
+            {
+                /*Codes_SRS_CONSTBUFFER_01_005: [ If the refcount reaches zero and the handle was created by CONSTBUFFER_CreateWithCustomFree with a non-NULL customFreeFunc, CONSTBUFFER_Destroy shall call customFreeFunc with customFreeFuncContext. ]*/
+                constbufferHandle->custom_free_func(constbufferHandle->custom_free_func_context);
+            }
             free(constbufferHandle);
         }
     }
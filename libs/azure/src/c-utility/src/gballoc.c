@@ -9,7 +9,7 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
-#ifndef GB_USE_CUSTOM_HEAP
+#if !defined(GB_USE_CUSTOM_HEAP) && !defined(GB_USE_POOL_HEAP)
 
 #ifndef SIZE_MAX
 #define SIZE_MAX ((size_t)~(size_t)0)
@@ -443,4 +443,4 @@ void gballoc_resetMetrics()
     }
 }
 
-#endif // GB_USE_CUSTOM_HEAP
+#endif // !GB_USE_CUSTOM_HEAP && !GB_USE_POOL_HEAP
@@ -0,0 +1,679 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef GB_USE_POOL_HEAP
+
+#ifndef GB_POOL_DO_NOT_REDIRECT
+#define GB_POOL_DO_NOT_REDIRECT
+#endif
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)~(size_t)0)
+#endif
+
+/* upper bound on the number of slabs a size class may grab; once reached, requests of that class go to the fallback heap */
+#ifndef GB_POOL_MAX_SLABS_PER_CLASS
+#define GB_POOL_MAX_SLABS_PER_CLASS 8
+#endif
+
+#define GB_POOL_MAGIC 0x9BA1
+
+/* every block (pooled or not) is preceded by this header, which tells gballoc_free where the block came from */
+typedef union GBALLOC_POOL_HEADER_TAG
+{
+    struct
+    {
+        size_t size;
+        unsigned short class_index;
+        unsigned short magic;
+    } info;
+    /* forces the payload that follows the header to be suitably aligned */
+    long long align_long_long;
+    double align_double;
+    void* align_pointer;
+} GBALLOC_POOL_HEADER;
+
+typedef struct GBALLOC_POOL_FREE_BLOCK_TAG
+{
+    struct GBALLOC_POOL_FREE_BLOCK_TAG* next;
+} GBALLOC_POOL_FREE_BLOCK;
+
+typedef struct GBALLOC_POOL_CLASS_TAG
+{
+    size_t block_size;
+    size_t blocks_per_slab;
+    GBALLOC_POOL_FREE_BLOCK* free_list;
+    void* slabs[GB_POOL_MAX_SLABS_PER_CLASS];
+    size_t slab_count;
+    size_t live;
+    size_t peak;
+    size_t failures;
+} GBALLOC_POOL_CLASS;
+
+typedef enum GBALLOC_STATE_TAG
+{
+    GBALLOC_STATE_INIT,
+    GBALLOC_STATE_NOT_INIT
+} GBALLOC_STATE;
+
+/* the sizes cover the small objects the client churns through per message: list entries, STRING and BUFFER handles, map and property entries */
+static GBALLOC_POOL_CLASS poolClasses[] =
+{
+    { 16, 32, NULL, { NULL }, 0, 0, 0, 0 },
+    { 32, 32, NULL, { NULL }, 0, 0, 0, 0 },
+    { 64, 16, NULL, { NULL }, 0, 0, 0, 0 },
+    { 128, 8, NULL, { NULL }, 0, 0, 0, 0 },
+    { 256, 4, NULL, { NULL }, 0, 0, 0, 0 }
+};
+
+#define POOL_CLASS_COUNT (sizeof(poolClasses) / sizeof(poolClasses[0]))
+#define FALLBACK_CLASS_INDEX POOL_CLASS_COUNT
+
+static size_t fallbackLive = 0;
+static size_t fallbackPeak = 0;
+static size_t fallbackFailures = 0;
+static size_t fallbackBytes = 0;
+
+static size_t totalSize = 0;
+static size_t maxSize = 0;
+static size_t g_allocations = 0;
+static GBALLOC_STATE gballocState = GBALLOC_STATE_NOT_INIT;
+
+static LOCK_HANDLE gballocThreadSafeLock = NULL;
+
+static int lock_pool(void)
+{
+    int result;
+    /* before gballoc_init the pool still works, but without a lock (startup is single threaded) */
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        result = 0;
+    }
+    else if (Lock(gballocThreadSafeLock) != LOCK_OK)
+    {
+        LogError("Failed to get the Lock.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static void unlock_pool(void)
+{
+    if (gballocState == GBALLOC_STATE_INIT)
+    {
+        (void)Unlock(gballocThreadSafeLock);
+    }
+}
+
+static void count_allocation(size_t size)
+{
+    g_allocations++;
+    totalSize += size;
+    if (maxSize < totalSize)
+    {
+        maxSize = totalSize;
+    }
+}
+
+static int add_slab(GBALLOC_POOL_CLASS* poolClass)
+{
+    int result;
+    size_t stride = sizeof(GBALLOC_POOL_HEADER) + poolClass->block_size;
+
+    if (poolClass->slab_count >= GB_POOL_MAX_SLABS_PER_CLASS)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        unsigned char* slab = (unsigned char*)malloc(stride * poolClass->blocks_per_slab);
+        if (slab == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            /* thread the blocks onto the free list back to front so they are handed out in address order */
+            for (i = poolClass->blocks_per_slab; i > 0; i--)
+            {
+                GBALLOC_POOL_FREE_BLOCK* block = (GBALLOC_POOL_FREE_BLOCK*)(slab + ((i - 1) * stride) + sizeof(GBALLOC_POOL_HEADER));
+                block->next = poolClass->free_list;
+                poolClass->free_list = block;
+            }
+            poolClass->slabs[poolClass->slab_count++] = slab;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+/* called with the lock held */
+static void* pool_allocate(size_t size)
+{
+    void* result = NULL;
+    size_t class_index;
+
+    for (class_index = 0; class_index < POOL_CLASS_COUNT; class_index++)
+    {
+        if (size <= poolClasses[class_index].block_size)
+        {
+            break;
+        }
+    }
+
+    if (class_index < POOL_CLASS_COUNT)
+    {
+        GBALLOC_POOL_CLASS* poolClass = &poolClasses[class_index];
+        if ((poolClass->free_list != NULL) || (add_slab(poolClass) == 0))
+        {
+            GBALLOC_POOL_FREE_BLOCK* block = poolClass->free_list;
+            GBALLOC_POOL_HEADER* header = ((GBALLOC_POOL_HEADER*)block) - 1;
+            poolClass->free_list = block->next;
+
+            header->info.size = size;
+            header->info.class_index = (unsigned short)class_index;
+            header->info.magic = GB_POOL_MAGIC;
+
+            poolClass->live++;
+            if (poolClass->peak < poolClass->live)
+            {
+                poolClass->peak = poolClass->live;
+            }
+            result = block;
+        }
+        else
+        {
+            /* the class is exhausted: fall through to the fallback heap and remember it */
+            poolClass->failures++;
+        }
+    }
+
+    if (result == NULL)
+    {
+        GBALLOC_POOL_HEADER* header;
+        if (size > SIZE_MAX - sizeof(GBALLOC_POOL_HEADER))
+        {
+            header = NULL;
+        }
+        else
+        {
+            header = (GBALLOC_POOL_HEADER*)malloc(sizeof(GBALLOC_POOL_HEADER) + size);
+        }
+
+        if (header == NULL)
+        {
+            fallbackFailures++;
+        }
+        else
+        {
+            header->info.size = size;
+            header->info.class_index = (unsigned short)FALLBACK_CLASS_INDEX;
+            header->info.magic = GB_POOL_MAGIC;
+
+            fallbackLive++;
+            fallbackBytes += size;
+            if (fallbackPeak < fallbackLive)
+            {
+                fallbackPeak = fallbackLive;
+            }
+            result = header + 1;
+        }
+    }
+
+    if (result != NULL)
+    {
+        count_allocation(size);
+    }
+
+    return result;
+}
+
+/* called with the lock held, tells whether header starts one of the blocks of the slabs of poolClass */
+static bool is_block_of_class(const GBALLOC_POOL_CLASS* poolClass, const GBALLOC_POOL_HEADER* header)
+{
+    bool result = false;
+    size_t stride = sizeof(GBALLOC_POOL_HEADER) + poolClass->block_size;
+    size_t i;
+
+    for (i = 0; (result == false) && (i < poolClass->slab_count); i++)
+    {
+        const unsigned char* slab = (const unsigned char*)poolClass->slabs[i];
+        if (((const unsigned char*)header >= slab) && ((const unsigned char*)header < slab + (stride * poolClass->blocks_per_slab)))
+        {
+            result = ((((const unsigned char*)header - slab) % stride) == 0);
+        }
+    }
+    return result;
+}
+
+/* called with the lock held, returns NULL if ptr was not allocated by this module */
+static GBALLOC_POOL_HEADER* get_header(void* ptr)
+{
+    GBALLOC_POOL_HEADER* result = ((GBALLOC_POOL_HEADER*)ptr) - 1;
+    if ((result->info.magic != GB_POOL_MAGIC) || (result->info.class_index > FALLBACK_CLASS_INDEX))
+    {
+        result = NULL;
+    }
+    /* the magic alone can be matched by chance, a pooled block must also sit in one of the slabs of its class */
+    else if ((result->info.class_index != FALLBACK_CLASS_INDEX) && !is_block_of_class(&poolClasses[result->info.class_index], result))
+    {
+        result = NULL;
+    }
+    return result;
+}
+
+/* called with the lock held */
+static void pool_release(GBALLOC_POOL_HEADER* header)
+{
+    totalSize -= header->info.size;
+    header->info.magic = 0;
+
+    if (header->info.class_index == FALLBACK_CLASS_INDEX)
+    {
+        fallbackLive--;
+        fallbackBytes -= header->info.size;
+        free(header);
+    }
+    else
+    {
+        GBALLOC_POOL_CLASS* poolClass = &poolClasses[header->info.class_index];
+        GBALLOC_POOL_FREE_BLOCK* block = (GBALLOC_POOL_FREE_BLOCK*)(header + 1);
+        block->next = poolClass->free_list;
+        poolClass->free_list = block;
+        poolClass->live--;
+    }
+}
+
+int gballoc_init(void)
+{
+    int result;
+
+    if (gballocState != GBALLOC_STATE_NOT_INIT)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_001: [ Init after Init shall fail and return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_GBALLOC_POOL_01_002: [ gballoc_init shall create a lock handle that will be used to make the other gballoc APIs thread-safe. ]*/
+    else if ((gballocThreadSafeLock = Lock_Init()) == NULL)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_003: [ If the Lock creation fails, gballoc_init shall return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        gballocState = GBALLOC_STATE_INIT;
+
+        /* Codes_SRS_GBALLOC_POOL_01_004: [ gballoc_init shall reset the maximum memory used to the memory used by the live blocks, the allocation count to zero, the per class peaks to the current live counts and the failures to zero. ]*/
+        /* blocks allocated before init stay valid, totalSize keeps accounting for them so that freeing them later does not underflow */
+        maxSize = totalSize;
+        g_allocations = 0;
+        for (i = 0; i < POOL_CLASS_COUNT; i++)
+        {
+            poolClasses[i].peak = poolClasses[i].live;
+            poolClasses[i].failures = 0;
+        }
+        fallbackPeak = fallbackLive;
+        fallbackFailures = 0;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+void gballoc_deinit(void)
+{
+    if (gballocState == GBALLOC_STATE_INIT)
+    {
+        size_t i;
+
+        /* Codes_SRS_GBALLOC_POOL_01_005: [ gballoc_deinit shall return the slabs of every size class that has no live block to the heap. ]*/
+        for (i = 0; i < POOL_CLASS_COUNT; i++)
+        {
+            if (poolClasses[i].live == 0)
+            {
+                size_t j;
+                for (j = 0; j < poolClasses[i].slab_count; j++)
+                {
+                    free(poolClasses[i].slabs[j]);
+                    poolClasses[i].slabs[j] = NULL;
+                }
+                poolClasses[i].slab_count = 0;
+                poolClasses[i].free_list = NULL;
+            }
+        }
+
+        /* Codes_SRS_GBALLOC_POOL_01_006: [ gballoc_deinit shall free the lock created by gballoc_init. ]*/
+        (void)Lock_Deinit(gballocThreadSafeLock);
+    }
+
+    gballocState = GBALLOC_STATE_NOT_INIT;
+}
+
+void* gballoc_malloc(size_t size)
+{
+    void* result;
+
+    /* Codes_SRS_GBALLOC_POOL_01_007: [ gballoc_malloc shall ensure thread safety by using the lock created by gballoc_init. ]*/
+    if (lock_pool() != 0)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_008: [ If acquiring the lock fails, gballoc_malloc shall return NULL. ]*/
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_009: [ gballoc_malloc shall serve the request from the free list of the smallest size class that fits size, adding a slab to that class if its free list is empty. ]*/
+        /* Codes_SRS_GBALLOC_POOL_01_010: [ If size is bigger than the biggest class, or the class already has GB_POOL_MAX_SLABS_PER_CLASS slabs, or allocating the slab fails, gballoc_malloc shall allocate from the fallback heap. ]*/
+        /* Codes_SRS_GBALLOC_POOL_01_011: [ If the fallback heap allocation fails, gballoc_malloc shall return NULL. ]*/
+        result = pool_allocate(size);
+        unlock_pool();
+    }
+
+    return result;
+}
+
+void* gballoc_calloc(size_t nmemb, size_t size)
+{
+    void* result;
+
+    if ((size != 0) && (nmemb > SIZE_MAX / size))
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_012: [ If nmemb * size overflows, gballoc_calloc shall return NULL. ]*/
+        LogError("Invalid arguments: nmemb = %lu, size = %lu", (unsigned long)nmemb, (unsigned long)size);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_013: [ gballoc_calloc shall allocate nmemb * size bytes like gballoc_malloc and zero them. ]*/
+        result = gballoc_malloc(nmemb * size);
+        if (result != NULL)
+        {
+            (void)memset(result, 0, nmemb * size);
+        }
+    }
+
+    return result;
+}
+
+void* gballoc_realloc(void* ptr, size_t size)
+{
+    void* result;
+
+    if (ptr == NULL)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_014: [ When ptr is NULL, gballoc_realloc shall behave like gballoc_malloc. ]*/
+        result = gballoc_malloc(size);
+    }
+    /* Codes_SRS_GBALLOC_POOL_01_015: [ gballoc_realloc shall ensure thread safety by using the lock created by gballoc_init. ]*/
+    else if (lock_pool() != 0)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_016: [ If acquiring the lock fails, gballoc_realloc shall return NULL. ]*/
+        result = NULL;
+    }
+    else
+    {
+        GBALLOC_POOL_HEADER* header = get_header(ptr);
+        if (header == NULL)
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_017: [ When ptr was not allocated by gballoc, gballoc_realloc shall return NULL. ]*/
+            LogError("Could not reallocate address %p (not allocated by gballoc)", ptr);
+            result = NULL;
+        }
+        else if ((header->info.class_index != FALLBACK_CLASS_INDEX) && (size <= poolClasses[header->info.class_index].block_size))
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_018: [ If the block already holds size bytes, gballoc_realloc shall return ptr and only update the accounted size. ]*/
+            totalSize = totalSize - header->info.size + size;
+            header->info.size = size;
+            count_allocation(0);
+            result = ptr;
+        }
+        else if ((header->info.class_index == FALLBACK_CLASS_INDEX) && (size > poolClasses[POOL_CLASS_COUNT - 1].block_size))
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_019: [ If ptr and the new size both belong to the fallback heap, gballoc_realloc shall call realloc on the underlying block. ]*/
+            GBALLOC_POOL_HEADER* newHeader;
+            size_t oldSize = header->info.size;
+            if (size > SIZE_MAX - sizeof(GBALLOC_POOL_HEADER))
+            {
+                newHeader = NULL;
+            }
+            else
+            {
+                newHeader = (GBALLOC_POOL_HEADER*)realloc(header, sizeof(GBALLOC_POOL_HEADER) + size);
+            }
+
+            if (newHeader == NULL)
+            {
+                /* Codes_SRS_GBALLOC_POOL_01_020: [ When the underlying allocation fails, gballoc_realloc shall return NULL and leave ptr untouched. ]*/
+                fallbackFailures++;
+                result = NULL;
+            }
+            else
+            {
+                newHeader->info.size = size;
+                fallbackBytes = fallbackBytes - oldSize + size;
+                totalSize -= oldSize;
+                count_allocation(size);
+                result = newHeader + 1;
+            }
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_021: [ Otherwise gballoc_realloc shall allocate a block for size bytes, copy the contents of ptr into it and release ptr. ]*/
+            size_t oldSize = header->info.size;
+            result = pool_allocate(size);
+            if (result == NULL)
+            {
+                /* Codes_SRS_GBALLOC_POOL_01_020: [ When the underlying allocation fails, gballoc_realloc shall return NULL and leave ptr untouched. ]*/
+                LogError("Failure reallocating %lu bytes", (unsigned long)size);
+            }
+            else
+            {
+                (void)memcpy(result, ptr, (oldSize < size) ? oldSize : size);
+                pool_release(header);
+            }
+        }
+
+        unlock_pool();
+    }
+
+    return result;
+}
+
+void gballoc_free(void* ptr)
+{
+    /* Codes_SRS_GBALLOC_POOL_01_022: [ If ptr is NULL, gballoc_free shall do nothing. ]*/
+    if (ptr != NULL)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_023: [ gballoc_free shall ensure thread safety by using the lock created by gballoc_init. ]*/
+        if (lock_pool() != 0)
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_024: [ If acquiring the lock fails, gballoc_free shall do nothing. ]*/
+            LogError("Failed to get the Lock.");
+        }
+        else
+        {
+            GBALLOC_POOL_HEADER* header = get_header(ptr);
+            if (header == NULL)
+            {
+                /* Codes_SRS_GBALLOC_POOL_01_025: [ When ptr was not allocated by gballoc, gballoc_free shall log an error and not free any memory. ]*/
+                LogError("Could not free allocation for address %p (not allocated by gballoc)", ptr);
+            }
+            else
+            {
+                /* Codes_SRS_GBALLOC_POOL_01_026: [ gballoc_free shall put a pooled block back on the free list of its class and give a fallback block back to the heap. ]*/
+                pool_release(header);
+            }
+            unlock_pool();
+        }
+    }
+}
+
+size_t gballoc_getMaximumMemoryUsed(void)
+{
+    size_t result;
+
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_027: [ If gballoc was not initialized gballoc_getMaximumMemoryUsed, gballoc_getCurrentMemoryUsed shall return SIZE_MAX and gballoc_getAllocationCount shall return 0. ]*/
+        LogError("gballoc is not initialized.");
+        result = SIZE_MAX;
+    }
+    else if (lock_pool() != 0)
+    {
+        result = SIZE_MAX;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_028: [ gballoc_getMaximumMemoryUsed shall return the maximum amount of requested bytes alive at the same time since gballoc_init. ]*/
+        result = maxSize;
+        unlock_pool();
+    }
+
+    return result;
+}
+
+size_t gballoc_getCurrentMemoryUsed(void)
+{
+    size_t result;
+
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_027: [ If gballoc was not initialized gballoc_getMaximumMemoryUsed, gballoc_getCurrentMemoryUsed shall return SIZE_MAX and gballoc_getAllocationCount shall return 0. ]*/
+        LogError("gballoc is not initialized.");
+        result = SIZE_MAX;
+    }
+    else if (lock_pool() != 0)
+    {
+        result = SIZE_MAX;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_029: [ gballoc_getCurrentMemoryUsed shall return the amount of requested bytes currently alive. ]*/
+        result = totalSize;
+        unlock_pool();
+    }
+
+    return result;
+}
+
+size_t gballoc_getAllocationCount(void)
+{
+    size_t result;
+
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_027: [ If gballoc was not initialized gballoc_getMaximumMemoryUsed, gballoc_getCurrentMemoryUsed shall return SIZE_MAX and gballoc_getAllocationCount shall return 0. ]*/
+        LogError("gballoc is not initialized.");
+        result = 0;
+    }
+    else if (lock_pool() != 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_030: [ gballoc_getAllocationCount shall return the number of successful allocations since gballoc_init. ]*/
+        result = g_allocations;
+        unlock_pool();
+    }
+
+    return result;
+}
+
+void gballoc_resetMetrics()
+{
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        LogError("gballoc is not initialized.");
+    }
+    else if (lock_pool() == 0)
+    {
+        size_t i;
+
+        /* Codes_SRS_GBALLOC_POOL_01_031: [ gballoc_resetMetrics shall reset the max allocation size to the memory used by the live blocks, the number of allocations to zero, the per class peaks to the current live counts and the failures to zero. ]*/
+        maxSize = totalSize;
+        g_allocations = 0;
+        for (i = 0; i < POOL_CLASS_COUNT; i++)
+        {
+            poolClasses[i].peak = poolClasses[i].live;
+            poolClasses[i].failures = 0;
+        }
+        fallbackPeak = fallbackLive;
+        fallbackFailures = 0;
+        unlock_pool();
+    }
+}
+
+size_t gballoc_getPoolClassCount(void)
+{
+    /* Codes_SRS_GBALLOC_POOL_01_032: [ gballoc_getPoolClassCount shall return the number of slab size classes. ]*/
+    return POOL_CLASS_COUNT;
+}
+
+int gballoc_getPoolStatistics(size_t class_index, GBALLOC_POOL_STATISTICS* statistics)
+{
+    int result;
+
+    if ((statistics == NULL) || (class_index > FALLBACK_CLASS_INDEX))
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_033: [ If statistics is NULL or class_index is greater than gballoc_getPoolClassCount(), gballoc_getPoolStatistics shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: class_index = %lu, statistics = %p", (unsigned long)class_index, statistics);
+        result = __FAILURE__;
+    }
+    else if (gballocState != GBALLOC_STATE_INIT)
+    {
+        /* Codes_SRS_GBALLOC_POOL_01_034: [ If gballoc was not initialized gballoc_getPoolStatistics shall fail and return a non-zero value. ]*/
+        LogError("gballoc is not initialized.");
+        result = __FAILURE__;
+    }
+    else if (lock_pool() != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (class_index == FALLBACK_CLASS_INDEX)
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_035: [ For class_index equal to gballoc_getPoolClassCount(), gballoc_getPoolStatistics shall report the fallback heap, with block_size 0 and reserved set to the bytes currently allocated from it. ]*/
+            statistics->block_size = 0;
+            statistics->live = fallbackLive;
+            statistics->peak = fallbackPeak;
+            statistics->failures = fallbackFailures;
+            statistics->reserved = fallbackBytes;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_POOL_01_036: [ Otherwise gballoc_getPoolStatistics shall report the block size, live and peak block counts, failures and the bytes held in slabs of the class. ]*/
+            const GBALLOC_POOL_CLASS* poolClass = &poolClasses[class_index];
+            statistics->block_size = poolClass->block_size;
+            statistics->live = poolClass->live;
+            statistics->peak = poolClass->peak;
+            statistics->failures = poolClass->failures;
+            statistics->reserved = poolClass->slab_count * poolClass->blocks_per_slab * (sizeof(GBALLOC_POOL_HEADER) + poolClass->block_size);
+        }
+
+        unlock_pool();
+        result = 0;
+    }
+
+    return result;
+}
+
+#endif // GB_USE_POOL_HEAP
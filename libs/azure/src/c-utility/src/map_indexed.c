@@ -0,0 +1,786 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*this is an alternate backend for map.h. It is meant for maps that are looked up often (message properties):
+- keys/values/hashes live in arrays that grow geometrically instead of one element at a time
+- lookups go through a small open addressing index (linear probing) keyed by a FNV-1a hash of the key
+- all key and value bytes live in an arena made of chained blocks, so adding a pair does not malloc 2 strings
+the keys and values arrays keep insertion order, so Map_GetInternals produces exactly what map.c produces.
+arena blocks are never moved, so a key or value pointer handed out stays valid until that key is deleted or
+its value is overwritten (same as map.c), and keys/values that come from the map itself can be passed back in*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/map.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/strings.h"
+
+DEFINE_ENUM_STRINGS(MAP_RESULT, MAP_RESULT_VALUES);
+
+#define MAP_INDEXED_INITIAL_CAPACITY 8
+#define MAP_INDEXED_INITIAL_ARENA_SIZE 128
+#define MAP_INDEXED_EMPTY_SLOT 0
+
+typedef struct MAP_ARENA_BLOCK_TAG
+{
+    struct MAP_ARENA_BLOCK_TAG* next;
+    size_t size;
+    size_t used;
+    size_t live; /*bytes in this block that still belong to a key or a value*/
+    /*the string bytes follow the header*/
+}MAP_ARENA_BLOCK;
+
+typedef struct MAP_HANDLE_DATA_TAG
+{
+    char** keys;
+    char** values;
+    uint32_t* hashes;
+    size_t count;
+    size_t capacity;
+    size_t* slots; /*each slot holds (entry position + 1), MAP_INDEXED_EMPTY_SLOT means the slot is not used*/
+    size_t slotCount; /*always a power of 2*/
+    MAP_ARENA_BLOCK* arena; /*the block that is appended to, older blocks follow through next*/
+    MAP_FILTER_CALLBACK mapFilterCallback;
+}MAP_HANDLE_DATA;
+
+#define LOG_MAP_ERROR LogError("result = %s", ENUM_TO_STRING(MAP_RESULT, result));
+
+static uint32_t Map_HashKey(const char* key)
+{
+    uint32_t result = 2166136261u;
+    while (*key != '\0')
+    {
+        result ^= (uint8_t)(*key);
+        result *= 16777619u;
+        key++;
+    }
+    return result;
+}
+
+static void Map_IndexInsert(MAP_HANDLE_DATA* handleData, size_t position)
+{
+    size_t mask = handleData->slotCount - 1;
+    size_t slot = handleData->hashes[position] & mask;
+    while (handleData->slots[slot] != MAP_INDEXED_EMPTY_SLOT)
+    {
+        slot = (slot + 1) & mask;
+    }
+    handleData->slots[slot] = position + 1;
+}
+
+/*rebuilds the index from the keys array, optionally with a different number of slots*/
+static int Map_IndexRebuild(MAP_HANDLE_DATA* handleData, size_t slotCount)
+{
+    int result;
+    if (slotCount != handleData->slotCount)
+    {
+        size_t* newSlots = (size_t*)malloc(slotCount * sizeof(size_t));
+        if (newSlots == NULL)
+        {
+            LogError("unable to malloc index");
+            result = __FAILURE__;
+        }
+        else
+        {
+            free(handleData->slots);
+            handleData->slots = newSlots;
+            handleData->slotCount = slotCount;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        size_t i;
+        (void)memset(handleData->slots, 0, handleData->slotCount * sizeof(size_t));
+        for (i = 0; i < handleData->count; i++)
+        {
+            Map_IndexInsert(handleData, i);
+        }
+    }
+    return result;
+}
+
+static char** findKey(MAP_HANDLE_DATA* handleData, const char* key)
+{
+    char** result = NULL;
+    if (handleData->count > 0)
+    {
+        uint32_t hash = Map_HashKey(key);
+        size_t mask = handleData->slotCount - 1;
+        size_t slot = hash & mask;
+        while (handleData->slots[slot] != MAP_INDEXED_EMPTY_SLOT)
+        {
+            size_t position = handleData->slots[slot] - 1;
+            if ((handleData->hashes[position] == hash) &&
+                (strcmp(handleData->keys[position], key) == 0))
+            {
+                result = handleData->keys + position;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+    return result;
+}
+
+static char** findValue(MAP_HANDLE_DATA* handleData, const char* value)
+{
+    char** result = NULL;
+    size_t i;
+    for (i = 0; i < handleData->count; i++)
+    {
+        if (strcmp(handleData->values[i], value) == 0)
+        {
+            result = handleData->values + i;
+            break;
+        }
+    }
+    return result;
+}
+
+#define MAP_ARENA_BLOCK_BYTES(block) ((char*)((block) + 1))
+
+/*returns "length" bytes of arena storage. Existing blocks are never moved, a new block is chained when the current one is full*/
+static char* Map_ArenaAllocate(MAP_HANDLE_DATA* handleData, size_t length)
+{
+    char* result;
+    MAP_ARENA_BLOCK* block = handleData->arena;
+    if ((block != NULL) && (block->size - block->used >= length))
+    {
+        result = MAP_ARENA_BLOCK_BYTES(block) + block->used;
+        block->used += length;
+        block->live += length;
+    }
+    else
+    {
+        /*blocks grow geometrically so that a map with n bytes of strings has O(log n) blocks*/
+        size_t newSize = (block == NULL) ? MAP_INDEXED_INITIAL_ARENA_SIZE : block->size;
+        if ((block != NULL) && (newSize <= (SIZE_MAX - sizeof(MAP_ARENA_BLOCK)) / 2))
+        {
+            newSize *= 2;
+        }
+
+        if (newSize < length)
+        {
+            newSize = length;
+        }
+
+        if (newSize > SIZE_MAX - sizeof(MAP_ARENA_BLOCK))
+        {
+            LogError("arena size overflow");
+            result = NULL;
+        }
+        else
+        {
+            MAP_ARENA_BLOCK* newBlock = (MAP_ARENA_BLOCK*)malloc(sizeof(MAP_ARENA_BLOCK) + newSize);
+            if (newBlock == NULL)
+            {
+                LogError("unable to malloc arena block");
+                result = NULL;
+            }
+            else
+            {
+                newBlock->next = block;
+                newBlock->size = newSize;
+                newBlock->used = length;
+                newBlock->live = length;
+                handleData->arena = newBlock;
+                result = MAP_ARENA_BLOCK_BYTES(newBlock);
+            }
+        }
+    }
+    return result;
+}
+
+/*gives back "length" bytes at "bytes". A block that has nothing live left is freed (or rewound if it is the current one)*/
+static void Map_ArenaRelease(MAP_HANDLE_DATA* handleData, const char* bytes, size_t length)
+{
+    MAP_ARENA_BLOCK** where = &handleData->arena;
+    while (*where != NULL)
+    {
+        MAP_ARENA_BLOCK* block = *where;
+        const char* blockBytes = MAP_ARENA_BLOCK_BYTES(block);
+        if ((bytes >= blockBytes) && (bytes < blockBytes + block->used))
+        {
+            block->live -= length;
+            if (block->live == 0)
+            {
+                if (block == handleData->arena)
+                {
+                    block->used = 0;
+                }
+                else
+                {
+                    *where = block->next;
+                    free(block);
+                }
+            }
+            break;
+        }
+        where = &block->next;
+    }
+}
+
+static void Map_ArenaDestroy(MAP_HANDLE_DATA* handleData)
+{
+    while (handleData->arena != NULL)
+    {
+        MAP_ARENA_BLOCK* next = handleData->arena->next;
+        free(handleData->arena);
+        handleData->arena = next;
+    }
+}
+
+/*makes sure that the keys/values/hashes arrays can hold at least "needed" entries*/
+static int Map_ReserveEntries(MAP_HANDLE_DATA* handleData, size_t needed)
+{
+    int result;
+    if (needed <= handleData->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newCapacity = (handleData->capacity == 0) ? MAP_INDEXED_INITIAL_CAPACITY : handleData->capacity;
+        char** newKeys;
+        while (newCapacity < needed)
+        {
+            newCapacity *= 2;
+        }
+
+        newKeys = (char**)realloc(handleData->keys, newCapacity * sizeof(char*));
+        if (newKeys == NULL)
+        {
+            LogError("realloc error");
+            result = __FAILURE__;
+        }
+        else
+        {
+            char** newValues;
+            handleData->keys = newKeys;
+            newValues = (char**)realloc(handleData->values, newCapacity * sizeof(char*));
+            if (newValues == NULL)
+            {
+                LogError("realloc error");
+                result = __FAILURE__;
+            }
+            else
+            {
+                uint32_t* newHashes;
+                handleData->values = newValues;
+                newHashes = (uint32_t*)realloc(handleData->hashes, newCapacity * sizeof(uint32_t));
+                if (newHashes == NULL)
+                {
+                    LogError("realloc error");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    handleData->hashes = newHashes;
+                    /*the index is kept at most half full so that probes stay short*/
+                    if (Map_IndexRebuild(handleData, 2 * newCapacity) != 0)
+                    {
+                        LogError("unable to grow index");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        /*the arrays are only ever grown, a failure above leaves them larger but consistent*/
+                        handleData->capacity = newCapacity;
+                        result = 0;
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+static int insertNewKeyValue(MAP_HANDLE_DATA* handleData, const char* key, const char* value)
+{
+    int result;
+    size_t keyLength = strlen(key) + 1;
+    size_t valueLength = strlen(value) + 1;
+    char* storage;
+    if (Map_ReserveEntries(handleData, handleData->count + 1) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else if (keyLength > SIZE_MAX - valueLength)
+    {
+        LogError("key and value are too long");
+        result = __FAILURE__;
+    }
+    else if ((storage = Map_ArenaAllocate(handleData, keyLength + valueLength)) == NULL)
+    {
+        LogError("unable to allocate arena space");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t position = handleData->count;
+        (void)memcpy(storage, key, keyLength);
+        (void)memcpy(storage + keyLength, value, valueLength);
+        handleData->keys[position] = storage;
+        handleData->values[position] = storage + keyLength;
+        handleData->hashes[position] = Map_HashKey(storage);
+        handleData->count++;
+        Map_IndexInsert(handleData, position);
+        result = 0;
+    }
+    return result;
+}
+
+MAP_HANDLE Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
+{
+    /*Codes_SRS_MAP_02_001: [Map_Create shall create a new, empty map.]*/
+    MAP_HANDLE_DATA* result = (MAP_HANDLE_DATA*)malloc(sizeof(MAP_HANDLE_DATA));
+    /*Codes_SRS_MAP_02_002: [If during creation there are any error, then Map_Create shall return NULL.]*/
+    if (result != NULL)
+    {
+        /*Codes_SRS_MAP_02_003: [Otherwise, it shall return a non-NULL handle that can be used in subsequent calls.] */
+        (void)memset(result, 0, sizeof(MAP_HANDLE_DATA));
+        result->mapFilterCallback = mapFilterFunc;
+    }
+    return (MAP_HANDLE)result;
+}
+
+void Map_Destroy(MAP_HANDLE handle)
+{
+    /*Codes_SRS_MAP_02_005: [If parameter handle is NULL then Map_Destroy shall take no action.] */
+    if (handle != NULL)
+    {
+        /*Codes_SRS_MAP_02_004: [Map_Destroy shall release all resources associated with the map.] */
+        MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA*)handle;
+        free(handleData->keys);
+        free(handleData->values);
+        free(handleData->hashes);
+        free(handleData->slots);
+        Map_ArenaDestroy(handleData);
+        free(handleData);
+    }
+}
+
+/*Codes_SRS_MAP_02_039: [Map_Clone shall make a copy of the map indicated by parameter handle and return a non-NULL handle to it.]*/
+MAP_HANDLE Map_Clone(MAP_HANDLE handle)
+{
+    MAP_HANDLE_DATA* result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_MAP_02_038: [Map_Clone returns NULL if parameter handle is NULL.]*/
+        result = NULL;
+        LogError("invalid arg to Map_Clone (NULL)");
+    }
+    else
+    {
+        MAP_HANDLE_DATA * handleData = (MAP_HANDLE_DATA *)handle;
+        result = (MAP_HANDLE_DATA*)Map_Create(handleData->mapFilterCallback);
+        if (result == NULL)
+        {
+            /*Codes_SRS_MAP_02_047: [If during cloning, any operation fails, then Map_Clone shall return NULL.] */
+            LogError("unable to malloc");
+        }
+        else if (handleData->count > 0)
+        {
+            size_t i;
+            size_t live = 0;
+            char* storage = NULL;
+            MAP_ARENA_BLOCK* block;
+            for (block = handleData->arena; block != NULL; block = block->next)
+            {
+                live += block->live;
+            }
+
+            /*the clone gets one compact block sized from the live bytes only*/
+            if ((Map_ReserveEntries(result, handleData->count) != 0) ||
+                ((live != 0) && ((storage = Map_ArenaAllocate(result, live)) == NULL)))
+            {
+                /*Codes_SRS_MAP_02_047: [If during cloning, any operation fails, then Map_Clone shall return NULL.] */
+                LogError("unable to clone storage");
+                Map_Destroy((MAP_HANDLE)result);
+                result = NULL;
+            }
+            else
+            {
+                for (i = 0; i < handleData->count; i++)
+                {
+                    size_t keyLength = strlen(handleData->keys[i]) + 1;
+                    size_t valueLength = strlen(handleData->values[i]) + 1;
+                    (void)memcpy(storage, handleData->keys[i], keyLength);
+                    result->keys[i] = storage;
+                    storage += keyLength;
+                    (void)memcpy(storage, handleData->values[i], valueLength);
+                    result->values[i] = storage;
+                    storage += valueLength;
+                    result->hashes[i] = handleData->hashes[i];
+                    result->count++;
+                    Map_IndexInsert(result, i);
+                }
+            }
+        }
+        else
+        {
+            /*empty map, nothing else to copy*/
+        }
+    }
+    return (MAP_HANDLE)result;
+}
+
+MAP_RESULT Map_Add(MAP_HANDLE handle, const char* key, const char* value)
+{
+    MAP_RESULT result;
+    /*Codes_SRS_MAP_02_006: [If parameter handle is NULL then Map_Add shall return MAP_INVALID_ARG.] */
+    /*Codes_SRS_MAP_02_007: [If parameter key is NULL then Map_Add shall return MAP_INVALID_ARG.]*/
+    /*Codes_SRS_MAP_02_008: [If parameter value is NULL then Map_Add shall return MAP_INVALID_ARG.] */
+    if (
+        (handle == NULL) ||
+        (key == NULL) ||
+        (value == NULL)
+        )
+    {
+        result = MAP_INVALIDARG;
+        LOG_MAP_ERROR;
+    }
+    else
+    {
+        MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA*)handle;
+        /*Codes_SRS_MAP_02_009: [If the key already exists, then Map_Add shall return MAP_KEYEXISTS.] */
+        if (findKey(handleData, key) != NULL)
+        {
+            result = MAP_KEYEXISTS;
+        }
+        /* Codes_SRS_MAP_07_009: [If the mapFilterCallback function is not NULL, then the return value will be check and if it is not zero then Map_Add shall return MAP_FILTER_REJECT.] */
+        else if ((handleData->mapFilterCallback != NULL) && (handleData->mapFilterCallback(key, value) != 0))
+        {
+            result = MAP_FILTER_REJECT;
+        }
+        /*Codes_SRS_MAP_02_010: [Otherwise, Map_Add shall add the pair <key,value> to the map.] */
+        else if (insertNewKeyValue(handleData, key, value) != 0)
+        {
+            /*Codes_SRS_MAP_02_011: [If adding the pair <key,value> fails then Map_Add shall return MAP_ERROR.] */
+            result = MAP_ERROR;
+            LOG_MAP_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_MAP_02_012: [Otherwise, Map_Add shall return MAP_OK.] */
+            result = MAP_OK;
+        }
+    }
+    return result;
+}
+
+MAP_RESULT Map_AddOrUpdate(MAP_HANDLE handle, const char* key, const char* value)
+{
+    MAP_RESULT result;
+    /*Codes_SRS_MAP_02_013: [If parameter handle is NULL then Map_AddOrUpdate shall return MAP_INVALID_ARG.]*/
+    /*Codes_SRS_MAP_02_014: [If parameter key is NULL then Map_AddOrUpdate shall return MAP_INVALID_ARG.]*/
+    /*Codes_SRS_MAP_02_015: [If parameter value is NULL then Map_AddOrUpdate shall return MAP_INVALID_ARG.] */
+    if (
+        (handle == NULL) ||
+        (key == NULL) ||
+        (value == NULL)
+        )
+    {
+        result = MAP_INVALIDARG;
+        LOG_MAP_ERROR;
+    }
+    else
+    {
+        MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA*)handle;
+
+        /* Codes_SRS_MAP_07_008: [If the mapFilterCallback function is not NULL, then the return value will be check and if it is not zero then Map_AddOrUpdate shall return MAP_FILTER_REJECT.] */
+        if (handleData->mapFilterCallback != NULL && handleData->mapFilterCallback(key, value) != 0)
+        {
+            result = MAP_FILTER_REJECT;
+        }
+        else
+        {
+            char** whereIsIt = findKey(handleData, key);
+            if (whereIsIt == NULL)
+            {
+                /*Codes_SRS_MAP_02_017: [Otherwise, Map_AddOrUpdate shall add the pair <key,value> to the map.]*/
+                if (insertNewKeyValue(handleData, key, value) != 0)
+                {
+                    result = MAP_ERROR;
+                    LOG_MAP_ERROR;
+                }
+                else
+                {
+                    result = MAP_OK;
+                }
+            }
+            else
+            {
+                /*Codes_SRS_MAP_02_016: [If the key already exists, then Map_AddOrUpdate shall overwrite the value of the existing key with parameter value.]*/
+                size_t index = whereIsIt - handleData->keys;
+                char* oldValue = handleData->values[index];
+                size_t oldValueLength = strlen(oldValue) + 1;
+                size_t valueLength = strlen(value) + 1;
+                char* newValue;
+                if (valueLength <= oldValueLength)
+                {
+                    /*the new value fits where the old one was. value might be (part of) the old value, hence memmove*/
+                    (void)memmove(oldValue, value, valueLength);
+                    Map_ArenaRelease(handleData, oldValue + valueLength, oldValueLength - valueLength);
+                    /*Codes_SRS_MAP_02_019: [Otherwise, Map_AddOrUpdate shall return MAP_OK.] */
+                    result = MAP_OK;
+                }
+                else if ((newValue = Map_ArenaAllocate(handleData, valueLength)) == NULL)
+                {
+                    result = MAP_ERROR;
+                    LOG_MAP_ERROR;
+                }
+                else
+                {
+                    /*the old value is only released after the copy, value might point into it or into the same block*/
+                    (void)memcpy(newValue, value, valueLength);
+                    handleData->values[index] = newValue;
+                    Map_ArenaRelease(handleData, oldValue, oldValueLength);
+                    /*Codes_SRS_MAP_02_019: [Otherwise, Map_AddOrUpdate shall return MAP_OK.] */
+                    result = MAP_OK;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+MAP_RESULT Map_Delete(MAP_HANDLE handle, const char* key)
+{
+    MAP_RESULT result;
+    /*Codes_SRS_MAP_02_020: [If parameter handle is NULL then Map_Delete shall return MAP_INVALIDARG.]*/
+    /*Codes_SRS_MAP_02_021: [If parameter key is NULL then Map_Delete shall return MAP_INVALIDARG.]*/
+    if (
+        (handle == NULL) ||
+        (key == NULL)
+        )
+    {
+        result = MAP_INVALIDARG;
+        LOG_MAP_ERROR;
+    }
+    else
+    {
+        MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA*)handle;
+        char** whereIsIt = findKey(handleData, key);
+        if (whereIsIt == NULL)
+        {
+            /*Codes_SRS_MAP_02_022: [If key does not exist then Map_Delete shall return MAP_KEYNOTFOUND.]*/
+            result = MAP_KEYNOTFOUND;
+        }
+        else
+        {
+            /*Codes_SRS_MAP_02_023: [Otherwise, Map_Delete shall remove the key and its associated value from the map and return MAP_OK.]*/
+            size_t index = whereIsIt - handleData->keys;
+            Map_ArenaRelease(handleData, handleData->keys[index], strlen(handleData->keys[index]) + 1);
+            Map_ArenaRelease(handleData, handleData->values[index], strlen(handleData->values[index]) + 1);
+            /*order has to be kept for Map_GetInternals*/
+            (void)memmove(handleData->keys + index, handleData->keys + index + 1, (handleData->count - index - 1) * sizeof(char*));
+            (void)memmove(handleData->values + index, handleData->values + index + 1, (handleData->count - index - 1) * sizeof(char*));
+            (void)memmove(handleData->hashes + index, handleData->hashes + index + 1, (handleData->count - index - 1) * sizeof(uint32_t));
+            handleData->count--;
+            /*positions after index have shifted, the index cannot fail to rebuild at the same size*/
+            (void)Map_IndexRebuild(handleData, handleData->slotCount);
+            result = MAP_OK;
+        }
+    }
+    return result;
+}
+
+MAP_RESULT Map_ContainsKey(MAP_HANDLE handle, const char* key, bool* keyExists)
+{
+    MAP_RESULT result;
+    /*Codes_SRS_MAP_02_024: [If parameter handle, key or keyExists are NULL then Map_ContainsKey shall return MAP_INVALIDARG.]*/
+    if (
+        (handle == NULL) ||
+        (key == NULL) ||
+        (keyExists == NULL)
+        )
+    {
+        result = MAP_INVALIDARG;
+        LOG_MAP_ERROR;
+    }
+    else
+    {
+        MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA*)handle;
+        /*Codes_SRS_MAP_02_025: [Otherwise if a key exists then Map_ContainsKey shall return MAP_OK and shall write in keyExists "true".]*/
+        /*Codes_SRS_MAP_02_026: [If a key doesn't exist, then Map_ContainsKey shall return MAP_OK and write in keyExists "false".] */
+        *keyExists = (findKey(handleData, key) != NULL) ? true : false;
+        result = MAP_OK;
+    }
+    return result;
+}
+
+MAP_RESULT Map_ContainsValue(MAP_HANDLE handle, const char* value, bool* valueExists)
+{
+    MAP_RESULT result;
+    /*Codes_SRS_MAP_02_027: [If parameter handle, value or valueExists is NULL then Map_ContainsValue shall return MAP_INVALIDARG.] */
+    if (
+        (handle == NULL) ||
+        (value == NULL) ||
+        (valueExists == NULL)
+        )
+    {
+        result = MAP_INVALIDARG;
+        LOG_MAP_ERROR;
+    }
+    else
+    {
+        MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA*)handle;
+        /*Codes_SRS_MAP_02_028: [Otherwise, if a pair <key, value> has its value equal to the parameter value, the Map_ContainsValue shall return MAP_OK and shall write in valueExists "true".]*/
+        /*Codes_SRS_MAP_02_029: [Otherwise, if such a <key, value> does not exist, then Map_ContainsValue shall return MAP_OK and shall write in valueExists "false".] */
+        *valueExists = (findValue(handleData, value) != NULL) ? true : false;
+        result = MAP_OK;
+    }
+    return result;
+}
+
+const char* Map_GetValueFromKey(MAP_HANDLE handle, const char* key)
+{
+    const char* result;
+    /*Codes_SRS_MAP_02_040: [If parameter handle or key is NULL then Map_GetValueFromKey returns NULL.]*/
+    if (
+        (handle == NULL) ||
+        (key == NULL)
+        )
+    {
+        result = NULL;
+        LogError("invalid parameter to Map_GetValueFromKey");
+    }
+    else
+    {
+        MAP_HANDLE_DATA * handleData = (MAP_HANDLE_DATA *)handle;
+        char** whereIsIt = findKey(handleData, key);
+        if (whereIsIt == NULL)
+        {
+            /*Codes_SRS_MAP_02_041: [If the key is not found, then Map_GetValueFromKey returns NULL.]*/
+            result = NULL;
+        }
+        else
+        {
+            /*Codes_SRS_MAP_02_042: [Otherwise, Map_GetValueFromKey returns the key's value.] */
+            size_t index = whereIsIt - handleData->keys;
+            result = handleData->values[index];
+        }
+    }
+    return result;
+}
+
+MAP_RESULT Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    MAP_RESULT result;
+    /*Codes_SRS_MAP_02_046: [If parameter handle, keys, values or count is NULL then Map_GetInternals shall return MAP_INVALIDARG.] */
+    if (
+        (handle == NULL) ||
+        (keys == NULL) ||
+        (values == NULL) ||
+        (count == NULL)
+        )
+    {
+        result = MAP_INVALIDARG;
+        LOG_MAP_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_MAP_02_043: [Map_GetInternals shall produce in *keys an pointer to an array of const char* having all the keys stored so far by the map.]*/
+        /*Codes_SRS_MAP_02_044: [Map_GetInternals shall produce in *values a pointer to an array of const char* having all the values stored so far by the map.]*/
+        /*Codes_SRS_MAP_02_045: [  Map_GetInternals shall produce in *count the number of stored keys and values.]*/
+        MAP_HANDLE_DATA * handleData = (MAP_HANDLE_DATA *)handle;
+        *keys = (const char* const*)(handleData->keys);
+        *values = (const char* const*)(handleData->values);
+        *count = handleData->count;
+        result = MAP_OK;
+    }
+    return result;
+}
+
+STRING_HANDLE Map_ToJSON(MAP_HANDLE handle)
+{
+    STRING_HANDLE result;
+    /*Codes_SRS_MAP_02_052: [If parameter handle is NULL then Map_ToJSON shall return NULL.] */
+    if (handle == NULL)
+    {
+        result = NULL;
+        LogError("invalid arg (NULL)");
+    }
+    else
+    {
+        /*Codes_SRS_MAP_02_048: [Map_ToJSON shall produce a STRING_HANDLE representing the content of the MAP.] */
+        result = STRING_construct("{");
+        if (result == NULL)
+        {
+            LogError("STRING_construct failed");
+        }
+        else
+        {
+            size_t i;
+            MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA *)handle;
+            /*Codes_SRS_MAP_02_049: [If the MAP is empty, then Map_ToJSON shall produce the string "{}".*/
+            bool breakFor = false; /*used to break out of for*/
+            for (i = 0; (i < handleData->count) && (!breakFor); i++)
+            {
+                /*Codes_SRS_MAP_02_050: [If the map has properties then Map_ToJSON shall produce the following string:{"name1":"value1", "name2":"value2" ...}]*/
+                STRING_HANDLE key = STRING_new_JSON(handleData->keys[i]);
+                if (key == NULL)
+                {
+                    LogError("STRING_new_JSON failed");
+                    STRING_delete(result);
+                    result = NULL;
+                    breakFor = true;
+                }
+                else
+                {
+                    STRING_HANDLE value = STRING_new_JSON(handleData->values[i]);
+                    if (value == NULL)
+                    {
+                        LogError("STRING_new_JSON failed");
+                        STRING_delete(result);
+                        result = NULL;
+                        breakFor = true;
+                    }
+                    else
+                    {
+                        if (!(
+                            ((i>0) ? (STRING_concat(result, ",") == 0) : 1) &&
+                            (STRING_concat_with_STRING(result, key) == 0) &&
+                            (STRING_concat(result, ":") == 0) &&
+                            (STRING_concat_with_STRING(result, value) == 0)
+                            ))
+                        {
+                            LogError("failed to build the JSON");
+                            STRING_delete(result);
+                            result = NULL;
+                            breakFor = true;
+                        }
+                        STRING_delete(value);
+                    }
+                    STRING_delete(key);
+                }
+            }
+
+            if (breakFor)
+            {
+                LogError("error happened during JSON string builder");
+            }
+            else if (STRING_concat(result, "}") != 0)
+            {
+                LogError("failed to build the JSON");
+                STRING_delete(result);
+                result = NULL;
+            }
+            else
+            {
+                /*return as is, JSON has been build*/
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,437 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/sastoken_cache.h"
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#define INDEFINITE_TIME         ((time_t)(-1))
+#define HMAC_INNER_PAD          0x36
+#define HMAC_OUTER_PAD          0x5C
+/* 32 bytes of signature are 44 base64 characters, and each of them takes at most 3 characters once url encoded */
+#define SIGNATURE_MAX_LENGTH    (44 * 3)
+#define EXPIRY_MAX_LENGTH       32
+
+static const char TOKEN_PREFIX[] = "SharedAccessSignature sr=";
+static const char SIGNATURE_TAG[] = "&sig=";
+static const char EXPIRY_TAG[] = "&se=";
+static const char KEYNAME_TAG[] = "&skn=";
+static const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+typedef struct SASTOKEN_CACHE_TAG
+{
+    SHA256Context inner_context;
+    SHA256Context outer_context;
+    char* scope;
+    char* key_name;
+    size_t lifetime;
+    size_t refresh_interval;
+    /* the token up to and including "&sig=" never changes, so it is written once */
+    char* token;
+    size_t signature_offset;
+    /* seconds since epoch at which the current token was made, token_time_valid is false while there is no token */
+    size_t token_time;
+    bool token_time_valid;
+} SASTOKEN_CACHE;
+
+static int get_seconds_since_epoch(size_t* seconds)
+{
+    int result;
+    time_t current_time;
+    if ((current_time = get_time(NULL)) == INDEFINITE_TIME)
+    {
+        LogError("Failed getting the current local time (get_time() failed)");
+        result = __FAILURE__;
+    }
+    else
+    {
+        *seconds = (size_t)get_difftime(current_time, (time_t)0);
+        result = 0;
+    }
+    return result;
+}
+
+static int prepare_pads(SASTOKEN_CACHE* cache, const unsigned char* key, size_t keyLength)
+{
+    int result;
+    uint8_t pad[SHA256_Message_Block_Size];
+    uint8_t hashedKey[SHA256HashSize];
+    size_t i;
+
+    if (keyLength > SHA256_Message_Block_Size)
+    {
+        /* RFC 2104: keys longer than the block size are hashed first */
+        SHA256Context keyContext;
+        if ((SHA256Reset(&keyContext) != 0) ||
+            (SHA256Input(&keyContext, key, (unsigned int)keyLength) != 0) ||
+            (SHA256Result(&keyContext, hashedKey) != 0))
+        {
+            key = NULL;
+        }
+        else
+        {
+            key = hashedKey;
+            keyLength = SHA256HashSize;
+        }
+    }
+
+    if (key == NULL)
+    {
+        LogError("Failed hashing the key");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memset(pad, HMAC_INNER_PAD, sizeof(pad));
+        for (i = 0; i < keyLength; i++)
+        {
+            pad[i] ^= key[i];
+        }
+
+        if ((SHA256Reset(&cache->inner_context) != 0) ||
+            (SHA256Input(&cache->inner_context, pad, sizeof(pad)) != 0))
+        {
+            LogError("Failed hashing the inner pad");
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memset(pad, HMAC_OUTER_PAD, sizeof(pad));
+            for (i = 0; i < keyLength; i++)
+            {
+                pad[i] ^= key[i];
+            }
+
+            if ((SHA256Reset(&cache->outer_context) != 0) ||
+                (SHA256Input(&cache->outer_context, pad, sizeof(pad)) != 0))
+            {
+                LogError("Failed hashing the outer pad");
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+    }
+
+    /* the pads are derived from the key, do not leave them on the stack */
+    (void)memset(pad, 0, sizeof(pad));
+    (void)memset(hashedKey, 0, sizeof(hashedKey));
+    return result;
+}
+
+/* writes the url encoded base64 form of the signature, returns the number of characters written */
+static size_t encode_signature(const uint8_t signature[SHA256HashSize], char* destination)
+{
+    size_t length = 0;
+    size_t i;
+
+    for (i = 0; i < SHA256HashSize; i += 3)
+    {
+        char encoded[4];
+        size_t j;
+        uint32_t triple = (uint32_t)signature[i] << 16;
+        if (i + 1 < SHA256HashSize)
+        {
+            triple |= (uint32_t)signature[i + 1] << 8;
+        }
+        if (i + 2 < SHA256HashSize)
+        {
+            triple |= signature[i + 2];
+        }
+
+        encoded[0] = BASE64_CHARS[(triple >> 18) & 0x3F];
+        encoded[1] = BASE64_CHARS[(triple >> 12) & 0x3F];
+        encoded[2] = (i + 1 < SHA256HashSize) ? BASE64_CHARS[(triple >> 6) & 0x3F] : '=';
+        encoded[3] = (i + 2 < SHA256HashSize) ? BASE64_CHARS[triple & 0x3F] : '=';
+
+        /* only '+', '/' and '=' need escaping, the same way URL_Encode escapes them */
+        for (j = 0; j < 4; j++)
+        {
+            switch (encoded[j])
+            {
+            case '+':
+                destination[length++] = '%'; destination[length++] = '2'; destination[length++] = 'b';
+                break;
+            case '/':
+                destination[length++] = '%'; destination[length++] = '2'; destination[length++] = 'f';
+                break;
+            case '=':
+                destination[length++] = '%'; destination[length++] = '3'; destination[length++] = 'd';
+                break;
+            default:
+                destination[length++] = encoded[j];
+                break;
+            }
+        }
+    }
+
+    return length;
+}
+
+static int generate_token(SASTOKEN_CACHE* cache, size_t now)
+{
+    int result;
+    char expiry[EXPIRY_MAX_LENGTH];
+
+    if (size_tToString(expiry, sizeof(expiry), now + cache->lifetime) != 0)
+    {
+        LogError("Failed converting the expiry to a string");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* starting from the saved pad states, the HMAC costs two SHA256 runs over the scope and the expiry only */
+        uint8_t digest[SHA256HashSize];
+        SHA256Context inner_context = cache->inner_context;
+        SHA256Context outer_context = cache->outer_context;
+        size_t expiryLength = strlen(expiry);
+
+        if ((SHA256Input(&inner_context, (const uint8_t*)cache->scope, (unsigned int)strlen(cache->scope)) != 0) ||
+            (SHA256Input(&inner_context, (const uint8_t*)"\n", 1) != 0) ||
+            (SHA256Input(&inner_context, (const uint8_t*)expiry, (unsigned int)expiryLength) != 0) ||
+            (SHA256Result(&inner_context, digest) != 0) ||
+            (SHA256Input(&outer_context, digest, SHA256HashSize) != 0) ||
+            (SHA256Result(&outer_context, digest) != 0))
+        {
+            LogError("Failed computing the HMAC of the SAS token");
+            result = __FAILURE__;
+        }
+        else
+        {
+            char* position = cache->token + cache->signature_offset;
+            position += encode_signature(digest, position);
+            (void)memcpy(position, EXPIRY_TAG, sizeof(EXPIRY_TAG) - 1);
+            position += sizeof(EXPIRY_TAG) - 1;
+            (void)memcpy(position, expiry, expiryLength);
+            position += expiryLength;
+            if (cache->key_name != NULL)
+            {
+                size_t keyNameLength = strlen(cache->key_name);
+                (void)memcpy(position, KEYNAME_TAG, sizeof(KEYNAME_TAG) - 1);
+                position += sizeof(KEYNAME_TAG) - 1;
+                (void)memcpy(position, cache->key_name, keyNameLength);
+                position += keyNameLength;
+            }
+            *position = '\0';
+
+            cache->token_time = now;
+            cache->token_time_valid = true;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static bool is_token_stale(const SASTOKEN_CACHE* cache, size_t now)
+{
+    /* a clock that went backwards (the time was set after boot) also makes the token stale */
+    return (!cache->token_time_valid) ||
+        (now < cache->token_time) ||
+        (now - cache->token_time >= cache->refresh_interval);
+}
+
+SASTOKEN_CACHE_HANDLE SASToken_Cache_Create(const char* key, const char* scope, const char* keyName, size_t lifetime, size_t refresh_interval)
+{
+    SASTOKEN_CACHE* result;
+
+    /* Codes_SRS_SASTOKEN_CACHE_01_001: [ If key or scope is NULL, SASToken_Cache_Create shall fail and return NULL. ]*/
+    /* Codes_SRS_SASTOKEN_CACHE_01_002: [ If lifetime is 0 or refresh_interval is 0 or greater than lifetime, SASToken_Cache_Create shall fail and return NULL. ]*/
+    if ((key == NULL) ||
+        (scope == NULL) ||
+        (lifetime == 0) ||
+        (refresh_interval == 0) ||
+        (refresh_interval > lifetime))
+    {
+        LogError("Invalid arguments: key = %p, scope = %p, lifetime = %lu, refresh_interval = %lu", key, scope, (unsigned long)lifetime, (unsigned long)refresh_interval);
+        result = NULL;
+    }
+    else if ((result = (SASTOKEN_CACHE*)malloc(sizeof(SASTOKEN_CACHE))) == NULL)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+        LogError("Failed allocating the SAS token cache");
+    }
+    else
+    {
+        BUFFER_HANDLE decodedKey;
+
+        (void)memset(result, 0, sizeof(SASTOKEN_CACHE));
+        result->lifetime = lifetime;
+        result->refresh_interval = refresh_interval;
+
+        /* Codes_SRS_SASTOKEN_CACHE_01_004: [ SASToken_Cache_Create shall decode key from base64. ]*/
+        if ((decodedKey = Base64_Decoder(key)) == NULL)
+        {
+            /* Codes_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+            LogError("Unable to decode the key for generating the SAS.");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            unsigned char* keyBytes = BUFFER_u_char(decodedKey);
+            size_t keyLength = BUFFER_length(decodedKey);
+            size_t scopeLength = strlen(scope);
+            size_t tokenSize = (sizeof(TOKEN_PREFIX) - 1) + scopeLength + (sizeof(SIGNATURE_TAG) - 1) +
+                SIGNATURE_MAX_LENGTH + (sizeof(EXPIRY_TAG) - 1) + EXPIRY_MAX_LENGTH +
+                ((keyName == NULL) ? 0 : (sizeof(KEYNAME_TAG) - 1) + strlen(keyName)) + 1;
+
+            /* Codes_SRS_SASTOKEN_CACHE_01_005: [ SASToken_Cache_Create shall hash the decoded key xor-ed with the HMAC inner and outer pads and keep both SHA256 states. ]*/
+            /* Codes_SRS_SASTOKEN_CACHE_01_006: [ SASToken_Cache_Create shall copy scope and keyName and allocate a buffer big enough for any token of that scope and keyName. ]*/
+            if ((keyBytes == NULL) ||
+                (keyLength == 0) ||
+                (prepare_pads(result, keyBytes, keyLength) != 0) ||
+                (mallocAndStrcpy_s(&result->scope, scope) != 0) ||
+                ((keyName != NULL) && (mallocAndStrcpy_s(&result->key_name, keyName) != 0)) ||
+                ((result->token = (char*)malloc(tokenSize)) == NULL))
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+                LogError("Failed preparing the SAS token cache");
+                free(result->key_name);
+                free(result->scope);
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                char* position = result->token;
+                (void)memcpy(position, TOKEN_PREFIX, sizeof(TOKEN_PREFIX) - 1);
+                position += sizeof(TOKEN_PREFIX) - 1;
+                (void)memcpy(position, scope, scopeLength);
+                position += scopeLength;
+                (void)memcpy(position, SIGNATURE_TAG, sizeof(SIGNATURE_TAG) - 1);
+                position += sizeof(SIGNATURE_TAG) - 1;
+                *position = '\0';
+                result->signature_offset = (size_t)(position - result->token);
+            }
+
+            /* the decoded key is not needed any more, the pad states are all that is kept */
+            if (keyBytes != NULL)
+            {
+                (void)memset(keyBytes, 0, keyLength);
+            }
+            BUFFER_delete(decodedKey);
+        }
+    }
+
+    return result;
+}
+
+void SASToken_Cache_Destroy(SASTOKEN_CACHE_HANDLE handle)
+{
+    /* Codes_SRS_SASTOKEN_CACHE_01_007: [ If handle is NULL, SASToken_Cache_Destroy shall do nothing. ]*/
+    if (handle != NULL)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_008: [ SASToken_Cache_Destroy shall clear the pad states and free all resources used by the cache. ]*/
+        (void)memset(&handle->inner_context, 0, sizeof(handle->inner_context));
+        (void)memset(&handle->outer_context, 0, sizeof(handle->outer_context));
+        free(handle->token);
+        free(handle->key_name);
+        free(handle->scope);
+        free(handle);
+    }
+}
+
+const char* SASToken_Cache_GetToken(SASTOKEN_CACHE_HANDLE handle)
+{
+    const char* result;
+    size_t now;
+
+    if (handle == NULL)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_009: [ If handle is NULL, SASToken_Cache_GetToken shall return NULL. ]*/
+        LogError("Invalid argument handle: NULL");
+        result = NULL;
+    }
+    else if (get_seconds_since_epoch(&now) != 0)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_010: [ If getting the current time fails, SASToken_Cache_GetToken shall return NULL. ]*/
+        result = NULL;
+    }
+    else if (!is_token_stale(handle, now))
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_011: [ If the cached token is less than refresh_interval seconds old, SASToken_Cache_GetToken shall return it without generating a new one. ]*/
+        result = handle->token;
+    }
+    /* Codes_SRS_SASTOKEN_CACHE_01_012: [ Otherwise SASToken_Cache_GetToken shall generate a token that expires lifetime seconds from now, keep it and return it. ]*/
+    else if (generate_token(handle, now) != 0)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_013: [ If generating the token fails, SASToken_Cache_GetToken shall return NULL. ]*/
+        handle->token_time_valid = false;
+        result = NULL;
+    }
+    else
+    {
+        result = handle->token;
+    }
+
+    return result;
+}
+
+int SASToken_Cache_DoWork(SASTOKEN_CACHE_HANDLE handle)
+{
+    int result;
+    size_t now;
+
+    if (handle == NULL)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_014: [ If handle is NULL, SASToken_Cache_DoWork shall fail and return a non-zero value. ]*/
+        LogError("Invalid argument handle: NULL");
+        result = __FAILURE__;
+    }
+    else if (get_seconds_since_epoch(&now) != 0)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_015: [ If getting the current time or generating the token fails, SASToken_Cache_DoWork shall return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    else if (!is_token_stale(handle, now))
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_016: [ If the cached token is less than refresh_interval seconds old, SASToken_Cache_DoWork shall do nothing and return 0. ]*/
+        result = 0;
+    }
+    /* Codes_SRS_SASTOKEN_CACHE_01_017: [ Otherwise SASToken_Cache_DoWork shall generate and keep a new token, so that the next SASToken_Cache_GetToken does not have to. ]*/
+    else if (generate_token(handle, now) != 0)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_015: [ If getting the current time or generating the token fails, SASToken_Cache_DoWork shall return a non-zero value. ]*/
+        handle->token_time_valid = false;
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+bool SASToken_Cache_Matches(SASTOKEN_CACHE_HANDLE handle, const char* scope, const char* keyName, size_t lifetime)
+{
+    bool result;
+
+    if ((handle == NULL) || (scope == NULL))
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_018: [ If handle or scope is NULL, SASToken_Cache_Matches shall return false. ]*/
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_019: [ SASToken_Cache_Matches shall return true if the cache was created with the same scope, keyName and lifetime, false otherwise. ]*/
+        result = (handle->lifetime == lifetime) &&
+            (strcmp(handle->scope, scope) == 0) &&
+            (((handle->key_name == NULL) && (keyName == NULL)) ||
+             ((handle->key_name != NULL) && (keyName != NULL) && (strcmp(handle->key_name, keyName) == 0)));
+    }
+
+    return result;
+}
@@ -10,250 +10,269 @@
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 
-#define NIBBLE_TO_STRING(c) (char)((c) < 10 ? (c) + '0' : (c) - 10 + 'a')
-#define NIBBLE_FROM_STRING(c) (char)(ISDIGIT(c) ? (c) - '0' : TOUPPER(c) + 10 - 'A')
-#define IS_HEXDIGIT(c) (            \
-    ((c >= '0') && (c <= '9')) ||   \
-    ((c >= 'A') && (c <= 'F')) ||   \
-    ((c >= 'a') && (c <= 'f'))      \
-)
-#define IS_PRINTABLE(c) (                           \
-    (c == 0) ||                                     \
-    (c == '!') ||                                   \
-    (c == '(') || (c == ')') || (c == '*') ||       \
-    (c == '-') || (c == '.') ||                     \
-    ((c >= '0') && (c <= '9')) ||                   \
-    ((c >= 'A') && (c <= 'Z')) ||                   \
-    (c == '_') ||                                   \
-    ((c >= 'a') && (c <= 'z'))                      \
-)
+#define HEX_INVALID 0xFF
 
-/*The below macros are to be called on the big nibble of a hex value*/
-#define IS_IN_ASCII_RANGE(c) (  \
-    (c >= '0') && (c <= '7')    \
-)
-#define IS_IN_EXTENDED_ASCII_RANGE(c) ( \
-    ((c >= '8') && (c <= '9')) ||       \
-    ((c >= 'A') && (c <= 'F')) ||       \
-    ((c >= 'a') && (c <= 'f'))          \
-)
-#define IS_IN_CONTINUATION_BYTE_RANGE(c) (  \
-    (c == '8') || (c == '9') ||             \
-    (c == 'A') || (c == 'B') ||             \
-    (c == 'a') || (c == 'b')                \
-)
-#define IS_IN_LEADING_BYTE_RANGE(c) (   \
-    ((c >= 'C') && (c <= 'F')) ||       \
-    ((c >= 'c') && (c <= 'f'))          \
-)
-#define IS_IN_UNSUPPORTED_LEADING_BYTE_RANGE(c) (   \
-    ((c >= 'D') && (c <= 'F')) ||                   \
-    ((c >= 'd') && (c <= 'f'))                      \
-)
+/*size of the encoding of each character: 1 for the characters that are left as is (including the null terminator),
+3 for "%xx" and 6 for the "%c2%xx"/"%c3%xx" encoding of the extended ASCII range*/
+static const unsigned char URL_ENCODED_SIZE[256] =
+{
+    1, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 1, 3, 3, 3, 3, 3, 3, 1, 1, 1, 3, 3, 1, 1, 3,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3,
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 1,
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
+};
 
-static size_t URL_PrintableChar(unsigned char charVal, char* buffer)
+/*value of each hex digit, HEX_INVALID for anything else*/
+static const unsigned char HEX_VALUE[256] =
 {
-    size_t size;
-    if (IS_PRINTABLE(charVal))
-    {
-        buffer[0] = (char)charVal;
-        size = 1;
-    }
-    else
-    {
-        char bigNibbleStr;
-        char littleNibbleStr;
-        unsigned char bigNibbleVal = charVal >> 4;
-        unsigned char littleNibbleVal = charVal & 0x0F;
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
 
-        if (bigNibbleVal >= 0x0C)
-        {
-            bigNibbleVal -= 0x04;
-        }
+static const char HEX_DIGITS[16] =
+{
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
 
-        bigNibbleStr = NIBBLE_TO_STRING(bigNibbleVal);
-        littleNibbleStr = NIBBLE_TO_STRING(littleNibbleVal);
+#define IS_PRINTABLE(c) (URL_ENCODED_SIZE[(unsigned char)(c)] == 1)
 
-        buffer[0] = '%';
+size_t URL_Encoded_Length(const char* text)
+{
+    size_t result = 0;
 
-        if (charVal < 0x80)
+    /*Codes_SRS_URL_ENCODE_01_001: [ If text is NULL, URL_Encoded_Length shall return 0. ]*/
+    if (text != NULL)
+    {
+        /*Codes_SRS_URL_ENCODE_01_002: [ Otherwise URL_Encoded_Length shall return the length of the URL encoding of text, not counting the null terminator. ]*/
+        const unsigned char* iterator = (const unsigned char*)text;
+        while (*iterator != '\0')
         {
-            buffer[1] = bigNibbleStr;
-            buffer[2] = littleNibbleStr;
-            size = 3;
+            result += URL_ENCODED_SIZE[*iterator++];
         }
-        else
+    }
+
+    return result;
+}
+
+static void encode_url_data_to_buffer(const char* text, char* encodedURL)
+{
+    const unsigned char* iterator = (const unsigned char*)text;
+    unsigned char currentUnsignedChar;
+
+    while ((currentUnsignedChar = *iterator++) != '\0')
+    {
+        switch (URL_ENCODED_SIZE[currentUnsignedChar])
         {
-            buffer[1] = 'c';
-            buffer[3] = '%';
-            buffer[4] = bigNibbleStr;
-            buffer[5] = littleNibbleStr;
-            if (charVal < 0xC0)
-            {
-                buffer[2] = '2';
-            }
-            else
-            {
-                buffer[2] = '3';
-            }
-            size = 6;
+            case 1:
+                *encodedURL++ = (char)currentUnsignedChar;
+                break;
+            case 3:
+                encodedURL[0] = '%';
+                encodedURL[1] = HEX_DIGITS[currentUnsignedChar >> 4];
+                encodedURL[2] = HEX_DIGITS[currentUnsignedChar & 0x0F];
+                encodedURL += 3;
+                break;
+            default:
+                /*the extended ASCII range is sent as the 2 bytes of its UTF-8 encoding*/
+                encodedURL[0] = '%';
+                encodedURL[1] = 'c';
+                encodedURL[2] = (currentUnsignedChar < 0xC0) ? '2' : '3';
+                encodedURL[3] = '%';
+                encodedURL[4] = HEX_DIGITS[(0x80 | (currentUnsignedChar & 0x3F)) >> 4];
+                encodedURL[5] = HEX_DIGITS[currentUnsignedChar & 0x0F];
+                encodedURL += 6;
+                break;
         }
     }
 
-    return size;
+    *encodedURL = '\0';
 }
 
-static size_t calculateDecodedStringSize(const char* encodedString, size_t len)
+int URL_Encode_To_Buffer(const char* text, char* destination, size_t destinationSize)
 {
-    size_t decodedSize = 0;
+    int result;
 
-    if (encodedString == NULL)
+    /*Codes_SRS_URL_ENCODE_01_003: [ If text or destination is NULL, URL_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+    if ((text == NULL) || (destination == NULL))
     {
-        LogError("Null encoded string");
+        LogError("Invalid arguments: text = %p, destination = %p", text, destination);
+        result = __FAILURE__;
     }
-    else if (len == 0)
+    /*Codes_SRS_URL_ENCODE_01_004: [ If destinationSize is smaller than URL_Encoded_Length(text) + 1, URL_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+    else if (destinationSize < URL_Encoded_Length(text) + 1)
     {
-        decodedSize = 1; //for null terminator
+        LogError("Destination too small: %lu bytes, %lu needed", (unsigned long)destinationSize, (unsigned long)(URL_Encoded_Length(text) + 1));
+        result = __FAILURE__;
     }
     else
     {
-        size_t remaining_len = len;
-        size_t next_step = 0;
-        size_t i = 0;
-        while (i < len)
+        /*Codes_SRS_URL_ENCODE_01_005: [ Otherwise URL_Encode_To_Buffer shall write the null terminated URL encoding of text to destination and return 0. ]*/
+        encode_url_data_to_buffer(text, destination);
+        result = 0;
+    }
+
+    return result;
+}
+
+int URL_Decode_To_Buffer(const char* text, char* destination, size_t destinationSize)
+{
+    int result;
+
+    /*Codes_SRS_URL_ENCODE_01_006: [ If text or destination is NULL, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+    if ((text == NULL) || (destination == NULL))
+    {
+        LogError("Invalid arguments: text = %p, destination = %p", text, destination);
+        result = __FAILURE__;
+    }
+    else
+    {
+        const unsigned char* iterator = (const unsigned char*)text;
+        char* decoded = destination;
+        char* decodedEnd = destination + destinationSize;
+
+        result = 0;
+        while (*iterator != '\0')
         {
-            //percent encoded character
-            if (encodedString[i] == '%')
+            if (decoded == decodedEnd)
+            {
+                /*Codes_SRS_URL_ENCODE_01_008: [ If destination cannot hold the decoded text and its null terminator, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+                LogError("Destination too small: %lu bytes", (unsigned long)destinationSize);
+                result = __FAILURE__;
+                break;
+            }
+            else if (*iterator == '%')
             {
-                if (remaining_len < 3 || !IS_HEXDIGIT(encodedString[i+1]) || !IS_HEXDIGIT(encodedString[i+2]))
+                /*Codes_SRS_URL_ENCODE_01_007: [ If text contains a '%' not followed by 2 hex digits, a percent encoding outside of the 7-bit ASCII range or a character that would have been encoded, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+                /*a null terminator after the '%' is caught by the first lookup, so the second one never reads past it*/
+                unsigned char bigNibble = HEX_VALUE[iterator[1]];
+                unsigned char littleNibble = (bigNibble == HEX_INVALID) ? HEX_INVALID : HEX_VALUE[iterator[2]];
+                if ((bigNibble == HEX_INVALID) || (littleNibble == HEX_INVALID))
                 {
                     LogError("Incomplete or invalid percent encoding");
+                    result = __FAILURE__;
                     break;
                 }
-                else if (!IS_IN_ASCII_RANGE(encodedString[i+1]))
+                else if (bigNibble > 7)
                 {
                     LogError("Out of range of characters accepted by this decoder");
+                    result = __FAILURE__;
                     break;
                 }
                 else
                 {
-                    decodedSize++;
-                    next_step = 3;
+                    *decoded++ = (char)((bigNibble << 4) | littleNibble);
+                    iterator += 3;
                 }
             }
-            else if (!IS_PRINTABLE(encodedString[i]))
+            else if (!IS_PRINTABLE(*iterator))
             {
                 LogError("Unprintable value in encoded string");
+                result = __FAILURE__;
                 break;
             }
-            //safe character
             else
             {
-                decodedSize++;
-                next_step = 1;
+                *decoded++ = (char)*iterator++;
             }
-
-            i += next_step;
-            remaining_len -= next_step;
         }
 
-        if (encodedString[i] != '\0') //i.e. broke out of above loop due to error
+        if (result == 0)
         {
-            decodedSize = 0;
-        }
-        else
-        {
-            decodedSize++; //add space for the null terminator
+            if (decoded == decodedEnd)
+            {
+                /*Codes_SRS_URL_ENCODE_01_008: [ If destination cannot hold the decoded text and its null terminator, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+                LogError("Destination too small: %lu bytes", (unsigned long)destinationSize);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_URL_ENCODE_01_009: [ Otherwise URL_Decode_To_Buffer shall write the null terminated decoded text to destination and return 0. ]*/
+                *decoded = '\0';
+            }
         }
     }
-    return decodedSize;
-}
-
-static unsigned char charFromNibbles(char bigNibbleStr, char littleNibbleStr)
-{
-    unsigned char bigNibbleVal = NIBBLE_FROM_STRING(bigNibbleStr);
-    unsigned char littleNibbleVal = NIBBLE_FROM_STRING(littleNibbleStr);
 
-    return bigNibbleVal << 4 | littleNibbleVal;
+    return result;
 }
 
-static void createDecodedString(const char* input, size_t input_size, char* output)
+static STRING_HANDLE encode_url_data(const char* text)
 {
-    /* Note that there is no danger of reckless indexing here, as calculateDecodedStringSize()
-    has already checked lengths of strings to ensure the formatting is always correct*/
-    size_t i = 0;
-    while (i <= input_size) //the <= instead of < ensures the '\0' will be copied
-    {
-        if (input[i] != '%')
-        {
-            *output++ = input[i];
-            i++;
-        }
-        else
-        {
-            *output++ = charFromNibbles(input[i+1], input[i+2]);
-            i += 3;
-        }
-    }
-}
+    STRING_HANDLE result;
+    /*Codes_SRS_URL_ENCODE_06_003: [If input is a zero length string then URL_Encode will return a zero length string.]*/
+    size_t lengthOfResult = URL_Encoded_Length(text) + 1;
+    char* encodedURL;
 
-static size_t URL_PrintableCharSize(unsigned char charVal)
-{
-    size_t size;
-    if (IS_PRINTABLE(charVal))
+    if ((encodedURL = (char*)malloc(lengthOfResult)) == NULL)
     {
-        size = 1;
+        /*Codes_SRS_URL_ENCODE_06_002: [If an error occurs during the encoding of input then URL_Encode will return NULL.]*/
+        result = NULL;
+        LogError("URL_Encode:: MALLOC failure on encode.");
     }
     else
     {
-        if (charVal < 0x80)
-        {
-            size = 3;
-        }
-        else
+        encode_url_data_to_buffer(text, encodedURL);
+
+        result = STRING_new_with_memory(encodedURL);
+        if (result == NULL)
         {
-            size = 6;
+            LogError("URL_Encode:: MALLOC failure on encode.");
+            free(encodedURL);
         }
     }
-    return size;
+    return result;
 }
 
-static STRING_HANDLE encode_url_data(const char* text)
+static STRING_HANDLE decode_url_data(const char* text)
 {
     STRING_HANDLE result;
-    size_t lengthOfResult = 0;
-    char* encodedURL;
-    unsigned char currentUnsignedChar;
-    const char* iterator = text;
+    /*the decoded string is never longer than the encoded one*/
+    size_t decodedStringSize = strlen(text) + 1;
+    char* decodedString;
 
-    /*Codes_SRS_URL_ENCODE_06_003: [If input is a zero length string then URL_Encode will return a zero length string.]*/
-    do
+    if ((decodedString = (char*)malloc(decodedStringSize)) == NULL)
     {
-        currentUnsignedChar = (unsigned char)(*iterator++);
-        lengthOfResult += URL_PrintableCharSize(currentUnsignedChar);
-    } while (currentUnsignedChar != 0);
-
-    if ((encodedURL = (char*)malloc(lengthOfResult)) == NULL)
+        LogError("URL_Decode:: MALLOC failure on decode.");
+        result = NULL;
+    }
+    else if (URL_Decode_To_Buffer(text, decodedString, decodedStringSize) != 0)
     {
-        /*Codes_SRS_URL_ENCODE_06_002: [If an error occurs during the encoding of input then URL_Encode will return NULL.]*/
+        LogError("URL_Decode:: Invalid input string");
+        free(decodedString);
         result = NULL;
-        LogError("URL_Encode:: MALLOC failure on encode.");
     }
     else
     {
-        size_t currentEncodePosition = 0;
-        iterator = text;;
-        do
-        {
-            currentUnsignedChar = (unsigned char)(*iterator++);
-            currentEncodePosition += URL_PrintableChar(currentUnsignedChar, &encodedURL[currentEncodePosition]);
-        } while (currentUnsignedChar != 0);
-
-        result = STRING_new_with_memory(encodedURL);
+        result = STRING_new_with_memory(decodedString);
         if (result == NULL)
         {
-            LogError("URL_Encode:: MALLOC failure on encode.");
-            free(encodedURL);
+            LogError("URL_Decode:: MALLOC failure on decode");
+            free(decodedString);
         }
     }
     return result;
@@ -298,16 +317,7 @@ STRING_HANDLE URL_DecodeString(const char* textDecode)
     }
     else
     {
-        STRING_HANDLE tempString = STRING_construct(textDecode);
-        if (tempString == NULL)
-        {
-            result = NULL;
-        }
-        else
-        {
-            result = URL_Decode(tempString);
-            STRING_delete(tempString);
-        }
+        result = decode_url_data(textDecode);
     }
     return result;
 }
@@ -322,30 +332,7 @@ STRING_HANDLE URL_Decode(STRING_HANDLE input)
     }
     else
     {
-        size_t decodedStringSize;
-        char* decodedString;
-        const char* inputString = STRING_c_str(input);
-        size_t inputLen = strlen(inputString);
-        if ((decodedStringSize = calculateDecodedStringSize(inputString, inputLen)) == 0)
-        {
-            LogError("URL_Decode:: Invalid input string");
-            result = NULL;
-        }
-        else if ((decodedString = (char*)malloc(decodedStringSize)) == NULL)
-        {
-            LogError("URL_Decode:: MALLOC failure on decode.");
-            result = NULL;
-        }
-        else
-        {
-            createDecodedString(inputString, inputLen, decodedString);
-            result = STRING_new_with_memory(decodedString);
-            if (result == NULL)
-            {
-                LogError("URL_Decode:: MALLOC failure on decode");
-                free(decodedString);
-            }
-        }
+        result = decode_url_data(STRING_c_str(input));
     }
     return result;
 }
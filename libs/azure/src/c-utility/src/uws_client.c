@@ -16,7 +16,6 @@
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
-#include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/uws_frame_encoder.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/utf8_checker.h"
@@ -99,6 +98,8 @@ typedef struct UWS_CLIENT_INSTANCE_TAG
     unsigned char* fragment_buffer;
     size_t fragment_buffer_count;
     unsigned char fragmented_frame_type;
+    unsigned char* send_buffer;
+    size_t send_buffer_size;
 } UWS_CLIENT_INSTANCE;
 
 /* Codes_SRS_UWS_CLIENT_01_360: [ Connection confidentiality and integrity is provided by running the WebSocket Protocol over TLS (wss URIs). ]*/
@@ -534,6 +535,7 @@ void uws_client_destroy(UWS_CLIENT_HANDLE uws_client)
     {
         free(uws_client->stream_buffer);
         free(uws_client->fragment_buffer);
+        free(uws_client->send_buffer);
 
         /* Codes_SRS_UWS_CLIENT_01_021: [ `uws_client_destroy` shall perform a close action if the uws instance has already been open. ]*/
         switch (uws_client->uws_state)
@@ -616,29 +618,86 @@ static void unchecked_on_send_complete(void* context, IO_SEND_RESULT send_result
     (void)send_result;
 }
 
+static int encode_frame_in_send_buffer(UWS_CLIENT_INSTANCE* uws_client, WS_FRAME_TYPE frame_type, const unsigned char* payload, size_t length, bool is_final, const unsigned char** encoded_frame, size_t* encoded_frame_length)
+{
+    int result;
+
+    if (length > SIZE_MAX - UWS_FRAME_ENCODER_MAX_HEADER_SIZE)
+    {
+        LogError("Frame payload too large: %u bytes", (unsigned int)length);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t needed_size = UWS_FRAME_ENCODER_MAX_HEADER_SIZE + length;
+
+        /* Codes_SRS_UWS_CLIENT_01_532: [ The payload shall be copied after `UWS_FRAME_ENCODER_MAX_HEADER_SIZE` bytes of headroom into a send buffer owned by the uws instance, which shall be grown with `realloc` only when it is too small for the frame. ]*/
+        if (needed_size > uws_client->send_buffer_size)
+        {
+            unsigned char* new_send_buffer = (unsigned char*)realloc(uws_client->send_buffer, needed_size);
+            if (new_send_buffer == NULL)
+            {
+                /* Codes_SRS_UWS_CLIENT_01_533: [ If growing the send buffer fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                LogError("Cannot allocate memory for the frame to be sent");
+                result = __FAILURE__;
+            }
+            else
+            {
+                uws_client->send_buffer = new_send_buffer;
+                uws_client->send_buffer_size = needed_size;
+                result = 0;
+            }
+        }
+        else
+        {
+            result = 0;
+        }
+
+        if (result == 0)
+        {
+            size_t header_length;
+
+            if (length > 0)
+            {
+                (void)memcpy(uws_client->send_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE, payload, length);
+            }
+
+            /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+            if (uws_frame_encoder_encode_in_place(frame_type, uws_client->send_buffer, length, true, is_final, 0, &header_length) != 0)
+            {
+                LogError("Encoding of frame failed.");
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* Codes_SRS_UWS_CLIENT_01_428: [ The encoded frame shall start `header_length` bytes before the payload in the send buffer. ]*/
+                *encoded_frame = uws_client->send_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE - header_length;
+                /* Codes_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be the header length plus the payload size. ]*/
+                *encoded_frame_length = header_length + length;
+            }
+        }
+    }
+
+    return result;
+}
+
 static int send_close_frame(UWS_CLIENT_INSTANCE* uws_client, unsigned int close_error_code)
 {
-    unsigned char* close_frame;
+    const unsigned char* close_frame;
     unsigned char close_frame_payload[2];
     size_t close_frame_length;
     int result;
-    BUFFER_HANDLE close_frame_buffer;
 
     close_frame_payload[0] = (unsigned char)(close_error_code >> 8);
     close_frame_payload[1] = (unsigned char)(close_error_code & 0xFF);
 
-    /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-    close_frame_buffer = uws_frame_encoder_encode(WS_CLOSE_FRAME, close_frame_payload, sizeof(close_frame_payload), true, true, 0);
-    if (close_frame_buffer == NULL)
+    if (encode_frame_in_send_buffer(uws_client, WS_CLOSE_FRAME, close_frame_payload, sizeof(close_frame_payload), true, &close_frame, &close_frame_length) != 0)
     {
         LogError("Encoding of CLOSE failed.");
         result = __FAILURE__;
     }
     else
     {
-        close_frame = BUFFER_u_char(close_frame_buffer);
-        close_frame_length = BUFFER_length(close_frame_buffer);
-
         /* Codes_SRS_UWS_CLIENT_01_471: [ The callback `on_underlying_io_close_sent` shall be passed as argument to `xio_send`. ]*/
         if (xio_send(uws_client->underlying_io, close_frame, close_frame_length, unchecked_on_send_complete, NULL) != 0)
         {
@@ -649,8 +708,6 @@ static int send_close_frame(UWS_CLIENT_INSTANCE* uws_client, unsigned int close_
         {
             result = 0;
         }
-
-        BUFFER_delete(close_frame_buffer);
     }
 
     return result;
@@ -1022,7 +1079,7 @@ static int ParseHttpResponse(const char* src, int* dst)
     return result;
 }
 
-static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, size_t length, size_t needed_bytes)
+static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, const unsigned char* payload, size_t length)
 {
     int result;
     unsigned char *new_fragment_bytes = (unsigned char *)realloc(uws_client->fragment_buffer, uws_client->fragment_buffer_count + length);
@@ -1036,7 +1093,7 @@ static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, size_t length
     else
     {
         uws_client->fragment_buffer = new_fragment_bytes;
-        (void)memcpy(uws_client->fragment_buffer + uws_client->fragment_buffer_count, uws_client->stream_buffer + needed_bytes - length, length);
+        (void)memcpy(uws_client->fragment_buffer + uws_client->fragment_buffer_count, payload, length);
         uws_client->fragment_buffer_count += length;
         result = 0;
     }
@@ -1060,6 +1117,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
         else
         {
             unsigned char decode_stream = 1;
+            bool decode_in_place = false;
 
             switch (uws_client->uws_state)
             {
@@ -1100,8 +1158,15 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
             case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
             {
                 /* Codes_SRS_UWS_CLIENT_01_385: [ If the state of the uws instance is OPEN, the received bytes shall be used for decoding WebSocket frames. ]*/
-                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->stream_buffer, uws_client->stream_buffer_count + size + 1);
-                if (new_received_bytes == NULL)
+                unsigned char* new_received_bytes;
+
+                if (uws_client->stream_buffer_count == 0)
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_534: [ If no bytes are left over from previous calls, frames shall be decoded directly from `buffer` without copying it. ]*/
+                    decode_in_place = true;
+                    decode_stream = 1;
+                }
+                else if ((new_received_bytes = (unsigned char*)realloc(uws_client->stream_buffer, uws_client->stream_buffer_count + size + 1)) == NULL)
                 {
                     /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
                     LogError("Cannot allocate memory for received data");
@@ -1192,15 +1257,17 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 {
                     size_t needed_bytes = 2;
                     size_t length;
+                    const unsigned char* frame_bytes = decode_in_place ? buffer : uws_client->stream_buffer;
+                    size_t frame_bytes_count = decode_in_place ? size : uws_client->stream_buffer_count;
 
                     /* Codes_SRS_UWS_CLIENT_01_277: [ To receive WebSocket data, an endpoint listens on the underlying network connection. ]*/
                     /* Codes_SRS_UWS_CLIENT_01_278: [ Incoming data MUST be parsed as WebSocket frames as defined in Section 5.2. ]*/
-                    if (uws_client->stream_buffer_count >= needed_bytes)
+                    if (frame_bytes_count >= needed_bytes)
                     {
                         unsigned char has_error = 0;
 
                         /* Codes_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-                        if ((uws_client->stream_buffer[1] & 0x80) != 0)
+                        if ((frame_bytes[1] & 0x80) != 0)
                         {
                             /* Codes_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
                             /* Codes_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
@@ -1210,16 +1277,16 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
 
                         /* Codes_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
                         /* Codes_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-                        length = uws_client->stream_buffer[1];
+                        length = frame_bytes[1];
 
                         if (length == 126)
                         {
                             /* Codes_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
                             needed_bytes += 2;
-                            if (uws_client->stream_buffer_count >= needed_bytes)
+                            if (frame_bytes_count >= needed_bytes)
                             {
                                 /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                length = ((size_t)(uws_client->stream_buffer[2]) << 8) + (size_t)uws_client->stream_buffer[3];
+                                length = ((size_t)(frame_bytes[2]) << 8) + (size_t)frame_bytes[3];
 
                                 if (length < 126)
                                 {
@@ -1240,9 +1307,9 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         {
                             /* Codes_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
                             needed_bytes += 8;
-                            if (uws_client->stream_buffer_count >= needed_bytes)
+                            if (frame_bytes_count >= needed_bytes)
                             {
-                                if ((uws_client->stream_buffer[2] & 0x80) != 0)
+                                if ((frame_bytes[2] & 0x80) != 0)
                                 {
                                     LogError("Bad frame: received a 64 bit length frame with the highest bit set");
 
@@ -1253,14 +1320,14 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 else
                                 {
                                     /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                    length = (size_t)(((uint64_t)(uws_client->stream_buffer[2]) << 56) +
-                                        (((uint64_t)uws_client->stream_buffer[3]) << 48) +
-                                        (((uint64_t)uws_client->stream_buffer[4]) << 40) +
-                                        (((uint64_t)uws_client->stream_buffer[5]) << 32) +
-                                        (((uint64_t)uws_client->stream_buffer[6]) << 24) +
-                                        (((uint64_t)uws_client->stream_buffer[7]) << 16) +
-                                        (((uint64_t)uws_client->stream_buffer[8]) << 8) +
-                                        (uint64_t)(uws_client->stream_buffer[9]));
+                                    length = (size_t)(((uint64_t)(frame_bytes[2]) << 56) +
+                                        (((uint64_t)frame_bytes[3]) << 48) +
+                                        (((uint64_t)frame_bytes[4]) << 40) +
+                                        (((uint64_t)frame_bytes[5]) << 32) +
+                                        (((uint64_t)frame_bytes[6]) << 24) +
+                                        (((uint64_t)frame_bytes[7]) << 16) +
+                                        (((uint64_t)frame_bytes[8]) << 8) +
+                                        (uint64_t)(frame_bytes[9]));
 
                                     if (length < 65536)
                                     {
@@ -1284,12 +1351,12 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         }
 
                         if ((has_error == 0) &&
-                            (uws_client->stream_buffer_count >= needed_bytes))
+                            (frame_bytes_count >= needed_bytes))
                         {
-                            unsigned char opcode = uws_client->stream_buffer[0] & 0xF;
+                            unsigned char opcode = frame_bytes[0] & 0xF;
 
                             /* Codes_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-                            bool is_final = (uws_client->stream_buffer[0] & 0x80) != 0;
+                            bool is_final = (frame_bytes[0] & 0x80) != 0;
 
                             switch (opcode)
                             {
@@ -1301,7 +1368,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-                                if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
+                                if (process_frame_fragment(uws_client, frame_bytes + needed_bytes - length, length) != 0)
                                 {
                                     break;
                                 }
@@ -1335,7 +1402,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
                                 if (is_final)
                                 {
-                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, uws_client->stream_buffer + needed_bytes - length, length);
+                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, frame_bytes + needed_bytes - length, length);
                                 }
                                 else
                                 {
@@ -1350,7 +1417,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-                                    if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
+                                    if (process_frame_fragment(uws_client, frame_bytes + needed_bytes - length, length) != 0)
                                     {
                                         break;
                                     }
@@ -1375,7 +1442,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
                                 if (is_final)
                                 {
-                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, uws_client->stream_buffer + needed_bytes - length, length);
+                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, frame_bytes + needed_bytes - length, length);
                                 }
                                 else
                                 {
@@ -1390,7 +1457,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-                                    if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
+                                    if (process_frame_fragment(uws_client, frame_bytes + needed_bytes - length, length) != 0)
                                     {
                                         break;
                                     }
@@ -1410,10 +1477,10 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             {
                                 uint16_t close_code;
                                 uint16_t* close_code_ptr;
-                                const unsigned char* data_ptr = uws_client->stream_buffer + needed_bytes - length;
+                                const unsigned char* data_ptr = frame_bytes + needed_bytes - length;
                                 const unsigned char* extra_data_ptr;
                                 size_t extra_data_length;
-                                unsigned char* close_frame_bytes;
+                                const unsigned char* close_frame_bytes;
                                 size_t close_frame_length;
                                 bool utf8_error = false;
 
@@ -1474,8 +1541,6 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 }
                                 else
                                 {
-                                    BUFFER_HANDLE close_frame_buffer;
-
                                     if (uws_client->uws_state == UWS_STATE_CLOSING_WAITING_FOR_CLOSE)
                                     {
                                         uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
@@ -1496,8 +1561,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_242: [ It SHOULD do so as soon as practical. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_239: [ Close frames sent from client to server must be masked as per Section 5.3. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                    close_frame_buffer = uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0);
-                                    if (close_frame_buffer == NULL)
+                                    if (encode_frame_in_send_buffer(uws_client, WS_CLOSE_FRAME, NULL, 0, true, &close_frame_bytes, &close_frame_length) != 0)
                                     {
                                         LogError("Cannot encode the response CLOSE frame");
 
@@ -1512,8 +1576,6 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     }
                                     else
                                     {
-                                        close_frame_bytes = BUFFER_u_char(close_frame_buffer);
-                                        close_frame_length = BUFFER_length(close_frame_buffer);
                                         if (xio_send(uws_client->underlying_io, close_frame_bytes, close_frame_length, on_underlying_io_close_sent, uws_client) != 0)
                                         {
                                             LogError("Cannot send the response CLOSE frame");
@@ -1527,8 +1589,6 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                                 uws_client->uws_state = UWS_STATE_CLOSED;
                                             }
                                         }
-
-                                        BUFFER_delete(close_frame_buffer);
                                     }
                                 }
 
@@ -1546,9 +1606,8 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             {
                                 /* Codes_SRS_UWS_CLIENT_01_249: [ Upon receipt of a Ping frame, an endpoint MUST send a Pong frame in response ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_250: [ It SHOULD respond with Pong frame as soon as is practical. ]*/
-                                unsigned char* pong_frame;
+                                const unsigned char* pong_frame;
                                 size_t pong_frame_length;
-                                BUFFER_HANDLE pong_frame_buffer;
 
                                 /* Codes_SRS_UWS_CLIENT_01_215: [ Control frames themselves MUST NOT be fragmented. ]*/
                                 if (!is_final)
@@ -1559,22 +1618,17 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 }
 
                                 /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                pong_frame_buffer = uws_frame_encoder_encode(WS_PONG_FRAME, uws_client->stream_buffer + needed_bytes - length, length, true, true, 0);
-                                if (pong_frame_buffer == NULL)
+                                /* Codes_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
+                                if (encode_frame_in_send_buffer(uws_client, WS_PONG_FRAME, frame_bytes + needed_bytes - length, length, true, &pong_frame, &pong_frame_length) != 0)
                                 {
                                     LogError("Encoding of PONG failed.");
                                 }
                                 else
                                 {
-                                    /* Codes_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
-                                    pong_frame = BUFFER_u_char(pong_frame_buffer);
-                                    pong_frame_length = BUFFER_length(pong_frame_buffer);
                                     if (xio_send(uws_client->underlying_io, pong_frame, pong_frame_length, unchecked_on_send_complete, NULL) != 0)
                                     {
                                         LogError("Sending PONG frame failed.");
                                     }
-
-                                    BUFFER_delete(pong_frame_buffer);
                                 }
 
                                 break;
@@ -1584,7 +1638,15 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 break;
                             }
 
-                            consume_stream_buffer_bytes(uws_client, needed_bytes);
+                            if (decode_in_place)
+                            {
+                                buffer += needed_bytes;
+                                size -= needed_bytes;
+                            }
+                            else
+                            {
+                                consume_stream_buffer_bytes(uws_client, needed_bytes);
+                            }
                         }
                     }
 
@@ -1592,6 +1654,25 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 }
                 }
             }
+
+            if (decode_in_place &&
+                (size > 0))
+            {
+                /* Codes_SRS_UWS_CLIENT_01_535: [ The bytes of an incomplete frame left at the end of `buffer` shall be saved for decoding together with the bytes received by the next call. ]*/
+                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->stream_buffer, uws_client->stream_buffer_count + size + 1);
+                if (new_received_bytes == NULL)
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
+                    LogError("Cannot allocate memory for received data");
+                    indicate_ws_error(uws_client, WS_ERROR_NOT_ENOUGH_MEMORY);
+                }
+                else
+                {
+                    uws_client->stream_buffer = new_received_bytes;
+                    (void)memcpy(uws_client->stream_buffer + uws_client->stream_buffer_count, buffer, size);
+                    uws_client->stream_buffer_count += size;
+                }
+            }
         }
     }
 }
@@ -1940,31 +2021,24 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
         }
         else
         {
-            BUFFER_HANDLE non_control_frame_buffer;
+            const unsigned char* encoded_frame;
+            size_t encoded_frame_length;
 
-            /* Codes_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode` and passing to it the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_425: [ Encoding shall be done in place in the send buffer by calling `uws_frame_encoder_encode_in_place` and passing to it the `size` argument as payload length, the `is_final` flag and setting `is_masked` to true. ]*/
             /* Codes_SRS_UWS_CLIENT_01_270: [ An endpoint MUST encapsulate the /data/ in a WebSocket frame as defined in Section 5.2. ]*/
             /* Codes_SRS_UWS_CLIENT_01_272: [ The opcode (frame-opcode) of the first frame containing the data MUST be set to the appropriate value from Section 5.2 for data that is to be interpreted by the recipient as text or binary data. ]*/
             /* Codes_SRS_UWS_CLIENT_01_274: [ If the data is being sent by the client, the frame(s) MUST be masked as defined in Section 5.3. ]*/
-            non_control_frame_buffer = uws_frame_encoder_encode((WS_FRAME_TYPE)frame_type, buffer, size, true, is_final, 0);
-            if (non_control_frame_buffer == NULL)
+            if (encode_frame_in_send_buffer(uws_client, (WS_FRAME_TYPE)frame_type, buffer, size, is_final, &encoded_frame, &encoded_frame_length) != 0)
             {
-                /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode_in_place` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
                 LogError("Failed encoding WebSocket frame");
                 free(ws_pending_send);
                 result = __FAILURE__;
             }
             else
             {
-                const unsigned char* encoded_frame;
-                size_t encoded_frame_length;
                 LIST_ITEM_HANDLE new_pending_send_list_item;
 
-                /* Codes_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
-                encoded_frame = BUFFER_u_char(non_control_frame_buffer);
-                /* Codes_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
-                encoded_frame_length = BUFFER_length(non_control_frame_buffer);
-
                 /* Codes_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
                 /* Codes_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
                 /* Codes_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
@@ -2012,8 +2086,6 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
                         result = 0;
                     }
                 }
-
-                BUFFER_delete(non_control_frame_buffer);
             }
         }
     }
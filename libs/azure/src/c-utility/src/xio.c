@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xio.h"
@@ -10,6 +11,11 @@
 
 static const char* CONCRETE_OPTIONS = "concreteOptions";
 
+/* segments that add up to this size are copied together and sent with one concrete_io_send, so a tlsio sends them in one record */
+#ifndef XIO_SEGMENTS_GATHER_SIZE
+#define XIO_SEGMENTS_GATHER_SIZE    1024
+#endif
+
 typedef struct XIO_INSTANCE_TAG
 {
     const IO_INTERFACE_DESCRIPTION* io_interface_description;
@@ -154,6 +160,88 @@ int xio_send(XIO_HANDLE xio, const void* buffer, size_t size, ON_SEND_COMPLETE o
     return result;
 }
 
+int xio_send_segments(XIO_HANDLE xio, const BUFFER_SEGMENT* segments, size_t segment_count, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    int result;
+
+    /* Codes_SRS_XIO_01_040: [If xio or segments is NULL or segment_count is 0, xio_send_segments shall return a non-zero value.] */
+    if ((xio == NULL) || (segments == NULL) || (segment_count == 0))
+    {
+        LogError("Invalid arguments: xio = %p, segments = %p, segment_count = %lu", xio, segments, (unsigned long)segment_count);
+        result = __FAILURE__;
+    }
+    else
+    {
+        XIO_INSTANCE* xio_instance = (XIO_INSTANCE*)xio;
+        size_t last_segment = segment_count - 1;
+        size_t total_size = 0;
+        size_t i;
+
+        /* stops counting as soon as the segments cannot be gathered, so the sum never overflows */
+        for (i = 0; (i < segment_count) && (total_size <= XIO_SEGMENTS_GATHER_SIZE); i++)
+        {
+            if (segments[i].size > XIO_SEGMENTS_GATHER_SIZE - total_size)
+            {
+                total_size = XIO_SEGMENTS_GATHER_SIZE + 1;
+            }
+            else
+            {
+                total_size += segments[i].size;
+            }
+        }
+
+        /* Codes_SRS_XIO_01_041: [Empty segments shall be skipped, except that the completion callback always travels with the last non-empty segment.] */
+        while ((last_segment > 0) && (segments[last_segment].size == 0))
+        {
+            last_segment--;
+        }
+
+        result = 0;
+        if (total_size <= XIO_SEGMENTS_GATHER_SIZE)
+        {
+            unsigned char gather_buffer[XIO_SEGMENTS_GATHER_SIZE];
+            size_t offset = 0;
+
+            /* Codes_SRS_XIO_01_045: [If the segments add up to XIO_SEGMENTS_GATHER_SIZE bytes or less, xio_send_segments shall copy them into one buffer and call concrete_io_send once with on_send_complete and callback_context.] */
+            for (i = 0; i <= last_segment; i++)
+            {
+                if (segments[i].size != 0)
+                {
+                    (void)memcpy(gather_buffer + offset, segments[i].data, segments[i].size);
+                    offset += segments[i].size;
+                }
+            }
+
+            if (xio_instance->io_interface_description->concrete_io_send(xio_instance->concrete_xio_handle, gather_buffer, offset, on_send_complete, callback_context) != 0)
+            {
+                /* Codes_SRS_XIO_01_044: [If any concrete_io_send call fails, xio_send_segments shall stop and return a non-zero value; on_send_complete shall not be called for that send.] */
+                LogError("Failed sending %lu gathered bytes", (unsigned long)offset);
+                result = __FAILURE__;
+            }
+        }
+        else
+        {
+            for (i = 0; (result == 0) && (i <= last_segment); i++)
+            {
+                if ((segments[i].size != 0) || (i == last_segment))
+                {
+                    /* Codes_SRS_XIO_01_042: [Otherwise xio_send_segments shall call concrete_io_send once per segment, in order, so that the bytes are queued back to back without being copied into an intermediate buffer.] */
+                    /* Codes_SRS_XIO_01_043: [Only the call for the last segment shall carry on_send_complete and callback_context; the preceding calls shall pass NULL.] */
+                    if (xio_instance->io_interface_description->concrete_io_send(xio_instance->concrete_xio_handle, segments[i].data, segments[i].size,
+                        (i == last_segment) ? on_send_complete : NULL, (i == last_segment) ? callback_context : NULL) != 0)
+                    {
+                        /* Codes_SRS_XIO_01_044: [If any concrete_io_send call fails, xio_send_segments shall stop and return a non-zero value; on_send_complete shall not be called for that send.] */
+                        LogError("Failed sending segment %lu of %lu", (unsigned long)i, (unsigned long)segment_count);
+                        result = __FAILURE__;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 void xio_dowork(XIO_HANDLE xio)
 {
     /* Codes_SRS_XIO_01_018: [When the handle argument is NULL, xio_dowork shall do nothing.] */
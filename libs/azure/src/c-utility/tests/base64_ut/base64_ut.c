@@ -1802,5 +1802,207 @@ TEST_FUNCTION(Base64_Decoder_invalid_length_fails_6)
 
 }
 
+/*Tests_SRS_BASE64_01_001: [ Base64_Encoded_Length shall return the number of characters in the base64 encoding of size bytes, not counting the null terminator. ]*/
+TEST_FUNCTION(Base64_Encoded_Length_matches_the_encodings)
+{
+    size_t i;
+
+    ASSERT_ARE_EQUAL(size_t, 0, Base64_Encoded_Length(0));
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///act
+        size_t result = Base64_Encoded_Length(testVector_BINARY_with_equal_signs[i].inputLength);
+
+        ///assert
+        ASSERT_ARE_EQUAL(size_t, strlen(testVector_BINARY_with_equal_signs[i].expectedOutput), result);
+    }
+}
+
+/*Tests_SRS_BASE64_01_002: [ If destination is NULL, or source is NULL and size is not 0, Base64_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Encode_To_Buffer_with_NULL_source_fails)
+{
+    ///arrange
+    char destination[8];
+
+    ///act
+    int result = Base64_Encode_To_Buffer(NULL, 1, destination, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_01_002: [ If destination is NULL, or source is NULL and size is not 0, Base64_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Encode_To_Buffer_with_NULL_destination_fails)
+{
+    ///act
+    int result = Base64_Encode_To_Buffer((const unsigned char*)"a", 1, NULL, 8);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_01_003: [ If destinationSize is smaller than Base64_Encoded_Length(size) + 1, Base64_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Encode_To_Buffer_with_no_room_for_the_null_terminator_fails)
+{
+    ///arrange
+    char destination[5] = { 'x', 'x', 'x', 'x', 'x' };
+
+    ///act
+    int result = Base64_Encode_To_Buffer((const unsigned char*)"a", 1, destination, 4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 'x', destination[0]);
+}
+
+/*Tests_SRS_BASE64_01_004: [ Base64_Encode_To_Buffer shall write the base64 encoding of the size bytes at source to destination, '=' padded and null terminated, and return 0. ]*/
+TEST_FUNCTION(Base64_Encode_To_Buffer_with_zero_size_writes_empty_string)
+{
+    ///arrange
+    char destination[1] = { 'x' };
+
+    ///act
+    int result = Base64_Encode_To_Buffer((const unsigned char*)"a", 0, destination, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, '\0', destination[0]);
+}
+
+/*Tests_SRS_BASE64_01_004: [ Base64_Encode_To_Buffer shall write the base64 encoding of the size bytes at source to destination, '=' padded and null terminated, and return 0. ]*/
+TEST_FUNCTION(Base64_Encode_To_Buffer_exhaustive_succeeds)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        char destination[32];
+        int result;
+
+        ///act
+        result = Base64_Encode_To_Buffer(testVector_BINARY_with_equal_signs[i].inputData, testVector_BINARY_with_equal_signs[i].inputLength, destination, Base64_Encoded_Length(testVector_BINARY_with_equal_signs[i].inputLength) + 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector_BINARY_with_equal_signs[i].expectedOutput, destination);
+    }
+}
+
+/*Tests_SRS_BASE64_01_009: [ If source is NULL or its length is not a multiple of 4, Base64_Decoded_Length shall return 0. ]*/
+TEST_FUNCTION(Base64_Decoded_Length_with_invalid_source_returns_0)
+{
+    ///act & assert
+    ASSERT_ARE_EQUAL(size_t, 0, Base64_Decoded_Length(NULL));
+    ASSERT_ARE_EQUAL(size_t, 0, Base64_Decoded_Length("12345"));
+}
+
+/*Tests_SRS_BASE64_01_010: [ Otherwise Base64_Decoded_Length shall return the number of bytes source decodes to, as given by its length and padding. ]*/
+TEST_FUNCTION(Base64_Decoded_Length_matches_the_inputs)
+{
+    size_t i;
+
+    ASSERT_ARE_EQUAL(size_t, 0, Base64_Decoded_Length(""));
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///act
+        size_t result = Base64_Decoded_Length(testVector_BINARY_with_equal_signs[i].expectedOutput);
+
+        ///assert
+        ASSERT_ARE_EQUAL(size_t, testVector_BINARY_with_equal_signs[i].inputLength, result);
+    }
+}
+
+/*Tests_SRS_BASE64_01_011: [ If source, destination or decodedSize is NULL, Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Decode_To_Buffer_with_NULL_arguments_fails)
+{
+    ///arrange
+    unsigned char destination[3];
+    size_t decodedSize;
+
+    ///act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer(NULL, destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YWJj", NULL, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YWJj", destination, sizeof(destination), NULL));
+}
+
+/*Tests_SRS_BASE64_01_012: [ If the length of source is not a multiple of 4, or source contains anything but base64 characters followed by at most 2 '=', Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Decode_To_Buffer_with_invalid_length_fails)
+{
+    ///arrange
+    unsigned char destination[8];
+    size_t decodedSize;
+
+    ///act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("=", destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YWJ", destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YWJjZ", destination, sizeof(destination), &decodedSize));
+}
+
+/*Tests_SRS_BASE64_01_012: [ If the length of source is not a multiple of 4, or source contains anything but base64 characters followed by at most 2 '=', Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Decode_To_Buffer_with_invalid_characters_fails)
+{
+    ///arrange
+    unsigned char destination[8];
+    size_t decodedSize;
+
+    ///act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YW-j", destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YW j", destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("Y=Jj", destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("Y===", destination, sizeof(destination), &decodedSize));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_Decode_To_Buffer("YQ==YWJj", destination, sizeof(destination), &decodedSize));
+}
+
+/*Tests_SRS_BASE64_01_013: [ If destinationSize is smaller than the decoded size, Base64_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_Decode_To_Buffer_with_small_destination_fails)
+{
+    ///arrange
+    unsigned char destination[3];
+    size_t decodedSize;
+
+    ///act
+    int result = Base64_Decode_To_Buffer("YWJjZA==", destination, sizeof(destination), &decodedSize);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_01_014: [ Otherwise Base64_Decode_To_Buffer shall decode source into destination, set decodedSize to the number of bytes written and return 0. ]*/
+TEST_FUNCTION(Base64_Decode_To_Buffer_with_empty_source_succeeds)
+{
+    ///arrange
+    unsigned char destination[1];
+    size_t decodedSize = 42;
+
+    ///act
+    int result = Base64_Decode_To_Buffer("", destination, 0, &decodedSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, decodedSize);
+}
+
+/*Tests_SRS_BASE64_01_014: [ Otherwise Base64_Decode_To_Buffer shall decode source into destination, set decodedSize to the number of bytes written and return 0. ]*/
+TEST_FUNCTION(Base64_Decode_To_Buffer_exhaustive_succeeds)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        unsigned char destination[16];
+        size_t decodedSize;
+        int result;
+
+        ///act
+        result = Base64_Decode_To_Buffer(testVector_BINARY_with_equal_signs[i].expectedOutput, destination, testVector_BINARY_with_equal_signs[i].inputLength, &decodedSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, testVector_BINARY_with_equal_signs[i].inputLength, decodedSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, testVector_BINARY_with_equal_signs[i].inputData, decodedSize));
+    }
+}
 
 END_TEST_SUITE(base64_unittests);
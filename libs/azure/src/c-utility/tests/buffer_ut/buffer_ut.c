@@ -1632,4 +1632,368 @@ BEGIN_TEST_SUITE(Buffer_UnitTests)
         BUFFER_delete(buffer);
     }
 
+    /* BUFFER_reserve */
+
+    /* Tests_SRS_BUFFER_01_030: [ If handle is NULL, BUFFER_reserve shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_reserve_handle_NULL_fails)
+    {
+        ///arrange
+
+        ///act
+        int result = BUFFER_reserve(NULL, 5, ALLOCATION_SIZE);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BUFFER_01_031: [ If both headroom and capacity are 0, BUFFER_reserve shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_reserve_zero_headroom_and_capacity_fails)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        umock_c_reset_all_calls();
+
+        ///act
+        int result = BUFFER_reserve(g_hBuffer, 0, 0);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_032: [ BUFFER_reserve shall make sure that at least headroom bytes are available in front of the content and that the content can grow to capacity bytes without reallocating. ]*/
+    /* Tests_SRS_BUFFER_01_035: [ On success, BUFFER_reserve shall return 0. ]*/
+    /* Tests_SRS_BUFFER_01_026: [ If the buffer is in reserved mode, BUFFER_enlarge shall use the tailroom, growing the storage geometrically when the tailroom is too small. ]*/
+    TEST_FUNCTION(BUFFER_reserve_then_enlarge_does_not_allocate)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(5 + ALLOCATION_SIZE));
+
+        ///act
+        int result = BUFFER_reserve(g_hBuffer, 5, ALLOCATION_SIZE);
+        int enlargeResult = BUFFER_enlarge(g_hBuffer, ALLOCATION_SIZE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(int, 0, enlargeResult);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_033: [ Existing content shall be preserved. ]*/
+    TEST_FUNCTION(BUFFER_reserve_preserves_existing_content)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_build(g_hBuffer, BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(5 + TOTAL_ALLOCATION_SIZE));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        int result = BUFFER_reserve(g_hBuffer, 5, TOTAL_ALLOCATION_SIZE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_034: [ If allocating memory fails, BUFFER_reserve shall return a non-zero value and leave the buffer unchanged. ]*/
+    TEST_FUNCTION(BUFFER_reserve_malloc_fails)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_build(g_hBuffer, BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        whenShallmalloc_fail = currentmalloc_call + 1;
+        STRICT_EXPECTED_CALL(gballoc_malloc(5 + TOTAL_ALLOCATION_SIZE));
+
+        ///act
+        int result = BUFFER_reserve(g_hBuffer, 5, TOTAL_ALLOCATION_SIZE);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_023: [ If the buffer is in reserved mode, BUFFER_append_build shall copy source into the tailroom, growing the storage geometrically when the tailroom is too small. ]*/
+    TEST_FUNCTION(BUFFER_append_build_reserved_grows_geometrically)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_reserve(g_hBuffer, 0, ALLOCATION_SIZE);
+        (void)BUFFER_append_build(g_hBuffer, BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 2 * ALLOCATION_SIZE))
+            .IgnoreArgument(1);
+
+        ///act
+        int result = BUFFER_append_build(g_hBuffer, ADDITIONAL_BUFFER, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE + 1, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), TOTAL_BUFFER, ALLOCATION_SIZE + 1));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* BUFFER_prepend_build */
+
+    /* Tests_SRS_BUFFER_01_036: [ If handle or source are NULL or if size is 0, BUFFER_prepend_build shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_prepend_build_handle_NULL_fails)
+    {
+        ///arrange
+
+        ///act
+        int result = BUFFER_prepend_build(NULL, BUFFER_Test1, BUFFER_TEST1_SIZE);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BUFFER_01_036: [ If handle or source are NULL or if size is 0, BUFFER_prepend_build shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_prepend_build_source_NULL_fails)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        umock_c_reset_all_calls();
+
+        ///act
+        int result = BUFFER_prepend_build(g_hBuffer, NULL, BUFFER_TEST1_SIZE);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_036: [ If handle or source are NULL or if size is 0, BUFFER_prepend_build shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_prepend_build_size_0_fails)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        umock_c_reset_all_calls();
+
+        ///act
+        int result = BUFFER_prepend_build(g_hBuffer, BUFFER_Test1, 0);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_039: [ BUFFER_prepend_build shall copy size bytes from source right in front of the existing content and return 0. ]*/
+    TEST_FUNCTION(BUFFER_prepend_build_uses_headroom_without_allocating)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_reserve(g_hBuffer, BUFFER_TEST1_SIZE, BUFFER_TEST2_SIZE);
+        (void)BUFFER_append_build(g_hBuffer, BUFFER_Test2, BUFFER_TEST2_SIZE);
+        umock_c_reset_all_calls();
+
+        ///act
+        int result = BUFFER_prepend_build(g_hBuffer, BUFFER_Test1, BUFFER_TEST1_SIZE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, BUFFER_TEST1_SIZE + BUFFER_TEST2_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), BUFFER_TEST_VALUE, BUFFER_TEST1_SIZE + BUFFER_TEST2_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_037: [ If the headroom is smaller than size, BUFFER_prepend_build shall grow the headroom first, switching the buffer into reserved mode if needed. ]*/
+    TEST_FUNCTION(BUFFER_prepend_build_on_plain_buffer_succeeds)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_build(g_hBuffer, BUFFER_Test2, BUFFER_TEST2_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(BUFFER_TEST1_SIZE + BUFFER_TEST2_SIZE));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        int result = BUFFER_prepend_build(g_hBuffer, BUFFER_Test1, BUFFER_TEST1_SIZE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, BUFFER_TEST1_SIZE + BUFFER_TEST2_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), BUFFER_TEST_VALUE, BUFFER_TEST1_SIZE + BUFFER_TEST2_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_038: [ If allocating memory fails, BUFFER_prepend_build shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_prepend_build_malloc_fails)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_build(g_hBuffer, BUFFER_Test2, BUFFER_TEST2_SIZE);
+        umock_c_reset_all_calls();
+
+        whenShallmalloc_fail = currentmalloc_call + 1;
+        STRICT_EXPECTED_CALL(gballoc_malloc(BUFFER_TEST1_SIZE + BUFFER_TEST2_SIZE));
+
+        ///act
+        int result = BUFFER_prepend_build(g_hBuffer, BUFFER_Test1, BUFFER_TEST1_SIZE);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, BUFFER_TEST2_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_027: [ If the buffer is in reserved mode, BUFFER_shrink shall only move the content boundaries; removed bytes at the beginning become headroom and removed bytes at the end become tailroom. ]*/
+    TEST_FUNCTION(BUFFER_shrink_reserved_then_prepend_reuses_storage)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_reserve(g_hBuffer, 0, ALLOCATION_SIZE);
+        (void)BUFFER_append_build(g_hBuffer, BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        ///act
+        int shrinkResult = BUFFER_shrink(g_hBuffer, BUFFER_TEST1_SIZE, false);
+        int prependResult = BUFFER_prepend_build(g_hBuffer, BUFFER_Test1, BUFFER_TEST1_SIZE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, shrinkResult);
+        ASSERT_ARE_EQUAL(int, 0, prependResult);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_021: [ If the buffer is in reserved mode, BUFFER_build with size 0 shall keep the reserved storage and only set the size to 0. ]*/
+    /* Tests_SRS_BUFFER_01_022: [ If the buffer is in reserved mode, BUFFER_build shall reuse the reserved storage, growing it only when size exceeds the room after the headroom. ]*/
+    TEST_FUNCTION(BUFFER_build_reserved_reuses_storage)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_reserve(g_hBuffer, 5, ALLOCATION_SIZE);
+        (void)BUFFER_build(g_hBuffer, BUFFER_Test1, BUFFER_TEST1_SIZE);
+        umock_c_reset_all_calls();
+
+        ///act
+        int clearResult = BUFFER_build(g_hBuffer, NULL, 0);
+        int buildResult = BUFFER_build(g_hBuffer, BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, clearResult);
+        ASSERT_ARE_EQUAL(int, 0, buildResult);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(g_hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_025: [ If the buffer is in reserved mode, BUFFER_unbuild shall free the reserved storage and return the buffer to its unallocated state. ]*/
+    TEST_FUNCTION(BUFFER_unbuild_reserved_frees_storage)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_reserve(g_hBuffer, 5, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        int result = BUFFER_unbuild(g_hBuffer);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 0, BUFFER_length(g_hBuffer));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* BUFFER_get_segment */
+
+    /* Tests_SRS_BUFFER_01_040: [ If handle or segment are NULL, BUFFER_get_segment shall return a non-zero value. ]*/
+    TEST_FUNCTION(BUFFER_get_segment_segment_NULL_fails)
+    {
+        ///arrange
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        umock_c_reset_all_calls();
+
+        ///act
+        int result = BUFFER_get_segment(g_hBuffer, NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_01_041: [ BUFFER_get_segment shall fill segment with a pointer to the content and its length, without copying. ]*/
+    TEST_FUNCTION(BUFFER_get_segment_succeeds)
+    {
+        ///arrange
+        BUFFER_SEGMENT segment;
+        BUFFER_HANDLE g_hBuffer = BUFFER_new();
+        (void)BUFFER_build(g_hBuffer, BUFFER_Test1, BUFFER_TEST1_SIZE);
+        umock_c_reset_all_calls();
+
+        ///act
+        int result = BUFFER_get_segment(g_hBuffer, &segment);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(void_ptr, BUFFER_u_char(g_hBuffer), segment.data);
+        ASSERT_ARE_EQUAL(size_t, BUFFER_TEST1_SIZE, segment.size);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        BUFFER_delete(g_hBuffer);
+    }
+
 END_TEST_SUITE(Buffer_UnitTests)
@@ -0,0 +1,143 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Measures the throughput of the base64 and URL codecs, once through the STRING/BUFFER returning functions
+   and once through the *_To_Buffer functions that write into caller memory, on SAS token sized inputs. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/urlencode.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/buffer_.h"
+
+#define PERF_ITERATIONS     200000
+/* a HMAC-SHA256 signature, and the scope of a device SAS token */
+#define PERF_BINARY_SIZE    32
+#define PERF_URL_TEXT       "myhub.azure-devices.net/devices/my device+1/messages/events?x=1&y=2"
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, double start, size_t bytes)
+{
+    double elapsed = now_seconds() - start;
+    (void)printf("%-32s %8.1f ns/op %8.1f MB/s\n", name,
+        elapsed * 1e9 / PERF_ITERATIONS,
+        (double)bytes * PERF_ITERATIONS / elapsed / 1e6);
+}
+
+int main(void)
+{
+    int result = 0;
+    unsigned char binary[PERF_BINARY_SIZE];
+    char encoded[64];
+    unsigned char decoded[PERF_BINARY_SIZE];
+    char urlEncoded[256];
+    char urlDecoded[256];
+    size_t decodedSize;
+    size_t i;
+    /* keeps the compiler from dropping the loops */
+    size_t checksum = 0;
+    double start;
+
+    for (i = 0; i < PERF_BINARY_SIZE; i++)
+    {
+        binary[i] = (unsigned char)(i * 37 + 11);
+    }
+    if ((Base64_Encode_To_Buffer(binary, PERF_BINARY_SIZE, encoded, sizeof(encoded)) != 0) ||
+        (URL_Encode_To_Buffer(PERF_URL_TEXT, urlEncoded, sizeof(urlEncoded)) != 0))
+    {
+        (void)printf("failed to prepare the inputs\n");
+        return 1;
+    }
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        STRING_HANDLE s = Base64_Encode_Bytes(binary, PERF_BINARY_SIZE);
+        checksum += (unsigned char)STRING_c_str(s)[i % 40];
+        STRING_delete(s);
+    }
+    report("Base64_Encode_Bytes", start, PERF_BINARY_SIZE);
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        (void)Base64_Encode_To_Buffer(binary, PERF_BINARY_SIZE, encoded, sizeof(encoded));
+        checksum += (unsigned char)encoded[i % 40];
+    }
+    report("Base64_Encode_To_Buffer", start, PERF_BINARY_SIZE);
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        BUFFER_HANDLE b = Base64_Decoder(encoded);
+        checksum += BUFFER_u_char(b)[i % PERF_BINARY_SIZE];
+        BUFFER_delete(b);
+    }
+    report("Base64_Decoder", start, PERF_BINARY_SIZE);
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        (void)Base64_Decode_To_Buffer(encoded, decoded, sizeof(decoded), &decodedSize);
+        checksum += decoded[i % PERF_BINARY_SIZE];
+    }
+    report("Base64_Decode_To_Buffer", start, PERF_BINARY_SIZE);
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        STRING_HANDLE s = URL_EncodeString(PERF_URL_TEXT);
+        checksum += (unsigned char)STRING_c_str(s)[i % 64];
+        STRING_delete(s);
+    }
+    report("URL_EncodeString", start, sizeof(PERF_URL_TEXT) - 1);
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        (void)URL_Encode_To_Buffer(PERF_URL_TEXT, urlEncoded, sizeof(urlEncoded));
+        checksum += (unsigned char)urlEncoded[i % 64];
+    }
+    report("URL_Encode_To_Buffer", start, sizeof(PERF_URL_TEXT) - 1);
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        STRING_HANDLE s = URL_DecodeString(urlEncoded);
+        checksum += (unsigned char)STRING_c_str(s)[i % 64];
+        STRING_delete(s);
+    }
+    report("URL_DecodeString", start, strlen(urlEncoded));
+
+    start = now_seconds();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+    {
+        (void)URL_Decode_To_Buffer(urlEncoded, urlDecoded, sizeof(urlDecoded));
+        checksum += (unsigned char)urlDecoded[i % 64];
+    }
+    report("URL_Decode_To_Buffer", start, strlen(urlEncoded));
+
+    if ((Base64_Decode_To_Buffer(encoded, decoded, sizeof(decoded), &decodedSize) != 0) ||
+        (decodedSize != PERF_BINARY_SIZE) ||
+        (memcmp(decoded, binary, PERF_BINARY_SIZE) != 0) ||
+        (URL_Decode_To_Buffer(urlEncoded, urlDecoded, sizeof(urlDecoded)) != 0) ||
+        (strcmp(urlDecoded, PERF_URL_TEXT) != 0))
+    {
+        (void)printf("round trip failed\n");
+        result = 1;
+    }
+
+    (void)printf("checksum %lu\n", (unsigned long)checksum);
+    return result;
+}
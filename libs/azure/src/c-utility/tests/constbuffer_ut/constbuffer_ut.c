@@ -77,6 +77,15 @@ size_t my_BUFFER_length(BUFFER_HANDLE handle)
     return result;
 }
 
+static size_t g_custom_free_calls;
+static void* g_custom_free_context;
+
+static void test_custom_free(void* context)
+{
+    g_custom_free_calls++;
+    g_custom_free_context = context;
+}
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
@@ -118,6 +127,8 @@ BEGIN_TEST_SUITE(constbuffer_unittests)
         }
 
         umock_c_reset_all_calls();
+        g_custom_free_calls = 0;
+        g_custom_free_context = NULL;
     }
 
     TEST_FUNCTION_CLEANUP(cleans)
@@ -342,6 +353,85 @@ BEGIN_TEST_SUITE(constbuffer_unittests)
         CONSTBUFFER_Destroy(handle);
     }
 
+    /*Tests_SRS_CONSTBUFFER_01_001: [ If source is NULL and size is different than 0 then CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_with_invalid_args_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+
+        ///act
+        handle = CONSTBUFFER_CreateWithCustomFree(NULL, 1, test_custom_free, (void*)0x42);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(size_t, 0, g_custom_free_calls);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_01_003: [ Otherwise CONSTBUFFER_CreateWithCustomFree shall return a non-NULL handle whose content is source and size, without copying the memory area. ]*/
+    /*Tests_SRS_CONSTBUFFER_01_004: [ The non-NULL handle returned by CONSTBUFFER_CreateWithCustomFree shall have its ref count set to "1". ]*/
+    /*Tests_SRS_CONSTBUFFER_01_005: [ If the refcount reaches zero and the handle was created by CONSTBUFFER_CreateWithCustomFree with a non-NULL customFreeFunc, CONSTBUFFER_Destroy shall call customFreeFunc with customFreeFuncContext. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_succeeds)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+        const CONSTBUFFER* content;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+        ///act
+        handle = CONSTBUFFER_CreateWithCustomFree(BUFFER1_u_char, BUFFER1_length, test_custom_free, (void*)0x42);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        content = CONSTBUFFER_GetContent(handle);
+        /*testing that it is a pointer assignment and not a copy*/
+        ASSERT_ARE_EQUAL(void_ptr, BUFFER1_u_char, content->buffer);
+        ASSERT_ARE_EQUAL(size_t, BUFFER1_length, content->size);
+
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        CONSTBUFFER_Destroy(handle);
+        ASSERT_ARE_EQUAL(size_t, 1, g_custom_free_calls);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)0x42, g_custom_free_context);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_01_005: [ If the refcount reaches zero and the handle was created by CONSTBUFFER_CreateWithCustomFree with a non-NULL customFreeFunc, CONSTBUFFER_Destroy shall call customFreeFunc with customFreeFuncContext. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_frees_after_the_last_clone)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle = CONSTBUFFER_CreateWithCustomFree(BUFFER1_u_char, BUFFER1_length, test_custom_free, NULL);
+        CONSTBUFFER_HANDLE clone = CONSTBUFFER_Clone(handle);
+
+        ///act
+        CONSTBUFFER_Destroy(handle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(size_t, 0, g_custom_free_calls);
+        CONSTBUFFER_Destroy(clone);
+        ASSERT_ARE_EQUAL(size_t, 1, g_custom_free_calls);
+    }
+
+    /*Tests_SRS_CONSTBUFFER_01_002: [ If allocating the handle fails then CONSTBUFFER_CreateWithCustomFree shall return NULL and shall not call customFreeFunc. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_fails_when_malloc_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .SetReturn(NULL);
+
+        ///act
+        handle = CONSTBUFFER_CreateWithCustomFree(BUFFER1_u_char, BUFFER1_length, test_custom_free, NULL);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(size_t, 0, g_custom_free_calls);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
     /*Tests_SRS_CONSTBUFFER_02_011: [If constbufferHandle is NULL then CONSTBUFFER_GetContent shall return NULL.]*/
     TEST_FUNCTION(CONSTBUFFER_GetContent_with_NULL_returns_NULL)
     {
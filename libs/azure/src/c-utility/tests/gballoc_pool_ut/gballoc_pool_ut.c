@@ -0,0 +1,1067 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#if defined(GB_MEASURE_MEMORY_FOR_THIS)
+#undef GB_MEASURE_MEMORY_FOR_THIS
+#endif
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/* the test code itself needs the real malloc family */
+#define GB_POOL_DO_NOT_REDIRECT
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/lock.h"
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)~(size_t)0)
+#endif
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+static const LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4244;
+
+/* bigger than the largest size class */
+#define TEST_FALLBACK_SIZE  1024
+
+#define ENABLE_MOCKS
+
+#include "umock_c.h"
+#include "umock_c_prod.h"
+
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, void*, mock_malloc, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_calloc, size_t, nmemb, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_realloc, void*, ptr, size_t, size);
+    MOCKABLE_FUNCTION(, void, mock_free, void*, ptr);
+
+    MOCKABLE_FUNCTION(, LOCK_HANDLE, Lock_Init);
+    MOCKABLE_FUNCTION(, LOCK_RESULT, Lock_Deinit, LOCK_HANDLE, handle);
+    MOCKABLE_FUNCTION(, LOCK_RESULT, Lock, LOCK_HANDLE, handle);
+    MOCKABLE_FUNCTION(, LOCK_RESULT, Unlock, LOCK_HANDLE, handle);
+#ifdef __cplusplus
+}
+#endif
+
+#undef ENABLE_MOCKS
+
+static void* my_mock_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_mock_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_mock_free(void* ptr)
+{
+    free(ptr);
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(GBAllocPool_UnitTests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    result = umock_c_init(on_umock_c_error);
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mock_malloc, my_mock_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_realloc, my_mock_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_free, my_mock_free);
+
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    /* every test releases its blocks, so this also gives the slabs back */
+    gballoc_deinit();
+
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* gballoc_init */
+
+/* Tests_SRS_GBALLOC_POOL_01_002: [ gballoc_init shall create a lock handle that will be used to make the other gballoc APIs thread-safe. ]*/
+TEST_FUNCTION(gballoc_init_creates_the_lock)
+{
+    ///arrange
+    int result;
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    ///act
+    result = gballoc_init();
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_003: [ If the Lock creation fails, gballoc_init shall return a non-zero value. ]*/
+TEST_FUNCTION(when_Lock_Init_fails_gballoc_init_fails)
+{
+    ///arrange
+    int result;
+    STRICT_EXPECTED_CALL(Lock_Init())
+        .SetReturn((LOCK_HANDLE)NULL);
+
+    ///act
+    result = gballoc_init();
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_001: [ Init after Init shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(gballoc_init_after_gballoc_init_fails)
+{
+    ///arrange
+    int result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    ///act
+    result = gballoc_init();
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_004: [ gballoc_init shall reset the maximum memory used to the memory used by the live blocks, the allocation count to zero, the per class peaks to the current live counts and the failures to zero. ]*/
+TEST_FUNCTION(gballoc_init_resets_the_counters)
+{
+    ///arrange
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    gballoc_free(gballoc_malloc(10));
+    gballoc_deinit();
+
+    ///act
+    (void)gballoc_init();
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(0, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.peak);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.failures);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_004: [ gballoc_init shall reset the maximum memory used to the memory used by the live blocks, the allocation count to zero, the per class peaks to the current live counts and the failures to zero. ]*/
+TEST_FUNCTION(gballoc_init_keeps_accounting_for_blocks_that_are_still_live)
+{
+    ///arrange
+    void* block;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    gballoc_deinit();
+
+    ///act
+    (void)gballoc_init();
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 10, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 10, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+    gballoc_free(block);
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+}
+
+/* gballoc_deinit */
+
+/* Tests_SRS_GBALLOC_POOL_01_005: [ gballoc_deinit shall return the slabs of every size class that has no live block to the heap. ]*/
+/* Tests_SRS_GBALLOC_POOL_01_006: [ gballoc_deinit shall free the lock created by gballoc_init. ]*/
+TEST_FUNCTION(gballoc_deinit_frees_the_empty_slabs_and_the_lock)
+{
+    ///arrange
+    (void)gballoc_init();
+    gballoc_free(gballoc_malloc(10));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+
+    ///act
+    gballoc_deinit();
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_005: [ gballoc_deinit shall return the slabs of every size class that has no live block to the heap. ]*/
+TEST_FUNCTION(gballoc_deinit_keeps_the_slabs_with_live_blocks)
+{
+    ///arrange
+    void* block;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+
+    ///act
+    gballoc_deinit();
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    (void)gballoc_init();
+    gballoc_free(block);
+}
+
+/* gballoc_malloc */
+
+/* Tests_SRS_GBALLOC_POOL_01_007: [ gballoc_malloc shall ensure thread safety by using the lock created by gballoc_init. ]*/
+/* Tests_SRS_GBALLOC_POOL_01_009: [ gballoc_malloc shall serve the request from the free list of the smallest size class that fits size, adding a slab to that class if its free list is empty. ]*/
+TEST_FUNCTION(gballoc_malloc_adds_a_slab_for_the_first_block_of_a_class)
+{
+    ///arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_malloc(20);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_009: [ gballoc_malloc shall serve the request from the free list of the smallest size class that fits size, adding a slab to that class if its free list is empty. ]*/
+TEST_FUNCTION(gballoc_malloc_serves_the_next_block_from_the_slab)
+{
+    ///arrange
+    void* first;
+    void* result;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    first = gballoc_malloc(20);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_malloc(32);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_NOT_EQUAL(void_ptr, first, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(1, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 32, statistics.block_size);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.live);
+
+    ///cleanup
+    gballoc_free(first);
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_026: [ gballoc_free shall put a pooled block back on the free list of its class and give a fallback block back to the heap. ]*/
+TEST_FUNCTION(gballoc_malloc_reuses_a_freed_block)
+{
+    ///arrange
+    void* first;
+    void* result;
+    (void)gballoc_init();
+    first = gballoc_malloc(100);
+    gballoc_free(first);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_malloc(100);
+
+    ///assert
+    ASSERT_ARE_EQUAL(void_ptr, first, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_010: [ If size is bigger than the biggest class, or the class already has GB_POOL_MAX_SLABS_PER_CLASS slabs, or allocating the slab fails, gballoc_malloc shall allocate from the fallback heap. ]*/
+TEST_FUNCTION(gballoc_malloc_with_a_size_bigger_than_the_biggest_class_uses_the_fallback_heap)
+{
+    ///arrange
+    void* result;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_malloc(TEST_FALLBACK_SIZE);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(gballoc_getPoolClassCount(), &statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.live);
+    ASSERT_ARE_EQUAL(size_t, TEST_FALLBACK_SIZE, statistics.reserved);
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_010: [ If size is bigger than the biggest class, or the class already has GB_POOL_MAX_SLABS_PER_CLASS slabs, or allocating the slab fails, gballoc_malloc shall allocate from the fallback heap. ]*/
+TEST_FUNCTION(when_allocating_the_slab_fails_gballoc_malloc_uses_the_fallback_heap)
+{
+    ///arrange
+    void* result;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_malloc(8);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(0, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.failures);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.live);
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(gballoc_getPoolClassCount(), &statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.live);
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_011: [ If the fallback heap allocation fails, gballoc_malloc shall return NULL. ]*/
+TEST_FUNCTION(when_the_fallback_heap_fails_gballoc_malloc_fails)
+{
+    ///arrange
+    void* result;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_malloc(TEST_FALLBACK_SIZE);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(gballoc_getPoolClassCount(), &statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.failures);
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_008: [ If acquiring the lock fails, gballoc_malloc shall return NULL. ]*/
+TEST_FUNCTION(when_acquiring_the_lock_fails_gballoc_malloc_fails)
+{
+    ///arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE))
+        .SetReturn(LOCK_ERROR);
+
+    ///act
+    result = gballoc_malloc(1);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(gballoc_malloc_before_gballoc_init_does_not_use_the_lock)
+{
+    ///arrange
+    void* result;
+
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+
+    ///act
+    result = gballoc_malloc(TEST_FALLBACK_SIZE);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* gballoc_calloc */
+
+/* Tests_SRS_GBALLOC_POOL_01_013: [ gballoc_calloc shall allocate nmemb * size bytes like gballoc_malloc and zero them. ]*/
+TEST_FUNCTION(gballoc_calloc_returns_a_zeroed_block)
+{
+    ///arrange
+    unsigned char* result;
+    size_t i;
+    (void)gballoc_init();
+    result = (unsigned char*)gballoc_malloc(48);
+    (void)memset(result, 0xAA, 48);
+    gballoc_free(result);
+    umock_c_reset_all_calls();
+
+    ///act
+    result = (unsigned char*)gballoc_calloc(4, 12);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    for (i = 0; i < 48; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, (int)result[i]);
+    }
+    ASSERT_ARE_EQUAL(size_t, 48, gballoc_getCurrentMemoryUsed());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_012: [ If nmemb * size overflows, gballoc_calloc shall return NULL. ]*/
+TEST_FUNCTION(when_nmemb_times_size_overflows_gballoc_calloc_fails)
+{
+    ///arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    ///act
+    result = gballoc_calloc(SIZE_MAX / 2, 4);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* gballoc_realloc */
+
+/* Tests_SRS_GBALLOC_POOL_01_014: [ When ptr is NULL, gballoc_realloc shall behave like gballoc_malloc. ]*/
+TEST_FUNCTION(gballoc_realloc_with_NULL_allocates_a_block)
+{
+    ///arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_realloc(NULL, 20);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 20, gballoc_getCurrentMemoryUsed());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_015: [ gballoc_realloc shall ensure thread safety by using the lock created by gballoc_init. ]*/
+/* Tests_SRS_GBALLOC_POOL_01_018: [ If the block already holds size bytes, gballoc_realloc shall return ptr and only update the accounted size. ]*/
+TEST_FUNCTION(gballoc_realloc_within_the_block_size_returns_the_same_block)
+{
+    ///arrange
+    void* block;
+    void* result;
+    (void)gballoc_init();
+    block = gballoc_malloc(40);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_realloc(block, 64);
+
+    ///assert
+    ASSERT_ARE_EQUAL(void_ptr, block, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 64, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 64, gballoc_getMaximumMemoryUsed());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_021: [ Otherwise gballoc_realloc shall allocate a block for size bytes, copy the contents of ptr into it and release ptr. ]*/
+TEST_FUNCTION(gballoc_realloc_to_a_bigger_class_moves_the_contents)
+{
+    ///arrange
+    unsigned char* block;
+    unsigned char* result;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    block = (unsigned char*)gballoc_malloc(10);
+    (void)memcpy(block, "0123456789", 10);
+
+    ///act
+    result = (unsigned char*)gballoc_realloc(block, 200);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_NOT_EQUAL(void_ptr, block, result);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(result, "0123456789", 10));
+    ASSERT_ARE_EQUAL(size_t, 200, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(0, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.live);
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(4, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.live);
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_019: [ If ptr and the new size both belong to the fallback heap, gballoc_realloc shall call realloc on the underlying block. ]*/
+TEST_FUNCTION(gballoc_realloc_of_a_fallback_block_reallocs_the_underlying_block)
+{
+    ///arrange
+    void* block;
+    void* result;
+    (void)gballoc_init();
+    block = gballoc_malloc(TEST_FALLBACK_SIZE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_realloc(block, 2 * TEST_FALLBACK_SIZE);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2 * TEST_FALLBACK_SIZE, gballoc_getCurrentMemoryUsed());
+
+    ///cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_020: [ When the underlying allocation fails, gballoc_realloc shall return NULL and leave ptr untouched. ]*/
+TEST_FUNCTION(when_the_underlying_realloc_fails_gballoc_realloc_fails)
+{
+    ///arrange
+    void* block;
+    void* result;
+    (void)gballoc_init();
+    block = gballoc_malloc(TEST_FALLBACK_SIZE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_realloc(block, 2 * TEST_FALLBACK_SIZE);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, TEST_FALLBACK_SIZE, gballoc_getCurrentMemoryUsed());
+
+    ///cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_020: [ When the underlying allocation fails, gballoc_realloc shall return NULL and leave ptr untouched. ]*/
+TEST_FUNCTION(when_allocating_the_new_block_fails_gballoc_realloc_fails)
+{
+    ///arrange
+    void* block;
+    void* result;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_realloc(block, TEST_FALLBACK_SIZE);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 10, gballoc_getCurrentMemoryUsed());
+
+    ///cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_016: [ If acquiring the lock fails, gballoc_realloc shall return NULL. ]*/
+TEST_FUNCTION(when_acquiring_the_lock_fails_gballoc_realloc_fails)
+{
+    ///arrange
+    void* block;
+    void* result;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE))
+        .SetReturn(LOCK_ERROR);
+
+    ///act
+    result = gballoc_realloc(block, 20);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_017: [ When ptr was not allocated by gballoc, gballoc_realloc shall return NULL. ]*/
+TEST_FUNCTION(gballoc_realloc_of_a_foreign_pointer_fails)
+{
+    ///arrange
+    void* foreign = calloc(1, 128);
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_realloc((unsigned char*)foreign + 64, 20);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    free(foreign);
+}
+
+/* gballoc_free */
+
+/* Tests_SRS_GBALLOC_POOL_01_022: [ If ptr is NULL, gballoc_free shall do nothing. ]*/
+TEST_FUNCTION(gballoc_free_with_NULL_does_nothing)
+{
+    ///arrange
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    ///act
+    gballoc_free(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_023: [ gballoc_free shall ensure thread safety by using the lock created by gballoc_init. ]*/
+/* Tests_SRS_GBALLOC_POOL_01_026: [ gballoc_free shall put a pooled block back on the free list of its class and give a fallback block back to the heap. ]*/
+TEST_FUNCTION(gballoc_free_of_a_fallback_block_frees_it)
+{
+    ///arrange
+    void* block;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    block = gballoc_malloc(TEST_FALLBACK_SIZE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    gballoc_free(block);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(gballoc_getPoolClassCount(), &statistics));
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.live);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.reserved);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_024: [ If acquiring the lock fails, gballoc_free shall do nothing. ]*/
+TEST_FUNCTION(when_acquiring_the_lock_fails_gballoc_free_does_nothing)
+{
+    ///arrange
+    void* block;
+    (void)gballoc_init();
+    block = gballoc_malloc(TEST_FALLBACK_SIZE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE))
+        .SetReturn(LOCK_ERROR);
+
+    ///act
+    gballoc_free(block);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, TEST_FALLBACK_SIZE, gballoc_getCurrentMemoryUsed());
+
+    ///cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_025: [ When ptr was not allocated by gballoc, gballoc_free shall log an error and not free any memory. ]*/
+TEST_FUNCTION(gballoc_free_of_a_foreign_pointer_does_not_free_it)
+{
+    ///arrange
+    void* foreign = calloc(1, 128);
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    gballoc_free((unsigned char*)foreign + 64);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    free(foreign);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_025: [ When ptr was not allocated by gballoc, gballoc_free shall log an error and not free any memory. ]*/
+TEST_FUNCTION(gballoc_free_of_a_foreign_pointer_behind_a_copied_pool_header_does_not_free_it)
+{
+    ///arrange
+    unsigned char* first;
+    unsigned char* second;
+    unsigned char* foreign = (unsigned char*)calloc(1, 128);
+    size_t header_size;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    /* the first blocks of a new slab are handed out in address order, so they are one stride apart */
+    first = (unsigned char*)gballoc_malloc(16);
+    second = (unsigned char*)gballoc_malloc(16);
+    header_size = (size_t)(second - first) - 16;
+    (void)memcpy(foreign + 64 - header_size, second - header_size, header_size);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    gballoc_free(foreign + 64);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(0, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.live);
+
+    ///cleanup
+    gballoc_free(first);
+    gballoc_free(second);
+    free(foreign);
+}
+
+/* counters */
+
+/* Tests_SRS_GBALLOC_POOL_01_027: [ If gballoc was not initialized gballoc_getMaximumMemoryUsed, gballoc_getCurrentMemoryUsed shall return SIZE_MAX and gballoc_getAllocationCount shall return 0. ]*/
+TEST_FUNCTION(the_counters_without_gballoc_init_report_no_data)
+{
+    ///arrange
+
+    ///act
+    size_t maximum = gballoc_getMaximumMemoryUsed();
+    size_t current = gballoc_getCurrentMemoryUsed();
+    size_t count = gballoc_getAllocationCount();
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, SIZE_MAX, maximum);
+    ASSERT_ARE_EQUAL(size_t, SIZE_MAX, current);
+    ASSERT_ARE_EQUAL(size_t, 0, count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_028: [ gballoc_getMaximumMemoryUsed shall return the maximum amount of requested bytes alive at the same time since gballoc_init. ]*/
+/* Tests_SRS_GBALLOC_POOL_01_029: [ gballoc_getCurrentMemoryUsed shall return the amount of requested bytes currently alive. ]*/
+/* Tests_SRS_GBALLOC_POOL_01_030: [ gballoc_getAllocationCount shall return the number of successful allocations since gballoc_init. ]*/
+TEST_FUNCTION(the_counters_track_the_requested_bytes)
+{
+    ///arrange
+    void* block1;
+    void* block2;
+    size_t maximum;
+    size_t current;
+    size_t count;
+    (void)gballoc_init();
+    block1 = gballoc_malloc(10);
+    block2 = gballoc_malloc(TEST_FALLBACK_SIZE);
+    gballoc_free(block2);
+    umock_c_reset_all_calls();
+
+    ///act
+    maximum = gballoc_getMaximumMemoryUsed();
+    current = gballoc_getCurrentMemoryUsed();
+    count = gballoc_getAllocationCount();
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 10 + TEST_FALLBACK_SIZE, maximum);
+    ASSERT_ARE_EQUAL(size_t, 10, current);
+    ASSERT_ARE_EQUAL(size_t, 2, count);
+
+    ///cleanup
+    gballoc_free(block1);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_031: [ gballoc_resetMetrics shall reset the max allocation size to the memory used by the live blocks, the number of allocations to zero, the per class peaks to the current live counts and the failures to zero. ]*/
+TEST_FUNCTION(gballoc_resetMetrics_resets_the_counters)
+{
+    ///arrange
+    void* block1;
+    void* block2;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    block1 = gballoc_malloc(10);
+    block2 = gballoc_malloc(10);
+    gballoc_free(block2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    gballoc_resetMetrics();
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 10, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 10, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+    ASSERT_ARE_EQUAL(int, 0, gballoc_getPoolStatistics(0, &statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.live);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.peak);
+
+    ///cleanup
+    gballoc_free(block1);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_031: [ gballoc_resetMetrics shall reset the max allocation size to the memory used by the live blocks, the number of allocations to zero, the per class peaks to the current live counts and the failures to zero. ]*/
+TEST_FUNCTION(freeing_a_block_allocated_before_gballoc_resetMetrics_keeps_the_memory_used_accurate)
+{
+    ///arrange
+    void* block1;
+    void* block2;
+    (void)gballoc_init();
+    block1 = gballoc_malloc(10);
+    block2 = gballoc_malloc(TEST_FALLBACK_SIZE);
+    gballoc_resetMetrics();
+    block1 = gballoc_realloc(block1, 20);
+    umock_c_reset_all_calls();
+
+    ///act
+    gballoc_free(block2);
+    gballoc_free(block1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    /* the realloc moved block1 to the 32 bytes class, so for a moment both copies were live */
+    ASSERT_ARE_EQUAL(size_t, 10 + 20 + TEST_FALLBACK_SIZE, gballoc_getMaximumMemoryUsed());
+}
+
+/* gballoc_getPoolClassCount */
+
+/* Tests_SRS_GBALLOC_POOL_01_032: [ gballoc_getPoolClassCount shall return the number of slab size classes. ]*/
+TEST_FUNCTION(gballoc_getPoolClassCount_returns_the_number_of_classes)
+{
+    ///arrange
+
+    ///act
+    size_t result = gballoc_getPoolClassCount();
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 5, result);
+}
+
+/* gballoc_getPoolStatistics */
+
+/* Tests_SRS_GBALLOC_POOL_01_033: [ If statistics is NULL or class_index is greater than gballoc_getPoolClassCount(), gballoc_getPoolStatistics shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(gballoc_getPoolStatistics_with_NULL_statistics_fails)
+{
+    ///arrange
+    int result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    ///act
+    result = gballoc_getPoolStatistics(0, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_033: [ If statistics is NULL or class_index is greater than gballoc_getPoolClassCount(), gballoc_getPoolStatistics shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(gballoc_getPoolStatistics_with_an_out_of_range_class_fails)
+{
+    ///arrange
+    int result;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    ///act
+    result = gballoc_getPoolStatistics(gballoc_getPoolClassCount() + 1, &statistics);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_034: [ If gballoc was not initialized gballoc_getPoolStatistics shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(gballoc_getPoolStatistics_without_gballoc_init_fails)
+{
+    ///arrange
+    int result;
+    GBALLOC_POOL_STATISTICS statistics;
+
+    ///act
+    result = gballoc_getPoolStatistics(0, &statistics);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_036: [ Otherwise gballoc_getPoolStatistics shall report the block size, live and peak block counts, failures and the bytes held in slabs of the class. ]*/
+TEST_FUNCTION(gballoc_getPoolStatistics_reports_a_size_class)
+{
+    ///arrange
+    int result;
+    void* block1;
+    void* block2;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    block1 = gballoc_malloc(60);
+    block2 = gballoc_malloc(64);
+    gballoc_free(block2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = gballoc_getPoolStatistics(2, &statistics);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 64, statistics.block_size);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.live);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.peak);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.failures);
+    ASSERT_IS_TRUE(statistics.reserved >= 64);
+
+    ///cleanup
+    gballoc_free(block1);
+}
+
+/* Tests_SRS_GBALLOC_POOL_01_035: [ For class_index equal to gballoc_getPoolClassCount(), gballoc_getPoolStatistics shall report the fallback heap, with block_size 0 and reserved set to the bytes currently allocated from it. ]*/
+TEST_FUNCTION(gballoc_getPoolStatistics_reports_the_fallback_heap)
+{
+    ///arrange
+    int result;
+    void* block1;
+    void* block2;
+    GBALLOC_POOL_STATISTICS statistics;
+    (void)gballoc_init();
+    block1 = gballoc_malloc(TEST_FALLBACK_SIZE);
+    block2 = gballoc_malloc(TEST_FALLBACK_SIZE);
+    gballoc_free(block2);
+    umock_c_reset_all_calls();
+
+    ///act
+    result = gballoc_getPoolStatistics(gballoc_getPoolClassCount(), &statistics);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.block_size);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.live);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.peak);
+    ASSERT_ARE_EQUAL(size_t, TEST_FALLBACK_SIZE, statistics.reserved);
+
+    ///cleanup
+    gballoc_free(block1);
+}
+
+END_TEST_SUITE(GBAllocPool_UnitTests)
@@ -0,0 +1,659 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+#include "azure_c_shared_utility/optimize_size.h"
+
+static size_t currentmalloc_call = 0;
+static size_t whenShallmalloc_fail = 0;
+
+void* my_gballoc_malloc(size_t size)
+{
+    void* result;
+    currentmalloc_call++;
+    if ((whenShallmalloc_fail > 0) && (currentmalloc_call == whenShallmalloc_fail))
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = malloc(size);
+    }
+    return result;
+}
+
+void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+#define ENABLE_MOCKS
+
+#include "azure_c_shared_utility/strings.h"
+
+STRING_HANDLE my_STRING_construct(const char* psz)
+{
+    (void)psz;
+    return (STRING_HANDLE)malloc(1);
+}
+
+void my_STRING_delete(STRING_HANDLE handle)
+{
+    free(handle);
+}
+
+STRING_HANDLE my_STRING_new_JSON(const char* source)
+{
+    (void)source;
+    return (STRING_HANDLE)malloc(1);
+}
+
+#include "azure_c_shared_utility/gballoc.h"
+
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/map.h"
+
+TEST_DEFINE_ENUM_TYPE(MAP_RESULT, MAP_RESULT_VALUES)
+IMPLEMENT_UMOCK_C_ENUM_TYPE(MAP_RESULT, MAP_RESULT_VALUES);
+
+#define TEST_PROPERTY_COUNT 40
+
+static const char* TEST_REDKEY = "testRedKey";
+static const char* TEST_REDVALUE = "testRedValue";
+
+static const char* TEST_YELLOWKEY = "testYellowKey";
+static const char* TEST_YELLOWVALUE = "testYellowValue";
+
+static const char* TEST_BLUEKEY = "testBlueKey";
+static const char* TEST_BLUEVALUE = "cyan";
+
+static int DontAllowCapitalsFilters(const char* mapProperty, const char* mapValue)
+{
+    int result = 0;
+    const char* iterator = mapProperty;
+    (void)mapValue;
+    while (*iterator != '\0')
+    {
+        if (*iterator >= 'A' && *iterator <= 'Z')
+        {
+            result = __FAILURE__;
+            break;
+        }
+        iterator++;
+    }
+    return result;
+}
+
+static MAP_HANDLE create_map_with_properties(size_t count)
+{
+    MAP_HANDLE result = Map_Create(NULL);
+    size_t i;
+    ASSERT_IS_NOT_NULL(result);
+    for (i = 0; i < count; i++)
+    {
+        char key[32];
+        char value[32];
+        (void)sprintf(key, "key%u", (unsigned int)i);
+        (void)sprintf(value, "value%u", (unsigned int)i);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(result, key, value));
+    }
+    return result;
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(map_indexed_unittests)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        int result;
+
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        umock_c_init(on_umock_c_error);
+
+        result = umocktypes_charptr_register_types();
+        ASSERT_ARE_EQUAL(int, 0, result);
+
+        REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_construct, my_STRING_construct);
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_new_JSON, my_STRING_new_JSON);
+        REGISTER_GLOBAL_MOCK_RETURN(STRING_concat, 0);
+        REGISTER_GLOBAL_MOCK_RETURN(STRING_concat_with_STRING, 0);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+
+        currentmalloc_call = 0;
+        whenShallmalloc_fail = 0;
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /*Tests_SRS_MAP_02_001: [Map_Create shall create a new, empty map.]*/
+    /*Tests_SRS_MAP_02_003: [Otherwise, it shall return a non-NULL handle that can be used in subsequent calls.] */
+    TEST_FUNCTION(Map_Create_succeeds_with_no_allocation_besides_handle)
+    {
+        ///arrange
+        MAP_HANDLE handle;
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+        ///act
+        handle = Map_Create(NULL);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_GetInternals(handle, &keys, &values, &count));
+        ASSERT_ARE_EQUAL(size_t, 0, count);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_002: [If during creation there are any error, then Map_Create shall return NULL.]*/
+    TEST_FUNCTION(Map_Create_fails_when_malloc_fails)
+    {
+        ///arrange
+        MAP_HANDLE handle;
+        whenShallmalloc_fail = 1;
+
+        ///act
+        handle = Map_Create(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+    }
+
+    /*Tests_SRS_MAP_02_005: [If parameter handle is NULL then Map_Destroy shall take no action.] */
+    TEST_FUNCTION(Map_Destroy_with_NULL_does_nothing)
+    {
+        ///act
+        Map_Destroy(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_MAP_02_006: [If parameter handle is NULL then Map_Add shall return MAP_INVALID_ARG.] */
+    /*Tests_SRS_MAP_02_007: [If parameter key is NULL then Map_Add shall return MAP_INVALID_ARG.]*/
+    /*Tests_SRS_MAP_02_008: [If parameter value is NULL then Map_Add shall return MAP_INVALID_ARG.] */
+    TEST_FUNCTION(Map_Add_with_NULL_arguments_fails)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+
+        ///act + assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_INVALIDARG, Map_Add(NULL, TEST_REDKEY, TEST_REDVALUE));
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_INVALIDARG, Map_Add(handle, NULL, TEST_REDVALUE));
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_INVALIDARG, Map_Add(handle, TEST_REDKEY, NULL));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_010: [Otherwise, Map_Add shall add the pair <key,value> to the map.] */
+    /*Tests_SRS_MAP_02_012: [Otherwise, Map_Add shall return MAP_OK.] */
+    /*Tests_SRS_MAP_02_042: [Otherwise, Map_GetValueFromKey returns the key's value.] */
+    TEST_FUNCTION(Map_Add_then_Map_GetValueFromKey_finds_all_values)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(TEST_PROPERTY_COUNT);
+        size_t i;
+
+        ///act + assert
+        for (i = 0; i < TEST_PROPERTY_COUNT; i++)
+        {
+            char key[32];
+            char value[32];
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)sprintf(value, "value%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(char_ptr, value, Map_GetValueFromKey(handle, key));
+        }
+        ASSERT_IS_NULL(Map_GetValueFromKey(handle, "key_not_there"));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_010: [Otherwise, Map_Add shall add the pair <key,value> to the map.] */
+    TEST_FUNCTION(Map_Add_grows_storage_geometrically)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        size_t i;
+        umock_c_reset_all_calls();
+        currentmalloc_call = 0;
+
+        ///act
+        for (i = 0; i < TEST_PROPERTY_COUNT; i++)
+        {
+            char key[32];
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(handle, key, "v"));
+        }
+
+        ///assert
+        /*40 entries need 4 growths of the index (8, 16, 32, 64 entries) and a couple of arena blocks, not 80 string copies*/
+        ASSERT_IS_TRUE(currentmalloc_call < 10);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_009: [If the key already exists, then Map_Add shall return MAP_KEYEXISTS.] */
+    TEST_FUNCTION(Map_Add_with_existing_key_returns_MAP_KEYEXISTS)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(TEST_PROPERTY_COUNT);
+
+        ///act
+        MAP_RESULT result = Map_Add(handle, "key17", TEST_REDVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_KEYEXISTS, result);
+        ASSERT_ARE_EQUAL(char_ptr, "value17", Map_GetValueFromKey(handle, "key17"));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_07_009: [If the mapFilterCallback function is not NULL, then the return value will be check and if it is not zero then Map_Add shall return MAP_FILTER_REJECT.] */
+    TEST_FUNCTION(Map_Add_rejected_by_filter_returns_MAP_FILTER_REJECT)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(DontAllowCapitalsFilters);
+        bool exists;
+
+        ///act
+        MAP_RESULT result = Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_FILTER_REJECT, result);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_ContainsKey(handle, TEST_REDKEY, &exists));
+        ASSERT_IS_FALSE(exists);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_011: [If adding the pair <key,value> fails then Map_Add shall return MAP_ERROR.] */
+    TEST_FUNCTION(Map_Add_fails_when_malloc_fails)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+        currentmalloc_call = 0;
+        whenShallmalloc_fail = 1;
+
+        ///act
+        MAP_RESULT result = Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_ERROR, result);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_GetInternals(handle, &keys, &values, &count));
+        ASSERT_ARE_EQUAL(size_t, 0, count);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_016: [If the key already exists, then Map_AddOrUpdate shall overwrite the value of the existing key with parameter value.]*/
+    /*Tests_SRS_MAP_02_019: [Otherwise, Map_AddOrUpdate shall return MAP_OK.] */
+    TEST_FUNCTION(Map_AddOrUpdate_overwrites_with_shorter_and_longer_values)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(TEST_PROPERTY_COUNT);
+
+        ///act
+        MAP_RESULT result1 = Map_AddOrUpdate(handle, "key3", "a");
+        MAP_RESULT result2 = Map_AddOrUpdate(handle, "key4", "a value that is a lot longer than the one it replaces");
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result1);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result2);
+        ASSERT_ARE_EQUAL(char_ptr, "a", Map_GetValueFromKey(handle, "key3"));
+        ASSERT_ARE_EQUAL(char_ptr, "a value that is a lot longer than the one it replaces", Map_GetValueFromKey(handle, "key4"));
+        ASSERT_ARE_EQUAL(char_ptr, "value5", Map_GetValueFromKey(handle, "key5"));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_017: [Otherwise, Map_AddOrUpdate shall add the pair <key,value> to the map.]*/
+    TEST_FUNCTION(Map_AddOrUpdate_adds_a_new_key)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+
+        ///act
+        MAP_RESULT result = Map_AddOrUpdate(handle, TEST_BLUEKEY, TEST_BLUEVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEVALUE, Map_GetValueFromKey(handle, TEST_BLUEKEY));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_010: [Otherwise, Map_Add shall add the pair <key,value> to the map.] */
+    TEST_FUNCTION(Map_Add_keeps_previously_returned_values_valid_while_growing)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        const char* redValue;
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        size_t i;
+        redValue = Map_GetValueFromKey(handle, TEST_REDKEY);
+
+        ///act
+        for (i = 0; i < TEST_PROPERTY_COUNT; i++)
+        {
+            char key[32];
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(handle, key, "a value long enough to need more arena blocks"));
+        }
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)redValue, (void*)Map_GetValueFromKey(handle, TEST_REDKEY));
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, redValue);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_010: [Otherwise, Map_Add shall add the pair <key,value> to the map.] */
+    TEST_FUNCTION(Map_Add_with_key_and_value_taken_from_the_same_map_succeeds)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+        size_t i;
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+
+        ///act
+        for (i = 0; i < TEST_PROPERTY_COUNT; i++)
+        {
+            char key[32];
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            /*the value comes from the map itself, adding has to grow the arena several times meanwhile*/
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(handle, key, Map_GetValueFromKey(handle, TEST_REDKEY)));
+        }
+        (void)Map_GetInternals(handle, &keys, &values, &count);
+        MAP_RESULT result = Map_Add(handle, values[count - 1], keys[count - 1]);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, "key39"));
+        ASSERT_ARE_EQUAL(char_ptr, "key39", Map_GetValueFromKey(handle, TEST_REDVALUE));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_016: [If the key already exists, then Map_AddOrUpdate shall overwrite the value of the existing key with parameter value.]*/
+    TEST_FUNCTION(Map_AddOrUpdate_with_value_taken_from_the_same_map_succeeds)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        (void)Map_Add(handle, TEST_BLUEKEY, "a value longer than the red one");
+
+        ///act
+        /*shorter value that is the tail of the current value*/
+        MAP_RESULT result1 = Map_AddOrUpdate(handle, TEST_BLUEKEY, Map_GetValueFromKey(handle, TEST_BLUEKEY) + 2);
+        /*longer value that lives in the same arena*/
+        MAP_RESULT result2 = Map_AddOrUpdate(handle, TEST_REDKEY, Map_GetValueFromKey(handle, TEST_BLUEKEY));
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result1);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result2);
+        ASSERT_ARE_EQUAL(char_ptr, "value longer than the red one", Map_GetValueFromKey(handle, TEST_BLUEKEY));
+        ASSERT_ARE_EQUAL(char_ptr, "value longer than the red one", Map_GetValueFromKey(handle, TEST_REDKEY));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_022: [If key does not exist then Map_Delete shall return MAP_KEYNOTFOUND.]*/
+    TEST_FUNCTION(Map_Delete_with_unknown_key_returns_MAP_KEYNOTFOUND)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(3);
+
+        ///act
+        MAP_RESULT result = Map_Delete(handle, TEST_REDKEY);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_KEYNOTFOUND, result);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_023: [Otherwise, Map_Delete shall remove the key and its associated value from the map and return MAP_OK.]*/
+    /*Tests_SRS_MAP_02_043: [Map_GetInternals shall produce in *keys an pointer to an array of const char* having all the keys stored so far by the map.]*/
+    /*Tests_SRS_MAP_02_044: [Map_GetInternals shall produce in *values a pointer to an array of const char* having all the values stored so far by the map.]*/
+    /*Tests_SRS_MAP_02_045: [  Map_GetInternals shall produce in *count the number of stored keys and values.]*/
+    TEST_FUNCTION(Map_Delete_keeps_insertion_order_in_Map_GetInternals)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        (void)Map_Add(handle, TEST_YELLOWKEY, TEST_YELLOWVALUE);
+        (void)Map_Add(handle, TEST_BLUEKEY, TEST_BLUEVALUE);
+
+        ///act
+        MAP_RESULT result = Map_Delete(handle, TEST_YELLOWKEY);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_GetInternals(handle, &keys, &values, &count));
+        ASSERT_ARE_EQUAL(size_t, 2, count);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDKEY, keys[0]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, values[0]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEKEY, keys[1]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEVALUE, values[1]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEVALUE, Map_GetValueFromKey(handle, TEST_BLUEKEY));
+        ASSERT_IS_NULL(Map_GetValueFromKey(handle, TEST_YELLOWKEY));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_023: [Otherwise, Map_Delete shall remove the key and its associated value from the map and return MAP_OK.]*/
+    TEST_FUNCTION(Map_Delete_all_then_Map_Add_succeeds)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(TEST_PROPERTY_COUNT);
+        size_t i;
+        for (i = 0; i < TEST_PROPERTY_COUNT; i++)
+        {
+            char key[32];
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Delete(handle, key));
+        }
+
+        ///act
+        MAP_RESULT result = Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, TEST_REDKEY));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_025: [Otherwise if a key exists then Map_ContainsKey shall return MAP_OK and shall write in keyExists "true".]*/
+    /*Tests_SRS_MAP_02_028: [Otherwise, if a pair <key, value> has its value equal to the parameter value, the Map_ContainsValue shall return MAP_OK and shall write in valueExists "true".]*/
+    TEST_FUNCTION(Map_ContainsKey_and_Map_ContainsValue_succeed)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(TEST_PROPERTY_COUNT);
+        bool keyExists;
+        bool valueExists;
+
+        ///act
+        MAP_RESULT result1 = Map_ContainsKey(handle, "key39", &keyExists);
+        MAP_RESULT result2 = Map_ContainsValue(handle, "value0", &valueExists);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result1);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result2);
+        ASSERT_IS_TRUE(keyExists);
+        ASSERT_IS_TRUE(valueExists);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_039: [Map_Clone shall make a copy of the map indicated by parameter handle and return a non-NULL handle to it.]*/
+    TEST_FUNCTION(Map_Clone_copies_all_pairs_in_order)
+    {
+        ///arrange
+        MAP_HANDLE handle = create_map_with_properties(TEST_PROPERTY_COUNT);
+        const char*const* keys;
+        const char*const* values;
+        const char*const* clonedKeys;
+        const char*const* clonedValues;
+        size_t count;
+        size_t clonedCount;
+        size_t i;
+        MAP_HANDLE clone;
+        (void)Map_Delete(handle, "key0");
+        (void)Map_AddOrUpdate(handle, "key1", "a value that does not fit where value1 was");
+
+        ///act
+        clone = Map_Clone(handle);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(clone);
+        (void)Map_GetInternals(handle, &keys, &values, &count);
+        (void)Map_GetInternals(clone, &clonedKeys, &clonedValues, &clonedCount);
+        ASSERT_ARE_EQUAL(size_t, count, clonedCount);
+        for (i = 0; i < count; i++)
+        {
+            ASSERT_ARE_EQUAL(char_ptr, keys[i], clonedKeys[i]);
+            ASSERT_ARE_EQUAL(char_ptr, values[i], clonedValues[i]);
+            ASSERT_ARE_EQUAL(char_ptr, values[i], Map_GetValueFromKey(clone, keys[i]));
+        }
+
+        ///cleanup
+        Map_Destroy(clone);
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_02_038: [Map_Clone returns NULL if parameter handle is NULL.]*/
+    TEST_FUNCTION(Map_Clone_with_NULL_returns_NULL)
+    {
+        ///act
+        MAP_HANDLE clone = Map_Clone(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(clone);
+    }
+
+    /*Tests_SRS_MAP_02_046: [If parameter handle, keys, values or count is NULL then Map_GetInternals shall return MAP_INVALIDARG.] */
+    TEST_FUNCTION(Map_GetInternals_with_NULL_handle_fails)
+    {
+        ///arrange
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+
+        ///act
+        MAP_RESULT result = Map_GetInternals(NULL, &keys, &values, &count);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_INVALIDARG, result);
+    }
+
+    /*Tests_SRS_MAP_02_049: [If the MAP is empty, then Map_ToJSON shall produce the string "{}".*/
+    TEST_FUNCTION(Map_ToJSON_on_empty_map_succeeds)
+    {
+        ///arrange
+        MAP_HANDLE handle = Map_Create(NULL);
+        STRING_HANDLE result;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "}"));
+
+        ///act
+        result = Map_ToJSON(handle);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        my_STRING_delete(result);
+        Map_Destroy(handle);
+    }
+
+END_TEST_SUITE(map_indexed_unittests)
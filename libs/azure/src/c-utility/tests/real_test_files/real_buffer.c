@@ -18,6 +18,9 @@
 #define BUFFER_append_build real_BUFFER_append_build
 #define BUFFER_shrink real_BUFFER_shrink
 #define BUFFER_fill real_BUFFER_fill
+#define BUFFER_reserve real_BUFFER_reserve
+#define BUFFER_prepend_build real_BUFFER_prepend_build
+#define BUFFER_get_segment real_BUFFER_get_segment
 
 #define GBALLOC_H
 
@@ -3,6 +3,7 @@
 
 #define CONSTBUFFER_Create real_CONSTBUFFER_Create
 #define CONSTBUFFER_CreateFromBuffer real_CONSTBUFFER_CreateFromBuffer
+#define CONSTBUFFER_CreateWithCustomFree real_CONSTBUFFER_CreateWithCustomFree
 #define CONSTBUFFER_Clone real_CONSTBUFFER_Clone
 #define CONSTBUFFER_GetContent real_CONSTBUFFER_GetContent
 #define CONSTBUFFER_Destroy real_CONSTBUFFER_Destroy
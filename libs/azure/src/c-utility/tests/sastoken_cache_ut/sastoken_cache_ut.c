@@ -0,0 +1,779 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <ctime>
+#else
+#include <stdio.h>
+#include <time.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+#define ENABLE_MOCKS
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/agenttime.h"
+
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/sastoken_cache.h"
+
+#define TEST_DECODEDKEY_HANDLE (BUFFER_HANDLE)0x56
+#define TEST_TIME_T ((time_t)3600)
+#define TEST_LIFETIME ((size_t)3600)
+#define TEST_REFRESH_INTERVAL ((size_t)300)
+
+static const char* TEST_KEY = "a2V5";
+static const char* TEST_SCOPE = "scope";
+static const char* TEST_KEYNAME = "name";
+/* the tokens SASToken_CreateString makes for the key "key" (a2V5) and the scope "scope" */
+static const char* TEST_TOKEN_NO_KEYNAME = "SharedAccessSignature sr=scope&sig=%2fhW50hU6E50ZQ0%2b4xmiI30h4kkbVosqxS29y%2fBtU%2b2I%3d&se=7200";
+static const char* TEST_TOKEN_WITH_KEYNAME = "SharedAccessSignature sr=scope&sig=%2fhW50hU6E50ZQ0%2b4xmiI30h4kkbVosqxS29y%2fBtU%2b2I%3d&se=7200&skn=name";
+static const char* TEST_TOKEN_EXPIRY_7500 = "SharedAccessSignature sr=scope&sig=HUngiF5FR3jMGTAYVan7xroV7BYsXjydvKMDgfirE0c%3d&se=7500&skn=name";
+
+static unsigned char test_decoded_key[3];
+static time_t test_current_time;
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+static time_t my_get_time(time_t* currentTime)
+{
+    (void)currentTime;
+    return test_current_time;
+}
+
+static double my_get_difftime(time_t stopTime, time_t startTime)
+{
+    return (double)(stopTime - startTime);
+}
+
+static BUFFER_HANDLE my_Base64_Decoder(const char* source)
+{
+    (void)source;
+    (void)memcpy(test_decoded_key, "key", sizeof(test_decoded_key));
+    return TEST_DECODEDKEY_HANDLE;
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t length = strlen(source);
+    *destination = (char*)malloc(length + 1);
+    (void)memcpy(*destination, source, length + 1);
+    return 0;
+}
+
+static int my_size_tToString(char* destination, size_t destinationSize, size_t value)
+{
+    (void)snprintf(destination, destinationSize, "%lu", (unsigned long)value);
+    return 0;
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+    static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+    {
+        char temp_str[256];
+        (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+        ASSERT_FAIL(temp_str);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+static void setup_create_expectations(const char* keyName)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_KEY));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SCOPE));
+    if (keyName != NULL)
+    {
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, keyName));
+    }
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+}
+
+BEGIN_TEST_SUITE(sastoken_cache_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_UMOCK_ALIAS_TYPE(time_t, int);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(size_t, unsigned int);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Base64_Decoder, my_Base64_Decoder);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Base64_Decoder, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_u_char, test_decoded_key);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_length, sizeof(test_decoded_key));
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
+    REGISTER_GLOBAL_MOCK_HOOK(size_tToString, my_size_tToString);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(size_tToString, __LINE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(get_time, my_get_time);
+    REGISTER_GLOBAL_MOCK_HOOK(get_difftime, my_get_difftime);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    test_current_time = TEST_TIME_T;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* SASToken_Cache_Create */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_001: [ If key or scope is NULL, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_with_NULL_key_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+
+    ///act
+    handle = SASToken_Cache_Create(NULL, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_001: [ If key or scope is NULL, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_with_NULL_scope_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, NULL, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_002: [ If lifetime is 0 or refresh_interval is 0 or greater than lifetime, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_with_zero_lifetime_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, 0, 0);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_002: [ If lifetime is 0 or refresh_interval is 0 or greater than lifetime, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_with_zero_refresh_interval_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, 0);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_002: [ If lifetime is 0 or refresh_interval is 0 or greater than lifetime, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_with_refresh_interval_greater_than_lifetime_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_LIFETIME + 1);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_004: [ SASToken_Cache_Create shall decode key from base64. ]*/
+/* Tests_SRS_SASTOKEN_CACHE_01_005: [ SASToken_Cache_Create shall hash the decoded key xor-ed with the HMAC inner and outer pads and keep both SHA256 states. ]*/
+/* Tests_SRS_SASTOKEN_CACHE_01_006: [ SASToken_Cache_Create shall copy scope and keyName and allocate a buffer big enough for any token of that scope and keyName. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_succeeds)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    setup_create_expectations(TEST_KEYNAME);
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_005: [ SASToken_Cache_Create shall hash the decoded key xor-ed with the HMAC inner and outer pads and keep both SHA256 states. ]*/
+TEST_FUNCTION(SASToken_Cache_Create_wipes_the_decoded_key)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    unsigned char zeroes[sizeof(test_decoded_key)] = { 0 };
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(zeroes, test_decoded_key, sizeof(test_decoded_key)));
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_cache_fails_SASToken_Cache_Create_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_decoding_the_key_fails_SASToken_Cache_Create_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_KEY))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_the_decoded_key_is_empty_SASToken_Cache_Create_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_KEY));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_copying_the_scope_fails_SASToken_Cache_Create_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_KEY));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SCOPE))
+        .SetReturn(__LINE__);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_003: [ If any error occurs, SASToken_Cache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_token_buffer_fails_SASToken_Cache_Create_fails)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_KEY));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SCOPE));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_KEYNAME));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+
+    ///act
+    handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* SASToken_Cache_Destroy */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_007: [ If handle is NULL, SASToken_Cache_Destroy shall do nothing. ]*/
+TEST_FUNCTION(SASToken_Cache_Destroy_with_NULL_handle_does_nothing)
+{
+    ///arrange
+
+    ///act
+    SASToken_Cache_Destroy(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_008: [ SASToken_Cache_Destroy shall clear the pad states and free all resources used by the cache. ]*/
+TEST_FUNCTION(SASToken_Cache_Destroy_frees_all_resources)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(handle));
+
+    ///act
+    SASToken_Cache_Destroy(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* SASToken_Cache_GetToken */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_009: [ If handle is NULL, SASToken_Cache_GetToken shall return NULL. ]*/
+TEST_FUNCTION(SASToken_Cache_GetToken_with_NULL_handle_fails)
+{
+    ///arrange
+    const char* token;
+
+    ///act
+    token = SASToken_Cache_GetToken(NULL);
+
+    ///assert
+    ASSERT_IS_NULL(token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_012: [ Otherwise SASToken_Cache_GetToken shall generate a token that expires lifetime seconds from now, keep it and return it. ]*/
+TEST_FUNCTION(SASToken_Cache_GetToken_generates_the_same_token_as_SASToken_CreateString)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(TEST_TIME_T, (time_t)0));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 7200));
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_WITH_KEYNAME, token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_012: [ Otherwise SASToken_Cache_GetToken shall generate a token that expires lifetime seconds from now, keep it and return it. ]*/
+TEST_FUNCTION(SASToken_Cache_GetToken_without_keyName_omits_skn)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, NULL, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_NO_KEYNAME, token);
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_011: [ If the cached token is less than refresh_interval seconds old, SASToken_Cache_GetToken shall return it without generating a new one. ]*/
+TEST_FUNCTION(SASToken_Cache_GetToken_within_the_refresh_interval_returns_the_cached_token)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    (void)SASToken_Cache_GetToken(handle);
+    test_current_time = TEST_TIME_T + (time_t)TEST_REFRESH_INTERVAL - 1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, (time_t)0));
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_WITH_KEYNAME, token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_012: [ Otherwise SASToken_Cache_GetToken shall generate a token that expires lifetime seconds from now, keep it and return it. ]*/
+TEST_FUNCTION(SASToken_Cache_GetToken_after_the_refresh_interval_generates_a_new_token)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    (void)SASToken_Cache_GetToken(handle);
+    test_current_time = TEST_TIME_T + (time_t)TEST_REFRESH_INTERVAL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, (time_t)0));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 7500));
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_EXPIRY_7500, token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_012: [ Otherwise SASToken_Cache_GetToken shall generate a token that expires lifetime seconds from now, keep it and return it. ]*/
+TEST_FUNCTION(SASToken_Cache_GetToken_when_the_clock_went_back_generates_a_new_token)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    test_current_time = TEST_TIME_T + 300;
+    (void)SASToken_Cache_GetToken(handle);
+    test_current_time = TEST_TIME_T;
+    umock_c_reset_all_calls();
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_WITH_KEYNAME, token);
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_010: [ If getting the current time fails, SASToken_Cache_GetToken shall return NULL. ]*/
+TEST_FUNCTION(when_get_time_fails_SASToken_Cache_GetToken_fails)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn((time_t)-1);
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_IS_NULL(token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_013: [ If generating the token fails, SASToken_Cache_GetToken shall return NULL. ]*/
+TEST_FUNCTION(when_size_tToString_fails_SASToken_Cache_GetToken_fails)
+{
+    ///arrange
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(TEST_TIME_T, (time_t)0));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 7200))
+        .SetReturn(__LINE__);
+
+    ///act
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_IS_NULL(token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* SASToken_Cache_DoWork */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_014: [ If handle is NULL, SASToken_Cache_DoWork shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASToken_Cache_DoWork_with_NULL_handle_fails)
+{
+    ///arrange
+    int result;
+
+    ///act
+    result = SASToken_Cache_DoWork(NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_017: [ Otherwise SASToken_Cache_DoWork shall generate and keep a new token, so that the next SASToken_Cache_GetToken does not have to. ]*/
+TEST_FUNCTION(SASToken_Cache_DoWork_generates_the_token_ahead_of_GetToken)
+{
+    ///arrange
+    int result;
+    const char* token;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(TEST_TIME_T, (time_t)0));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 7200));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(TEST_TIME_T, (time_t)0));
+
+    ///act
+    result = SASToken_Cache_DoWork(handle);
+    token = SASToken_Cache_GetToken(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_WITH_KEYNAME, token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_016: [ If the cached token is less than refresh_interval seconds old, SASToken_Cache_DoWork shall do nothing and return 0. ]*/
+TEST_FUNCTION(SASToken_Cache_DoWork_within_the_refresh_interval_does_nothing)
+{
+    ///arrange
+    int result;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    (void)SASToken_Cache_DoWork(handle);
+    test_current_time = TEST_TIME_T + 1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, (time_t)0));
+
+    ///act
+    result = SASToken_Cache_DoWork(handle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_015: [ If getting the current time or generating the token fails, SASToken_Cache_DoWork shall return a non-zero value. ]*/
+TEST_FUNCTION(when_get_time_fails_SASToken_Cache_DoWork_fails)
+{
+    ///arrange
+    int result;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn((time_t)-1);
+
+    ///act
+    result = SASToken_Cache_DoWork(handle);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_015: [ If getting the current time or generating the token fails, SASToken_Cache_DoWork shall return a non-zero value. ]*/
+TEST_FUNCTION(when_size_tToString_fails_SASToken_Cache_DoWork_fails)
+{
+    ///arrange
+    int result;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(TEST_TIME_T, (time_t)0));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 7200))
+        .SetReturn(__LINE__);
+
+    ///act
+    result = SASToken_Cache_DoWork(handle);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* SASToken_Cache_Matches */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_018: [ If handle or scope is NULL, SASToken_Cache_Matches shall return false. ]*/
+TEST_FUNCTION(SASToken_Cache_Matches_with_NULL_handle_returns_false)
+{
+    ///arrange
+    bool result;
+
+    ///act
+    result = SASToken_Cache_Matches(NULL, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME);
+
+    ///assert
+    ASSERT_IS_FALSE(result);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_018: [ If handle or scope is NULL, SASToken_Cache_Matches shall return false. ]*/
+TEST_FUNCTION(SASToken_Cache_Matches_with_NULL_scope_returns_false)
+{
+    ///arrange
+    bool result;
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///act
+    result = SASToken_Cache_Matches(handle, NULL, TEST_KEYNAME, TEST_LIFETIME);
+
+    ///assert
+    ASSERT_IS_FALSE(result);
+
+    ///cleanup
+    SASToken_Cache_Destroy(handle);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_019: [ SASToken_Cache_Matches shall return true if the cache was created with the same scope, keyName and lifetime, false otherwise. ]*/
+TEST_FUNCTION(SASToken_Cache_Matches_compares_scope_keyName_and_lifetime)
+{
+    ///arrange
+    SASTOKEN_CACHE_HANDLE handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+    SASTOKEN_CACHE_HANDLE no_keyname_handle = SASToken_Cache_Create(TEST_KEY, TEST_SCOPE, NULL, TEST_LIFETIME, TEST_REFRESH_INTERVAL);
+
+    ///act
+    ///assert
+    ASSERT_IS_TRUE(SASToken_Cache_Matches(handle, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME));
+    ASSERT_IS_FALSE(SASToken_Cache_Matches(handle, "other", TEST_KEYNAME, TEST_LIFETIME));
+    ASSERT_IS_FALSE(SASToken_Cache_Matches(handle, TEST_SCOPE, "other", TEST_LIFETIME));
+    ASSERT_IS_FALSE(SASToken_Cache_Matches(handle, TEST_SCOPE, NULL, TEST_LIFETIME));
+    ASSERT_IS_FALSE(SASToken_Cache_Matches(handle, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME + 1));
+    ASSERT_IS_TRUE(SASToken_Cache_Matches(no_keyname_handle, TEST_SCOPE, NULL, TEST_LIFETIME));
+    ASSERT_IS_FALSE(SASToken_Cache_Matches(no_keyname_handle, TEST_SCOPE, TEST_KEYNAME, TEST_LIFETIME));
+
+    ///cleanup
+    SASToken_Cache_Destroy(no_keyname_handle);
+    SASToken_Cache_Destroy(handle);
+}
+
+END_TEST_SUITE(sastoken_cache_unittests)
@@ -1294,4 +1294,164 @@ TEST_FUNCTION(URL_Decode_Extended_ASCII_chars)
     }
 }
 
+/* Buffer Tests */
+/*Tests_SRS_URL_ENCODE_01_001: [ If text is NULL, URL_Encoded_Length shall return 0. ]*/
+TEST_FUNCTION(URL_Encoded_Length_with_NULL_returns_0)
+{
+    //act
+    size_t result = URL_Encoded_Length(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+}
+
+/*Tests_SRS_URL_ENCODE_01_002: [ Otherwise URL_Encoded_Length shall return the length of the URL encoding of text, not counting the null terminator. ]*/
+TEST_FUNCTION(URL_Encoded_Length_Exhaustive_chars)
+{
+    size_t i;
+    size_t numberOfTests = sizeof(testVector) / sizeof(testVector[0]);
+
+    ASSERT_ARE_EQUAL(size_t, 0, URL_Encoded_Length(""));
+    for (i = 0; i < numberOfTests; i++)
+    {
+        //act
+        size_t result = URL_Encoded_Length(testVector[i].inputData);
+
+        //assert
+        ASSERT_ARE_EQUAL(size_t, strlen(testVector[i].expectedOutput), result);
+    }
+}
+
+/*Tests_SRS_URL_ENCODE_01_003: [ If text or destination is NULL, URL_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_Encode_To_Buffer_with_NULL_arguments_fails)
+{
+    //arrange
+    char destination[16];
+
+    //act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Encode_To_Buffer(NULL, destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Encode_To_Buffer("hello", NULL, sizeof(destination)));
+}
+
+/*Tests_SRS_URL_ENCODE_01_004: [ If destinationSize is smaller than URL_Encoded_Length(text) + 1, URL_Encode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_Encode_To_Buffer_with_small_destination_fails)
+{
+    //arrange
+    char destination[14] = "untouched";
+
+    //act
+    int result = URL_Encode_To_Buffer("hello world", destination, 13);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "untouched", destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_005: [ Otherwise URL_Encode_To_Buffer shall write the null terminated URL encoding of text to destination and return 0. ]*/
+TEST_FUNCTION(URL_Encode_To_Buffer_full_url)
+{
+    //arrange
+    const char* fullUrl = "https://one.two.three.four-five.com/six/Seven('EightNine1234567890.Ten_Eleven')?twelve-thirteen=2015-11-31 HTTP/1.1";
+    char destination[256];
+
+    //act
+    int result = URL_Encode_To_Buffer(fullUrl, destination, URL_Encoded_Length(fullUrl) + 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "https%3a%2f%2fone.two.three.four-five.com%2fsix%2fSeven(%27EightNine1234567890.Ten_Eleven%27)%3ftwelve-thirteen%3d2015-11-31%20HTTP%2f1.1", destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_005: [ Otherwise URL_Encode_To_Buffer shall write the null terminated URL encoding of text to destination and return 0. ]*/
+TEST_FUNCTION(URL_Encode_To_Buffer_Exhaustive_chars)
+{
+    size_t i;
+    size_t numberOfTests = sizeof(testVector) / sizeof(testVector[0]);
+
+    for (i = 0; i < numberOfTests; i++)
+    {
+        //arrange
+        char destination[8];
+
+        //act
+        int result = URL_Encode_To_Buffer(testVector[i].inputData, destination, strlen(testVector[i].expectedOutput) + 1);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector[i].expectedOutput, destination);
+    }
+}
+
+/*Tests_SRS_URL_ENCODE_01_006: [ If text or destination is NULL, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_Decode_To_Buffer_with_NULL_arguments_fails)
+{
+    //arrange
+    char destination[16];
+
+    //act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer(NULL, destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("hello", NULL, sizeof(destination)));
+}
+
+/*Tests_SRS_URL_ENCODE_01_007: [ If text contains a '%' not followed by 2 hex digits, a percent encoding outside of the 7-bit ASCII range or a character that would have been encoded, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_Decode_To_Buffer_invalid_encodings_fail)
+{
+    //arrange
+    char destination[32];
+
+    //act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("hello world", destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("hello%20world&mistake", destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("%7", destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("%", destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("%G5", destination, sizeof(destination)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("%C2%B4", destination, sizeof(destination)));
+}
+
+/*Tests_SRS_URL_ENCODE_01_008: [ If destination cannot hold the decoded text and its null terminator, URL_Decode_To_Buffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_Decode_To_Buffer_with_small_destination_fails)
+{
+    //arrange
+    char destination[12];
+
+    //act & assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("hello%20world", destination, 11));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("hello%20world", destination, 0));
+    ASSERT_ARE_NOT_EQUAL(int, 0, URL_Decode_To_Buffer("", destination, 0));
+}
+
+/*Tests_SRS_URL_ENCODE_01_009: [ Otherwise URL_Decode_To_Buffer shall write the null terminated decoded text to destination and return 0. ]*/
+TEST_FUNCTION(URL_Decode_To_Buffer_exact_size_succeeds)
+{
+    //arrange
+    char destination[12];
+
+    //act
+    int result = URL_Decode_To_Buffer("hello%20world", destination, sizeof(destination));
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "hello world", destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_009: [ Otherwise URL_Decode_To_Buffer shall write the null terminated decoded text to destination and return 0. ]*/
+TEST_FUNCTION(URL_Decode_To_Buffer_ASCII_chars)
+{
+    size_t i;
+    size_t numberOfTests = sizeof(testVectorASCII) / sizeof(testVectorASCII[0]);
+
+    for (i = 0; i < numberOfTests; i++)
+    {
+        //arrange
+        char destination[4];
+
+        //act
+        int result = URL_Decode_To_Buffer(testVectorASCII[i].endcodedRep, destination, sizeof(destination));
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVectorASCII[i].charRep, destination);
+    }
+}
+
 END_TEST_SUITE(URLEncode_UnitTests)
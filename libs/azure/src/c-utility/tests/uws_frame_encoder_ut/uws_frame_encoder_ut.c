@@ -5,11 +5,13 @@
 #include <cstdlib>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -1417,4 +1419,207 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_8_byte_frame_with_different_mask_
     real_BUFFER_delete(result);
 }
 
+/* uws_frame_encoder_encode_in_place */
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_056: [ If `frame_buffer` or `header_length` is NULL, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_NULL_frame_buffer_fails)
+{
+    // arrange
+    size_t header_length;
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, NULL, 0, true, true, 0, &header_length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_056: [ If `frame_buffer` or `header_length` is NULL, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_NULL_header_length_fails)
+{
+    // arrange
+    unsigned char frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, 0, true, true, 0, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_057: [ If `reserved` has any bits set except the lowest 3 then `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_reserved_bit_4_set_fails)
+{
+    // arrange
+    unsigned char frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    size_t header_length;
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, 0, false, true, 0x08, &header_length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_055: [ `uws_frame_encoder_encode_in_place` shall encode the information given in `opcode`, `length`, `is_masked`, `is_final` and `reserved` according to the RFC6455 into the `UWS_FRAME_ENCODER_MAX_HEADER_SIZE` bytes of headroom at the start of `frame_buffer`, so that the header ends right where the payload starts. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_060: [ On success `uws_frame_encoder_encode_in_place` shall store the header size in `header_length` and return 0. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_encodes_an_unmasked_1_byte_long_binary_frame)
+{
+    // arrange
+    unsigned char frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1];
+    unsigned char expected_bytes[] = { 0x82, 0x01, 0x42 };
+    size_t header_length;
+    int result;
+
+    frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE] = 0x42;
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, 1, false, true, 0, &header_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 2, header_length);
+    stringify_bytes(expected_bytes, sizeof(expected_bytes), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE - header_length, header_length + 1, actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_055: [ `uws_frame_encoder_encode_in_place` shall encode the information given in `opcode`, `length`, `is_masked`, `is_final` and `reserved` according to the RFC6455 into the `UWS_FRAME_ENCODER_MAX_HEADER_SIZE` bytes of headroom at the start of `frame_buffer`, so that the header ends right where the payload starts. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_060: [ On success `uws_frame_encoder_encode_in_place` shall store the header size in `header_length` and return 0. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_encodes_the_16_bit_length_of_a_126_byte_long_frame)
+{
+    // arrange
+    unsigned char frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 126];
+    unsigned char expected_header[] = { 0x01, 0x7E, 0x00, 0x7E };
+    size_t header_length;
+    int result;
+
+    (void)memset(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 0x42, 126);
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_TEXT_FRAME, frame_buffer, 126, false, false, 0, &header_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected_header), header_length);
+    stringify_bytes(expected_header, sizeof(expected_header), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE - header_length, header_length, actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(int, 0x42, frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 125]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_055: [ `uws_frame_encoder_encode_in_place` shall encode the information given in `opcode`, `length`, `is_masked`, `is_final` and `reserved` according to the RFC6455 into the `UWS_FRAME_ENCODER_MAX_HEADER_SIZE` bytes of headroom at the start of `frame_buffer`, so that the header ends right where the payload starts. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_059: [ If `is_masked` is true, the `length` payload bytes following the headroom shall be masked in place. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand` shall be used 4 times (for each byte). ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_uses_the_whole_headroom_for_a_masked_65536_byte_long_frame)
+{
+    // arrange
+    unsigned char* frame_buffer = (unsigned char*)real_malloc(UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 65536);
+    unsigned char expected_header[] = { 0x82, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04 };
+    size_t header_length;
+    int result;
+
+    (void)memset(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 0, 65536);
+
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x01);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x02);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x03);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x04);
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, 65536, true, true, 0, &header_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, header_length);
+    stringify_bytes(expected_header, sizeof(expected_header), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(frame_buffer, header_length, actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(int, 0x01, frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 65532]);
+    ASSERT_ARE_EQUAL(int, 0x04, frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 65535]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    real_free(frame_buffer);
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_059: [ If `is_masked` is true, the `length` payload bytes following the headroom shall be masked in place. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_058: [ The payload shall be masked 4 bytes at a time, with the remaining bytes masked one at a time. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_masks_an_8_byte_frame_with_different_mask_bytes)
+{
+    // arrange
+    unsigned char frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 8];
+    unsigned char payload[] = { 0x42, 0x43, 0x44, 0x45, 0x01, 0x02, 0xFF, 0xAA };
+    unsigned char expected_bytes[] = { 0x82, 0x88, 0x00, 0xFF, 0xAA, 0x42, 0x42, 0xBC, 0xEE, 0x07, 0x01, 0xFD, 0x55, 0xE8 };
+    size_t header_length;
+    int result;
+
+    (void)memcpy(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE, payload, sizeof(payload));
+
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x00);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0xFF);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0xAA);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x42);
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, sizeof(payload), true, true, 0, &header_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 6, header_length);
+    stringify_bytes(expected_bytes, sizeof(expected_bytes), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE - header_length, header_length + sizeof(payload), actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_058: [ The payload shall be masked 4 bytes at a time, with the remaining bytes masked one at a time. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_masks_the_tail_of_a_7_byte_frame)
+{
+    // arrange
+    unsigned char frame_buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 7];
+    unsigned char payload[] = { 0x42, 0x43, 0x44, 0x45, 0x01, 0x02, 0xFF };
+    unsigned char expected_bytes[] = { 0x81, 0x87, 0x00, 0xFF, 0xAA, 0x42, 0x42, 0xBC, 0xEE, 0x07, 0x01, 0xFD, 0x55 };
+    size_t header_length;
+    int result;
+
+    (void)memcpy(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE, payload, sizeof(payload));
+
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x00);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0xFF);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0xAA);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x42);
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_TEXT_FRAME, frame_buffer, sizeof(payload), true, true, 0, &header_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    stringify_bytes(expected_bytes, sizeof(expected_bytes), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(frame_buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE - header_length, header_length + sizeof(payload), actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(uws_frame_encoder_ut)
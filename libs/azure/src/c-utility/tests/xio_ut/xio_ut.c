@@ -37,6 +37,8 @@ static void my_gballoc_free(void* ptr)
 
 #include "azure_c_shared_utility/xio.h"
 static CONCRETE_IO_HANDLE TEST_CONCRETE_IO_HANDLE = (CONCRETE_IO_HANDLE)0x4242;
+/* bigger than XIO_SEGMENTS_GATHER_SIZE, so the segments are sent one by one */
+#define TEST_LARGE_SEGMENT_SIZE 2000
 
 #define ENABLE_MOCKS
 MOCK_FUNCTION_WITH_CODE(, CONCRETE_IO_HANDLE, test_xio_create, void*, xio_create_parameters)
@@ -710,6 +712,175 @@ TEST_FUNCTION(when_the_concrete_xio_send_fails_then_xio_send_fails)
     xio_destroy(handle);
 }
 
+/* xio_send_segments */
+
+/* Tests_SRS_XIO_01_040: [If xio or segments is NULL or segment_count is 0, xio_send_segments shall return a non-zero value.] */
+TEST_FUNCTION(xio_send_segments_with_NULL_handle_fails)
+{
+    // arrange
+    int result;
+    unsigned char send_data[] = { 0x42, 43 };
+    BUFFER_SEGMENT segments[1];
+    segments[0].data = send_data;
+    segments[0].size = sizeof(send_data);
+    umock_c_reset_all_calls();
+
+    // act
+    result = xio_send_segments(NULL, segments, 1, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_XIO_01_040: [If xio or segments is NULL or segment_count is 0, xio_send_segments shall return a non-zero value.] */
+TEST_FUNCTION(xio_send_segments_with_0_segments_fails)
+{
+    // arrange
+    int result;
+    BUFFER_SEGMENT segments[1];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    result = xio_send_segments(handle, segments, 0, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_01_045: [If the segments add up to XIO_SEGMENTS_GATHER_SIZE bytes or less, xio_send_segments shall copy them into one buffer and call concrete_io_send once with on_send_complete and callback_context.] */
+/* Tests_SRS_XIO_01_041: [Empty segments shall be skipped, except that the completion callback always travels with the last non-empty segment.] */
+TEST_FUNCTION(xio_send_segments_gathers_small_segments_in_one_send)
+{
+    // arrange
+    int result;
+    unsigned char header[] = { 0x30, 0x02 };
+    unsigned char body[] = { 0x42, 43 };
+    unsigned char expected_bytes[] = { 0x30, 0x02, 0x42, 43 };
+    BUFFER_SEGMENT segments[4];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    segments[0].data = header;
+    segments[0].size = sizeof(header);
+    segments[1].data = NULL;
+    segments[1].size = 0;
+    segments[2].data = body;
+    segments[2].size = sizeof(body);
+    segments[3].data = NULL;
+    segments[3].size = 0;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, IGNORED_PTR_ARG, sizeof(expected_bytes), test_on_send_complete, (void*)0x4242))
+        .ValidateArgumentBuffer(2, expected_bytes, sizeof(expected_bytes));
+
+    // act
+    result = xio_send_segments(handle, segments, 4, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_01_044: [If any concrete_io_send call fails, xio_send_segments shall stop and return a non-zero value; on_send_complete shall not be called for that send.] */
+TEST_FUNCTION(when_the_gathered_concrete_xio_send_fails_then_xio_send_segments_fails)
+{
+    // arrange
+    int result;
+    unsigned char header[] = { 0x30, 0x02 };
+    unsigned char body[] = { 0x42, 43 };
+    BUFFER_SEGMENT segments[2];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    segments[0].data = header;
+    segments[0].size = sizeof(header);
+    segments[1].data = body;
+    segments[1].size = sizeof(body);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, IGNORED_PTR_ARG, sizeof(header) + sizeof(body), test_on_send_complete, (void*)0x4242))
+        .SetReturn(42);
+
+    // act
+    result = xio_send_segments(handle, segments, 2, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_01_042: [Otherwise xio_send_segments shall call concrete_io_send once per segment, in order, so that the bytes are queued back to back without being copied into an intermediate buffer.] */
+/* Tests_SRS_XIO_01_043: [Only the call for the last segment shall carry on_send_complete and callback_context; the preceding calls shall pass NULL.] */
+/* Tests_SRS_XIO_01_041: [Empty segments shall be skipped, except that the completion callback always travels with the last non-empty segment.] */
+TEST_FUNCTION(xio_send_segments_sends_each_large_segment_and_completes_on_the_last)
+{
+    // arrange
+    int result;
+    unsigned char header[] = { 0x30, 0x02 };
+    static unsigned char body[TEST_LARGE_SEGMENT_SIZE];
+    BUFFER_SEGMENT segments[4];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    segments[0].data = header;
+    segments[0].size = sizeof(header);
+    segments[1].data = NULL;
+    segments[1].size = 0;
+    segments[2].data = body;
+    segments[2].size = sizeof(body);
+    segments[3].data = NULL;
+    segments[3].size = 0;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, header, sizeof(header), NULL, NULL));
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, body, sizeof(body), test_on_send_complete, (void*)0x4242));
+
+    // act
+    result = xio_send_segments(handle, segments, 4, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_01_044: [If any concrete_io_send call fails, xio_send_segments shall stop and return a non-zero value; on_send_complete shall not be called for that send.] */
+TEST_FUNCTION(when_the_concrete_xio_send_fails_then_xio_send_segments_stops_and_fails)
+{
+    // arrange
+    int result;
+    unsigned char header[] = { 0x30, 0x02 };
+    static unsigned char body[TEST_LARGE_SEGMENT_SIZE];
+    BUFFER_SEGMENT segments[2];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    segments[0].data = header;
+    segments[0].size = sizeof(header);
+    segments[1].data = body;
+    segments[1].size = sizeof(body);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, header, sizeof(header), NULL, NULL))
+        .SetReturn(42);
+
+    // act
+    result = xio_send_segments(handle, segments, 2, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
 /* Tests_SRS_XIO_01_011: [No error check shall be performed on buffer and size.] */
 TEST_FUNCTION(xio_send_with_NULL_buffer_and_nonzero_length_passes_the_args_down_and_succeeds)
 {
@@ -61,6 +61,29 @@ DEFINE_ENUM(BLOB_RESULT, BLOB_RESULT_VALUES)
 */
 MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions)
 
+/* called each time a block has been uploaded, with the count of blocks uploaded so far */
+typedef void(*BLOB_ON_BLOCK_UPLOADED)(unsigned int blockCount, void* context);
+
+/**
+* @brief  Synchronously uploads a file read in fixed-size blocks to blob storage, holding one block in memory
+*
+* @param  SASURI                The URI to use to upload data
+* @param  blockSize             The size of the blocks, at most 4MB. It is the only buffer allocated for the data.
+* @param  maxBlockRetries       How many times a block is sent again when the request fails or storage answers with a 5xx status
+* @param  readCallback          A callback to be invoked to read the next block into the block buffer
+* @param  readContext           Any data provided by the user to serve as context on readCallback.
+* @param  blockCount            On input, the count of blocks of this blob already uploaded, which are not read again. On output, the count of blocks uploaded.
+* @param  onBlockUploaded       An optional callback to be invoked after each block is uploaded
+* @param  onBlockUploadedContext Any data provided by the user to serve as context on onBlockUploaded.
+* @param  httpStatus            A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param  httpResponse          A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param  certificates          A null terminated string containing CA certificates to be used
+* @param  proxyOptions          A structure that contains optional web proxy information
+*
+* @return    A @c BLOB_RESULT. BLOB_OK means the last request was answered, and httpStatus tells whether the blob has been uploaded. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadStreamFromSasUri, const char*, SASURI, size_t, blockSize, unsigned int, maxBlockRetries, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK, readCallback, void*, readContext, unsigned int*, blockCount, BLOB_ON_BLOCK_UPLOADED, onBlockUploaded, void*, onBlockUploadedContext, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions)
+
 /**
 * @brief  Synchronously uploads a byte array as a new block to blob storage
 *
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file   iothub_client_batch.h
+*    @brief  The @c batch is a component that coalesces telemetry messages that have the
+*            same properties into one message, so that they share the protocol overhead.
+*/
+
+#ifndef IOTHUB_CLIENT_BATCH_H
+#define IOTHUB_CLIENT_BATCH_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#include "iothub_client_options.h"
+#include "internal/iothub_client_private.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+typedef struct IOTHUB_CLIENT_BATCH_TAG* IOTHUB_CLIENT_BATCH_HANDLE;
+
+#define IOTHUB_CLIENT_BATCH_ADD_RESULT_VALUES   \
+    IOTHUB_CLIENT_BATCH_ADD_OK,                 \
+    IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST,        \
+    IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE,      \
+    IOTHUB_CLIENT_BATCH_ADD_ERROR
+
+/** @brief Result of ::IoTHubClient_Batch_Add. FLUSH_FIRST means the message can be batched,
+*          but not with the messages already pending.
+*/
+DEFINE_ENUM(IOTHUB_CLIENT_BATCH_ADD_RESULT, IOTHUB_CLIENT_BATCH_ADD_RESULT_VALUES);
+
+/** @brief Name of the property set on a batched message; its value is "json-array" or "length-prefixed". */
+#define IOTHUB_CLIENT_BATCH_FORMAT_PROPERTY "batch-format"
+
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_BATCH_HANDLE, IoTHubClient_Batch_Create, const IOTHUB_CLIENT_BATCHING_OPTIONS*, options);
+MOCKABLE_FUNCTION(, void, IoTHubClient_Batch_Destroy, IOTHUB_CLIENT_BATCH_HANDLE, batch);
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_BATCH_ADD_RESULT, IoTHubClient_Batch_Add, IOTHUB_CLIENT_BATCH_HANDLE, batch, IOTHUB_MESSAGE_LIST*, message, tickcounter_ms_t, now);
+MOCKABLE_FUNCTION(, bool, IoTHubClient_Batch_IsDue, IOTHUB_CLIENT_BATCH_HANDLE, batch, tickcounter_ms_t, now);
+MOCKABLE_FUNCTION(, bool, IoTHubClient_Batch_GetTimeToDue, IOTHUB_CLIENT_BATCH_HANDLE, batch, tickcounter_ms_t, now, tickcounter_ms_t*, ms_to_due);
+MOCKABLE_FUNCTION(, bool, IoTHubClient_Batch_HasPending, IOTHUB_CLIENT_BATCH_HANDLE, batch);
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_LIST*, IoTHubClient_Batch_Flush, IOTHUB_CLIENT_BATCH_HANDLE, batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_CLIENT_BATCH_H */
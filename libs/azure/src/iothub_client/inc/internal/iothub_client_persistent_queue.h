@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file   iothub_client_persistent_queue.h
+*    @brief  The @c persistent queue keeps telemetry in a log file while the client is offline
+*            and gives it back, in order and at a bounded rate, once it is connected again.
+*/
+
+#ifndef IOTHUB_CLIENT_PERSISTENT_QUEUE_H
+#define IOTHUB_CLIENT_PERSISTENT_QUEUE_H
+
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#include "iothub_client_core_common.h"
+#include "internal/iothub_client_private.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+typedef struct IOTHUB_CLIENT_PERSISTENT_QUEUE_TAG* IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE;
+
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, IoTHubClient_PersistentQueue_Create, const IOTHUB_CLIENT_PERSISTENCE_OPTIONS*, options);
+MOCKABLE_FUNCTION(, void, IoTHubClient_PersistentQueue_Destroy, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue);
+MOCKABLE_FUNCTION(, int, IoTHubClient_PersistentQueue_Store, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue, IOTHUB_MESSAGE_HANDLE, message);
+MOCKABLE_FUNCTION(, bool, IoTHubClient_PersistentQueue_HasStored, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue);
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_LIST*, IoTHubClient_PersistentQueue_GetNext, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue, tickcounter_ms_t, now);
+MOCKABLE_FUNCTION(, bool, IoTHubClient_PersistentQueue_GetTimeToNext, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue, tickcounter_ms_t, now, tickcounter_ms_t*, ms_to_next);
+MOCKABLE_FUNCTION(, bool, IoTHubClient_PersistentQueue_IsReplayed, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue, const IOTHUB_MESSAGE_LIST*, message);
+MOCKABLE_FUNCTION(, void, IoTHubClient_PersistentQueue_DoWork, IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_CLIENT_PERSISTENT_QUEUE_H */
@@ -89,6 +89,8 @@ extern "C"
     typedef int(*pfIoTHubTransport_Subscribe_InputQueue)(IOTHUB_DEVICE_HANDLE handle);
     typedef void(*pfIoTHubTransport_Unsubscribe_InputQueue)(IOTHUB_DEVICE_HANDLE handle);
     typedef int(*pfIoTHubTransport_SetCallbackContext)(TRANSPORT_LL_HANDLE handle, void* ctx);
+    typedef int(*pfIoTHubTransport_GetTrafficStatistics)(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_SEND_STATISTICS* statistics);
+    typedef int(*pfIoTHubTransport_DoWorkWithBudget)(TRANSPORT_LL_HANDLE handle, const IOTHUB_CLIENT_DOWORK_BUDGET* budget, uint32_t* next_call_in_ms);
 
 #define TRANSPORT_PROVIDER_FIELDS                                                   \
 pfIotHubTransport_SendMessageDisposition IoTHubTransport_SendMessageDisposition;  \
@@ -111,7 +113,9 @@ pfIoTHubTransport_SetRetryPolicy IoTHubTransport_SetRetryPolicy;
 pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;                      \
 pfIoTHubTransport_Subscribe_InputQueue IoTHubTransport_Subscribe_InputQueue;        \
 pfIoTHubTransport_Unsubscribe_InputQueue IoTHubTransport_Unsubscribe_InputQueue;    \
-pfIoTHubTransport_SetCallbackContext IoTHubTransport_SetCallbackContext     /*there's an intentional missing ; on this line*/
+pfIoTHubTransport_SetCallbackContext IoTHubTransport_SetCallbackContext;           \
+pfIoTHubTransport_GetTrafficStatistics IoTHubTransport_GetTrafficStatistics;       \
+pfIoTHubTransport_DoWorkWithBudget IoTHubTransport_DoWorkWithBudget     /*there's an intentional missing ; on this line*/
 
     struct TRANSPORT_PROVIDER_TAG
     {
@@ -46,6 +46,8 @@ MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubTransport_MQTT_Common_SendMessag
 MOCKABLE_FUNCTION(, int, IoTHubTransport_MQTT_Common_Subscribe_InputQueue, IOTHUB_DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, void, IoTHubTransport_MQTT_Common_Unsubscribe_InputQueue, IOTHUB_DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, int, IoTHubTransport_MQTT_SetCallbackContext, TRANSPORT_LL_HANDLE, handle, void*, ctx);
+MOCKABLE_FUNCTION(, int, IoTHubTransport_MQTT_Common_GetTrafficStatistics, TRANSPORT_LL_HANDLE, handle, IOTHUB_CLIENT_SEND_STATISTICS*, statistics);
+MOCKABLE_FUNCTION(, int, IoTHubTransport_MQTT_Common_DoWorkWithBudget, TRANSPORT_LL_HANDLE, handle, const IOTHUB_CLIENT_DOWORK_BUDGET*, budget, uint32_t*, next_call_in_ms);
 
 #ifdef __cplusplus
 }
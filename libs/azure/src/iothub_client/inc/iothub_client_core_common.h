@@ -8,6 +8,7 @@
 
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/filestore.h"
 
 #include "iothub_transport_ll.h"
 #include "iothub_message.h"
@@ -65,6 +66,32 @@ extern "C"
     */
     DEFINE_ENUM(IOTHUB_CLIENT_STATUS, IOTHUB_CLIENT_STATUS_VALUES);
 
+    /** @brief Counters returned by ::IoTHubClient_LL_GetSendStatistics. With telemetry batching
+    *          messages_confirmed counts every message of a batch, transport_messages_confirmed counts the batch once.
+    *          The byte counters are the protocol bytes of the transport (TLS excluded) and stay 0 for
+    *          transports that do not count them. radio_wake_ups is counted by MQTT in idle mode (OPTION_MQTT_IDLE_MODE)
+    *          and keep_alive_pings by MQTT only.
+    */
+    typedef struct IOTHUB_CLIENT_SEND_STATISTICS_TAG
+    {
+        uint64_t messages_confirmed;
+        uint64_t transport_messages_confirmed;
+        uint64_t bytes_sent;
+        uint64_t bytes_received;
+        uint32_t radio_wake_ups;
+        uint32_t keep_alive_pings;
+    } IOTHUB_CLIENT_SEND_STATISTICS;
+
+    /** @brief Limits one call of ::IoTHubClient_LL_DoWorkWithBudget. max_wait_ms is the longest the call
+    *          waits for data from the network (0 only takes what already arrived); max_receive_bytes is
+    *          the most bytes it reads (0 for no limit). The transport keeps using the budget afterwards.
+    */
+    typedef struct IOTHUB_CLIENT_DOWORK_BUDGET_TAG
+    {
+        uint32_t max_wait_ms;
+        size_t max_receive_bytes;
+    } IOTHUB_CLIENT_DOWORK_BUDGET;
+
 #define IOTHUB_IDENTITY_TYPE_VALUE  \
     IOTHUB_TYPE_TELEMETRY,          \
     IOTHUB_TYPE_DEVICE_TWIN,        \
@@ -102,11 +129,13 @@ extern "C"
     IOTHUB_CLIENT_CONFIRMATION_OK,                   \
     IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY,      \
     IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT,      \
-    IOTHUB_CLIENT_CONFIRMATION_ERROR                 \
+    IOTHUB_CLIENT_CONFIRMATION_ERROR,                \
+    IOTHUB_CLIENT_CONFIRMATION_PERSISTED             \
 
     /** @brief Enumeration passed in by the IoT Hub when the event confirmation
     *           callback is invoked to indicate status of the event processing in
-    *           the hub.
+    *           the hub. IOTHUB_CLIENT_CONFIRMATION_PERSISTED means the message was written and flushed
+    *           to the persistent queue, which sends it once the client is connected again.
     */
     DEFINE_ENUM(IOTHUB_CLIENT_CONFIRMATION_RESULT, IOTHUB_CLIENT_CONFIRMATION_RESULT_VALUES);
 
@@ -149,6 +178,22 @@ extern "C"
     DEFINE_ENUM(DEVICE_TWIN_UPDATE_STATE, DEVICE_TWIN_UPDATE_STATE_VALUES);
 
     typedef void(*IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK)(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* userContextCallback);
+    /** @brief Settings of OPTION_PERSISTENT_QUEUE. While the client is not connected, telemetry is written to
+    *          the file at path through file_store, in pages of page_size bytes, and the file does not grow past max_bytes.
+    *          Once connected, the stored messages are sent at no more than max_replay_rate messages per second
+    *          (0 for no limit) and replay_callback is called with the result of each of them.
+    */
+    typedef struct IOTHUB_CLIENT_PERSISTENCE_OPTIONS_TAG
+    {
+        const FILE_STORE_INTERFACE_DESCRIPTION* file_store;
+        const char* path;
+        size_t page_size;
+        size_t max_bytes;
+        uint32_t max_replay_rate;
+        IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK replay_callback;
+        void* replay_context;
+    } IOTHUB_CLIENT_PERSISTENCE_OPTIONS;
+
     typedef void(*IOTHUB_CLIENT_CONNECTION_STATUS_CALLBACK)(IOTHUB_CLIENT_CONNECTION_STATUS result, IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason, void* userContextCallback);
     typedef IOTHUBMESSAGE_DISPOSITION_RESULT (*IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC)(IOTHUB_MESSAGE_HANDLE message, void* userContextCallback);
 
@@ -180,6 +225,31 @@ extern "C"
     typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
     typedef IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT(*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
 
+    /**
+    *  @brief             Callback invoked by IoTHubClient_LL_UploadStreamToBlob to read the next block of the file into the client's block buffer.
+    *  @param offset      Offset in the file of the first byte to read. Blocks are read in order, from the first block that was not uploaded yet.
+    *  @param buffer      The buffer receiving the data.
+    *  @param size        The size of buffer, which is the block size of the upload.
+    *  @param bytesRead   Receives the number of bytes copied to buffer. Fewer than size bytes ends the file.
+    *  @param context     User context provided on the call to IoTHubClient_LL_UploadStreamToBlob.
+    *  @remarks           If the user wants to abort the upload, the callback should return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT
+    *                     It should return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK otherwise.
+    */
+    typedef IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT(*IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK)(size_t offset, unsigned char* buffer, size_t size, size_t* bytesRead, void* context);
+
+    /** @brief Settings of IoTHubClient_LL_UploadStreamToBlob. The file is read and uploaded in blocks of block_size
+    *          bytes, the only buffer held for its data. A block that fails is sent again up to max_block_retries times.
+    *          When file_store is not NULL, the upload and the count of uploaded blocks are kept in the file at state_path,
+    *          so that uploading the same destination again, after a reconnect or a restart, resumes it.
+    */
+    typedef struct IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS_TAG
+    {
+        size_t block_size;
+        unsigned int max_block_retries;
+        const FILE_STORE_INTERFACE_DESCRIPTION* file_store;
+        const char* state_path;
+    } IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS;
+
     /** @brief    This struct captures IoTHub client configuration. */
     typedef struct IOTHUB_CLIENT_CONFIG_TAG
     {
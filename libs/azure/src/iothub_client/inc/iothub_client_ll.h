@@ -141,6 +141,21 @@ typedef struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG* IOTHUB_CLIENT_LL_HANDLE;
     */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_GetSendStatus, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_STATUS*, iotHubClientStatus);
 
+    /**
+    * @brief    This function returns counters of the telemetry sent by the client.
+    *
+    * @param    iotHubClientHandle        The handle created by a call to the create function.
+    * @param    statistics                Receives the number of confirmed messages, the number of
+    *                                     confirmed transport messages (a batch counts once) and
+    *                                     the protocol bytes sent and received by the transport,
+    *                                     from which the bytes on the wire per message follow.
+    *                                     The byte counters are 0 for transports that do not count
+    *                                     them and cover every device of a shared transport.
+    *
+    * @return    IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_GetSendStatistics, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_SEND_STATISTICS*, statistics);
+
     /**
     * @brief    Sets up the message callback to be invoked when IoT Hub issues a
     *             message to the device. This is a blocking call.
@@ -234,6 +249,23 @@ typedef struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG* IOTHUB_CLIENT_LL_HANDLE;
     */
      MOCKABLE_FUNCTION(, void, IoTHubClient_LL_DoWork, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle);
 
+    /**
+    * @brief    Does the work of _DoWork within a budget and tells when it next
+    *             needs to be called, so the caller can sleep until then.
+    *
+    * @param    iotHubClientHandle    The handle created by a call to the create function.
+    * @param    budget                The longest time the transport may wait for data and the
+    *                                 most bytes it may read in this call (0 for no limit).
+    * @param    next_call_in_ms       Receives the milliseconds until the client has work again:
+    *                                 a keep-alive, a retry, a resend, a due batch or a message
+    *                                 timeout. Data arriving from the hub earlier is only noticed
+    *                                 by the next call, so callers that expect cloud-to-device
+    *                                 messages or methods should cap the sleep.
+    *
+    * @return    IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_DoWorkWithBudget, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const IOTHUB_CLIENT_DOWORK_BUDGET*, budget, uint32_t*, next_call_in_ms);
+
     /**
     * @brief    This API sets a runtime option identified by parameter @p optionName
     *             to a value pointed to by @p value. @p optionName and the data type
@@ -395,6 +427,23 @@ typedef struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG* IOTHUB_CLIENT_LL_HANDLE;
      */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadMultipleBlocksToBlobEx, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
 
+     /**
+     * @brief    This API uploads to Azure Storage the file read in blocks of @p options->block_size bytes by @p readCallback
+     *           under the blob name devicename/@pdestinationFileName. Only one block is held in memory, a block that
+     *           fails is sent again, and when @p options->file_store is set an interrupted upload resumes on the next
+     *           call for the same @p destinationFileName.
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    destinationFileName     name of the file.
+     * @param    options                 The block size, the retries per block and where the upload is saved.
+     * @param    readCallback            A callback to be invoked to read a block of the file at a given offset.
+     * @param    context                 Any data provided by the user to serve as context on readCallback.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success or an error code upon failure. After a failure of a saved upload, calling
+     *           this function again resumes it.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadStreamToBlob, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS*, options, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK, readCallback, void*, context);
+
 #endif /*DONT_USE_UPLOADTOBLOB*/
 
 #ifdef __cplusplus
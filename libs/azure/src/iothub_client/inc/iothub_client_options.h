@@ -4,7 +4,10 @@
 #ifndef IOTHUB_CLIENT_OPTIONS_H
 #define IOTHUB_CLIENT_OPTIONS_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/const_defines.h"
+#include "azure_c_shared_utility/macro_utils.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -18,6 +21,33 @@ extern "C"
         const char* password;
     } IOTHUB_PROXY_OPTIONS;
 
+#define IOTHUB_CLIENT_BATCH_FORMAT_VALUES       \
+    IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY,      \
+    IOTHUB_CLIENT_BATCH_FORMAT_LENGTH_PREFIXED
+
+    /** @brief How the payloads of batched telemetry messages are combined:
+    *          JSON_ARRAY gives [payload1,payload2,...] and expects every payload to be a JSON value;
+    *          LENGTH_PREFIXED gives each payload preceded by its size as a 2 byte big endian number.
+    */
+    DEFINE_ENUM(IOTHUB_CLIENT_BATCH_FORMAT, IOTHUB_CLIENT_BATCH_FORMAT_VALUES);
+
+    typedef struct IOTHUB_CLIENT_BATCHING_OPTIONS_TAG
+    {
+        size_t max_messages;        /* messages per batch; less than 2 turns batching off */
+        size_t max_bytes;           /* combined payload size per batch */
+        uint32_t max_latency_ms;    /* how long the first message of a batch may wait for others */
+        IOTHUB_CLIENT_BATCH_FORMAT format;
+    } IOTHUB_CLIENT_BATCHING_OPTIONS;
+
+    typedef struct IOTHUB_CLIENT_MQTT_IDLE_OPTIONS_TAG
+    {
+        uint16_t min_ping_interval_secs;    /* first ping interval probed; 0 turns the idle mode off */
+        uint16_t ping_interval_step_secs;   /* growth of the ping interval after each answered probe */
+        uint32_t radio_tail_ms;             /* how long the radio stays up after traffic */
+        uint32_t max_send_delay_ms;         /* how long telemetry may be held back waiting for the radio to be up */
+        size_t max_held_messages;           /* telemetry is sent once this many messages are held; 0 for no limit */
+    } IOTHUB_CLIENT_MQTT_IDLE_OPTIONS;
+
     static STATIC_VAR_UNUSED const char* OPTION_LOG_TRACE = "logtrace";
     static STATIC_VAR_UNUSED const char* OPTION_X509_CERT = "x509certificate";
     static STATIC_VAR_UNUSED const char* OPTION_X509_PRIVATE_KEY = "x509privatekey";
@@ -45,6 +75,35 @@ extern "C"
     */
     static STATIC_VAR_UNUSED const char* OPTION_AUTO_URL_ENCODE_DECODE = "auto_url_encode_decode";
 
+    /*
+    * @brief    Maximum number of telemetry messages the MQTT transport keeps waiting for PUBACK (int, 1 to 1024, default 16).
+    *           Messages beyond this stay queued until an acknowledgement frees a slot. Can only be changed while no message is waiting for PUBACK.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_MQTT_INFLIGHT_WINDOW = "mqtt_inflight_window";
+
+    /*
+    * @brief    Saves radio wake-ups on cellular links (const IOTHUB_CLIENT_MQTT_IDLE_OPTIONS*, off by default). Set a long OPTION_KEEP_ALIVE with it:
+    *           the MQTT transport then learns how long the network keeps an idle connection and pings only that often, lets telemetry
+    *           stand in for pings, and holds telemetry back until the radio is up anyway, a ping is due, max_held_messages are waiting
+    *           or max_send_delay_ms has passed. IoTHubClient_LL_GetSendStatistics reports the radio wake-ups and pings.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_MQTT_IDLE_MODE = "mqtt_idle_mode";
+
+    /*
+    * @brief    Coalesces telemetry messages that have the same properties into one message (const IOTHUB_CLIENT_BATCHING_OPTIONS*, off by default).
+    *           A batch is sent when it reaches max_messages or max_bytes, or max_latency_ms after its first message was queued.
+    *           The batched message carries the "batch-format" property; the confirmation callback of each message is called when the batch completes.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_TELEMETRY_BATCHING = "telemetry_batching";
+
+    /*
+    * @brief    Stores telemetry in a file while the client is not connected (const IOTHUB_CLIENT_PERSISTENCE_OPTIONS*, off by default).
+    *           A stored message is confirmed with IOTHUB_CLIENT_CONFIRMATION_PERSISTED; once connected the stored messages are
+    *           sent in order before new ones, also after a reboot. Every stored message rewrites and flushes the last page of the file,
+    *           which is kept as long as it holds unsent messages.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_PERSISTENT_QUEUE = "persistent_queue";
+
     /*
     * @brief Informs the service of what is the maximum period the client will wait for a keep-alive message from the service.
     *        The service must send keep-alives before this timeout is reached, otherwise the client will trigger its re-connection logic.
@@ -11,6 +11,7 @@
 
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/map.h"
+#include "azure_c_shared_utility/constbuffer.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
 
 #ifdef __cplusplus
@@ -65,6 +66,42 @@ static const char DIAG_CREATION_TIME_UTC_PROPERTY_NAME[] = "diag_creation_time_u
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_HANDLE, IoTHubMessage_CreateFromByteArray, const unsigned char*, byteArray, size_t, size);
 
+/** @brief  Called once no message refers to a payload passed to
+*          @c IoTHubMessage_CreateFromBorrowedByteArray anymore.
+*/
+typedef void(*IOTHUB_MESSAGE_PAYLOAD_RELEASE_CALLBACK)(void* releaseContext);
+
+/**
+* @brief   Creates a new IoT hub message that refers to a byte array owned
+*          by the caller instead of copying it. The type of the message will
+*          be set to @c IOTHUBMESSAGE_BYTEARRAY.
+*
+* @param   byteArray       The byte array holding the payload. It must not
+*                          change until @p releaseCallback is called.
+* @param   size            The size of the byte array.
+* @param   releaseCallback Called with @p releaseContext once the message and
+*                          all its clones are destroyed. Can be @c NULL for
+*                          payloads that live for the whole program.
+* @param   releaseContext  User specified context passed to @p releaseCallback.
+*
+* @return  A valid @c IOTHUB_MESSAGE_HANDLE if the message was successfully
+*          created or @c NULL in case an error occurs, in which case
+*          @p releaseCallback is not called.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_HANDLE, IoTHubMessage_CreateFromBorrowedByteArray, const unsigned char*, byteArray, size_t, size, IOTHUB_MESSAGE_PAYLOAD_RELEASE_CALLBACK, releaseCallback, void*, releaseContext);
+
+/**
+* @brief   Creates a new IoT hub message that shares a refcounted payload.
+*          The type of the message will be set to @c IOTHUBMESSAGE_BYTEARRAY.
+*
+* @param   payload The payload. The message takes its own reference, so the
+*                  caller still has to destroy @p payload.
+*
+* @return  A valid @c IOTHUB_MESSAGE_HANDLE if the message was successfully
+*          created or @c NULL in case an error occurs.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_HANDLE, IoTHubMessage_CreateFromConstBuffer, CONSTBUFFER_HANDLE, payload);
+
 /**
 * @brief   Creates a new IoT hub message from a null terminated string.  The
 *          type of the message will be set to @c IOTHUBMESSAGE_STRING.
@@ -79,7 +116,9 @@ MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_HANDLE, IoTHubMessage_CreateFromString, const
 
 /**
 * @brief   Creates a new IoT hub message with the content identical to that
-*          of the @p iotHubMessageHandle parameter.
+*          of the @p iotHubMessageHandle parameter. The payload and the
+*          properties are shared with the original rather than copied; the
+*          properties are copied the first time either message changes them.
 *
 * @param   iotHubMessageHandle Handle to the message that is to be cloned.
 *
@@ -180,6 +219,17 @@ MOCKABLE_FUNCTION(, const char*, IoTHubMessage_GetContentEncodingSystemProperty,
 */
 MOCKABLE_FUNCTION(, MAP_HANDLE, IoTHubMessage_Properties, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle);
 
+/**
+* @brief   Gets a handle to the message's properties map for reading only.
+*          Unlike IoTHubMessage_Properties this never copies the properties of a message
+*          that shares them with a clone, so the returned map must not be changed.
+*
+* @param   iotHubMessageHandle Handle to the message.
+*
+* @return  A @c MAP_HANDLE pointing to the properties map for this message, or NULL if iotHubMessageHandle is NULL.
+*/
+MOCKABLE_FUNCTION(, MAP_HANDLE, IoTHubMessage_GetReadOnlyProperties, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle);
+
 /**
 * @brief   Sets a property on a Iothub Message.
 *
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file   iothub_twin_parser.h
+*    @brief  The @c IoTHubTwinParser component reads a device twin document or a desired
+*            properties patch in one pass and calls back only for the properties that
+*            were registered, without building a JSON tree.
+*/
+
+#ifndef IOTHUB_TWIN_PARSER_H
+#define IOTHUB_TWIN_PARSER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "iothub_client_core_common.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+#define IOTHUB_TWIN_PROPERTY_TYPE_VALUES \
+    IOTHUB_TWIN_PROPERTY_STRING, \
+    IOTHUB_TWIN_PROPERTY_NUMBER, \
+    IOTHUB_TWIN_PROPERTY_BOOLEAN, \
+    IOTHUB_TWIN_PROPERTY_NULL, \
+    IOTHUB_TWIN_PROPERTY_JSON
+
+/** @brief Enumeration of the value types a property can be registered for. @c IOTHUB_TWIN_PROPERTY_JSON
+*          matches any value and gives its JSON text.
+*/
+DEFINE_ENUM(IOTHUB_TWIN_PROPERTY_TYPE, IOTHUB_TWIN_PROPERTY_TYPE_VALUES);
+
+/** @brief A property value as seen by a callback. It is only valid during the callback. */
+typedef struct IOTHUB_TWIN_PROPERTY_VALUE_TAG
+{
+    IOTHUB_TWIN_PROPERTY_TYPE type;
+    union
+    {
+        /* the unescaped, zero terminated string */
+        struct
+        {
+            const char* value;
+            size_t length;
+        } string;
+        double number;
+        bool boolean;
+        /* the JSON text of the value, pointing into the payload */
+        struct
+        {
+            const char* value;
+            size_t length;
+        } json;
+    } value;
+} IOTHUB_TWIN_PROPERTY_VALUE;
+
+typedef void(*IOTHUB_TWIN_PROPERTY_CALLBACK)(const char* path, const IOTHUB_TWIN_PROPERTY_VALUE* value, void* context);
+
+typedef struct IOTHUB_TWIN_PARSER_TAG* IOTHUB_TWIN_PARSER_HANDLE;
+
+/**
+* @brief   Creates a twin parser.
+*
+* @param   max_string_length   The longest string value, once unescaped, that the parser can give
+*                              to a callback. The buffer for it is the only memory used while parsing.
+*
+* @return  A handle to the parser, or NULL on failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_TWIN_PARSER_HANDLE, IoTHubTwinParser_Create, size_t, max_string_length);
+
+/**
+* @brief   Frees a twin parser and its registrations.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubTwinParser_Destroy, IOTHUB_TWIN_PARSER_HANDLE, parser);
+
+/**
+* @brief   Registers a callback for the property at a JSON pointer (RFC 6901) in the twin document,
+*          for instance "/desired/telemetryInterval".
+*
+* @param   parser      The handle of the parser.
+* @param   path        The JSON pointer of the property. It is copied.
+* @param   type        The type of value the callback is called for. A null value is always given
+*                      to the callback, as it removes the property from the twin.
+* @param   callback    The function called with the value of the property.
+* @param   context     User specified context passed to the callback.
+*
+* @return  0 on success, a non-zero value otherwise.
+*/
+MOCKABLE_FUNCTION(, int, IoTHubTwinParser_Register, IOTHUB_TWIN_PARSER_HANDLE, parser, const char*, path, IOTHUB_TWIN_PROPERTY_TYPE, type, IOTHUB_TWIN_PROPERTY_CALLBACK, callback, void*, context);
+
+/**
+* @brief   Parses the payload given to an @c IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK and calls the callbacks
+*          registered for the properties it contains. A partial update holds the desired properties
+*          only, so its members are matched as if they were under "/desired".
+*
+* @param   parser          The handle of the parser.
+* @param   update_state    The update state given to the device twin callback.
+* @param   payload         The twin document or patch, which does not need to be zero terminated.
+* @param   size            The size of the payload.
+*
+* @return  0 if the payload was parsed, a non-zero value otherwise. Callbacks made before an
+*          error is found are not undone.
+*/
+MOCKABLE_FUNCTION(, int, IoTHubTwinParser_Parse, IOTHUB_TWIN_PARSER_HANDLE, parser, DEVICE_TWIN_UPDATE_STATE, update_state, const unsigned char*, payload, size_t, size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_TWIN_PARSER_H */
@@ -379,3 +379,335 @@ BLOB_RESULT Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIEN
     }
     return result;
 }
+
+/*block IDs of a streamed upload are the BASE64 encoding of the block index printed on 6 digits*/
+#define STREAM_BLOCK_ID_LENGTH 8
+#define STREAM_BLOCK_PATH_SUFFIX "&comp=block&blockid="
+#define BLOCK_LIST_HEADER "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"
+#define BLOCK_LIST_FOOTER "</BlockList>"
+#define BLOCK_LIST_LATEST_BEGIN "<Latest>"
+#define BLOCK_LIST_LATEST_END "</Latest>"
+
+static int encode_stream_block_id(unsigned int blockID, char* destination)
+{
+    int result;
+    char temp[7];
+    if (sprintf(temp, "%06u", blockID) != 6)
+    {
+        LogError("failed to sprintf");
+        result = __FAILURE__;
+    }
+    else if (Base64_Encode_To_Buffer((const unsigned char*)temp, 6, destination, STREAM_BLOCK_ID_LENGTH + 1) != 0)
+    {
+        LogError("unable to Base64_Encode_To_Buffer");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*sends a request, again up to maxRetries times while there is no answer or storage answers with a 5xx status*/
+static BLOB_RESULT execute_with_retries(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, BUFFER_HANDLE requestContent, unsigned int maxRetries, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    unsigned int attempt = 0;
+
+    do
+    {
+        if (HTTPAPIEX_ExecuteRequest(
+            httpApiExHandle,
+            HTTPAPI_REQUEST_PUT,
+            relativePath,
+            NULL,
+            requestContent,
+            httpStatus,
+            NULL,
+            httpResponse) != HTTPAPIEX_OK)
+        {
+            LogError("unable to HTTPAPIEX_ExecuteRequest, attempt %u", attempt + 1);
+            result = BLOB_HTTP_ERROR;
+        }
+        else
+        {
+            if (*httpStatus >= 300)
+            {
+                LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
+            }
+            result = BLOB_OK;
+        }
+        attempt++;
+    } while ((attempt <= maxRetries) && ((result != BLOB_OK) || (*httpStatus >= 500)));
+
+    return result;
+}
+
+/*the block list is only built at the end, from the count of blocks, so that its size does not grow with the upload*/
+static BLOB_RESULT put_stream_block_list(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, unsigned int blockCount, unsigned int maxRetries, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    const size_t entryLength = (sizeof(BLOCK_LIST_LATEST_BEGIN) - 1) + STREAM_BLOCK_ID_LENGTH + (sizeof(BLOCK_LIST_LATEST_END) - 1);
+    size_t blockListLength = (sizeof(BLOCK_LIST_HEADER) - 1) + ((size_t)blockCount * entryLength) + (sizeof(BLOCK_LIST_FOOTER) - 1);
+    BUFFER_HANDLE blockList = BUFFER_new();
+
+    if (blockList == NULL)
+    {
+        LogError("failed to BUFFER_new");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        if (BUFFER_pre_build(blockList, blockListLength) != 0)
+        {
+            LogError("failed to BUFFER_pre_build");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            unsigned char* position = BUFFER_u_char(blockList);
+            unsigned int blockID;
+
+            (void)memcpy(position, BLOCK_LIST_HEADER, sizeof(BLOCK_LIST_HEADER) - 1);
+            position += sizeof(BLOCK_LIST_HEADER) - 1;
+            result = BLOB_OK;
+            for (blockID = 0; (blockID < blockCount) && (result == BLOB_OK); blockID++)
+            {
+                char blockIdString[STREAM_BLOCK_ID_LENGTH + 1];
+                if (encode_stream_block_id(blockID, blockIdString) != 0)
+                {
+                    result = BLOB_ERROR;
+                }
+                else
+                {
+                    (void)memcpy(position, BLOCK_LIST_LATEST_BEGIN, sizeof(BLOCK_LIST_LATEST_BEGIN) - 1);
+                    position += sizeof(BLOCK_LIST_LATEST_BEGIN) - 1;
+                    (void)memcpy(position, blockIdString, STREAM_BLOCK_ID_LENGTH);
+                    position += STREAM_BLOCK_ID_LENGTH;
+                    (void)memcpy(position, BLOCK_LIST_LATEST_END, sizeof(BLOCK_LIST_LATEST_END) - 1);
+                    position += sizeof(BLOCK_LIST_LATEST_END) - 1;
+                }
+            }
+
+            if (result == BLOB_OK)
+            {
+                STRING_HANDLE newRelativePath;
+                (void)memcpy(position, BLOCK_LIST_FOOTER, sizeof(BLOCK_LIST_FOOTER) - 1);
+
+                /*Codes_SRS_BLOB_01_010: [ Once every block is uploaded, Blob_UploadStreamFromSasUri shall PUT the block list of blockCount blocks to base relativePath + "&comp=blocklist". ]*/
+                newRelativePath = STRING_construct(relativePath);
+                if (newRelativePath == NULL)
+                {
+                    LogError("failed to STRING_construct");
+                    result = BLOB_ERROR;
+                }
+                else
+                {
+                    if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
+                    {
+                        LogError("failed to STRING_concat");
+                        result = BLOB_ERROR;
+                    }
+                    else
+                    {
+                        result = execute_with_retries(httpApiExHandle, STRING_c_str(newRelativePath), blockList, maxRetries, httpStatus, httpResponse);
+                    }
+                    STRING_delete(newRelativePath);
+                }
+            }
+        }
+        BUFFER_delete(blockList);
+    }
+    return result;
+}
+
+static BLOB_RESULT upload_stream_blocks(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, size_t blockSize, unsigned int maxBlockRetries, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK readCallback, void* readContext, unsigned int* blockCount, BLOB_ON_BLOCK_UPLOADED onBlockUploaded, void* onBlockUploadedContext, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    size_t relativePathLength = strlen(relativePath);
+    /*Codes_SRS_BLOB_01_003: [ Blob_UploadStreamFromSasUri shall allocate the path of the block requests and a BUFFER of blockSize bytes once, and reuse them for every block. ]*/
+    char* blockPath = (char*)malloc(relativePathLength + (sizeof(STREAM_BLOCK_PATH_SUFFIX) - 1) + STREAM_BLOCK_ID_LENGTH + 1);
+    if (blockPath == NULL)
+    {
+        LogError("oom - out of memory");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        BUFFER_HANDLE block = BUFFER_new();
+        if (block == NULL)
+        {
+            LogError("unable to BUFFER_new");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            if (BUFFER_reserve(block, 0, blockSize) != 0)
+            {
+                LogError("unable to reserve a block of %lu bytes", (unsigned long)blockSize);
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                char* blockId = blockPath + relativePathLength + (sizeof(STREAM_BLOCK_PATH_SUFFIX) - 1);
+                int isLastBlock = 0;
+
+                (void)memcpy(blockPath, relativePath, relativePathLength);
+                (void)memcpy(blockPath + relativePathLength, STREAM_BLOCK_PATH_SUFFIX, sizeof(STREAM_BLOCK_PATH_SUFFIX) - 1);
+                *httpStatus = 0;
+                result = BLOB_OK;
+
+                while ((result == BLOB_OK) && !isLastBlock)
+                {
+                    size_t bytesRead = 0;
+                    if ((size_t)*blockCount > (SIZE_MAX / blockSize) - 1)
+                    {
+                        LogError("unable to address block %u of %lu bytes", *blockCount, (unsigned long)blockSize);
+                        result = BLOB_INVALID_ARG;
+                    }
+                    /*the reserved storage is kept, so this does not allocate*/
+                    else if ((BUFFER_build(block, NULL, 0) != 0) || (BUFFER_pre_build(block, blockSize) != 0))
+                    {
+                        LogError("unable to prepare the block buffer");
+                        result = BLOB_ERROR;
+                    }
+                    /*Codes_SRS_BLOB_01_004: [ Blob_UploadStreamFromSasUri shall call readCallback with the offset blockCount * blockSize and the block buffer. ]*/
+                    else if (readCallback((size_t)*blockCount * blockSize, BUFFER_u_char(block), blockSize, &bytesRead, readContext) == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+                    {
+                        /*Codes_SRS_BLOB_01_005: [ If readCallback returns IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT, Blob_UploadStreamFromSasUri shall return BLOB_ABORTED. ]*/
+                        LogInfo("Upload to blob has been aborted by the user");
+                        result = BLOB_ABORTED;
+                    }
+                    else if (bytesRead > blockSize)
+                    {
+                        LogError("readCallback returned %lu bytes for a block of %lu bytes", (unsigned long)bytesRead, (unsigned long)blockSize);
+                        result = BLOB_ERROR;
+                    }
+                    else if (bytesRead == 0)
+                    {
+                        /*Codes_SRS_BLOB_01_006: [ A block shorter than blockSize shall be the last one; a block of 0 bytes shall not be uploaded. ]*/
+                        isLastBlock = 1;
+                    }
+                    else if (*blockCount >= MAX_BLOCK_COUNT)
+                    {
+                        /*Codes_SRS_BLOB_01_007: [ If the file has more than 50000 blocks, Blob_UploadStreamFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+                        LogError("unable to upload more than %lu blocks in one blob", (unsigned long)MAX_BLOCK_COUNT);
+                        result = BLOB_INVALID_ARG;
+                    }
+                    else if ((bytesRead < blockSize) && (BUFFER_shrink(block, blockSize - bytesRead, true) != 0))
+                    {
+                        LogError("unable to BUFFER_shrink");
+                        result = BLOB_ERROR;
+                    }
+                    else if (encode_stream_block_id(*blockCount, blockId) != 0)
+                    {
+                        result = BLOB_ERROR;
+                    }
+                    else
+                    {
+                        isLastBlock = (bytesRead < blockSize);
+
+                        /*Codes_SRS_BLOB_01_008: [ Blob_UploadStreamFromSasUri shall PUT the block to base relativePath + "&comp=block&blockid=" + BASE64 encoded block ID, again up to maxBlockRetries times while HTTPAPIEX_ExecuteRequest fails or the HTTP status is 5xx. ]*/
+                        result = execute_with_retries(httpApiExHandle, blockPath, block, maxBlockRetries, httpStatus, httpResponse);
+                        if (result != BLOB_OK)
+                        {
+                            LogError("unable to upload block %u", *blockCount);
+                        }
+                        else if (*httpStatus >= 300)
+                        {
+                            /*Codes_SRS_BLOB_01_009: [ If the block is answered with a status >= 300, Blob_UploadStreamFromSasUri shall stop and return BLOB_OK. ]*/
+                            isLastBlock = 1;
+                        }
+                        else
+                        {
+                            /*Codes_SRS_BLOB_01_011: [ After a block is uploaded, Blob_UploadStreamFromSasUri shall increment blockCount and call onBlockUploaded with it if onBlockUploaded is not NULL. ]*/
+                            (*blockCount)++;
+                            if (onBlockUploaded != NULL)
+                            {
+                                onBlockUploaded(*blockCount, onBlockUploadedContext);
+                            }
+                        }
+                    }
+                }
+
+                if ((result == BLOB_OK) && (*httpStatus < 300))
+                {
+                    result = put_stream_block_list(httpApiExHandle, relativePath, *blockCount, maxBlockRetries, httpStatus, httpResponse);
+                }
+            }
+            BUFFER_delete(block);
+        }
+        free(blockPath);
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadStreamFromSasUri(const char* SASURI, size_t blockSize, unsigned int maxBlockRetries, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK readCallback, void* readContext, unsigned int* blockCount, BLOB_ON_BLOCK_UPLOADED onBlockUploaded, void* onBlockUploadedContext, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_01_001: [ If SASURI, readCallback, blockCount or httpStatus is NULL, or blockSize is 0 or bigger than 4MB, Blob_UploadStreamFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if ((SASURI == NULL) || (readCallback == NULL) || (blockCount == NULL) || (httpStatus == NULL) || (blockSize == 0) || (blockSize > BLOCK_SIZE))
+    {
+        LogError("invalid argument detected SASURI=%p readCallback=%p blockCount=%p httpStatus=%p blockSize=%lu", SASURI, readCallback, blockCount, httpStatus, (unsigned long)blockSize);
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        const char* hostnameBegin = strstr(SASURI, "://");
+        const char* hostnameEnd = (hostnameBegin == NULL) ? NULL : strchr(hostnameBegin + 3, '/');
+        if (hostnameEnd == NULL)
+        {
+            /*Codes_SRS_BLOB_01_002: [ If the hostname cannot be determined, then Blob_UploadStreamFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+            LogError("hostname cannot be determined");
+            result = BLOB_INVALID_ARG;
+        }
+        else
+        {
+            size_t hostnameSize;
+            char* hostname;
+
+            hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
+            hostnameSize = hostnameEnd - hostnameBegin;
+            hostname = (char*)malloc(hostnameSize + 1);
+            if (hostname == NULL)
+            {
+                LogError("oom - out of memory");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                HTTPAPIEX_HANDLE httpApiExHandle;
+                (void)memcpy(hostname, hostnameBegin, hostnameSize);
+                hostname[hostnameSize] = '\0';
+
+                httpApiExHandle = HTTPAPIEX_Create(hostname);
+                if (httpApiExHandle == NULL)
+                {
+                    LogError("unable to create a HTTPAPIEX_HANDLE");
+                    result = BLOB_ERROR;
+                }
+                else
+                {
+                    if ((certificates != NULL) && (HTTPAPIEX_SetOption(httpApiExHandle, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
+                    {
+                        LogError("failure in setting trusted certificates");
+                        result = BLOB_ERROR;
+                    }
+                    else if ((proxyOptions != NULL && proxyOptions->host_address != NULL) && HTTPAPIEX_SetOption(httpApiExHandle, OPTION_HTTP_PROXY, proxyOptions) == HTTPAPIEX_ERROR)
+                    {
+                        LogError("failure in setting proxy options");
+                        result = BLOB_ERROR;
+                    }
+                    else
+                    {
+                        result = upload_stream_blocks(httpApiExHandle, hostnameEnd, blockSize, maxBlockRetries, readCallback, readContext, blockCount, onBlockUploaded, onBlockUploadedContext, httpStatus, httpResponse);
+                    }
+                    HTTPAPIEX_Destroy(httpApiExHandle);
+                }
+                free(hostname);
+            }
+        }
+    }
+    return result;
+}
@@ -10,6 +10,7 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/sastoken_cache.h"
 #include "azure_c_shared_utility/shared_util_options.h"
 
 #ifdef USE_PROV_MODULE
@@ -19,6 +20,8 @@
 #include "internal/iothub_client_authorization.h"
 
 #define DEFAULT_SAS_TOKEN_EXPIRY_TIME_SECS          3600
+/* a cached token is replaced once a tenth of its lifetime has passed */
+#define SAS_TOKEN_CACHE_REFRESH_DIVISOR             10
 #define INDEFINITE_TIME                             ((time_t)(-1))
 
 typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
@@ -29,6 +32,7 @@ typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
     char* module_id;
     size_t token_expiry_time_sec;
     IOTHUB_CREDENTIAL_TYPE cred_type;
+    SASTOKEN_CACHE_HANDLE sas_token_cache;
 #ifdef USE_PROV_MODULE
     IOTHUB_SECURITY_HANDLE device_auth_handle;
 #endif
@@ -207,6 +211,7 @@ void IoTHubClient_Auth_Destroy(IOTHUB_AUTHORIZATION_HANDLE handle)
 #ifdef USE_PROV_MODULE
         iothub_device_auth_destroy(handle->device_auth_handle);
 #endif
+        SASToken_Cache_Destroy(handle->sas_token_cache);
         free(handle->device_key);
         free(handle->device_id);
         free(handle->module_id);
@@ -434,6 +439,75 @@ char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const c
     return result;
 }
 
+const char* IoTHubClient_Auth_Get_Cached_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, size_t expiry_time_relative_seconds, const char* key_name)
+{
+    const char* result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_IoTHub_Authorization_01_027: [ if handle is NULL, IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+        LogError("Invalid Parameter handle: %p", handle);
+        result = NULL;
+    }
+    else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+    {
+        /* Codes_SRS_IoTHub_Authorization_01_028: [ If the credential type is IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN IoTHubClient_Auth_Get_Cached_SasToken shall return the device_sas_token without copying it. ] */
+        result = handle->device_sas_token;
+    }
+    else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY)
+    {
+        if (scope == NULL)
+        {
+            /* Codes_SRS_IoTHub_Authorization_01_029: [ If the credential type is IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY and scope is NULL, IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+            LogError("Invalid Parameter scope: %p", scope);
+            result = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_IoTHub_Authorization_01_030: [ If there is no token cache, or the cache was made for a different scope, key_name or expiry_time_relative_seconds, IoTHubClient_Auth_Get_Cached_SasToken shall replace it with one created by SASToken_Cache_Create, refreshing every tenth of expiry_time_relative_seconds. ] */
+            if ((handle->sas_token_cache == NULL) ||
+                !SASToken_Cache_Matches(handle->sas_token_cache, scope, key_name, expiry_time_relative_seconds))
+            {
+                size_t refresh_interval = expiry_time_relative_seconds / SAS_TOKEN_CACHE_REFRESH_DIVISOR;
+                SASToken_Cache_Destroy(handle->sas_token_cache);
+                handle->sas_token_cache = SASToken_Cache_Create(handle->device_key, scope, key_name, expiry_time_relative_seconds, (refresh_interval == 0) ? 1 : refresh_interval);
+            }
+
+            if (handle->sas_token_cache == NULL)
+            {
+                /* Codes_SRS_IoTHub_Authorization_01_031: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+                LogError("Failed creating the sas token cache");
+                result = NULL;
+            }
+            /* Codes_SRS_IoTHub_Authorization_01_032: [ Otherwise IoTHubClient_Auth_Get_Cached_SasToken shall return the token returned by SASToken_Cache_GetToken. ] */
+            else if ((result = SASToken_Cache_GetToken(handle->sas_token_cache)) == NULL)
+            {
+                /* Codes_SRS_IoTHub_Authorization_01_031: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+                LogError("Failed getting the cached sas token");
+            }
+        }
+    }
+    else
+    {
+        /* Codes_SRS_IoTHub_Authorization_01_033: [ For any other credential type IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+        LogError("Failed getting cached sas token invalid credential type");
+        result = NULL;
+    }
+    return result;
+}
+
+void IoTHubClient_Auth_Refresh_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle)
+{
+    /* Codes_SRS_IoTHub_Authorization_01_034: [ If handle is NULL or no token has been cached yet, IoTHubClient_Auth_Refresh_SasToken shall do nothing. ] */
+    if ((handle != NULL) && (handle->sas_token_cache != NULL))
+    {
+        /* Codes_SRS_IoTHub_Authorization_01_035: [ Otherwise IoTHubClient_Auth_Refresh_SasToken shall call SASToken_Cache_DoWork so the next token is ready before it is needed. ] */
+        if (SASToken_Cache_DoWork(handle->sas_token_cache) != 0)
+        {
+            LogError("Failed refreshing the cached sas token");
+        }
+    }
+}
+
 const char* IoTHubClient_Auth_Get_DeviceId(IOTHUB_AUTHORIZATION_HANDLE handle)
 {
     const char* result;
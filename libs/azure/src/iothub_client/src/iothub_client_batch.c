@@ -0,0 +1,481 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/map.h"
+
+#include "internal/iothub_client_batch.h"
+
+#define BATCH_FORMAT_JSON_ARRAY_VALUE "json-array"
+#define BATCH_FORMAT_LENGTH_PREFIXED_VALUE "length-prefixed"
+#define LENGTH_PREFIX_SIZE 2
+#define MAX_LENGTH_PREFIXED_PAYLOAD 0xFFFF
+
+typedef struct IOTHUB_CLIENT_BATCH_TAG
+{
+    IOTHUB_CLIENT_BATCHING_OPTIONS options;
+    DLIST_ENTRY pending;
+    size_t pending_count;
+    size_t pending_bytes;
+    tickcounter_ms_t first_queued_ms;
+} IOTHUB_CLIENT_BATCH;
+
+typedef struct BATCHED_MESSAGE_TAG
+{
+    /* has to stay the first field: IoTHubClientCore_LL frees the IOTHUB_MESSAGE_LIST it completes */
+    IOTHUB_MESSAGE_LIST message;
+    DLIST_ENTRY members;
+} BATCHED_MESSAGE;
+
+/* bytes the format adds before the first payload, and around each payload */
+static size_t get_batch_header_size(const IOTHUB_CLIENT_BATCH* batch)
+{
+    return (batch->options.format == IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY) ? 1 : 0;
+}
+
+static size_t get_frame_size(const IOTHUB_CLIENT_BATCH* batch, size_t payload_size)
+{
+    /* JSON: the ',' or the closing ']' after the payload */
+    return payload_size + ((batch->options.format == IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY) ? 1 : LENGTH_PREFIX_SIZE);
+}
+
+static int get_payload(IOTHUB_MESSAGE_HANDLE message, const unsigned char** payload, size_t* payload_size)
+{
+    int result;
+    IOTHUBMESSAGE_CONTENT_TYPE content_type = IoTHubMessage_GetContentType(message);
+    if (content_type == IOTHUBMESSAGE_BYTEARRAY)
+    {
+        if (IoTHubMessage_GetByteArray(message, payload, payload_size) != IOTHUB_MESSAGE_OK)
+        {
+            LogError("Failure getting the message payload");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    else if (content_type == IOTHUBMESSAGE_STRING)
+    {
+        const char* text = IoTHubMessage_GetString(message);
+        if (text == NULL)
+        {
+            LogError("Failure getting the message string");
+            result = __FAILURE__;
+        }
+        else
+        {
+            *payload = (const unsigned char*)text;
+            *payload_size = strlen(text);
+            result = 0;
+        }
+    }
+    else
+    {
+        LogError("Unknown message content type %d", (int)content_type);
+        result = __FAILURE__;
+    }
+    return result;
+}
+
+static bool strings_are_equal(const char* left, const char* right)
+{
+    return (left == NULL) ? (right == NULL) : ((right != NULL) && (strcmp(left, right) == 0));
+}
+
+static bool is_batchable(IOTHUB_MESSAGE_HANDLE message)
+{
+    /* messages that have to be told apart by the service, and diagnostic samples, go on their own */
+    return (IoTHubMessage_GetMessageId(message) == NULL) &&
+        (IoTHubMessage_GetCorrelationId(message) == NULL) &&
+        (IoTHubMessage_GetDiagnosticPropertyData(message) == NULL) &&
+        (IoTHubMessage_GetProperty(message, IOTHUB_CLIENT_BATCH_FORMAT_PROPERTY) == NULL);
+}
+
+static bool have_same_properties(IOTHUB_MESSAGE_HANDLE left, IOTHUB_MESSAGE_HANDLE right)
+{
+    bool result;
+    const char* const* left_keys;
+    const char* const* left_values;
+    size_t left_count;
+    const char* const* right_keys;
+    const char* const* right_values;
+    size_t right_count;
+
+    if (!strings_are_equal(IoTHubMessage_GetContentTypeSystemProperty(left), IoTHubMessage_GetContentTypeSystemProperty(right)) ||
+        !strings_are_equal(IoTHubMessage_GetContentEncodingSystemProperty(left), IoTHubMessage_GetContentEncodingSystemProperty(right)) ||
+        !strings_are_equal(IoTHubMessage_GetOutputName(left), IoTHubMessage_GetOutputName(right)))
+    {
+        result = false;
+    }
+    else if ((Map_GetInternals(IoTHubMessage_GetReadOnlyProperties(left), &left_keys, &left_values, &left_count) != MAP_OK) ||
+        (Map_GetInternals(IoTHubMessage_GetReadOnlyProperties(right), &right_keys, &right_values, &right_count) != MAP_OK))
+    {
+        LogError("Failure getting the message properties");
+        result = false;
+    }
+    else if (left_count != right_count)
+    {
+        result = false;
+    }
+    else
+    {
+        /* messages built the same way list their properties in the same order */
+        size_t index;
+        result = true;
+        for (index = 0; index < left_count && result; index++)
+        {
+            result = (strcmp(left_keys[index], right_keys[index]) == 0) && (strcmp(left_values[index], right_values[index]) == 0);
+        }
+    }
+    return result;
+}
+
+static int copy_properties(IOTHUB_MESSAGE_HANDLE source, IOTHUB_MESSAGE_HANDLE destination)
+{
+    int result;
+    const char* const* keys;
+    const char* const* values;
+    size_t count;
+    const char* content_type = IoTHubMessage_GetContentTypeSystemProperty(source);
+    const char* content_encoding = IoTHubMessage_GetContentEncodingSystemProperty(source);
+    const char* output_name = IoTHubMessage_GetOutputName(source);
+
+    if (Map_GetInternals(IoTHubMessage_GetReadOnlyProperties(source), &keys, &values, &count) != MAP_OK)
+    {
+        LogError("Failure getting the message properties");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t index;
+        result = 0;
+        for (index = 0; index < count && result == 0; index++)
+        {
+            if (IoTHubMessage_SetProperty(destination, keys[index], values[index]) != IOTHUB_MESSAGE_OK)
+            {
+                LogError("Failure setting property %s", keys[index]);
+                result = __FAILURE__;
+            }
+        }
+
+        if (result != 0)
+        {
+            /* already logged */
+        }
+        else if ((content_type != NULL) && (IoTHubMessage_SetContentTypeSystemProperty(destination, content_type) != IOTHUB_MESSAGE_OK))
+        {
+            LogError("Failure setting the content type");
+            result = __FAILURE__;
+        }
+        else if ((content_encoding != NULL) && (IoTHubMessage_SetContentEncodingSystemProperty(destination, content_encoding) != IOTHUB_MESSAGE_OK))
+        {
+            LogError("Failure setting the content encoding");
+            result = __FAILURE__;
+        }
+        else if ((output_name != NULL) && (IoTHubMessage_SetOutputName(destination, output_name) != IOTHUB_MESSAGE_OK))
+        {
+            LogError("Failure setting the output name");
+            result = __FAILURE__;
+        }
+    }
+    return result;
+}
+
+static void complete_messages(PDLIST_ENTRY messages, IOTHUB_CLIENT_CONFIRMATION_RESULT result)
+{
+    PDLIST_ENTRY entry;
+    while ((entry = DList_RemoveHeadList(messages)) != messages)
+    {
+        IOTHUB_MESSAGE_LIST* message = containingRecord(entry, IOTHUB_MESSAGE_LIST, entry);
+        if (message->callback != NULL)
+        {
+            message->callback(result, message->context);
+        }
+        IoTHubMessage_Destroy(message->messageHandle);
+        free(message);
+    }
+}
+
+static void on_batched_message_complete(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* context)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_016: [ When the batched message is completed, the confirmation callback of each of its messages shall be called with the same result, in the order the messages were added, and the messages shall be destroyed. ] */
+    BATCHED_MESSAGE* batched_message = (BATCHED_MESSAGE*)context;
+    complete_messages(&batched_message->members, result);
+}
+
+static IOTHUB_MESSAGE_HANDLE create_batched_payload(IOTHUB_CLIENT_BATCH* batch)
+{
+    IOTHUB_MESSAGE_HANDLE result;
+    unsigned char* payload = (unsigned char*)malloc(batch->pending_bytes);
+    if (payload == NULL)
+    {
+        LogError("Failure allocating %lu bytes for the batch payload", (unsigned long)batch->pending_bytes);
+        result = NULL;
+    }
+    else
+    {
+        bool is_json = (batch->options.format == IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+        size_t position = 0;
+        PDLIST_ENTRY entry = batch->pending.Flink;
+
+        if (is_json)
+        {
+            payload[position++] = '[';
+        }
+
+        result = NULL;
+        while (entry != &batch->pending)
+        {
+            IOTHUB_MESSAGE_LIST* message = containingRecord(entry, IOTHUB_MESSAGE_LIST, entry);
+            const unsigned char* member_payload;
+            size_t member_size;
+
+            if (get_payload(message->messageHandle, &member_payload, &member_size) != 0)
+            {
+                break;
+            }
+
+            if (!is_json)
+            {
+                payload[position++] = (unsigned char)(member_size >> 8);
+                payload[position++] = (unsigned char)(member_size & 0xFF);
+            }
+            if (member_size > 0)
+            {
+                (void)memcpy(payload + position, member_payload, member_size);
+                position += member_size;
+            }
+            entry = entry->Flink;
+            if (is_json)
+            {
+                payload[position++] = (entry == &batch->pending) ? ']' : ',';
+            }
+        }
+
+        if (entry == &batch->pending)
+        {
+            result = IoTHubMessage_CreateFromByteArray(payload, position);
+            if (result == NULL)
+            {
+                LogError("Failure creating the batched message");
+            }
+        }
+        free(payload);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_BATCH_HANDLE IoTHubClient_Batch_Create(const IOTHUB_CLIENT_BATCHING_OPTIONS* options)
+{
+    IOTHUB_CLIENT_BATCH* result;
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_001: [ If options is NULL, max_messages is less than 2, max_latency_ms is 0 or format is unknown, IoTHubClient_Batch_Create shall fail and return NULL. ] */
+    if ((options == NULL) ||
+        (options->max_messages < 2) ||
+        (options->max_latency_ms == 0) ||
+        ((options->format != IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY) && (options->format != IOTHUB_CLIENT_BATCH_FORMAT_LENGTH_PREFIXED)))
+    {
+        LogError("Invalid batching options %p", options);
+        result = NULL;
+    }
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_002: [ If allocating the batch fails, IoTHubClient_Batch_Create shall return NULL. ] */
+    else if ((result = (IOTHUB_CLIENT_BATCH*)malloc(sizeof(IOTHUB_CLIENT_BATCH))) == NULL)
+    {
+        LogError("Failure allocating the batch");
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_003: [ Otherwise IoTHubClient_Batch_Create shall copy options and return an empty batch. ] */
+        result->options = *options;
+        DList_InitializeListHead(&result->pending);
+        result->pending_count = 0;
+        result->pending_bytes = 0;
+        result->first_queued_ms = 0;
+    }
+    return result;
+}
+
+void IoTHubClient_Batch_Destroy(IOTHUB_CLIENT_BATCH_HANDLE batch)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_004: [ If batch is NULL, IoTHubClient_Batch_Destroy shall do nothing. ] */
+    if (batch != NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_005: [ IoTHubClient_Batch_Destroy shall call the confirmation callback of every pending message with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, destroy the messages and free the batch. ] */
+        complete_messages(&batch->pending, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
+        free(batch);
+    }
+}
+
+IOTHUB_CLIENT_BATCH_ADD_RESULT IoTHubClient_Batch_Add(IOTHUB_CLIENT_BATCH_HANDLE batch, IOTHUB_MESSAGE_LIST* message, tickcounter_ms_t now)
+{
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result;
+    const unsigned char* payload;
+    size_t payload_size;
+
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_006: [ If batch or message is NULL, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_ERROR. ] */
+    if ((batch == NULL) || (message == NULL))
+    {
+        LogError("Invalid argument batch=%p, message=%p", batch, message);
+        result = IOTHUB_CLIENT_BATCH_ADD_ERROR;
+    }
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_007: [ If the message has a message id, a correlation id, diagnostic data or the batch-format property, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE. ] */
+    else if (!is_batchable(message->messageHandle))
+    {
+        result = IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE;
+    }
+    else if (get_payload(message->messageHandle, &payload, &payload_size) != 0)
+    {
+        result = IOTHUB_CLIENT_BATCH_ADD_ERROR;
+    }
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_008: [ If the payload alone does not fit in max_bytes, or is longer than 65535 bytes with the length prefixed format, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE. ] */
+    else if (((batch->options.format == IOTHUB_CLIENT_BATCH_FORMAT_LENGTH_PREFIXED) && (payload_size > MAX_LENGTH_PREFIXED_PAYLOAD)) ||
+        ((batch->options.max_bytes != 0) && (get_batch_header_size(batch) + get_frame_size(batch, payload_size) > batch->options.max_bytes)))
+    {
+        result = IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE;
+    }
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_009: [ If messages are pending and the batch is full, the message would take it over max_bytes, or its properties, content type, content encoding or output name differ from the pending ones, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST. ] */
+    else if ((batch->pending_count > 0) &&
+        ((batch->pending_count >= batch->options.max_messages) ||
+        ((batch->options.max_bytes != 0) && (batch->pending_bytes + get_frame_size(batch, payload_size) > batch->options.max_bytes)) ||
+        !have_same_properties(containingRecord(batch->pending.Flink, IOTHUB_MESSAGE_LIST, entry)->messageHandle, message->messageHandle)))
+    {
+        result = IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_010: [ Otherwise IoTHubClient_Batch_Add shall take ownership of message, keep it pending and return IOTHUB_CLIENT_BATCH_ADD_OK. ] */
+        if (batch->pending_count == 0)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_011: [ The time of the first pending message shall be now. ] */
+            batch->first_queued_ms = now;
+            batch->pending_bytes = get_batch_header_size(batch);
+        }
+        DList_InsertTailList(&batch->pending, &message->entry);
+        batch->pending_count++;
+        batch->pending_bytes += get_frame_size(batch, payload_size);
+        result = IOTHUB_CLIENT_BATCH_ADD_OK;
+    }
+    return result;
+}
+
+bool IoTHubClient_Batch_IsDue(IOTHUB_CLIENT_BATCH_HANDLE batch, tickcounter_ms_t now)
+{
+    bool result;
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_012: [ If batch is NULL or no message is pending, IoTHubClient_Batch_IsDue shall return false. ] */
+    if ((batch == NULL) || (batch->pending_count == 0))
+    {
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_013: [ IoTHubClient_Batch_IsDue shall return true if max_messages are pending, the pending payloads reach max_bytes, or max_latency_ms have passed since the first pending message was added. ] */
+        result = (batch->pending_count >= batch->options.max_messages) ||
+            ((batch->options.max_bytes != 0) && (batch->pending_bytes >= batch->options.max_bytes)) ||
+            (now < batch->first_queued_ms) ||
+            (now - batch->first_queued_ms >= batch->options.max_latency_ms);
+    }
+    return result;
+}
+
+bool IoTHubClient_Batch_GetTimeToDue(IOTHUB_CLIENT_BATCH_HANDLE batch, tickcounter_ms_t now, tickcounter_ms_t* ms_to_due)
+{
+    bool result;
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_021: [ If batch or ms_to_due is NULL or no message is pending, IoTHubClient_Batch_GetTimeToDue shall return false. ] */
+    if ((batch == NULL) || (ms_to_due == NULL) || (batch->pending_count == 0))
+    {
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_022: [ Otherwise IoTHubClient_Batch_GetTimeToDue shall set ms_to_due to 0 if IoTHubClient_Batch_IsDue would return true, and to the milliseconds left until max_latency_ms have passed since the first pending message was added otherwise, and return true. ] */
+        if (IoTHubClient_Batch_IsDue(batch, now))
+        {
+            *ms_to_due = 0;
+        }
+        else
+        {
+            *ms_to_due = batch->first_queued_ms + batch->options.max_latency_ms - now;
+        }
+        result = true;
+    }
+    return result;
+}
+
+bool IoTHubClient_Batch_HasPending(IOTHUB_CLIENT_BATCH_HANDLE batch)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_017: [ IoTHubClient_Batch_HasPending shall return true if batch is not NULL and has pending messages, false otherwise. ] */
+    return (batch != NULL) && (batch->pending_count > 0);
+}
+
+IOTHUB_MESSAGE_LIST* IoTHubClient_Batch_Flush(IOTHUB_CLIENT_BATCH_HANDLE batch)
+{
+    IOTHUB_MESSAGE_LIST* result;
+    /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_014: [ If batch is NULL or no message is pending, IoTHubClient_Batch_Flush shall return NULL. ] */
+    if ((batch == NULL) || (batch->pending_count == 0))
+    {
+        result = NULL;
+    }
+    else if (batch->pending_count == 1)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_015: [ If one message is pending, IoTHubClient_Batch_Flush shall return it unchanged. ] */
+        result = containingRecord(DList_RemoveHeadList(&batch->pending), IOTHUB_MESSAGE_LIST, entry);
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_018: [ Otherwise IoTHubClient_Batch_Flush shall return a new message whose payload combines the pending payloads in the configured format, with the properties, content type, content encoding and output name of the pending messages and the batch-format property. ] */
+        /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_019: [ The new message shall time out like the first pending message. ] */
+        IOTHUB_MESSAGE_LIST* first = containingRecord(batch->pending.Flink, IOTHUB_MESSAGE_LIST, entry);
+        BATCHED_MESSAGE* batched_message = (BATCHED_MESSAGE*)malloc(sizeof(BATCHED_MESSAGE));
+        if (batched_message == NULL)
+        {
+            LogError("Failure allocating the batched message");
+            result = NULL;
+        }
+        else if ((batched_message->message.messageHandle = create_batched_payload(batch)) == NULL)
+        {
+            free(batched_message);
+            result = NULL;
+        }
+        else if ((copy_properties(first->messageHandle, batched_message->message.messageHandle) != 0) ||
+            (IoTHubMessage_SetProperty(batched_message->message.messageHandle, IOTHUB_CLIENT_BATCH_FORMAT_PROPERTY,
+                (batch->options.format == IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY) ? BATCH_FORMAT_JSON_ARRAY_VALUE : BATCH_FORMAT_LENGTH_PREFIXED_VALUE) != IOTHUB_MESSAGE_OK))
+        {
+            LogError("Failure setting the batched message properties");
+            IoTHubMessage_Destroy(batched_message->message.messageHandle);
+            free(batched_message);
+            result = NULL;
+        }
+        else
+        {
+            PDLIST_ENTRY entry;
+            batched_message->message.callback = on_batched_message_complete;
+            batched_message->message.context = batched_message;
+            batched_message->message.ms_timesOutAfter = first->ms_timesOutAfter;
+            batched_message->message.message_timeout_value = first->message_timeout_value;
+            batched_message->message.message_count = batch->pending_count;
+            DList_InitializeListHead(&batched_message->members);
+            while ((entry = DList_RemoveHeadList(&batch->pending)) != &batch->pending)
+            {
+                DList_InsertTailList(&batched_message->members, entry);
+            }
+            result = &batched_message->message;
+        }
+
+        if (result == NULL)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_BATCH_01_020: [ If building the new message fails, IoTHubClient_Batch_Flush shall call the confirmation callback of every pending message with IOTHUB_CLIENT_CONFIRMATION_ERROR, destroy them and return NULL. ] */
+            complete_messages(&batch->pending, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+        }
+    }
+
+    if (batch != NULL)
+    {
+        batch->pending_count = 0;
+        batch->pending_bytes = 0;
+    }
+    return result;
+}
@@ -23,6 +23,8 @@
 #include "internal/iothub_client_authorization.h"
 #include "internal/iothub_client_private.h"
 #include "internal/iothub_client_diagnostic.h"
+#include "internal/iothub_client_batch.h"
+#include "internal/iothub_client_persistent_queue.h"
 #include "internal/iothubtransport.h"
 
 #ifndef DONT_USE_UPLOADTOBLOB
@@ -37,6 +39,7 @@
 
 #define LOG_ERROR_RESULT LogError("result = %s", ENUM_TO_STRING(IOTHUB_CLIENT_RESULT, result));
 #define INDEFINITE_TIME ((time_t)(-1))
+#define DOWORK_DEFAULT_INTERVAL_MS 1000 /*how often transports without _DoWorkWithBudget want to be called*/
 
 DEFINE_ENUM_STRINGS(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, IOTHUB_CLIENT_FILE_UPLOAD_RESULT_VALUES);
 DEFINE_ENUM_STRINGS(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_RESULT_VALUES);
@@ -120,6 +123,10 @@ typedef struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG
     STRING_HANDLE product_info;
     IOTHUB_DIAGNOSTIC_SETTING_DATA diagnostic_setting;
     SINGLYLINKEDLIST_HANDLE event_callbacks;  // List of IOTHUB_EVENT_CALLBACK's
+    IOTHUB_CLIENT_BATCH_HANDLE telemetry_batch; /*NULL unless OPTION_TELEMETRY_BATCHING is set*/
+    IOTHUB_CLIENT_SEND_STATISTICS send_statistics;
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE persistent_queue; /*NULL unless OPTION_PERSISTENT_QUEUE is set*/
+    bool is_connected;
 }IOTHUB_CLIENT_CORE_LL_HANDLE_DATA;
 
 static const char HOSTNAME_TOKEN[] = "HostName";
@@ -269,6 +276,8 @@ static void setTransportProtocol(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData,
     handleData->IoTHubTransport_Subscribe_InputQueue = protocol->IoTHubTransport_Subscribe_InputQueue;
     handleData->IoTHubTransport_Unsubscribe_InputQueue = protocol->IoTHubTransport_Unsubscribe_InputQueue;
     handleData->IoTHubTransport_SetCallbackContext = protocol->IoTHubTransport_SetCallbackContext;
+    handleData->IoTHubTransport_GetTrafficStatistics = protocol->IoTHubTransport_GetTrafficStatistics;
+    handleData->IoTHubTransport_DoWorkWithBudget = protocol->IoTHubTransport_DoWorkWithBudget;
 }
 
 static bool is_event_equal(IOTHUB_EVENT_CALLBACK *event_callback, const char *input_name)
@@ -478,10 +487,17 @@ static void IoTHubClientCore_LL_SendComplete(PDLIST_ENTRY completed, IOTHUB_CLIE
     {
         /*Codes_SRS_IOTHUBCLIENT_LL_02_027: [If parameter result is IOTHUB_CLIENT_CONFIRMATION_ERROR then IoTHubClientCore_LL_SendComplete shall call all the non-NULL callbacks with the result parameter set to IOTHUB_CLIENT_CONFIRMATION_ERROR and the context set to the context passed originally in the SendEventAsync call.] */
         /*Codes_SRS_IOTHUBCLIENT_LL_02_025: [If parameter result is IOTHUB_CLIENT_CONFIRMATION_OK then IoTHubClientCore_LL_SendComplete shall call all the non-NULL callbacks with the result parameter set to IOTHUB_CLIENT_CONFIRMATION_OK and the context set to the context passed originally in the SendEventAsync call.]*/
+        IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)ctx;
         PDLIST_ENTRY oldest;
         while ((oldest = DList_RemoveHeadList(completed)) != completed)
         {
             IOTHUB_MESSAGE_LIST* messageList = (IOTHUB_MESSAGE_LIST*)containingRecord(oldest, IOTHUB_MESSAGE_LIST, entry);
+            /*Codes_SRS_IOTHUBCLIENT_LL_01_002: [ If result is IOTHUB_CLIENT_CONFIRMATION_OK, IoTHubClientCore_LL_SendComplete shall count each completed message once as a transport message and as many times as the messages it carries. ]*/
+            if (result == IOTHUB_CLIENT_CONFIRMATION_OK)
+            {
+                handleData->send_statistics.messages_confirmed += messageList->message_count;
+                handleData->send_statistics.transport_messages_confirmed++;
+            }
             /*Codes_SRS_IOTHUBCLIENT_LL_02_026: [If any callback is NULL then there shall not be a callback call.]*/
             if (messageList->callback != NULL)
             {
@@ -566,6 +582,8 @@ static void IoTHubClientCore_LL_ConnectionStatusCallBack(IOTHUB_CLIENT_CONNECTIO
     {
         IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)ctx;
 
+        handleData->is_connected = (status == IOTHUB_CLIENT_CONNECTION_AUTHENTICATED);
+
         /*Codes_SRS_IOTHUBCLIENT_LL_25_114: [IoTHubClientCore_LL_ConnectionStatusCallBack shall call non-callback set by the user from IoTHubClientCore_LL_SetConnectionStatusCallback passing the status, reason and the passed userContextCallback.]*/
         if (handleData->conStatusCallback != NULL)
         {
@@ -1655,6 +1673,18 @@ void IoTHubClientCore_LL_Destroy(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle
             free(temp);
         }
 
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_003: [ IoTHubClientCore_LL_Destroy shall destroy the telemetry batch, which completes the messages still waiting in it with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY. ]*/
+        if (handleData->telemetry_batch != NULL)
+        {
+            IoTHubClient_Batch_Destroy(handleData->telemetry_batch);
+        }
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_016: [ IoTHubClientCore_LL_Destroy shall destroy the persistent queue after the waitingToSend list, so that replayed messages completed with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY stay stored. ]*/
+        if (handleData->persistent_queue != NULL)
+        {
+            IoTHubClient_PersistentQueue_Destroy(handleData->persistent_queue);
+        }
+
         /* Codes_SRS_IOTHUBCLIENT_LL_07_007: [ IoTHubClientCore_LL_Destroy shall iterate the device twin queues and destroy any remaining items. ] */
         while ((unsend = DList_RemoveHeadList(&(handleData->iot_msg_queue))) != &(handleData->iot_msg_queue))
         {
@@ -1713,6 +1743,52 @@ static int attach_ms_timesOutAfter(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData
     return result;
 }
 
+static void flush_telemetry_batch(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData)
+{
+    IOTHUB_MESSAGE_LIST* batched = IoTHubClient_Batch_Flush(handleData->telemetry_batch);
+    if (batched != NULL)
+    {
+        DList_InsertTailList(&(handleData->waitingToSend), &(batched->entry));
+    }
+}
+
+static void add_to_telemetry_batch(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST* newEntry)
+{
+    tickcounter_ms_t now = 0;
+    IOTHUB_CLIENT_BATCH_ADD_RESULT add_result;
+
+    if (tickcounter_get_current_ms(handleData->tickCounter, &now) != 0)
+    {
+        LogError("unable to get the current ms, the message will not be batched");
+        add_result = IOTHUB_CLIENT_BATCH_ADD_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_005: [ If the message cannot join the messages waiting in the batch, IoTHubClientCore_LL_SendEventAsync shall move the batch to waitingToSend and add the message to a new batch. ]*/
+        add_result = IoTHubClient_Batch_Add(handleData->telemetry_batch, newEntry, now);
+        if (add_result == IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST)
+        {
+            flush_telemetry_batch(handleData);
+            add_result = IoTHubClient_Batch_Add(handleData->telemetry_batch, newEntry, now);
+        }
+    }
+
+    if (add_result == IOTHUB_CLIENT_BATCH_ADD_OK)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_006: [ If the batch is then due, IoTHubClientCore_LL_SendEventAsync shall move it to waitingToSend. ]*/
+        if (IoTHubClient_Batch_IsDue(handleData->telemetry_batch, now))
+        {
+            flush_telemetry_batch(handleData);
+        }
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_007: [ A message that cannot be batched shall be added to waitingToSend after the messages waiting in the batch, so that messages keep their order. ]*/
+        flush_telemetry_batch(handleData);
+        DList_InsertTailList(&(handleData->waitingToSend), &(newEntry->entry));
+    }
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SendEventAsync(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1767,7 +1843,29 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SendEventAsync(IOTHUB_CLIENT_CORE_LL_HA
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClientCore_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
                     newEntry->callback = eventConfirmationCallback;
                     newEntry->context = userContextCallback;
-                    DList_InsertTailList(&(iotHubClientHandle->waitingToSend), &(newEntry->entry));
+                    newEntry->message_count = 1;
+                    if ((handleData->persistent_queue != NULL) &&
+                        (!handleData->is_connected || IoTHubClient_PersistentQueue_HasStored(handleData->persistent_queue)) &&
+                        (IoTHubClient_PersistentQueue_Store(handleData->persistent_queue, newEntry->messageHandle) == 0))
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_01_017: [ If the persistent queue is on and the client is not connected, or stored messages wait to be replayed, IoTHubClientCore_LL_SendEventAsync shall store the message with IoTHubClient_PersistentQueue_Store and complete it with IOTHUB_CLIENT_CONFIRMATION_PERSISTED. ]*/
+                        if (newEntry->callback != NULL)
+                        {
+                            newEntry->callback(IOTHUB_CLIENT_CONFIRMATION_PERSISTED, newEntry->context);
+                        }
+                        IoTHubMessage_Destroy(newEntry->messageHandle);
+                        free(newEntry);
+                    }
+                    /*Codes_SRS_IOTHUBCLIENT_LL_01_018: [ If IoTHubClient_PersistentQueue_Store fails, the message shall be kept in memory as if the persistent queue was off. ]*/
+                    else if (handleData->telemetry_batch == NULL)
+                    {
+                        DList_InsertTailList(&(iotHubClientHandle->waitingToSend), &(newEntry->entry));
+                    }
+                    else
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_01_004: [ If telemetry batching is on, IoTHubClientCore_LL_SendEventAsync shall add the new record to the telemetry batch with IoTHubClient_Batch_Add instead of waitingToSend. ]*/
+                        add_to_telemetry_batch(handleData, newEntry);
+                    }
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_015: [Otherwise IoTHubClientCore_LL_SendEventAsync shall succeed and return IOTHUB_CLIENT_OK.] */
                     result = IOTHUB_CLIENT_OK;
                 }
@@ -1971,6 +2069,121 @@ static void DoTimeouts(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData)
     }
 }
 
+static void do_persistent_queue_work(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData)
+{
+    if (!handleData->is_connected)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_019: [ While the client is not connected, IoTHubClientCore_LL_DoWork shall move the messages of waitingToSend that were not replayed to the persistent queue, in order, completing each one with IOTHUB_CLIENT_CONFIRMATION_PERSISTED, and stop at the first one that cannot be stored. ]*/
+        PDLIST_ENTRY current = handleData->waitingToSend.Flink;
+        while (current != &(handleData->waitingToSend))
+        {
+            IOTHUB_MESSAGE_LIST* entry = containingRecord(current, IOTHUB_MESSAGE_LIST, entry);
+            PDLIST_ENTRY next = current->Flink;
+            if (!IoTHubClient_PersistentQueue_IsReplayed(handleData->persistent_queue, entry))
+            {
+                if (IoTHubClient_PersistentQueue_Store(handleData->persistent_queue, entry->messageHandle) != 0)
+                {
+                    break;
+                }
+                (void)DList_RemoveEntryList(current);
+                if (entry->callback != NULL)
+                {
+                    entry->callback(IOTHUB_CLIENT_CONFIRMATION_PERSISTED, entry->context);
+                }
+                IoTHubMessage_Destroy(entry->messageHandle);
+                free(entry);
+            }
+            current = next;
+        }
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_020: [ Once the client is connected, IoTHubClientCore_LL_DoWork shall add the messages returned by IoTHubClient_PersistentQueue_GetNext to waitingToSend. ]*/
+        tickcounter_ms_t now;
+        if (tickcounter_get_current_ms(handleData->tickCounter, &now) != 0)
+        {
+            LogError("unable to get the current ms, stored messages are replayed later");
+        }
+        else
+        {
+            IOTHUB_MESSAGE_LIST* replayed;
+            while ((replayed = IoTHubClient_PersistentQueue_GetNext(handleData->persistent_queue, now)) != NULL)
+            {
+                DList_InsertTailList(&(handleData->waitingToSend), &(replayed->entry));
+            }
+        }
+    }
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_021: [ IoTHubClientCore_LL_DoWork shall then call IoTHubClient_PersistentQueue_DoWork. ]*/
+    IoTHubClient_PersistentQueue_DoWork(handleData->persistent_queue);
+}
+
+/*do the work of IoTHubClientCore_LL_DoWork that comes before the underlaying layer's _DoWork function*/
+static void DoClientWork(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData)
+{
+    DoTimeouts(handleData);
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_008: [ If the telemetry batch is due, IoTHubClientCore_LL_DoWork shall move it to waitingToSend before calling the underlaying layer's _DoWork function. ]*/
+    if (handleData->telemetry_batch != NULL)
+    {
+        tickcounter_ms_t now;
+        if (tickcounter_get_current_ms(handleData->tickCounter, &now) != 0)
+        {
+            LogError("unable to get the current ms, the telemetry batch is sent now");
+            flush_telemetry_batch(handleData);
+        }
+        else if (IoTHubClient_Batch_IsDue(handleData->telemetry_batch, now))
+        {
+            flush_telemetry_batch(handleData);
+        }
+    }
+
+    if (handleData->persistent_queue != NULL)
+    {
+        do_persistent_queue_work(handleData);
+    }
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_07_008: [ IoTHubClientCore_LL_DoWork shall iterate the message queue and execute the underlying transports IoTHubTransport_ProcessItem function for each item. ] */
+    DLIST_ENTRY* client_item = handleData->iot_msg_queue.Flink;
+    (void)printf("IoTHubClient_LL_DoWork not NULL 0x%x.\r\n", client_item);
+    while (client_item != &(handleData->iot_msg_queue)) /*while we are not at the end of the list*/
+    {
+        (void)printf("IoTHubClient_LL_DoWork loop.\r\n");
+        PDLIST_ENTRY next_item = client_item->Flink;
+
+        IOTHUB_DEVICE_TWIN* queue_data = containingRecord(client_item, IOTHUB_DEVICE_TWIN, entry);
+        IOTHUB_IDENTITY_INFO identity_info;
+        identity_info.device_twin = queue_data;
+        IOTHUB_PROCESS_ITEM_RESULT process_results =  handleData->IoTHubTransport_ProcessItem(handleData->transportHandle, IOTHUB_TYPE_DEVICE_TWIN, &identity_info);
+        if (process_results == IOTHUB_PROCESS_CONTINUE || process_results == IOTHUB_PROCESS_NOT_CONNECTED)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_07_010: [ If 'IoTHubTransport_ProcessItem' returns IOTHUB_PROCESS_CONTINUE or IOTHUB_PROCESS_NOT_CONNECTED IoTHubClientCore_LL_DoWork shall continue on to call the underlaying layer's _DoWork function. ]*/
+            break;
+        }
+        else
+        {
+            DList_RemoveEntryList(client_item);
+            if (process_results == IOTHUB_PROCESS_OK)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_07_011: [ If 'IoTHubTransport_ProcessItem' returns IOTHUB_PROCESS_OK IoTHubClientCore_LL_DoWork shall add the IOTHUB_DEVICE_TWIN to the ack queue. ]*/
+                DList_InsertTailList(&(handleData->iot_ack_queue), &(queue_data->entry));
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_07_012: [ If 'IoTHubTransport_ProcessItem' returns any other value IoTHubClientCore_LL_DoWork shall destroy the IOTHUB_DEVICE_TWIN item. ]*/
+                LogError("Failure queue processing item");
+                device_twin_data_destroy(queue_data);
+            }
+        }
+        // Move along to the next item
+        client_item = next_item;
+    }
+    (void)printf("IoTHubClient_LL_DoWork exit loop.\r\n");
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_001: [ IoTHubClientCore_LL_DoWork shall call IoTHubClient_Auth_Refresh_SasToken before the underlaying layer's _DoWork function, so a cached SAS token is regenerated ahead of a reconnect. ]*/
+    IoTHubClient_Auth_Refresh_SasToken(handleData->authorization_module);
+}
+
 void IoTHubClientCore_LL_DoWork(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle)
 {
     (void)printf("IoTHubClient_LL_DoWork start.\r\n");
@@ -1978,48 +2191,106 @@ void IoTHubClientCore_LL_DoWork(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle)
     if (iotHubClientHandle != NULL)
     {
         IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)iotHubClientHandle;
-        DoTimeouts(handleData);
+        DoClientWork(handleData);
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClientCore_LL_DoWork shall invoke the underlaying layer's _DoWork function.]*/
+        handleData->IoTHubTransport_DoWork(handleData->transportHandle);
+    }
+}
+
+static void lower_to_deadline(uint32_t* ms_to_next_call, tickcounter_ms_t now, tickcounter_ms_t deadline)
+{
+    tickcounter_ms_t ms_left = (deadline > now) ? (deadline - now) : 0;
+    if (ms_left < *ms_to_next_call)
+    {
+        *ms_to_next_call = (uint32_t)ms_left;
+    }
+}
+
+static void lower_to_client_deadlines(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData, uint32_t* next_call_in_ms)
+{
+    tickcounter_ms_t now;
+    if (tickcounter_get_current_ms(handleData->tickCounter, &now) != 0)
+    {
+        LogError("unable to get the current ms, the next call is not delayed");
+        *next_call_in_ms = 0;
+    }
+    else
+    {
+        tickcounter_ms_t ms_to_due;
 
-        /*Codes_SRS_IOTHUBCLIENT_LL_07_008: [ IoTHubClientCore_LL_DoWork shall iterate the message queue and execute the underlying transports IoTHubTransport_ProcessItem function for each item. ] */
-        DLIST_ENTRY* client_item = handleData->iot_msg_queue.Flink;
-        (void)printf("IoTHubClient_LL_DoWork not NULL 0x%x.\r\n", client_item);
-        while (client_item != &(handleData->iot_msg_queue)) /*while we are not at the end of the list*/
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_030: [ next_call_in_ms shall be lowered to the time left until the first message of waitingToSend times out. ]*/
+        DLIST_ENTRY* current = handleData->waitingToSend.Flink;
+        while (current != &(handleData->waitingToSend))
         {
-            (void)printf("IoTHubClient_LL_DoWork loop.\r\n");
-            PDLIST_ENTRY next_item = client_item->Flink;
+            IOTHUB_MESSAGE_LIST* entry = containingRecord(current, IOTHUB_MESSAGE_LIST, entry);
+            if (entry->ms_timesOutAfter != 0)
+            {
+                lower_to_deadline(next_call_in_ms, now, entry->ms_timesOutAfter + ((tickcounter_ms_t)entry->message_timeout_value + 1) * 1000);
+            }
+            current = current->Flink;
+        }
 
-            IOTHUB_DEVICE_TWIN* queue_data = containingRecord(client_item, IOTHUB_DEVICE_TWIN, entry);
-            IOTHUB_IDENTITY_INFO identity_info;
-            identity_info.device_twin = queue_data;
-            IOTHUB_PROCESS_ITEM_RESULT process_results =  handleData->IoTHubTransport_ProcessItem(handleData->transportHandle, IOTHUB_TYPE_DEVICE_TWIN, &identity_info);
-            if (process_results == IOTHUB_PROCESS_CONTINUE || process_results == IOTHUB_PROCESS_NOT_CONNECTED)
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_031: [ next_call_in_ms shall be lowered to the time left until the telemetry batch is due, as given by IoTHubClient_Batch_GetTimeToDue. ]*/
+        if ((handleData->telemetry_batch != NULL) && IoTHubClient_Batch_GetTimeToDue(handleData->telemetry_batch, now, &ms_to_due))
+        {
+            lower_to_deadline(next_call_in_ms, now, now + ms_to_due);
+        }
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_032: [ While the client is connected, next_call_in_ms shall be lowered to the time left until the persistent queue can replay its next message, as given by IoTHubClient_PersistentQueue_GetTimeToNext. ]*/
+        if ((handleData->persistent_queue != NULL) && handleData->is_connected && IoTHubClient_PersistentQueue_GetTimeToNext(handleData->persistent_queue, now, &ms_to_due))
+        {
+            lower_to_deadline(next_call_in_ms, now, now + ms_to_due);
+        }
+    }
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_DoWorkWithBudget(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, const IOTHUB_CLIENT_DOWORK_BUDGET* budget, uint32_t* next_call_in_ms)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_026: [ If iotHubClientHandle, budget or next_call_in_ms is NULL, IoTHubClientCore_LL_DoWorkWithBudget shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (iotHubClientHandle == NULL || budget == NULL || next_call_in_ms == NULL)
+    {
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LOG_ERROR_RESULT;
+    }
+    else
+    {
+        IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)iotHubClientHandle;
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_027: [ IoTHubClientCore_LL_DoWorkWithBudget shall do the work of IoTHubClientCore_LL_DoWork, calling the underlaying layer's _DoWorkWithBudget function instead of _DoWork when the transport has one. ]*/
+        DoClientWork(handleData);
+
+        if (handleData->IoTHubTransport_DoWorkWithBudget != NULL)
+        {
+            if (handleData->IoTHubTransport_DoWorkWithBudget(handleData->transportHandle, budget, next_call_in_ms) != 0)
             {
-                /*Codes_SRS_IOTHUBCLIENT_LL_07_010: [ If 'IoTHubTransport_ProcessItem' returns IOTHUB_PROCESS_CONTINUE or IOTHUB_PROCESS_NOT_CONNECTED IoTHubClientCore_LL_DoWork shall continue on to call the underlaying layer's _DoWork function. ]*/
-                break;
+                /*Codes_SRS_IOTHUBCLIENT_LL_01_028: [ If _DoWorkWithBudget fails, IoTHubClientCore_LL_DoWorkWithBudget shall set next_call_in_ms to 0 and return IOTHUB_CLIENT_ERROR. ]*/
+                LogError("the transport failed doing its work");
+                *next_call_in_ms = 0;
+                result = IOTHUB_CLIENT_ERROR;
             }
             else
             {
-                DList_RemoveEntryList(client_item);
-                if (process_results == IOTHUB_PROCESS_OK)
-                {
-                    /*Codes_SRS_IOTHUBCLIENT_LL_07_011: [ If 'IoTHubTransport_ProcessItem' returns IOTHUB_PROCESS_OK IoTHubClientCore_LL_DoWork shall add the IOTHUB_DEVICE_TWIN to the ack queue. ]*/
-                    DList_InsertTailList(&(iotHubClientHandle->iot_ack_queue), &(queue_data->entry));
-                }
-                else
-                {
-                    /*Codes_SRS_IOTHUBCLIENT_LL_07_012: [ If 'IoTHubTransport_ProcessItem' returns any other value IoTHubClientCore_LL_DoWork shall destroy the IOTHUB_DEVICE_TWIN item. ]*/
-                    LogError("Failure queue processing item");
-                    device_twin_data_destroy(queue_data);
-                }
+                result = IOTHUB_CLIENT_OK;
             }
-            // Move along to the next item
-            client_item = next_item;
         }
-        (void)printf("IoTHubClient_LL_DoWork exit loop.\r\n");
+        else
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_01_029: [ Otherwise next_call_in_ms shall be DOWORK_DEFAULT_INTERVAL_MS, or 0 if messages are waiting to be sent. ]*/
+            handleData->IoTHubTransport_DoWork(handleData->transportHandle);
+            *next_call_in_ms = DList_IsListEmpty(&(handleData->waitingToSend)) ? DOWORK_DEFAULT_INTERVAL_MS : 0;
+            result = IOTHUB_CLIENT_OK;
+        }
 
-        /*Codes_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClientCore_LL_DoWork shall invoke the underlaying layer's _DoWork function.]*/
-        handleData->IoTHubTransport_DoWork(handleData->transportHandle);
+        if (result == IOTHUB_CLIENT_OK)
+        {
+            lower_to_client_deadlines(handleData, next_call_in_ms);
+        }
     }
+
+    return result;
 }
 
 IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_GetSendStatus(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_STATUS *iotHubClientStatus)
@@ -2039,6 +2310,49 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_GetSendStatus(IOTHUB_CLIENT_CORE_LL_HAN
         /* Codes_SRS_IOTHUBCLIENT_09_008: [IoTHubClient_GetSendStatus shall return IOTHUB_CLIENT_OK and status IOTHUB_CLIENT_SEND_STATUS_IDLE if there is currently no items to be sent] */
         /* Codes_SRS_IOTHUBCLIENT_09_009: [IoTHubClient_GetSendStatus shall return IOTHUB_CLIENT_OK and status IOTHUB_CLIENT_SEND_STATUS_BUSY if there are currently items to be sent] */
         result = handleData->IoTHubTransport_GetSendStatus(handleData->deviceHandle, iotHubClientStatus);
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_012: [ Messages waiting in the telemetry batch shall make IoTHubClient_GetSendStatus report IOTHUB_CLIENT_SEND_STATUS_BUSY. ]*/
+        if ((result == IOTHUB_CLIENT_OK) && (handleData->telemetry_batch != NULL) && IoTHubClient_Batch_HasPending(handleData->telemetry_batch))
+        {
+            *iotHubClientStatus = IOTHUB_CLIENT_SEND_STATUS_BUSY;
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_022: [ Messages waiting in the persistent queue shall make IoTHubClient_GetSendStatus report IOTHUB_CLIENT_SEND_STATUS_BUSY. ]*/
+        else if ((result == IOTHUB_CLIENT_OK) && (handleData->persistent_queue != NULL) && IoTHubClient_PersistentQueue_HasStored(handleData->persistent_queue))
+        {
+            *iotHubClientStatus = IOTHUB_CLIENT_SEND_STATUS_BUSY;
+        }
+    }
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_GetSendStatistics(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_SEND_STATISTICS* statistics)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_013: [ If iotHubClientHandle or statistics is NULL, IoTHubClientCore_LL_GetSendStatistics shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (iotHubClientHandle == NULL || statistics == NULL)
+    {
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LOG_ERROR_RESULT;
+    }
+    else
+    {
+        IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)iotHubClientHandle;
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_014: [ IoTHubClientCore_LL_GetSendStatistics shall return the confirmed message counts, and the traffic counters filled in by the underlaying layer's _GetTrafficStatistics function when the transport has one, 0 otherwise. ]*/
+        *statistics = handleData->send_statistics;
+        if ((handleData->IoTHubTransport_GetTrafficStatistics != NULL) &&
+            (handleData->IoTHubTransport_GetTrafficStatistics(handleData->transportHandle, statistics) != 0))
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_01_015: [ If _GetTrafficStatistics fails, IoTHubClientCore_LL_GetSendStatistics shall return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("unable to get the transport traffic statistics");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_CLIENT_OK;
+        }
     }
 
     return result;
@@ -2205,6 +2519,49 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SetOption(IOTHUB_CLIENT_CORE_LL_HANDLE
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        else if (strcmp(optionName, OPTION_TELEMETRY_BATCHING) == 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_01_009: [ "telemetry_batching" - value is a pointer to an IOTHUB_CLIENT_BATCHING_OPTIONS; a max_messages less than 2 turns batching off, otherwise IoTHubClientCore_LL_SetOption shall create a batch with IoTHubClient_Batch_Create. ]*/
+            const IOTHUB_CLIENT_BATCHING_OPTIONS* batching = (const IOTHUB_CLIENT_BATCHING_OPTIONS*)value;
+            IOTHUB_CLIENT_BATCH_HANDLE new_batch = NULL;
+            if ((batching->max_messages >= 2) && ((new_batch = IoTHubClient_Batch_Create(batching)) == NULL))
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_01_010: [ If IoTHubClient_Batch_Create fails, IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_ERROR and keep the current batching. ]*/
+                LogError("unable to create the telemetry batch");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_01_011: [ Messages waiting in the previous batch shall be moved to waitingToSend before it is destroyed. ]*/
+                if (handleData->telemetry_batch != NULL)
+                {
+                    flush_telemetry_batch(handleData);
+                    IoTHubClient_Batch_Destroy(handleData->telemetry_batch);
+                }
+                handleData->telemetry_batch = new_batch;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_PERSISTENT_QUEUE) == 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_01_023: [ "persistent_queue" - value is a pointer to an IOTHUB_CLIENT_PERSISTENCE_OPTIONS; IoTHubClientCore_LL_SetOption shall create the persistent queue with IoTHubClient_PersistentQueue_Create, which picks up the messages stored before a restart. ]*/
+            if (handleData->persistent_queue != NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_01_024: [ If the persistent queue is already set, IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
+                LogError("the persistent queue can only be set once");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else if ((handleData->persistent_queue = IoTHubClient_PersistentQueue_Create((const IOTHUB_CLIENT_PERSISTENCE_OPTIONS*)value)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_01_025: [ If IoTHubClient_PersistentQueue_Create fails, IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
+                LogError("unable to create the persistent queue");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         else if (strcmp(optionName, OPTION_DIAGNOSTIC_SAMPLING_PERCENTAGE) == 0)
         {
             uint32_t percentage = *(uint32_t*)value;
@@ -2600,6 +2957,28 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_UploadMultipleBlocksToBlobEx(IOTHUB_CLI
     }
     return result;
 }
+
+IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_UploadStreamToBlob(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS* options, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK readCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_041: [ If iotHubClientHandle, destinationFileName, options or readCallback is NULL then IoTHubClientCore_LL_UploadStreamToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (options == NULL) ||
+        (readCallback == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle=%p, destinationFileName=%p, options=%p, readCallback=%p", iotHubClientHandle, destinationFileName, options, readCallback);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_01_042: [ IoTHubClientCore_LL_UploadStreamToBlob shall call IoTHubClient_LL_UploadStreamToBlob_Impl and return its result. ]*/
+        result = IoTHubClient_LL_UploadStreamToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, options, readCallback, context);
+    }
+    return result;
+}
 #endif // DONT_USE_UPLOADTOBLOB
 
 IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SendEventToOutputAsync(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, const char* outputName, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
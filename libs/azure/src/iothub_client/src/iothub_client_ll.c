@@ -61,6 +61,11 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetSendStatus(IOTHUB_CLIENT_LL_HANDLE iotHu
     return IoTHubClientCore_LL_GetSendStatus((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, iotHubClientStatus);
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetSendStatistics(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_SEND_STATISTICS* statistics)
+{
+    return IoTHubClientCore_LL_GetSendStatistics((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, statistics);
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetMessageCallback(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC messageCallback, void* userContextCallback)
 {
     return IoTHubClientCore_LL_SetMessageCallback((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, messageCallback, userContextCallback);
@@ -91,6 +96,11 @@ void IoTHubClient_LL_DoWork(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
     IoTHubClientCore_LL_DoWork((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle);
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_DoWorkWithBudget(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const IOTHUB_CLIENT_DOWORK_BUDGET* budget, uint32_t* next_call_in_ms)
+{
+    return IoTHubClientCore_LL_DoWorkWithBudget((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, budget, next_call_in_ms);
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetDeviceTwinCallback(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK deviceTwinCallback, void* userContextCallback)
 {
     return IoTHubClientCore_LL_SetDeviceTwinCallback((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, deviceTwinCallback, userContextCallback);
@@ -136,6 +146,11 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlobEx(IOTHUB_CLIENT_
 {
     return IoTHubClientCore_LL_UploadMultipleBlocksToBlobEx((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, destinationFileName, getDataCallbackEx, context);
 }
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadStreamToBlob(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS* options, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK readCallback, void* context)
+{
+    return IoTHubClientCore_LL_UploadStreamToBlob((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, destinationFileName, options, readCallback, context);
+}
 #endif
 
 
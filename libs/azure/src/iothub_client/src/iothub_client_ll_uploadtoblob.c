@@ -5,6 +5,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/string_tokenizer.h"
@@ -1091,6 +1092,433 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTO
     return result;
 }
 
+#define UPLOAD_STATE_MAGIC          0x5355
+#define UPLOAD_STATE_HEADER_SIZE    12
+#define UPLOAD_STATE_PROGRESS_SIZE  8
+#define UPLOAD_STATE_MAX_STRING     0xFFFF
+
+/*the state file holds a header with the block size and the lengths of the destination file name, correlationId and
+  SAS URI, the 3 strings, then the count of uploaded blocks and its complement, which is rewritten after every block*/
+typedef struct UPLOAD_STREAM_STATE_TAG
+{
+    const FILE_STORE_INTERFACE_DESCRIPTION* file_store;
+    FILE_STORE_HANDLE file;
+    uint32_t progress_offset;
+} UPLOAD_STREAM_STATE;
+
+static void put_uint16(unsigned char* destination, size_t value)
+{
+    destination[0] = (unsigned char)(value >> 8);
+    destination[1] = (unsigned char)(value & 0xFF);
+}
+
+static void put_uint32(unsigned char* destination, uint32_t value)
+{
+    destination[0] = (unsigned char)(value >> 24);
+    destination[1] = (unsigned char)((value >> 16) & 0xFF);
+    destination[2] = (unsigned char)((value >> 8) & 0xFF);
+    destination[3] = (unsigned char)(value & 0xFF);
+}
+
+static size_t get_uint16(const unsigned char* source)
+{
+    return ((size_t)source[0] << 8) | source[1];
+}
+
+static uint32_t get_uint32(const unsigned char* source)
+{
+    return ((uint32_t)source[0] << 24) | ((uint32_t)source[1] << 16) | ((uint32_t)source[2] << 8) | source[3];
+}
+
+static int write_upload_progress(UPLOAD_STREAM_STATE* state, unsigned int blockCount)
+{
+    int result;
+    unsigned char progress[UPLOAD_STATE_PROGRESS_SIZE];
+
+    put_uint32(progress, (uint32_t)blockCount);
+    put_uint32(progress + 4, ~(uint32_t)blockCount);
+    if ((state->file_store->concrete_file_write(state->file, state->progress_offset, progress, sizeof(progress)) != 0) ||
+        (state->file_store->concrete_file_flush(state->file) != 0))
+    {
+        LogError("unable to save the count of uploaded blocks");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static void on_stream_block_uploaded(unsigned int blockCount, void* context)
+{
+    /*a count that is not saved only means that a resumed upload sends some blocks again*/
+    (void)write_upload_progress((UPLOAD_STREAM_STATE*)context, blockCount);
+}
+
+/*returns 0 when the state file holds an upload of destinationFileName with the same block size, which is then loaded*/
+static int load_upload_state(UPLOAD_STREAM_STATE* state, size_t blockSize, const char* destinationFileName, STRING_HANDLE correlationId, STRING_HANDLE sasUri, unsigned int* blockCount)
+{
+    int result;
+    unsigned char header[UPLOAD_STATE_HEADER_SIZE];
+    size_t bytesRead;
+
+    if ((state->file_store->concrete_file_read(state->file, 0, header, sizeof(header), &bytesRead) != 0) ||
+        (bytesRead != sizeof(header)) ||
+        (get_uint16(header) != UPLOAD_STATE_MAGIC) ||
+        (get_uint32(header + 2) != (uint32_t)blockSize) ||
+        (get_uint16(header + 6) != strlen(destinationFileName)))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t nameLength = get_uint16(header + 6);
+        size_t correlationIdLength = get_uint16(header + 8);
+        size_t sasUriLength = get_uint16(header + 10);
+        size_t stringsLength = nameLength + correlationIdLength + sasUriLength;
+        unsigned char* strings = (unsigned char*)malloc(stringsLength + UPLOAD_STATE_PROGRESS_SIZE);
+        if (strings == NULL)
+        {
+            LogError("unable to malloc");
+            result = __FAILURE__;
+        }
+        else
+        {
+            const unsigned char* progress = strings + stringsLength;
+            if ((state->file_store->concrete_file_read(state->file, UPLOAD_STATE_HEADER_SIZE, strings, stringsLength + UPLOAD_STATE_PROGRESS_SIZE, &bytesRead) != 0) ||
+                (bytesRead != stringsLength + UPLOAD_STATE_PROGRESS_SIZE) ||
+                (memcmp(strings, destinationFileName, nameLength) != 0) ||
+                (get_uint32(progress) != ~get_uint32(progress + 4)))
+            {
+                result = __FAILURE__;
+            }
+            else if ((STRING_copy_n(correlationId, (const char*)strings + nameLength, correlationIdLength) != 0) ||
+                (STRING_copy_n(sasUri, (const char*)strings + nameLength + correlationIdLength, sasUriLength) != 0))
+            {
+                LogError("unable to STRING_copy_n");
+                result = __FAILURE__;
+            }
+            else
+            {
+                state->progress_offset = (uint32_t)(UPLOAD_STATE_HEADER_SIZE + stringsLength);
+                *blockCount = (unsigned int)get_uint32(progress);
+                result = 0;
+            }
+            free(strings);
+        }
+    }
+    return result;
+}
+
+static int save_upload_state(UPLOAD_STREAM_STATE* state, size_t blockSize, const char* destinationFileName, STRING_HANDLE correlationId, STRING_HANDLE sasUri)
+{
+    int result;
+    size_t nameLength = strlen(destinationFileName);
+    size_t correlationIdLength = STRING_length(correlationId);
+    size_t sasUriLength = STRING_length(sasUri);
+
+    if ((nameLength > UPLOAD_STATE_MAX_STRING) || (correlationIdLength > UPLOAD_STATE_MAX_STRING) || (sasUriLength > UPLOAD_STATE_MAX_STRING))
+    {
+        LogError("upload too long to be saved");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t stringsLength = nameLength + correlationIdLength + sasUriLength;
+        unsigned char* record = (unsigned char*)malloc(UPLOAD_STATE_HEADER_SIZE + stringsLength + UPLOAD_STATE_PROGRESS_SIZE);
+        if (record == NULL)
+        {
+            LogError("unable to malloc");
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned char* strings = record + UPLOAD_STATE_HEADER_SIZE;
+            put_uint16(record, UPLOAD_STATE_MAGIC);
+            put_uint32(record + 2, (uint32_t)blockSize);
+            put_uint16(record + 6, nameLength);
+            put_uint16(record + 8, correlationIdLength);
+            put_uint16(record + 10, sasUriLength);
+            (void)memcpy(strings, destinationFileName, nameLength);
+            (void)memcpy(strings + nameLength, STRING_c_str(correlationId), correlationIdLength);
+            (void)memcpy(strings + nameLength + correlationIdLength, STRING_c_str(sasUri), sasUriLength);
+            put_uint32(strings + stringsLength, 0);
+            put_uint32(strings + stringsLength + 4, ~(uint32_t)0);
+
+            if ((state->file_store->concrete_file_write(state->file, 0, record, UPLOAD_STATE_HEADER_SIZE + stringsLength + UPLOAD_STATE_PROGRESS_SIZE) != 0) ||
+                (state->file_store->concrete_file_flush(state->file) != 0))
+            {
+                LogError("unable to save the upload state");
+                result = __FAILURE__;
+            }
+            else
+            {
+                state->progress_offset = (uint32_t)(UPLOAD_STATE_HEADER_SIZE + stringsLength);
+                result = 0;
+            }
+            free(record);
+        }
+    }
+    return result;
+}
+
+static void close_upload_state(UPLOAD_STREAM_STATE* state, const char* path, bool removeFile)
+{
+    if (state->file != NULL)
+    {
+        state->file_store->concrete_file_close(state->file);
+        state->file = NULL;
+        if (removeFile && (state->file_store->concrete_file_remove(path) != 0))
+        {
+            LogError("unable to remove %s", path);
+        }
+    }
+}
+
+/*builds the headers that step 1 builds, for the notification of an upload that resumes without step 1*/
+static int add_request_headers(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    int result;
+    if (!(
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Content-Type", "application/json") == HTTP_HEADERS_OK) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Accept", "application/json") == HTTP_HEADERS_OK) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "User-Agent", "iothubclient/" IOTHUB_SDK_VERSION) == HTTP_HEADERS_OK) &&
+        (handleData->authorizationScheme == X509 || (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Authorization", "") == HTTP_HEADERS_OK)) &&
+        (handleData->authorizationScheme != SAS_TOKEN || (HTTPHeaders_ReplaceHeaderNameValuePair(requestHttpHeaders, "Authorization", STRING_c_str(handleData->credentials.sas)) == HTTP_HEADERS_OK))
+        ))
+    {
+        LogError("unable to HTTPHeaders_AddHeaderNameValuePair");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*creates the HTTPAPIEX_HANDLE to the IoTHub with the saved options, as IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl does*/
+static HTTPAPIEX_HANDLE create_iothub_http_handle(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    HTTPAPIEX_HANDLE result = HTTPAPIEX_Create(handleData->hostname);
+    if (result == NULL)
+    {
+        LogError("unable to HTTPAPIEX_Create");
+    }
+    else
+    {
+        if (handleData->curl_verbosity_level != UPOADTOBLOB_CURL_VERBOSITY_UNSET)
+        {
+            size_t curl_verbose = (handleData->curl_verbosity_level == UPOADTOBLOB_CURL_VERBOSITY_ON);
+            (void)HTTPAPIEX_SetOption(result, OPTION_CURL_VERBOSE, &curl_verbose);
+        }
+
+        if (set_transfer_timeout(handleData, result) != HTTPAPIEX_OK)
+        {
+            LogError("unable to set blob transfer timeout");
+            HTTPAPIEX_Destroy(result);
+            result = NULL;
+        }
+        else if ((handleData->authorizationScheme == X509) &&
+            (!(
+                (HTTPAPIEX_SetOption(result, OPTION_X509_CERT, handleData->credentials.x509credentials.x509certificate) == HTTPAPIEX_OK) &&
+                (HTTPAPIEX_SetOption(result, OPTION_X509_PRIVATE_KEY, handleData->credentials.x509credentials.x509privatekey) == HTTPAPIEX_OK)
+            )))
+        {
+            LogError("unable to HTTPAPIEX_SetOption for x509");
+            HTTPAPIEX_Destroy(result);
+            result = NULL;
+        }
+        else if ((handleData->certificates != NULL) && (HTTPAPIEX_SetOption(result, "TrustedCerts", handleData->certificates) != HTTPAPIEX_OK))
+        {
+            LogError("unable to set TrustedCerts!");
+            HTTPAPIEX_Destroy(result);
+            result = NULL;
+        }
+        else if ((handleData->http_proxy_options.host_address != NULL) && (HTTPAPIEX_SetOption(result, OPTION_HTTP_PROXY, &handleData->http_proxy_options) != HTTPAPIEX_OK))
+        {
+            LogError("unable to set http proxy!");
+            HTTPAPIEX_Destroy(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+static int notify_stream_upload_result(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, STRING_HANDLE correlationId, HTTPAPIEX_HANDLE iotHubHttpApiExHandle, HTTP_HEADERS_HANDLE requestHttpHeaders, BUFFER_HANDLE messageBody, BLOB_RESULT blobResult, unsigned int httpStatus)
+{
+    int result;
+    char body[128];
+    int bodyLength;
+
+    if (blobResult == BLOB_ABORTED)
+    {
+        bodyLength = snprintf(body, sizeof(body), "%s", FILE_UPLOAD_ABORTED_BODY);
+    }
+    else if (blobResult != BLOB_OK)
+    {
+        bodyLength = snprintf(body, sizeof(body), "%s", FILE_UPLOAD_FAILED_BODY);
+    }
+    else
+    {
+        bodyLength = snprintf(body, sizeof(body), "{\"isSuccess\":%s, \"statusCode\":%u, \"statusDescription\":\"\"}", ((httpStatus < 300) ? "true" : "false"), httpStatus);
+    }
+
+    if ((bodyLength <= 0) || ((size_t)bodyLength >= sizeof(body)) || (BUFFER_build(messageBody, (const unsigned char*)body, (size_t)bodyLength) != 0))
+    {
+        LogError("unable to build the notification");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, messageBody);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadStreamToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, const IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS* options, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK readCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_01_033: [ If handle, destinationFileName, options or readCallback is NULL, if options->block_size is 0 or bigger than 4MB, or if options->file_store is set without options->state_path, IoTHubClient_LL_UploadStreamToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (destinationFileName == NULL) ||
+        (options == NULL) ||
+        (readCallback == NULL) ||
+        (options->block_size == 0) ||
+        (options->block_size > BLOCK_SIZE) ||
+        ((options->file_store != NULL) && (options->state_path == NULL))
+        )
+    {
+        LogError("invalid argument detected handle=%p destinationFileName=%p options=%p readCallback=%p", handle, destinationFileName, options, readCallback);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        HTTPAPIEX_HANDLE iotHubHttpApiExHandle = create_iothub_http_handle(handleData);
+        if (iotHubHttpApiExHandle == NULL)
+        {
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            STRING_HANDLE correlationId = STRING_new();
+            STRING_HANDLE sasUri = STRING_new();
+            HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc();
+            BUFFER_HANDLE responseToIoTHub = BUFFER_new();
+
+            if ((correlationId == NULL) || (sasUri == NULL) || (requestHttpHeaders == NULL) || (responseToIoTHub == NULL))
+            {
+                LogError("unable to allocate the upload");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                UPLOAD_STREAM_STATE state;
+                unsigned int blockCount = 0;
+                int isResumed = 0;
+                int isReady;
+
+                state.file_store = options->file_store;
+                state.file = NULL;
+                state.progress_offset = 0;
+
+                if (state.file_store != NULL)
+                {
+                    state.file = state.file_store->concrete_file_open(options->state_path);
+                    if (state.file == NULL)
+                    {
+                        LogError("unable to open %s, the upload will not be resumable", options->state_path);
+                    }
+                    /*Codes_SRS_IOTHUBCLIENT_LL_01_034: [ If options->state_path holds an upload of destinationFileName with the same block size, IoTHubClient_LL_UploadStreamToBlob shall resume it with its correlationId, SAS URI and count of uploaded blocks, without asking the IoTHub for a new SAS URI. ]*/
+                    else if (load_upload_state(&state, options->block_size, destinationFileName, correlationId, sasUri, &blockCount) == 0)
+                    {
+                        LogInfo("resuming the upload of %s after %u blocks", destinationFileName, blockCount);
+                        isResumed = 1;
+                    }
+                }
+
+                if (isResumed)
+                {
+                    isReady = (add_request_headers(handleData, requestHttpHeaders) == 0);
+                }
+                /*Codes_SRS_IOTHUBCLIENT_LL_01_035: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall get the correlationId and the SAS URI from the IoTHub as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, and save them to options->state_path when options->file_store is not NULL. ]*/
+                else if (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) != 0)
+                {
+                    LogError("error in IoTHubClient_LL_UploadToBlob_step1");
+                    isReady = 0;
+                }
+                else
+                {
+                    if ((state.file != NULL) && (save_upload_state(&state, options->block_size, destinationFileName, correlationId, sasUri) != 0))
+                    {
+                        /*the upload goes on, it only cannot be resumed*/
+                        close_upload_state(&state, options->state_path, false);
+                    }
+                    isReady = 1;
+                }
+
+                if (!isReady)
+                {
+                    close_upload_state(&state, options->state_path, false);
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    unsigned int httpStatus = 0;
+                    /*Codes_SRS_IOTHUBCLIENT_LL_01_036: [ IoTHubClient_LL_UploadStreamToBlob shall call Blob_UploadStreamFromSasUri with the block size, the retries, readCallback and the count of uploaded blocks, saving the count after every block when the upload is saved. ]*/
+                    BLOB_RESULT blobResult = Blob_UploadStreamFromSasUri(STRING_c_str(sasUri), options->block_size, options->max_block_retries, readCallback, context, &blockCount,
+                        (state.file == NULL) ? NULL : on_stream_block_uploaded, &state, &httpStatus, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options));
+
+                    if ((state.file != NULL) && ((blobResult == BLOB_HTTP_ERROR) || ((blobResult == BLOB_OK) && (httpStatus >= 500))))
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_01_037: [ If the upload is saved and storage could not be reached or answered with a 5xx status, IoTHubClient_LL_UploadStreamToBlob shall keep the saved upload, not notify the IoTHub, and return IOTHUB_CLIENT_ERROR. ]*/
+                        LogError("upload of %s interrupted after %u blocks, it resumes on the next call", destinationFileName, blockCount);
+                        close_upload_state(&state, options->state_path, false);
+                        result = IOTHUB_CLIENT_ERROR;
+                    }
+                    /*Codes_SRS_IOTHUBCLIENT_LL_01_038: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall notify the IoTHub of the result as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does. ]*/
+                    else if (notify_stream_upload_result(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub, blobResult, httpStatus) != 0)
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_01_039: [ If the notification of a blob that was committed fails, the saved upload shall be kept so that the next call commits and notifies it again. ]*/
+                        LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
+                        close_upload_state(&state, options->state_path, !((blobResult == BLOB_OK) && (httpStatus < 300)));
+                        result = IOTHUB_CLIENT_ERROR;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_01_040: [ Once the IoTHub is notified, IoTHubClient_LL_UploadStreamToBlob shall remove options->state_path and return IOTHUB_CLIENT_OK if the upload succeeded or was aborted, IOTHUB_CLIENT_ERROR otherwise. ]*/
+                        close_upload_state(&state, options->state_path, true);
+                        result = ((blobResult == BLOB_ABORTED) || ((blobResult == BLOB_OK) && (httpStatus < 300))) ? IOTHUB_CLIENT_OK : IOTHUB_CLIENT_ERROR;
+                    }
+                }
+            }
+
+            if (responseToIoTHub != NULL)
+            {
+                BUFFER_delete(responseToIoTHub);
+            }
+            if (requestHttpHeaders != NULL)
+            {
+                HTTPHeaders_Free(requestHttpHeaders);
+            }
+            if (sasUri != NULL)
+            {
+                STRING_delete(sasUri);
+            }
+            if (correlationId != NULL)
+            {
+                STRING_delete(correlationId);
+            }
+            HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
+        }
+    }
+    return result;
+}
+
 void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle)
 {
     if (handle == NULL)
@@ -0,0 +1,1018 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/map.h"
+
+#include "internal/iothub_client_persistent_queue.h"
+
+/* The log is a file of pages. A page holds whole records followed by zero padding, and is always
+   written whole, so a flash file system only sees page sized writes. A record is
+       magic (2) | body length (2) | sequence (4) | crc32 of sequence and body (4) | body
+   and sequences grow by one from record to record. A body is a message, or a confirmation that
+   every message up to a sequence reached the hub. */
+#define RECORD_MAGIC                0x5051
+#define RECORD_HEADER_SIZE          12
+#define RECORD_TYPE_MESSAGE         1
+#define RECORD_TYPE_CONFIRMATION    2
+#define CONFIRMATION_BODY_SIZE      5
+#define CONFIRMATION_RECORD_SIZE    (RECORD_HEADER_SIZE + CONFIRMATION_BODY_SIZE)
+#define FIELD_HEADER_SIZE           3
+
+#define FIELD_BYTE_ARRAY            1
+#define FIELD_STRING                2
+#define FIELD_MESSAGE_ID            3
+#define FIELD_CORRELATION_ID        4
+#define FIELD_CONTENT_TYPE          5
+#define FIELD_CONTENT_ENCODING      6
+#define FIELD_OUTPUT_NAME           7
+#define FIELD_PROPERTY_KEY          8
+#define FIELD_PROPERTY_VALUE        9
+
+#define MIN_PAGE_SIZE               64
+#define MAX_PAGE_SIZE               32768
+#define COMPACTION_SUFFIX           ".tmp"
+
+/* replayed messages the queue waits for at a time; a confirmation moves the head past them in order */
+#define REPLAY_WINDOW               4
+#define NO_PAGE                     UINT32_MAX
+
+typedef enum REPLAY_SLOT_STATE_TAG
+{
+    REPLAY_SLOT_IN_FLIGHT,
+    REPLAY_SLOT_CONFIRMED,
+    REPLAY_SLOT_FAILED
+} REPLAY_SLOT_STATE;
+
+typedef struct REPLAY_SLOT_TAG
+{
+    struct IOTHUB_CLIENT_PERSISTENT_QUEUE_TAG* queue;
+    uint32_t sequence;
+    uint32_t next_offset;
+    REPLAY_SLOT_STATE state;
+} REPLAY_SLOT;
+
+typedef struct IOTHUB_CLIENT_PERSISTENT_QUEUE_TAG
+{
+    const FILE_STORE_INTERFACE_DESCRIPTION* file_store;
+    char* path;
+    char* compaction_path;
+    FILE_STORE_HANDLE file;
+    size_t page_size;
+    uint32_t max_pages;
+    uint32_t max_replay_rate;
+    IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK replay_callback;
+    void* replay_context;
+
+    /* the last page of the log, where records are appended */
+    unsigned char* write_page;
+    uint32_t write_page_index;
+    size_t write_position;
+    bool write_page_dirty;
+
+    /* the page the replay reads from, when it is not the last one */
+    unsigned char* read_page;
+    uint32_t read_page_index;
+    size_t read_page_size;
+
+    uint32_t next_sequence;
+    uint32_t last_message_sequence;
+    uint32_t confirmed_sequence;
+    bool confirmation_dirty;
+
+    /* no unconfirmed message is stored before head_offset */
+    uint32_t head_offset;
+    uint32_t read_offset;
+
+    REPLAY_SLOT slots[REPLAY_WINDOW];
+    size_t first_slot;
+    size_t slot_count;
+    bool rewind;
+    bool has_replayed;
+    tickcounter_ms_t last_replay_ms;
+} IOTHUB_CLIENT_PERSISTENT_QUEUE;
+
+static void on_replayed_message_complete(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* context);
+
+static const uint32_t crc32_nibble_table[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char* buffer, size_t size)
+{
+    size_t index;
+    for (index = 0; index < size; index++)
+    {
+        crc = crc32_nibble_table[(crc ^ buffer[index]) & 0x0F] ^ (crc >> 4);
+        crc = crc32_nibble_table[(crc ^ (buffer[index] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return crc;
+}
+
+static void put_uint16(unsigned char* destination, size_t value)
+{
+    destination[0] = (unsigned char)(value >> 8);
+    destination[1] = (unsigned char)(value & 0xFF);
+}
+
+static void put_uint32(unsigned char* destination, uint32_t value)
+{
+    destination[0] = (unsigned char)(value >> 24);
+    destination[1] = (unsigned char)((value >> 16) & 0xFF);
+    destination[2] = (unsigned char)((value >> 8) & 0xFF);
+    destination[3] = (unsigned char)(value & 0xFF);
+}
+
+static size_t get_uint16(const unsigned char* source)
+{
+    return ((size_t)source[0] << 8) | source[1];
+}
+
+static uint32_t get_uint32(const unsigned char* source)
+{
+    return ((uint32_t)source[0] << 24) | ((uint32_t)source[1] << 16) | ((uint32_t)source[2] << 8) | source[3];
+}
+
+static uint32_t get_record_crc(const unsigned char* record, size_t body_size)
+{
+    uint32_t crc = crc32_update(0xFFFFFFFF, record + 4, 4);
+    return ~crc32_update(crc, record + RECORD_HEADER_SIZE, body_size);
+}
+
+/* checks the record at position of a page holding size valid bytes; returns its body size, or -1 if there is none */
+static int check_record(const unsigned char* page, size_t size, size_t position)
+{
+    int result;
+    if ((position + RECORD_HEADER_SIZE > size) || (get_uint16(page + position) != RECORD_MAGIC))
+    {
+        result = -1;
+    }
+    else
+    {
+        size_t body_size = get_uint16(page + position + 2);
+        if ((body_size == 0) ||
+            (position + RECORD_HEADER_SIZE + body_size > size) ||
+            (get_record_crc(page + position, body_size) != get_uint32(page + position + 8)))
+        {
+            result = -1;
+        }
+        else
+        {
+            result = (int)body_size;
+        }
+    }
+    return result;
+}
+
+static size_t get_field_size(const char* value)
+{
+    return (value == NULL) ? 0 : FIELD_HEADER_SIZE + strlen(value) + 1;
+}
+
+static unsigned char* put_field(unsigned char* destination, unsigned char tag, const void* value, size_t size)
+{
+    destination[0] = tag;
+    put_uint16(destination + 1, size);
+    (void)memcpy(destination + FIELD_HEADER_SIZE, value, size);
+    return destination + FIELD_HEADER_SIZE + size;
+}
+
+static unsigned char* put_string_field(unsigned char* destination, unsigned char tag, const char* value)
+{
+    /* strings keep their '\0' so that the replay can hand them out of the page */
+    return (value == NULL) ? destination : put_field(destination, tag, value, strlen(value) + 1);
+}
+
+static int write_page_to_file(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    int result;
+    if (queue->file_store->concrete_file_write(queue->file, (uint32_t)(queue->write_page_index * queue->page_size), queue->write_page, queue->page_size) != 0)
+    {
+        LogError("Failure writing page %lu of the persistent queue", (unsigned long)queue->write_page_index);
+        result = __FAILURE__;
+    }
+    else
+    {
+        queue->write_page_dirty = false;
+        result = 0;
+    }
+    return result;
+}
+
+static void start_empty_log(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    queue->write_page_index = 0;
+    queue->write_position = 0;
+    queue->write_page_dirty = false;
+    (void)memset(queue->write_page, 0, queue->page_size);
+    queue->read_page_index = NO_PAGE;
+    queue->head_offset = 0;
+    queue->read_offset = 0;
+    queue->confirmation_dirty = false;
+}
+
+/* drops the pages before the one holding head_offset by copying the rest of the log to a new file */
+static int compact_log(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    int result;
+    uint32_t head_page = (uint32_t)(queue->head_offset / queue->page_size);
+
+    if (head_page == 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        const FILE_STORE_INTERFACE_DESCRIPTION* file_store = queue->file_store;
+        FILE_STORE_HANDLE compacted;
+
+        if ((file_store->concrete_file_exists(queue->compaction_path)) && (file_store->concrete_file_remove(queue->compaction_path) != 0))
+        {
+            LogError("Failure removing %s", queue->compaction_path);
+            result = __FAILURE__;
+        }
+        else if ((compacted = file_store->concrete_file_open(queue->compaction_path)) == NULL)
+        {
+            LogError("Failure opening %s", queue->compaction_path);
+            result = __FAILURE__;
+        }
+        else
+        {
+            uint32_t page;
+            size_t bytes_read;
+            uint32_t shift = (uint32_t)(head_page * queue->page_size);
+            size_t index;
+
+            result = 0;
+            for (page = head_page; (page < queue->write_page_index) && (result == 0); page++)
+            {
+                if ((file_store->concrete_file_read(queue->file, (uint32_t)(page * queue->page_size), queue->read_page, queue->page_size, &bytes_read) != 0) ||
+                    (bytes_read != queue->page_size) ||
+                    (file_store->concrete_file_write(compacted, (uint32_t)((page - head_page) * queue->page_size), queue->read_page, queue->page_size) != 0))
+                {
+                    LogError("Failure copying page %lu of the persistent queue", (unsigned long)page);
+                    result = __FAILURE__;
+                }
+            }
+            queue->read_page_index = NO_PAGE;
+
+            if ((result != 0) ||
+                (file_store->concrete_file_write(compacted, (uint32_t)((queue->write_page_index - head_page) * queue->page_size), queue->write_page, queue->page_size) != 0) ||
+                (file_store->concrete_file_flush(compacted) != 0))
+            {
+                file_store->concrete_file_close(compacted);
+                (void)file_store->concrete_file_remove(queue->compaction_path);
+                LogError("Failure compacting the persistent queue");
+                result = __FAILURE__;
+            }
+            else
+            {
+                file_store->concrete_file_close(compacted);
+                file_store->concrete_file_close(queue->file);
+
+                if (file_store->concrete_file_remove(queue->path) != 0)
+                {
+                    /* the log is untouched, keep on using it */
+                    LogError("Failure removing %s", queue->path);
+                    (void)file_store->concrete_file_remove(queue->compaction_path);
+                    queue->file = file_store->concrete_file_open(queue->path);
+                    result = __FAILURE__;
+                }
+                else if (file_store->concrete_file_rename(queue->compaction_path, queue->path) != 0)
+                {
+                    /* IoTHubClient_PersistentQueue_Create picks up the copy after a restart, as after a reboot between the remove and the rename */
+                    LogError("Failure renaming %s, the persistent queue stops", queue->compaction_path);
+                    queue->file = NULL;
+                    result = __FAILURE__;
+                }
+                else if ((queue->file = file_store->concrete_file_open(queue->path)) == NULL)
+                {
+                    LogError("Failure reopening %s, the persistent queue stops", queue->path);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    queue->write_page_index -= head_page;
+                    queue->write_page_dirty = false;
+                    queue->head_offset -= shift;
+                    queue->read_offset -= shift;
+                    for (index = 0; index < queue->slot_count; index++)
+                    {
+                        queue->slots[(queue->first_slot + index) % REPLAY_WINDOW].next_offset -= shift;
+                    }
+                    /* the confirmation records may have been on the dropped pages */
+                    queue->confirmation_dirty = (queue->confirmed_sequence != 0);
+                    result = 0;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/* makes room for a record of record_size bytes at write_position */
+static int reserve_record(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue, size_t record_size)
+{
+    int result;
+    if (queue->file == NULL)
+    {
+        result = __FAILURE__;
+    }
+    else if (queue->write_position + record_size <= queue->page_size)
+    {
+        result = 0;
+    }
+    else if ((queue->write_page_index + 1 >= queue->max_pages) && (compact_log(queue) != 0))
+    {
+        LogError("The persistent queue is full");
+        result = __FAILURE__;
+    }
+    else if ((queue->write_page_index + 1 >= queue->max_pages) || (write_page_to_file(queue) != 0))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        queue->write_page_index++;
+        queue->write_position = 0;
+        (void)memset(queue->write_page, 0, queue->page_size);
+        result = 0;
+    }
+    return result;
+}
+
+static void commit_record(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue, size_t body_size)
+{
+    unsigned char* record = queue->write_page + queue->write_position;
+    put_uint16(record, RECORD_MAGIC);
+    put_uint16(record + 2, body_size);
+    put_uint32(record + 4, queue->next_sequence);
+    put_uint32(record + 8, get_record_crc(record, body_size));
+    queue->write_position += RECORD_HEADER_SIZE + body_size;
+    queue->write_page_dirty = true;
+    queue->next_sequence++;
+}
+
+static int append_confirmation(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    int result;
+    if (reserve_record(queue, CONFIRMATION_RECORD_SIZE) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        unsigned char* body = queue->write_page + queue->write_position + RECORD_HEADER_SIZE;
+        body[0] = RECORD_TYPE_CONFIRMATION;
+        put_uint32(body + 1, queue->confirmed_sequence);
+        commit_record(queue, CONFIRMATION_BODY_SIZE);
+        queue->confirmation_dirty = false;
+        result = 0;
+    }
+    return result;
+}
+
+/* finds the last record of the log, and the last confirmation, after a restart */
+static void recover_log(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    uint32_t page;
+    size_t bytes_read;
+    bool end_of_log = false;
+    bool has_records = false;
+    uint32_t tail_page = 0;
+    size_t tail_position = 0;
+    uint32_t expected_sequence = 0;
+
+    for (page = 0; (page < queue->max_pages) && !end_of_log; page++)
+    {
+        size_t position = 0;
+        int body_size;
+
+        if ((queue->file_store->concrete_file_read(queue->file, (uint32_t)(page * queue->page_size), queue->read_page, queue->page_size, &bytes_read) != 0) ||
+            ((body_size = check_record(queue->read_page, bytes_read, 0)) < 0))
+        {
+            /* pages are only started for a record, so a page without one is past the end */
+            end_of_log = true;
+        }
+        else
+        {
+            do
+            {
+                const unsigned char* record = queue->read_page + position;
+                const unsigned char* body = record + RECORD_HEADER_SIZE;
+                uint32_t sequence = get_uint32(record + 4);
+
+                if ((expected_sequence != 0) && (sequence != expected_sequence))
+                {
+                    end_of_log = true;
+                }
+                else
+                {
+                    if (body[0] == RECORD_TYPE_MESSAGE)
+                    {
+                        queue->last_message_sequence = sequence;
+                    }
+                    else if ((body[0] == RECORD_TYPE_CONFIRMATION) && (body_size == CONFIRMATION_BODY_SIZE) && (get_uint32(body + 1) > queue->confirmed_sequence))
+                    {
+                        queue->confirmed_sequence = get_uint32(body + 1);
+                    }
+                    expected_sequence = sequence + 1;
+                    position += RECORD_HEADER_SIZE + (size_t)body_size;
+                    has_records = true;
+                    tail_page = page;
+                    tail_position = position;
+                }
+            } while (!end_of_log && ((body_size = check_record(queue->read_page, bytes_read, position)) >= 0));
+
+            /* a record that does not check out before the padding is a write that did not finish */
+            if (!end_of_log && (position + RECORD_HEADER_SIZE <= bytes_read) && (get_uint16(queue->read_page + position) == RECORD_MAGIC))
+            {
+                end_of_log = true;
+            }
+        }
+    }
+
+    start_empty_log(queue);
+    if (has_records)
+    {
+        if ((queue->file_store->concrete_file_read(queue->file, (uint32_t)(tail_page * queue->page_size), queue->write_page, queue->page_size, &bytes_read) != 0) ||
+            (bytes_read < tail_position))
+        {
+            LogError("Failure reading the last page of the persistent queue");
+            has_records = false;
+        }
+        else
+        {
+            /* whatever follows the last record is rewritten by the next page write */
+            (void)memset(queue->write_page + tail_position, 0, queue->page_size - tail_position);
+            queue->write_page_index = tail_page;
+            queue->write_position = tail_position;
+            queue->next_sequence = expected_sequence;
+        }
+    }
+
+    if (!has_records)
+    {
+        queue->last_message_sequence = 0;
+        queue->confirmed_sequence = 0;
+        queue->next_sequence = 1;
+    }
+}
+
+static void destroy_queue(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    if (queue->file != NULL)
+    {
+        queue->file_store->concrete_file_close(queue->file);
+    }
+    free(queue->read_page);
+    free(queue->write_page);
+    free(queue->compaction_path);
+    free(queue->path);
+    free(queue);
+}
+
+IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE IoTHubClient_PersistentQueue_Create(const IOTHUB_CLIENT_PERSISTENCE_OPTIONS* options)
+{
+    IOTHUB_CLIENT_PERSISTENT_QUEUE* result;
+
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_001: [ If options, its file_store, any function of the file_store or path is NULL, page_size is not between 64 and 32768 or max_bytes is less than 2 pages, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+    if ((options == NULL) || (options->file_store == NULL) || (options->path == NULL) ||
+        (options->file_store->concrete_file_open == NULL) || (options->file_store->concrete_file_close == NULL) ||
+        (options->file_store->concrete_file_read == NULL) || (options->file_store->concrete_file_write == NULL) ||
+        (options->file_store->concrete_file_flush == NULL) || (options->file_store->concrete_file_exists == NULL) ||
+        (options->file_store->concrete_file_remove == NULL) || (options->file_store->concrete_file_rename == NULL) ||
+        (options->page_size < MIN_PAGE_SIZE) || (options->page_size > MAX_PAGE_SIZE) ||
+        (options->max_bytes / options->page_size < 2))
+    {
+        LogError("Invalid persistent queue options %p", options);
+        result = NULL;
+    }
+    else if ((result = (IOTHUB_CLIENT_PERSISTENT_QUEUE*)malloc(sizeof(IOTHUB_CLIENT_PERSISTENT_QUEUE))) == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_002: [ If any allocation or opening the file fails, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+        LogError("Failure allocating the persistent queue");
+    }
+    else
+    {
+        size_t path_length = strlen(options->path);
+        (void)memset(result, 0, sizeof(IOTHUB_CLIENT_PERSISTENT_QUEUE));
+        result->file_store = options->file_store;
+        result->page_size = options->page_size;
+        result->max_pages = (options->max_bytes / options->page_size > UINT32_MAX / 2) ? (UINT32_MAX / 2) : (uint32_t)(options->max_bytes / options->page_size);
+        result->max_replay_rate = options->max_replay_rate;
+        result->replay_callback = options->replay_callback;
+        result->replay_context = options->replay_context;
+
+        if ((mallocAndStrcpy_s(&result->path, options->path) != 0) ||
+            ((result->compaction_path = (char*)malloc(path_length + sizeof(COMPACTION_SUFFIX))) == NULL) ||
+            ((result->write_page = (unsigned char*)malloc(result->page_size)) == NULL) ||
+            ((result->read_page = (unsigned char*)malloc(result->page_size)) == NULL))
+        {
+            LogError("Failure allocating the persistent queue buffers");
+            destroy_queue(result);
+            result = NULL;
+        }
+        else
+        {
+            (void)memcpy(result->compaction_path, options->path, path_length);
+            (void)memcpy(result->compaction_path + path_length, COMPACTION_SUFFIX, sizeof(COMPACTION_SUFFIX));
+
+            /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_003: [ If the file at path does not exist but its compaction copy does, IoTHubClient_PersistentQueue_Create shall rename the copy to path. ] */
+            if (!result->file_store->concrete_file_exists(result->path) &&
+                result->file_store->concrete_file_exists(result->compaction_path) &&
+                (result->file_store->concrete_file_rename(result->compaction_path, result->path) != 0))
+            {
+                LogError("Failure restoring %s", result->compaction_path);
+            }
+
+            if ((result->file = result->file_store->concrete_file_open(result->path)) == NULL)
+            {
+                LogError("Failure opening %s", result->path);
+                destroy_queue(result);
+                result = NULL;
+            }
+            else
+            {
+                /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_004: [ IoTHubClient_PersistentQueue_Create shall read the log up to its first invalid record, so that the messages stored and not confirmed before a restart are replayed. ] */
+                recover_log(result);
+            }
+        }
+    }
+    return result;
+}
+
+void IoTHubClient_PersistentQueue_Destroy(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_005: [ If queue is NULL, IoTHubClient_PersistentQueue_Destroy shall do nothing. ] */
+    if (queue != NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_006: [ IoTHubClient_PersistentQueue_Destroy shall write the pending confirmation and the last page, close the file and free the queue. ] */
+        if (queue->file != NULL)
+        {
+            if (queue->confirmation_dirty)
+            {
+                (void)append_confirmation(queue);
+            }
+            if (queue->write_page_dirty && (write_page_to_file(queue) == 0))
+            {
+                (void)queue->file_store->concrete_file_flush(queue->file);
+            }
+        }
+        destroy_queue(queue);
+    }
+}
+
+int IoTHubClient_PersistentQueue_Store(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue, IOTHUB_MESSAGE_HANDLE message)
+{
+    int result;
+
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_007: [ If queue or message is NULL, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+    if ((queue == NULL) || (message == NULL))
+    {
+        LogError("Invalid argument queue=%p, message=%p", queue, message);
+        result = __FAILURE__;
+    }
+    else
+    {
+        IOTHUBMESSAGE_CONTENT_TYPE content_type = IoTHubMessage_GetContentType(message);
+        const unsigned char* payload = NULL;
+        size_t payload_size = 0;
+        const char* message_id = IoTHubMessage_GetMessageId(message);
+        const char* correlation_id = IoTHubMessage_GetCorrelationId(message);
+        const char* content_type_property = IoTHubMessage_GetContentTypeSystemProperty(message);
+        const char* content_encoding = IoTHubMessage_GetContentEncodingSystemProperty(message);
+        const char* output_name = IoTHubMessage_GetOutputName(message);
+        const char* const* keys;
+        const char* const* values;
+        size_t count;
+
+        if (content_type == IOTHUBMESSAGE_BYTEARRAY)
+        {
+            if (IoTHubMessage_GetByteArray(message, &payload, &payload_size) != IOTHUB_MESSAGE_OK)
+            {
+                content_type = IOTHUBMESSAGE_UNKNOWN;
+            }
+        }
+        else if (content_type == IOTHUBMESSAGE_STRING)
+        {
+            const char* text = IoTHubMessage_GetString(message);
+            if (text == NULL)
+            {
+                content_type = IOTHUBMESSAGE_UNKNOWN;
+            }
+            else
+            {
+                payload = (const unsigned char*)text;
+                payload_size = strlen(text) + 1;
+            }
+        }
+
+        if ((content_type != IOTHUBMESSAGE_BYTEARRAY) && (content_type != IOTHUBMESSAGE_STRING))
+        {
+            LogError("Failure getting the message payload");
+            result = __FAILURE__;
+        }
+        else if (Map_GetInternals(IoTHubMessage_GetReadOnlyProperties(message), &keys, &values, &count) != MAP_OK)
+        {
+            LogError("Failure getting the message properties");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t index;
+            size_t body_size = 1 + FIELD_HEADER_SIZE + payload_size +
+                get_field_size(message_id) + get_field_size(correlation_id) + get_field_size(content_type_property) +
+                get_field_size(content_encoding) + get_field_size(output_name);
+            for (index = 0; index < count; index++)
+            {
+                body_size += get_field_size(keys[index]) + get_field_size(values[index]);
+            }
+
+            /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_008: [ If the message does not fit in one page, or the log is full and cannot be compacted, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+            /* the page of a message keeps room for the confirmation that follows it, so that a full log can still record one */
+            if (RECORD_HEADER_SIZE + body_size + CONFIRMATION_RECORD_SIZE > queue->page_size)
+            {
+                LogError("A message of %lu bytes does not fit in a page of the persistent queue", (unsigned long)body_size);
+                result = __FAILURE__;
+            }
+            else if (reserve_record(queue, RECORD_HEADER_SIZE + body_size + CONFIRMATION_RECORD_SIZE) != 0)
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_009: [ Otherwise IoTHubClient_PersistentQueue_Store shall append the payload, message id, correlation id, content type, content encoding, output name and properties of the message to the last page and return 0; the diagnostic data is not stored. ] */
+                size_t record_position = queue->write_position;
+                uint32_t last_message_sequence = queue->last_message_sequence;
+                unsigned char* body = queue->write_page + queue->write_position + RECORD_HEADER_SIZE;
+                unsigned char* field = body + 1;
+                body[0] = RECORD_TYPE_MESSAGE;
+                field = put_field(field, (content_type == IOTHUBMESSAGE_BYTEARRAY) ? FIELD_BYTE_ARRAY : FIELD_STRING, payload, payload_size);
+                field = put_string_field(field, FIELD_MESSAGE_ID, message_id);
+                field = put_string_field(field, FIELD_CORRELATION_ID, correlation_id);
+                field = put_string_field(field, FIELD_CONTENT_TYPE, content_type_property);
+                field = put_string_field(field, FIELD_CONTENT_ENCODING, content_encoding);
+                field = put_string_field(field, FIELD_OUTPUT_NAME, output_name);
+                for (index = 0; index < count; index++)
+                {
+                    field = put_string_field(field, FIELD_PROPERTY_KEY, keys[index]);
+                    field = put_string_field(field, FIELD_PROPERTY_VALUE, values[index]);
+                }
+                queue->last_message_sequence = queue->next_sequence;
+                commit_record(queue, body_size);
+
+                /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_024: [ IoTHubClient_PersistentQueue_Store shall write and flush the last page before it returns 0, so that a message reported as persisted survives a power loss. ] */
+                if ((write_page_to_file(queue) != 0) || (queue->file_store->concrete_file_flush(queue->file) != 0))
+                {
+                    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_025: [ If the write or the flush fails, IoTHubClient_PersistentQueue_Store shall remove the message from the last page and fail with a non-zero value. ] */
+                    /* the caller keeps the message in memory; the page is written again without it, so that a restart does not replay it as well */
+                    LogError("Failure writing a message to the persistent queue");
+                    (void)memset(queue->write_page + record_position, 0, queue->write_position - record_position);
+                    queue->write_position = record_position;
+                    queue->last_message_sequence = last_message_sequence;
+                    queue->next_sequence--;
+                    queue->write_page_dirty = true;
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+bool IoTHubClient_PersistentQueue_HasStored(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_010: [ IoTHubClient_PersistentQueue_HasStored shall return true if queue is not NULL and holds a message that was not confirmed yet. ] */
+    return (queue != NULL) && (queue->last_message_sequence > queue->confirmed_sequence);
+}
+
+bool IoTHubClient_PersistentQueue_IsReplayed(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue, const IOTHUB_MESSAGE_LIST* message)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_011: [ IoTHubClient_PersistentQueue_IsReplayed shall return true if message was returned by IoTHubClient_PersistentQueue_GetNext of queue. ] */
+    return (queue != NULL) && (message != NULL) &&
+        (message->callback == on_replayed_message_complete) && (((const REPLAY_SLOT*)message->context)->queue == queue);
+}
+
+static void advance_head(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue)
+{
+    size_t index;
+    bool in_flight = false;
+
+    while ((queue->slot_count > 0) && (queue->slots[queue->first_slot].state == REPLAY_SLOT_CONFIRMED))
+    {
+        REPLAY_SLOT* slot = &queue->slots[queue->first_slot];
+        queue->confirmed_sequence = slot->sequence;
+        queue->head_offset = slot->next_offset;
+        queue->confirmation_dirty = true;
+        queue->first_slot = (queue->first_slot + 1) % REPLAY_WINDOW;
+        queue->slot_count--;
+    }
+
+    for (index = 0; index < queue->slot_count; index++)
+    {
+        in_flight |= (queue->slots[(queue->first_slot + index) % REPLAY_WINDOW].state == REPLAY_SLOT_IN_FLIGHT);
+    }
+    if (queue->rewind && !in_flight)
+    {
+        queue->slot_count = 0;
+    }
+}
+
+static void on_replayed_message_complete(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* context)
+{
+    REPLAY_SLOT* slot = (REPLAY_SLOT*)context;
+    IOTHUB_CLIENT_PERSISTENT_QUEUE* queue = slot->queue;
+
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_016: [ When a replayed message is confirmed with IOTHUB_CLIENT_CONFIRMATION_OK and every message replayed before it is confirmed, it shall be marked as confirmed in the log. ] */
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_017: [ When a replayed message completes with any other result, the replay shall start again from the first message that is not confirmed once no replayed message is waiting for its result. ] */
+    if (result == IOTHUB_CLIENT_CONFIRMATION_OK)
+    {
+        slot->state = REPLAY_SLOT_CONFIRMED;
+    }
+    else
+    {
+        slot->state = REPLAY_SLOT_FAILED;
+        queue->rewind = true;
+    }
+    advance_head(queue);
+
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_018: [ The replay_callback of the options shall be called with the result of each replayed message. ] */
+    if (queue->replay_callback != NULL)
+    {
+        queue->replay_callback(result, queue->replay_context);
+    }
+}
+
+static IOTHUB_MESSAGE_HANDLE create_message_from_record(const unsigned char* body, size_t body_size)
+{
+    IOTHUB_MESSAGE_HANDLE result = NULL;
+    const char* key = NULL;
+    size_t position = 1;
+    bool failed = false;
+
+    while ((position + FIELD_HEADER_SIZE <= body_size) && !failed)
+    {
+        unsigned char tag = body[position];
+        size_t size = get_uint16(body + position + 1);
+        const unsigned char* value = body + position + FIELD_HEADER_SIZE;
+        const char* text = (const char*)value;
+
+        if ((position + FIELD_HEADER_SIZE + size > body_size) ||
+            ((tag != FIELD_BYTE_ARRAY) && ((size == 0) || (value[size - 1] != '\0'))) ||
+            ((result == NULL) != ((tag == FIELD_BYTE_ARRAY) || (tag == FIELD_STRING))))
+        {
+            LogError("Invalid field %d in a record of the persistent queue", (int)tag);
+            failed = true;
+        }
+        else
+        {
+            switch (tag)
+            {
+            case FIELD_BYTE_ARRAY:
+                failed = ((result = IoTHubMessage_CreateFromByteArray(value, size)) == NULL);
+                break;
+            case FIELD_STRING:
+                failed = ((result = IoTHubMessage_CreateFromString(text)) == NULL);
+                break;
+            case FIELD_MESSAGE_ID:
+                failed = (IoTHubMessage_SetMessageId(result, text) != IOTHUB_MESSAGE_OK);
+                break;
+            case FIELD_CORRELATION_ID:
+                failed = (IoTHubMessage_SetCorrelationId(result, text) != IOTHUB_MESSAGE_OK);
+                break;
+            case FIELD_CONTENT_TYPE:
+                failed = (IoTHubMessage_SetContentTypeSystemProperty(result, text) != IOTHUB_MESSAGE_OK);
+                break;
+            case FIELD_CONTENT_ENCODING:
+                failed = (IoTHubMessage_SetContentEncodingSystemProperty(result, text) != IOTHUB_MESSAGE_OK);
+                break;
+            case FIELD_OUTPUT_NAME:
+                failed = (IoTHubMessage_SetOutputName(result, text) != IOTHUB_MESSAGE_OK);
+                break;
+            case FIELD_PROPERTY_KEY:
+                key = text;
+                break;
+            case FIELD_PROPERTY_VALUE:
+                failed = (key == NULL) || (IoTHubMessage_SetProperty(result, key, text) != IOTHUB_MESSAGE_OK);
+                key = NULL;
+                break;
+            default:
+                /* fields added by later versions are skipped */
+                break;
+            }
+            position += FIELD_HEADER_SIZE + size;
+        }
+    }
+
+    if (failed && (result != NULL))
+    {
+        IoTHubMessage_Destroy(result);
+        result = NULL;
+    }
+    return result;
+}
+
+/* returns the page holding offset and how many of its bytes are valid, or NULL if offset is past the end of the log */
+static const unsigned char* get_page(IOTHUB_CLIENT_PERSISTENT_QUEUE* queue, uint32_t offset, size_t* size)
+{
+    const unsigned char* result;
+    uint32_t page = (uint32_t)(offset / queue->page_size);
+
+    if (page > queue->write_page_index)
+    {
+        result = NULL;
+    }
+    else if (page == queue->write_page_index)
+    {
+        result = queue->write_page;
+        *size = queue->write_position;
+    }
+    else if ((page != queue->read_page_index) &&
+        (queue->file_store->concrete_file_read(queue->file, (uint32_t)(page * queue->page_size), queue->read_page, queue->page_size, &queue->read_page_size) != 0))
+    {
+        LogError("Failure reading page %lu of the persistent queue", (unsigned long)page);
+        queue->read_page_index = NO_PAGE;
+        result = NULL;
+    }
+    else
+    {
+        queue->read_page_index = page;
+        result = queue->read_page;
+        *size = queue->read_page_size;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_LIST* IoTHubClient_PersistentQueue_GetNext(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue, tickcounter_ms_t now)
+{
+    IOTHUB_MESSAGE_LIST* result = NULL;
+
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_012: [ If queue is NULL, REPLAY_WINDOW replayed messages are waiting for their result, or a failed replay waits for the others to complete, IoTHubClient_PersistentQueue_GetNext shall return NULL. ] */
+    if ((queue != NULL) && (queue->file != NULL) && (queue->slot_count < REPLAY_WINDOW) && !(queue->rewind && (queue->slot_count > 0)))
+    {
+        if (queue->rewind)
+        {
+            queue->read_offset = queue->head_offset;
+            queue->rewind = false;
+        }
+
+        /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_013: [ If max_replay_rate is not 0 and less than 1000 / max_replay_rate ms passed since the last replayed message, IoTHubClient_PersistentQueue_GetNext shall return NULL. ] */
+        if ((queue->max_replay_rate == 0) || !queue->has_replayed || (now < queue->last_replay_ms) ||
+            (now - queue->last_replay_ms >= 1000 / queue->max_replay_rate))
+        {
+            const unsigned char* page;
+            size_t page_size = 0;
+            bool done = false;
+
+            while (!done && ((page = get_page(queue, queue->read_offset, &page_size)) != NULL))
+            {
+                size_t position = queue->read_offset % queue->page_size;
+                int body_size = check_record(page, page_size, position);
+
+                if (body_size < 0)
+                {
+                    /* padding, or the end of the log */
+                    if (queue->read_offset / queue->page_size == queue->write_page_index)
+                    {
+                        done = true;
+                    }
+                    else
+                    {
+                        queue->read_offset = (uint32_t)((queue->read_offset / queue->page_size + 1) * queue->page_size);
+                    }
+                }
+                else
+                {
+                    const unsigned char* record = page + position;
+                    uint32_t sequence = get_uint32(record + 4);
+                    uint32_t next_offset = queue->read_offset + RECORD_HEADER_SIZE + (uint32_t)body_size;
+
+                    if ((record[RECORD_HEADER_SIZE] != RECORD_TYPE_MESSAGE) || (sequence <= queue->confirmed_sequence))
+                    {
+                        queue->read_offset = next_offset;
+                    }
+                    else
+                    {
+                        /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_014: [ Otherwise IoTHubClient_PersistentQueue_GetNext shall return the next stored message that is not confirmed, in the order they were stored, as a new IOTHUB_MESSAGE_LIST that does not time out. ] */
+                        IOTHUB_MESSAGE_HANDLE message = create_message_from_record(record + RECORD_HEADER_SIZE, (size_t)body_size);
+                        if (message == NULL)
+                        {
+                            /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_015: [ If the message cannot be created, IoTHubClient_PersistentQueue_GetNext shall return NULL and try it again on the next call. ] */
+                            LogError("Failure creating the message stored with sequence %lu", (unsigned long)sequence);
+                        }
+                        else if ((result = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST))) == NULL)
+                        {
+                            LogError("Failure allocating the replayed message");
+                            IoTHubMessage_Destroy(message);
+                        }
+                        else
+                        {
+                            REPLAY_SLOT* slot = &queue->slots[(queue->first_slot + queue->slot_count) % REPLAY_WINDOW];
+                            slot->queue = queue;
+                            slot->sequence = sequence;
+                            slot->next_offset = next_offset;
+                            slot->state = REPLAY_SLOT_IN_FLIGHT;
+                            queue->slot_count++;
+
+                            (void)memset(result, 0, sizeof(IOTHUB_MESSAGE_LIST));
+                            result->messageHandle = message;
+                            result->callback = on_replayed_message_complete;
+                            result->context = slot;
+                            result->message_count = 1;
+
+                            queue->read_offset = next_offset;
+                            queue->last_replay_ms = now;
+                            queue->has_replayed = true;
+                        }
+                        done = true;
+                    }
+
+                    if (queue->slot_count == 0)
+                    {
+                        /* nothing unconfirmed before read_offset */
+                        queue->head_offset = queue->read_offset;
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+bool IoTHubClient_PersistentQueue_GetTimeToNext(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue, tickcounter_ms_t now, tickcounter_ms_t* ms_to_next)
+{
+    bool result;
+
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_022: [ If queue or ms_to_next is NULL, every stored message that is not confirmed was already replayed, or IoTHubClient_PersistentQueue_GetNext waits for replayed messages to complete, IoTHubClient_PersistentQueue_GetTimeToNext shall return false. ] */
+    if ((queue == NULL) || (ms_to_next == NULL) || (queue->file == NULL) || !IoTHubClient_PersistentQueue_HasStored(queue) ||
+        (queue->slot_count >= REPLAY_WINDOW) || (queue->rewind && (queue->slot_count > 0)) ||
+        (!queue->rewind && (queue->slot_count > 0) &&
+            (queue->slots[(queue->first_slot + queue->slot_count - 1) % REPLAY_WINDOW].sequence >= queue->last_message_sequence)))
+    {
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_023: [ Otherwise IoTHubClient_PersistentQueue_GetTimeToNext shall set ms_to_next to the milliseconds left until 1000 / max_replay_rate ms passed since the last replayed message, 0 if they did or max_replay_rate is 0, and return true. ] */
+        if ((queue->max_replay_rate == 0) || !queue->has_replayed || (now < queue->last_replay_ms) ||
+            (now - queue->last_replay_ms >= 1000 / queue->max_replay_rate))
+        {
+            *ms_to_next = 0;
+        }
+        else
+        {
+            *ms_to_next = queue->last_replay_ms + 1000 / queue->max_replay_rate - now;
+        }
+        result = true;
+    }
+    return result;
+}
+
+void IoTHubClient_PersistentQueue_DoWork(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_019: [ If queue is NULL, IoTHubClient_PersistentQueue_DoWork shall do nothing. ] */
+    if ((queue != NULL) && (queue->file != NULL))
+    {
+        if ((queue->slot_count == 0) && !IoTHubClient_PersistentQueue_HasStored(queue) &&
+            ((queue->write_page_index != 0) || (queue->write_position != 0)))
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_020: [ When every stored message is confirmed, IoTHubClient_PersistentQueue_DoWork shall remove the file and start an empty log. ] */
+            queue->file_store->concrete_file_close(queue->file);
+            if (queue->file_store->concrete_file_remove(queue->path) != 0)
+            {
+                LogError("Failure removing %s", queue->path);
+            }
+            if ((queue->file = queue->file_store->concrete_file_open(queue->path)) == NULL)
+            {
+                LogError("Failure opening %s, the persistent queue stops", queue->path);
+            }
+            start_empty_log(queue);
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_021: [ Otherwise IoTHubClient_PersistentQueue_DoWork shall append a confirmation record if messages were confirmed, then write and flush the last page if it changed. ] */
+            if (queue->confirmation_dirty)
+            {
+                (void)append_confirmation(queue);
+            }
+            if (queue->write_page_dirty &&
+                ((write_page_to_file(queue) != 0) || (queue->file_store->concrete_file_flush(queue->file) != 0)))
+            {
+                LogError("Failure writing the persistent queue");
+            }
+        }
+    }
+}
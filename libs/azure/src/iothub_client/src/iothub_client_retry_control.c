@@ -379,6 +379,62 @@ int retry_control_should_retry(RETRY_CONTROL_HANDLE retry_control_handle, RETRY_
     return result;
 }
 
+int retry_control_get_wait_time(RETRY_CONTROL_HANDLE retry_control_handle, unsigned int* wait_time_in_secs)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_001: [If `retry_control_handle` or `wait_time_in_secs` are NULL, `retry_control_get_wait_time` shall fail and return non-zero]
+    if ((retry_control_handle == NULL) || (wait_time_in_secs == NULL))
+    {
+        LogError("Failed to get the retry wait time (either retry_control_handle (%p) or wait_time_in_secs (%p) are NULL)", retry_control_handle, wait_time_in_secs);
+        result = __FAILURE__;
+    }
+    else
+    {
+        RETRY_CONTROL_INSTANCE* retry_control = (RETRY_CONTROL_INSTANCE*)retry_control_handle;
+
+        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_002: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_NONE, `wait_time_in_secs` shall be set to RETRY_CONTROL_NO_RETRY]
+        if (retry_control->policy == IOTHUB_CLIENT_RETRY_NONE)
+        {
+            *wait_time_in_secs = RETRY_CONTROL_NO_RETRY;
+            result = RESULT_OK;
+        }
+        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_003: [If `retry_control->retry_count` is 0 or `retry_control->policy` is IOTHUB_CLIENT_RETRY_IMMEDIATE, `wait_time_in_secs` shall be set to 0]
+        else if (retry_control->retry_count == 0 || retry_control->policy == IOTHUB_CLIENT_RETRY_IMMEDIATE)
+        {
+            *wait_time_in_secs = 0;
+            result = RESULT_OK;
+        }
+        else
+        {
+            time_t current_time;
+
+            // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_004: [If `retry_control->last_retry_time` is INDEFINITE_TIME or get_time() fails, `retry_control_get_wait_time` shall fail and return non-zero]
+            if (retry_control->last_retry_time == INDEFINITE_TIME || (current_time = get_time(NULL)) == INDEFINITE_TIME)
+            {
+                LogError("Failed to get the retry wait time (get_time() failed)");
+                result = __FAILURE__;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_005: [Otherwise `wait_time_in_secs` shall be set to the seconds left until (`current_time` - `retry_control->last_retry_time`) reaches `retry_control->current_wait_time_in_secs`, 0 if it already did]
+                double elapsed = get_difftime(current_time, retry_control->last_retry_time);
+                if (elapsed >= retry_control->current_wait_time_in_secs)
+                {
+                    *wait_time_in_secs = 0;
+                }
+                else
+                {
+                    *wait_time_in_secs = (unsigned int)ceil(retry_control->current_wait_time_in_secs - elapsed);
+                }
+                result = RESULT_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
 int retry_control_set_option(RETRY_CONTROL_HANDLE retry_control_handle, const char* name, const void* value)
 {
     int result;
@@ -5,7 +5,8 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
-#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/constbuffer.h"
+#include "azure_c_shared_utility/refcount.h"
 
 #include "iothub_message.h"
 
@@ -15,14 +16,10 @@ DEFINE_ENUM_STRINGS(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUE
 #define LOG_IOTHUB_MESSAGE_ERROR() \
     LogError("(result = %s)", ENUM_TO_STRING(IOTHUB_MESSAGE_RESULT, result));
 
-typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
+/*everything about a message except its payload; clones share one of these until one of them changes it*/
+typedef struct MESSAGE_PROPERTIES_TAG
 {
-    IOTHUBMESSAGE_CONTENT_TYPE contentType;
-    union
-    {
-        BUFFER_HANDLE byteArray;
-        STRING_HANDLE string;
-    } value;
+    COUNT_TYPE count;
     MAP_HANDLE properties;
     char* messageId;
     char* correlationId;
@@ -33,6 +30,16 @@ typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
     char* connectionModuleId;
     char* connectionDeviceId;
     IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE diagnosticData;
+    /*IoTHubMessage_Properties gave the map to the application, which can change it at any time, so the block cannot be shared anymore*/
+    bool mapHandedOut;
+}MESSAGE_PROPERTIES;
+
+typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
+{
+    IOTHUBMESSAGE_CONTENT_TYPE contentType;
+    /*the payload, for STRING messages including the '\0'*/
+    CONSTBUFFER_HANDLE content;
+    MESSAGE_PROPERTIES* propertiesData;
 }IOTHUB_MESSAGE_HANDLE_DATA;
 
 static bool ContainsOnlyUsAscii(const char* asciiValue)
@@ -77,32 +84,6 @@ static void DestroyDiagnosticPropertyData(IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DAT
     free(diagnosticHandle);
 }
 
-static void DestroyMessageData(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
-{
-    if (handleData->contentType == IOTHUBMESSAGE_BYTEARRAY)
-    {
-        BUFFER_delete(handleData->value.byteArray);
-    }
-    else if (handleData->contentType == IOTHUBMESSAGE_STRING)
-    {
-        STRING_delete(handleData->value.string);
-    }
-
-    Map_Destroy(handleData->properties);
-    free(handleData->messageId);
-    handleData->messageId = NULL;
-    free(handleData->correlationId);
-    handleData->correlationId = NULL;
-    free(handleData->userDefinedContentType);
-    free(handleData->contentEncoding);
-    DestroyDiagnosticPropertyData(handleData->diagnosticData);
-    free(handleData->outputName);
-    free(handleData->inputName);
-    free(handleData->connectionModuleId);
-    free(handleData->connectionDeviceId);
-    free(handleData);
-}
-
 static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE CloneDiagnosticPropertyData(const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* source)
 {
     IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE result = NULL;
@@ -139,73 +120,261 @@ static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE CloneDiagnosticPropertyDat
     return result;
 }
 
+static void DestroyMessageProperties(MESSAGE_PROPERTIES* propertiesData)
+{
+    Map_Destroy(propertiesData->properties);
+    free(propertiesData->messageId);
+    free(propertiesData->correlationId);
+    free(propertiesData->userDefinedContentType);
+    free(propertiesData->contentEncoding);
+    DestroyDiagnosticPropertyData(propertiesData->diagnosticData);
+    free(propertiesData->outputName);
+    free(propertiesData->inputName);
+    free(propertiesData->connectionModuleId);
+    free(propertiesData->connectionDeviceId);
+    free(propertiesData);
+}
+
+static void ReleaseMessageProperties(MESSAGE_PROPERTIES* propertiesData)
+{
+    if ((propertiesData != NULL) &&
+        (DEC_REF_VAR(propertiesData->count) == DEC_RETURN_ZERO))
+    {
+        DestroyMessageProperties(propertiesData);
+    }
+}
+
+static MESSAGE_PROPERTIES* CreateMessageProperties(void)
+{
+    MESSAGE_PROPERTIES* result = (MESSAGE_PROPERTIES*)malloc(sizeof(MESSAGE_PROPERTIES));
+    if (result == NULL)
+    {
+        LogError("malloc failed");
+    }
+    else
+    {
+        memset(result, 0, sizeof(*result));
+        INIT_REF_VAR(result->count);
+
+        if ((result->properties = Map_Create(ValidateAsciiCharactersFilter)) == NULL)
+        {
+            LogError("Map_Create for properties failed");
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+static MESSAGE_PROPERTIES* CloneMessageProperties(const MESSAGE_PROPERTIES* source)
+{
+    MESSAGE_PROPERTIES* result = (MESSAGE_PROPERTIES*)malloc(sizeof(MESSAGE_PROPERTIES));
+    if (result == NULL)
+    {
+        LogError("unable to malloc");
+    }
+    else
+    {
+        memset(result, 0, sizeof(*result));
+        INIT_REF_VAR(result->count);
+
+        if (source->messageId != NULL && mallocAndStrcpy_s(&result->messageId, source->messageId) != 0)
+        {
+            LogError("unable to Copy messageId");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->correlationId != NULL && mallocAndStrcpy_s(&result->correlationId, source->correlationId) != 0)
+        {
+            LogError("unable to Copy correlationId");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->userDefinedContentType != NULL && mallocAndStrcpy_s(&result->userDefinedContentType, source->userDefinedContentType) != 0)
+        {
+            LogError("unable to copy contentType");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->contentEncoding != NULL && mallocAndStrcpy_s(&result->contentEncoding, source->contentEncoding) != 0)
+        {
+            LogError("unable to copy contentEncoding");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->diagnosticData != NULL && (result->diagnosticData = CloneDiagnosticPropertyData(source->diagnosticData)) == NULL)
+        {
+            LogError("unable to copy CloneDiagnosticPropertyData");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->outputName != NULL && mallocAndStrcpy_s(&result->outputName, source->outputName) != 0)
+        {
+            LogError("unable to copy outputName");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->inputName != NULL && mallocAndStrcpy_s(&result->inputName, source->inputName) != 0)
+        {
+            LogError("unable to copy inputName");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->connectionModuleId != NULL && mallocAndStrcpy_s(&result->connectionModuleId, source->connectionModuleId) != 0)
+        {
+            LogError("unable to copy connectionModuleId");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if (source->connectionDeviceId != NULL && mallocAndStrcpy_s(&result->connectionDeviceId, source->connectionDeviceId) != 0)
+        {
+            LogError("unable to copy connectionDeviceId");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+        else if ((result->properties = Map_Clone(source->properties)) == NULL)
+        {
+            LogError("unable to Map_Clone");
+            DestroyMessageProperties(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+/*Codes_SRS_IOTHUBMESSAGE_01_036: [ Before changing a system property, a diagnostic property or the properties map of a message whose properties are shared with a clone, the message shall get its own copy of all of them. ]*/
+static MESSAGE_PROPERTIES* GetWritableProperties(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
+{
+    MESSAGE_PROPERTIES* result;
+    if (handleData->propertiesData->count == 1)
+    {
+        result = handleData->propertiesData;
+    }
+    else if ((result = CloneMessageProperties(handleData->propertiesData)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_037: [ If making the copy fails, the change shall fail and the message shall keep sharing the properties. ]*/
+        LogError("unable to copy the properties shared with a clone");
+    }
+    else
+    {
+        ReleaseMessageProperties(handleData->propertiesData);
+        handleData->propertiesData = result;
+    }
+    return result;
+}
+
+static void DestroyMessageData(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
+{
+    if (handleData->content != NULL)
+    {
+        CONSTBUFFER_Destroy(handleData->content);
+    }
+    ReleaseMessageProperties(handleData->propertiesData);
+    free(handleData);
+}
+
+static IOTHUB_MESSAGE_HANDLE_DATA* CreateMessageData(IOTHUBMESSAGE_CONTENT_TYPE contentType)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
+    if (result == NULL)
+    {
+        LogError("unable to malloc");
+    }
+    else
+    {
+        result->contentType = contentType;
+        result->content = NULL;
+        if ((result->propertiesData = CreateMessageProperties()) == NULL)
+        {
+            LogError("unable to create the message properties");
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
 IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
 {
     IOTHUB_MESSAGE_HANDLE_DATA* result;
+    /*Codes_SRS_IOTHUBMESSAGE_06_002: [If size is NOT zero then byteArray MUST NOT be NULL*/
     if ((byteArray == NULL) && (size != 0))
     {
         LogError("Invalid argument - byteArray is NULL");
         result = NULL;
     }
+    /*Codes_SRS_IOTHUBMESSAGE_02_023: [IoTHubMessage_CreateFromByteArray shall call Map_Create to create the message properties.] */
+    /*Codes_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
+    else if ((result = CreateMessageData(IOTHUBMESSAGE_BYTEARRAY)) == NULL)
+    {
+        LogError("unable to create the message");
+        /*Codes_SRS_IOTHUBMESSAGE_02_024: [If there are any errors then IoTHubMessage_CreateFromByteArray shall return NULL.] */
+    }
     else
     {
-        result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
-        if (result == NULL)
+        /*Codes_SRS_IOTHUBMESSAGE_06_001: [If size is zero then byteArray may be NULL.]*/
+        static const unsigned char empty = 0x00;
+
+        /*Codes_SRS_IOTHUBMESSAGE_02_022: [IoTHubMessage_CreateFromByteArray shall call CONSTBUFFER_Create passing byteArray and size as parameters.] */
+        if ((result->content = CONSTBUFFER_Create((size == 0) ? &empty : byteArray, size)) == NULL)
         {
-            LogError("unable to malloc");
+            LogError("CONSTBUFFER_Create failed");
             /*Codes_SRS_IOTHUBMESSAGE_02_024: [If there are any errors then IoTHubMessage_CreateFromByteArray shall return NULL.] */
-            /*let it go through*/
+            DestroyMessageData(result);
+            result = NULL;
         }
-        else
-        {
-            const unsigned char* source;
-            unsigned char temp = 0x00;
+        /*Codes_SRS_IOTHUBMESSAGE_02_025: [Otherwise, IoTHubMessage_CreateFromByteArray shall return a non-NULL handle.] */
+    }
+    return result;
+}
 
-            memset(result, 0, sizeof(*result));
-            /*Codes_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
-            result->contentType = IOTHUBMESSAGE_BYTEARRAY;
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromBorrowedByteArray(const unsigned char* byteArray, size_t size, IOTHUB_MESSAGE_PAYLOAD_RELEASE_CALLBACK releaseCallback, void* releaseContext)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    /*Codes_SRS_IOTHUBMESSAGE_01_030: [ If byteArray is NULL and size is not 0, IoTHubMessage_CreateFromBorrowedByteArray shall fail and return NULL. ]*/
+    if ((byteArray == NULL) && (size != 0))
+    {
+        LogError("Invalid argument - byteArray is NULL");
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_01_031: [ IoTHubMessage_CreateFromBorrowedByteArray shall create a message of type IOTHUBMESSAGE_BYTEARRAY with an empty properties map. ]*/
+    else if ((result = CreateMessageData(IOTHUBMESSAGE_BYTEARRAY)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_033: [ If any error occurs, IoTHubMessage_CreateFromBorrowedByteArray shall return NULL and shall not call releaseCallback. ]*/
+        LogError("unable to create the message");
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_01_032: [ IoTHubMessage_CreateFromBorrowedByteArray shall call CONSTBUFFER_CreateWithCustomFree passing byteArray, size, releaseCallback and releaseContext, so that the payload is not copied and releaseCallback is called once no message refers to it anymore. ]*/
+    else if ((result->content = CONSTBUFFER_CreateWithCustomFree(byteArray, size, releaseCallback, releaseContext)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_033: [ If any error occurs, IoTHubMessage_CreateFromBorrowedByteArray shall return NULL and shall not call releaseCallback. ]*/
+        LogError("CONSTBUFFER_CreateWithCustomFree failed");
+        DestroyMessageData(result);
+        result = NULL;
+    }
+    return result;
+}
 
-            if (size != 0)
-            {
-                /*Codes_SRS_IOTHUBMESSAGE_06_002: [If size is NOT zero then byteArray MUST NOT be NULL*/
-                if (byteArray == NULL)
-                {
-                    LogError("Attempted to create a Hub Message from a NULL pointer!");
-                    DestroyMessageData(result);
-                    result = NULL;
-                    source = NULL;
-                }
-                else
-                {
-                    source = byteArray;
-                }
-            }
-            else
-            {
-                /*Codes_SRS_IOTHUBMESSAGE_06_001: [If size is zero then byteArray may be NULL.]*/
-                source = &temp;
-            }
-            if (result != NULL)
-            {
-                /*Codes_SRS_IOTHUBMESSAGE_02_022: [IoTHubMessage_CreateFromByteArray shall call BUFFER_create passing byteArray and size as parameters.] */
-                if ((result->value.byteArray = BUFFER_create(source, size)) == NULL)
-                {
-                    LogError("BUFFER_create failed");
-                    /*Codes_SRS_IOTHUBMESSAGE_02_024: [If there are any errors then IoTHubMessage_CreateFromByteArray shall return NULL.] */
-                    DestroyMessageData(result);
-                    result = NULL;
-                }
-                /*Codes_SRS_IOTHUBMESSAGE_02_023: [IoTHubMessage_CreateFromByteArray shall call Map_Create to create the message properties.] */
-                else if ((result->properties = Map_Create(ValidateAsciiCharactersFilter)) == NULL)
-                {
-                    LogError("Map_Create for properties failed");
-                    /*Codes_SRS_IOTHUBMESSAGE_02_024: [If there are any errors then IoTHubMessage_CreateFromByteArray shall return NULL.] */
-                    DestroyMessageData(result);
-                    result = NULL;
-                }
-                /*Codes_SRS_IOTHUBMESSAGE_02_025: [Otherwise, IoTHubMessage_CreateFromByteArray shall return a non-NULL handle.] */
-            }
-        }
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromConstBuffer(CONSTBUFFER_HANDLE payload)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    /*Codes_SRS_IOTHUBMESSAGE_01_034: [ If payload is NULL, IoTHubMessage_CreateFromConstBuffer shall fail and return NULL. ]*/
+    if (payload == NULL)
+    {
+        LogError("Invalid argument - payload is NULL");
+        result = NULL;
+    }
+    else if ((result = CreateMessageData(IOTHUBMESSAGE_BYTEARRAY)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_035: [ If any error occurs, IoTHubMessage_CreateFromConstBuffer shall return NULL. ]*/
+        LogError("unable to create the message");
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_01_038: [ IoTHubMessage_CreateFromConstBuffer shall create a message of type IOTHUBMESSAGE_BYTEARRAY that holds a reference to payload obtained by calling CONSTBUFFER_Clone. ]*/
+    else if ((result->content = CONSTBUFFER_Clone(payload)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_035: [ If any error occurs, IoTHubMessage_CreateFromConstBuffer shall return NULL. ]*/
+        LogError("CONSTBUFFER_Clone failed");
+        DestroyMessageData(result);
+        result = NULL;
     }
     return result;
 }
@@ -218,40 +387,22 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source)
         LogError("Invalid argument - source is NULL");
         result = NULL;
     }
-    else
+    /*Codes_SRS_IOTHUBMESSAGE_02_028: [IoTHubMessage_CreateFromString shall call Map_Create to create the message properties.] */
+    /*Codes_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
+    else if ((result = CreateMessageData(IOTHUBMESSAGE_STRING)) == NULL)
     {
-        result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
-        if (result == NULL)
-        {
-            LogError("malloc failed");
-            /*Codes_SRS_IOTHUBMESSAGE_02_029: [If there are any encountered in the execution of IoTHubMessage_CreateFromString then IoTHubMessage_CreateFromString shall return NULL.] */
-            /*let it go through*/
-        }
-        else
-        {
-            memset(result, 0, sizeof(*result));
-            /*Codes_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
-            result->contentType = IOTHUBMESSAGE_STRING;
-
-            /*Codes_SRS_IOTHUBMESSAGE_02_027: [IoTHubMessage_CreateFromString shall call STRING_construct passing source as parameter.] */
-            if ((result->value.string = STRING_construct(source)) == NULL)
-            {
-                LogError("STRING_construct failed");
-                /*Codes_SRS_IOTHUBMESSAGE_02_029: [If there are any encountered in the execution of IoTHubMessage_CreateFromString then IoTHubMessage_CreateFromString shall return NULL.] */
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            /*Codes_SRS_IOTHUBMESSAGE_02_028: [IoTHubMessage_CreateFromString shall call Map_Create to create the message properties.] */
-            else if ((result->properties = Map_Create(ValidateAsciiCharactersFilter)) == NULL)
-            {
-                LogError("Map_Create for properties failed");
-                /*Codes_SRS_IOTHUBMESSAGE_02_029: [If there are any encountered in the execution of IoTHubMessage_CreateFromString then IoTHubMessage_CreateFromString shall return NULL.] */
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            /*Codes_SRS_IOTHUBMESSAGE_02_031: [Otherwise, IoTHubMessage_CreateFromString shall return a non-NULL handle.] */
-        }
+        LogError("unable to create the message");
+        /*Codes_SRS_IOTHUBMESSAGE_02_029: [If there are any encountered in the execution of IoTHubMessage_CreateFromString then IoTHubMessage_CreateFromString shall return NULL.] */
     }
+    /*Codes_SRS_IOTHUBMESSAGE_02_027: [IoTHubMessage_CreateFromString shall call CONSTBUFFER_Create passing source and its length including the null terminator as parameters.] */
+    else if ((result->content = CONSTBUFFER_Create((const unsigned char*)source, strlen(source) + 1)) == NULL)
+    {
+        LogError("CONSTBUFFER_Create failed");
+        /*Codes_SRS_IOTHUBMESSAGE_02_029: [If there are any encountered in the execution of IoTHubMessage_CreateFromString then IoTHubMessage_CreateFromString shall return NULL.] */
+        DestroyMessageData(result);
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_02_031: [Otherwise, IoTHubMessage_CreateFromString shall return a non-NULL handle.] */
     return result;
 }
 
@@ -276,104 +427,36 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
             /*do nothing and return as is*/
             LogError("unable to malloc");
         }
+        /*Codes_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall share the content with iotHubMessageHandle by a call to CONSTBUFFER_Clone.] */
+        else if ((result->content = CONSTBUFFER_Clone(source->content)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+            LogError("unable to CONSTBUFFER_Clone");
+            free(result);
+            result = NULL;
+        }
         else
         {
-            memset(result, 0, sizeof(*result));
             result->contentType = source->contentType;
-
-            if (source->messageId != NULL && mallocAndStrcpy_s(&result->messageId, source->messageId) != 0)
-            {
-                LogError("unable to Copy messageId");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->correlationId != NULL && mallocAndStrcpy_s(&result->correlationId, source->correlationId) != 0)
-            {
-                LogError("unable to Copy correlationId");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->userDefinedContentType != NULL && mallocAndStrcpy_s(&result->userDefinedContentType, source->userDefinedContentType) != 0)
+            if (source->propertiesData->mapHandedOut)
             {
-                LogError("unable to copy contentType");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->contentEncoding != NULL && mallocAndStrcpy_s(&result->contentEncoding, source->contentEncoding) != 0)
-            {
-                LogError("unable to copy contentEncoding");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->diagnosticData != NULL && (result->diagnosticData = CloneDiagnosticPropertyData(source->diagnosticData)) == NULL)
-            {
-                LogError("unable to copy CloneDiagnosticPropertyData");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->outputName != NULL && mallocAndStrcpy_s(&result->outputName, source->outputName) != 0)
-            {
-                LogError("unable to copy outputName");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->inputName != NULL && mallocAndStrcpy_s(&result->inputName, source->inputName) != 0)
-            {
-                LogError("unable to copy inputName");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->connectionModuleId != NULL && mallocAndStrcpy_s(&result->connectionModuleId, source->connectionModuleId) != 0)
-            {
-                LogError("unable to copy inputName");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->connectionDeviceId != NULL && mallocAndStrcpy_s(&result->connectionDeviceId, source->connectionDeviceId) != 0)
-            {
-                LogError("unable to copy inputName");
-                DestroyMessageData(result);
-                result = NULL;
-            }
-            else if (source->contentType == IOTHUBMESSAGE_BYTEARRAY)
-            {
-                /*Codes_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone to content by a call to BUFFER_clone] */
-                if ((result->value.byteArray = BUFFER_clone(source->value.byteArray)) == NULL)
-                {
-                    /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
-                    LogError("unable to BUFFER_clone");
-                    DestroyMessageData(result);
-                    result = NULL;
-                }
-                /*Codes_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
-                else if ((result->properties = Map_Clone(source->properties)) == NULL)
+                /*Codes_SRS_IOTHUBMESSAGE_01_039: [ If the properties map of iotHubMessageHandle was returned by IoTHubMessage_Properties, IoTHubMessage_Clone shall give the new message its own copy of the properties map, the system properties and the diagnostic properties. ]*/
+                if ((result->propertiesData = CloneMessageProperties(source->propertiesData)) == NULL)
                 {
                     /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
-                    LogError("unable to Map_Clone");
-                    DestroyMessageData(result);
+                    LogError("unable to copy the message properties");
+                    CONSTBUFFER_Destroy(result->content);
+                    free(result);
                     result = NULL;
                 }
-                /*Codes_SRS_IOTHUBMESSAGE_03_002: [IoTHubMessage_Clone shall return upon success a non-NULL handle to the newly created IoT hub message.]*/
             }
-            else /*can only be STRING*/
+            else
             {
-                /*Codes_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone the content by a call to BUFFER_clone or STRING_clone] */
-                if ((result->value.string = STRING_clone(source->value.string)) == NULL)
-                {
-                    /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
-                    LogError("failed to STRING_clone");
-                    DestroyMessageData(result);
-                    result = NULL;
-                }
-                /*Codes_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
-                else if ((result->properties = Map_Clone(source->properties)) == NULL)
-                {
-                    /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
-                    LogError("unable to Map_Clone");
-                    DestroyMessageData(result);
-                    result = NULL;
-                }
+                /*Codes_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall share the properties map, the system properties and the diagnostic properties with iotHubMessageHandle by incrementing their reference count; they are copied only when one of the two messages changes them.] */
+                result->propertiesData = source->propertiesData;
+                INC_REF_VAR(result->propertiesData->count);
             }
+            /*Codes_SRS_IOTHUBMESSAGE_03_002: [IoTHubMessage_Clone shall return upon success a non-NULL handle to the newly created IoT hub message.]*/
         }
     }
     return result;
@@ -403,10 +486,11 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMes
         }
         else
         {
-            /*Codes_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using BUFFER_u_char and it shall be copied in the buffer argument.]*/
-            *buffer = BUFFER_u_char(handleData->value.byteArray);
-            /*Codes_SRS_IOTHUBMESSAGE_01_012: [The size of the associated data shall be obtained by using BUFFER_length and it shall be copied to the size argument.]*/
-            *size = BUFFER_length(handleData->value.byteArray);
+            /*Codes_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using CONSTBUFFER_GetContent and it shall be copied in the buffer argument.]*/
+            /*Codes_SRS_IOTHUBMESSAGE_01_012: [The size of the associated data shall be obtained by using CONSTBUFFER_GetContent and it shall be copied to the size argument.]*/
+            const CONSTBUFFER* content = CONSTBUFFER_GetContent(handleData->content);
+            *buffer = content->buffer;
+            *size = content->size;
             result = IOTHUB_MESSAGE_OK;
         }
     }
@@ -432,7 +516,7 @@ const char* IoTHubMessage_GetString(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
         else
         {
             /*Codes_SRS_IOTHUBMESSAGE_02_018: [IoTHubMessage_GetStringData shall return the currently stored null terminated string.] */
-            result = STRING_c_str(handleData->value.string);
+            result = (const char*)CONSTBUFFER_GetContent(handleData->content)->buffer;
         }
     }
     return result;
@@ -466,9 +550,40 @@ MAP_HANDLE IoTHubMessage_Properties(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
     }
     else
     {
-        /*Codes_SRS_IOTHUBMESSAGE_02_002: [Otherwise, for any non-NULL iotHubMessageHandle it shall return a non-NULL MAP_HANDLE.]*/
+        /*the caller can change the map through the returned handle, so it has to stop being shared with clones*/
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
-        result = handleData->properties;
+        MESSAGE_PROPERTIES* propertiesData;
+
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_01_037: [ If making the copy fails, the change shall fail and the message shall keep sharing the properties. ]*/
+            LogError("unable to get a private copy of the message properties");
+            result = NULL;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_02_002: [Otherwise, for any non-NULL iotHubMessageHandle it shall return a non-NULL MAP_HANDLE.]*/
+            propertiesData->mapHandedOut = true;
+            result = propertiesData->properties;
+        }
+    }
+    return result;
+}
+
+MAP_HANDLE IoTHubMessage_GetReadOnlyProperties(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    MAP_HANDLE result;
+    if (iotHubMessageHandle == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_040: [ If iotHubMessageHandle is NULL then IoTHubMessage_GetReadOnlyProperties shall return NULL. ]*/
+        LogError("invalid arg (NULL) passed to IoTHubMessage_GetReadOnlyProperties");
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_041: [ Otherwise IoTHubMessage_GetReadOnlyProperties shall return the properties map of the message without copying it, even when it is shared with a clone. ]*/
+        IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        result = handleData->propertiesData->properties;
     }
     return result;
 }
@@ -483,7 +598,14 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetProperty(IOTHUB_MESSAGE_HANDLE msg_handle
     }
     else
     {
-        if (Map_AddOrUpdate(msg_handle->properties, key, value) != MAP_OK)
+        MESSAGE_PROPERTIES* propertiesData;
+
+        if ((propertiesData = GetWritableProperties(msg_handle)) == NULL)
+        {
+            LogError("unable to get a private copy of the message properties");
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else if (Map_AddOrUpdate(propertiesData->properties, key, value) != MAP_OK)
         {
             LogError("Failure adding property to internal map");
             result = IOTHUB_MESSAGE_ERROR;
@@ -508,9 +630,9 @@ const char* IoTHubMessage_GetProperty(IOTHUB_MESSAGE_HANDLE msg_handle, const ch
     {
         bool key_exists = false;
         // The return value is not neccessary, just check the key_exist variable
-        if ((Map_ContainsKey(msg_handle->properties, key, &key_exists) == MAP_OK) && key_exists)
+        if ((Map_ContainsKey(msg_handle->propertiesData->properties, key, &key_exists) == MAP_OK) && key_exists)
         {
-            result = Map_GetValueFromKey(msg_handle->properties, key);
+            result = Map_GetValueFromKey(msg_handle->propertiesData->properties, key);
         }
         else
         {
@@ -533,7 +655,7 @@ const char* IoTHubMessage_GetCorrelationId(IOTHUB_MESSAGE_HANDLE iotHubMessageHa
     {
         /* Codes_SRS_IOTHUBMESSAGE_07_017: [IoTHubMessage_GetCorrelationId shall return the correlationId as a const char*.] */
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
-        result = handleData->correlationId;
+        result = handleData->propertiesData->correlationId;
     }
     return result;
 }
@@ -550,22 +672,32 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetCorrelationId(IOTHUB_MESSAGE_HANDLE iotHu
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
-        /* Codes_SRS_IOTHUBMESSAGE_07_019: [If the IOTHUB_MESSAGE_HANDLE correlationId is not NULL, then the IOTHUB_MESSAGE_HANDLE correlationId will be deallocated.] */
-        if (handleData->correlationId != NULL)
-        {
-            free(handleData->correlationId);
-            handleData->correlationId = NULL;
-        }
+        MESSAGE_PROPERTIES* propertiesData;
 
-        if (mallocAndStrcpy_s(&handleData->correlationId, correlationId) != 0)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            /* Codes_SRS_IOTHUBMESSAGE_07_020: [If the allocation or the copying of the correlationId fails, then IoTHubMessage_SetCorrelationId shall return IOTHUB_MESSAGE_ERROR.] */
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            /* Codes_SRS_IOTHUBMESSAGE_07_021: [IoTHubMessage_SetCorrelationId finishes successfully it shall return IOTHUB_MESSAGE_OK.] */
-            result = IOTHUB_MESSAGE_OK;
+            /* Codes_SRS_IOTHUBMESSAGE_07_019: [If the IOTHUB_MESSAGE_HANDLE correlationId is not NULL, then the IOTHUB_MESSAGE_HANDLE correlationId will be deallocated.] */
+            if (propertiesData->correlationId != NULL)
+            {
+                free(propertiesData->correlationId);
+                propertiesData->correlationId = NULL;
+            }
+
+            if (mallocAndStrcpy_s(&propertiesData->correlationId, correlationId) != 0)
+            {
+                /* Codes_SRS_IOTHUBMESSAGE_07_020: [If the allocation or the copying of the correlationId fails, then IoTHubMessage_SetCorrelationId shall return IOTHUB_MESSAGE_ERROR.] */
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                /* Codes_SRS_IOTHUBMESSAGE_07_021: [IoTHubMessage_SetCorrelationId finishes successfully it shall return IOTHUB_MESSAGE_OK.] */
+                result = IOTHUB_MESSAGE_OK;
+            }
         }
     }
     return result;
@@ -583,21 +715,31 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMes
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
-        /* Codes_SRS_IOTHUBMESSAGE_07_013: [If the IOTHUB_MESSAGE_HANDLE messageId is not NULL, then the IOTHUB_MESSAGE_HANDLE messageId will be freed] */
-        if (handleData->messageId != NULL)
-        {
-            free(handleData->messageId);
-            handleData->messageId = NULL;
-        }
+        MESSAGE_PROPERTIES* propertiesData;
 
-        /* Codes_SRS_IOTHUBMESSAGE_07_014: [If the allocation or the copying of the messageId fails, then IoTHubMessage_SetMessageId shall return IOTHUB_MESSAGE_ERROR.] */
-        if (mallocAndStrcpy_s(&handleData->messageId, messageId) != 0)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            result = IOTHUB_MESSAGE_OK;
+            /* Codes_SRS_IOTHUBMESSAGE_07_013: [If the IOTHUB_MESSAGE_HANDLE messageId is not NULL, then the IOTHUB_MESSAGE_HANDLE messageId will be freed] */
+            if (propertiesData->messageId != NULL)
+            {
+                free(propertiesData->messageId);
+                propertiesData->messageId = NULL;
+            }
+
+            /* Codes_SRS_IOTHUBMESSAGE_07_014: [If the allocation or the copying of the messageId fails, then IoTHubMessage_SetMessageId shall return IOTHUB_MESSAGE_ERROR.] */
+            if (mallocAndStrcpy_s(&propertiesData->messageId, messageId) != 0)
+            {
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_MESSAGE_OK;
+            }
         }
     }
     return result;
@@ -616,7 +758,7 @@ const char* IoTHubMessage_GetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle
     {
         /* Codes_SRS_IOTHUBMESSAGE_07_011: [IoTHubMessage_MessageId shall return the messageId as a const char*.] */
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
-        result = handleData->messageId;
+        result = handleData->propertiesData->messageId;
     }
     return result;
 }
@@ -634,24 +776,33 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentTypeSystemProperty(IOTHUB_MESSAGE_
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_09_002: [If the IOTHUB_MESSAGE_HANDLE `contentType` is not NULL it shall be deallocated.]
-        if (handleData->userDefinedContentType != NULL)
-        {
-            free(handleData->userDefinedContentType);
-            handleData->userDefinedContentType = NULL;
-        }
-
-        if (mallocAndStrcpy_s(&handleData->userDefinedContentType, contentType) != 0)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            LogError("Failed saving a copy of contentType");
-            // Codes_SRS_IOTHUBMESSAGE_09_003: [If the allocation or the copying of `contentType` fails, then IoTHubMessage_SetContentTypeSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_09_004: [If IoTHubMessage_SetContentTypeSystemProperty finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
+            // Codes_SRS_IOTHUBMESSAGE_09_002: [If the IOTHUB_MESSAGE_HANDLE `contentType` is not NULL it shall be deallocated.]
+            if (propertiesData->userDefinedContentType != NULL)
+            {
+                free(propertiesData->userDefinedContentType);
+                propertiesData->userDefinedContentType = NULL;
+            }
+
+            if (mallocAndStrcpy_s(&propertiesData->userDefinedContentType, contentType) != 0)
+            {
+                LogError("Failed saving a copy of contentType");
+                // Codes_SRS_IOTHUBMESSAGE_09_003: [If the allocation or the copying of `contentType` fails, then IoTHubMessage_SetContentTypeSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_09_004: [If IoTHubMessage_SetContentTypeSystemProperty finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
         }
     }
 
@@ -673,7 +824,7 @@ const char* IoTHubMessage_GetContentTypeSystemProperty(IOTHUB_MESSAGE_HANDLE iot
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
 
         // Codes_SRS_IOTHUBMESSAGE_09_006: [IoTHubMessage_GetContentTypeSystemProperty shall return the `contentType` as a const char* ]
-        result = (const char*)handleData->userDefinedContentType;
+        result = (const char*)handleData->propertiesData->userDefinedContentType;
     }
 
     return result;
@@ -692,24 +843,33 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentEncodingSystemProperty(IOTHUB_MESS
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_09_007: [If the IOTHUB_MESSAGE_HANDLE `contentEncoding` is not NULL it shall be deallocated.]
-        if (handleData->contentEncoding != NULL)
-        {
-            free(handleData->contentEncoding);
-            handleData->contentEncoding = NULL;
-        }
-
-        if (mallocAndStrcpy_s(&handleData->contentEncoding, contentEncoding) != 0)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            LogError("Failed saving a copy of contentEncoding");
-            // Codes_SRS_IOTHUBMESSAGE_09_008: [If the allocation or the copying of `contentEncoding` fails, then IoTHubMessage_SetContentEncodingSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_09_009: [If IoTHubMessage_SetContentEncodingSystemProperty finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
+            // Codes_SRS_IOTHUBMESSAGE_09_007: [If the IOTHUB_MESSAGE_HANDLE `contentEncoding` is not NULL it shall be deallocated.]
+            if (propertiesData->contentEncoding != NULL)
+            {
+                free(propertiesData->contentEncoding);
+                propertiesData->contentEncoding = NULL;
+            }
+
+            if (mallocAndStrcpy_s(&propertiesData->contentEncoding, contentEncoding) != 0)
+            {
+                LogError("Failed saving a copy of contentEncoding");
+                // Codes_SRS_IOTHUBMESSAGE_09_008: [If the allocation or the copying of `contentEncoding` fails, then IoTHubMessage_SetContentEncodingSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_09_009: [If IoTHubMessage_SetContentEncodingSystemProperty finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
         }
     }
 
@@ -731,7 +891,7 @@ const char* IoTHubMessage_GetContentEncodingSystemProperty(IOTHUB_MESSAGE_HANDLE
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
 
         // Codes_SRS_IOTHUBMESSAGE_09_011: [IoTHubMessage_GetContentEncodingSystemProperty shall return the `contentEncoding` as a const char* ]
-        result = (const char*)handleData->contentEncoding;
+        result = (const char*)handleData->propertiesData->contentEncoding;
     }
 
     return result;
@@ -749,7 +909,7 @@ const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* IoTHubMessage_GetDiagnosticProper
     else
     {
         /* Codes_SRS_IOTHUBMESSAGE_10_002: [IoTHubMessage_GetDiagnosticPropertyData shall return the diagnosticData as a const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA*.] */
-        result = iotHubMessageHandle->diagnosticData;
+        result = iotHubMessageHandle->propertiesData->diagnosticData;
     }
     return result;
 }
@@ -771,23 +931,33 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetDiagnosticPropertyData(IOTHUB_MESSAGE_HAN
     }
     else
     {
-        // Codes_SRS_IOTHUBMESSAGE_10_004: [If the IOTHUB_MESSAGE_HANDLE `diagnosticData` is not NULL it shall be deallocated.]
-        if (iotHubMessageHandle->diagnosticData != NULL)
-        {
-            DestroyDiagnosticPropertyData(iotHubMessageHandle->diagnosticData);
-            iotHubMessageHandle->diagnosticData = NULL;
-        }
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_10_005: [If the allocation or the copying of `diagnosticData` fails, then IoTHubMessage_SetDiagnosticPropertyData shall return IOTHUB_MESSAGE_ERROR.]
-        if ((iotHubMessageHandle->diagnosticData = CloneDiagnosticPropertyData(diagnosticData)) == NULL)
+        if ((propertiesData = GetWritableProperties(iotHubMessageHandle)) == NULL)
         {
-            LogError("Failed saving a copy of diagnosticData");
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_10_006: [If IoTHubMessage_SetDiagnosticPropertyData finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
+            // Codes_SRS_IOTHUBMESSAGE_10_004: [If the IOTHUB_MESSAGE_HANDLE `diagnosticData` is not NULL it shall be deallocated.]
+            if (propertiesData->diagnosticData != NULL)
+            {
+                DestroyDiagnosticPropertyData(propertiesData->diagnosticData);
+                propertiesData->diagnosticData = NULL;
+            }
+
+            // Codes_SRS_IOTHUBMESSAGE_10_005: [If the allocation or the copying of `diagnosticData` fails, then IoTHubMessage_SetDiagnosticPropertyData shall return IOTHUB_MESSAGE_ERROR.]
+            if ((propertiesData->diagnosticData = CloneDiagnosticPropertyData(diagnosticData)) == NULL)
+            {
+                LogError("Failed saving a copy of diagnosticData");
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_10_006: [If IoTHubMessage_SetDiagnosticPropertyData finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
         }
     }
     return result;
@@ -806,7 +976,7 @@ const char* IoTHubMessage_GetOutputName(IOTHUB_MESSAGE_HANDLE iotHubMessageHandl
     else
     {
         // Codes_SRS_IOTHUBMESSAGE_31_035: [IoTHubMessage_GetOutputName shall return the OutputName as a const char*.]
-        result = iotHubMessageHandle->outputName;
+        result = iotHubMessageHandle->propertiesData->outputName;
     }
     return result;
 }
@@ -824,26 +994,34 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetOutputName(IOTHUB_MESSAGE_HANDLE iotHubMe
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_31_037: [If the IOTHUB_MESSAGE_HANDLE OutputName is not NULL, then the IOTHUB_MESSAGE_HANDLE OutputName will be deallocated.]
-        if (handleData->outputName != NULL)
-        {
-            free(handleData->outputName);
-            handleData->outputName = NULL;
-        }
-
-        if (mallocAndStrcpy_s(&handleData->outputName, outputName) != 0)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            // Codes_SRS_IOTHUBMESSAGE_31_038: [If the allocation or the copying of the OutputName fails, then IoTHubMessage_SetOutputName shall return IOTHUB_MESSAGE_ERROR.]
-            LogError("Failed saving a copy of outputName");
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_31_039: [IoTHubMessage_SetOutputName finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
-        }
+            // Codes_SRS_IOTHUBMESSAGE_31_037: [If the IOTHUB_MESSAGE_HANDLE OutputName is not NULL, then the IOTHUB_MESSAGE_HANDLE OutputName will be deallocated.]
+            if (propertiesData->outputName != NULL)
+            {
+                free(propertiesData->outputName);
+                propertiesData->outputName = NULL;
+            }
 
+            if (mallocAndStrcpy_s(&propertiesData->outputName, outputName) != 0)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_038: [If the allocation or the copying of the OutputName fails, then IoTHubMessage_SetOutputName shall return IOTHUB_MESSAGE_ERROR.]
+                LogError("Failed saving a copy of outputName");
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_039: [IoTHubMessage_SetOutputName finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
+        }
     }
 
     return result;
@@ -861,7 +1039,7 @@ const char* IoTHubMessage_GetInputName(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle
     else
     {
         // Codes_SRS_IOTHUBMESSAGE_31_041: [IoTHubMessage_GetInputName shall return the InputName as a const char*.]
-        result = iotHubMessageHandle->inputName;
+        result = iotHubMessageHandle->propertiesData->inputName;
     }
     return result;
 }
@@ -879,26 +1057,34 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetInputName(IOTHUB_MESSAGE_HANDLE iotHubMes
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_31_043: [If the IOTHUB_MESSAGE_HANDLE InputName is not NULL, then the IOTHUB_MESSAGE_HANDLE InputName will be deallocated.]
-        if (handleData->inputName != NULL)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            free(handleData->inputName);
-            handleData->inputName = NULL;
-        }
-
-        if (mallocAndStrcpy_s(&handleData->inputName, inputName) != 0)
-        {
-            // Codes_SRS_IOTHUBMESSAGE_31_044: [If the allocation or the copying of the InputName fails, then IoTHubMessage_SetInputName shall return IOTHUB_MESSAGE_ERROR.]
-            LogError("Failed saving a copy of inputName");
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_31_045: [IoTHubMessage_SetInputName finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
-        }
+            // Codes_SRS_IOTHUBMESSAGE_31_043: [If the IOTHUB_MESSAGE_HANDLE InputName is not NULL, then the IOTHUB_MESSAGE_HANDLE InputName will be deallocated.]
+            if (propertiesData->inputName != NULL)
+            {
+                free(propertiesData->inputName);
+                propertiesData->inputName = NULL;
+            }
 
+            if (mallocAndStrcpy_s(&propertiesData->inputName, inputName) != 0)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_044: [If the allocation or the copying of the InputName fails, then IoTHubMessage_SetInputName shall return IOTHUB_MESSAGE_ERROR.]
+                LogError("Failed saving a copy of inputName");
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_045: [IoTHubMessage_SetInputName finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
+        }
     }
 
     return result;
@@ -917,7 +1103,7 @@ const char* IoTHubMessage_GetConnectionModuleId(IOTHUB_MESSAGE_HANDLE iotHubMess
     else
     {
         // Codes_SRS_IOTHUBMESSAGE_31_047: [IoTHubMessage_GetConnectionModuleId shall return the ConnectionModuleId as a const char*.]
-        result = iotHubMessageHandle->connectionModuleId;
+        result = iotHubMessageHandle->propertiesData->connectionModuleId;
     }
     return result;
 }
@@ -935,26 +1121,34 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetConnectionModuleId(IOTHUB_MESSAGE_HANDLE
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_31_049: [If the IOTHUB_MESSAGE_HANDLE ConnectionModuleId is not NULL, then the IOTHUB_MESSAGE_HANDLE ConnectionModuleId will be deallocated.]
-        if (handleData->connectionModuleId != NULL)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            free(handleData->connectionModuleId);
-            handleData->connectionModuleId = NULL;
-        }
-
-        if (mallocAndStrcpy_s(&handleData->connectionModuleId, connectionModuleId) != 0)
-        {
-            // Codes_SRS_IOTHUBMESSAGE_31_050: [If the allocation or the copying of the ConnectionModuleId fails, then IoTHubMessage_SetConnectionModuleId shall return IOTHUB_MESSAGE_ERROR.]
-            LogError("Failed saving a copy of connectionModuleId");
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_31_051: [IoTHubMessage_SetConnectionModuleId finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
-        }
+            // Codes_SRS_IOTHUBMESSAGE_31_049: [If the IOTHUB_MESSAGE_HANDLE ConnectionModuleId is not NULL, then the IOTHUB_MESSAGE_HANDLE ConnectionModuleId will be deallocated.]
+            if (propertiesData->connectionModuleId != NULL)
+            {
+                free(propertiesData->connectionModuleId);
+                propertiesData->connectionModuleId = NULL;
+            }
 
+            if (mallocAndStrcpy_s(&propertiesData->connectionModuleId, connectionModuleId) != 0)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_050: [If the allocation or the copying of the ConnectionModuleId fails, then IoTHubMessage_SetConnectionModuleId shall return IOTHUB_MESSAGE_ERROR.]
+                LogError("Failed saving a copy of connectionModuleId");
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_051: [IoTHubMessage_SetConnectionModuleId finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
+        }
     }
 
     return result;
@@ -973,7 +1167,7 @@ const char* IoTHubMessage_GetConnectionDeviceId(IOTHUB_MESSAGE_HANDLE iotHubMess
     else
     {
         // Codes_SRS_IOTHUBMESSAGE_31_053: [IoTHubMessage_GetConnectionDeviceId shall return the ConnectionDeviceId as a const char*.]
-        result = iotHubMessageHandle->connectionDeviceId;
+        result = iotHubMessageHandle->propertiesData->connectionDeviceId;
     }
     return result;
 }
@@ -991,26 +1185,34 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetConnectionDeviceId(IOTHUB_MESSAGE_HANDLE
     else
     {
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        MESSAGE_PROPERTIES* propertiesData;
 
-        // Codes_SRS_IOTHUBMESSAGE_31_055: [If the IOTHUB_MESSAGE_HANDLE ConnectionDeviceId is not NULL, then the IOTHUB_MESSAGE_HANDLE ConnectionDeviceId will be deallocated.]
-        if (handleData->connectionDeviceId != NULL)
-        {
-            free(handleData->connectionDeviceId);
-            handleData->connectionDeviceId = NULL;
-        }
-
-        if (mallocAndStrcpy_s(&handleData->connectionDeviceId, connectionDeviceId) != 0)
+        if ((propertiesData = GetWritableProperties(handleData)) == NULL)
         {
-            // Codes_SRS_IOTHUBMESSAGE_31_056: [If the allocation or the copying of the ConnectionDeviceId fails, then IoTHubMessage_SetConnectionDeviceId shall return IOTHUB_MESSAGE_ERROR.]
-            LogError("Failed saving a copy of connectionDeviceId");
+            LogError("unable to get a private copy of the message properties");
             result = IOTHUB_MESSAGE_ERROR;
         }
         else
         {
-            // Codes_SRS_IOTHUBMESSAGE_31_057: [IoTHubMessage_SetConnectionDeviceId finishes successfully it shall return IOTHUB_MESSAGE_OK.]
-            result = IOTHUB_MESSAGE_OK;
-        }
+            // Codes_SRS_IOTHUBMESSAGE_31_055: [If the IOTHUB_MESSAGE_HANDLE ConnectionDeviceId is not NULL, then the IOTHUB_MESSAGE_HANDLE ConnectionDeviceId will be deallocated.]
+            if (propertiesData->connectionDeviceId != NULL)
+            {
+                free(propertiesData->connectionDeviceId);
+                propertiesData->connectionDeviceId = NULL;
+            }
 
+            if (mallocAndStrcpy_s(&propertiesData->connectionDeviceId, connectionDeviceId) != 0)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_056: [If the allocation or the copying of the ConnectionDeviceId fails, then IoTHubMessage_SetConnectionDeviceId shall return IOTHUB_MESSAGE_ERROR.]
+                LogError("Failed saving a copy of connectionDeviceId");
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBMESSAGE_31_057: [IoTHubMessage_SetConnectionDeviceId finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+                result = IOTHUB_MESSAGE_OK;
+            }
+        }
     }
 
     return result;
@@ -0,0 +1,786 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+
+#include "iothub_twin_parser.h"
+
+/* Registered paths are at most this long, so the path of the value being parsed is kept in a
+   buffer of this size; a member whose path does not fit cannot be registered and is skipped. */
+#define MAX_PATH_LENGTH         256
+#define MAX_DEPTH               16
+#define MAX_NUMBER_LENGTH       32
+#define DESIRED_PATH            "/desired"
+
+#define PATH_MATCH_NONE         0x00
+#define PATH_MATCH_EXACT        0x01
+#define PATH_MATCH_BELOW        0x02
+
+typedef struct TWIN_PROPERTY_REGISTRATION_TAG
+{
+    char* path;
+    size_t path_length;
+    IOTHUB_TWIN_PROPERTY_TYPE type;
+    IOTHUB_TWIN_PROPERTY_CALLBACK callback;
+    void* context;
+} TWIN_PROPERTY_REGISTRATION;
+
+typedef struct IOTHUB_TWIN_PARSER_TAG
+{
+    TWIN_PROPERTY_REGISTRATION* registrations;
+    size_t registration_count;
+    char* string_buffer;
+    size_t string_buffer_size;
+
+    // Parse state
+    const char* position;
+    const char* end;
+    char path[MAX_PATH_LENGTH + 1];
+} IOTHUB_TWIN_PARSER;
+
+static void skip_whitespace(IOTHUB_TWIN_PARSER* parser)
+{
+    while (parser->position < parser->end &&
+        (*parser->position == ' ' || *parser->position == '\t' || *parser->position == '\n' || *parser->position == '\r'))
+    {
+        parser->position++;
+    }
+}
+
+static int hex_value(char c)
+{
+    int result;
+    if (c >= '0' && c <= '9')
+    {
+        result = c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        result = c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        result = c - 'A' + 10;
+    }
+    else
+    {
+        result = -1;
+    }
+    return result;
+}
+
+static int read_hex4(IOTHUB_TWIN_PARSER* parser, unsigned long* code_point)
+{
+    int result = 0;
+    size_t index;
+    *code_point = 0;
+    if (parser->end - parser->position < 4)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        for (index = 0; index < 4; index++)
+        {
+            int digit = hex_value(parser->position[index]);
+            if (digit < 0)
+            {
+                result = __FAILURE__;
+                break;
+            }
+            *code_point = (*code_point << 4) | (unsigned long)digit;
+        }
+        parser->position += 4;
+    }
+    return result;
+}
+
+/* Appends a character to buffer while it fits; length keeps counting past the end of the buffer
+   so that the caller can tell that the string was too long. */
+static void append_char(char* buffer, size_t buffer_size, size_t* length, char c)
+{
+    if (buffer != NULL && *length < buffer_size)
+    {
+        buffer[*length] = c;
+    }
+    (*length)++;
+}
+
+static void append_decoded_char(char* buffer, size_t buffer_size, size_t* length, char c, bool pointer_escape)
+{
+    // A member name becomes a JSON pointer segment, in which '~' and '/' are escaped
+    if (pointer_escape && c == '~')
+    {
+        append_char(buffer, buffer_size, length, '~');
+        append_char(buffer, buffer_size, length, '0');
+    }
+    else if (pointer_escape && c == '/')
+    {
+        append_char(buffer, buffer_size, length, '~');
+        append_char(buffer, buffer_size, length, '1');
+    }
+    else
+    {
+        append_char(buffer, buffer_size, length, c);
+    }
+}
+
+static void append_utf8(char* buffer, size_t buffer_size, size_t* length, unsigned long code_point)
+{
+    if (code_point < 0x80)
+    {
+        append_char(buffer, buffer_size, length, (char)code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        append_char(buffer, buffer_size, length, (char)(0xC0 | (code_point >> 6)));
+        append_char(buffer, buffer_size, length, (char)(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        append_char(buffer, buffer_size, length, (char)(0xE0 | (code_point >> 12)));
+        append_char(buffer, buffer_size, length, (char)(0x80 | ((code_point >> 6) & 0x3F)));
+        append_char(buffer, buffer_size, length, (char)(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        append_char(buffer, buffer_size, length, (char)(0xF0 | (code_point >> 18)));
+        append_char(buffer, buffer_size, length, (char)(0x80 | ((code_point >> 12) & 0x3F)));
+        append_char(buffer, buffer_size, length, (char)(0x80 | ((code_point >> 6) & 0x3F)));
+        append_char(buffer, buffer_size, length, (char)(0x80 | (code_point & 0x3F)));
+    }
+}
+
+/* Reads the string starting at the opening quote, unescaping it into buffer (which may be NULL to
+   only skip it). length is the unescaped length, even when that did not fit in buffer_size. */
+static int read_string(IOTHUB_TWIN_PARSER* parser, char* buffer, size_t buffer_size, bool pointer_escape, size_t* length)
+{
+    int result = __FAILURE__;
+    *length = 0;
+    parser->position++;
+    while (parser->position < parser->end)
+    {
+        char c = *parser->position++;
+        if (c == '"')
+        {
+            result = 0;
+            break;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            break;
+        }
+        else if (c != '\\')
+        {
+            append_decoded_char(buffer, buffer_size, length, c, pointer_escape);
+        }
+        else if (parser->position == parser->end)
+        {
+            break;
+        }
+        else
+        {
+            char escaped = *parser->position++;
+            if (escaped == 'u')
+            {
+                unsigned long code_point;
+                if (read_hex4(parser, &code_point) != 0)
+                {
+                    break;
+                }
+                if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                {
+                    unsigned long low_surrogate;
+                    if (parser->end - parser->position < 2 || parser->position[0] != '\\' || parser->position[1] != 'u')
+                    {
+                        break;
+                    }
+                    parser->position += 2;
+                    if (read_hex4(parser, &low_surrogate) != 0 || low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+                    {
+                        break;
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                }
+                else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+                {
+                    break;
+                }
+
+                if (code_point < 0x80)
+                {
+                    append_decoded_char(buffer, buffer_size, length, (char)code_point, pointer_escape);
+                }
+                else
+                {
+                    append_utf8(buffer, buffer_size, length, code_point);
+                }
+            }
+            else
+            {
+                char decoded;
+                switch (escaped)
+                {
+                    case '"': decoded = '"'; break;
+                    case '\\': decoded = '\\'; break;
+                    case '/': decoded = '/'; break;
+                    case 'b': decoded = '\b'; break;
+                    case 'f': decoded = '\f'; break;
+                    case 'n': decoded = '\n'; break;
+                    case 'r': decoded = '\r'; break;
+                    case 't': decoded = '\t'; break;
+                    default: decoded = '\0'; break;
+                }
+                if (decoded == '\0')
+                {
+                    break;
+                }
+                append_decoded_char(buffer, buffer_size, length, decoded, pointer_escape);
+            }
+        }
+    }
+
+    if (result != 0)
+    {
+        LogError("Malformed JSON string");
+    }
+    return result;
+}
+
+static bool is_scalar_char(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+}
+
+/* Finds the end of a value nobody registered for; it is only checked for balanced brackets and
+   well formed strings. */
+static int skip_value(IOTHUB_TWIN_PARSER* parser)
+{
+    int result = 0;
+    size_t depth = 0;
+    do
+    {
+        skip_whitespace(parser);
+        if (parser->position == parser->end)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            char c = *parser->position;
+            size_t length;
+            if (c == '"')
+            {
+                result = read_string(parser, NULL, 0, false, &length);
+            }
+            else if (c == '{' || c == '[')
+            {
+                depth++;
+                parser->position++;
+            }
+            else if (c == '}' || c == ']' || c == ',' || c == ':')
+            {
+                if (depth == 0)
+                {
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    if (c == '}' || c == ']')
+                    {
+                        depth--;
+                    }
+                    parser->position++;
+                }
+            }
+            else if (!is_scalar_char(c))
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                while (parser->position < parser->end && is_scalar_char(*parser->position))
+                {
+                    parser->position++;
+                }
+            }
+        }
+    } while (result == 0 && depth > 0);
+
+    if (result != 0)
+    {
+        LogError("Malformed JSON value");
+    }
+    return result;
+}
+
+static int get_path_match(const IOTHUB_TWIN_PARSER* parser, size_t path_length)
+{
+    int result = PATH_MATCH_NONE;
+    size_t index;
+    for (index = 0; index < parser->registration_count; index++)
+    {
+        const TWIN_PROPERTY_REGISTRATION* registration = &parser->registrations[index];
+        if (registration->path_length >= path_length && memcmp(registration->path, parser->path, path_length) == 0)
+        {
+            if (registration->path_length == path_length)
+            {
+                result |= PATH_MATCH_EXACT;
+            }
+            else if (registration->path[path_length] == '/')
+            {
+                result |= PATH_MATCH_BELOW;
+            }
+        }
+    }
+    return result;
+}
+
+static void dispatch_value(const IOTHUB_TWIN_PARSER* parser, size_t path_length, const IOTHUB_TWIN_PROPERTY_VALUE* value, const char* json, size_t json_length)
+{
+    size_t index;
+    for (index = 0; index < parser->registration_count; index++)
+    {
+        const TWIN_PROPERTY_REGISTRATION* registration = &parser->registrations[index];
+        if (registration->path_length == path_length && memcmp(registration->path, parser->path, path_length) == 0)
+        {
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_013: [ A null value shall be given to every callback registered for its path, whatever type they were registered for. ] */
+            if (value->type == IOTHUB_TWIN_PROPERTY_NULL)
+            {
+                registration->callback(registration->path, value, registration->context);
+            }
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_014: [ A callback registered for IOTHUB_TWIN_PROPERTY_JSON shall be given the JSON text of the value, whatever its type. ] */
+            else if (registration->type == IOTHUB_TWIN_PROPERTY_JSON)
+            {
+                IOTHUB_TWIN_PROPERTY_VALUE json_value;
+                json_value.type = IOTHUB_TWIN_PROPERTY_JSON;
+                json_value.value.json.value = json;
+                json_value.value.json.length = json_length;
+                registration->callback(registration->path, &json_value, registration->context);
+            }
+            else if (registration->type == value->type)
+            {
+                registration->callback(registration->path, value, registration->context);
+            }
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_015: [ Callbacks registered for another type than the one of the value shall not be called. ] */
+        }
+    }
+}
+
+static int read_literal(IOTHUB_TWIN_PARSER* parser, const char* literal)
+{
+    int result;
+    size_t length = strlen(literal);
+    if ((size_t)(parser->end - parser->position) < length || memcmp(parser->position, literal, length) != 0)
+    {
+        LogError("Malformed JSON literal");
+        result = __FAILURE__;
+    }
+    else
+    {
+        parser->position += length;
+        result = 0;
+    }
+    return result;
+}
+
+static int read_number(IOTHUB_TWIN_PARSER* parser, double* number)
+{
+    int result;
+    char text[MAX_NUMBER_LENGTH + 1];
+    size_t length = 0;
+    char* number_end;
+    while (parser->position < parser->end && length < MAX_NUMBER_LENGTH &&
+        ((*parser->position >= '0' && *parser->position <= '9') || *parser->position == '-' || *parser->position == '+' ||
+        *parser->position == '.' || *parser->position == 'e' || *parser->position == 'E'))
+    {
+        text[length++] = *parser->position++;
+    }
+    text[length] = '\0';
+
+    *number = strtod(text, &number_end);
+    if (length == 0 || number_end != text + length)
+    {
+        LogError("Malformed JSON number");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static int parse_value(IOTHUB_TWIN_PARSER* parser, size_t path_length, size_t depth);
+
+/* A member whose path does not fit MAX_PATH_LENGTH gets this length, which no registration has */
+#define PATH_TOO_LONG   (MAX_PATH_LENGTH + 1)
+
+static int parse_object(IOTHUB_TWIN_PARSER* parser, size_t path_length, size_t depth)
+{
+    int result = 0;
+    parser->position++;
+    skip_whitespace(parser);
+    if (parser->position < parser->end && *parser->position == '}')
+    {
+        parser->position++;
+    }
+    else
+    {
+        while (result == 0)
+        {
+            size_t key_length;
+            size_t member_path_length;
+
+            skip_whitespace(parser);
+            if (parser->position == parser->end || *parser->position != '"')
+            {
+                LogError("Expected a member name");
+                result = __FAILURE__;
+                break;
+            }
+
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_016: [ Member names shall be matched against the registered paths with '~' and '/' escaped as "~0" and "~1". ] */
+            if (path_length < MAX_PATH_LENGTH)
+            {
+                parser->path[path_length] = '/';
+                result = read_string(parser, parser->path + path_length + 1, MAX_PATH_LENGTH - path_length - 1, true, &key_length);
+                member_path_length = (key_length < MAX_PATH_LENGTH - path_length) ? path_length + 1 + key_length : PATH_TOO_LONG;
+            }
+            else
+            {
+                result = read_string(parser, NULL, 0, true, &key_length);
+                member_path_length = PATH_TOO_LONG;
+            }
+            if (result != 0)
+            {
+                break;
+            }
+
+            skip_whitespace(parser);
+            if (parser->position == parser->end || *parser->position != ':')
+            {
+                LogError("Expected ':' after a member name");
+                result = __FAILURE__;
+                break;
+            }
+            parser->position++;
+
+            if ((result = parse_value(parser, member_path_length, depth)) != 0)
+            {
+                break;
+            }
+
+            skip_whitespace(parser);
+            if (parser->position < parser->end && *parser->position == ',')
+            {
+                parser->position++;
+            }
+            else if (parser->position < parser->end && *parser->position == '}')
+            {
+                parser->position++;
+                break;
+            }
+            else
+            {
+                LogError("Expected ',' or '}' in an object");
+                result = __FAILURE__;
+            }
+        }
+    }
+    return result;
+}
+
+static int parse_array(IOTHUB_TWIN_PARSER* parser, size_t path_length, size_t depth)
+{
+    int result = 0;
+    parser->position++;
+    skip_whitespace(parser);
+    if (parser->position < parser->end && *parser->position == ']')
+    {
+        parser->position++;
+    }
+    else
+    {
+        unsigned long index = 0;
+        while (result == 0)
+        {
+            size_t element_path_length = PATH_TOO_LONG;
+            if (path_length < MAX_PATH_LENGTH)
+            {
+                /* Codes_SRS_IOTHUB_TWIN_PARSER_01_017: [ Array elements shall be matched with their zero based index as the last segment of the path. ] */
+                int written = snprintf(parser->path + path_length, MAX_PATH_LENGTH + 1 - path_length, "/%lu", index);
+                if (written > 0 && (size_t)written <= MAX_PATH_LENGTH - path_length)
+                {
+                    element_path_length = path_length + (size_t)written;
+                }
+            }
+
+            if ((result = parse_value(parser, element_path_length, depth)) != 0)
+            {
+                break;
+            }
+            index++;
+
+            skip_whitespace(parser);
+            if (parser->position < parser->end && *parser->position == ',')
+            {
+                parser->position++;
+            }
+            else if (parser->position < parser->end && *parser->position == ']')
+            {
+                parser->position++;
+                break;
+            }
+            else
+            {
+                LogError("Expected ',' or ']' in an array");
+                result = __FAILURE__;
+            }
+        }
+    }
+    return result;
+}
+
+static int parse_value(IOTHUB_TWIN_PARSER* parser, size_t path_length, size_t depth)
+{
+    int result;
+    int match = (path_length == PATH_TOO_LONG) ? PATH_MATCH_NONE : get_path_match(parser, path_length);
+
+    skip_whitespace(parser);
+    if (parser->position == parser->end)
+    {
+        LogError("Unexpected end of the payload");
+        result = __FAILURE__;
+    }
+    else if (match == PATH_MATCH_NONE)
+    {
+        /* Codes_SRS_IOTHUB_TWIN_PARSER_01_018: [ Values that no registered path is at or below shall be skipped without being decoded. ] */
+        result = skip_value(parser);
+    }
+    else
+    {
+        const char* start = parser->position;
+        char c = *parser->position;
+        IOTHUB_TWIN_PROPERTY_VALUE value;
+        value.type = IOTHUB_TWIN_PROPERTY_JSON;
+
+        if (c == '{' || c == '[')
+        {
+            if ((match & PATH_MATCH_BELOW) == 0)
+            {
+                result = skip_value(parser);
+            }
+            else if (depth >= MAX_DEPTH)
+            {
+                /* Codes_SRS_IOTHUB_TWIN_PARSER_01_019: [ If the objects and arrays leading to a registered path are nested more than 16 deep, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+                LogError("JSON nested too deep");
+                result = __FAILURE__;
+            }
+            else if (c == '{')
+            {
+                result = parse_object(parser, path_length, depth + 1);
+            }
+            else
+            {
+                result = parse_array(parser, path_length, depth + 1);
+            }
+        }
+        else if ((match & PATH_MATCH_EXACT) == 0)
+        {
+            result = skip_value(parser);
+        }
+        else if (c == '"')
+        {
+            size_t length;
+            if ((result = read_string(parser, parser->string_buffer, parser->string_buffer_size, false, &length)) == 0)
+            {
+                if (length >= parser->string_buffer_size)
+                {
+                    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_020: [ If a registered string value is longer than max_string_length once unescaped, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+                    LogError("String value of %lu bytes is longer than the buffer of %lu bytes", (unsigned long)length, (unsigned long)(parser->string_buffer_size - 1));
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    parser->string_buffer[length] = '\0';
+                    value.type = IOTHUB_TWIN_PROPERTY_STRING;
+                    value.value.string.value = parser->string_buffer;
+                    value.value.string.length = length;
+                }
+            }
+        }
+        else if (c == 't' || c == 'f')
+        {
+            value.type = IOTHUB_TWIN_PROPERTY_BOOLEAN;
+            value.value.boolean = (c == 't');
+            result = read_literal(parser, value.value.boolean ? "true" : "false");
+        }
+        else if (c == 'n')
+        {
+            value.type = IOTHUB_TWIN_PROPERTY_NULL;
+            result = read_literal(parser, "null");
+        }
+        else
+        {
+            value.type = IOTHUB_TWIN_PROPERTY_NUMBER;
+            result = read_number(parser, &value.value.number);
+        }
+
+        if (result == 0 && (match & PATH_MATCH_EXACT) != 0)
+        {
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_012: [ For every value whose path is registered, IoTHubTwinParser_Parse shall call the callbacks registered for it with the path as registered, the value and the context. ] */
+            dispatch_value(parser, path_length, &value, start, (size_t)(parser->position - start));
+        }
+    }
+    return result;
+}
+
+IOTHUB_TWIN_PARSER_HANDLE IoTHubTwinParser_Create(size_t max_string_length)
+{
+    IOTHUB_TWIN_PARSER* result;
+    if (max_string_length == 0)
+    {
+        /* Codes_SRS_IOTHUB_TWIN_PARSER_01_001: [ If max_string_length is 0, IoTHubTwinParser_Create shall fail and return NULL. ] */
+        LogError("Invalid argument max_string_length 0");
+        result = NULL;
+    }
+    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_002: [ IoTHubTwinParser_Create shall allocate the parser and a buffer of max_string_length + 1 bytes for the string values, and return a non-NULL handle. ] */
+    else if ((result = (IOTHUB_TWIN_PARSER*)malloc(sizeof(IOTHUB_TWIN_PARSER))) == NULL)
+    {
+        /* Codes_SRS_IOTHUB_TWIN_PARSER_01_003: [ If any allocation fails, IoTHubTwinParser_Create shall fail and return NULL. ] */
+        LogError("Failed allocating the twin parser");
+    }
+    else
+    {
+        memset(result, 0, sizeof(IOTHUB_TWIN_PARSER));
+        result->string_buffer_size = max_string_length + 1;
+        if ((result->string_buffer = (char*)malloc(result->string_buffer_size)) == NULL)
+        {
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_003: [ If any allocation fails, IoTHubTwinParser_Create shall fail and return NULL. ] */
+            LogError("Failed allocating the string buffer");
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+void IoTHubTwinParser_Destroy(IOTHUB_TWIN_PARSER_HANDLE parser)
+{
+    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_004: [ If parser is NULL, IoTHubTwinParser_Destroy shall do nothing. ] */
+    if (parser != NULL)
+    {
+        /* Codes_SRS_IOTHUB_TWIN_PARSER_01_005: [ IoTHubTwinParser_Destroy shall free the registrations, the string buffer and the parser. ] */
+        size_t index;
+        for (index = 0; index < parser->registration_count; index++)
+        {
+            free(parser->registrations[index].path);
+        }
+        free(parser->registrations);
+        free(parser->string_buffer);
+        free(parser);
+    }
+}
+
+int IoTHubTwinParser_Register(IOTHUB_TWIN_PARSER_HANDLE parser, const char* path, IOTHUB_TWIN_PROPERTY_TYPE type, IOTHUB_TWIN_PROPERTY_CALLBACK callback, void* context)
+{
+    int result;
+    size_t path_length;
+    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_006: [ If parser, path or callback is NULL, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+    if (parser == NULL || path == NULL || callback == NULL)
+    {
+        LogError("Invalid argument parser: %p, path: %p, callback: %p", parser, path, callback);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_007: [ If path does not start with '/' or is longer than 256 characters, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+    else if (path[0] != '/' || (path_length = strlen(path)) > MAX_PATH_LENGTH)
+    {
+        LogError("Invalid JSON pointer %s", path);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_008: [ If type is not a IOTHUB_TWIN_PROPERTY_TYPE value, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+    else if ((int)type < (int)IOTHUB_TWIN_PROPERTY_STRING || (int)type > (int)IOTHUB_TWIN_PROPERTY_JSON)
+    {
+        LogError("Invalid property type %d", (int)type);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_TWIN_PARSER_01_009: [ IoTHubTwinParser_Register shall add a copy of path, with type, callback and context, to the registrations and return 0. ] */
+        TWIN_PROPERTY_REGISTRATION* registrations = (TWIN_PROPERTY_REGISTRATION*)realloc(parser->registrations, (parser->registration_count + 1) * sizeof(TWIN_PROPERTY_REGISTRATION));
+        if (registrations == NULL)
+        {
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_010: [ If any allocation fails, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+            LogError("Failed allocating the registration");
+            result = __FAILURE__;
+        }
+        else
+        {
+            TWIN_PROPERTY_REGISTRATION* registration = &registrations[parser->registration_count];
+            parser->registrations = registrations;
+            if (mallocAndStrcpy_s(&registration->path, path) != 0)
+            {
+                /* Codes_SRS_IOTHUB_TWIN_PARSER_01_010: [ If any allocation fails, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+                LogError("Failed copying the path");
+                result = __FAILURE__;
+            }
+            else
+            {
+                registration->path_length = path_length;
+                registration->type = type;
+                registration->callback = callback;
+                registration->context = context;
+                parser->registration_count++;
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+int IoTHubTwinParser_Parse(IOTHUB_TWIN_PARSER_HANDLE parser, DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payload, size_t size)
+{
+    int result;
+    /* Codes_SRS_IOTHUB_TWIN_PARSER_01_011: [ If parser or payload is NULL, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+    if (parser == NULL || payload == NULL)
+    {
+        LogError("Invalid argument parser: %p, payload: %p", parser, payload);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t path_length;
+        parser->position = (const char*)payload;
+        parser->end = parser->position + size;
+        if (update_state == DEVICE_TWIN_UPDATE_PARTIAL)
+        {
+            /* Codes_SRS_IOTHUB_TWIN_PARSER_01_021: [ For DEVICE_TWIN_UPDATE_PARTIAL the members of the payload shall be matched as if they were under "/desired". ] */
+            path_length = sizeof(DESIRED_PATH) - 1;
+            (void)memcpy(parser->path, DESIRED_PATH, path_length);
+        }
+        else
+        {
+            path_length = 0;
+        }
+
+        /* Codes_SRS_IOTHUB_TWIN_PARSER_01_022: [ IoTHubTwinParser_Parse shall read the payload once, without allocating memory. ] */
+        if ((result = parse_value(parser, path_length, 0)) == 0)
+        {
+            skip_whitespace(parser);
+            if (parser->position != parser->end)
+            {
+                /* Codes_SRS_IOTHUB_TWIN_PARSER_01_023: [ If the payload is not one JSON value, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+                LogError("Unexpected data after the JSON value");
+                result = __FAILURE__;
+            }
+        }
+    }
+    return result;
+}
@@ -46,6 +46,8 @@
 #define RESEND_TIMEOUT_VALUE_MIN            1*60
 #define MAX_SEND_RECOUNT_LIMIT              2
 #define DEFAULT_CONNECTION_INTERVAL         30
+#define DEFAULT_TELEMETRY_INFLIGHT_WINDOW   16
+#define MAX_TELEMETRY_INFLIGHT_WINDOW       1024
 #define FAILED_CONN_BACKOFF_VALUE           5
 #define STATUS_CODE_FAILURE_VALUE           500
 #define STATUS_CODE_TIMEOUT_VALUE           408
@@ -53,6 +55,9 @@
 #define DEFAULT_RETRY_POLICY                IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER
 #define DEFAULT_RETRY_TIMEOUT_IN_SECONDS    0
 #define MAX_DISCONNECT_VALUE                50
+// How soon DoWorkWithBudget asks to be called again while a reply from the hub is expected
+#define REPLY_POLL_INTERVAL_MS              250
+#define NO_WORK_SCHEDULED                   ((tickcounter_ms_t)UINT32_MAX)
 
 static const char TOPIC_DEVICE_TWIN_PREFIX[] = "$iothub/twin";
 static const char TOPIC_DEVICE_METHOD_PREFIX[] = "$iothub/methods";
@@ -153,6 +158,8 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
 {
     // Topic control
     STRING_HANDLE topic_MqttEvent;
+    // PUBLISH packet prepared once for topic_MqttEvent; only the properties are encoded per message
+    MQTT_PUBLISH_TEMPLATE_HANDLE telemetry_publish_template;
     STRING_HANDLE topic_MqttMessage;
     STRING_HANDLE topic_GetState;
     STRING_HANDLE topic_NotifyState;
@@ -161,6 +168,10 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     STRING_HANDLE topic_DeviceMethods;
 
     uint32_t topics_ToSubscribe;
+    // Topics the broker keeps in the persistent session, and the SUBSCRIBE still waiting for its SUBACK
+    uint32_t session_topics;
+    uint32_t subscribe_pending_topics;
+    uint16_t subscribe_pending_packet_id;
 
     // Connection related constants
     STRING_HANDLE hostAddress;
@@ -183,6 +194,9 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     // Protocol
     MQTT_CLIENT_HANDLE mqttClient;
     XIO_HANDLE xioTransport;
+    // The xio the receive budget of DoWorkWithBudget was last given to, and that budget
+    XIO_HANDLE budget_xio;
+    IOTHUB_CLIENT_DOWORK_BUDGET applied_budget;
 
     // Session - connection
     uint16_t packetId;
@@ -195,6 +209,10 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     bool device_twin_get_sent;
     bool twin_resp_sub_recv;
     bool isRecoverableError;
+    // Session resumption: set by an accepted CONNACK, consumed by the next DoWork
+    bool was_connected;
+    bool session_resumed;
+    bool replay_unacked;
     uint16_t keepAliveValue;
     uint16_t connect_timeout_in_sec;
     tickcounter_ms_t mqtt_connect_time;
@@ -214,9 +232,20 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     CONTROL_PACKET_TYPE currPacketState;
 
     // Telemetry specific
+    // Messages waiting for PUBACK, oldest publish first so the resend check can stop at the first one not yet due
     DLIST_ENTRY telemetry_waitingForAck;
+    // telemetry_window preallocated entries; a message in flight sits at packet_id % telemetry_window
+    struct MQTT_MESSAGE_DETAILS_LIST_TAG* telemetry_slots;
+    size_t telemetry_window;
+    size_t telemetry_inflight_count;
     bool auto_url_encode_decode;
 
+    // Idle mode: telemetry is held back until the radio is up anyway
+    bool idle_mode;
+    IOTHUB_CLIENT_MQTT_IDLE_OPTIONS idle_options;
+    bool telemetry_held;
+    tickcounter_ms_t telemetry_held_since;
+
     // Controls frequency of reconnection logic.
     RETRY_CONTROL_HANDLE retry_control_handle;
 
@@ -253,6 +282,7 @@ typedef struct MQTT_MESSAGE_DETAILS_LIST_TAG
     IOTHUB_MESSAGE_LIST* iotHubMessageEntry;
     void* context;
     uint16_t packet_id;
+    bool replay_pending;
     DLIST_ENTRY entry;
 } MQTT_MESSAGE_DETAILS_LIST, *PMQTT_MESSAGE_DETAILS_LIST;
 
@@ -298,6 +328,9 @@ static void free_transport_handle_data(MQTTTRANSPORT_HANDLE_DATA* transport_data
         mqtt_client_deinit(transport_data->mqttClient);
     }
 
+    mqtt_client_destroy_publish_template(transport_data->telemetry_publish_template);
+    free(transport_data->telemetry_slots);
+
     if (transport_data->retry_control_handle != NULL)
     {
         retry_control_destroy(transport_data->retry_control_handle);
@@ -589,7 +622,7 @@ static int addUserPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_message_
     const char* const* propertyValues;
     size_t propertyCount;
     size_t index = *index_ptr;
-    MAP_HANDLE properties_map = IoTHubMessage_Properties(iothub_message_handle);
+    MAP_HANDLE properties_map = IoTHubMessage_GetReadOnlyProperties(iothub_message_handle);
     if (properties_map != NULL)
     {
         if (Map_GetInternals(properties_map, &propertyKeys, &propertyValues, &propertyCount) != MAP_OK)
@@ -781,13 +814,14 @@ static int addDiagnosticPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_me
 }
 
 
-static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handle, const char* eventTopic, bool urlencode)
+/* Returns the part of the event topic that follows topic_MqttEvent: the user, system and diagnostic properties and the output name. */
+static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handle, bool urlencode)
 {
     size_t index = 0;
-    STRING_HANDLE result = STRING_construct(eventTopic);
+    STRING_HANDLE result = STRING_new();
     if (result == NULL)
     {
-        LogError("Failed to create event topic string handle");
+        LogError("Failed to create event topic suffix string handle");
     }
     else if (addUserPropertiesTouMqttMessage(iothub_message_handle, result, &index, urlencode) != 0)
     {
@@ -827,46 +861,121 @@ static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_me
     return result;
 }
 
-static int publish_mqtt_telemetry_msg(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry, const unsigned char* payload, size_t len)
+static int create_telemetry_slots(PMQTTTRANSPORT_HANDLE_DATA transport_data, size_t window)
 {
     int result;
-    STRING_HANDLE msgTopic = addPropertiesTouMqttMessage(mqttMsgEntry->iotHubMessageEntry->messageHandle, STRING_c_str(transport_data->topic_MqttEvent), transport_data->auto_url_encode_decode);
-    if (msgTopic == NULL)
+    MQTT_MESSAGE_DETAILS_LIST* slots = (MQTT_MESSAGE_DETAILS_LIST*)malloc(window * sizeof(MQTT_MESSAGE_DETAILS_LIST));
+    if (slots == NULL)
+    {
+        LogError("Failure allocating the telemetry in-flight window");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memset(slots, 0, window * sizeof(MQTT_MESSAGE_DETAILS_LIST));
+        free(transport_data->telemetry_slots);
+        transport_data->telemetry_slots = slots;
+        transport_data->telemetry_window = window;
+        result = 0;
+    }
+    return result;
+}
+
+static MQTT_MESSAGE_DETAILS_LIST* acquire_telemetry_slot(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    MQTT_MESSAGE_DETAILS_LIST* result;
+    if (transport_data->telemetry_inflight_count >= transport_data->telemetry_window)
+    {
+        result = NULL;
+    }
+    else
+    {
+        uint16_t packet_id;
+        // Fewer than telemetry_window slots are in use, so one of the next telemetry_window ids maps to a free one
+        do
+        {
+            packet_id = get_next_packet_id(transport_data);
+            result = &transport_data->telemetry_slots[packet_id % transport_data->telemetry_window];
+        } while (result->iotHubMessageEntry != NULL);
+
+        result->packet_id = packet_id;
+        result->retryCount = 0;
+        result->replay_pending = false;
+        transport_data->telemetry_inflight_count++;
+    }
+    return result;
+}
+
+static void release_telemetry_slot(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry)
+{
+    mqttMsgEntry->iotHubMessageEntry = NULL;
+    transport_data->telemetry_inflight_count--;
+}
+
+// Flags every message waiting for its PUBACK to be published again on the new connection; returns whether there is any
+static bool mark_unacked_telemetry_for_replay(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    PDLIST_ENTRY currentListEntry = transport_data->telemetry_waitingForAck.Flink;
+    while (currentListEntry != &transport_data->telemetry_waitingForAck)
+    {
+        containingRecord(currentListEntry, MQTT_MESSAGE_DETAILS_LIST, entry)->replay_pending = true;
+        currentListEntry = currentListEntry->Flink;
+    }
+    return !DList_IsListEmpty(&transport_data->telemetry_waitingForAck);
+}
+
+static MQTT_MESSAGE_DETAILS_LIST* find_telemetry_slot(PMQTTTRANSPORT_HANDLE_DATA transport_data, uint16_t packet_id)
+{
+    MQTT_MESSAGE_DETAILS_LIST* result = &transport_data->telemetry_slots[packet_id % transport_data->telemetry_window];
+    if (result->iotHubMessageEntry == NULL || result->packet_id != packet_id)
+    {
+        result = NULL;
+    }
+    return result;
+}
+
+static int publish_mqtt_telemetry_msg(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry, const unsigned char* payload, size_t len, bool is_resend)
+{
+    int result;
+    STRING_HANDLE topicSuffix = addPropertiesTouMqttMessage(mqttMsgEntry->iotHubMessageEntry->messageHandle, transport_data->auto_url_encode_decode);
+    if (topicSuffix == NULL)
     {
         LogError("Failed adding properties to mqtt message");
         result = __FAILURE__;
     }
     else
     {
-        MQTT_MESSAGE_HANDLE mqttMsg = mqttmessage_create_in_place(mqttMsgEntry->packet_id, STRING_c_str(msgTopic), DELIVER_AT_LEAST_ONCE, payload, len);
-        if (mqttMsg == NULL)
+        if (tickcounter_get_current_ms(transport_data->msgTickCounter, &mqttMsgEntry->msgPublishTime) != 0)
         {
-            LogError("Failed creating mqtt message");
+            LogError("Failed retrieving tickcounter info");
             result = __FAILURE__;
         }
         else
         {
-            if (tickcounter_get_current_ms(transport_data->msgTickCounter, &mqttMsgEntry->msgPublishTime) != 0)
+            int publish_result;
+            if (is_resend)
             {
-                LogError("Failed retrieving tickcounter info");
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_036: [ A telemetry message that was published before shall be published again with mqtt_client_republish_with_template, keeping its packet id and setting the DUP flag. ] */
+                publish_result = mqtt_client_republish_with_template(transport_data->mqttClient, transport_data->telemetry_publish_template, mqttMsgEntry->packet_id, STRING_c_str(topicSuffix), payload, len);
+            }
+            else
+            {
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_014: [ Telemetry messages shall be published with mqtt_client_publish_with_template, passing the message properties as the topic suffix and the message body as the payload, without copying it. ] */
+                publish_result = mqtt_client_publish_with_template(transport_data->mqttClient, transport_data->telemetry_publish_template, mqttMsgEntry->packet_id, STRING_c_str(topicSuffix), payload, len);
+            }
+
+            if (publish_result != 0)
+            {
+                LogError("Failed attempting to publish mqtt message");
                 result = __FAILURE__;
             }
             else
             {
-                if (mqtt_client_publish(transport_data->mqttClient, mqttMsg) != 0)
-                {
-                    LogError("Failed attempting to publish mqtt message");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    mqttMsgEntry->retryCount++;
-                    result = 0;
-                }
+                mqttMsgEntry->retryCount++;
+                result = 0;
             }
-            mqttmessage_destroy(mqttMsg);
         }
-        STRING_delete(msgTopic);
+        STRING_delete(topicSuffix);
     }
     return result;
 }
@@ -1545,20 +1654,14 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
                 const PUBLISH_ACK* puback = (const PUBLISH_ACK*)msgInfo;
                 if (puback != NULL)
                 {
-                    PDLIST_ENTRY currentListEntry = transport_data->telemetry_waitingForAck.Flink;
-                    while (currentListEntry != &transport_data->telemetry_waitingForAck)
+                    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_018: [ On PUBACK the transport shall look up the message only in the slot packetId % window and complete it with IOTHUB_CLIENT_CONFIRMATION_OK if its packet id matches. ] */
+                    MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = find_telemetry_slot(transport_data, puback->packetId);
+                    if (mqttMsgEntry != NULL)
                     {
-                        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentListEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
-                        DLIST_ENTRY saveListEntry;
-                        saveListEntry.Flink = currentListEntry->Flink;
-
-                        if (puback->packetId == mqttMsgEntry->packet_id)
-                        {
-                            (void)DList_RemoveEntryList(currentListEntry); //First remove the item from Waiting for Ack List.
-                            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_OK);
-                            free(mqttMsgEntry);
-                        }
-                        currentListEntry = saveListEntry.Flink;
+                        IOTHUB_MESSAGE_LIST* iothubMsgList = mqttMsgEntry->iotHubMessageEntry;
+                        (void)DList_RemoveEntryList(&mqttMsgEntry->entry); //First remove the item from Waiting for Ack List.
+                        release_telemetry_slot(transport_data, mqttMsgEntry);
+                        sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_OK);
                     }
                 }
                 else
@@ -1579,6 +1682,23 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
                         transport_data->isRecoverableError = true;
                         transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_CONNECTED;
 
+                        // A SUBSCRIBE that was not acked before the connection dropped is not known to be in the session
+                        transport_data->subscribe_pending_topics = UNSUBSCRIBE_FROM_TOPIC;
+                        if (connack->isSessionPresent)
+                        {
+                            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_034: [ When the CONNACK reports a session present, the transport shall not subscribe again to the topics that were acknowledged by a SUBACK in that session. ] */
+                            transport_data->topics_ToSubscribe &= ~transport_data->session_topics;
+                        }
+                        else
+                        {
+                            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_035: [ When the CONNACK reports no session present, the transport shall subscribe again to every topic of the lost session. ] */
+                            transport_data->topics_ToSubscribe |= transport_data->session_topics;
+                            transport_data->session_topics = UNSUBSCRIBE_FROM_TOPIC;
+                        }
+                        transport_data->session_resumed = connack->isSessionPresent && transport_data->was_connected;
+                        transport_data->was_connected = true;
+                        transport_data->replay_unacked = mark_unacked_telemetry_for_replay(transport_data);
+
                         // Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_008: [ Upon successful connection the retry control shall be reset using retry_control_reset() ]
                         retry_control_reset(transport_data->retry_control_handle);
 
@@ -1630,6 +1750,22 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
                     // The subscribed packet has been acked
                     transport_data->currPacketState = SUBACK_TYPE;
 
+                    if (suback->packetId == transport_data->subscribe_pending_packet_id)
+                    {
+                        for (index = 0; index < suback->qosCount; index++)
+                        {
+                            if (suback->qosReturn[index] == DELIVER_FAILURE)
+                            {
+                                break;
+                            }
+                        }
+                        if (index == suback->qosCount)
+                        {
+                            transport_data->session_topics |= transport_data->subscribe_pending_topics;
+                        }
+                        transport_data->subscribe_pending_topics = UNSUBSCRIBE_FROM_TOPIC;
+                    }
+
                     // Is this a twin message
                     if (suback->packetId == transport_data->twin_resp_packet_id)
                     {
@@ -1677,6 +1813,7 @@ static void ResetConnectionIfNecessary(PMQTTTRANSPORT_HANDLE_DATA transport_data
 
         xio_destroy(transport_data->xioTransport);
         transport_data->xioTransport = NULL;
+        transport_data->budget_xio = NULL;
     }
 }
 
@@ -1711,6 +1848,7 @@ static void DisconnectFromClient(PMQTTTRANSPORT_HANDLE_DATA transport_data)
     }
     xio_destroy(transport_data->xioTransport);
     transport_data->xioTransport = NULL;
+    transport_data->budget_xio = NULL;
 
     transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_NOT_CONNECTED;
     transport_data->currPacketState = DISCONNECT_TYPE;
@@ -1840,6 +1978,8 @@ static void SubscribeToMqttProtocol(PMQTTTRANSPORT_HANDLE_DATA transport_data)
             {
                 /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_018: [On success IoTHubTransport_MQTT_Common_Subscribe shall return 0.] */
                 transport_data->topics_ToSubscribe &= ~topic_subscription;
+                transport_data->subscribe_pending_topics |= topic_subscription;
+                transport_data->subscribe_pending_packet_id = packet_id;
                 transport_data->currPacketState = SUBSCRIBE_TYPE;
             }
         }
@@ -1977,13 +2117,24 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
 {
     int result;
 
-    char* sasToken = NULL;
+    const char* sasToken = NULL;
+    /* tokens from IoTHubClient_Auth_Get_SasToken are copies the transport frees, cached device key tokens are not */
+    char* ownedSasToken = NULL;
     result = 0;
 
     IOTHUB_CREDENTIAL_TYPE cred_type = IoTHubClient_Auth_Get_Credential_Type(transport_data->authorization_module);
-    if (cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY || cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
+    if (cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY)
     {
-        sasToken = IoTHubClient_Auth_Get_SasToken(transport_data->authorization_module, STRING_c_str(transport_data->devicesAndModulesPath), transport_data->option_sas_token_lifetime_secs, NULL);
+        sasToken = IoTHubClient_Auth_Get_Cached_SasToken(transport_data->authorization_module, STRING_c_str(transport_data->devicesAndModulesPath), transport_data->option_sas_token_lifetime_secs, NULL);
+        if (sasToken == NULL)
+        {
+            LogError("failure getting sas token from IoTHubClient_Auth_Get_Cached_SasToken.");
+            result = __FAILURE__;
+        }
+    }
+    else if (cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
+    {
+        sasToken = ownedSasToken = IoTHubClient_Auth_Get_SasToken(transport_data->authorization_module, STRING_c_str(transport_data->devicesAndModulesPath), transport_data->option_sas_token_lifetime_secs, NULL);
         if (sasToken == NULL)
         {
             LogError("failure getting sas token from IoTHubClient_Auth_Get_SasToken.");
@@ -2005,7 +2156,7 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
         }
         else
         {
-            sasToken = IoTHubClient_Auth_Get_SasToken(transport_data->authorization_module, NULL, 0, NULL);
+            sasToken = ownedSasToken = IoTHubClient_Auth_Get_SasToken(transport_data->authorization_module, NULL, 0, NULL);
             if (sasToken == NULL)
             {
                 LogError("failure getting sas Token.");
@@ -2069,7 +2220,7 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
             options.username = (char*)STRING_c_str(transport_data->configPassedThroughUsername);
             if (sasToken != NULL)
             {
-                options.password = sasToken;
+                options.password = (char*)sasToken;
             }
             options.keepAliveInterval = transport_data->keepAliveValue;
             options.useCleanSession = false;
@@ -2093,9 +2244,9 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
                 result = __FAILURE__;
             }
 
-            if (sasToken != NULL)
+            if (ownedSasToken != NULL)
             {
-                free(sasToken);
+                free(ownedSasToken);
             }
             STRING_delete(clientId);
         }
@@ -2294,6 +2445,19 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
                 free_transport_handle_data(state);
                 state = NULL;
             }
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_013: [ IoTHubTransport_MQTT_Common_Create shall create a DELIVER_AT_LEAST_ONCE publish template for topic_MqttEvent with mqtt_client_create_publish_template. ] */
+            else if ((state->telemetry_publish_template = mqtt_client_create_publish_template(DELIVER_AT_LEAST_ONCE, STRING_c_str(state->topic_MqttEvent))) == NULL)
+            {
+                LogError("Could not create the telemetry publish template");
+                free_transport_handle_data(state);
+                state = NULL;
+            }
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_015: [ IoTHubTransport_MQTT_Common_Create shall preallocate an in-flight window of DEFAULT_TELEMETRY_INFLIGHT_WINDOW telemetry slots. ] */
+            else if (create_telemetry_slots(state, DEFAULT_TELEMETRY_INFLIGHT_WINDOW) != 0)
+            {
+                free_transport_handle_data(state);
+                state = NULL;
+            }
             else
             {
                 state->mqttClient = mqtt_client_init(mqtt_notification_callback, mqtt_operation_complete_callback, state, mqtt_error_callback, state);
@@ -2338,6 +2502,7 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
                         state->isRecoverableError = true;
                         state->packetId = 1;
                         state->xioTransport = NULL;
+                        state->budget_xio = NULL;
                         state->portNum = 0;
                         state->waitingToSend = waitingToSend;
                         state->currPacketState = CONNECT_TYPE;
@@ -2349,6 +2514,8 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
                         state->topic_GetState = NULL;
                         state->topic_NotifyState = NULL;
                         state->topics_ToSubscribe = UNSUBSCRIBE_FROM_TOPIC;
+                        state->session_topics = UNSUBSCRIBE_FROM_TOPIC;
+                        state->subscribe_pending_topics = UNSUBSCRIBE_FROM_TOPIC;
                         state->topic_DeviceMethods = NULL;
                         state->topic_InputQueue = NULL;
                         state->log_trace = state->raw_trace = false;
@@ -2466,8 +2633,9 @@ void IoTHubTransport_MQTT_Common_Destroy(TRANSPORT_LL_HANDLE handle)
         {
             PDLIST_ENTRY currentEntry = DList_RemoveHeadList(&transport_data->telemetry_waitingForAck);
             MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
-            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
-            free(mqttMsgEntry);
+            IOTHUB_MESSAGE_LIST* iothubMsgList = mqttMsgEntry->iotHubMessageEntry;
+            release_telemetry_slot(transport_data, mqttMsgEntry);
+            sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
         }
         while (!DList_IsListEmpty(&transport_data->ack_waiting_queue))
         {
@@ -2534,6 +2702,7 @@ void IoTHubTransport_MQTT_Common_Unsubscribe_DeviceTwin(IOTHUB_DEVICE_HANDLE han
         {
             /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_049: [If subscribe_state is set to IOTHUB_DEVICE_TWIN_DESIRED_STATE then IoTHubTransport_MQTT_Common_Unsubscribe_DeviceTwin shall unsubscribe from the topic_GetState to the mqtt client.] */
             transport_data->topics_ToSubscribe &= ~SUBSCRIBE_GET_REPORTED_STATE_TOPIC;
+            transport_data->session_topics &= ~SUBSCRIBE_GET_REPORTED_STATE_TOPIC;
             STRING_delete(transport_data->topic_GetState);
             transport_data->topic_GetState = NULL;
         }
@@ -2541,6 +2710,7 @@ void IoTHubTransport_MQTT_Common_Unsubscribe_DeviceTwin(IOTHUB_DEVICE_HANDLE han
         {
             /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_050: [If subscribe_state is set to IOTHUB_DEVICE_TWIN_NOTIFICATION_STATE then IoTHubTransport_MQTT_Common_Unsubscribe_DeviceTwin shall unsubscribe from the topic_NotifyState to the mqtt client.] */
             transport_data->topics_ToSubscribe &= ~SUBSCRIBE_NOTIFICATION_STATE_TOPIC;
+            transport_data->session_topics &= ~SUBSCRIBE_NOTIFICATION_STATE_TOPIC;
             STRING_delete(transport_data->topic_NotifyState);
             transport_data->topic_NotifyState = NULL;
         }
@@ -2620,6 +2790,7 @@ void IoTHubTransport_MQTT_Common_Unsubscribe_DeviceMethod(IOTHUB_DEVICE_HANDLE h
             STRING_delete(transport_data->topic_DeviceMethods);
             transport_data->topic_DeviceMethods = NULL;
             transport_data->topics_ToSubscribe &= ~SUBSCRIBE_DEVICE_METHOD_TOPIC;
+            transport_data->session_topics &= ~SUBSCRIBE_DEVICE_METHOD_TOPIC;
         }
     }
     else
@@ -2724,6 +2895,7 @@ void IoTHubTransport_MQTT_Common_Unsubscribe(IOTHUB_DEVICE_HANDLE handle)
         STRING_delete(transport_data->topic_MqttMessage);
         transport_data->topic_MqttMessage = NULL;
         transport_data->topics_ToSubscribe &= ~SUBSCRIBE_TELEMETRY_TOPIC;
+        transport_data->session_topics &= ~SUBSCRIBE_TELEMETRY_TOPIC;
     }
     else
     {
@@ -2794,158 +2966,456 @@ IOTHUB_PROCESS_ITEM_RESULT IoTHubTransport_MQTT_Common_ProcessItem(TRANSPORT_LL_
     return result;
 }
 
-/* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_054: [ IoTHubTransport_MQTT_Common_DoWork shall subscribe to the Notification and get_state Topics if they are defined. ] */
-void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle)
+/* Hands the DoWork budget to the xio as its receive timeout and receive budget options */
+static void apply_receive_budget(PMQTTTRANSPORT_HANDLE_DATA transport_data, const IOTHUB_CLIENT_DOWORK_BUDGET* budget)
 {
-    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_026: [IoTHubTransport_MQTT_Common_DoWork shall do nothing if parameter handle and/or iotHubClientHandle is NULL.] */
-    PMQTTTRANSPORT_HANDLE_DATA transport_data = (PMQTTTRANSPORT_HANDLE_DATA)handle;
-    if (transport_data != NULL)
+    // Only given to the xio when it changes, xios that do not know the options log every refusal
+    if (transport_data->xioTransport != NULL &&
+        (transport_data->budget_xio != transport_data->xioTransport ||
+         transport_data->applied_budget.max_wait_ms != budget->max_wait_ms ||
+         transport_data->applied_budget.max_receive_bytes != budget->max_receive_bytes))
+    {
+        unsigned int receive_timeout_ms = (unsigned int)budget->max_wait_ms;
+        size_t receive_budget = budget->max_receive_bytes;
+
+        (void)xio_setoption(transport_data->xioTransport, OPTION_RECEIVE_TIMEOUT_MS, &receive_timeout_ms);
+        (void)xio_setoption(transport_data->xioTransport, OPTION_RECEIVE_BUDGET, &receive_budget);
+        transport_data->budget_xio = transport_data->xioTransport;
+        transport_data->applied_budget = *budget;
+    }
+}
+
+static void lower_to_deadline(tickcounter_ms_t* ms_to_next_work, tickcounter_ms_t current_ms, tickcounter_ms_t deadline_ms)
+{
+    tickcounter_ms_t ms_left = (deadline_ms > current_ms) ? (deadline_ms - current_ms) : 0;
+    if (ms_left < *ms_to_next_work)
     {
-        if (InitializeConnection(transport_data) != 0)
+        *ms_to_next_work = ms_left;
+    }
+}
+
+static bool has_held_messages(PDLIST_ENTRY waitingToSend, size_t count)
+{
+    PDLIST_ENTRY current_entry = waitingToSend->Flink;
+    while (count > 0 && current_entry != waitingToSend)
+    {
+        count--;
+        current_entry = current_entry->Flink;
+    }
+    return count == 0;
+}
+
+static bool hold_telemetry(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    bool result = false;
+    if (transport_data->idle_mode && !DList_IsListEmpty(transport_data->waitingToSend))
+    {
+        tickcounter_ms_t current_ms;
+        tickcounter_ms_t ms_to_keep_alive = NO_WORK_SCHEDULED;
+        MQTT_CLIENT_RADIO_STATISTICS radio_statistics;
+        if (tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms) != 0 ||
+            mqtt_client_get_radio_statistics(transport_data->mqttClient, &radio_statistics) != 0 ||
+            mqtt_client_get_next_work_time(transport_data->mqttClient, &ms_to_keep_alive) != 0)
         {
-            // Don't want to flood the logs with failures here
+            LogError("failure getting the radio state, sending the telemetry");
         }
         else
         {
-            if (transport_data->mqttClientStatus == MQTT_CLIENT_STATUS_PENDING_CLOSE)
+            if (!transport_data->telemetry_held)
             {
-                mqtt_client_disconnect(transport_data->mqttClient, NULL, NULL);
-                transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_NOT_CONNECTED;
+                transport_data->telemetry_held = true;
+                transport_data->telemetry_held_since = current_ms;
             }
-            else if (transport_data->currPacketState == CONNACK_TYPE || transport_data->currPacketState == SUBSCRIBE_TYPE)
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_033: [ In idle mode IoTHubTransport_MQTT_Common_DoWork shall leave the messages in waitingToSend unless the radio is awake according to mqtt_client_get_radio_statistics, mqtt_client_get_next_work_time reports keep-alive work due now, max_held_messages messages are waiting or max_send_delay_ms have passed since it started holding them. ] */
+            result = !radio_statistics.radioAwake && ms_to_keep_alive != 0 &&
+                (current_ms - transport_data->telemetry_held_since) < transport_data->idle_options.max_send_delay_ms &&
+                (transport_data->idle_options.max_held_messages == 0 || !has_held_messages(transport_data->waitingToSend, transport_data->idle_options.max_held_messages));
+        }
+    }
+
+    if (!result)
+    {
+        transport_data->telemetry_held = false;
+    }
+    return result;
+}
+
+static tickcounter_ms_t get_ms_to_next_work(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    tickcounter_ms_t result = NO_WORK_SCHEDULED;
+    tickcounter_ms_t current_ms;
+
+    if (transport_data->isDestroyCalled)
+    {
+        // Nothing left to do
+    }
+    else if (tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms) != 0)
+    {
+        LogError("failure getting the time of the next transport work");
+        result = 0;
+    }
+    else if (transport_data->mqttClientStatus == MQTT_CLIENT_STATUS_NOT_CONNECTED)
+    {
+        unsigned int wait_time_in_secs;
+        if (!transport_data->isRecoverableError)
+        {
+            // Stays disconnected until the application acts
+        }
+        else if (retry_control_get_wait_time(transport_data->retry_control_handle, &wait_time_in_secs) != 0)
+        {
+            // The reconnection is attempted anyway if the retry control fails
+            result = 0;
+        }
+        else if (wait_time_in_secs != RETRY_CONTROL_NO_RETRY)
+        {
+            result = (tickcounter_ms_t)wait_time_in_secs * 1000;
+        }
+    }
+    else if (transport_data->mqttClientStatus == MQTT_CLIENT_STATUS_CONNECTING)
+    {
+        // Waiting for the CONNACK, which has to be read before the connect timeout runs out
+        result = REPLY_POLL_INTERVAL_MS;
+        lower_to_deadline(&result, current_ms, transport_data->mqtt_connect_time + ((tickcounter_ms_t)transport_data->connect_timeout_in_sec + 1) * 1000);
+    }
+    else if (transport_data->mqttClientStatus == MQTT_CLIENT_STATUS_CONNECTED)
+    {
+        // The SAS token is refreshed once more than option_sas_token_lifetime_secs*SAS_REFRESH_MULTIPLIER seconds have passed
+        lower_to_deadline(&result, current_ms, transport_data->mqtt_connect_time +
+            ((tickcounter_ms_t)(transport_data->option_sas_token_lifetime_secs*SAS_REFRESH_MULTIPLIER) + 1) * 1000);
+
+        if (transport_data->currPacketState == CONNACK_TYPE || transport_data->currPacketState == SUBSCRIBE_TYPE ||
+            transport_data->currPacketState == SUBACK_TYPE)
+        {
+            result = 0;
+        }
+        else if (transport_data->currPacketState == PUBLISH_TYPE)
+        {
+            if (transport_data->replay_unacked ||
+                (!DList_IsListEmpty(transport_data->waitingToSend) && transport_data->telemetry_inflight_count < transport_data->telemetry_window && !transport_data->telemetry_held))
             {
-                SubscribeToMqttProtocol(transport_data);
+                result = 0;
             }
-            else if (transport_data->currPacketState == SUBACK_TYPE)
+            else
             {
-                if ((transport_data->topic_NotifyState != NULL || transport_data->topic_GetState != NULL) &&
-                    !transport_data->device_twin_get_sent)
+                if (transport_data->telemetry_held)
                 {
-                    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_055: [ IoTHubTransport_MQTT_Common_DoWork shall send a device twin get property message upon successfully retrieving a SUBACK on device twin topics. ] */
-                    if (publish_device_twin_get_message(transport_data) == 0)
-                    {
-                        transport_data->device_twin_get_sent = true;
-                    }
-                    else
+                    // Held telemetry goes out at the latest max_send_delay_ms after it was first held, or with the next ping
+                    lower_to_deadline(&result, current_ms, transport_data->telemetry_held_since + transport_data->idle_options.max_send_delay_ms);
+                }
+                if (!DList_IsListEmpty(&transport_data->telemetry_waitingForAck))
+                {
+                    MQTT_MESSAGE_DETAILS_LIST* oldest = containingRecord(transport_data->telemetry_waitingForAck.Flink, MQTT_MESSAGE_DETAILS_LIST, entry);
+                    lower_to_deadline(&result, current_ms, oldest->msgPublishTime + ((tickcounter_ms_t)RESEND_TIMEOUT_VALUE_MIN + 1) * 1000);
+                    if (result > REPLY_POLL_INTERVAL_MS)
                     {
-                        LogError("Failure: sending device twin get property command.");
+                        // PUBACKs are on their way
+                        result = REPLY_POLL_INTERVAL_MS;
                     }
                 }
-                // Publish can be called now
-                transport_data->currPacketState = PUBLISH_TYPE;
             }
-            else if (transport_data->currPacketState == PUBLISH_TYPE)
+        }
+
+        if (mqtt_client_get_next_work_time(transport_data->mqttClient, &result) != 0)
+        {
+            result = 0;
+        }
+    }
+    else
+    {
+        // A close or disconnect is pending
+        result = 0;
+    }
+
+    return result;
+}
+
+static void RequestDeviceTwin(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    if ((transport_data->topic_NotifyState != NULL || transport_data->topic_GetState != NULL) &&
+        !transport_data->device_twin_get_sent)
+    {
+        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_055: [ IoTHubTransport_MQTT_Common_DoWork shall send a device twin get property message upon successfully retrieving a SUBACK on device twin topics. ] */
+        if (publish_device_twin_get_message(transport_data) == 0)
+        {
+            transport_data->device_twin_get_sent = true;
+        }
+        else
+        {
+            LogError("Failure: sending device twin get property command.");
+        }
+    }
+}
+
+static int ReplayUnackedTelemetry(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    int result = 0;
+
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_037: [ After an accepted CONNACK, IoTHubTransport_MQTT_Common_DoWork shall publish again every message waiting for its PUBACK, in publish order and without waiting for the resend timeout. ] */
+    // The entries still to replay are at the head of the list, a replayed one goes behind every message published before it
+    while ((result == 0) && (transport_data->telemetry_waitingForAck.Flink != &transport_data->telemetry_waitingForAck))
+    {
+        PDLIST_ENTRY currentListEntry = transport_data->telemetry_waitingForAck.Flink;
+        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentListEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
+        IOTHUB_MESSAGE_LIST* iothubMsgList = mqttMsgEntry->iotHubMessageEntry;
+        size_t messageLength;
+        const unsigned char* messagePayload = NULL;
+
+        if (!mqttMsgEntry->replay_pending)
+        {
+            break;
+        }
+
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_039: [ Publishing a message again after a reconnect shall not count as a resend: its count of resends shall start over, as for a message published for the first time on that connection. ] */
+        mqttMsgEntry->retryCount = 0;
+
+        if (!RetrieveMessagePayload(iothubMsgList->messageHandle, &messagePayload, &messageLength))
+        {
+            LogError("Failure from creating Message IoTHubMessage_GetData");
+            (void)DList_RemoveEntryList(currentListEntry);
+            release_telemetry_slot(transport_data, mqttMsgEntry);
+            sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+        }
+        else if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength, true) != 0)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_040: [ If publishing a message again fails, IoTHubTransport_MQTT_Common_DoWork shall keep it and the messages after it waiting for their PUBACK, publish nothing else, and try the replay again on the next call. ] */
+            LogError("Failure replaying telemetry message");
+            result = __FAILURE__;
+        }
+        else
+        {
+            mqttMsgEntry->replay_pending = false;
+            (void)DList_RemoveEntryList(currentListEntry);
+            DList_InsertTailList(&(transport_data->telemetry_waitingForAck), currentListEntry);
+        }
+    }
+    return result;
+}
+
+static void ProcessTelemetry(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    tickcounter_ms_t current_ms;
+    PDLIST_ENTRY currentListEntry;
+    if (transport_data->replay_unacked && ReplayUnackedTelemetry(transport_data) == 0)
+    {
+        transport_data->replay_unacked = false;
+    }
+
+    currentListEntry = transport_data->telemetry_waitingForAck.Flink;
+    if (currentListEntry != &transport_data->telemetry_waitingForAck &&
+        tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms) == 0)
+    {
+        while (currentListEntry != &transport_data->telemetry_waitingForAck)
+        {
+            MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentListEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
+            DLIST_ENTRY nextListEntry;
+            nextListEntry.Flink = currentListEntry->Flink;
+
+            /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_033: [IoTHubTransport_MQTT_Common_DoWork shall iterate through the Waiting Acknowledge messages looking for any message that has been waiting longer than 2 min.]*/
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_019: [ The waiting acknowledge messages are kept in publish order, so IoTHubTransport_MQTT_Common_DoWork shall stop looking at the first message that has not timed out. ] */
+            if (mqttMsgEntry->replay_pending ||
+                mqttMsgEntry->msgPublishTime > current_ms || ((current_ms - mqttMsgEntry->msgPublishTime) / 1000) <= RESEND_TIMEOUT_VALUE_MIN)
+            {
+                break;
+            }
+
+            /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_034: [If IoTHubTransport_MQTT_Common_DoWork has resent the message two times then it shall fail the message and reconnect to IoTHub ... ] */
+            if (mqttMsgEntry->retryCount >= MAX_SEND_RECOUNT_LIMIT)
+            {
+                PDLIST_ENTRY current_entry;
+                IOTHUB_MESSAGE_LIST* iothubMsgList = mqttMsgEntry->iotHubMessageEntry;
+                (void)DList_RemoveEntryList(currentListEntry);
+                release_telemetry_slot(transport_data, mqttMsgEntry);
+                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT);
+
+                transport_data->currPacketState = PACKET_TYPE_ERROR;
+                transport_data->device_twin_get_sent = false;
+                DisconnectFromClient(transport_data);
+
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_07_057: [ ... then go through all the rest of the waiting messages and reset the retryCount on the message. ]*/
+                current_entry = transport_data->telemetry_waitingForAck.Flink;
+                while (current_entry != &transport_data->telemetry_waitingForAck)
+                {
+                    MQTT_MESSAGE_DETAILS_LIST* msg_reset_entry;
+                    msg_reset_entry = containingRecord(current_entry, MQTT_MESSAGE_DETAILS_LIST, entry);
+                    msg_reset_entry->retryCount = 0;
+                    current_entry = current_entry->Flink;
+                }
+            }
+            else
             {
-                PDLIST_ENTRY currentListEntry = transport_data->telemetry_waitingForAck.Flink;
-                while (currentListEntry != &transport_data->telemetry_waitingForAck)
+                size_t messageLength;
+                const unsigned char* messagePayload = NULL;
+                IOTHUB_MESSAGE_LIST* iothubMsgList = mqttMsgEntry->iotHubMessageEntry;
+                if (!RetrieveMessagePayload(iothubMsgList->messageHandle, &messagePayload, &messageLength))
                 {
-                    tickcounter_ms_t current_ms;
-                    MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentListEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
-                    DLIST_ENTRY nextListEntry;
-                    nextListEntry.Flink = currentListEntry->Flink;
-
-                    (void)tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms);
-                    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_033: [IoTHubTransport_MQTT_Common_DoWork shall iterate through the Waiting Acknowledge messages looking for any message that has been waiting longer than 2 min.]*/
-                    if (((current_ms - mqttMsgEntry->msgPublishTime) / 1000) > RESEND_TIMEOUT_VALUE_MIN)
-                    {
-                        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_034: [If IoTHubTransport_MQTT_Common_DoWork has resent the message two times then it shall fail the message and reconnect to IoTHub ... ] */
-                        if (mqttMsgEntry->retryCount >= MAX_SEND_RECOUNT_LIMIT)
-                        {
-                            PDLIST_ENTRY current_entry;
-                            (void)DList_RemoveEntryList(currentListEntry);
-                            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT);
-                            free(mqttMsgEntry);
-
-                            transport_data->currPacketState = PACKET_TYPE_ERROR;
-                            transport_data->device_twin_get_sent = false;
-                            DisconnectFromClient(transport_data);
-
-                            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_07_057: [ ... then go through all the rest of the waiting messages and reset the retryCount on the message. ]*/
-                            current_entry = transport_data->telemetry_waitingForAck.Flink;
-                            while (current_entry != &transport_data->telemetry_waitingForAck)
-                            {
-                                MQTT_MESSAGE_DETAILS_LIST* msg_reset_entry;
-                                msg_reset_entry = containingRecord(current_entry, MQTT_MESSAGE_DETAILS_LIST, entry);
-                                msg_reset_entry->retryCount = 0;
-                                current_entry = current_entry->Flink;
-                            }
-                        }
-                        else
-                        {
-                            size_t messageLength;
-                            const unsigned char* messagePayload = NULL;
-                            if (!RetrieveMessagePayload(mqttMsgEntry->iotHubMessageEntry->messageHandle, &messagePayload, &messageLength))
-                            {
-                                LogError("Failure from creating Message IoTHubMessage_GetData");
-                                (void)DList_RemoveEntryList(currentListEntry);
-                                sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                            }
-                            else
-                            {
-                                if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
-                                {
-                                    (void)DList_RemoveEntryList(currentListEntry);
-                                    sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                                    free(mqttMsgEntry);
-                                }
-                            }
-                        }
-                    }
-                    currentListEntry = nextListEntry.Flink;
+                    LogError("Failure from creating Message IoTHubMessage_GetData");
+                    (void)DList_RemoveEntryList(currentListEntry);
+                    release_telemetry_slot(transport_data, mqttMsgEntry);
+                    sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+                }
+                else if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength, true) != 0)
+                {
+                    (void)DList_RemoveEntryList(currentListEntry);
+                    release_telemetry_slot(transport_data, mqttMsgEntry);
+                    sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
                 }
+                else
+                {
+                    // Resent now, so it goes behind every message published before it
+                    (void)DList_RemoveEntryList(currentListEntry);
+                    DList_InsertTailList(&(transport_data->telemetry_waitingForAck), currentListEntry);
+                }
+            }
+            currentListEntry = nextListEntry.Flink;
+        }
+    }
 
-                currentListEntry = transport_data->waitingToSend->Flink;
-                /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
-                while (currentListEntry != transport_data->waitingToSend)
+    if (!transport_data->replay_unacked && !hold_telemetry(transport_data))
+    {
+        currentListEntry = transport_data->waitingToSend->Flink;
+        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
+        while (currentListEntry != transport_data->waitingToSend)
+        {
+            IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
+            DLIST_ENTRY savedFromCurrentListEntry;
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_016: [ IoTHubTransport_MQTT_Common_DoWork shall not publish a message while the in-flight window is full; the message shall stay in waitingToSend. ] */
+            MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = acquire_telemetry_slot(transport_data);
+            if (mqttMsgEntry == NULL)
+            {
+                break;
+            }
+            savedFromCurrentListEntry.Flink = currentListEntry->Flink;
+
+            /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
+            size_t messageLength;
+            const unsigned char* messagePayload = NULL;
+            if (!RetrieveMessagePayload(iothubMsgList->messageHandle, &messagePayload, &messageLength))
+            {
+                release_telemetry_slot(transport_data, mqttMsgEntry);
+                (void)(DList_RemoveEntryList(currentListEntry));
+                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+                LogError("Failure result from IoTHubMessage_GetData");
+            }
+            else
+            {
+                /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_029: [IoTHubTransport_MQTT_Common_DoWork shall create a MQTT_MESSAGE_HANDLE and pass this to a call to mqtt_client_publish.] */
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_017: [ IoTHubTransport_MQTT_Common_DoWork shall give the message a packet id that maps to a free slot of the in-flight window. ] */
+                mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
+                if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength, false) != 0)
                 {
-                    IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
-                    DLIST_ENTRY savedFromCurrentListEntry;
-                    savedFromCurrentListEntry.Flink = currentListEntry->Flink;
-
-                    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
-                    size_t messageLength;
-                    const unsigned char* messagePayload = NULL;
-                    if (!RetrieveMessagePayload(iothubMsgList->messageHandle, &messagePayload, &messageLength))
-                    {
-                        (void)(DList_RemoveEntryList(currentListEntry));
-                        sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                        LogError("Failure result from IoTHubMessage_GetData");
-                    }
-                    else
-                    {
-                        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_029: [IoTHubTransport_MQTT_Common_DoWork shall create a MQTT_MESSAGE_HANDLE and pass this to a call to mqtt_client_publish.] */
-                        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = (MQTT_MESSAGE_DETAILS_LIST*)malloc(sizeof(MQTT_MESSAGE_DETAILS_LIST));
-                        if (mqttMsgEntry == NULL)
-                        {
-                            LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
-                        }
-                        else
-                        {
-                            mqttMsgEntry->retryCount = 0;
-                            mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
-                            mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
-                            if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
-                            {
-                                (void)(DList_RemoveEntryList(currentListEntry));
-                                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                                free(mqttMsgEntry);
-                            }
-                            else
-                            {
-                                (void)(DList_RemoveEntryList(currentListEntry));
-                                DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
-                            }
-                        }
-                    }
-                    currentListEntry = savedFromCurrentListEntry.Flink;
+                    release_telemetry_slot(transport_data, mqttMsgEntry);
+                    (void)(DList_RemoveEntryList(currentListEntry));
+                    sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+                }
+                else
+                {
+                    (void)(DList_RemoveEntryList(currentListEntry));
+                    DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
                 }
             }
-            /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_030: [IoTHubTransport_MQTT_Common_DoWork shall call mqtt_client_dowork everytime it is called if it is connected.] */
-            mqtt_client_dowork(transport_data->mqttClient);
+            currentListEntry = savedFromCurrentListEntry.Flink;
         }
     }
 }
 
+static void DoWork(PMQTTTRANSPORT_HANDLE_DATA transport_data, const IOTHUB_CLIENT_DOWORK_BUDGET* budget)
+{
+    if (InitializeConnection(transport_data) != 0)
+    {
+        // Don't want to flood the logs with failures here
+    }
+    else
+    {
+        if (transport_data->mqttClientStatus == MQTT_CLIENT_STATUS_PENDING_CLOSE)
+        {
+            mqtt_client_disconnect(transport_data->mqttClient, NULL, NULL);
+            transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_NOT_CONNECTED;
+        }
+        else if (transport_data->currPacketState == CONNACK_TYPE || transport_data->currPacketState == SUBSCRIBE_TYPE)
+        {
+            /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_054: [ IoTHubTransport_MQTT_Common_DoWork shall subscribe to the Notification and get_state Topics if they are defined. ] */
+            SubscribeToMqttProtocol(transport_data);
+            if (transport_data->session_resumed && transport_data->currPacketState == PUBLISH_TYPE)
+            {
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_038: [ When a resumed session leaves nothing to subscribe, IoTHubTransport_MQTT_Common_DoWork shall request the device twin if needed and publish the pending telemetry in the same call that handles the CONNACK. ] */
+                RequestDeviceTwin(transport_data);
+                ProcessTelemetry(transport_data);
+            }
+            transport_data->session_resumed = false;
+        }
+        else if (transport_data->currPacketState == SUBACK_TYPE)
+        {
+            RequestDeviceTwin(transport_data);
+            // Publish can be called now
+            transport_data->currPacketState = PUBLISH_TYPE;
+        }
+        else if (transport_data->currPacketState == PUBLISH_TYPE)
+        {
+            ProcessTelemetry(transport_data);
+        }
+        if (budget != NULL)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_027: [ IoTHubTransport_MQTT_Common_DoWorkWithBudget shall give max_wait_ms and max_receive_bytes of budget to the xio with the OPTION_RECEIVE_TIMEOUT_MS and OPTION_RECEIVE_BUDGET options before calling mqtt_client_dowork, whenever they or the xio changed. ] */
+            apply_receive_budget(transport_data, budget);
+        }
+
+        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_030: [IoTHubTransport_MQTT_Common_DoWork shall call mqtt_client_dowork everytime it is called if it is connected.] */
+        mqtt_client_dowork(transport_data->mqttClient);
+    }
+}
+
+void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle)
+{
+    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_026: [IoTHubTransport_MQTT_Common_DoWork shall do nothing if parameter handle and/or iotHubClientHandle is NULL.] */
+    PMQTTTRANSPORT_HANDLE_DATA transport_data = (PMQTTTRANSPORT_HANDLE_DATA)handle;
+    if (transport_data != NULL)
+    {
+        DoWork(transport_data, NULL);
+    }
+}
+
+int IoTHubTransport_MQTT_Common_DoWorkWithBudget(TRANSPORT_LL_HANDLE handle, const IOTHUB_CLIENT_DOWORK_BUDGET* budget, uint32_t* next_call_in_ms)
+{
+    int result;
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_025: [ If handle, budget or next_call_in_ms is NULL, IoTHubTransport_MQTT_Common_DoWorkWithBudget shall return a non-zero value. ] */
+    if (handle == NULL || budget == NULL || next_call_in_ms == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, budget: %p, next_call_in_ms: %p", handle, budget, next_call_in_ms);
+        result = __FAILURE__;
+    }
+    else
+    {
+        PMQTTTRANSPORT_HANDLE_DATA transport_data = (PMQTTTRANSPORT_HANDLE_DATA)handle;
+        uint64_t bytes_sent;
+        uint64_t bytes_received_before = 0;
+        uint64_t bytes_received_after = 0;
+        tickcounter_ms_t ms_to_next_work;
+
+        (void)mqtt_client_get_traffic(transport_data->mqttClient, &bytes_sent, &bytes_received_before);
+
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_026: [ IoTHubTransport_MQTT_Common_DoWorkWithBudget shall do the work of IoTHubTransport_MQTT_Common_DoWork. ] */
+        DoWork(transport_data, budget);
+
+        (void)mqtt_client_get_traffic(transport_data->mqttClient, &bytes_sent, &bytes_received_after);
+
+        if (budget->max_receive_bytes != 0 && bytes_received_after - bytes_received_before >= budget->max_receive_bytes)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_028: [ If the call received max_receive_bytes, next_call_in_ms shall be 0, since more data may be waiting. ] */
+            ms_to_next_work = 0;
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_029: [ Otherwise next_call_in_ms shall be the milliseconds until the earliest of: the next reconnection attempt allowed by the retry policy, the CONNACK timeout, the SAS token refresh, the resend of the oldest message waiting for its PUBACK, the end of max_send_delay_ms while the idle mode holds telemetry and the keep-alive work of mqtt_client_get_next_work_time; 0 if messages can be published and are not held or a subscription, close or disconnect is pending; at most REPLY_POLL_INTERVAL_MS while a CONNACK or PUBACK is expected; UINT32_MAX if nothing is scheduled. ] */
+            ms_to_next_work = get_ms_to_next_work(transport_data);
+        }
+        *next_call_in_ms = (ms_to_next_work > UINT32_MAX) ? UINT32_MAX : (uint32_t)ms_to_next_work;
+
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_030: [ On success IoTHubTransport_MQTT_Common_DoWorkWithBudget shall return 0. ] */
+        result = 0;
+    }
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_GetSendStatus(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATUS *iotHubClientStatus)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -3043,6 +3513,58 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_SetOption(TRANSPORT_LL_HANDLE h
             }
             result = IOTHUB_CLIENT_OK;
         }
+        else if (strcmp(OPTION_MQTT_IDLE_MODE, option) == 0)
+        {
+            const IOTHUB_CLIENT_MQTT_IDLE_OPTIONS* idle_options = (const IOTHUB_CLIENT_MQTT_IDLE_OPTIONS*)value;
+            MQTT_CLIENT_IDLE_OPTIONS client_idle_options;
+            client_idle_options.minPingIntervalSec = idle_options->min_ping_interval_secs;
+            client_idle_options.pingIntervalStepSec = idle_options->ping_interval_step_secs;
+            client_idle_options.radioTailMs = idle_options->radio_tail_ms;
+
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_031: [ If the option parameter is set to "mqtt_idle_mode" the value shall be a const IOTHUB_CLIENT_MQTT_IDLE_OPTIONS*, passed on to mqtt_client_set_idle_options; a min_ping_interval_secs of 0 shall turn the idle mode off by passing NULL. ] */
+            if (mqtt_client_set_idle_options(transport_data->mqttClient, (idle_options->min_ping_interval_secs == 0) ? NULL : &client_idle_options) != 0)
+            {
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_032: [ If mqtt_client_set_idle_options fails, IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_ERROR. ] */
+                LogError("failure setting the mqtt idle mode");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                transport_data->idle_options = *idle_options;
+                transport_data->idle_mode = (idle_options->min_ping_interval_secs != 0);
+                transport_data->telemetry_held = false;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(OPTION_MQTT_INFLIGHT_WINDOW, option) == 0)
+        {
+            int* window = (int*)value;
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_020: [ If the option parameter is set to "mqtt_inflight_window" and the int value is not between 1 and 1024, IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ] */
+            if (*window <= 0 || *window > MAX_TELEMETRY_INFLIGHT_WINDOW)
+            {
+                LogError("invalid mqtt_inflight_window %d", *window);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else if ((size_t)*window == transport_data->telemetry_window)
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_021: [ If messages are waiting for PUBACK, IoTHubTransport_MQTT_Common_SetOption shall not change the window and shall return IOTHUB_CLIENT_ERROR. ] */
+            else if (transport_data->telemetry_inflight_count != 0)
+            {
+                LogError("mqtt_inflight_window cannot change while messages are waiting for PUBACK");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_022: [ Otherwise IoTHubTransport_MQTT_Common_SetOption shall reallocate the slots for the new window. ] */
+            else if (create_telemetry_slots(transport_data, (size_t)*window) != 0)
+            {
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_039: [If the option parameter is set to "x509certificate" then the value shall be a const char of the certificate to be used for x509.] */
         else if ((strcmp(OPTION_X509_CERT, option) == 0) && (cred_type != IOTHUB_CREDENTIAL_TYPE_X509 && cred_type != IOTHUB_CREDENTIAL_TYPE_UNKNOWN))
         {
@@ -3349,6 +3871,7 @@ void IoTHubTransport_MQTT_Common_Unsubscribe_InputQueue(IOTHUB_DEVICE_HANDLE han
         STRING_delete(transport_data->topic_InputQueue);
         transport_data->topic_InputQueue = NULL;
         transport_data->topics_ToSubscribe &= ~SUBSCRIBE_INPUT_QUEUE_TOPIC;
+        transport_data->session_topics &= ~SUBSCRIBE_INPUT_QUEUE_TOPIC;
     }
     else
     {
@@ -3373,3 +3896,34 @@ int IoTHubTransport_MQTT_SetCallbackContext(TRANSPORT_LL_HANDLE handle, void* ct
     }
     return result;
 }
+
+int IoTHubTransport_MQTT_Common_GetTrafficStatistics(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_SEND_STATISTICS* statistics)
+{
+    int result;
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_023: [ If handle or statistics is NULL, IoTHubTransport_MQTT_Common_GetTrafficStatistics shall return a non-zero value. ] */
+    if (handle == NULL || statistics == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, statistics: %p", handle, statistics);
+        result = __FAILURE__;
+    }
+    else
+    {
+        MQTTTRANSPORT_HANDLE_DATA* transport_data = (MQTTTRANSPORT_HANDLE_DATA*)handle;
+        MQTT_CLIENT_RADIO_STATISTICS radio_statistics;
+        if (mqtt_client_get_radio_statistics(transport_data->mqttClient, &radio_statistics) != 0)
+        {
+            LogError("failure getting the MQTT traffic counters");
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_01_024: [ IoTHubTransport_MQTT_Common_GetTrafficStatistics shall set bytes_sent, bytes_received, radio_wake_ups and keep_alive_pings of statistics from mqtt_client_get_radio_statistics and leave the other fields as they are. ] */
+            statistics->bytes_sent = radio_statistics.bytesSent;
+            statistics->bytes_received = radio_statistics.bytesReceived;
+            statistics->radio_wake_ups = radio_statistics.radioWakeUps;
+            statistics->keep_alive_pings = radio_statistics.pingsSent;
+            result = 0;
+        }
+    }
+    return result;
+}
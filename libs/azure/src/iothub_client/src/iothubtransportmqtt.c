@@ -168,6 +168,16 @@ static int IotHubTransportMqtt_SetCallbackContext(TRANSPORT_LL_HANDLE handle, vo
     return IoTHubTransport_MQTT_SetCallbackContext(handle, ctx);
 }
 
+static int IotHubTransportMqtt_GetTrafficStatistics(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_SEND_STATISTICS* statistics)
+{
+    return IoTHubTransport_MQTT_Common_GetTrafficStatistics(handle, statistics);
+}
+
+static int IotHubTransportMqtt_DoWorkWithBudget(TRANSPORT_LL_HANDLE handle, const IOTHUB_CLIENT_DOWORK_BUDGET* budget, uint32_t* next_call_in_ms)
+{
+    return IoTHubTransport_MQTT_Common_DoWorkWithBudget(handle, budget, next_call_in_ms);
+}
+
 static TRANSPORT_PROVIDER myfunc =
 {
     IoTHubTransportMqtt_SendMessageDisposition,     /*pfIotHubTransport_SendMessageDisposition IoTHubTransport_SendMessageDisposition;*/
@@ -190,7 +200,9 @@ static TRANSPORT_PROVIDER myfunc =
     IoTHubTransportMqtt_GetSendStatus,              /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
     IotHubTransportMqtt_Subscribe_InputQueue,       /*pfIoTHubTransport_Subscribe_InputQueue IoTHubTransport_Subscribe_InputQueue; */
     IotHubTransportMqtt_Unsubscribe_InputQueue,     /*pfIoTHubTransport_Unsubscribe_InputQueue IoTHubTransport_Unsubscribe_InputQueue; */
-    IotHubTransportMqtt_SetCallbackContext          /*pfIoTHubTransport_SetCallbackContext IoTHubTransport_SetCallbackContext; */
+    IotHubTransportMqtt_SetCallbackContext,         /*pfIoTHubTransport_SetCallbackContext IoTHubTransport_SetCallbackContext; */
+    IotHubTransportMqtt_GetTrafficStatistics,       /*pfIoTHubTransport_GetTrafficStatistics IoTHubTransport_GetTrafficStatistics; */
+    IotHubTransportMqtt_DoWorkWithBudget            /*pfIoTHubTransport_DoWorkWithBudget IoTHubTransport_DoWorkWithBudget; */
 };
 
 /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_022: [This function shall return a pointer to a structure of type TRANSPORT_PROVIDER */
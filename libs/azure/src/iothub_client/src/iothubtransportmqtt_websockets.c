@@ -225,6 +225,16 @@ static int IotHubTransportMqtt_WS_SetCallbackContext(TRANSPORT_LL_HANDLE handle,
     return IoTHubTransport_MQTT_SetCallbackContext(handle, ctx);
 }
 
+static int IotHubTransportMqtt_WS_GetTrafficStatistics(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_SEND_STATISTICS* statistics)
+{
+    return IoTHubTransport_MQTT_Common_GetTrafficStatistics(handle, statistics);
+}
+
+static int IotHubTransportMqtt_WS_DoWorkWithBudget(TRANSPORT_LL_HANDLE handle, const IOTHUB_CLIENT_DOWORK_BUDGET* budget, uint32_t* next_call_in_ms)
+{
+    return IoTHubTransport_MQTT_Common_DoWorkWithBudget(handle, budget, next_call_in_ms);
+}
+
 /* Codes_SRS_IOTHUB_MQTT_WEBSOCKET_TRANSPORT_07_011: [ This function shall return a pointer to a structure of type TRANSPORT_PROVIDER having the following values for its fields:
 IoTHubTransport_SendMessageDisposition = IoTHubTransport_WS_SendMessageDisposition
 IoTHubTransport_Subscribe_DeviceMethod = IoTHubTransport_WS_Subscribe_DeviceMethod
@@ -259,7 +269,9 @@ static TRANSPORT_PROVIDER thisTransportProvider_WebSocketsOverTls = {
     IoTHubTransportMqtt_WS_GetSendStatus,
     IoTHubTransportMqtt_WS_Subscribe_InputQueue,
     IoTHubTransportMqtt_WS_Unsubscribe_InputQueue,
-    IotHubTransportMqtt_WS_SetCallbackContext
+    IotHubTransportMqtt_WS_SetCallbackContext,
+    IotHubTransportMqtt_WS_GetTrafficStatistics,
+    IotHubTransportMqtt_WS_DoWorkWithBudget
 };
 
 const TRANSPORT_PROVIDER* MQTT_WebSocket_Protocol(void)
@@ -312,7 +312,7 @@ static int create_application_properties_to_encode(MESSAGE_HANDLE message_batch_
     AMQP_VALUE uamqp_properties_map = NULL;
     int result;
 
-    if ((properties_map = IoTHubMessage_Properties(messageHandle)) == NULL)
+    if ((properties_map = IoTHubMessage_GetReadOnlyProperties(messageHandle)) == NULL)
     {
         LogError("Failed to get property map from IoTHub message.");
         result = __FAILURE__;
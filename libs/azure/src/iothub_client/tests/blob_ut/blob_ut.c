@@ -79,6 +79,20 @@ static void my_BUFFER_delete(BUFFER_HANDLE h)
     my_gballoc_free(h);
 }
 
+static BUFFER_HANDLE my_BUFFER_new(void)
+{
+    return (BUFFER_HANDLE)my_gballoc_malloc(1);
+}
+
+/*the block and the block list are written here, big enough for the few blocks the tests upload*/
+static unsigned char streamBufferStorage[4096];
+
+static unsigned char* my_BUFFER_u_char(BUFFER_HANDLE handle)
+{
+    (void)handle;
+    return streamBufferStorage;
+}
+
 static HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
 {
     return (HTTP_HEADERS_HANDLE)my_gballoc_malloc(1);
@@ -234,6 +248,53 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_GetFakeData_Callback
     return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
 }
 
+/**
+ * STREAM_UPLOAD_CONTEXT and FileUpload_Read_Callback
+ * allow to simulate a file of size "size" read in blocks
+ */
+typedef struct STREAM_UPLOAD_CONTEXT_TAG
+{
+    size_t size; /* size of the file */
+    size_t lastOffset; /* offset of the last read */
+    unsigned int readCount; /* number of reads */
+    int abortOnRead; /* the callback shall abort if the read asked is equal to this value */
+    unsigned int lastUploadedCount; /* last count given to on_block_uploaded */
+}STREAM_UPLOAD_CONTEXT;
+
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_Read_Callback(size_t offset, unsigned char* buffer, size_t size, size_t* bytesRead, void* _uploadContext)
+{
+    STREAM_UPLOAD_CONTEXT* uploadContext = (STREAM_UPLOAD_CONTEXT*)_uploadContext;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT result;
+
+    uploadContext->lastOffset = offset;
+    if (uploadContext->abortOnRead == (int)uploadContext->readCount)
+    {
+        result = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT;
+    }
+    else
+    {
+        *bytesRead = (offset >= uploadContext->size) ? 0 : ((uploadContext->size - offset > size) ? size : uploadContext->size - offset);
+        (void)memset(buffer, 'a', *bytesRead);
+        result = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+    }
+    uploadContext->readCount++;
+    return result;
+}
+
+static void on_block_uploaded(unsigned int blockCount, void* _uploadContext)
+{
+    ((STREAM_UPLOAD_CONTEXT*)_uploadContext)->lastUploadedCount = blockCount;
+}
+
+static void init_stream_context(STREAM_UPLOAD_CONTEXT* streamContext, size_t size)
+{
+    (void)memset(streamContext, 0, sizeof(STREAM_UPLOAD_CONTEXT));
+    streamContext->size = size;
+    streamContext->abortOnRead = -1;
+}
+
+#define TEST_STREAM_BLOCK_SIZE 16
+
 BEGIN_TEST_SUITE(blob_ut)
 
 TEST_SUITE_INITIALIZE(TestSuiteInitialize)
@@ -254,6 +315,11 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_create, my_BUFFER_create);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_create, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_new, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_u_char, my_BUFFER_u_char);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_reserve, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_pre_build, __FAILURE__);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
@@ -1623,4 +1689,321 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     gballoc_free(fakeContext.fakeData);
 }
 
+/*Tests_SRS_BLOB_01_001: [ If SASURI, readCallback, blockCount or httpStatus is NULL, or blockSize is 0 or bigger than 4MB, Blob_UploadStreamFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_with_invalid_arguments_fails)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    BLOB_RESULT result[6];
+    init_stream_context(&streamContext, 10);
+
+    ///act
+    result[0] = Blob_UploadStreamFromSasUri(NULL, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+    result[1] = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, NULL, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+    result[2] = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, NULL, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+    result[3] = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, NULL, testValidBufferHandle, NULL, NULL);
+    result[4] = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, 0, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+    result[5] = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, BLOCK_SIZE + 1, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result[0]);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result[1]);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result[2]);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result[3]);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result[4]);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result[5]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, streamContext.readCount);
+}
+
+/*Tests_SRS_BLOB_01_002: [ If the hostname cannot be determined, then Blob_UploadStreamFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_without_hostname_fails)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, 10);
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri("https:/h.h", TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_01_003: [ Blob_UploadStreamFromSasUri shall allocate the path of the block requests and a BUFFER of blockSize bytes once, and reuse them for every block. ]*/
+/*Tests_SRS_BLOB_01_004: [ Blob_UploadStreamFromSasUri shall call readCallback with the offset blockCount * blockSize and the block buffer. ]*/
+/*Tests_SRS_BLOB_01_006: [ A block shorter than blockSize shall be the last one; a block of 0 bytes shall not be uploaded. ]*/
+/*Tests_SRS_BLOB_01_008: [ Blob_UploadStreamFromSasUri shall PUT the block to base relativePath + "&comp=block&blockid=" + BASE64 encoded block ID, again up to maxBlockRetries times while HTTPAPIEX_ExecuteRequest fails or the HTTP status is 5xx. ]*/
+/*Tests_SRS_BLOB_01_010: [ Once every block is uploaded, Blob_UploadStreamFromSasUri shall PUT the block list of blockCount blocks to base relativePath + "&comp=blocklist". ]*/
+/*Tests_SRS_BLOB_01_011: [ After a block is uploaded, Blob_UploadStreamFromSasUri shall increment blockCount and call onBlockUploaded with it if onBlockUploaded is not NULL. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_uploads_a_block_and_a_half_with_one_buffer)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, TEST_STREAM_BLOCK_SIZE + TEST_STREAM_BLOCK_SIZE / 2);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*hostname*/
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*block path*/
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, 0, TEST_STREAM_BLOCK_SIZE));
+
+    /*first block, full*/
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, NULL, 0));
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+
+    /*second block, half*/
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, NULL, 0));
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_shrink(IGNORED_PTR_ARG, TEST_STREAM_BLOCK_SIZE / 2, true));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+
+    /*block list*/
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_construct(TEST_RELATIVE_PATH_1));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist"));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, on_block_uploaded, &streamContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 2, blockCount);
+    ASSERT_ARE_EQUAL(int, 2, streamContext.lastUploadedCount);
+    ASSERT_ARE_EQUAL(int, 2, streamContext.readCount);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+}
+
+/*Tests_SRS_BLOB_01_006: [ A block shorter than blockSize shall be the last one; a block of 0 bytes shall not be uploaded. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_with_a_multiple_of_the_block_size_reads_once_more_and_succeeds)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, 3 * TEST_STREAM_BLOCK_SIZE);
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 3, blockCount);
+    ASSERT_ARE_EQUAL(int, 4, streamContext.readCount);
+    ASSERT_ARE_EQUAL(int, 3 * TEST_STREAM_BLOCK_SIZE, streamContext.lastOffset);
+}
+
+/*Tests_SRS_BLOB_01_004: [ Blob_UploadStreamFromSasUri shall call readCallback with the offset blockCount * blockSize and the block buffer. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_resumes_after_the_uploaded_blocks)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 2;
+    init_stream_context(&streamContext, 3 * TEST_STREAM_BLOCK_SIZE + 1);
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, on_block_uploaded, &streamContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 4, blockCount);
+    ASSERT_ARE_EQUAL(int, 2, streamContext.readCount);
+    ASSERT_ARE_EQUAL(int, 3 * TEST_STREAM_BLOCK_SIZE, streamContext.lastOffset);
+    ASSERT_ARE_EQUAL(int, 4, streamContext.lastUploadedCount);
+}
+
+/*Tests_SRS_BLOB_01_008: [ Blob_UploadStreamFromSasUri shall PUT the block to base relativePath + "&comp=block&blockid=" + BASE64 encoded block ID, again up to maxBlockRetries times while HTTPAPIEX_ExecuteRequest fails or the HTTP status is 5xx. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_sends_a_block_again_after_a_failure_and_a_5xx)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    const unsigned int FiveHundredThree = 503;
+    init_stream_context(&streamContext, TEST_STREAM_BLOCK_SIZE / 2);
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&FiveHundredThree, sizeof(FiveHundredThree));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 2, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 1, blockCount);
+    ASSERT_ARE_EQUAL(int, 1, streamContext.readCount);
+}
+
+/*Tests_SRS_BLOB_01_008: [ Blob_UploadStreamFromSasUri shall PUT the block to base relativePath + "&comp=block&blockid=" + BASE64 encoded block ID, again up to maxBlockRetries times while HTTPAPIEX_ExecuteRequest fails or the HTTP status is 5xx. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_when_the_retries_fail_returns_BLOB_HTTP_ERROR_with_the_uploaded_blocks)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, 3 * TEST_STREAM_BLOCK_SIZE);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, 0, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, NULL, 0));
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, NULL, 0));
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 1, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_HTTP_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 1, blockCount);
+}
+
+/*Tests_SRS_BLOB_01_009: [ If the block is answered with a status >= 300, Blob_UploadStreamFromSasUri shall stop and return BLOB_OK. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_when_a_block_gets_a_404_stops_without_committing)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, 3 * TEST_STREAM_BLOCK_SIZE);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, 0, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, NULL, 0));
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, TEST_STREAM_BLOCK_SIZE));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_To_Buffer(IGNORED_PTR_ARG, 6, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&FourHundredFour, sizeof(FourHundredFour));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 3, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 404, httpResponse);
+    ASSERT_ARE_EQUAL(int, 0, blockCount);
+}
+
+/*Tests_SRS_BLOB_01_005: [ If readCallback returns IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT, Blob_UploadStreamFromSasUri shall return BLOB_ABORTED. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_returns_BLOB_ABORTED_when_the_read_aborts)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, 3 * TEST_STREAM_BLOCK_SIZE);
+    streamContext.abortOnRead = 1;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ABORTED, result);
+    ASSERT_ARE_EQUAL(int, 1, blockCount);
+    ASSERT_ARE_EQUAL(int, 2, streamContext.readCount);
+}
+
+/*Tests_SRS_BLOB_01_007: [ If the file has more than 50000 blocks, Blob_UploadStreamFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadStreamFromSasUri_when_the_file_has_too_many_blocks_fails)
+{
+    ///arrange
+    STREAM_UPLOAD_CONTEXT streamContext;
+    unsigned int blockCount = 0;
+    init_stream_context(&streamContext, (MAX_BLOCK_COUNT + 1) * TEST_STREAM_BLOCK_SIZE);
+
+    ///act
+    BLOB_RESULT result = Blob_UploadStreamFromSasUri(TEST_VALID_SASURI_1, TEST_STREAM_BLOCK_SIZE, 0, FileUpload_Read_Callback, &streamContext, &blockCount, NULL, NULL, &httpResponse, testValidBufferHandle, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(int, MAX_BLOCK_COUNT, blockCount);
+}
+
 END_TEST_SUITE(blob_ut);
@@ -29,6 +29,7 @@ static void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/agenttime.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/sastoken_cache.h"
 #include "azure_c_shared_utility/xio.h"
 
 #ifdef USE_PROV_MODULE
@@ -50,6 +51,7 @@ static const char* TEST_KEYNAME_VALUE = "Test_keyname_value";
 static size_t TEST_EXPIRY_TIME = 1;
 
 #define TEST_TIME_VALUE                     (time_t)123456
+#define TEST_SASTOKEN_CACHE_HANDLE          (SASTOKEN_CACHE_HANDLE)0x4242
 
 TEST_DEFINE_ENUM_TYPE(IOTHUB_CREDENTIAL_TYPE, IOTHUB_CREDENTIAL_TYPE_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_CREDENTIAL_TYPE, IOTHUB_CREDENTIAL_TYPE_VALUES);
@@ -117,6 +119,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(XDA_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SECURITY_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SASTOKEN_CACHE_HANDLE, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -135,6 +138,13 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
     REGISTER_GLOBAL_MOCK_HOOK(STRING_construct, my_STRING_construct);
     REGISTER_GLOBAL_MOCK_RETURN(SASToken_Validate, true);
+
+    REGISTER_GLOBAL_MOCK_RETURN(SASToken_Cache_Create, TEST_SASTOKEN_CACHE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_Cache_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(SASToken_Cache_GetToken, TEST_SAS_TOKEN);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_Cache_GetToken, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(SASToken_Cache_Matches, true);
+    REGISTER_GLOBAL_MOCK_RETURN(SASToken_Cache_DoWork, 0);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -378,6 +388,7 @@ TEST_FUNCTION(IoTHubClient_Auth_Destroy_succeed)
 #ifdef USE_PROV_MODULE
     STRICT_EXPECTED_CALL(iothub_device_auth_destroy(IGNORED_PTR_ARG));
 #endif
+    STRICT_EXPECTED_CALL(SASToken_Cache_Destroy(NULL));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -718,4 +729,249 @@ TEST_FUNCTION(IoTHubClient_Auth_Is_SasToken_Valid_sas_token_succeed)
     IoTHubClient_Auth_Destroy(handle);
 }
 
+/* Codes_SRS_IoTHub_Authorization_01_027: [ if handle is NULL, IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_handle_NULL_fail)
+{
+    //arrange
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(NULL, SCOPE_NAME, TEST_EXPIRY_TIME, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_028: [ If the credential type is IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN IoTHubClient_Auth_Get_Cached_SasToken shall return the device_sas_token without copying it. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_sas_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(NULL, DEVICE_ID, TEST_SAS_TOKEN, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, NULL, 0, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_029: [ If the credential type is IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY and scope is NULL, IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_scope_NULL_fail)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, NULL, TEST_EXPIRY_TIME, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_030: [ If there is no token cache, or the cache was made for a different scope, key_name or expiry_time_relative_seconds, IoTHubClient_Auth_Get_Cached_SasToken shall replace it with one created by SASToken_Cache_Create, refreshing every tenth of expiry_time_relative_seconds. ] */
+/* Codes_SRS_IoTHub_Authorization_01_032: [ Otherwise IoTHubClient_Auth_Get_Cached_SasToken shall return the token returned by SASToken_Cache_GetToken. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_device_key_creates_the_cache)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_Destroy(NULL));
+    STRICT_EXPECTED_CALL(SASToken_Cache_Create(DEVICE_KEY, SCOPE_NAME, TEST_KEYNAME_VALUE, 3600, 360));
+    STRICT_EXPECTED_CALL(SASToken_Cache_GetToken(TEST_SASTOKEN_CACHE_HANDLE));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_030: [ If there is no token cache, or the cache was made for a different scope, key_name or expiry_time_relative_seconds, IoTHubClient_Auth_Get_Cached_SasToken shall replace it with one created by SASToken_Cache_Create, refreshing every tenth of expiry_time_relative_seconds. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_short_expiry_refreshes_every_second)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_Destroy(NULL));
+    STRICT_EXPECTED_CALL(SASToken_Cache_Create(DEVICE_KEY, SCOPE_NAME, NULL, TEST_EXPIRY_TIME, 1));
+    STRICT_EXPECTED_CALL(SASToken_Cache_GetToken(TEST_SASTOKEN_CACHE_HANDLE));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_032: [ Otherwise IoTHubClient_Auth_Get_Cached_SasToken shall return the token returned by SASToken_Cache_GetToken. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_reuses_a_matching_cache)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_Matches(TEST_SASTOKEN_CACHE_HANDLE, SCOPE_NAME, TEST_KEYNAME_VALUE, 3600));
+    STRICT_EXPECTED_CALL(SASToken_Cache_GetToken(TEST_SASTOKEN_CACHE_HANDLE));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_030: [ If there is no token cache, or the cache was made for a different scope, key_name or expiry_time_relative_seconds, IoTHubClient_Auth_Get_Cached_SasToken shall replace it with one created by SASToken_Cache_Create, refreshing every tenth of expiry_time_relative_seconds. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_replaces_a_cache_that_does_not_match)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_Matches(TEST_SASTOKEN_CACHE_HANDLE, SCOPE_NAME, TEST_KEYNAME_VALUE, 7200))
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(SASToken_Cache_Destroy(TEST_SASTOKEN_CACHE_HANDLE));
+    STRICT_EXPECTED_CALL(SASToken_Cache_Create(DEVICE_KEY, SCOPE_NAME, TEST_KEYNAME_VALUE, 7200, 720));
+    STRICT_EXPECTED_CALL(SASToken_Cache_GetToken(TEST_SASTOKEN_CACHE_HANDLE));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 7200, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_031: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_cache_create_fail)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_Destroy(NULL));
+    STRICT_EXPECTED_CALL(SASToken_Cache_Create(DEVICE_KEY, SCOPE_NAME, TEST_KEYNAME_VALUE, 3600, 360))
+        .SetReturn(NULL);
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_031: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_get_token_fail)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_Destroy(NULL));
+    STRICT_EXPECTED_CALL(SASToken_Cache_Create(DEVICE_KEY, SCOPE_NAME, TEST_KEYNAME_VALUE, 3600, 360));
+    STRICT_EXPECTED_CALL(SASToken_Cache_GetToken(TEST_SASTOKEN_CACHE_HANDLE))
+        .SetReturn(NULL);
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_033: [ For any other credential type IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_x509_fail)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(NULL, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Set_x509_Type(handle, true);
+    umock_c_reset_all_calls();
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_034: [ If handle is NULL or no token has been cached yet, IoTHubClient_Auth_Refresh_SasToken shall do nothing. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_without_cache_does_nothing)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken(NULL);
+    IoTHubClient_Auth_Refresh_SasToken(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_01_035: [ Otherwise IoTHubClient_Auth_Refresh_SasToken shall call SASToken_Cache_DoWork so the next token is ready before it is needed. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_refreshes_the_cache)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600, TEST_KEYNAME_VALUE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SASToken_Cache_DoWork(TEST_SASTOKEN_CACHE_HANDLE));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
 END_TEST_SUITE(iothub_client_authorization_ut)
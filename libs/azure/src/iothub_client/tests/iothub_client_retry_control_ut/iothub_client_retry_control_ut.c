@@ -1159,4 +1159,131 @@ TEST_FUNCTION(Reset_success)
     retry_control_destroy(handle);
 }
 
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_001: [If `retry_control_handle` or `wait_time_in_secs` are NULL, `retry_control_get_wait_time` shall fail and return non-zero]
+TEST_FUNCTION(Get_Wait_Time_NULL_handle)
+{
+    // arrange
+    unsigned int wait_time_in_secs;
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = retry_control_get_wait_time(NULL, &wait_time_in_secs);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_002: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_NONE, `wait_time_in_secs` shall be set to RETRY_CONTROL_NO_RETRY]
+TEST_FUNCTION(Get_Wait_Time_RETRY_NONE_success)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_NONE, 10);
+    unsigned int wait_time_in_secs = 0;
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = retry_control_get_wait_time(handle, &wait_time_in_secs);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, RETRY_CONTROL_NO_RETRY, wait_time_in_secs);
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_003: [If `retry_control->retry_count` is 0 or `retry_control->policy` is IOTHUB_CLIENT_RETRY_IMMEDIATE, `wait_time_in_secs` shall be set to 0]
+TEST_FUNCTION(Get_Wait_Time_no_retry_yet_success)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_INTERVAL, 0);
+    unsigned int wait_time_in_secs = 1234;
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = retry_control_get_wait_time(handle, &wait_time_in_secs);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, wait_time_in_secs);
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_004: [If `retry_control->last_retry_time` is INDEFINITE_TIME or get_time() fails, `retry_control_get_wait_time` shall fail and return non-zero]
+TEST_FUNCTION(Get_Wait_Time_get_time_fails)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_INTERVAL, 0);
+    unsigned int wait_time_in_secs;
+    RETRY_ACTION retry_action;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    (void)retry_control_should_retry(handle, &retry_action);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(INDEFINITE_TIME);
+
+    // act
+    int result = retry_control_get_wait_time(handle, &wait_time_in_secs);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_01_005: [Otherwise `wait_time_in_secs` shall be set to the seconds left until (`current_time` - `retry_control->last_retry_time`) reaches `retry_control->current_wait_time_in_secs`, 0 if it already did]
+TEST_FUNCTION(Get_Wait_Time_INTERVAL_success)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_INTERVAL, 0);
+    time_t retry_time = TEST_current_time;
+    time_t current_time = add_seconds(retry_time, 2);
+    unsigned int wait_time_in_secs = 0;
+    RETRY_ACTION retry_action;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(retry_time);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(retry_time);
+    (void)retry_control_should_retry(handle, &retry_action);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+    STRICT_EXPECTED_CALL(get_difftime(current_time, retry_time)).SetReturn(1.5);
+
+    // act
+    int result = retry_control_get_wait_time(handle, &wait_time_in_secs);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    // the default interval is 5 seconds
+    ASSERT_ARE_EQUAL(int, 4, wait_time_in_secs);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+    STRICT_EXPECTED_CALL(get_difftime(current_time, retry_time)).SetReturn(7);
+
+    result = retry_control_get_wait_time(handle, &wait_time_in_secs);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, wait_time_in_secs);
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
 END_TEST_SUITE(iothub_client_retry_control_ut)
@@ -0,0 +1,586 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#undef ENABLE_MOCKS
+
+#include "iothub_twin_parser.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int real_mallocAndStrcpy_s(char** destination, const char* source);
+#ifdef __cplusplus
+}
+#endif
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+#define TEST_MAX_STRING_LENGTH 16
+static void* TEST_CONTEXT = (void*)0x4242;
+
+/* every callback is written down as "path=value;" */
+static char g_calls[1024];
+static void* g_last_context;
+
+static void test_property_callback(const char* path, const IOTHUB_TWIN_PROPERTY_VALUE* value, void* context)
+{
+    char call[256];
+    switch (value->type)
+    {
+        case IOTHUB_TWIN_PROPERTY_STRING:
+            (void)snprintf(call, sizeof(call), "%s=\"%s\"%u;", path, value->value.string.value, (unsigned int)value->value.string.length);
+            break;
+        case IOTHUB_TWIN_PROPERTY_NUMBER:
+            (void)snprintf(call, sizeof(call), "%s=%g;", path, value->value.number);
+            break;
+        case IOTHUB_TWIN_PROPERTY_BOOLEAN:
+            (void)snprintf(call, sizeof(call), "%s=%s;", path, value->value.boolean ? "true" : "false");
+            break;
+        case IOTHUB_TWIN_PROPERTY_NULL:
+            (void)snprintf(call, sizeof(call), "%s=null;", path);
+            break;
+        default:
+            (void)snprintf(call, sizeof(call), "%s=json:%.*s;", path, (int)value->value.json.length, value->value.json.value);
+            break;
+    }
+    (void)strcat(g_calls, call);
+    g_last_context = context;
+}
+
+static int parse_string(IOTHUB_TWIN_PARSER_HANDLE parser, DEVICE_TWIN_UPDATE_STATE update_state, const char* json)
+{
+    return IoTHubTwinParser_Parse(parser, update_state, (const unsigned char*)json, strlen(json));
+}
+
+static IOTHUB_TWIN_PARSER_HANDLE create_parser_with(const char* path, IOTHUB_TWIN_PROPERTY_TYPE type)
+{
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+    ASSERT_IS_NOT_NULL(parser);
+    ASSERT_ARE_EQUAL(int, 0, IoTHubTwinParser_Register(parser, path, type, test_property_callback, TEST_CONTEXT));
+    umock_c_reset_all_calls();
+    return parser;
+}
+
+BEGIN_TEST_SUITE(iothub_twin_parser_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, real_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+    g_calls[0] = '\0';
+    g_last_context = NULL;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_001: [ If max_string_length is 0, IoTHubTwinParser_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubTwinParser_Create_max_string_length_0_fails)
+{
+    //act
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(0);
+
+    //assert
+    ASSERT_IS_NULL(parser);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_002: [ IoTHubTwinParser_Create shall allocate the parser and a buffer of max_string_length + 1 bytes for the string values, and return a non-NULL handle. ] */
+TEST_FUNCTION(IoTHubTwinParser_Create_succeeds)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_MAX_STRING_LENGTH + 1));
+
+    //act
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+
+    //assert
+    ASSERT_IS_NOT_NULL(parser);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_003: [ If any allocation fails, IoTHubTwinParser_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubTwinParser_Create_allocation_fails)
+{
+    //arrange
+    size_t index;
+    ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_MAX_STRING_LENGTH + 1));
+    umock_c_negative_tests_snapshot();
+
+    for (index = 0; index < umock_c_negative_tests_call_count(); index++)
+    {
+        IOTHUB_TWIN_PARSER_HANDLE parser;
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+
+        //assert
+        ASSERT_IS_NULL(parser, "On failed call %lu", (unsigned long)index);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_004: [ If parser is NULL, IoTHubTwinParser_Destroy shall do nothing. ] */
+TEST_FUNCTION(IoTHubTwinParser_Destroy_NULL_does_nothing)
+{
+    //act
+    IoTHubTwinParser_Destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_005: [ IoTHubTwinParser_Destroy shall free the registrations, the string buffer and the parser. ] */
+TEST_FUNCTION(IoTHubTwinParser_Destroy_frees_everything)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(parser));
+
+    //act
+    IoTHubTwinParser_Destroy(parser);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_006: [ If parser, path or callback is NULL, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Register_NULL_arguments_fail)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+    umock_c_reset_all_calls();
+
+    //act
+    int result1 = IoTHubTwinParser_Register(NULL, "/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, NULL);
+    int result2 = IoTHubTwinParser_Register(parser, NULL, IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, NULL);
+    int result3 = IoTHubTwinParser_Register(parser, "/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER, NULL, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_007: [ If path does not start with '/' or is longer than 256 characters, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_008: [ If type is not a IOTHUB_TWIN_PROPERTY_TYPE value, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Register_invalid_path_or_type_fails)
+{
+    //arrange
+    char long_path[258];
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+    (void)memset(long_path, 'a', sizeof(long_path) - 1);
+    long_path[0] = '/';
+    long_path[sizeof(long_path) - 1] = '\0';
+    umock_c_reset_all_calls();
+
+    //act
+    int result1 = IoTHubTwinParser_Register(parser, "desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, NULL);
+    int result2 = IoTHubTwinParser_Register(parser, "", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, NULL);
+    int result3 = IoTHubTwinParser_Register(parser, long_path, IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, NULL);
+    int result4 = IoTHubTwinParser_Register(parser, "/desired/interval", (IOTHUB_TWIN_PROPERTY_TYPE)42, test_property_callback, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result4);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_009: [ IoTHubTwinParser_Register shall add a copy of path, with type, callback and context, to the registrations and return 0. ] */
+TEST_FUNCTION(IoTHubTwinParser_Register_succeeds)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "/desired/interval"));
+
+    //act
+    int result = IoTHubTwinParser_Register(parser, "/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, TEST_CONTEXT);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_010: [ If any allocation fails, IoTHubTwinParser_Register shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Register_allocation_fails)
+{
+    //arrange
+    size_t index;
+    IOTHUB_TWIN_PARSER_HANDLE parser = IoTHubTwinParser_Create(TEST_MAX_STRING_LENGTH);
+    umock_c_reset_all_calls();
+    ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "/desired/interval"));
+    umock_c_negative_tests_snapshot();
+
+    for (index = 0; index < umock_c_negative_tests_call_count(); index++)
+    {
+        int result;
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        result = IoTHubTwinParser_Register(parser, "/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, TEST_CONTEXT);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result, "On failed call %lu", (unsigned long)index);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_011: [ If parser or payload is NULL, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_NULL_arguments_fail)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result1 = IoTHubTwinParser_Parse(NULL, DEVICE_TWIN_UPDATE_COMPLETE, (const unsigned char*)"{}", 2);
+    int result2 = IoTHubTwinParser_Parse(parser, DEVICE_TWIN_UPDATE_COMPLETE, NULL, 2);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(char_ptr, "", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_012: [ For every value whose path is registered, IoTHubTwinParser_Parse shall call the callbacks registered for it with the path as registered, the value and the context. ] */
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_022: [ IoTHubTwinParser_Parse shall read the payload once, without allocating memory. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_full_twin_calls_registered_callbacks)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+    ASSERT_ARE_EQUAL(int, 0, IoTHubTwinParser_Register(parser, "/desired/name", IOTHUB_TWIN_PROPERTY_STRING, test_property_callback, TEST_CONTEXT));
+    ASSERT_ARE_EQUAL(int, 0, IoTHubTwinParser_Register(parser, "/desired/enabled", IOTHUB_TWIN_PROPERTY_BOOLEAN, test_property_callback, TEST_CONTEXT));
+    ASSERT_ARE_EQUAL(int, 0, IoTHubTwinParser_Register(parser, "/desired/$version", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, TEST_CONTEXT));
+    umock_c_reset_all_calls();
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_COMPLETE,
+        "{ \"desired\": { \"interval\": 2.5, \"name\": \"a\\\"b\\u00e9\", \"enabled\": true, \"other\": [1, {\"x\": \"}\"}], \"$version\": 3 },"
+        " \"reported\": { \"interval\": 10, \"name\": \"a string longer than the buffer\" } }");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/interval=2.5;/desired/name=\"a\"b\xc3\xa9\"5;/desired/enabled=true;/desired/$version=3;", g_calls);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_CONTEXT, g_last_context);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_021: [ For DEVICE_TWIN_UPDATE_PARTIAL the members of the payload shall be matched as if they were under "/desired". ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_partial_update_is_under_desired)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"interval\":7,\"$version\":4}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/interval=7;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_013: [ A null value shall be given to every callback registered for its path, whatever type they were registered for. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_null_value_calls_back_any_type)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"interval\":null}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/interval=null;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_014: [ A callback registered for IOTHUB_TWIN_PROPERTY_JSON shall be given the JSON text of the value, whatever its type. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_json_callback_gets_the_value_text)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/config", IOTHUB_TWIN_PROPERTY_JSON);
+    ASSERT_ARE_EQUAL(int, 0, IoTHubTwinParser_Register(parser, "/desired/config/rate", IOTHUB_TWIN_PROPERTY_NUMBER, test_property_callback, TEST_CONTEXT));
+    ASSERT_ARE_EQUAL(int, 0, IoTHubTwinParser_Register(parser, "/desired/level", IOTHUB_TWIN_PROPERTY_JSON, test_property_callback, TEST_CONTEXT));
+    umock_c_reset_all_calls();
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"config\":{\"rate\":1,\"list\":[1,2]},\"level\":12}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/config/rate=1;/desired/config=json:{\"rate\":1,\"list\":[1,2]};/desired/level=json:12;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_015: [ Callbacks registered for another type than the one of the value shall not be called. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_other_type_does_not_call_back)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"interval\":\"7\"}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_016: [ Member names shall be matched against the registered paths with '~' and '/' escaped as "~0" and "~1". ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_escapes_member_names)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/a~1b~0c", IOTHUB_TWIN_PROPERTY_BOOLEAN);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"a/b~c\":false}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/a~1b~0c=false;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_017: [ Array elements shall be matched with their zero based index as the last segment of the path. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_matches_array_elements)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/thresholds/1/max", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"thresholds\":[{\"max\":1},{\"max\":2},{\"max\":3}]}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/thresholds/1/max=2;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_018: [ Values that no registered path is at or below shall be skipped without being decoded. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_skips_unregistered_values)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_COMPLETE,
+        "{\"reported\":{\"log\":\"a string much longer than the sixteen bytes of the buffer\",\"deep\":[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]]]},"
+        "\"desired\":{\"interval\":1}}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/interval=1;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_019: [ If the objects and arrays leading to a registered path are nested more than 16 deep, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_too_deep_fails)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/0/0/0/0/0/0/0/0/0/0/0/0/0/0/0/0/0", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    //act
+    int result = parse_string(parser, DEVICE_TWIN_UPDATE_COMPLETE, "{\"desired\":[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]}");
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_020: [ If a registered string value is longer than max_string_length once unescaped, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_string_too_long_fails)
+{
+    //arrange
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/name", IOTHUB_TWIN_PROPERTY_STRING);
+
+    //act
+    int result1 = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"name\":\"0123456789abcdef\"}");
+    int result2 = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, "{\"name\":\"0123456789abcdefg\"}");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(char_ptr, "/desired/name=\"0123456789abcdef\"16;", g_calls);
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+/* Tests_SRS_IOTHUB_TWIN_PARSER_01_023: [ If the payload is not one JSON value, IoTHubTwinParser_Parse shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubTwinParser_Parse_malformed_payload_fails)
+{
+    //arrange
+    static const char* malformed[] =
+    {
+        "",
+        "{\"interval\":1",
+        "{\"interval\":1}}",
+        "{\"interval\" 1}",
+        "{\"interval\":1e}",
+        "{\"interval\":tru}",
+        "{interval:1}",
+        "{\"other\":[1,2}",
+        "{\"other\":\"\\q\"}",
+        "{\"other\":\"\\ud800\"}"
+    };
+    size_t index;
+    IOTHUB_TWIN_PARSER_HANDLE parser = create_parser_with("/desired/interval", IOTHUB_TWIN_PROPERTY_NUMBER);
+
+    for (index = 0; index < sizeof(malformed) / sizeof(malformed[0]); index++)
+    {
+        //act
+        int result = parse_string(parser, DEVICE_TWIN_UPDATE_PARTIAL, malformed[index]);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result, "Payload %s", malformed[index]);
+    }
+
+    //cleanup
+    IoTHubTwinParser_Destroy(parser);
+}
+
+END_TEST_SUITE(iothub_twin_parser_ut)
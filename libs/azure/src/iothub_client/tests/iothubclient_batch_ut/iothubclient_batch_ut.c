@@ -0,0 +1,735 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/doublylinkedlist.h"
+#include "azure_c_shared_utility/map.h"
+#include "iothub_message.h"
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_client_batch.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/umock_c_prod.h"
+MOCKABLE_FUNCTION(, void, test_confirmation_callback, IOTHUB_CLIENT_CONFIRMATION_RESULT, result, void*, userContextCallback);
+#undef ENABLE_MOCKS
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void real_DList_InitializeListHead(PDLIST_ENTRY listHead);
+    int real_DList_IsListEmpty(const PDLIST_ENTRY listHead);
+    void real_DList_InsertTailList(PDLIST_ENTRY listHead, PDLIST_ENTRY listEntry);
+    void real_DList_InsertHeadList(PDLIST_ENTRY listHead, PDLIST_ENTRY listEntry);
+    void real_DList_AppendTailList(PDLIST_ENTRY listHead, PDLIST_ENTRY ListToAppend);
+    int real_DList_RemoveEntryList(PDLIST_ENTRY listEntry);
+    PDLIST_ENTRY real_DList_RemoveHeadList(PDLIST_ENTRY listHead);
+#ifdef __cplusplus
+}
+#endif
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+#define TEST_MESSAGE_COUNT 4
+static IOTHUB_MESSAGE_HANDLE TEST_BATCHED_MESSAGE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x4242;
+static const char* TEST_PROPERTY_KEY = "sensor";
+static const char* TEST_PAYLOADS[TEST_MESSAGE_COUNT] = { "{\"t\":1}", "{\"t\":2}", "{\"t\":3}", "{\"t\":4}" };
+
+/* the property value of each message; messages with the same value can share a batch */
+static const char* g_property_values[TEST_MESSAGE_COUNT];
+static const char* g_message_id;
+static unsigned char g_created_payload[128];
+static size_t g_created_payload_size;
+
+static IOTHUB_MESSAGE_HANDLE test_message_handle(size_t index)
+{
+    return (IOTHUB_MESSAGE_HANDLE)(uintptr_t)(0x100 + index);
+}
+
+static size_t test_message_index(IOTHUB_MESSAGE_HANDLE handle)
+{
+    return (size_t)((uintptr_t)handle - 0x100);
+}
+
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const unsigned char** buffer, size_t* size)
+{
+    const char* payload = TEST_PAYLOADS[test_message_index(iotHubMessageHandle)];
+    *buffer = (const unsigned char*)payload;
+    *size = strlen(payload);
+    return IOTHUB_MESSAGE_OK;
+}
+
+static MAP_HANDLE my_IoTHubMessage_GetReadOnlyProperties(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    return (MAP_HANDLE)iotHubMessageHandle;
+}
+
+static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    size_t index = test_message_index((IOTHUB_MESSAGE_HANDLE)handle);
+    *keys = &TEST_PROPERTY_KEY;
+    *values = &g_property_values[index];
+    *count = 1;
+    return MAP_OK;
+}
+
+static const char* my_IoTHubMessage_GetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    (void)iotHubMessageHandle;
+    return g_message_id;
+}
+
+static IOTHUB_MESSAGE_HANDLE my_IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
+{
+    ASSERT_IS_TRUE(size <= sizeof(g_created_payload));
+    (void)memcpy(g_created_payload, byteArray, size);
+    g_created_payload_size = size;
+    return TEST_BATCHED_MESSAGE_HANDLE;
+}
+
+static IOTHUB_MESSAGE_LIST* create_test_entry(size_t index, tickcounter_ms_t timesOutAfter)
+{
+    IOTHUB_MESSAGE_LIST* entry = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST));
+    ASSERT_IS_NOT_NULL(entry);
+    entry->messageHandle = test_message_handle(index);
+    entry->callback = test_confirmation_callback;
+    entry->context = (void*)(uintptr_t)(index + 1);
+    entry->ms_timesOutAfter = timesOutAfter;
+    entry->message_timeout_value = 0;
+    entry->message_count = 1;
+    return entry;
+}
+
+static void destroy_test_entry(IOTHUB_MESSAGE_LIST* entry)
+{
+    free(entry);
+}
+
+static IOTHUB_CLIENT_BATCH_HANDLE create_test_batch(size_t max_messages, size_t max_bytes, IOTHUB_CLIENT_BATCH_FORMAT format)
+{
+    IOTHUB_CLIENT_BATCHING_OPTIONS options;
+    options.max_messages = max_messages;
+    options.max_bytes = max_bytes;
+    options.max_latency_ms = 1000;
+    options.format = format;
+    return IoTHubClient_Batch_Create(&options);
+}
+
+BEGIN_TEST_SUITE(iothubclient_batch_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(PDLIST_ENTRY, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_CONFIRMATION_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(DList_InitializeListHead, real_DList_InitializeListHead);
+    REGISTER_GLOBAL_MOCK_HOOK(DList_IsListEmpty, real_DList_IsListEmpty);
+    REGISTER_GLOBAL_MOCK_HOOK(DList_InsertTailList, real_DList_InsertTailList);
+    REGISTER_GLOBAL_MOCK_HOOK(DList_InsertHeadList, real_DList_InsertHeadList);
+    REGISTER_GLOBAL_MOCK_HOOK(DList_AppendTailList, real_DList_AppendTailList);
+    REGISTER_GLOBAL_MOCK_HOOK(DList_RemoveEntryList, real_DList_RemoveEntryList);
+    REGISTER_GLOBAL_MOCK_HOOK(DList_RemoveHeadList, real_DList_RemoveHeadList);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetContentType, IOTHUBMESSAGE_BYTEARRAY);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetByteArray, my_IoTHubMessage_GetByteArray);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetReadOnlyProperties, my_IoTHubMessage_GetReadOnlyProperties);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetMessageId, my_IoTHubMessage_GetMessageId);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_CreateFromByteArray, my_IoTHubMessage_CreateFromByteArray);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_CreateFromByteArray, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_SetProperty, IOTHUB_MESSAGE_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_SetProperty, IOTHUB_MESSAGE_ERROR);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    size_t index;
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+    for (index = 0; index < TEST_MESSAGE_COUNT; index++)
+    {
+        g_property_values[index] = "a";
+    }
+    g_message_id = NULL;
+    g_created_payload_size = 0;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_001: [ If options is NULL, max_messages is less than 2, max_latency_ms is 0 or format is unknown, IoTHubClient_Batch_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Create_NULL_options_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_CLIENT_BATCH_HANDLE batch = IoTHubClient_Batch_Create(NULL);
+
+    //assert
+    ASSERT_IS_NULL(batch);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_001: [ If options is NULL, max_messages is less than 2, max_latency_ms is 0 or format is unknown, IoTHubClient_Batch_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Create_one_message_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(1, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+
+    //assert
+    ASSERT_IS_NULL(batch);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_001: [ If options is NULL, max_messages is less than 2, max_latency_ms is 0 or format is unknown, IoTHubClient_Batch_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Create_zero_latency_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS options = { 10, 0, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+
+    //act
+    IOTHUB_CLIENT_BATCH_HANDLE batch = IoTHubClient_Batch_Create(&options);
+
+    //assert
+    ASSERT_IS_NULL(batch);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_002: [ If allocating the batch fails, IoTHubClient_Batch_Create shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Create_malloc_fails)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+
+    //assert
+    ASSERT_IS_NULL(batch);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_003: [ Otherwise IoTHubClient_Batch_Create shall copy options and return an empty batch. ] */
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_017: [ IoTHubClient_Batch_HasPending shall return true if batch is not NULL and has pending messages, false otherwise. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Create_succeeds)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+
+    //assert
+    ASSERT_IS_NOT_NULL(batch);
+    ASSERT_IS_FALSE(IoTHubClient_Batch_HasPending(batch));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_004: [ If batch is NULL, IoTHubClient_Batch_Destroy shall do nothing. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Destroy_NULL_does_nothing)
+{
+    //arrange
+
+    //act
+    IoTHubClient_Batch_Destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_005: [ IoTHubClient_Batch_Destroy shall call the confirmation callback of every pending message with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, destroy the messages and free the batch. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Destroy_completes_pending_messages)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, (void*)1));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(test_message_handle(0)));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Batch_Destroy(batch);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_006: [ If batch or message is NULL, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_ERROR. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Add_NULL_batch_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_LIST* entry = create_test_entry(0, 0);
+
+    //act
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result = IoTHubClient_Batch_Add(NULL, entry, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_BATCH_ADD_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    destroy_test_entry(entry);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_007: [ If the message has a message id, a correlation id, diagnostic data or the batch-format property, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Add_message_with_id_is_not_batchable)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    IOTHUB_MESSAGE_LIST* entry = create_test_entry(0, 0);
+    g_message_id = "message-1";
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(test_message_handle(0)));
+
+    //act
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result = IoTHubClient_Batch_Add(batch, entry, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE, result);
+    ASSERT_IS_FALSE(IoTHubClient_Batch_HasPending(batch));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    destroy_test_entry(entry);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_008: [ If the payload alone does not fit in max_bytes, or is longer than 65535 bytes with the length prefixed format, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Add_payload_over_max_bytes_is_not_batchable)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 8, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    IOTHUB_MESSAGE_LIST* entry = create_test_entry(0, 0);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result = IoTHubClient_Batch_Add(batch, entry, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_BATCH_ADD_NOT_BATCHABLE, result);
+    ASSERT_IS_FALSE(IoTHubClient_Batch_HasPending(batch));
+
+    //cleanup
+    destroy_test_entry(entry);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_010: [ Otherwise IoTHubClient_Batch_Add shall take ownership of message, keep it pending and return IOTHUB_CLIENT_BATCH_ADD_OK. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Add_first_message_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(test_message_handle(0)));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(test_message_handle(0)));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetDiagnosticPropertyData(test_message_handle(0)));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetProperty(test_message_handle(0), IOTHUB_CLIENT_BATCH_FORMAT_PROPERTY));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(test_message_handle(0)));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(test_message_handle(0), IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result = IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_BATCH_ADD_OK, result);
+    ASSERT_IS_TRUE(IoTHubClient_Batch_HasPending(batch));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_009: [ If messages are pending and the batch is full, the message would take it over max_bytes, or its properties, content type, content encoding or output name differ from the pending ones, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Add_different_properties_flush_first)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    IOTHUB_MESSAGE_LIST* entry = create_test_entry(1, 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    g_property_values[1] = "b";
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result = IoTHubClient_Batch_Add(batch, entry, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST, result);
+
+    //cleanup
+    destroy_test_entry(entry);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_009: [ If messages are pending and the batch is full, the message would take it over max_bytes, or its properties, content type, content encoding or output name differ from the pending ones, IoTHubClient_Batch_Add shall return IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Add_over_max_bytes_flush_first)
+{
+    //arrange
+    /* "[" + 2 * ("{\"t\":n}" + ",") is 17 bytes */
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 20, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    IOTHUB_MESSAGE_LIST* entry = create_test_entry(2, 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 0);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_BATCH_ADD_RESULT result = IoTHubClient_Batch_Add(batch, entry, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_BATCH_ADD_FLUSH_FIRST, result);
+
+    //cleanup
+    destroy_test_entry(entry);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_012: [ If batch is NULL or no message is pending, IoTHubClient_Batch_IsDue shall return false. ] */
+TEST_FUNCTION(IoTHubClient_Batch_IsDue_empty_returns_false)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    umock_c_reset_all_calls();
+
+    //act
+    bool result = IoTHubClient_Batch_IsDue(batch, 5000);
+
+    //assert
+    ASSERT_IS_FALSE(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_011: [ The time of the first pending message shall be now. ] */
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_013: [ IoTHubClient_Batch_IsDue shall return true if max_messages are pending, the pending payloads reach max_bytes, or max_latency_ms have passed since the first pending message was added. ] */
+TEST_FUNCTION(IoTHubClient_Batch_IsDue_after_max_latency_returns_true)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 100);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 900);
+    umock_c_reset_all_calls();
+
+    //act
+    bool early = IoTHubClient_Batch_IsDue(batch, 1099);
+    bool due = IoTHubClient_Batch_IsDue(batch, 1100);
+
+    //assert
+    ASSERT_IS_FALSE(early);
+    ASSERT_IS_TRUE(due);
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_013: [ IoTHubClient_Batch_IsDue shall return true if max_messages are pending, the pending payloads reach max_bytes, or max_latency_ms have passed since the first pending message was added. ] */
+TEST_FUNCTION(IoTHubClient_Batch_IsDue_with_max_messages_returns_true)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(2, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 0);
+    umock_c_reset_all_calls();
+
+    //act
+    bool result = IoTHubClient_Batch_IsDue(batch, 0);
+
+    //assert
+    ASSERT_IS_TRUE(result);
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_021: [ If batch or ms_to_due is NULL or no message is pending, IoTHubClient_Batch_GetTimeToDue shall return false. ] */
+TEST_FUNCTION(IoTHubClient_Batch_GetTimeToDue_empty_returns_false)
+{
+    //arrange
+    tickcounter_ms_t ms_to_due = 12345;
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    umock_c_reset_all_calls();
+
+    //act
+    bool result = IoTHubClient_Batch_GetTimeToDue(batch, 5000, &ms_to_due);
+
+    //assert
+    ASSERT_IS_FALSE(result);
+    ASSERT_IS_TRUE(ms_to_due == 12345);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_022: [ Otherwise IoTHubClient_Batch_GetTimeToDue shall set ms_to_due to 0 if IoTHubClient_Batch_IsDue would return true, and to the milliseconds left until max_latency_ms have passed since the first pending message was added otherwise, and return true. ] */
+TEST_FUNCTION(IoTHubClient_Batch_GetTimeToDue_returns_time_left)
+{
+    //arrange
+    tickcounter_ms_t early_ms = 0;
+    tickcounter_ms_t late_ms = 12345;
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 100);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 900);
+    umock_c_reset_all_calls();
+
+    //act
+    bool early = IoTHubClient_Batch_GetTimeToDue(batch, 1000, &early_ms);
+    bool late = IoTHubClient_Batch_GetTimeToDue(batch, 2000, &late_ms);
+
+    //assert
+    ASSERT_IS_TRUE(early);
+    ASSERT_IS_TRUE(late);
+    ASSERT_IS_TRUE(early_ms == 100);
+    ASSERT_IS_TRUE(late_ms == 0);
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_014: [ If batch is NULL or no message is pending, IoTHubClient_Batch_Flush shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Flush_empty_returns_NULL)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_LIST* result = IoTHubClient_Batch_Flush(batch);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_015: [ If one message is pending, IoTHubClient_Batch_Flush shall return it unchanged. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Flush_one_message_returns_it)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    IOTHUB_MESSAGE_LIST* entry = create_test_entry(0, 0);
+    (void)IoTHubClient_Batch_Add(batch, entry, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_LIST* result = IoTHubClient_Batch_Flush(batch);
+
+    //assert
+    ASSERT_ARE_EQUAL(void_ptr, entry, result);
+    ASSERT_IS_FALSE(IoTHubClient_Batch_HasPending(batch));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    destroy_test_entry(entry);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_018: [ Otherwise IoTHubClient_Batch_Flush shall return a new message whose payload combines the pending payloads in the configured format, with the properties, content type, content encoding and output name of the pending messages and the batch-format property. ] */
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_019: [ The new message shall time out like the first pending message. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Flush_json_array_succeeds)
+{
+    //arrange
+    static const char expected[] = "[{\"t\":1},{\"t\":2}]";
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 1234), 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 5678), 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_SetProperty(TEST_BATCHED_MESSAGE_HANDLE, TEST_PROPERTY_KEY, "a"));
+    STRICT_EXPECTED_CALL(IoTHubMessage_SetProperty(TEST_BATCHED_MESSAGE_HANDLE, IOTHUB_CLIENT_BATCH_FORMAT_PROPERTY, "json-array"));
+
+    //act
+    IOTHUB_MESSAGE_LIST* result = IoTHubClient_Batch_Flush(batch);
+
+    //assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_BATCHED_MESSAGE_HANDLE, result->messageHandle);
+    ASSERT_ARE_EQUAL(size_t, 2, result->message_count);
+    ASSERT_IS_TRUE(result->ms_timesOutAfter == 1234);
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected) - 1, g_created_payload_size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, g_created_payload, g_created_payload_size));
+    ASSERT_IS_FALSE(IoTHubClient_Batch_HasPending(batch));
+
+    //cleanup
+    result->callback(IOTHUB_CLIENT_CONFIRMATION_OK, result->context);
+    free(result);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_018: [ Otherwise IoTHubClient_Batch_Flush shall return a new message whose payload combines the pending payloads in the configured format, with the properties, content type, content encoding and output name of the pending messages and the batch-format property. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Flush_length_prefixed_succeeds)
+{
+    //arrange
+    static const unsigned char expected[] = { 0, 7, '{', '"', 't', '"', ':', '1', '}', 0, 7, '{', '"', 't', '"', ':', '2', '}' };
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_LENGTH_PREFIXED);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 0);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_LIST* result = IoTHubClient_Batch_Flush(batch);
+
+    //assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected), g_created_payload_size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, g_created_payload, g_created_payload_size));
+
+    //cleanup
+    result->callback(IOTHUB_CLIENT_CONFIRMATION_OK, result->context);
+    free(result);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_016: [ When the batched message is completed, the confirmation callback of each of its messages shall be called with the same result, in the order the messages were added, and the messages shall be destroyed. ] */
+TEST_FUNCTION(IoTHubClient_Batch_batched_message_complete_calls_each_callback)
+{
+    //arrange
+    IOTHUB_MESSAGE_LIST* result;
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 0);
+    result = IoTHubClient_Batch_Flush(batch);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, (void*)1));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(test_message_handle(0)));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, (void*)2));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(test_message_handle(1)));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+
+    //act
+    result->callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, result->context);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(result);
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_BATCH_01_020: [ If building the new message fails, IoTHubClient_Batch_Flush shall call the confirmation callback of every pending message with IOTHUB_CLIENT_CONFIRMATION_ERROR, destroy them and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Batch_Flush_create_message_fails_completes_with_error)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCH_HANDLE batch = create_test_batch(10, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(0, 0), 0);
+    (void)IoTHubClient_Batch_Add(batch, create_test_entry(1, 0), 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_CreateFromByteArray(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_ERROR, (void*)1));
+    STRICT_EXPECTED_CALL(test_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_ERROR, (void*)2));
+
+    //act
+    IOTHUB_MESSAGE_LIST* result = IoTHubClient_Batch_Flush(batch);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_IS_FALSE(IoTHubClient_Batch_HasPending(batch));
+
+    //cleanup
+    IoTHubClient_Batch_Destroy(batch);
+}
+
+END_TEST_SUITE(iothubclient_batch_ut)
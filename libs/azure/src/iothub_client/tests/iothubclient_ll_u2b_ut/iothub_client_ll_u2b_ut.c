@@ -159,6 +159,9 @@ static void my_json_value_free(JSON_Value *value)
     free(value);
 }
 
+static size_t g_HTTPAPIEX_ExecuteRequest_calls;
+static size_t g_HTTPAPIEX_ExecuteRequest_failing_call; /*1 based, 0 when no call fails*/
+
 static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
     HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode,
     HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
@@ -170,6 +173,11 @@ static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTT
     (void)requestContent;
     (void)responseHttpHeadersHandle;
     (void)responseContent;
+    g_HTTPAPIEX_ExecuteRequest_calls++;
+    if (g_HTTPAPIEX_ExecuteRequest_calls == g_HTTPAPIEX_ExecuteRequest_failing_call)
+    {
+        return HTTPAPIEX_ERROR;
+    }
     if (statusCode != NULL)
     {
         *statusCode = 200; /*success*/
@@ -177,6 +185,146 @@ static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTT
     return HTTPAPIEX_OK;
 }
 
+/*Blob_UploadStreamFromSasUri uploads TEST_STREAM_BLOCKS_PER_CALL more blocks, then ends with g_stream_result and g_stream_http_status*/
+#define TEST_STREAM_BLOCKS_PER_CALL 2
+static BLOB_RESULT g_stream_result;
+static unsigned int g_stream_http_status;
+static unsigned int g_stream_first_block;
+static size_t g_stream_calls;
+static bool g_stream_saves_progress;
+
+static BLOB_RESULT my_Blob_UploadStreamFromSasUri(const char* SASURI, size_t blockSize, unsigned int maxBlockRetries, IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK readCallback, void* readContext, unsigned int* blockCount,
+    BLOB_ON_BLOCK_UPLOADED onBlockUploaded, void* onBlockUploadedContext, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions)
+{
+    int i;
+    (void)SASURI;
+    (void)blockSize;
+    (void)maxBlockRetries;
+    (void)readCallback;
+    (void)readContext;
+    (void)httpResponse;
+    (void)certificates;
+    (void)proxyOptions;
+    g_stream_calls++;
+    g_stream_first_block = *blockCount;
+    g_stream_saves_progress = (onBlockUploaded != NULL);
+    for (i = 0; i < TEST_STREAM_BLOCKS_PER_CALL; i++)
+    {
+        (*blockCount)++;
+        if (onBlockUploaded != NULL)
+        {
+            onBlockUploaded(*blockCount, onBlockUploadedContext);
+        }
+    }
+    *httpStatus = g_stream_http_status;
+    return g_stream_result;
+}
+
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT test_read_callback(size_t offset, unsigned char* buffer, size_t size, size_t* bytesRead, void* readContext)
+{
+    (void)offset;
+    (void)buffer;
+    (void)size;
+    (void)readContext;
+    *bytesRead = 0;
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
+/*an in-memory file store holding the state file of the streamed uploads*/
+#define TEST_STATE_PATH "upload.state"
+#define TEST_STATE_FILE_CAPACITY 256
+typedef struct TEST_STATE_FILE_TAG
+{
+    unsigned char data[TEST_STATE_FILE_CAPACITY];
+    size_t size;
+    bool exists;
+    bool writes_fail;
+    size_t removes;
+} TEST_STATE_FILE;
+
+static TEST_STATE_FILE g_state_file;
+
+static FILE_STORE_HANDLE test_file_open(const char* path)
+{
+    (void)path;
+    g_state_file.exists = true;
+    return (FILE_STORE_HANDLE)&g_state_file;
+}
+
+static void test_file_close(FILE_STORE_HANDLE file)
+{
+    (void)file;
+}
+
+static int test_file_read(FILE_STORE_HANDLE file, uint32_t offset, unsigned char* buffer, size_t size, size_t* bytes_read)
+{
+    TEST_STATE_FILE* stateFile = (TEST_STATE_FILE*)file;
+    size_t available = (offset < stateFile->size) ? (stateFile->size - offset) : 0;
+    *bytes_read = (size < available) ? size : available;
+    (void)memcpy(buffer, stateFile->data + offset, *bytes_read);
+    return 0;
+}
+
+static int test_file_write(FILE_STORE_HANDLE file, uint32_t offset, const unsigned char* buffer, size_t size)
+{
+    int result;
+    TEST_STATE_FILE* stateFile = (TEST_STATE_FILE*)file;
+    if (stateFile->writes_fail || (offset + size > TEST_STATE_FILE_CAPACITY))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memcpy(stateFile->data + offset, buffer, size);
+        if (offset + size > stateFile->size)
+        {
+            stateFile->size = offset + size;
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static int test_file_flush(FILE_STORE_HANDLE file)
+{
+    (void)file;
+    return 0;
+}
+
+static bool test_file_exists(const char* path)
+{
+    (void)path;
+    return g_state_file.exists;
+}
+
+static int test_file_remove(const char* path)
+{
+    (void)path;
+    g_state_file.exists = false;
+    g_state_file.size = 0;
+    g_state_file.removes++;
+    return 0;
+}
+
+static int test_file_rename(const char* old_path, const char* new_path)
+{
+    (void)old_path;
+    (void)new_path;
+    return __FAILURE__;
+}
+
+static const FILE_STORE_INTERFACE_DESCRIPTION test_file_store =
+{
+    test_file_open,
+    test_file_close,
+    test_file_read,
+    test_file_write,
+    test_file_flush,
+    test_file_exists,
+    test_file_remove,
+    test_file_rename
+};
+
 static HTTPAPIEX_RESULT my_HTTPAPIEX_SAS_ExecuteRequest(HTTPAPIEX_SAS_HANDLE sasHandle, HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
 {
     (void)sasHandle;
@@ -412,6 +560,8 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_READ_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BLOB_ON_BLOCK_UPLOADED, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
@@ -469,6 +619,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SetOption, HTTPAPIEX_ERROR);
 
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Blob_UploadMultipleBlocksFromSasUri, BLOB_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(Blob_UploadStreamFromSasUri, my_Blob_UploadStreamFromSasUri);
 
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __FAILURE__);
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
@@ -484,6 +635,14 @@ TEST_SUITE_CLEANUP(TestClassCleanup)
 static void reset_test_data()
 {
     memset(&context, 0, sizeof(context));
+    memset(&g_state_file, 0, sizeof(g_state_file));
+    g_HTTPAPIEX_ExecuteRequest_calls = 0;
+    g_HTTPAPIEX_ExecuteRequest_failing_call = 0;
+    g_stream_result = BLOB_OK;
+    g_stream_http_status = 201;
+    g_stream_first_block = 0;
+    g_stream_calls = 0;
+    g_stream_saves_progress = false;
 }
 
 TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
@@ -5479,4 +5638,280 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_x509privatekey_fails_when_s
     IoTHubClient_LL_UploadToBlob_Destroy(h);
 }
 
+static void setup_stream_options(IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS* options, size_t blockSize)
+{
+    options->block_size = blockSize;
+    options->max_block_retries = 1;
+    options->file_store = &test_file_store;
+    options->state_path = TEST_STATE_PATH;
+}
+
+/*runs an upload of "text.txt" that storage interrupts after TEST_STREAM_BLOCKS_PER_CALL blocks, leaving it saved*/
+static void interrupt_stream_upload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h, const IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS* options)
+{
+    g_stream_result = BLOB_HTTP_ERROR;
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", options, test_read_callback, NULL));
+    ASSERT_IS_TRUE(g_state_file.exists);
+
+    g_stream_result = BLOB_OK;
+    g_HTTPAPIEX_ExecuteRequest_calls = 0;
+    umock_c_reset_all_calls();
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_035: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall get the correlationId and the SAS URI from the IoTHub as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, and save them to options->state_path when options->file_store is not NULL. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_01_036: [ IoTHubClient_LL_UploadStreamToBlob shall call Blob_UploadStreamFromSasUri with the block size, the retries, readCallback and the count of uploaded blocks, saving the count after every block when the upload is saved. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_01_040: [ Once the IoTHub is notified, IoTHubClient_LL_UploadStreamToBlob shall remove options->state_path and return IOTHUB_CLIENT_OK if the upload succeeded or was aborted, IOTHUB_CLIENT_ERROR otherwise. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_saves_the_upload_and_removes_it_once_notified)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_HTTPAPIEX_ExecuteRequest_calls); /*SAS URI and notification*/
+    ASSERT_ARE_EQUAL(size_t, 1, g_stream_calls);
+    ASSERT_ARE_EQUAL(int, 0, g_stream_first_block);
+    ASSERT_IS_TRUE(g_stream_saves_progress);
+    ASSERT_ARE_EQUAL(size_t, 1, g_state_file.removes);
+    ASSERT_IS_FALSE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_037: [ If the upload is saved and storage could not be reached or answered with a 5xx status, IoTHubClient_LL_UploadStreamToBlob shall keep the saved upload, not notify the IoTHub, and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_keeps_the_upload_when_storage_cannot_be_reached)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    g_stream_result = BLOB_HTTP_ERROR;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_HTTPAPIEX_ExecuteRequest_calls); /*SAS URI only, no notification*/
+    ASSERT_ARE_EQUAL(size_t, 0, g_state_file.removes);
+    ASSERT_IS_TRUE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_037: [ If the upload is saved and storage could not be reached or answered with a 5xx status, IoTHubClient_LL_UploadStreamToBlob shall keep the saved upload, not notify the IoTHub, and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_keeps_the_upload_when_storage_answers_5xx)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    g_stream_http_status = 503;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_HTTPAPIEX_ExecuteRequest_calls); /*SAS URI only, no notification*/
+    ASSERT_ARE_EQUAL(size_t, 0, g_state_file.removes);
+    ASSERT_IS_TRUE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_034: [ If options->state_path holds an upload of destinationFileName with the same block size, IoTHubClient_LL_UploadStreamToBlob shall resume it with its correlationId, SAS URI and count of uploaded blocks, without asking the IoTHub for a new SAS URI. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_resumes_a_saved_upload)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    interrupt_stream_upload(h, &options);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_HTTPAPIEX_ExecuteRequest_calls); /*notification only, no new SAS URI*/
+    ASSERT_ARE_EQUAL(int, TEST_STREAM_BLOCKS_PER_CALL, g_stream_first_block);
+    ASSERT_IS_TRUE(g_stream_saves_progress);
+    ASSERT_ARE_EQUAL(size_t, 1, g_state_file.removes);
+    ASSERT_IS_FALSE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_035: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall get the correlationId and the SAS URI from the IoTHub as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, and save them to options->state_path when options->file_store is not NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_discards_a_corrupt_saved_upload)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    interrupt_stream_upload(h, &options);
+    g_state_file.data[g_state_file.size - 1] ^= 0xFF; /*the count of uploaded blocks no longer matches its complement*/
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_HTTPAPIEX_ExecuteRequest_calls); /*new SAS URI and notification*/
+    ASSERT_ARE_EQUAL(int, 0, g_stream_first_block);
+    ASSERT_IS_FALSE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_035: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall get the correlationId and the SAS URI from the IoTHub as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, and save them to options->state_path when options->file_store is not NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_discards_a_saved_upload_of_another_destination)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    interrupt_stream_upload(h, &options);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "other.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_HTTPAPIEX_ExecuteRequest_calls); /*new SAS URI and notification*/
+    ASSERT_ARE_EQUAL(int, 0, g_stream_first_block);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_035: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall get the correlationId and the SAS URI from the IoTHub as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, and save them to options->state_path when options->file_store is not NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_discards_a_saved_upload_with_another_block_size)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    interrupt_stream_upload(h, &options);
+    options.block_size = 2048;
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_HTTPAPIEX_ExecuteRequest_calls); /*new SAS URI and notification*/
+    ASSERT_ARE_EQUAL(int, 0, g_stream_first_block);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_038: [ Otherwise IoTHubClient_LL_UploadStreamToBlob shall notify the IoTHub of the result as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_goes_on_without_saving_when_saving_the_upload_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    g_state_file.writes_fail = true;
+    g_stream_result = BLOB_HTTP_ERROR;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_stream_calls);
+    ASSERT_IS_FALSE(g_stream_saves_progress);
+    ASSERT_ARE_EQUAL(size_t, 2, g_HTTPAPIEX_ExecuteRequest_calls); /*the upload cannot resume, so the failure is notified*/
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_040: [ Once the IoTHub is notified, IoTHubClient_LL_UploadStreamToBlob shall remove options->state_path and return IOTHUB_CLIENT_OK if the upload succeeded or was aborted, IOTHUB_CLIENT_ERROR otherwise. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_removes_the_upload_when_storage_answers_4xx)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    interrupt_stream_upload(h, &options);
+    g_stream_http_status = 403; /*the saved SAS URI expired*/
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_HTTPAPIEX_ExecuteRequest_calls); /*notification of the failure*/
+    ASSERT_ARE_EQUAL(size_t, 1, g_state_file.removes);
+    ASSERT_IS_FALSE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_039: [ If the notification of a blob that was committed fails, the saved upload shall be kept so that the next call commits and notifies it again. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_keeps_a_committed_upload_when_the_notification_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    g_HTTPAPIEX_ExecuteRequest_failing_call = 2; /*the notification*/
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_HTTPAPIEX_ExecuteRequest_calls);
+    ASSERT_ARE_EQUAL(size_t, 0, g_state_file.removes);
+    ASSERT_IS_TRUE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_039: [ If the notification of a blob that was committed fails, the saved upload shall be kept so that the next call commits and notifies it again. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadStreamToBlob_removes_a_failed_upload_when_the_notification_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_UPLOAD_STREAM_OPTIONS options;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_X509);
+    setup_stream_options(&options, 1024);
+    g_stream_http_status = 403;
+    g_HTTPAPIEX_ExecuteRequest_failing_call = 2; /*the notification*/
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadStreamToBlob_Impl(h, "text.txt", &options, test_read_callback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_state_file.removes);
+    ASSERT_IS_FALSE(g_state_file.exists);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
 END_TEST_SUITE(iothubclient_ll_uploadtoblob_ut)
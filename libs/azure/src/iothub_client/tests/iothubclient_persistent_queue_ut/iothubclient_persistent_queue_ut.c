@@ -0,0 +1,1124 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/map.h"
+#include "iothub_message.h"
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_client_persistent_queue.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/umock_c_prod.h"
+MOCKABLE_FUNCTION(, void, test_replay_callback, IOTHUB_CLIENT_CONFIRMATION_RESULT, result, void*, userContextCallback);
+#undef ENABLE_MOCKS
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int real_mallocAndStrcpy_s(char** destination, const char* source);
+#ifdef __cplusplus
+}
+#endif
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+#define TEST_LOG_PATH "iothubclient_persistent_queue_ut.log"
+#define TEST_COMPACTION_PATH TEST_LOG_PATH ".tmp"
+#define TEST_PAGE_SIZE 128
+#define TEST_MAX_PAGES 4
+#define TEST_MESSAGE_COUNT 64
+#define TEST_PAYLOAD_SIZE 64
+static const char* TEST_PROPERTY_KEY = "sensor";
+
+/* the messages the queue stores (handles 0x100 + index) and the ones it creates on replay (0x400 + index) */
+typedef struct TEST_MESSAGE_TAG
+{
+    unsigned char payload[TEST_PAYLOAD_SIZE];
+    size_t payload_size;
+    char message_id[TEST_PAYLOAD_SIZE];
+    char property_value[TEST_PAYLOAD_SIZE];
+} TEST_MESSAGE;
+
+static TEST_MESSAGE g_stored_messages[TEST_MESSAGE_COUNT];
+static TEST_MESSAGE g_created_messages[TEST_MESSAGE_COUNT];
+static size_t g_created_message_count;
+static size_t g_destroyed_message_count;
+static bool g_fail_file_writes;
+static bool g_fail_file_flushes;
+static size_t g_file_flush_count;
+
+static TEST_MESSAGE* get_test_message(IOTHUB_MESSAGE_HANDLE handle)
+{
+    uintptr_t value = (uintptr_t)handle;
+    return (value >= 0x400) ? &g_created_messages[value - 0x400] : &g_stored_messages[value - 0x100];
+}
+
+static IOTHUB_MESSAGE_HANDLE create_test_message(size_t index, const char* payload)
+{
+    TEST_MESSAGE* message = &g_stored_messages[index];
+    message->payload_size = strlen(payload);
+    (void)memcpy(message->payload, payload, message->payload_size);
+    (void)strcpy(message->message_id, payload);
+    (void)strcpy(message->property_value, payload);
+    return (IOTHUB_MESSAGE_HANDLE)(uintptr_t)(0x100 + index);
+}
+
+static IOTHUB_MESSAGE_HANDLE create_numbered_test_message(size_t index)
+{
+    char payload[16];
+    (void)sprintf(payload, "msg-%03u", (unsigned int)index);
+    return create_test_message(index, payload);
+}
+
+static bool created_message_is(const IOTHUB_MESSAGE_LIST* entry, const char* payload)
+{
+    TEST_MESSAGE* message = get_test_message(entry->messageHandle);
+    return (message->payload_size == strlen(payload)) &&
+        (memcmp(message->payload, payload, message->payload_size) == 0) &&
+        (strcmp(message->message_id, payload) == 0) &&
+        (strcmp(message->property_value, payload) == 0);
+}
+
+static IOTHUBMESSAGE_CONTENT_TYPE my_IoTHubMessage_GetContentType(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    (void)iotHubMessageHandle;
+    return IOTHUBMESSAGE_BYTEARRAY;
+}
+
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const unsigned char** buffer, size_t* size)
+{
+    TEST_MESSAGE* message = get_test_message(iotHubMessageHandle);
+    *buffer = message->payload;
+    *size = message->payload_size;
+    return IOTHUB_MESSAGE_OK;
+}
+
+static const char* my_IoTHubMessage_GetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    return get_test_message(iotHubMessageHandle)->message_id;
+}
+
+static MAP_HANDLE my_IoTHubMessage_GetReadOnlyProperties(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    return (MAP_HANDLE)iotHubMessageHandle;
+}
+
+static const char* g_property_values[1];
+
+static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    g_property_values[0] = get_test_message((IOTHUB_MESSAGE_HANDLE)handle)->property_value;
+    *keys = &TEST_PROPERTY_KEY;
+    *values = g_property_values;
+    *count = 1;
+    return MAP_OK;
+}
+
+static IOTHUB_MESSAGE_HANDLE my_IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
+{
+    TEST_MESSAGE* message = &g_created_messages[g_created_message_count];
+    ASSERT_IS_TRUE(size <= TEST_PAYLOAD_SIZE);
+    (void)memset(message, 0, sizeof(TEST_MESSAGE));
+    (void)memcpy(message->payload, byteArray, size);
+    message->payload_size = size;
+    return (IOTHUB_MESSAGE_HANDLE)(uintptr_t)(0x400 + g_created_message_count++);
+}
+
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_SetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* messageId)
+{
+    (void)strcpy(get_test_message(iotHubMessageHandle)->message_id, messageId);
+    return IOTHUB_MESSAGE_OK;
+}
+
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_SetProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* key, const char* value)
+{
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_KEY, key);
+    (void)strcpy(get_test_message(iotHubMessageHandle)->property_value, value);
+    return IOTHUB_MESSAGE_OK;
+}
+
+static void my_IoTHubMessage_Destroy(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    (void)iotHubMessageHandle;
+    g_destroyed_message_count++;
+}
+
+/* a file store over stdio, standing in for the flash file system of the device */
+static FILE_STORE_HANDLE test_file_open(const char* path)
+{
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        file = fopen(path, "w+b");
+    }
+    return file;
+}
+
+static void test_file_close(FILE_STORE_HANDLE file)
+{
+    (void)fclose((FILE*)file);
+}
+
+static int test_file_read(FILE_STORE_HANDLE file, uint32_t offset, unsigned char* buffer, size_t size, size_t* bytes_read)
+{
+    int result;
+    if (fseek((FILE*)file, (long)offset, SEEK_SET) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        *bytes_read = fread(buffer, 1, size, (FILE*)file);
+        result = 0;
+    }
+    return result;
+}
+
+static int test_file_write(FILE_STORE_HANDLE file, uint32_t offset, const unsigned char* buffer, size_t size)
+{
+    int result;
+    if (g_fail_file_writes || (fseek((FILE*)file, (long)offset, SEEK_SET) != 0) || (fwrite(buffer, 1, size, (FILE*)file) != size))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static int test_file_flush(FILE_STORE_HANDLE file)
+{
+    g_file_flush_count++;
+    return g_fail_file_flushes ? __LINE__ : fflush((FILE*)file);
+}
+
+static bool test_file_exists(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file != NULL)
+    {
+        (void)fclose(file);
+    }
+    return (file != NULL);
+}
+
+static int test_file_remove(const char* path)
+{
+    return remove(path);
+}
+
+static int test_file_rename(const char* old_path, const char* new_path)
+{
+    return rename(old_path, new_path);
+}
+
+static const FILE_STORE_INTERFACE_DESCRIPTION test_file_store =
+{
+    test_file_open,
+    test_file_close,
+    test_file_read,
+    test_file_write,
+    test_file_flush,
+    test_file_exists,
+    test_file_remove,
+    test_file_rename
+};
+
+static long get_test_log_size(void)
+{
+    long result;
+    FILE* file = fopen(TEST_LOG_PATH, "rb");
+    if (file == NULL)
+    {
+        result = -1;
+    }
+    else
+    {
+        (void)fseek(file, 0, SEEK_END);
+        result = ftell(file);
+        (void)fclose(file);
+    }
+    return result;
+}
+
+static void set_test_options(IOTHUB_CLIENT_PERSISTENCE_OPTIONS* options)
+{
+    options->file_store = &test_file_store;
+    options->path = TEST_LOG_PATH;
+    options->page_size = TEST_PAGE_SIZE;
+    options->max_bytes = TEST_PAGE_SIZE * TEST_MAX_PAGES;
+    options->max_replay_rate = 0;
+    options->replay_callback = test_replay_callback;
+    options->replay_context = (void*)0x42;
+}
+
+static IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE create_test_queue(void)
+{
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS options;
+    set_test_options(&options);
+    return IoTHubClient_PersistentQueue_Create(&options);
+}
+
+static void store_test_messages(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue, size_t first, size_t count)
+{
+    size_t index;
+    for (index = first; index < first + count; index++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(index)));
+    }
+}
+
+/* plays the transport: the queue is told how the replayed message went, and the message list is freed */
+static void complete_replayed_message(IOTHUB_MESSAGE_LIST* entry, IOTHUB_CLIENT_CONFIRMATION_RESULT result)
+{
+    entry->callback(result, entry->context);
+    IoTHubMessage_Destroy(entry->messageHandle);
+    free(entry);
+}
+
+static bool replay_next_is(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue, size_t index, IOTHUB_CLIENT_CONFIRMATION_RESULT result)
+{
+    char payload[16];
+    bool is_expected;
+    IOTHUB_MESSAGE_LIST* entry = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+    (void)sprintf(payload, "msg-%03u", (unsigned int)index);
+    is_expected = (entry != NULL) && created_message_is(entry, payload);
+    if (entry != NULL)
+    {
+        complete_replayed_message(entry, result);
+    }
+    return is_expected;
+}
+
+BEGIN_TEST_SUITE(iothubclient_persistent_queue_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_CONFIRMATION_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, real_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetContentType, my_IoTHubMessage_GetContentType);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetByteArray, my_IoTHubMessage_GetByteArray);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetMessageId, my_IoTHubMessage_GetMessageId);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetReadOnlyProperties, my_IoTHubMessage_GetReadOnlyProperties);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_CreateFromByteArray, my_IoTHubMessage_CreateFromByteArray);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_CreateFromByteArray, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_SetMessageId, my_IoTHubMessage_SetMessageId);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_SetProperty, my_IoTHubMessage_SetProperty);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_Destroy, my_IoTHubMessage_Destroy);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+    (void)remove(TEST_LOG_PATH);
+    (void)remove(TEST_COMPACTION_PATH);
+    g_created_message_count = 0;
+    g_destroyed_message_count = 0;
+    g_fail_file_writes = false;
+    g_fail_file_flushes = false;
+    g_file_flush_count = 0;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    (void)remove(TEST_LOG_PATH);
+    (void)remove(TEST_COMPACTION_PATH);
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_001: [ If options, its file_store, any function of the file_store or path is NULL, page_size is not between 64 and 32768 or max_bytes is less than 2 pages, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_NULL_options_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = IoTHubClient_PersistentQueue_Create(NULL);
+
+    //assert
+    ASSERT_IS_NULL(queue);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_001: [ If options, its file_store, any function of the file_store or path is NULL, page_size is not between 64 and 32768 or max_bytes is less than 2 pages, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_small_page_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS options;
+    set_test_options(&options);
+    options.page_size = 32;
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = IoTHubClient_PersistentQueue_Create(&options);
+
+    //assert
+    ASSERT_IS_NULL(queue);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_001: [ If options, its file_store, any function of the file_store or path is NULL, page_size is not between 64 and 32768 or max_bytes is less than 2 pages, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_one_page_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS options;
+    set_test_options(&options);
+    options.max_bytes = TEST_PAGE_SIZE;
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = IoTHubClient_PersistentQueue_Create(&options);
+
+    //assert
+    ASSERT_IS_NULL(queue);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_001: [ If options, its file_store, any function of the file_store or path is NULL, page_size is not between 64 and 32768 or max_bytes is less than 2 pages, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_NULL_file_function_fails)
+{
+    //arrange
+    FILE_STORE_INTERFACE_DESCRIPTION file_store = test_file_store;
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS options;
+    set_test_options(&options);
+    file_store.concrete_file_rename = NULL;
+    options.file_store = &file_store;
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = IoTHubClient_PersistentQueue_Create(&options);
+
+    //assert
+    ASSERT_IS_NULL(queue);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_002: [ If any allocation or opening the file fails, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_malloc_fails)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+
+    //assert
+    ASSERT_IS_NULL(queue);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_002: [ If any allocation or opening the file fails, IoTHubClient_PersistentQueue_Create shall fail and return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_path_copy_fails)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_LOG_PATH))
+        .SetReturn(__LINE__);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+
+    //assert
+    ASSERT_IS_NULL(queue);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_004: [ IoTHubClient_PersistentQueue_Create shall read the log up to its first invalid record, so that the messages stored and not confirmed before a restart are replayed. ] */
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_010: [ IoTHubClient_PersistentQueue_HasStored shall return true if queue is not NULL and holds a message that was not confirmed yet. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_empty_log_succeeds)
+{
+    //arrange
+
+    //act
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+
+    //assert
+    ASSERT_IS_NOT_NULL(queue);
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+    ASSERT_IS_NULL(IoTHubClient_PersistentQueue_GetNext(queue, 0));
+    ASSERT_ARE_EQUAL(long, 0, get_test_log_size());
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_005: [ If queue is NULL, IoTHubClient_PersistentQueue_Destroy shall do nothing. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Destroy_NULL_does_nothing)
+{
+    //arrange
+
+    //act
+    IoTHubClient_PersistentQueue_Destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_007: [ If queue or message is NULL, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_NULL_message_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    umock_c_reset_all_calls();
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_007: [ If queue or message is NULL, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_NULL_queue_fails)
+{
+    //arrange
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(NULL, create_numbered_test_message(0));
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_008: [ If the message does not fit in one page, or the log is full and cannot be compacted, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_message_larger_than_a_page_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    IOTHUB_MESSAGE_HANDLE message = create_test_message(0, "0123456789012345678901234567890123456789");
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, message);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_009: [ Otherwise IoTHubClient_PersistentQueue_Store shall append the payload, message id, correlation id, content type, content encoding, output name and properties of the message to the last page and return 0; the diagnostic data is not stored. ] */
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_014: [ Otherwise IoTHubClient_PersistentQueue_GetNext shall return the next stored message that is not confirmed, in the order they were stored, as a new IOTHUB_MESSAGE_LIST that does not time out. ] */
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_011: [ IoTHubClient_PersistentQueue_IsReplayed shall return true if message was returned by IoTHubClient_PersistentQueue_GetNext of queue. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetNext_returns_the_stored_messages_in_order)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    IOTHUB_MESSAGE_LIST* first;
+    IOTHUB_MESSAGE_LIST* second;
+    IOTHUB_MESSAGE_LIST other;
+    store_test_messages(queue, 0, 2);
+
+    //act
+    first = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+    second = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+
+    //assert
+    ASSERT_IS_TRUE(IoTHubClient_PersistentQueue_HasStored(queue));
+    ASSERT_IS_NOT_NULL(first);
+    ASSERT_IS_NOT_NULL(second);
+    ASSERT_IS_TRUE(created_message_is(first, "msg-000"));
+    ASSERT_IS_TRUE(created_message_is(second, "msg-001"));
+    ASSERT_ARE_EQUAL(int, 0, (int)first->ms_timesOutAfter);
+    ASSERT_ARE_EQUAL(size_t, 1, first->message_count);
+    ASSERT_IS_TRUE(IoTHubClient_PersistentQueue_IsReplayed(queue, first));
+    other.callback = test_replay_callback;
+    other.context = NULL;
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_IsReplayed(queue, &other));
+    ASSERT_IS_NULL(IoTHubClient_PersistentQueue_GetNext(queue, 0));
+
+    //cleanup
+    complete_replayed_message(first, IOTHUB_CLIENT_CONFIRMATION_OK);
+    complete_replayed_message(second, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_016: [ When a replayed message is confirmed with IOTHUB_CLIENT_CONFIRMATION_OK and every message replayed before it is confirmed, it shall be marked as confirmed in the log. ] */
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_018: [ The replay_callback of the options shall be called with the result of each replayed message. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_confirming_every_message_empties_the_queue)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    IOTHUB_MESSAGE_LIST* entry;
+    store_test_messages(queue, 0, 1);
+    entry = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+    ASSERT_IS_NOT_NULL(entry);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_replay_callback(IOTHUB_CLIENT_CONFIRMATION_OK, (void*)0x42));
+
+    //act
+    entry->callback(IOTHUB_CLIENT_CONFIRMATION_OK, entry->context);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+
+    //cleanup
+    IoTHubMessage_Destroy(entry->messageHandle);
+    free(entry);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_004: [ IoTHubClient_PersistentQueue_Create shall read the log up to its first invalid record, so that the messages stored and not confirmed before a restart are replayed. ] */
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_006: [ IoTHubClient_PersistentQueue_Destroy shall write the pending confirmation and the last page, close the file and free the queue. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_replays_the_messages_of_the_last_run)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 3);
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+    IoTHubClient_PersistentQueue_Destroy(queue);
+
+    //act
+    queue = create_test_queue();
+
+    //assert
+    ASSERT_IS_NOT_NULL(queue);
+    ASSERT_IS_TRUE(IoTHubClient_PersistentQueue_HasStored(queue));
+    ASSERT_IS_TRUE(replay_next_is(queue, 1, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_TRUE(replay_next_is(queue, 2, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_004: [ IoTHubClient_PersistentQueue_Create shall read the log up to its first invalid record, so that the messages stored and not confirmed before a restart are replayed. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_stops_at_a_torn_record)
+{
+    //arrange
+    FILE* file;
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 2);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+
+    /* a power loss in the middle of the second record */
+    file = fopen(TEST_LOG_PATH, "r+b");
+    ASSERT_IS_NOT_NULL(file);
+    ASSERT_ARE_EQUAL(int, 0, fseek(file, 60, SEEK_SET));
+    ASSERT_ARE_EQUAL(int, 0xAA, fputc(0xAA, file));
+    (void)fclose(file);
+
+    //act
+    queue = create_test_queue();
+
+    //assert
+    ASSERT_IS_NOT_NULL(queue);
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_NULL(IoTHubClient_PersistentQueue_GetNext(queue, 0));
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+
+    /* the next message replaces the torn one */
+    store_test_messages(queue, 5, 1);
+    ASSERT_IS_TRUE(replay_next_is(queue, 5, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_003: [ If the file at path does not exist but its compaction copy does, IoTHubClient_PersistentQueue_Create shall rename the copy to path. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Create_restores_the_compaction_copy)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 1);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+    ASSERT_ARE_EQUAL(int, 0, rename(TEST_LOG_PATH, TEST_COMPACTION_PATH));
+
+    //act
+    queue = create_test_queue();
+
+    //assert
+    ASSERT_IS_NOT_NULL(queue);
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_FALSE(test_file_exists(TEST_COMPACTION_PATH));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_012: [ If queue is NULL, REPLAY_WINDOW replayed messages are waiting for their result, or a failed replay waits for the others to complete, IoTHubClient_PersistentQueue_GetNext shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetNext_NULL_queue_returns_NULL)
+{
+    //arrange
+
+    //act
+    IOTHUB_MESSAGE_LIST* entry = IoTHubClient_PersistentQueue_GetNext(NULL, 0);
+
+    //assert
+    ASSERT_IS_NULL(entry);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_012: [ If queue is NULL, REPLAY_WINDOW replayed messages are waiting for their result, or a failed replay waits for the others to complete, IoTHubClient_PersistentQueue_GetNext shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetNext_bounds_the_messages_in_flight)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    IOTHUB_MESSAGE_LIST* entries[4];
+    size_t index;
+    store_test_messages(queue, 0, 5);
+    for (index = 0; index < 4; index++)
+    {
+        entries[index] = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+        ASSERT_IS_NOT_NULL(entries[index]);
+    }
+
+    //act
+    IOTHUB_MESSAGE_LIST* entry = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+
+    //assert
+    ASSERT_IS_NULL(entry);
+    complete_replayed_message(entries[0], IOTHUB_CLIENT_CONFIRMATION_OK);
+    ASSERT_IS_TRUE(replay_next_is(queue, 4, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //cleanup
+    for (index = 1; index < 4; index++)
+    {
+        complete_replayed_message(entries[index], IOTHUB_CLIENT_CONFIRMATION_OK);
+    }
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_017: [ When a replayed message completes with any other result, the replay shall start again from the first message that is not confirmed once no replayed message is waiting for its result. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetNext_after_a_failure_replays_again)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    IOTHUB_MESSAGE_LIST* first;
+    IOTHUB_MESSAGE_LIST* second;
+    store_test_messages(queue, 0, 3);
+    first = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+    second = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+    ASSERT_IS_NOT_NULL(first);
+    ASSERT_IS_NOT_NULL(second);
+
+    //act
+    complete_replayed_message(first, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+
+    //assert
+    ASSERT_IS_NULL(IoTHubClient_PersistentQueue_GetNext(queue, 0));
+    complete_replayed_message(second, IOTHUB_CLIENT_CONFIRMATION_OK);
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_TRUE(replay_next_is(queue, 1, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_TRUE(replay_next_is(queue, 2, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_013: [ If max_replay_rate is not 0 and less than 1000 / max_replay_rate ms passed since the last replayed message, IoTHubClient_PersistentQueue_GetNext shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetNext_honors_the_replay_rate)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS options;
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue;
+    IOTHUB_MESSAGE_LIST* first;
+    IOTHUB_MESSAGE_LIST* second;
+    set_test_options(&options);
+    options.max_replay_rate = 2;
+    queue = IoTHubClient_PersistentQueue_Create(&options);
+    store_test_messages(queue, 0, 2);
+    first = IoTHubClient_PersistentQueue_GetNext(queue, 1000);
+    ASSERT_IS_NOT_NULL(first);
+
+    //act
+    second = IoTHubClient_PersistentQueue_GetNext(queue, 1499);
+
+    //assert
+    ASSERT_IS_NULL(second);
+    second = IoTHubClient_PersistentQueue_GetNext(queue, 1500);
+    ASSERT_IS_NOT_NULL(second);
+
+    //cleanup
+    complete_replayed_message(first, IOTHUB_CLIENT_CONFIRMATION_OK);
+    complete_replayed_message(second, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_023: [ Otherwise IoTHubClient_PersistentQueue_GetTimeToNext shall set ms_to_next to the milliseconds left until 1000 / max_replay_rate ms passed since the last replayed message, 0 if they did or max_replay_rate is 0, and return true. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetTimeToNext_follows_the_replay_rate)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS options;
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue;
+    IOTHUB_MESSAGE_LIST* first;
+    tickcounter_ms_t before_first = 1234;
+    tickcounter_ms_t after_first = 1234;
+    set_test_options(&options);
+    options.max_replay_rate = 2;
+    queue = IoTHubClient_PersistentQueue_Create(&options);
+    store_test_messages(queue, 0, 2);
+
+    //act
+    bool can_replay_first = IoTHubClient_PersistentQueue_GetTimeToNext(queue, 1000, &before_first);
+    first = IoTHubClient_PersistentQueue_GetNext(queue, 1000);
+    bool can_replay_second = IoTHubClient_PersistentQueue_GetTimeToNext(queue, 1200, &after_first);
+
+    //assert
+    ASSERT_IS_TRUE(can_replay_first);
+    ASSERT_IS_TRUE(can_replay_second);
+    ASSERT_IS_TRUE(before_first == 0);
+    ASSERT_IS_TRUE(after_first == 300);
+
+    //cleanup
+    complete_replayed_message(first, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_022: [ If queue or ms_to_next is NULL, every stored message that is not confirmed was already replayed, or IoTHubClient_PersistentQueue_GetNext waits for replayed messages to complete, IoTHubClient_PersistentQueue_GetTimeToNext shall return false. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetTimeToNext_everything_replayed_returns_false)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    IOTHUB_MESSAGE_LIST* first;
+    tickcounter_ms_t ms_to_next = 1234;
+    bool empty = IoTHubClient_PersistentQueue_GetTimeToNext(queue, 0, &ms_to_next);
+    store_test_messages(queue, 0, 1);
+    first = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+    ASSERT_IS_NOT_NULL(first);
+
+    //act
+    bool in_flight = IoTHubClient_PersistentQueue_GetTimeToNext(queue, 0, &ms_to_next);
+
+    //assert
+    ASSERT_IS_FALSE(empty);
+    ASSERT_IS_FALSE(in_flight);
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_GetTimeToNext(NULL, 0, &ms_to_next));
+    ASSERT_IS_TRUE(ms_to_next == 1234);
+
+    //cleanup
+    complete_replayed_message(first, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_015: [ If the message cannot be created, IoTHubClient_PersistentQueue_GetNext shall return NULL and try it again on the next call. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_GetNext_create_message_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_CreateFromByteArray(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_MESSAGE_LIST* entry = IoTHubClient_PersistentQueue_GetNext(queue, 0);
+
+    //assert
+    ASSERT_IS_NULL(entry);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_024: [ IoTHubClient_PersistentQueue_Store shall write and flush the last page before it returns 0, so that a message reported as persisted survives a power loss. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_flushes_the_message_before_returning)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(0));
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_file_flush_count);
+    ASSERT_ARE_EQUAL(long, TEST_PAGE_SIZE, get_test_log_size());
+    /* a power loss right after Store must not lose the message */
+    g_fail_file_writes = true;
+    IoTHubClient_PersistentQueue_Destroy(queue);
+    g_fail_file_writes = false;
+    queue = create_test_queue();
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_025: [ If the write or the flush fails, IoTHubClient_PersistentQueue_Store shall remove the message from the last page and fail with a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_fails_when_the_write_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    g_fail_file_writes = true;
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(0));
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+    ASSERT_ARE_EQUAL(size_t, 0, g_file_flush_count);
+    g_fail_file_writes = false;
+    store_test_messages(queue, 1, 1);
+    ASSERT_IS_TRUE(replay_next_is(queue, 1, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_NULL(IoTHubClient_PersistentQueue_GetNext(queue, 0));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_025: [ If the write or the flush fails, IoTHubClient_PersistentQueue_Store shall remove the message from the last page and fail with a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_fails_when_the_flush_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    g_fail_file_flushes = true;
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(0));
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+    /* the message stays with the caller, a restart must not replay it as well */
+    g_fail_file_flushes = false;
+    IoTHubClient_PersistentQueue_Destroy(queue);
+    queue = create_test_queue();
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+    ASSERT_IS_NULL(IoTHubClient_PersistentQueue_GetNext(queue, 0));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_008: [ If the message does not fit in one page, or the log is full and cannot be compacted, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_full_log_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    size_t index = 0;
+    while (IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(index)) == 0)
+    {
+        index++;
+    }
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(index));
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(index >= TEST_MAX_PAGES);
+    ASSERT_IS_TRUE(get_test_log_size() <= TEST_PAGE_SIZE * TEST_MAX_PAGES);
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_008: [ If the message does not fit in one page, or the log is full and cannot be compacted, IoTHubClient_PersistentQueue_Store shall fail and return a non-zero value. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_Store_compacts_a_full_log)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    size_t stored = 0;
+    size_t replayed;
+    while (IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(stored)) == 0)
+    {
+        stored++;
+    }
+    for (replayed = 0; replayed < 3; replayed++)
+    {
+        ASSERT_IS_TRUE(replay_next_is(queue, replayed, IOTHUB_CLIENT_CONFIRMATION_OK));
+    }
+
+    //act
+    int result = IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(stored));
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_FALSE(test_file_exists(TEST_COMPACTION_PATH));
+    ASSERT_IS_TRUE(get_test_log_size() <= TEST_PAGE_SIZE * TEST_MAX_PAGES);
+    stored++;
+    IoTHubClient_PersistentQueue_Destroy(queue);
+    queue = create_test_queue();
+    for (; replayed < stored; replayed++)
+    {
+        ASSERT_IS_TRUE(replay_next_is(queue, replayed, IOTHUB_CLIENT_CONFIRMATION_OK));
+    }
+    ASSERT_IS_FALSE(IoTHubClient_PersistentQueue_HasStored(queue));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_019: [ If queue is NULL, IoTHubClient_PersistentQueue_DoWork shall do nothing. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_DoWork_NULL_does_nothing)
+{
+    //arrange
+
+    //act
+    IoTHubClient_PersistentQueue_DoWork(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_021: [ Otherwise IoTHubClient_PersistentQueue_DoWork shall append a confirmation record if messages were confirmed, then write and flush the last page if it changed. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_DoWork_writes_the_last_page)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 2);
+    g_fail_file_writes = true;
+    ASSERT_ARE_NOT_EQUAL(int, 0, IoTHubClient_PersistentQueue_Store(queue, create_numbered_test_message(2)));
+    g_fail_file_writes = false;
+    g_file_flush_count = 0;
+
+    //act
+    IoTHubClient_PersistentQueue_DoWork(queue);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_file_flush_count);
+    IoTHubClient_PersistentQueue_DoWork(queue);
+    ASSERT_ARE_EQUAL(size_t, 1, g_file_flush_count);
+
+    //cleanup
+    g_fail_file_writes = true;
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_021: [ Otherwise IoTHubClient_PersistentQueue_DoWork shall append a confirmation record if messages were confirmed, then write and flush the last page if it changed. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_DoWork_persists_confirmations)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 2);
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //act
+    IoTHubClient_PersistentQueue_DoWork(queue);
+
+    //assert
+    /* a power loss now must not replay the confirmed message */
+    g_fail_file_writes = true;
+    IoTHubClient_PersistentQueue_Destroy(queue);
+    g_fail_file_writes = false;
+    queue = create_test_queue();
+    ASSERT_IS_TRUE(replay_next_is(queue, 1, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_PERSISTENT_QUEUE_01_020: [ When every stored message is confirmed, IoTHubClient_PersistentQueue_DoWork shall remove the file and start an empty log. ] */
+TEST_FUNCTION(IoTHubClient_PersistentQueue_DoWork_removes_a_confirmed_log)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE queue = create_test_queue();
+    store_test_messages(queue, 0, 2);
+    IoTHubClient_PersistentQueue_DoWork(queue);
+    ASSERT_IS_TRUE(replay_next_is(queue, 0, IOTHUB_CLIENT_CONFIRMATION_OK));
+    ASSERT_IS_TRUE(replay_next_is(queue, 1, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //act
+    IoTHubClient_PersistentQueue_DoWork(queue);
+
+    //assert
+    ASSERT_ARE_EQUAL(long, 0, get_test_log_size());
+    store_test_messages(queue, 2, 1);
+    ASSERT_IS_TRUE(replay_next_is(queue, 2, IOTHUB_CLIENT_CONFIRMATION_OK));
+
+    //cleanup
+    IoTHubClient_PersistentQueue_Destroy(queue);
+}
+
+END_TEST_SUITE(iothubclient_persistent_queue_ut)
@@ -0,0 +1,335 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Sends messages through IoTHubClient_LL into a transport that completes every send on the next DoWork,
+   then reports the peak heap use and how well the gballoc slab pools are used. Build with use_pool_heap. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/doublylinkedlist.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/map.h"
+#include "iothub_client_ll.h"
+#include "iothub_message.h"
+#include "internal/iothub_transport_ll_private.h"
+
+#ifndef GB_USE_POOL_HEAP
+#error iothubclient_pool_soak needs GB_USE_POOL_HEAP (cmake -Duse_pool_heap=ON)
+#endif
+
+#define SOAK_MESSAGE_COUNT  100000
+/* messages queued in the client before the transport gets to run */
+#define SOAK_BATCH_SIZE     10
+
+typedef struct FAKE_TRANSPORT_TAG
+{
+    PDLIST_ENTRY waitingToSend;
+    pfTransport_SendComplete_Callback send_complete_cb;
+    void* transport_ctx;
+} FAKE_TRANSPORT;
+
+static FAKE_TRANSPORT fake_transport;
+static size_t confirmed_count = 0;
+
+static TRANSPORT_LL_HANDLE FakeTransport_Create(const IOTHUBTRANSPORT_CONFIG* config, TRANSPORT_CALLBACKS_INFO* cb_info, void* ctx)
+{
+    (void)config;
+    fake_transport.waitingToSend = NULL;
+    fake_transport.send_complete_cb = cb_info->send_complete_cb;
+    fake_transport.transport_ctx = ctx;
+    return (TRANSPORT_LL_HANDLE)&fake_transport;
+}
+
+static void FakeTransport_Destroy(TRANSPORT_LL_HANDLE handle)
+{
+    (void)handle;
+}
+
+static IOTHUB_DEVICE_HANDLE FakeTransport_Register(TRANSPORT_LL_HANDLE handle, const IOTHUB_DEVICE_CONFIG* device, PDLIST_ENTRY waitingToSend)
+{
+    (void)device;
+    fake_transport.waitingToSend = waitingToSend;
+    return (IOTHUB_DEVICE_HANDLE)handle;
+}
+
+static void FakeTransport_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
+{
+    (void)deviceHandle;
+}
+
+static void FakeTransport_DoWork(TRANSPORT_LL_HANDLE handle)
+{
+    FAKE_TRANSPORT* transport = (FAKE_TRANSPORT*)handle;
+    if (transport->waitingToSend != NULL)
+    {
+        /* acknowledge everything that was queued, the way a transport does when its PUBACKs arrive */
+        DLIST_ENTRY completed;
+        PDLIST_ENTRY entry;
+        DList_InitializeListHead(&completed);
+        while ((entry = DList_RemoveHeadList(transport->waitingToSend)) != transport->waitingToSend)
+        {
+            DList_InsertTailList(&completed, entry);
+        }
+        if (!DList_IsListEmpty(&completed))
+        {
+            transport->send_complete_cb(&completed, IOTHUB_CLIENT_CONFIRMATION_OK, transport->transport_ctx);
+        }
+    }
+}
+
+static int FakeTransport_Subscribe(IOTHUB_DEVICE_HANDLE handle)
+{
+    (void)handle;
+    return 0;
+}
+
+static void FakeTransport_Unsubscribe(IOTHUB_DEVICE_HANDLE handle)
+{
+    (void)handle;
+}
+
+static int FakeTransport_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_RETRY_POLICY retryPolicy, size_t retryTimeoutLimitInSeconds)
+{
+    (void)handle;
+    (void)retryPolicy;
+    (void)retryTimeoutLimitInSeconds;
+    return 0;
+}
+
+static IOTHUB_CLIENT_RESULT FakeTransport_GetSendStatus(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATUS* iotHubClientStatus)
+{
+    FAKE_TRANSPORT* transport = (FAKE_TRANSPORT*)handle;
+    *iotHubClientStatus = DList_IsListEmpty(transport->waitingToSend) ? IOTHUB_CLIENT_SEND_STATUS_IDLE : IOTHUB_CLIENT_SEND_STATUS_BUSY;
+    return IOTHUB_CLIENT_OK;
+}
+
+static IOTHUB_CLIENT_RESULT FakeTransport_SetOption(TRANSPORT_LL_HANDLE handle, const char* optionName, const void* value)
+{
+    (void)handle;
+    (void)optionName;
+    (void)value;
+    return IOTHUB_CLIENT_OK;
+}
+
+static STRING_HANDLE FakeTransport_GetHostname(TRANSPORT_LL_HANDLE handle)
+{
+    (void)handle;
+    return STRING_construct("soak.azure-devices.net");
+}
+
+static IOTHUB_PROCESS_ITEM_RESULT FakeTransport_ProcessItem(TRANSPORT_LL_HANDLE handle, IOTHUB_IDENTITY_TYPE item_type, IOTHUB_IDENTITY_INFO* iothub_item)
+{
+    (void)handle;
+    (void)item_type;
+    (void)iothub_item;
+    return IOTHUB_PROCESS_OK;
+}
+
+static IOTHUB_CLIENT_RESULT FakeTransport_SendMessageDisposition(MESSAGE_CALLBACK_INFO* messageData, IOTHUBMESSAGE_DISPOSITION_RESULT disposition)
+{
+    (void)messageData;
+    (void)disposition;
+    return IOTHUB_CLIENT_OK;
+}
+
+static int FakeTransport_DeviceMethod_Response(IOTHUB_DEVICE_HANDLE handle, METHOD_HANDLE methodId, const unsigned char* response, size_t response_size, int status_response)
+{
+    (void)handle;
+    (void)methodId;
+    (void)response;
+    (void)response_size;
+    (void)status_response;
+    return 0;
+}
+
+static int FakeTransport_SetCallbackContext(TRANSPORT_LL_HANDLE handle, void* ctx)
+{
+    (void)handle;
+    fake_transport.transport_ctx = ctx;
+    return 0;
+}
+
+static TRANSPORT_PROVIDER fake_transport_provider =
+{
+    FakeTransport_SendMessageDisposition,
+    FakeTransport_Subscribe,
+    FakeTransport_Unsubscribe,
+    FakeTransport_DeviceMethod_Response,
+    FakeTransport_Subscribe,
+    FakeTransport_Unsubscribe,
+    FakeTransport_ProcessItem,
+    FakeTransport_GetHostname,
+    FakeTransport_SetOption,
+    FakeTransport_Create,
+    FakeTransport_Destroy,
+    FakeTransport_Register,
+    FakeTransport_Unregister,
+    FakeTransport_Subscribe,
+    FakeTransport_Unsubscribe,
+    FakeTransport_DoWork,
+    FakeTransport_SetRetryPolicy,
+    FakeTransport_GetSendStatus,
+    FakeTransport_Subscribe,
+    FakeTransport_Unsubscribe,
+    FakeTransport_SetCallbackContext,
+    NULL,
+    NULL
+};
+
+static const TRANSPORT_PROVIDER* FakeTransport_ProvideTransportInterface(void)
+{
+    return &fake_transport_provider;
+}
+
+static void send_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* userContextCallback)
+{
+    (void)userContextCallback;
+    if (result == IOTHUB_CLIENT_CONFIRMATION_OK)
+    {
+        confirmed_count++;
+    }
+}
+
+static int send_one_message(IOTHUB_CLIENT_LL_HANDLE client_handle, size_t message_number)
+{
+    int result;
+    char payload[64];
+    char sequence[16];
+    IOTHUB_MESSAGE_HANDLE message_handle;
+    int payload_length = snprintf(payload, sizeof(payload), "{\"deviceId\":\"soak\",\"seq\":%lu,\"temperature\":21.5}", (unsigned long)message_number);
+    (void)snprintf(sequence, sizeof(sequence), "%lu", (unsigned long)message_number);
+
+    if ((message_handle = IoTHubMessage_CreateFromByteArray((const unsigned char*)payload, (size_t)payload_length)) == NULL)
+    {
+        (void)printf("IoTHubMessage_CreateFromByteArray failed at message %lu\r\n", (unsigned long)message_number);
+        result = __LINE__;
+    }
+    else
+    {
+        if ((IoTHubMessage_SetMessageId(message_handle, sequence) != IOTHUB_MESSAGE_OK) ||
+            (Map_AddOrUpdate(IoTHubMessage_Properties(message_handle), "sequence", sequence) != MAP_OK) ||
+            (IoTHubClient_LL_SendEventAsync(client_handle, message_handle, send_confirmation_callback, NULL) != IOTHUB_CLIENT_OK))
+        {
+            (void)printf("sending failed at message %lu\r\n", (unsigned long)message_number);
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+        IoTHubMessage_Destroy(message_handle);
+    }
+
+    return result;
+}
+
+static void print_pool_statistics(void)
+{
+    size_t class_count = gballoc_getPoolClassCount();
+    size_t reserved_total = 0;
+    size_t used_total = 0;
+    size_t i;
+
+    (void)printf("class   block     live     peak   failures   reserved\r\n");
+    for (i = 0; i <= class_count; i++)
+    {
+        GBALLOC_POOL_STATISTICS statistics;
+        if (gballoc_getPoolStatistics(i, &statistics) == 0)
+        {
+            if (i == class_count)
+            {
+                (void)printf("heap  %7s %8lu %8lu %10lu %10lu\r\n", "-",
+                    (unsigned long)statistics.live, (unsigned long)statistics.peak, (unsigned long)statistics.failures, (unsigned long)statistics.reserved);
+            }
+            else
+            {
+                (void)printf("%5lu %7lu %8lu %8lu %10lu %10lu\r\n", (unsigned long)i, (unsigned long)statistics.block_size,
+                    (unsigned long)statistics.live, (unsigned long)statistics.peak, (unsigned long)statistics.failures, (unsigned long)statistics.reserved);
+                reserved_total += statistics.reserved;
+                /* a block holds at most block_size bytes, so this is an upper bound on what the peak actually used */
+                used_total += statistics.peak * statistics.block_size;
+            }
+        }
+    }
+
+    (void)printf("slab bytes reserved: %lu, used at peak: %lu, fragmentation: %lu%%\r\n",
+        (unsigned long)reserved_total, (unsigned long)used_total,
+        (unsigned long)((reserved_total == 0) ? 0 : ((reserved_total - used_total) * 100) / reserved_total));
+}
+
+int main(void)
+{
+    int result;
+
+    if (gballoc_init() != 0)
+    {
+        (void)printf("gballoc_init failed\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        if (platform_init() != 0)
+        {
+            (void)printf("platform_init failed\r\n");
+            result = __LINE__;
+        }
+        else
+        {
+            IOTHUB_CLIENT_CONFIG config;
+            IOTHUB_CLIENT_LL_HANDLE client_handle;
+
+            (void)memset(&config, 0, sizeof(config));
+            config.protocol = (IOTHUB_CLIENT_TRANSPORT_PROVIDER)FakeTransport_ProvideTransportInterface;
+            config.deviceId = "soak";
+            config.deviceKey = "c29hay10ZXN0LWtleQ==";
+            config.iotHubName = "soak";
+            config.iotHubSuffix = "azure-devices.net";
+
+            if ((client_handle = IoTHubClient_LL_Create(&config)) == NULL)
+            {
+                (void)printf("IoTHubClient_LL_Create failed\r\n");
+                result = __LINE__;
+            }
+            else
+            {
+                size_t i;
+                size_t heap_after_create = gballoc_getCurrentMemoryUsed();
+
+                result = 0;
+                for (i = 0; (i < SOAK_MESSAGE_COUNT) && (result == 0); i++)
+                {
+                    result = send_one_message(client_handle, i);
+                    if ((i % SOAK_BATCH_SIZE) == (SOAK_BATCH_SIZE - 1))
+                    {
+                        IoTHubClient_LL_DoWork(client_handle);
+                    }
+                }
+                IoTHubClient_LL_DoWork(client_handle);
+
+                (void)printf("messages sent: %lu, confirmed: %lu\r\n", (unsigned long)i, (unsigned long)confirmed_count);
+                (void)printf("heap after create: %lu bytes, after soak: %lu bytes, peak: %lu bytes, allocations: %lu\r\n",
+                    (unsigned long)heap_after_create, (unsigned long)gballoc_getCurrentMemoryUsed(),
+                    (unsigned long)gballoc_getMaximumMemoryUsed(), (unsigned long)gballoc_getAllocationCount());
+                print_pool_statistics();
+
+                if ((result == 0) && (confirmed_count != SOAK_MESSAGE_COUNT))
+                {
+                    result = __LINE__;
+                }
+
+                IoTHubClient_LL_Destroy(client_handle);
+            }
+
+            platform_deinit();
+        }
+
+        gballoc_deinit();
+    }
+
+    return result;
+}
@@ -67,6 +67,8 @@ void* my_gballoc_realloc(void* ptr, size_t size)
 
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/umock_c_prod.h"
+#include "internal/iothub_client_batch.h"
+#include "internal/iothub_client_persistent_queue.h"
 
 #ifndef DONT_USE_UPLOADTOBLOB
 #include "internal/iothub_client_ll_uploadtoblob.h"
@@ -107,6 +109,8 @@ MOCKABLE_FUNCTION(, int, FAKE_IoTHubTransport_DeviceMethod_Response, IOTHUB_DEVI
 MOCKABLE_FUNCTION(, int, FAKE_IotHubTransport_Subscribe_InputQueue, IOTHUB_DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, void, FAKE_IotHubTransport_Unsubscribe_InputQueue, IOTHUB_DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, int, FAKE_IoTHubTransport_SetCallbackContext, TRANSPORT_LL_HANDLE, handle, void*, ctx);
+MOCKABLE_FUNCTION(, int, FAKE_IoTHubTransport_GetTrafficStatistics, TRANSPORT_LL_HANDLE, handle, IOTHUB_CLIENT_SEND_STATISTICS*, statistics);
+MOCKABLE_FUNCTION(, int, FAKE_IoTHubTransport_DoWorkWithBudget, TRANSPORT_LL_HANDLE, handle, const IOTHUB_CLIENT_DOWORK_BUDGET*, budget, uint32_t*, next_call_in_ms);
 MOCKABLE_FUNCTION(, bool, messageInputCallbackEx, MESSAGE_CALLBACK_INFO*, messageData, void*, userContextCallback);
 
 MOCKABLE_FUNCTION(, bool, Transport_MessageCallbackFromInput, MESSAGE_CALLBACK_INFO*, messageData, void*, ctx);
@@ -211,6 +215,8 @@ static const char* TEST_STRING_VALUE = "Test string value";
 #define TEST_TRANSPORT_LL_HANDLE            (TRANSPORT_LL_HANDLE)0x49
 #define TEST_IOTHUB_DEVICE_HANDLE           (IOTHUB_DEVICE_HANDLE)0x50
 #define TEST_MESSAGE_HANDLE                 (IOTHUB_MESSAGE_HANDLE)0x51
+#define TEST_TELEMETRY_BATCH_HANDLE         (IOTHUB_CLIENT_BATCH_HANDLE)0x52
+#define TEST_PERSISTENT_QUEUE_HANDLE        (IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE)0x53
 #define TEST_TIME_VALUE                     (time_t)123456
 
 #define TEST_BUFFER_HANDLE                  (BUFFER_HANDLE)0x52
@@ -571,7 +577,9 @@ static TRANSPORT_PROVIDER FAKE_transport_provider =
     FAKE_IoTHubTransport_GetSendStatus, /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
     FAKE_IotHubTransport_Subscribe_InputQueue, /*pfIoTHubTransport_Subscribe_InputQueue IoTHubTransport_Subscribe_InputQueue; */
     FAKE_IotHubTransport_Unsubscribe_InputQueue, /*pfIoTHubTransport_Unsubscribe_InputQueue IoTHubTransport_Unsubscribe_InputQueue; */
-    FAKE_IoTHubTransport_SetCallbackContext
+    FAKE_IoTHubTransport_SetCallbackContext, /*pfIoTHubTransport_SetCallbackContext IoTHubTransport_SetCallbackContext; */
+    FAKE_IoTHubTransport_GetTrafficStatistics, /*pfIoTHubTransport_GetTrafficStatistics IoTHubTransport_GetTrafficStatistics; */
+    FAKE_IoTHubTransport_DoWorkWithBudget /*pfIoTHubTransport_DoWorkWithBudget IoTHubTransport_DoWorkWithBudget; */
 };
 
 static const TRANSPORT_PROVIDER* provideFAKE(void)
@@ -733,6 +741,9 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(LIST_ACTION_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(LIST_CONDITION_FUNCTION, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_BATCH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_PERSISTENT_QUEUE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_BATCH_ADD_RESULT, int);
 
 #ifndef DONT_USE_UPLOADTOBLOB
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE, void*);
@@ -772,6 +783,26 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(FAKE_IotHubTransport_Unsubscribe_InputQueue, my_FAKE_IoTHubTransport_Common_Unsubscribe_InputQueue);
 
     REGISTER_GLOBAL_MOCK_RETURN(FAKE_IoTHubTransport_SetCallbackContext, 0)
+    REGISTER_GLOBAL_MOCK_RETURN(FAKE_IoTHubTransport_GetTrafficStatistics, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_GetTrafficStatistics, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_RETURN(FAKE_IoTHubTransport_DoWorkWithBudget, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_DoWorkWithBudget, __FAILURE__);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Batch_Create, TEST_TELEMETRY_BATCH_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Batch_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Batch_Add, IOTHUB_CLIENT_BATCH_ADD_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Batch_IsDue, false);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Batch_HasPending, false);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Batch_GetTimeToDue, false);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_PersistentQueue_Create, TEST_PERSISTENT_QUEUE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_PersistentQueue_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_PersistentQueue_Store, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_PersistentQueue_Store, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_PersistentQueue_HasStored, false);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_PersistentQueue_GetNext, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_PersistentQueue_IsReplayed, false);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_PersistentQueue_GetTimeToNext, false);
 
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_Subscribe_DeviceMethod, __FAILURE__);
     REGISTER_GLOBAL_MOCK_RETURN(FAKE_IoTHubMessage_GetMessageId, "1");
@@ -2867,6 +2898,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_calls_underlying_succeeds)
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*_DoWork will ask "what's the time"*/
         .IgnoreAllArguments();
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -2879,6 +2911,130 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_calls_underlying_succeeds)
     IoTHubClientCore_LL_Destroy(handle);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_01_026: [ If iotHubClientHandle, budget or next_call_in_ms is NULL, IoTHubClientCore_LL_DoWorkWithBudget shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_DoWorkWithBudget_with_NULL_handle_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_DOWORK_BUDGET budget = { 100, 512 };
+    uint32_t next_call_in_ms;
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_DoWorkWithBudget(NULL, &budget, &next_call_in_ms);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_026: [ If iotHubClientHandle, budget or next_call_in_ms is NULL, IoTHubClientCore_LL_DoWorkWithBudget shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_DoWorkWithBudget_with_NULL_budget_fails)
+{
+    //arrange
+    uint32_t next_call_in_ms;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_DoWorkWithBudget(handle, NULL, &next_call_in_ms);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_027: [ IoTHubClientCore_LL_DoWorkWithBudget shall do the work of IoTHubClientCore_LL_DoWork, calling the underlaying layer's _DoWorkWithBudget function instead of _DoWork when the transport has one. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_DoWorkWithBudget_calls_underlying_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_DOWORK_BUDGET budget = { 100, 512 };
+    uint32_t transport_next_call_in_ms = 3000;
+    uint32_t next_call_in_ms = 0;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWorkWithBudget(IGNORED_PTR_ARG, &budget, &next_call_in_ms))
+        .CopyOutArgumentBuffer_next_call_in_ms(&transport_next_call_in_ms, sizeof(transport_next_call_in_ms));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_DoWorkWithBudget(handle, &budget, &next_call_in_ms);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(uint32_t, 3000, next_call_in_ms);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_028: [ If _DoWorkWithBudget fails, IoTHubClientCore_LL_DoWorkWithBudget shall set next_call_in_ms to 0 and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_DoWorkWithBudget_underlying_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_DOWORK_BUDGET budget = { 100, 512 };
+    uint32_t next_call_in_ms = 1234;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWorkWithBudget(IGNORED_PTR_ARG, &budget, &next_call_in_ms))
+        .SetReturn(__FAILURE__);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_DoWorkWithBudget(handle, &budget, &next_call_in_ms);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(uint32_t, 0, next_call_in_ms);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_031: [ next_call_in_ms shall be lowered to the time left until the telemetry batch is due, as given by IoTHubClient_Batch_GetTimeToDue. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_DoWorkWithBudget_lowers_to_the_batch_deadline)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS batching = { 10, 0, 1000, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_DOWORK_BUDGET budget = { 100, 512 };
+    uint32_t transport_next_call_in_ms = 3000;
+    tickcounter_ms_t ms_to_due = 200;
+    uint32_t next_call_in_ms = 0;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &batching);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_IsDue(TEST_TELEMETRY_BATCH_HANDLE, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWorkWithBudget(IGNORED_PTR_ARG, &budget, &next_call_in_ms))
+        .CopyOutArgumentBuffer_next_call_in_ms(&transport_next_call_in_ms, sizeof(transport_next_call_in_ms));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_GetTimeToDue(TEST_TELEMETRY_BATCH_HANDLE, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_ms_to_due(&ms_to_due, sizeof(ms_to_due))
+        .SetReturn(true);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_DoWorkWithBudget(handle, &budget, &next_call_in_ms);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(uint32_t, 200, next_call_in_ms);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
 /*Tests_SRS_IoTHubClientCore_LL_02_022: [If parameter completed is NULL or parameter handle is NULL then IoTHubClientCore_LL_SendBatch shall return.]*/
 TEST_FUNCTION(IoTHubClientCore_LL_SendComplete_with_NULL_handle_shall_return)
 {
@@ -3450,6 +3606,101 @@ TEST_FUNCTION(IoTHubClientCore_LL_GetSendStatus_HasEventToSend_Succeeds)
     IoTHubClientCore_LL_Destroy(handle);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_01_012: [ Messages waiting in the telemetry batch shall make IoTHubClient_GetSendStatus report IOTHUB_CLIENT_SEND_STATUS_BUSY. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_GetSendStatus_with_pending_telemetry_batch_reports_busy)
+{
+    // arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS batching = { 10, 0, 1000, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &batching);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATUS status;
+    IOTHUB_CLIENT_STATUS desire_status = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetSendStatus(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_handle()
+        .CopyOutArgumentBuffer_iotHubClientStatus(&desire_status, sizeof(status))
+        .SetReturn(IOTHUB_CLIENT_OK);
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_HasPending(TEST_TELEMETRY_BATCH_HANDLE))
+        .SetReturn(true);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_GetSendStatus(handle, &status);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_STATUS, IOTHUB_CLIENT_SEND_STATUS_BUSY, status);
+
+    // cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_013: [ If iotHubClientHandle or statistics is NULL, IoTHubClientCore_LL_GetSendStatistics shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_GetSendStatistics_with_NULL_handle_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_SEND_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_GetSendStatistics(NULL, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_014: [ IoTHubClientCore_LL_GetSendStatistics shall return the confirmed message counts, and the traffic counters filled in by the underlaying layer's _GetTrafficStatistics function when the transport has one, 0 otherwise. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_GetSendStatistics_succeeds)
+{
+    // arrange
+    IOTHUB_CLIENT_SEND_STATISTICS statistics;
+    IOTHUB_CLIENT_SEND_STATISTICS transport_statistics = { 0, 0, 1234, 56, 3, 7 };
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetTrafficStatistics(IGNORED_PTR_ARG, &statistics))
+        .CopyOutArgumentBuffer_statistics(&transport_statistics, sizeof(transport_statistics));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_GetSendStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_IS_TRUE(statistics.messages_confirmed == 0);
+    ASSERT_IS_TRUE(statistics.bytes_sent == 1234);
+    ASSERT_IS_TRUE(statistics.bytes_received == 56);
+    ASSERT_IS_TRUE(statistics.radio_wake_ups == 3);
+    ASSERT_IS_TRUE(statistics.keep_alive_pings == 7);
+
+    // cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_015: [ If _GetTrafficStatistics fails, IoTHubClientCore_LL_GetSendStatistics shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_GetSendStatistics_transport_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_SEND_STATISTICS statistics;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetTrafficStatistics(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(__FAILURE__);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_GetSendStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+
+    // cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
 /*Tests_SRS_IoTHubClientCore_LL_02_034: [If iotHubClientHandle is NULL then IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.]*/
 TEST_FUNCTION(IoTHubClientCore_LL_SetOption_with_NULL_handle_fails)
 {
@@ -3634,6 +3885,253 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_to_zero_after_Create_
     IoTHubClientCore_LL_Destroy(handle);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_01_009: [ "telemetry_batching" - value is a pointer to an IOTHUB_CLIENT_BATCHING_OPTIONS; a max_messages less than 2 turns batching off, otherwise IoTHubClientCore_LL_SetOption shall create a batch with IoTHubClient_Batch_Create. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_telemetry_batching_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS batching = { 10, 0, 1000, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_Create(&batching));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &batching);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_010: [ If IoTHubClient_Batch_Create fails, IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_ERROR and keep the current batching. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_telemetry_batching_fails_when_IoTHubClient_Batch_Create_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS batching = { 10, 0, 1000, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_Create(&batching))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &batching);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_011: [ Messages waiting in the previous batch shall be moved to waitingToSend before it is destroyed. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_telemetry_batching_off_flushes_the_batch)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS batching = { 10, 0, 1000, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_BATCHING_OPTIONS no_batching = { 0, 0, 0, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &batching);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_Flush(TEST_TELEMETRY_BATCH_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_Destroy(TEST_TELEMETRY_BATCH_HANDLE));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &no_batching);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_004: [ If telemetry batching is on, IoTHubClientCore_LL_SendEventAsync shall add the new record to the telemetry batch with IoTHubClient_Batch_Add instead of waitingToSend. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SendEventAsync_with_telemetry_batching_adds_to_the_batch)
+{
+    //arrange
+    IOTHUB_CLIENT_BATCHING_OPTIONS batching = { 10, 0, 1000, IOTHUB_CLIENT_BATCH_FORMAT_JSON_ARRAY };
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_TELEMETRY_BATCHING, &batching);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_Add(TEST_TELEMETRY_BATCH_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Batch_IsDue(TEST_TELEMETRY_BATCH_HANDLE, IGNORED_NUM_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_023: [ "persistent_queue" - value is a pointer to an IOTHUB_CLIENT_PERSISTENCE_OPTIONS; IoTHubClientCore_LL_SetOption shall create the persistent queue with IoTHubClient_PersistentQueue_Create, which picks up the messages stored before a restart. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_persistent_queue_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS persistence;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    memset(&persistence, 0, sizeof(persistence));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_PersistentQueue_Create(&persistence));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_024: [ If the persistent queue is already set, IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_persistent_queue_twice_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS persistence;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    memset(&persistence, 0, sizeof(persistence));
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_025: [ If IoTHubClient_PersistentQueue_Create fails, IoTHubClientCore_LL_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_persistent_queue_fails_when_IoTHubClient_PersistentQueue_Create_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS persistence;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    memset(&persistence, 0, sizeof(persistence));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_PersistentQueue_Create(&persistence))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_017: [ If the persistent queue is on and the client is not connected, or stored messages wait to be replayed, IoTHubClientCore_LL_SendEventAsync shall store the message with IoTHubClient_PersistentQueue_Store and complete it with IOTHUB_CLIENT_CONFIRMATION_PERSISTED. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SendEventAsync_while_not_connected_stores_the_message)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS persistence;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    memset(&persistence, 0, sizeof(persistence));
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_PersistentQueue_Store(TEST_PERSISTENT_QUEUE_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_PERSISTED, (void*)1));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_018: [ If IoTHubClient_PersistentQueue_Store fails, the message shall be kept in memory as if the persistent queue was off. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_SendEventAsync_keeps_the_message_when_IoTHubClient_PersistentQueue_Store_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS persistence;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    memset(&persistence, 0, sizeof(persistence));
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_PersistentQueue_Store(TEST_PERSISTENT_QUEUE_HANDLE, IGNORED_PTR_ARG))
+        .SetReturn(__FAILURE__);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_01_022: [ Messages waiting in the persistent queue shall make IoTHubClient_GetSendStatus report IOTHUB_CLIENT_SEND_STATUS_BUSY. ]*/
+TEST_FUNCTION(IoTHubClientCore_LL_GetSendStatus_with_stored_messages_reports_busy)
+{
+    //arrange
+    IOTHUB_CLIENT_PERSISTENCE_OPTIONS persistence;
+    IOTHUB_CLIENT_STATUS status;
+    IOTHUB_CLIENT_STATUS desire_status = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    memset(&persistence, 0, sizeof(persistence));
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_PERSISTENT_QUEUE, &persistence);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetSendStatus(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_handle()
+        .CopyOutArgumentBuffer_iotHubClientStatus(&desire_status, sizeof(status))
+        .SetReturn(IOTHUB_CLIENT_OK);
+    STRICT_EXPECTED_CALL(IoTHubClient_PersistentQueue_HasStored(TEST_PERSISTENT_QUEUE_HANDLE))
+        .SetReturn(true);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_GetSendStatus(handle, &status);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_STATUS, IOTHUB_CLIENT_SEND_STATUS_BUSY, status);
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
 /*Tests_SRS_IoTHubClientCore_LL_02_039: [ "messageTimeout" - once IoTHubClientCore_LL_SendEventAsync is called the message shall timeout after value miliseconds. Value is a pointer to a tickcounter_ms_t. ]*/
 TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_to_one_after_Create_succeeds)
 {
@@ -3710,6 +4208,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_calls_timeout_callbac
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -3745,6 +4244,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_defaults_to_zero)
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -3789,6 +4289,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_only_removes_the_mess
         .IgnoreArgument(1);
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -3824,6 +4325,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_when_exactly_on_the_e
         .CopyOutArgumentBuffer(2, &eleven, sizeof(eleven));
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -3871,6 +4373,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*destroying the IOTHUB_MESSAGE_LIST*/
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     /*because we're at time = 12 in this test, the second message is untouched*/
@@ -3929,6 +4432,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     timeIsNow = 13; /*13 > 10 (receive time) + 2 (timeout) => timeout!!!*/
@@ -3944,6 +4448,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
 
@@ -4004,6 +4509,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_one_with_timeout_one_with
             .IgnoreArgument(1);
     }
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     {/*this scope happen in the second _DoWork call*/
@@ -4012,6 +4518,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_one_with_timeout_one_with
             .IgnoreArgument(1)
             .CopyOutArgumentBuffer(2, &timeIsNow, sizeof(timeIsNow));
     }
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -4054,6 +4561,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_when_tickcounter_fail
     }
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -4357,6 +4865,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_SendReportedState_succeed)
 
     STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -4388,6 +4897,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_SendReportedState_continue_processing_s
         .IgnoreArgument(3)
         .SetReturn(IOTHUB_PROCESS_CONTINUE);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
     //act
@@ -2834,6 +2834,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_calls_underlying_succeeds)
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*_DoWork will ask "what's the time"*/
         .IgnoreAllArguments();
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, handle))
         .IgnoreArgument(1);
 
@@ -3686,6 +3687,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_calls_timeout_callbac
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -3722,6 +3724,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_defaults_to_zero)
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -3767,6 +3770,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_only_removes_the_mess
         .IgnoreArgument(1);
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -3803,6 +3807,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_when_exactly_on_the_e
         .CopyOutArgumentBuffer(2, &eleven, sizeof(eleven));
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     //act
@@ -3850,6 +3855,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*destroying the IOTHUB_MESSAGE_LIST*/
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     /*because we're at time = 12 in this test, the second message is untouched*/
@@ -3908,6 +3914,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -3924,6 +3931,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -3985,6 +3993,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_one_with_timeout_one_with
             .IgnoreArgument(1);
     }
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -3994,6 +4003,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_one_with_timeout_one_with
             .IgnoreArgument(1)
             .CopyOutArgumentBuffer(2, &timeIsNow, sizeof(timeIsNow));
     }
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -4037,6 +4047,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_when_tickcounter_fail
     }
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
 
@@ -4344,6 +4355,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_SendReportedState_succeed)
         .IgnoreArgument(1)
         .IgnoreArgument(2);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h))
         .IgnoreArgument(1);
 
@@ -4376,6 +4388,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_SendReportedState_continue_processing_s
         .IgnoreArgument(3)
         .SetReturn(IOTHUB_PROCESS_CONTINUE);
 
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h))
         .IgnoreArgument(1);
 
@@ -31,6 +31,7 @@ static void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/constbuffer.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/map.h"
@@ -53,6 +54,12 @@ extern "C" {
     extern BUFFER_HANDLE real_BUFFER_clone(BUFFER_HANDLE handle);
     extern BUFFER_HANDLE real_BUFFER_create(const unsigned char* source, size_t size);
 
+    extern CONSTBUFFER_HANDLE real_CONSTBUFFER_Create(const unsigned char* source, size_t size);
+    extern CONSTBUFFER_HANDLE real_CONSTBUFFER_CreateWithCustomFree(const unsigned char* source, size_t size, CONSTBUFFER_CUSTOM_FREE_FUNC customFreeFunc, void* customFreeFuncContext);
+    extern CONSTBUFFER_HANDLE real_CONSTBUFFER_Clone(CONSTBUFFER_HANDLE constbufferHandle);
+    extern const CONSTBUFFER* real_CONSTBUFFER_GetContent(CONSTBUFFER_HANDLE constbufferHandle);
+    extern void real_CONSTBUFFER_Destroy(CONSTBUFFER_HANDLE constbufferHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -60,6 +67,8 @@ extern "C" {
 #define NUMBER_OF_CHAR      8
 
 static MAP_FILTER_CALLBACK g_mapFilterFunc;
+static size_t g_release_calls;
+static void* g_release_context;
 
 static const unsigned char c[1] = { '3' };
 static const char* TEST_MESSAGE_ID = "3820ADAE-E3CA-4065-843A-A6BDE950D8DC";
@@ -118,6 +127,12 @@ static void my_Map_Destroy(MAP_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+static void test_payload_release(void* releaseContext)
+{
+    g_release_calls++;
+    g_release_context = releaseContext;
+}
+
 static int my_mallocAndStrcpy_s(char** destination, const char* source)
 {
     *destination = (char*)my_gballoc_malloc(strlen(source)+1);
@@ -277,6 +292,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_UMOCK_ALIAS_TYPE(MAP_FILTER_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CONSTBUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CONSTBUFFER_CUSTOM_FREE_FUNC, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
@@ -297,6 +314,15 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_clone, real_BUFFER_clone);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_clone, NULL);
 
+    REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_Create, real_CONSTBUFFER_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(CONSTBUFFER_Create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_CreateWithCustomFree, real_CONSTBUFFER_CreateWithCustomFree);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(CONSTBUFFER_CreateWithCustomFree, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_Clone, real_CONSTBUFFER_Clone);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(CONSTBUFFER_Clone, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_GetContent, real_CONSTBUFFER_GetContent);
+    REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_Destroy, real_CONSTBUFFER_Destroy);
+
     REGISTER_STRING_GLOBAL_MOCK_HOOK;
 
     REGISTER_GLOBAL_MOCK_HOOK(Map_Create, my_Map_Create);
@@ -322,6 +348,8 @@ TEST_SUITE_CLEANUP(suite_cleanup)
 static void reset_test_data()
 {
     g_mapFilterFunc = NULL;
+    g_release_calls = 0;
+    g_release_context = NULL;
 }
 
 TEST_FUNCTION_INITIALIZE(method_init)
@@ -354,7 +382,7 @@ static int should_skip_index(size_t current_index, const size_t skip_array[], si
     return result;
 }
 
-/*Tests_SRS_IOTHUBMESSAGE_02_022: [IoTHubMessage_CreateFromByteArray shall call BUFFER_create passing byteArray and size as parameters.]*/
+/*Tests_SRS_IOTHUBMESSAGE_02_022: [IoTHubMessage_CreateFromByteArray shall call CONSTBUFFER_Create passing byteArray and size as parameters.]*/
 /*Tests_SRS_IOTHUBMESSAGE_02_023: [IoTHubMessage_CreateFromByteArray shall call Map_Create to create the message properties.]*/
 /*Tests_SRS_IOTHUBMESSAGE_02_025: [Otherwise, IoTHubMessage_CreateFromByteArray shall return a non-NULL handle.] */
 /*Tests_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
@@ -363,8 +391,9 @@ TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_happy_path)
 {
     // arrange
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_create(c, 1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(c, 1));
 
     //act
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
@@ -398,8 +427,9 @@ TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_succeeds_when_size_0_and_buffer_
 {
     // arrange
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, 0)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(IGNORED_PTR_ARG, 0)).IgnoreArgument(1);
 
     //act
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(NULL, 0);
@@ -417,8 +447,9 @@ TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_succeeds_when_size_0_and_buffer_
 {
     //arrange
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, 0)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(IGNORED_PTR_ARG, 0)).IgnoreArgument(1);
 
     //act
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 0);
@@ -439,8 +470,9 @@ TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_fails)
 
     // arrange
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_create(c, 1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(c, 1));
 
     umock_c_negative_tests_snapshot();
 
@@ -464,7 +496,7 @@ TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_fails)
     umock_c_negative_tests_deinit();
 }
 
-/*Tests_SRS_IOTHUBMESSAGE_02_027: [IoTHubMessage_CreateFromString shall call STRING_construct passing source as parameter.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_027: [IoTHubMessage_CreateFromString shall call CONSTBUFFER_Create passing source and its length including the null terminator as parameters.] */
 /*Tests_SRS_IOTHUBMESSAGE_02_028: [IoTHubMessage_CreateFromString shall call Map_Create to create the message properties.] */
 /*Tests_SRS_IOTHUBMESSAGE_02_031: [Otherwise, IoTHubMessage_CreateFromString shall return a non-NULL handle.] */
 /*Tests_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
@@ -473,8 +505,10 @@ TEST_FUNCTION(IoTHubMessage_CreateFromString_happy_path)
 {
     //arrange
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(STRING_construct("a"));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(IGNORED_PTR_ARG, 2))
+        .ValidateArgumentBuffer(1, "a", 2);
 
     //act
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString("a");
@@ -511,8 +545,10 @@ TEST_FUNCTION(IoTHubMessage_CreateFromString_fails)
 
     // arrange
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(STRING_construct("a"));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(IGNORED_PTR_ARG, 2))
+        .ValidateArgumentBuffer(1, "a", 2);
 
     umock_c_negative_tests_snapshot();
 
@@ -608,7 +644,7 @@ TEST_FUNCTION(IoTHubMessage_Destroy_destroys_a_BYTEARRAY_IoTHubMEssage)
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -619,6 +655,7 @@ TEST_FUNCTION(IoTHubMessage_Destroy_destroys_a_BYTEARRAY_IoTHubMEssage)
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(h));
 
     //act
@@ -637,7 +674,7 @@ TEST_FUNCTION(IoTHubMessage_Destroy_destroys_a_STRING_IoTHubMessage)
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -648,6 +685,7 @@ TEST_FUNCTION(IoTHubMessage_Destroy_destroys_a_STRING_IoTHubMessage)
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(h));
 
     //act
@@ -659,8 +697,8 @@ TEST_FUNCTION(IoTHubMessage_Destroy_destroys_a_STRING_IoTHubMessage)
     //cleanup
 }
 
-/*Tests_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using BUFFER_u_char and it shall be copied in the buffer argument.]*/
-/*Tests_SRS_IOTHUBMESSAGE_01_012: [The size of the associated data shall be obtained by using BUFFER_length and it shall be copied to the size argument.]*/
+/*Tests_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using CONSTBUFFER_GetContent and it shall be copied in the buffer argument.]*/
+/*Tests_SRS_IOTHUBMESSAGE_01_012: [The size of the associated data shall be obtained by using CONSTBUFFER_GetContent and it shall be copied to the size argument.]*/
 /*Tests_SRS_IOTHUBMESSAGE_02_033: [IoTHubMessage_GetByteArray shall return IOTHUBMESSAGE_OK when all oeprations complete succesfully.] */
 TEST_FUNCTION(IoTHubMessage_GetByteArray_happy_path)
 {
@@ -670,8 +708,7 @@ TEST_FUNCTION(IoTHubMessage_GetByteArray_happy_path)
     size_t size;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_GetContent(IGNORED_PTR_ARG));
 
     //act
     IOTHUB_MESSAGE_RESULT r = IoTHubMessage_GetByteArray(h, &byteArray, &size);
@@ -743,8 +780,8 @@ TEST_FUNCTION(IoTHubMessage_GetByteArray_with_STRING_fails)
 }
 
 /*Tests_SRS_IOTHUBMESSAGE_03_001: [IoTHubMessage_Clone shall create a new IoT hub message with data content identical to that of the iotHubMessageHandle parameter.]*/
-/*Tests_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone the content by a call to BUFFER_clone or STRING_clone] */
-/*Tests_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall share the content with iotHubMessageHandle by a call to CONSTBUFFER_Clone.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall share the properties map, the system properties and the diagnostic properties with iotHubMessageHandle by incrementing their reference count; they are copied only when one of the two messages changes them.] */
 /*Tests_SRS_IOTHUBMESSAGE_03_002: [IoTHubMessage_Clone shall return upon success a non-NULL handle to the newly created IoT hub message.]*/
 TEST_FUNCTION(IoTHubMessage_Clone_with_BYTE_ARRAY_happy_path)
 {
@@ -753,8 +790,7 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_BYTE_ARRAY_happy_path)
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_clone(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(IGNORED_PTR_ARG));
 
     //act
     IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
@@ -794,8 +830,7 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_BYTE_ARRAY_fails)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_clone(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(IGNORED_PTR_ARG));
 
     umock_c_negative_tests_snapshot();
 
@@ -821,8 +856,8 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_BYTE_ARRAY_fails)
 }
 
 /*Tests_SRS_IOTHUBMESSAGE_03_001: [IoTHubMessage_Clone shall create a new IoT hub message with data content identical to that of the iotHubMessageHandle parameter.]*/
-/*Tests_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone the content by a call to BUFFER_clone or STRING_clone] */
-/*Tests_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall share the content with iotHubMessageHandle by a call to CONSTBUFFER_Clone.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall share the properties map, the system properties and the diagnostic properties with iotHubMessageHandle by incrementing their reference count; they are copied only when one of the two messages changes them.] */
 /*Tests_SRS_IOTHUBMESSAGE_03_002: [IoTHubMessage_Clone shall return upon success a non-NULL handle to the newly created IoT hub message.]*/
 TEST_FUNCTION(IoTHubMessage_Clone_with_STRING_happy_path)
 {
@@ -831,8 +866,7 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_STRING_happy_path)
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(STRING_clone(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(IGNORED_PTR_ARG));
 
     ///act
     IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
@@ -857,8 +891,7 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_STRING_fails)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(STRING_clone(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(IGNORED_PTR_ARG));
 
     umock_c_negative_tests_snapshot();
 
@@ -883,6 +916,401 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_STRING_fails)
     umock_c_negative_tests_deinit();
 }
 
+/*Tests_SRS_IOTHUBMESSAGE_01_030: [ If byteArray is NULL and size is not 0, IoTHubMessage_CreateFromBorrowedByteArray shall fail and return NULL. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromBorrowedByteArray_with_NULL_byteArray_and_non_zero_size_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromBorrowedByteArray(NULL, 1, test_payload_release, (void*)0x4242);
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(size_t, 0, g_release_calls);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_031: [ IoTHubMessage_CreateFromBorrowedByteArray shall create a message of type IOTHUBMESSAGE_BYTEARRAY with an empty properties map. ]*/
+/*Tests_SRS_IOTHUBMESSAGE_01_032: [ IoTHubMessage_CreateFromBorrowedByteArray shall call CONSTBUFFER_CreateWithCustomFree passing byteArray, size, releaseCallback and releaseContext, so that the payload is not copied and releaseCallback is called once no message refers to it anymore. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromBorrowedByteArray_does_not_copy_the_payload)
+{
+    //arrange
+    const unsigned char* byteArray;
+    size_t size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_CreateWithCustomFree(c, 1, test_payload_release, (void*)0x4242));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromBorrowedByteArray(c, 1, test_payload_release, (void*)0x4242);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_BYTEARRAY, IoTHubMessage_GetContentType(h));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &byteArray, &size));
+    ASSERT_ARE_EQUAL(void_ptr, c, byteArray);
+    ASSERT_ARE_EQUAL(size_t, 1, size);
+    ASSERT_ARE_EQUAL(size_t, 0, g_release_calls);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_032: [ IoTHubMessage_CreateFromBorrowedByteArray shall call CONSTBUFFER_CreateWithCustomFree passing byteArray, size, releaseCallback and releaseContext, so that the payload is not copied and releaseCallback is called once no message refers to it anymore. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromBorrowedByteArray_releases_the_payload_after_the_last_clone)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromBorrowedByteArray(c, 1, test_payload_release, (void*)0x4242);
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+    ASSERT_IS_NOT_NULL(clone);
+
+    //act
+    IoTHubMessage_Destroy(h);
+    ASSERT_ARE_EQUAL(size_t, 0, g_release_calls);
+    IoTHubMessage_Destroy(clone);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_release_calls);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x4242, g_release_context);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_033: [ If any error occurs, IoTHubMessage_CreateFromBorrowedByteArray shall return NULL and shall not call releaseCallback. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromBorrowedByteArray_fails)
+{
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_CreateWithCustomFree(c, 1, test_payload_release, (void*)0x4242));
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[80];
+        sprintf(tmp_msg, "IoTHubMessage_CreateFromBorrowedByteArray failure in test %zu/%zu", index, count);
+
+        IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromBorrowedByteArray(c, 1, test_payload_release, (void*)0x4242);
+
+        //assert
+        ASSERT_IS_NULL(h, tmp_msg);
+        ASSERT_ARE_EQUAL(size_t, 0, g_release_calls, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_034: [ If payload is NULL, IoTHubMessage_CreateFromConstBuffer shall fail and return NULL. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromConstBuffer_with_NULL_payload_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromConstBuffer(NULL);
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_038: [ IoTHubMessage_CreateFromConstBuffer shall create a message of type IOTHUBMESSAGE_BYTEARRAY that holds a reference to payload obtained by calling CONSTBUFFER_Clone. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromConstBuffer_shares_the_payload)
+{
+    //arrange
+    CONSTBUFFER_HANDLE payload = real_CONSTBUFFER_Create(c, 1);
+    const unsigned char* byteArray;
+    size_t size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(payload));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromConstBuffer(payload);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_BYTEARRAY, IoTHubMessage_GetContentType(h));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &byteArray, &size));
+    ASSERT_ARE_EQUAL(void_ptr, real_CONSTBUFFER_GetContent(payload)->buffer, byteArray);
+    ASSERT_ARE_EQUAL(size_t, 1, size);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+    real_CONSTBUFFER_Destroy(payload);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_035: [ If any error occurs, IoTHubMessage_CreateFromConstBuffer shall return NULL. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromConstBuffer_fails)
+{
+    CONSTBUFFER_HANDLE payload = real_CONSTBUFFER_Create(c, 1);
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(payload));
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[80];
+        sprintf(tmp_msg, "IoTHubMessage_CreateFromConstBuffer failure in test %zu/%zu", index, count);
+
+        IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromConstBuffer(payload);
+
+        //assert
+        ASSERT_IS_NULL(h, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+    real_CONSTBUFFER_Destroy(payload);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall share the content with iotHubMessageHandle by a call to CONSTBUFFER_Clone.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall share the properties map, the system properties and the diagnostic properties with iotHubMessageHandle by incrementing their reference count; they are copied only when one of the two messages changes them.] */
+TEST_FUNCTION(IoTHubMessage_Clone_shares_the_payload_and_the_properties)
+{
+    //arrange
+    const unsigned char* byteArray;
+    const unsigned char* clonedByteArray;
+    size_t size;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    (void)IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(r);
+    (void)IoTHubMessage_GetByteArray(h, &byteArray, &size);
+    (void)IoTHubMessage_GetByteArray(r, &clonedByteArray, &size);
+    ASSERT_ARE_EQUAL(void_ptr, byteArray, clonedByteArray);
+    ASSERT_ARE_EQUAL(void_ptr, IoTHubMessage_GetMessageId(h), IoTHubMessage_GetMessageId(r));
+
+    ///cleanup
+    IoTHubMessage_Destroy(r);
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_036: [ Before changing a system property, a diagnostic property or the properties map of a message whose properties are shared with a clone, the message shall get its own copy of all of them. ]*/
+TEST_FUNCTION(IoTHubMessage_SetMessageId_on_a_clone_copies_the_properties)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    (void)IoTHubMessage_SetCorrelationId(h, TEST_MESSAGE_ID);
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_MESSAGE_ID));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_MESSAGE_ID2));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetMessageId(r, TEST_MESSAGE_ID2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(IoTHubMessage_GetMessageId(h));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID2, IoTHubMessage_GetMessageId(r));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetCorrelationId(r));
+    ASSERT_ARE_NOT_EQUAL(void_ptr, IoTHubMessage_GetCorrelationId(h), IoTHubMessage_GetCorrelationId(r));
+
+    //cleanup
+    IoTHubMessage_Destroy(r);
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_036: [ Before changing a system property, a diagnostic property or the properties map of a message whose properties are shared with a clone, the message shall get its own copy of all of them. ]*/
+TEST_FUNCTION(IoTHubMessage_Properties_on_a_cloned_message_returns_its_own_map)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+
+    //act
+    MAP_HANDLE clonedMap = IoTHubMessage_Properties(r);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clonedMap);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(void_ptr, IoTHubMessage_Properties(h), clonedMap);
+    ASSERT_ARE_EQUAL(void_ptr, clonedMap, IoTHubMessage_Properties(r));
+
+    //cleanup
+    IoTHubMessage_Destroy(r);
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_037: [ If making the copy fails, the change shall fail and the message shall keep sharing the properties. ]*/
+TEST_FUNCTION(IoTHubMessage_SetProperty_on_a_clone_fails_when_copying_the_properties_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Map_Destroy(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperty(r, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(r);
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_039: [ If the properties map of iotHubMessageHandle was returned by IoTHubMessage_Properties, IoTHubMessage_Clone shall give the new message its own copy of the properties map, the system properties and the diagnostic properties. ]*/
+TEST_FUNCTION(IoTHubMessage_Clone_after_IoTHubMessage_Properties_copies_the_properties)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    MAP_HANDLE map = IoTHubMessage_Properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(map));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(r);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(void_ptr, map, IoTHubMessage_GetReadOnlyProperties(r));
+
+    //cleanup
+    IoTHubMessage_Destroy(r);
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+TEST_FUNCTION(IoTHubMessage_Clone_after_IoTHubMessage_Properties_fails_when_copying_the_properties_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    (void)IoTHubMessage_Properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Map_Destroy(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NULL(r);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_041: [ Otherwise IoTHubMessage_GetReadOnlyProperties shall return the properties map of the message without copying it, even when it is shared with a clone. ]*/
+TEST_FUNCTION(IoTHubMessage_GetReadOnlyProperties_on_a_clone_does_not_copy_the_properties)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+    umock_c_reset_all_calls();
+
+    //act
+    MAP_HANDLE cloneMap = IoTHubMessage_GetReadOnlyProperties(r);
+
+    //assert
+    ASSERT_IS_NOT_NULL(cloneMap);
+    ASSERT_ARE_EQUAL(void_ptr, IoTHubMessage_GetReadOnlyProperties(h), cloneMap);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(r);
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_040: [ If iotHubMessageHandle is NULL then IoTHubMessage_GetReadOnlyProperties shall return NULL. ]*/
+TEST_FUNCTION(IoTHubMessage_GetReadOnlyProperties_with_NULL_handle_returns_NULL)
+{
+    //arrange
+
+    //act
+    MAP_HANDLE r = IoTHubMessage_GetReadOnlyProperties(NULL);
+
+    //assert
+    ASSERT_IS_NULL(r);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
 /*Tests_SRS_IOTHUBMESSAGE_02_002: [Otherwise, for any non-NULL iotHubMessageHandle it shall return a non-NULL MAP_HANDLE.] */
 TEST_FUNCTION(IoTHubMessage_Properties_happy_path)
 {
@@ -953,7 +1381,7 @@ TEST_FUNCTION(IoTHubMessage_GetString_happy_path)
     IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_GetContent(IGNORED_PTR_ARG));
 
     //act
     const char* r = IoTHubMessage_GetString(h);
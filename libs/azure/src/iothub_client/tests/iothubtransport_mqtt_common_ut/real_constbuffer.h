@@ -9,6 +9,7 @@
 #define CONSTBUFFER_Create             real_CONSTBUFFER_Create
 #define CONSTBUFFER_Clone              real_CONSTBUFFER_Clone
 #define CONSTBUFFER_CreateFromBuffer   real_CONSTBUFFER_CreateFromBuffer
+#define CONSTBUFFER_CreateWithCustomFree real_CONSTBUFFER_CreateWithCustomFree
 #define CONSTBUFFER_GetContent         real_CONSTBUFFER_GetContent
 #define CONSTBUFFER_Destroy            real_CONSTBUFFER_Destroy
 
@@ -18,6 +19,7 @@
 #undef CONSTBUFFER_Create
 #undef CONSTBUFFER_Clone
 #undef CONSTBUFFER_CreateFromBuffer
+#undef CONSTBUFFER_CreateWithCustomFree
 #undef CONSTBUFFER_GetContent
 #undef CONSTBUFFER_Destroy
 #undef CONSTBUFFER_TAG
@@ -190,7 +190,9 @@ static TRANSPORT_PROVIDER FAKE_transport_provider =
     FAKE_IoTHubTransport_GetSendStatus,
     FAKE_IoTHubTransport_Subscribe_InputQueue,
     FAKE_IoTHubTransport_Unsubscribe_InputQueue,
-    FAKE_IoTHubTransport_SetCallbackContext
+    FAKE_IoTHubTransport_SetCallbackContext,
+    NULL,
+    NULL
 };
 
 static const TRANSPORT_PROVIDER* provideFAKE(void)
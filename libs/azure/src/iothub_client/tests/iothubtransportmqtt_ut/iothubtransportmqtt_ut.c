@@ -108,6 +108,8 @@ static pfIoTHubTransport_ProcessItem                IoTHubTransportMqtt_ProcessI
 static pfIoTHubTransport_Subscribe_InputQueue       IoTHubTransportMqtt_Subscribe_InputQueue;
 static pfIoTHubTransport_Unsubscribe_InputQueue     IoTHubTransportMqtt_Unsubscribe_InputQueue;
 static pfIoTHubTransport_SetCallbackContext         IoTHubTransportMqtt_SetCallbackContext;
+static pfIoTHubTransport_GetTrafficStatistics       IoTHubTransportMqtt_GetTrafficStatistics;
+static pfIoTHubTransport_DoWorkWithBudget           IoTHubTransportMqtt_DoWorkWithBudget;
 
 static TRANSPORT_LL_HANDLE my_IoTHubTransport_MQTT_Common_Create(const IOTHUBTRANSPORT_CONFIG* config, MQTT_GET_IO_TRANSPORT get_io_transport, TRANSPORT_CALLBACKS_INFO* cb_info, void* ctx)
 {
@@ -350,6 +352,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     IoTHubTransportMqtt_Subscribe_InputQueue = ((TRANSPORT_PROVIDER*)MQTT_Protocol())->IoTHubTransport_Subscribe_InputQueue;
     IoTHubTransportMqtt_Unsubscribe_InputQueue = ((TRANSPORT_PROVIDER*)MQTT_Protocol())->IoTHubTransport_Unsubscribe_InputQueue;
     IoTHubTransportMqtt_SetCallbackContext = ((TRANSPORT_PROVIDER*)MQTT_Protocol())->IoTHubTransport_SetCallbackContext;
+    IoTHubTransportMqtt_GetTrafficStatistics = ((TRANSPORT_PROVIDER*)MQTT_Protocol())->IoTHubTransport_GetTrafficStatistics;
+    IoTHubTransportMqtt_DoWorkWithBudget = ((TRANSPORT_PROVIDER*)MQTT_Protocol())->IoTHubTransport_DoWorkWithBudget;
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -890,4 +894,47 @@ TEST_FUNCTION(IoTHubTransportMqtt_SetCallbackContext_success)
     // cleanup
 }
 
+TEST_FUNCTION(IoTHubTransportMqtt_GetTrafficStatistics_success)
+{
+    // arrange
+    IOTHUB_CLIENT_SEND_STATISTICS statistics;
+    IOTHUBTRANSPORT_CONFIG config = { 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportMqtt_Create(&config, g_transport_cb_info, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubTransport_MQTT_Common_GetTrafficStatistics(IGNORED_PTR_ARG, &statistics));
+
+    // act
+    int result = IoTHubTransportMqtt_GetTrafficStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+}
+
+TEST_FUNCTION(IoTHubTransportMqtt_DoWorkWithBudget_success)
+{
+    // arrange
+    IOTHUB_CLIENT_DOWORK_BUDGET budget = { 100, 512 };
+    uint32_t next_call_in_ms;
+    IOTHUBTRANSPORT_CONFIG config = { 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportMqtt_Create(&config, g_transport_cb_info, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubTransport_MQTT_Common_DoWorkWithBudget(IGNORED_PTR_ARG, &budget, &next_call_in_ms));
+
+    // act
+    int result = IoTHubTransportMqtt_DoWorkWithBudget(handle, &budget, &next_call_in_ms);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+}
+
 END_TEST_SUITE(iothubtransportmqtt_ut)
@@ -10,6 +10,7 @@
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/strings.h"
 #include "iotdevice.h"
+#include "jsonreader.h"
 
 #ifdef __cplusplus
 #include <cstddef>
@@ -41,9 +42,13 @@ typedef EXECUTE_COMMAND_RESULT (*actionWrapper)(void* device, size_t ParameterCo
 
 typedef METHODRETURN_HANDLE (*methodWrapper)(void* device, size_t ParameterCount, const AGENT_DATA_TYPE* values);
 
+/* sorts the JSON_READER_MEMBER_INDEXes of a struct or a model, NULL in reflected data that was not built by DECLARE_STRUCT or DECLARE_MODEL */
+typedef void(*jsonMemberIndexSorter)(void);
+
 typedef struct REFLECTION_STRUCT_TAG
 {
     const char* name;
+    jsonMemberIndexSorter sortJSONMembers;
 }REFLECTION_STRUCT;
 
 typedef struct WRAPPER_ARGUMENT_TAG
@@ -111,9 +116,16 @@ typedef struct REFLECTION_DESIRED_PROPERTY_TAG
     const char* modelName;
 } REFLECTION_DESIRED_PROPERTY;
 
+/* the in place JSON decoders of a model, NULL in reflected data that was not built by DECLARE_MODEL */
+typedef void(*jsonDesiredPropertiesDecoder)(JSON_READER* reader, void* device, bool isDocumentRoot);
+typedef EXECUTE_COMMAND_RESULT(*jsonActionDispatcher)(void* device, const char* actionPath, size_t actionPathLength, JSON_READER* parameters);
+
 typedef struct REFLECTION_MODEL_TAG
 {
     const char* name;
+    jsonDesiredPropertiesDecoder desiredPropertiesFromJSON;
+    jsonActionDispatcher actionFromJSON;
+    jsonMemberIndexSorter sortJSONMembers;
 } REFLECTION_MODEL;
 
 typedef struct REFLECTED_SOMETHING_TAG
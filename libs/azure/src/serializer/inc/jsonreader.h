@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file jsonreader.h
+*    @brief Reads JSON text in place, one member or value at a time.
+*
+*    @details JSON reader is the input side of the decoders generated by DECLARE_STRUCT and
+*             DECLARE_MODEL. Values are converted straight from the JSON text into the fields
+*             of a device, without building a MULTITREE or AGENT_DATA_TYPEs first. Values are
+*             accepted in the same text as CreateAgentDataType_From_String accepts them.
+*             Member names are looked up in a JSON_READER_MEMBER_INDEX, a table sorted once by
+*             JSONReader_SortMembers when the schema is registered and then only read.
+*/
+
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "agenttypesystem.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+#define JSON_READER_RESULT_VALUES   \
+JSON_READER_OK,                     \
+JSON_READER_INVALID_ARG,            \
+JSON_READER_PARSE_ERROR,            \
+JSON_READER_TYPE_MISMATCH,          \
+JSON_READER_MEMBER_NOT_FOUND,       \
+JSON_READER_ERROR
+
+DEFINE_ENUM(JSON_READER_RESULT, JSON_READER_RESULT_VALUES);
+
+/* the reader is meant to live on the stack of the caller, it does not own the JSON text */
+typedef struct JSON_READER_TAG
+{
+    const char* json;
+    size_t length;
+    size_t position;
+    bool isFirstMember; /* no ',' is expected before the next member of the current object */
+    JSON_READER_RESULT result; /* the first error stops all further reading */
+} JSON_READER;
+
+/* ids start at 1, JSONReader_FindMember returns 0 for a name that is not in the index */
+typedef struct JSON_READER_MEMBER_TAG
+{
+    const char* name;
+    size_t nameLength;
+    size_t id;
+} JSON_READER_MEMBER;
+
+typedef struct JSON_READER_MEMBER_INDEX_TAG
+{
+    JSON_READER_MEMBER* members;
+    size_t count;
+    bool isSorted; /* set by JSONReader_SortMembers, lookups in an unsorted index are linear */
+} JSON_READER_MEMBER_INDEX;
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, void, JSONReader_Init, JSON_READER*, reader, const char*, json, size_t, length);
+MOCKABLE_FUNCTION(, void, JSONReader_SetError, JSON_READER*, reader, JSON_READER_RESULT, result);
+MOCKABLE_FUNCTION(, bool, JSONReader_BeginObject, JSON_READER*, reader);
+MOCKABLE_FUNCTION(, bool, JSONReader_NextMember, JSON_READER*, reader, const char**, name, size_t*, nameLength);
+MOCKABLE_FUNCTION(, void, JSONReader_SkipValue, JSON_READER*, reader);
+MOCKABLE_FUNCTION(, void, JSONReader_End, JSON_READER*, reader);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadString, JSON_READER*, reader, const char**, value, size_t*, valueLength);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadInt64, JSON_READER*, reader, int64_t, minimum, int64_t, maximum, int64_t*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadBool, JSON_READER*, reader, bool*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadDouble, JSON_READER*, reader, double*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadFloat, JSON_READER*, reader, float*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadCharz, JSON_READER*, reader, char**, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadCharzNoQuotes, JSON_READER*, reader, char**, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadDateTimeOffset, JSON_READER*, reader, EDM_DATE_TIME_OFFSET*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadGuid, JSON_READER*, reader, EDM_GUID*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_ReadBinary, JSON_READER*, reader, EDM_BINARY*, value);
+MOCKABLE_FUNCTION(, void, JSONReader_SortMembers, JSON_READER_MEMBER_INDEX*, memberIndex);
+MOCKABLE_FUNCTION(, size_t, JSONReader_FindMember, const JSON_READER_MEMBER_INDEX*, memberIndex, const char*, name, size_t, nameLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSONREADER_H */
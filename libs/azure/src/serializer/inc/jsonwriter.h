@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file jsonwriter.h
+*    @brief Writes JSON text straight into a caller supplied buffer.
+*
+*    @details JSON writer is the output side of the encoders generated by DECLARE_STRUCT and
+*             DECLARE_MODEL. Values are written in the same text as AgentDataTypes_ToString
+*             produces, without building AGENT_DATA_TYPEs or a MULTITREE first.
+*             The writer always counts the bytes the JSON needs, also past the end of the
+*             buffer, so a pass with a NULL buffer measures the exact size of the output.
+*/
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "agenttypesystem.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+#define JSON_WRITER_RESULT_VALUES   \
+JSON_WRITER_OK,                     \
+JSON_WRITER_INVALID_ARG,            \
+JSON_WRITER_BUFFER_TOO_SMALL,       \
+JSON_WRITER_ERROR
+
+DEFINE_ENUM(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+/* the writer is meant to live on the stack of the caller, it owns no memory */
+typedef struct JSON_WRITER_TAG
+{
+    unsigned char* buffer;
+    size_t bufferSize;
+    size_t length; /* bytes needed so far, can be more than bufferSize */
+    JSON_WRITER_RESULT result; /* the first error stops all further writing */
+} JSON_WRITER;
+
+typedef void(*JSON_WRITER_VALUE_FUNC)(JSON_WRITER* writer, const void* value);
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, void, JSONWriter_Init, JSON_WRITER*, writer, unsigned char*, buffer, size_t, bufferSize);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendRaw, JSON_WRITER*, writer, const char*, text, size_t, length);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendMemberName, JSON_WRITER*, writer, size_t, memberIndex, const char*, name, size_t, nameLength);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendInt64, JSON_WRITER*, writer, int64_t, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendBool, JSON_WRITER*, writer, bool, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendDouble, JSON_WRITER*, writer, double, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendFloat, JSON_WRITER*, writer, float, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendString, JSON_WRITER*, writer, const char*, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendStringNoQuotes, JSON_WRITER*, writer, const char*, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendDateTimeOffset, JSON_WRITER*, writer, const EDM_DATE_TIME_OFFSET*, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendGuid, JSON_WRITER*, writer, const EDM_GUID*, value);
+MOCKABLE_FUNCTION(, void, JSONWriter_AppendBinary, JSON_WRITER*, writer, const EDM_BINARY*, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_Encode, unsigned char**, destination, size_t*, destinationSize, JSON_WRITER_VALUE_FUNC, valueFunc, const void*, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_EncodeToBuffer, unsigned char*, buffer, size_t, bufferSize, size_t*, length, JSON_WRITER_VALUE_FUNC, valueFunc, const void*, value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSONWRITER_H */
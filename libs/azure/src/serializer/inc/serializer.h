@@ -41,10 +41,12 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstdarg>
+#include <climits>
 
 #else
 #include <stdlib.h>
 #include <stdarg.h>
+#include <limits.h>
 #endif
 
 #include "azure_c_shared_utility/gballoc.h"
@@ -57,6 +59,8 @@
 #include "codefirst.h"
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "jsonwriter.h"
+#include "jsonreader.h"
 
 
 
@@ -102,11 +106,16 @@ extern "C"
     typedef struct name##_TAG { \
         FOR_EACH_2(INSERT_FIELD_INTO_STRUCT, __VA_ARGS__) \
     } name; \
+    DECLARE_STRUCT_FROM_JSON(name) \
     /* Codes_SRS_SERIALIZER_99_081:[ DECLARE_STRUCT's name argument shall uniquely identify the struct within the schema.] */ \
     REFLECTED_STRUCT(name) \
     /* Codes_SRS_SERIALIZER_99_082:[ DECLARE_STRUCT's field<n>Name argument shall uniquely name a field within the struct.] */ \
     FOR_EACH_2_KEEP_1(REFLECTED_FIELD, name, __VA_ARGS__) \
     TO_AGENT_DATA_TYPE(name, __VA_ARGS__) \
+    /* Codes_SRS_SERIALIZER_H_01_004: [ DECLARE_STRUCT shall define a function ToJSON_name that writes the fields of a name value as a JSON object with a JSON writer. ]*/ \
+    TO_JSON(name, __VA_ARGS__) \
+    /* Codes_SRS_SERIALIZER_H_01_009: [ DECLARE_STRUCT shall define a function FromJSON_name that reads all the fields of a name value from a JSON object with a JSON reader. ]*/ \
+    FROM_JSON(name, __VA_ARGS__) \
     /*Codes_SRS_SERIALIZER_99_042:[ The parameter types are either predefined parameter types (specs SRS_SERIALIZER_99_004-SRS_SERIALIZER_99_014) or a type introduced by DECLARE_STRUCT.]*/ \
     static AGENT_DATA_TYPES_RESULT FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, name* destination) \
     { \
@@ -170,11 +179,14 @@ extern "C"
 #define SERIALIZER_REGISTER_NAMESPACE(NAMESPACE) CodeFirst_RegisterSchema(#NAMESPACE, & ALL_REFLECTED(NAMESPACE))
 
 #define DECLARE_MODEL(name, ...)                                                             \
+    DECLARE_MODEL_FROM_JSON(name)                                                            \
     REFLECTED_MODEL(name)                                                                    \
     FOR_EACH_1(CREATE_DESIRED_PROPERTY_CALLBACK, __VA_ARGS__)                                \
     typedef struct name { int :1; FOR_EACH_1(BUILD_MODEL_STRUCT, __VA_ARGS__) } name;        \
     FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT, name, __VA_ARGS__)                               \
     TO_AGENT_DATA_TYPE(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__)))     \
+    MODEL_TO_JSON(name, __VA_ARGS__)                                                         \
+    MODEL_FROM_JSON(name, __VA_ARGS__)                                                       \
     int FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, void* destination)         \
     {                                                                                        \
         (void)source;                                                                        \
@@ -307,6 +319,37 @@ extern "C"
 /*Codes_SRS_SERIALIZER_99_114:[ If CodeFirst_SendAsync fails, SEND shall return IOT_AGENT_SERIALIZE_FAILED.] */
 #define SERIALIZE(destination, destinationSize,...) CodeFirst_SendAsync(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
+/**
+ * @def      SERIALIZE_MODEL(destination, destinationSize, modelName, device)
+ * This macro produces the same JSON as SERIALIZE(destination, destinationSize, *device)
+ * does for a device created without property path, by writing the WITH_DATA
+ * properties straight from the fields of the device. No AGENT_DATA_TYPE and
+ * no MULTITREE is built, the JSON is measured and written into one allocation.
+ * The properties are written in the order they are declared in the model.
+ *
+ * @param   destination                  Pointer to an @c unsigned @c char* that
+ *                                       will receive the serialized data.
+ *                                       The caller frees it.
+ * @param   destinationSize              Pointer to a @c size_t that gets
+ *                                       written with the size in bytes of the
+ *                                       serialized data
+ * @param   modelName                    The model the device is an instance of.
+ * @param   device                       The device, as returned by CREATE_MODEL_INSTANCE.
+ *
+ * @return  JSON_WRITER_OK when the data was serialized.
+ */
+/* Codes_SRS_SERIALIZER_H_01_007: [ SERIALIZE_MODEL shall call JSONWriter_Encode, passing destination, destinationSize, ToJSONProperties_modelName and device, and return its result. ]*/
+#define SERIALIZE_MODEL(destination, destinationSize, modelName, device) JSONWriter_Encode(destination, destinationSize, C2(ToJSONProperties_, modelName), device)
+
+/**
+ * @def      SERIALIZE_MODEL_TO_BUFFER(buffer, bufferSize, length, modelName, device)
+ * Same as ::SERIALIZE_MODEL, but the JSON is written into a buffer owned by the
+ * caller and nothing is allocated. When the buffer is too small the macro
+ * returns JSON_WRITER_BUFFER_TOO_SMALL and length receives the size needed.
+ */
+/* Codes_SRS_SERIALIZER_H_01_008: [ SERIALIZE_MODEL_TO_BUFFER shall call JSONWriter_EncodeToBuffer, passing buffer, bufferSize, length, ToJSONProperties_modelName and device, and return its result. ]*/
+#define SERIALIZE_MODEL_TO_BUFFER(buffer, bufferSize, length, modelName, device) JSONWriter_EncodeToBuffer(buffer, bufferSize, length, C2(ToJSONProperties_, modelName), device)
+
 #define SERIALIZE_REPORTED_PROPERTIES(destination, destinationSize,...) CodeFirst_SendAsyncReported(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
 
@@ -437,14 +480,381 @@ Actions are discarded, since no marshalling will be done for those when sending
 
 #define FIELD_AS_STRING(x,y) memberNames[iMember++] = #y;
 
+/* These macros write a struct or a model directly as JSON, one member per field in
+declaration order, with the same text the AGENT_DATA_TYPE path produces for each value */
+#define ENCODE_JSON_MEMBER(type, name) \
+    JSONWriter_AppendMemberName(writer, memberIndex++, TOSTRING(name), sizeof(TOSTRING(name)) - 1); \
+    C2(ToJSON_, type)(writer, &value->name);
+
+#define TO_JSON(name, ...) \
+    static void C2(ToJSON_, name)(JSON_WRITER* writer, const name* value) \
+    { \
+        size_t memberIndex = 0; \
+        JSONWriter_AppendRaw(writer, "{", 1); \
+        FOR_EACH_2(ENCODE_JSON_MEMBER, __VA_ARGS__) \
+        JSONWriter_AppendRaw(writer, "}", 1); \
+        (void)memberIndex; \
+    }
+
+/* a model used as the type of a property is written with all its data, reported and desired properties, like ToAGENT_DATA_TYPE does */
+#define ENCODE_JSON_MODEL_ELEMENT(elem) ENCODE_JSON_FOR_##elem
+#define ENCODE_JSON_FOR_MODEL_PROPERTY(type, name) ENCODE_JSON_MEMBER(type, name)
+#define ENCODE_JSON_FOR_MODEL_REPORTED_PROPERTY(type, name) ENCODE_JSON_MEMBER(type, name)
+#define ENCODE_JSON_FOR_MODEL_DESIRED_PROPERTY(type, name, ...) ENCODE_JSON_MEMBER(type, name)
+#define ENCODE_JSON_FOR_MODEL_ACTION(...)
+#define ENCODE_JSON_FOR_MODEL_METHOD(...)
+
+/* a device is written with its WITH_DATA properties only, like SERIALIZE(*device) does */
+#define ENCODE_JSON_PROPERTY_ELEMENT(elem) ENCODE_JSON_PROPERTY_FOR_##elem
+#define ENCODE_JSON_PROPERTY_FOR_MODEL_PROPERTY(type, name) ENCODE_JSON_MEMBER(type, name)
+#define ENCODE_JSON_PROPERTY_FOR_MODEL_REPORTED_PROPERTY(type, name)
+#define ENCODE_JSON_PROPERTY_FOR_MODEL_DESIRED_PROPERTY(type, name, ...)
+#define ENCODE_JSON_PROPERTY_FOR_MODEL_ACTION(...)
+#define ENCODE_JSON_PROPERTY_FOR_MODEL_METHOD(...)
+
+/* Codes_SRS_SERIALIZER_H_01_005: [ DECLARE_MODEL shall define a function ToJSON_name that writes the data, reported and desired properties of a name value as a JSON object with a JSON writer. ]*/
+/* Codes_SRS_SERIALIZER_H_01_006: [ DECLARE_MODEL shall define a JSON_WRITER_VALUE_FUNC ToJSONProperties_name that writes the WITH_DATA properties of a device as a JSON object. ]*/
+#define MODEL_TO_JSON(name, ...) \
+    static void C2(ToJSON_, name)(JSON_WRITER* writer, const name* value) \
+    { \
+        size_t memberIndex = 0; \
+        (void)value; \
+        JSONWriter_AppendRaw(writer, "{", 1); \
+        FOR_EACH_1(ENCODE_JSON_MODEL_ELEMENT, __VA_ARGS__) \
+        JSONWriter_AppendRaw(writer, "}", 1); \
+        (void)memberIndex; \
+    } \
+    static void C2(ToJSONProperties_, name)(JSON_WRITER* writer, const void* device) \
+    { \
+        const name* value = (const name*)device; \
+        size_t memberIndex = 0; \
+        (void)value; \
+        JSONWriter_AppendRaw(writer, "{", 1); \
+        FOR_EACH_1(ENCODE_JSON_PROPERTY_ELEMENT, __VA_ARGS__) \
+        JSONWriter_AppendRaw(writer, "}", 1); \
+        (void)memberIndex; \
+    }
+
+/* These macros read a struct or a model directly from JSON text into its fields, accepting the same
+text as the MULTITREE and AGENT_DATA_TYPE path. Members are looked up in a table sorted by name */
+#define JSON_READER_MEMBER_ENTRY(N, type, name) { TOSTRING(name), sizeof(TOSTRING(name)) - 1, N },
+
+/* only models can dispatch actions, for the other types this also tells that they are not models */
+#define NO_JSON_ACTION_DISPATCHER(type) \
+    static jsonActionDispatcher C2(JSONActionDispatcher_, type)(void) \
+    { \
+        return NULL; \
+    }
+
+#define DECODE_JSON_FIELD(N, type, name) \
+    case N: \
+        C2(FromJSON_, type)(reader, &value->name); \
+        break;
+
+/* like FromAGENT_DATA_TYPE, all the fields have to be there and members that are not fields are ignored */
+/* the sort function is in the reflected data of the struct, which comes first */
+#define DECLARE_STRUCT_FROM_JSON(name) \
+    static void C2(SortJSONMembers_, name)(void);
+
+/* Codes_SRS_SERIALIZER_H_01_012: [ DECLARE_STRUCT and DECLARE_MODEL shall define a jsonMemberIndexSorter SortJSONMembers_name that sorts every JSON_READER_MEMBER_INDEX of name with JSONReader_SortMembers. ]*/
+#define FROM_JSON(name, ...) \
+    static JSON_READER_MEMBER C2(JSONFields_, name)[] = { FOR_EACH_2_COUNTED(JSON_READER_MEMBER_ENTRY, __VA_ARGS__) { NULL, 0, 0 } }; \
+    static JSON_READER_MEMBER_INDEX C2(JSONFieldIndex_, name) = { C2(JSONFields_, name), DIV2(COUNT_ARG(__VA_ARGS__)), false }; \
+    static void C2(SortJSONMembers_, name)(void) \
+    { \
+        JSONReader_SortMembers(&C2(JSONFieldIndex_, name)); \
+    } \
+    static void C2(FromJSON_, name)(JSON_READER* reader, name* value) \
+    { \
+        bool isFieldRead[DIV2(COUNT_ARG(__VA_ARGS__))] = { false }; \
+        size_t fieldCount = 0; \
+        const char* memberName; \
+        size_t memberNameLength; \
+        if (JSONReader_BeginObject(reader)) \
+        { \
+            while (JSONReader_NextMember(reader, &memberName, &memberNameLength)) \
+            { \
+                size_t id = JSONReader_FindMember(&C2(JSONFieldIndex_, name), memberName, memberNameLength); \
+                if (id == 0) \
+                { \
+                    JSONReader_SkipValue(reader); \
+                } \
+                else if (isFieldRead[id / 2 - 1]) \
+                { \
+                    LogError("field %.*s of %s is repeated", (int)memberNameLength, memberName, TOSTRING(name)); \
+                    JSONReader_SetError(reader, JSON_READER_PARSE_ERROR); \
+                } \
+                else \
+                { \
+                    isFieldRead[id / 2 - 1] = true; \
+                    fieldCount++; \
+                    switch (id) \
+                    { \
+                        FOR_EACH_2_COUNTED(DECODE_JSON_FIELD, __VA_ARGS__) \
+                        default: \
+                            break; \
+                    } \
+                } \
+            } \
+            if ((reader->result == JSON_READER_OK) && \
+                (fieldCount != DIV2(COUNT_ARG(__VA_ARGS__)))) \
+            { \
+                LogError("not all the fields of %s are in the JSON", TOSTRING(name)); \
+                JSONReader_SetError(reader, JSON_READER_MEMBER_NOT_FOUND); \
+            } \
+        } \
+    } \
+    NO_JSON_ACTION_DISPATCHER(name)
+
+/* the members of a model are its data, reported and desired properties, its actions are looked up in a table of their own */
+#define JSON_READER_MEMBER_ENTITY(N, callType, ...) EXPAND_ARGS(JSON_READER_MEMBER_FOR_##callType(N, __VA_ARGS__))
+#define JSON_READER_MEMBER_SOMETHING(N, ...) EXPAND_ARGS(JSON_READER_MEMBER_ENTITY(N, __VA_ARGS__))
+#define JSON_READER_MEMBER_ELEMENT(N, elem) EXPAND_ARGS(JSON_READER_MEMBER_SOMETHING(N, EXPAND_ARGS(EXPAND_##elem)))
+#define JSON_READER_MEMBER_FOR_MODEL_PROPERTY(N, type, name) JSON_READER_MEMBER_ENTRY(N, type, name)
+#define JSON_READER_MEMBER_FOR_MODEL_REPORTED_PROPERTY(N, type, name) JSON_READER_MEMBER_ENTRY(N, type, name)
+#define JSON_READER_MEMBER_FOR_MODEL_DESIRED_PROPERTY(N, type, name, ...) JSON_READER_MEMBER_ENTRY(N, type, name)
+#define JSON_READER_MEMBER_FOR_MODEL_ACTION(N, ...)
+#define JSON_READER_MEMBER_FOR_MODEL_METHOD(N, ...)
+
+#define JSON_READER_ACTION_ENTITY(N, callType, ...) EXPAND_ARGS(JSON_READER_ACTION_FOR_##callType(N, __VA_ARGS__))
+#define JSON_READER_ACTION_SOMETHING(N, ...) EXPAND_ARGS(JSON_READER_ACTION_ENTITY(N, __VA_ARGS__))
+#define JSON_READER_ACTION_ELEMENT(N, elem) EXPAND_ARGS(JSON_READER_ACTION_SOMETHING(N, EXPAND_ARGS(EXPAND_##elem)))
+#define JSON_READER_ACTION_FOR_MODEL_PROPERTY(N, type, name)
+#define JSON_READER_ACTION_FOR_MODEL_REPORTED_PROPERTY(N, type, name)
+#define JSON_READER_ACTION_FOR_MODEL_DESIRED_PROPERTY(N, type, name, ...)
+#define JSON_READER_ACTION_FOR_MODEL_ACTION(N, actionName, ...) JSON_READER_MEMBER_ENTRY(N, , actionName)
+#define JSON_READER_ACTION_FOR_MODEL_METHOD(N, ...)
+
+/* desired properties are read into the device, a model used as the type of a property is read recursively, like CommandDecoder_IngestDesiredProperties does */
+#define DECODE_JSON_DESIRED_ENTITY(N, callType, ...) EXPAND_ARGS(DECODE_JSON_DESIRED_FOR_##callType(N, __VA_ARGS__))
+#define DECODE_JSON_DESIRED_SOMETHING(N, ...) EXPAND_ARGS(DECODE_JSON_DESIRED_ENTITY(N, __VA_ARGS__))
+#define DECODE_JSON_DESIRED_ELEMENT(N, elem) EXPAND_ARGS(DECODE_JSON_DESIRED_SOMETHING(N, EXPAND_ARGS(EXPAND_##elem)))
+#define DECODE_JSON_MODEL_IN_MODEL(N, type, name, what) \
+    case N: \
+        if (C2(JSONActionDispatcher_, type)() == NULL) \
+        { \
+            LogError("cannot ingest name (" what " instead of WITH_DESIRED_PROPERTY): %s", TOSTRING(name)); \
+            JSONReader_SetError(reader, JSON_READER_TYPE_MISMATCH); \
+        } \
+        else \
+        { \
+            C2(FromJSON_, type)(reader, &value->name); \
+        } \
+        break;
+#define DECODE_JSON_DESIRED_FOR_MODEL_PROPERTY(N, type, name) DECODE_JSON_MODEL_IN_MODEL(N, type, name, "WITH_DATA")
+#define DECODE_JSON_DESIRED_FOR_MODEL_REPORTED_PROPERTY(N, type, name) DECODE_JSON_MODEL_IN_MODEL(N, type, name, "WITH_REPORTED_PROPERTY")
+#define DECODE_JSON_DESIRED_FOR_MODEL_DESIRED_PROPERTY(N, type, name, ...) \
+    case N: \
+        C2(FromJSON_, type)(reader, &value->name); \
+        IF(COUNT_ARG(__VA_ARGS__), if (reader->result == JSON_READER_OK) { __VA_ARGS__(value); }, ) \
+        break;
+#define DECODE_JSON_DESIRED_FOR_MODEL_ACTION(N, ...)
+#define DECODE_JSON_DESIRED_FOR_MODEL_METHOD(N, ...)
+
+/* "child/action" is dispatched by the model in model named child, which is WITH_DATA like for CodeFirst_InvokeAction */
+#define DISPATCH_JSON_CHILD_ENTITY(N, callType, ...) EXPAND_ARGS(DISPATCH_JSON_CHILD_FOR_##callType(N, __VA_ARGS__))
+#define DISPATCH_JSON_CHILD_SOMETHING(N, ...) EXPAND_ARGS(DISPATCH_JSON_CHILD_ENTITY(N, __VA_ARGS__))
+#define DISPATCH_JSON_CHILD_ELEMENT(N, elem) EXPAND_ARGS(DISPATCH_JSON_CHILD_SOMETHING(N, EXPAND_ARGS(EXPAND_##elem)))
+#define DISPATCH_JSON_CHILD(N, type, name) \
+    case N: \
+        childDispatcher = C2(JSONActionDispatcher_, type)(); \
+        child = &value->name; \
+        break;
+#define DISPATCH_JSON_CHILD_FOR_MODEL_PROPERTY(N, type, name) DISPATCH_JSON_CHILD(N, type, name)
+#define DISPATCH_JSON_CHILD_FOR_MODEL_REPORTED_PROPERTY(N, type, name)
+#define DISPATCH_JSON_CHILD_FOR_MODEL_DESIRED_PROPERTY(N, type, name, ...)
+#define DISPATCH_JSON_CHILD_FOR_MODEL_ACTION(N, ...)
+#define DISPATCH_JSON_CHILD_FOR_MODEL_METHOD(N, ...)
+
+/* the parameters of an action are read by name into the same locals the AGENT_DATA_TYPE wrapper uses, members that are not parameters are ignored */
+#define JSON_READER_PARAMETER_INDEX(actionName, ...) \
+    static JSON_READER_MEMBER C2(actionName, JSONPARAMETERS)[] = { FOR_EACH_2_COUNTED(JSON_READER_MEMBER_ENTRY, __VA_ARGS__) { NULL, 0, 0 } }; \
+    static JSON_READER_MEMBER_INDEX C2(actionName, JSONPARAMETERINDEX) = { C2(actionName, JSONPARAMETERS), DIV2(COUNT_ARG(__VA_ARGS__)), false };
+#define DEFINE_LOCAL_PARAMETER_IS_READ(type, name) bool C2(name, _isRead) = false;
+#define DESTROY_LOCAL_PARAMETER(type, name) C2(destroyLocalParameter, type)(&C2(name, _local));
+#define DECODE_JSON_PARAMETER(N, type, name) \
+    case N: \
+        if (C2(name, _isRead)) \
+        { \
+            JSONReader_SetError(parameters, JSON_READER_PARSE_ERROR); \
+        } \
+        else \
+        { \
+            C2(FromJSON_, type)(parameters, &C2(name, _local)); \
+            C2(name, _isRead) = true; \
+            parameterCount++; \
+        } \
+        break;
+#define DECODE_JSON_ACTION_ENTITY(N, callType, ...) EXPAND_ARGS(DECODE_JSON_ACTION_FOR_##callType(N, __VA_ARGS__))
+#define DECODE_JSON_ACTION_SOMETHING(N, ...) EXPAND_ARGS(DECODE_JSON_ACTION_ENTITY(N, __VA_ARGS__))
+#define DECODE_JSON_ACTION_ELEMENT(N, elem) EXPAND_ARGS(DECODE_JSON_ACTION_SOMETHING(N, EXPAND_ARGS(EXPAND_##elem)))
+#define DECODE_JSON_ACTION_FOR_MODEL_PROPERTY(N, type, name)
+#define DECODE_JSON_ACTION_FOR_MODEL_REPORTED_PROPERTY(N, type, name)
+#define DECODE_JSON_ACTION_FOR_MODEL_DESIRED_PROPERTY(N, type, name, ...)
+#define DECODE_JSON_ACTION_FOR_MODEL_METHOD(N, ...)
+#define DECODE_JSON_ACTION_FOR_MODEL_ACTION(N, actionName, ...) \
+    case N: \
+    { \
+        size_t parameterCount = 0; \
+        const char* parameterName; \
+        size_t parameterNameLength; \
+        FOR_EACH_2(DEFINE_LOCAL_PARAMETER, __VA_ARGS__) \
+        FOR_EACH_2(DEFINE_LOCAL_PARAMETER_IS_READ, __VA_ARGS__) \
+        if (JSONReader_BeginObject(parameters)) \
+        { \
+            while (JSONReader_NextMember(parameters, &parameterName, &parameterNameLength)) \
+            { \
+                switch (JSONReader_FindMember(&C2(actionName, JSONPARAMETERINDEX), parameterName, parameterNameLength)) \
+                { \
+                    FOR_EACH_2_COUNTED(DECODE_JSON_PARAMETER, __VA_ARGS__) \
+                    default: \
+                        JSONReader_SkipValue(parameters); \
+                        break; \
+                } \
+            } \
+        } \
+        JSONReader_End(parameters); \
+        if ((parameters->result != JSON_READER_OK) || \
+            (parameterCount != DIV2(COUNT_ARG(__VA_ARGS__)))) \
+        { \
+            LogError("the parameters of action %s could not be read", TOSTRING(actionName)); \
+            result = EXECUTE_COMMAND_ERROR; \
+        } \
+        else \
+        { \
+            result = actionName(value FOR_EACH_2(PUSH_LOCAL_PARAMETER, __VA_ARGS__)); \
+        } \
+        FOR_EACH_2(DESTROY_LOCAL_PARAMETER, __VA_ARGS__) \
+        break; \
+    }
+
+/* the model functions are in the reflected data of the model, which comes first */
+#define DECLARE_MODEL_FROM_JSON(name) \
+    static void C2(DesiredPropertiesFromJSON_, name)(JSON_READER* reader, void* device, bool isDocumentRoot); \
+    static EXECUTE_COMMAND_RESULT C2(ActionFromJSON_, name)(void* device, const char* actionPath, size_t actionPathLength, JSON_READER* parameters); \
+    static void C2(SortJSONMembers_, name)(void);
+
+#define SORT_JSON_PARAMETERS_ENTITY(N, callType, ...) EXPAND_ARGS(SORT_JSON_PARAMETERS_FOR_##callType(N, __VA_ARGS__))
+#define SORT_JSON_PARAMETERS_SOMETHING(N, ...) EXPAND_ARGS(SORT_JSON_PARAMETERS_ENTITY(N, __VA_ARGS__))
+#define SORT_JSON_PARAMETERS_ELEMENT(N, elem) EXPAND_ARGS(SORT_JSON_PARAMETERS_SOMETHING(N, EXPAND_ARGS(EXPAND_##elem)))
+#define SORT_JSON_PARAMETERS_FOR_MODEL_PROPERTY(N, type, name)
+#define SORT_JSON_PARAMETERS_FOR_MODEL_REPORTED_PROPERTY(N, type, name)
+#define SORT_JSON_PARAMETERS_FOR_MODEL_DESIRED_PROPERTY(N, type, name, ...)
+#define SORT_JSON_PARAMETERS_FOR_MODEL_ACTION(N, actionName, ...) JSONReader_SortMembers(&C2(actionName, JSONPARAMETERINDEX));
+#define SORT_JSON_PARAMETERS_FOR_MODEL_METHOD(N, ...)
+
+/* Codes_SRS_SERIALIZER_H_01_010: [ DECLARE_MODEL shall define a jsonDesiredPropertiesDecoder DesiredPropertiesFromJSON_name that reads the desired properties of a device from a JSON object with a JSON reader, calling their onDesiredProperty callbacks. ]*/
+/* Codes_SRS_SERIALIZER_H_01_011: [ DECLARE_MODEL shall define a jsonActionDispatcher ActionFromJSON_name that reads the parameters of an action of the model or of one of its models in model from a JSON object and calls the action. ]*/
+#define MODEL_FROM_JSON(name, ...) \
+    static JSON_READER_MEMBER C2(JSONMembers_, name)[] = { FOR_EACH_1_COUNTED(JSON_READER_MEMBER_ELEMENT, __VA_ARGS__) { NULL, 0, 0 } }; \
+    static JSON_READER_MEMBER_INDEX C2(JSONMemberIndex_, name) = { C2(JSONMembers_, name), sizeof(C2(JSONMembers_, name)) / sizeof(JSON_READER_MEMBER) - 1, false }; \
+    static JSON_READER_MEMBER C2(JSONActions_, name)[] = { FOR_EACH_1_COUNTED(JSON_READER_ACTION_ELEMENT, __VA_ARGS__) { NULL, 0, 0 } }; \
+    static JSON_READER_MEMBER_INDEX C2(JSONActionIndex_, name) = { C2(JSONActions_, name), sizeof(C2(JSONActions_, name)) / sizeof(JSON_READER_MEMBER) - 1, false }; \
+    static void C2(SortJSONMembers_, name)(void) \
+    { \
+        JSONReader_SortMembers(&C2(JSONMemberIndex_, name)); \
+        JSONReader_SortMembers(&C2(JSONActionIndex_, name)); \
+        FOR_EACH_1_COUNTED(SORT_JSON_PARAMETERS_ELEMENT, __VA_ARGS__) \
+    } \
+    static void C2(DesiredPropertiesFromJSON_, name)(JSON_READER* reader, void* device, bool isDocumentRoot) \
+    { \
+        name* value = (name*)device; \
+        bool isMemberRead[COUNT_ARG(__VA_ARGS__) + 1] = { false }; \
+        const char* memberName; \
+        size_t memberNameLength; \
+        if (JSONReader_BeginObject(reader)) \
+        { \
+            while (JSONReader_NextMember(reader, &memberName, &memberNameLength)) \
+            { \
+                size_t id = JSONReader_FindMember(&C2(JSONMemberIndex_, name), memberName, memberNameLength); \
+                if ((id != 0) && isMemberRead[id]) \
+                { \
+                    LogError("member %.*s of %s is repeated", (int)memberNameLength, memberName, TOSTRING(name)); \
+                    JSONReader_SetError(reader, JSON_READER_PARSE_ERROR); \
+                } \
+                else \
+                { \
+                    isMemberRead[id] = true; \
+                    switch (id) \
+                    { \
+                        FOR_EACH_1_COUNTED(DECODE_JSON_DESIRED_ELEMENT, __VA_ARGS__) \
+                        default: \
+                            /* the service adds $version to the desired properties of a twin */ \
+                            if (isDocumentRoot && \
+                                (memberNameLength == sizeof("$version") - 1) && \
+                                (memcmp(memberName, "$version", memberNameLength) == 0)) \
+                            { \
+                                JSONReader_SkipValue(reader); \
+                            } \
+                            else \
+                            { \
+                                LogError("%.*s is not a member of %s", (int)memberNameLength, memberName, TOSTRING(name)); \
+                                JSONReader_SetError(reader, JSON_READER_MEMBER_NOT_FOUND); \
+                            } \
+                            break; \
+                    } \
+                } \
+            } \
+        } \
+        (void)value; \
+    } \
+    static void C2(FromJSON_, name)(JSON_READER* reader, name* value) \
+    { \
+        C2(DesiredPropertiesFromJSON_, name)(reader, value, false); \
+    } \
+    static EXECUTE_COMMAND_RESULT C2(ActionFromJSON_, name)(void* device, const char* actionPath, size_t actionPathLength, JSON_READER* parameters) \
+    { \
+        EXECUTE_COMMAND_RESULT result; \
+        name* value = (name*)device; \
+        const char* slash = (const char*)memchr(actionPath, '/', actionPathLength); \
+        if (slash != NULL) \
+        { \
+            jsonActionDispatcher childDispatcher = NULL; \
+            void* child = NULL; \
+            size_t childNameLength = (size_t)(slash - actionPath); \
+            switch (JSONReader_FindMember(&C2(JSONMemberIndex_, name), actionPath, childNameLength)) \
+            { \
+                FOR_EACH_1_COUNTED(DISPATCH_JSON_CHILD_ELEMENT, __VA_ARGS__) \
+                default: \
+                    break; \
+            } \
+            if (childDispatcher == NULL) \
+            { \
+                LogError("%.*s is not a model in model of %s", (int)childNameLength, actionPath, TOSTRING(name)); \
+                result = EXECUTE_COMMAND_ERROR; \
+            } \
+            else \
+            { \
+                result = childDispatcher(child, slash + 1, actionPathLength - childNameLength - 1, parameters); \
+            } \
+        } \
+        else \
+        { \
+            switch (JSONReader_FindMember(&C2(JSONActionIndex_, name), actionPath, actionPathLength)) \
+            { \
+                FOR_EACH_1_COUNTED(DECODE_JSON_ACTION_ELEMENT, __VA_ARGS__) \
+                default: \
+                    LogError("%.*s is not an action of %s", (int)actionPathLength, actionPath, TOSTRING(name)); \
+                    result = EXECUTE_COMMAND_ERROR; \
+                    break; \
+            } \
+        } \
+        (void)value; \
+        return result; \
+    } \
+    static jsonActionDispatcher C2(JSONActionDispatcher_, name)(void) \
+    { \
+        return C2(ActionFromJSON_, name); \
+    }
+
 #define REFLECTED_LIST_HEAD(name) \
     static const REFLECTED_DATA_FROM_DATAPROVIDER ALL_REFLECTED(name) = { &C2(REFLECTED_, C1(DEC(__COUNTER__))) };
 #define REFLECTED_STRUCT(name) \
-    static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_STRUCT_TYPE,               &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {TOSTRING(name)}, {0}, {0}, {0}, {0}} };
+    static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_STRUCT_TYPE,               &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {TOSTRING(name), C2(SortJSONMembers_, name)}, {0}, {0}, {0}, {0}} };
 #define REFLECTED_FIELD(XstructName, XfieldType, XfieldName) \
     static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_FIELD_TYPE,                &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {TOSTRING(XfieldName), TOSTRING(XfieldType), TOSTRING(XstructName)}, {0}, {0}, {0} } };
 #define REFLECTED_MODEL(name) \
-    static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {TOSTRING(name)} } };
+    static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {TOSTRING(name), C2(DesiredPropertiesFromJSON_, name), C2(ActionFromJSON_, name), C2(SortJSONMembers_, name)} } };
 #define REFLECTED_PROPERTY(type, name, modelName) \
     static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_PROPERTY_TYPE,             &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {TOSTRING(name), TOSTRING(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name, offsetof(modelName, name), sizeof(type), TOSTRING(modelName)}, {0}, {0} } };
 #define REFLECTED_REPORTED_PROPERTY(type, name, modelName) \
@@ -568,6 +978,7 @@ Actions are discarded, since no marshalling will be done for those when sending
     DEFINITION_THAT_CAN_SUSTAIN_A_COMMA_STEAL(actionName, 1); \
     static const WRAPPER_ARGUMENT C2(actionName, WRAPPERARGUMENTS)[DIV2(INC(INC(COUNT_ARG(__VA_ARGS__))))] = { FOR_EACH_2_COUNTED(MAKE_WRAPPER_ARGUMENT, __VA_ARGS__) IFCOMMA(INC(INC(COUNT_ARG(__VA_ARGS__)))) {0} }; \
     REFLECTED_ACTION(actionName, DIV2(COUNT_ARG(__VA_ARGS__)), C2(actionName, WRAPPERARGUMENTS), C2(actionName, WRAPPER), modelName) \
+    JSON_READER_PARAMETER_INDEX(actionName, __VA_ARGS__) \
     /*Codes_SRS_SERIALIZER_99_040:[ In addition to declaring the function, DECLARE_IOT_METHOD shall provide a definition for a wrapper that takes as parameters a size_t parameterCount and const AGENT_DATA_TYPE*.] */ \
     /*Codes_SRS_SERIALIZER_99_041:[ This wrapper shall convert all the arguments to predefined types and then call the function written by the data provider developer.]*/ \
     static EXECUTE_COMMAND_RESULT C2(actionName, WRAPPER)(void* device, size_t ParameterCount, const AGENT_DATA_TYPE* values) \
@@ -1511,6 +1922,159 @@ static void C2(destroyLocalParameter, ascii_char_ptr_no_quotes)(ascii_char_ptr_n
     }
 }
 
+/* the JSON writers of the predefined types, used by the ToJSON_ functions of structs and models */
+static void C2(ToJSON_, double)(JSON_WRITER* writer, const double* value)
+{
+    JSONWriter_AppendDouble(writer, *value);
+}
+
+static void C2(ToJSON_, float)(JSON_WRITER* writer, const float* value)
+{
+    JSONWriter_AppendFloat(writer, *value);
+}
+
+static void C2(ToJSON_, int)(JSON_WRITER* writer, const int* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, long)(JSON_WRITER* writer, const long* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, int8_t)(JSON_WRITER* writer, const int8_t* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, uint8_t)(JSON_WRITER* writer, const uint8_t* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, int16_t)(JSON_WRITER* writer, const int16_t* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, int32_t)(JSON_WRITER* writer, const int32_t* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, int64_t)(JSON_WRITER* writer, const int64_t* value)
+{
+    JSONWriter_AppendInt64(writer, *value);
+}
+
+static void C2(ToJSON_, bool)(JSON_WRITER* writer, const bool* value)
+{
+    JSONWriter_AppendBool(writer, *value);
+}
+
+static void C2(ToJSON_, ascii_char_ptr)(JSON_WRITER* writer, const ascii_char_ptr* value)
+{
+    JSONWriter_AppendString(writer, *value);
+}
+
+static void C2(ToJSON_, ascii_char_ptr_no_quotes)(JSON_WRITER* writer, const ascii_char_ptr_no_quotes* value)
+{
+    JSONWriter_AppendStringNoQuotes(writer, *value);
+}
+
+static void C2(ToJSON_, EDM_DATE_TIME_OFFSET)(JSON_WRITER* writer, const EDM_DATE_TIME_OFFSET* value)
+{
+    JSONWriter_AppendDateTimeOffset(writer, value);
+}
+
+static void C2(ToJSON_, EDM_GUID)(JSON_WRITER* writer, const EDM_GUID* value)
+{
+    JSONWriter_AppendGuid(writer, value);
+}
+
+static void C2(ToJSON_, EDM_BINARY)(JSON_WRITER* writer, const EDM_BINARY* value)
+{
+    JSONWriter_AppendBinary(writer, value);
+}
+
+/* the JSON readers of the predefined types, used by the FromJSON_ functions of structs and models */
+static void C2(FromJSON_, double)(JSON_READER* reader, double* value)
+{
+    JSONReader_ReadDouble(reader, value);
+}
+
+static void C2(FromJSON_, float)(JSON_READER* reader, float* value)
+{
+    JSONReader_ReadFloat(reader, value);
+}
+
+/* the integers are read with the range of the EDM type CodeFirst_GetPrimitiveType maps them to */
+#define FROM_JSON_INTEGER(type, minimum, maximum) \
+static void C2(FromJSON_, type)(JSON_READER* reader, type* value) \
+{ \
+    int64_t number; \
+    JSONReader_ReadInt64(reader, minimum, maximum, &number); \
+    if (reader->result == JSON_READER_OK) \
+    { \
+        *value = (type)number; \
+    } \
+}
+
+FROM_JSON_INTEGER(int, INT32_MIN, INT32_MAX)
+FROM_JSON_INTEGER(long, LONG_MIN, LONG_MAX)
+FROM_JSON_INTEGER(int8_t, INT8_MIN, INT8_MAX)
+FROM_JSON_INTEGER(uint8_t, 0, UINT8_MAX)
+FROM_JSON_INTEGER(int16_t, INT16_MIN, INT16_MAX)
+FROM_JSON_INTEGER(int32_t, INT32_MIN, INT32_MAX)
+FROM_JSON_INTEGER(int64_t, INT64_MIN, INT64_MAX)
+
+static void C2(FromJSON_, bool)(JSON_READER* reader, bool* value)
+{
+    JSONReader_ReadBool(reader, value);
+}
+
+static void C2(FromJSON_, ascii_char_ptr)(JSON_READER* reader, ascii_char_ptr* value)
+{
+    JSONReader_ReadCharz(reader, value);
+}
+
+static void C2(FromJSON_, ascii_char_ptr_no_quotes)(JSON_READER* reader, ascii_char_ptr_no_quotes* value)
+{
+    JSONReader_ReadCharzNoQuotes(reader, value);
+}
+
+static void C2(FromJSON_, EDM_DATE_TIME_OFFSET)(JSON_READER* reader, EDM_DATE_TIME_OFFSET* value)
+{
+    JSONReader_ReadDateTimeOffset(reader, value);
+}
+
+static void C2(FromJSON_, EDM_GUID)(JSON_READER* reader, EDM_GUID* value)
+{
+    JSONReader_ReadGuid(reader, value);
+}
+
+static void C2(FromJSON_, EDM_BINARY)(JSON_READER* reader, EDM_BINARY* value)
+{
+    JSONReader_ReadBinary(reader, value);
+}
+
+NO_JSON_ACTION_DISPATCHER(double)
+NO_JSON_ACTION_DISPATCHER(float)
+NO_JSON_ACTION_DISPATCHER(int)
+NO_JSON_ACTION_DISPATCHER(long)
+NO_JSON_ACTION_DISPATCHER(int8_t)
+NO_JSON_ACTION_DISPATCHER(uint8_t)
+NO_JSON_ACTION_DISPATCHER(int16_t)
+NO_JSON_ACTION_DISPATCHER(int32_t)
+NO_JSON_ACTION_DISPATCHER(int64_t)
+NO_JSON_ACTION_DISPATCHER(bool)
+NO_JSON_ACTION_DISPATCHER(ascii_char_ptr)
+NO_JSON_ACTION_DISPATCHER(ascii_char_ptr_no_quotes)
+NO_JSON_ACTION_DISPATCHER(EDM_DATE_TIME_OFFSET)
+NO_JSON_ACTION_DISPATCHER(EDM_GUID)
+NO_JSON_ACTION_DISPATCHER(EDM_BINARY)
+
 #ifdef __cplusplus
     }
 #endif
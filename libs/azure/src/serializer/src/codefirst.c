@@ -26,6 +26,9 @@ typedef struct DEVICE_HEADER_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     size_t DataSize;
     unsigned char* data;
+    /* the in place JSON decoders of the model, NULL when commands and desired properties go through Device */
+    jsonDesiredPropertiesDecoder DesiredPropertiesFromJSON;
+    jsonActionDispatcher ActionFromJSON;
 } DEVICE_HEADER_DATA;
 
 #define COUNT_OF(A) (sizeof(A) / sizeof((A)[0]))
@@ -486,6 +489,25 @@ static const REFLECTED_SOMETHING* FindModelInCodeFirstMetadata(const REFLECTED_S
     return result;
 }
 
+static void SortJSONMembersInCodeFirstMetadata(const REFLECTED_SOMETHING* reflectedData)
+{
+    const REFLECTED_SOMETHING* something;
+
+    for (something = reflectedData; something != NULL; something = something->next)
+    {
+        if ((something->type == REFLECTION_STRUCT_TYPE) &&
+            (something->what.structure.sortJSONMembers != NULL))
+        {
+            something->what.structure.sortJSONMembers();
+        }
+        else if ((something->type == REFLECTION_MODEL_TYPE) &&
+            (something->what.model.sortJSONMembers != NULL))
+        {
+            something->what.model.sortJSONMembers();
+        }
+    }
+}
+
 static const REFLECTED_SOMETHING* FindChildModelInCodeFirstMetadata(const REFLECTED_SOMETHING* reflectedData, const REFLECTED_SOMETHING* startModel, const char* relativePath, size_t* offset)
 {
     const REFLECTED_SOMETHING* result = startModel;
@@ -702,6 +724,9 @@ SCHEMA_HANDLE CodeFirst_RegisterSchema(const char* schemaNamespace, const REFLEC
         result = Schema_GetSchemaByNamespace(schemaNamespace);
         if (result == NULL)
         {
+            /*Codes_SRS_CODEFIRST_01_008: [ Before it creates a schema that is not registered yet, CodeFirst_RegisterSchema shall call the jsonMemberIndexSorter of every struct and model in metadata, so that the member indexes are sorted before any device can be created from the schema and the JSON decoders only read them. ]*/
+            SortJSONMembersInCodeFirstMetadata(metadata->reflectedData);
+
             if ((result = Schema_Create(schemaNamespace, (void*)metadata)) == NULL)
             {
                 /* Codes_SRS_CODEFIRST_99_076:[If any Schema APIs fail, CodeFirst_RegisterSchema shall return NULL.] */
@@ -939,9 +964,15 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                 else
                 {
                     SCHEMA_RESULT schemaResult;
+                    const char* modelName = Schema_GetModelName(model);
+                    const REFLECTED_SOMETHING* reflectedModel = ((metadata == NULL) || (modelName == NULL)) ? NULL : FindModelInCodeFirstMetadata(metadata->reflectedData, modelName);
                     deviceHeader->ReflectedData = metadata;
                     deviceHeader->DataSize = dataSize;
                     deviceHeader->ModelHandle = model;
+                    /*Codes_SRS_CODEFIRST_01_002: [ CodeFirst_CreateDevice shall keep the JSON decoders of the model found in metadata with the name of model. ]*/
+                    /*Codes_SRS_CODEFIRST_01_003: [ If the model is not found in metadata, the JSON decoders shall be NULL. ]*/
+                    deviceHeader->DesiredPropertiesFromJSON = (reflectedModel == NULL) ? NULL : reflectedModel->what.model.desiredPropertiesFromJSON;
+                    deviceHeader->ActionFromJSON = (reflectedModel == NULL) ? NULL : reflectedModel->what.model.actionFromJSON;
                     schemaResult = Schema_AddDeviceRef(model);
                     if (schemaResult != SCHEMA_OK)
                     {
@@ -1524,6 +1555,140 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
     return result;
 }
 
+/* reads {"Name":"child/action","Parameters":{...}} in place and has the model dispatch the action */
+static EXECUTE_COMMAND_RESULT ExecuteCommandFromJSON(DEVICE_HEADER_DATA* deviceHeader, const char* command)
+{
+    EXECUTE_COMMAND_RESULT result;
+    JSON_READER reader;
+    const char* memberName;
+    size_t memberNameLength;
+    const char* actionPath = NULL;
+    size_t actionPathLength = 0;
+    size_t parametersStart = 0;
+    size_t parametersEnd = 0;
+
+    JSONReader_Init(&reader, command, strlen(command));
+    if (JSONReader_BeginObject(&reader))
+    {
+        while (JSONReader_NextMember(&reader, &memberName, &memberNameLength))
+        {
+            if ((memberNameLength == sizeof("Name") - 1) &&
+                (memcmp(memberName, "Name", memberNameLength) == 0))
+            {
+                JSONReader_ReadString(&reader, &actionPath, &actionPathLength);
+            }
+            else if ((memberNameLength == sizeof("Parameters") - 1) &&
+                (memcmp(memberName, "Parameters", memberNameLength) == 0))
+            {
+                /* the parameters can come before the name, they are read once the action is known */
+                parametersStart = reader.position;
+                JSONReader_SkipValue(&reader);
+                parametersEnd = reader.position;
+            }
+            else
+            {
+                JSONReader_SkipValue(&reader);
+            }
+        }
+    }
+    JSONReader_End(&reader);
+
+    if (reader.result != JSON_READER_OK)
+    {
+        LogError("the command is not valid JSON");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else if ((actionPath == NULL) ||
+        (actionPathLength == 0))
+    {
+        LogError("Getting action name failed.");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else if (parametersEnd == 0)
+    {
+        LogError("Error getting Parameters node.");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        JSON_READER parameters;
+        JSONReader_Init(&parameters, command + parametersStart, parametersEnd - parametersStart);
+        result = deviceHeader->ActionFromJSON(deviceHeader->data, actionPath, actionPathLength, &parameters);
+    }
+    return result;
+}
+
+/* reads the desired properties in place, straight into the device */
+static CODEFIRST_RESULT IngestDesiredPropertiesFromJSON(DEVICE_HEADER_DATA* deviceHeader, const char* jsonPayload, bool parseDesiredNode)
+{
+    CODEFIRST_RESULT result;
+    JSON_READER reader;
+    size_t jsonPayloadLength = strlen(jsonPayload);
+
+    /* the text is checked before anything is written into the device, like the MULTITREE is built first */
+    JSONReader_Init(&reader, jsonPayload, jsonPayloadLength);
+    JSONReader_SkipValue(&reader);
+    JSONReader_End(&reader);
+
+    if (reader.result != JSON_READER_OK)
+    {
+        /* nothing more to read */
+    }
+    else if (!parseDesiredNode)
+    {
+        JSONReader_Init(&reader, jsonPayload, jsonPayloadLength);
+        deviceHeader->DesiredPropertiesFromJSON(&reader, deviceHeader->data, true);
+    }
+    else
+    {
+        /* a full twin, only its "desired" member is read */
+        bool isDesiredFound = false;
+        const char* memberName;
+        size_t memberNameLength;
+        JSONReader_Init(&reader, jsonPayload, jsonPayloadLength);
+        if (JSONReader_BeginObject(&reader))
+        {
+            while (JSONReader_NextMember(&reader, &memberName, &memberNameLength))
+            {
+                if ((memberNameLength != sizeof("desired") - 1) ||
+                    (memcmp(memberName, "desired", memberNameLength) != 0))
+                {
+                    JSONReader_SkipValue(&reader);
+                }
+                else if (isDesiredFound)
+                {
+                    LogError("'desired' is repeated in tree");
+                    JSONReader_SetError(&reader, JSON_READER_PARSE_ERROR);
+                }
+                else
+                {
+                    deviceHeader->DesiredPropertiesFromJSON(&reader, deviceHeader->data, true);
+                    isDesiredFound = true;
+                }
+            }
+        }
+
+        if ((reader.result == JSON_READER_OK) &&
+            (!isDesiredFound))
+        {
+            LogError("Unable to find 'desired' in tree");
+            JSONReader_SetError(&reader, JSON_READER_MEMBER_NOT_FOUND);
+        }
+    }
+    JSONReader_End(&reader);
+
+    if (reader.result != JSON_READER_OK)
+    {
+        LogError("failure reading the desired properties");
+        result = CODEFIRST_ERROR;
+    }
+    else
+    {
+        result = CODEFIRST_OK;
+    }
+    return result;
+}
+
 EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommand(void* device, const char* command)
 {
     EXECUTE_COMMAND_RESULT result;
@@ -1546,6 +1711,12 @@ EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommand(void* device, const char* comman
             result = EXECUTE_COMMAND_ERROR;
             LogError("unable to find the device given by address %p", device);
         }
+        else if (deviceHeader->ActionFromJSON != NULL)
+        {
+            /*Codes_SRS_CODEFIRST_01_004: [ If the model of the device has JSON decoders, CodeFirst_ExecuteCommand shall read the action name and the parameters from the command JSON in place and call the action through the jsonActionDispatcher of the model. ]*/
+            /*Codes_SRS_CODEFIRST_01_005: [ If the command is not valid JSON, has no string member "Name" or no member "Parameters", CodeFirst_ExecuteCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+            result = ExecuteCommandFromJSON(deviceHeader, command);
+        }
         else
         {
             /*Codes_SRS_CODEFIRST_02_017: [Otherwise CodeFirst_ExecuteCommand shall call Device_ExecuteCommand and return what Device_ExecuteCommand is returning.] */
@@ -1605,6 +1776,12 @@ CODEFIRST_RESULT CodeFirst_IngestDesiredProperties(void* device, const char* jso
             LogError("unable to find a device having this memory address %p", device);
             result = CODEFIRST_ERROR;
         }
+        else if (deviceHeader->DesiredPropertiesFromJSON != NULL)
+        {
+            /*Codes_SRS_CODEFIRST_01_006: [ If the model of the device has JSON decoders, CodeFirst_IngestDesiredProperties shall read the desired properties from jsonPayload in place into the device, only from the member "desired" when parseDesiredNode is true, and skip "$version". ]*/
+            /*Codes_SRS_CODEFIRST_01_007: [ If jsonPayload is not valid JSON, in which case the device is left unchanged, has a member that is not a desired property or a model in model of the device, repeats a member, or has no member "desired" when parseDesiredNode is true, CodeFirst_IngestDesiredProperties shall return CODEFIRST_ERROR. ]*/
+            result = IngestDesiredPropertiesFromJSON(deviceHeader, jsonPayload, parseDesiredNode);
+        }
         else
         {
             /*Codes_SRS_CODEFIRST_02_033: [ CodeFirst_IngestDesiredProperties shall call Device_IngestDesiredProperties. ]*/
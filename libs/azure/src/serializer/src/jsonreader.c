@@ -0,0 +1,1018 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "jsonreader.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(JSON_READER_RESULT, JSON_READER_RESULT_VALUES);
+
+#define NaN_STRING "\"NaN\""
+#define MINUSINF_STRING "\"-INF\""
+#define PLUSINF_STRING "\"INF\""
+
+/* the same bound JSONWriter_AppendDouble writes with, plus room for an exponent */
+#define MAX_NUMBER_TOKEN_LENGTH (1 + (DBL_MAX_10_EXP + 1) + 1 + DBL_DIG + 8)
+
+/* more than the longest date time offset or GUID CreateAgentDataType_From_String accepts */
+#define MAX_STRING_TOKEN_LENGTH 128
+
+#define IS_WHITE_SPACE(c) (((c) == ' ') || ((c) == '\t') || ((c) == '\n') || ((c) == '\r'))
+#define IS_DIGIT(c) (((c) >= '0') && ((c) <= '9'))
+
+typedef enum JSON_TOKEN_TYPE_TAG
+{
+    JSON_TOKEN_STRING,
+    JSON_TOKEN_NUMBER,
+    JSON_TOKEN_LITERAL
+} JSON_TOKEN_TYPE;
+
+typedef struct JSON_TOKEN_TAG
+{
+    const char* text; /* strings include their quotes */
+    size_t length;
+    JSON_TOKEN_TYPE type;
+    bool isInteger; /* a number without fraction and exponent */
+} JSON_TOKEN;
+
+static void setError(JSON_READER* reader, JSON_READER_RESULT result)
+{
+    reader->result = result;
+    LogError("(result = %s, position = %lu)", ENUM_TO_STRING(JSON_READER_RESULT, result), (unsigned long)reader->position);
+}
+
+/* true when reads can go on, the error of an earlier read is kept */
+static bool canRead(JSON_READER* reader)
+{
+    bool result;
+    if (reader == NULL)
+    {
+        LogError("NULL reader");
+        result = false;
+    }
+    else
+    {
+        result = (reader->result == JSON_READER_OK);
+    }
+    return result;
+}
+
+static void skipWhiteSpace(JSON_READER* reader)
+{
+    while ((reader->position < reader->length) &&
+        IS_WHITE_SPACE(reader->json[reader->position]))
+    {
+        reader->position++;
+    }
+}
+
+static bool isAtEnd(const JSON_READER* reader)
+{
+    return reader->position >= reader->length;
+}
+
+static char currentChar(const JSON_READER* reader)
+{
+    return isAtEnd(reader) ? '\0' : reader->json[reader->position];
+}
+
+/* scans a string starting at the opening quote, the span returned is the raw text between the quotes */
+static void scanString(JSON_READER* reader, const char** content, size_t* contentLength)
+{
+    if (currentChar(reader) != '"')
+    {
+        setError(reader, JSON_READER_PARSE_ERROR);
+    }
+    else
+    {
+        size_t start = ++reader->position;
+        while ((!isAtEnd(reader)) &&
+            (reader->json[reader->position] != '"'))
+        {
+            if (reader->json[reader->position] != '\\')
+            {
+                reader->position++;
+            }
+            else
+            {
+                /* Codes_SRS_JSON_READER_01_012: [ Strings shall accept the escape sequences \", \\, \/, \b, \f, \n, \r and \t, any other escape sequence is a JSON_READER_PARSE_ERROR. ]*/
+                /* \uXXXX is refused, like JSONDecoder_JSON_To_MultiTree refuses it */
+                char escaped = (reader->position + 1 < reader->length) ? reader->json[reader->position + 1] : '\0';
+                if ((escaped == '"') || (escaped == '\\') || (escaped == '/') ||
+                    (escaped == 'b') || (escaped == 'f') || (escaped == 'n') || (escaped == 'r') || (escaped == 't'))
+                {
+                    reader->position += 2;
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+
+        if (currentChar(reader) != '"')
+        {
+            setError(reader, JSON_READER_PARSE_ERROR);
+        }
+        else
+        {
+            *content = reader->json + start;
+            *contentLength = reader->position - start;
+            reader->position++;
+        }
+    }
+}
+
+static size_t scanDigits(JSON_READER* reader)
+{
+    size_t start = reader->position;
+    while (IS_DIGIT(currentChar(reader)))
+    {
+        reader->position++;
+    }
+    return reader->position - start;
+}
+
+/* the same grammar as the JSON decoder: no leading zeros, optional fraction and exponent */
+static void scanNumber(JSON_READER* reader, bool* isInteger)
+{
+    size_t digitCount;
+    size_t firstDigit;
+
+    *isInteger = true;
+    if (currentChar(reader) == '-')
+    {
+        reader->position++;
+    }
+
+    firstDigit = reader->position;
+    digitCount = scanDigits(reader);
+    if ((digitCount == 0) ||
+        ((digitCount > 1) && (reader->json[firstDigit] == '0')))
+    {
+        setError(reader, JSON_READER_PARSE_ERROR);
+    }
+    else
+    {
+        if (currentChar(reader) == '.')
+        {
+            reader->position++;
+            *isInteger = false;
+            if (scanDigits(reader) == 0)
+            {
+                setError(reader, JSON_READER_PARSE_ERROR);
+            }
+        }
+
+        if ((reader->result == JSON_READER_OK) &&
+            ((currentChar(reader) == 'e') || (currentChar(reader) == 'E')))
+        {
+            reader->position++;
+            *isInteger = false;
+            if ((currentChar(reader) == '-') || (currentChar(reader) == '+'))
+            {
+                reader->position++;
+            }
+            if (scanDigits(reader) == 0)
+            {
+                setError(reader, JSON_READER_PARSE_ERROR);
+            }
+        }
+    }
+}
+
+static bool scanLiteral(JSON_READER* reader, const char* literal, size_t literalLength)
+{
+    bool result;
+    if ((reader->length - reader->position >= literalLength) &&
+        (memcmp(reader->json + reader->position, literal, literalLength) == 0))
+    {
+        reader->position += literalLength;
+        result = true;
+    }
+    else
+    {
+        result = false;
+    }
+    return result;
+}
+
+/* reads a string, number, true, false or null; objects and arrays are a JSON_READER_TYPE_MISMATCH */
+static bool readScalar(JSON_READER* reader, JSON_TOKEN* token)
+{
+    size_t start;
+    char c;
+
+    skipWhiteSpace(reader);
+    start = reader->position;
+    c = currentChar(reader);
+    token->isInteger = false;
+
+    if (c == '"')
+    {
+        const char* content;
+        size_t contentLength;
+        token->type = JSON_TOKEN_STRING;
+        scanString(reader, &content, &contentLength);
+    }
+    else if ((c == '-') || IS_DIGIT(c))
+    {
+        token->type = JSON_TOKEN_NUMBER;
+        scanNumber(reader, &token->isInteger);
+    }
+    else if (scanLiteral(reader, "true", 4) ||
+        scanLiteral(reader, "false", 5) ||
+        scanLiteral(reader, "null", 4))
+    {
+        token->type = JSON_TOKEN_LITERAL;
+    }
+    else if ((c == '{') || (c == '['))
+    {
+        setError(reader, JSON_READER_TYPE_MISMATCH);
+    }
+    else
+    {
+        setError(reader, JSON_READER_PARSE_ERROR);
+    }
+
+    token->text = reader->json + start;
+    token->length = reader->position - start;
+    return reader->result == JSON_READER_OK;
+}
+
+static void skipArray(JSON_READER* reader)
+{
+    /* the opening bracket has been checked by the caller */
+    reader->position++;
+    skipWhiteSpace(reader);
+    if (currentChar(reader) == ']')
+    {
+        reader->position++;
+    }
+    else
+    {
+        while (reader->result == JSON_READER_OK)
+        {
+            JSONReader_SkipValue(reader);
+            skipWhiteSpace(reader);
+            if (currentChar(reader) == ',')
+            {
+                reader->position++;
+            }
+            else if (currentChar(reader) == ']')
+            {
+                reader->position++;
+                break;
+            }
+            else if (reader->result == JSON_READER_OK)
+            {
+                setError(reader, JSON_READER_PARSE_ERROR);
+            }
+        }
+    }
+}
+
+void JSONReader_Init(JSON_READER* reader, const char* json, size_t length)
+{
+    if (reader == NULL)
+    {
+        LogError("NULL reader");
+    }
+    else
+    {
+        /* Codes_SRS_JSON_READER_01_001: [ JSONReader_Init shall set the reader to read length bytes at json, from position 0 and with result JSON_READER_OK. ]*/
+        reader->json = json;
+        reader->length = length;
+        reader->position = 0;
+        reader->isFirstMember = false;
+        if (json == NULL)
+        {
+            /* Codes_SRS_JSON_READER_01_002: [ If json is NULL, the result of the reader shall be JSON_READER_INVALID_ARG. ]*/
+            reader->length = 0;
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            reader->result = JSON_READER_OK;
+        }
+    }
+}
+
+void JSONReader_SetError(JSON_READER* reader, JSON_READER_RESULT result)
+{
+    /* Codes_SRS_JSON_READER_01_004: [ JSONReader_SetError shall set the result of the reader, unless the reader already has an error. ]*/
+    if (canRead(reader) &&
+        (result != JSON_READER_OK))
+    {
+        setError(reader, result);
+    }
+}
+
+bool JSONReader_BeginObject(JSON_READER* reader)
+{
+    bool result;
+    /* Codes_SRS_JSON_READER_01_003: [ If reader is NULL or its result is not JSON_READER_OK, the JSONReader_ functions shall do nothing and JSONReader_BeginObject and JSONReader_NextMember shall return false. ]*/
+    if (!canRead(reader))
+    {
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_JSON_READER_01_005: [ JSONReader_BeginObject shall skip white space and consume the '{' that opens an object. ]*/
+        skipWhiteSpace(reader);
+        if (currentChar(reader) != '{')
+        {
+            /* Codes_SRS_JSON_READER_01_006: [ If the next value is not an object, JSONReader_BeginObject shall set JSON_READER_TYPE_MISMATCH and return false. ]*/
+            setError(reader, JSON_READER_TYPE_MISMATCH);
+            result = false;
+        }
+        else
+        {
+            reader->position++;
+            reader->isFirstMember = true;
+            result = true;
+        }
+    }
+    return result;
+}
+
+bool JSONReader_NextMember(JSON_READER* reader, const char** name, size_t* nameLength)
+{
+    bool result;
+    if (!canRead(reader))
+    {
+        result = false;
+    }
+    else if ((name == NULL) || (nameLength == NULL))
+    {
+        setError(reader, JSON_READER_INVALID_ARG);
+        result = false;
+    }
+    else
+    {
+        skipWhiteSpace(reader);
+        if (currentChar(reader) == '}')
+        {
+            /* Codes_SRS_JSON_READER_01_007: [ When the next character is the '}' that closes the object, JSONReader_NextMember shall consume it and return false. ]*/
+            reader->position++;
+            reader->isFirstMember = false;
+            result = false;
+        }
+        else if ((!reader->isFirstMember) &&
+            (currentChar(reader) != ','))
+        {
+            /* Codes_SRS_JSON_READER_01_009: [ If the object is malformed, JSONReader_NextMember shall set JSON_READER_PARSE_ERROR and return false. ]*/
+            setError(reader, JSON_READER_PARSE_ERROR);
+            result = false;
+        }
+        else
+        {
+            /* Codes_SRS_JSON_READER_01_008: [ Otherwise JSONReader_NextMember shall consume the ',' separating the members, the member name and the ':', set name and nameLength to the characters between the quotes of the name as they are in the JSON and return true. ]*/
+            if (!reader->isFirstMember)
+            {
+                reader->position++;
+                skipWhiteSpace(reader);
+            }
+            reader->isFirstMember = false;
+
+            scanString(reader, name, nameLength);
+            skipWhiteSpace(reader);
+            if (reader->result != JSON_READER_OK)
+            {
+                result = false;
+            }
+            else if (currentChar(reader) != ':')
+            {
+                setError(reader, JSON_READER_PARSE_ERROR);
+                result = false;
+            }
+            else
+            {
+                reader->position++;
+                result = true;
+            }
+        }
+    }
+    return result;
+}
+
+void JSONReader_SkipValue(JSON_READER* reader)
+{
+    if (canRead(reader))
+    {
+        /* Codes_SRS_JSON_READER_01_010: [ JSONReader_SkipValue shall consume the next value, of any type. ]*/
+        skipWhiteSpace(reader);
+        if (currentChar(reader) == '{')
+        {
+            const char* name;
+            size_t nameLength;
+            (void)JSONReader_BeginObject(reader);
+            while (JSONReader_NextMember(reader, &name, &nameLength))
+            {
+                JSONReader_SkipValue(reader);
+            }
+        }
+        else if (currentChar(reader) == '[')
+        {
+            skipArray(reader);
+        }
+        else
+        {
+            JSON_TOKEN token;
+            (void)readScalar(reader, &token);
+        }
+    }
+}
+
+void JSONReader_End(JSON_READER* reader)
+{
+    if (canRead(reader))
+    {
+        /* Codes_SRS_JSON_READER_01_011: [ JSONReader_End shall set JSON_READER_PARSE_ERROR if anything but white space follows the last value. ]*/
+        skipWhiteSpace(reader);
+        if (!isAtEnd(reader))
+        {
+            setError(reader, JSON_READER_PARSE_ERROR);
+        }
+    }
+}
+
+void JSONReader_ReadString(JSON_READER* reader, const char** value, size_t* valueLength)
+{
+    if (canRead(reader))
+    {
+        JSON_TOKEN token;
+        if ((value == NULL) || (valueLength == NULL))
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else if (readScalar(reader, &token))
+        {
+            if (token.type != JSON_TOKEN_STRING)
+            {
+                /* Codes_SRS_JSON_READER_01_014: [ If the next value is not of the type a JSONReader_Read function reads, it shall set JSON_READER_TYPE_MISMATCH. ]*/
+                setError(reader, JSON_READER_TYPE_MISMATCH);
+            }
+            else
+            {
+                /* Codes_SRS_JSON_READER_01_013: [ JSONReader_ReadString shall set value and valueLength to the characters between the quotes of the next string, as they are in the JSON. ]*/
+                *value = token.text + 1;
+                *valueLength = token.length - 2;
+            }
+        }
+    }
+}
+
+void JSONReader_ReadInt64(JSON_READER* reader, int64_t minimum, int64_t maximum, int64_t* value)
+{
+    if (canRead(reader))
+    {
+        JSON_TOKEN token;
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else if (readScalar(reader, &token))
+        {
+            if ((token.type != JSON_TOKEN_NUMBER) ||
+                (!token.isInteger))
+            {
+                setError(reader, JSON_READER_TYPE_MISMATCH);
+            }
+            else
+            {
+                /* Codes_SRS_JSON_READER_01_015: [ JSONReader_ReadInt64 shall read a number without fraction and exponent that is between minimum and maximum, otherwise it shall set JSON_READER_TYPE_MISMATCH. ]*/
+                bool isNegative = (token.text[0] == '-');
+                /* the magnitude of INT64_MIN, which does not fit an int64_t */
+                uint64_t limit = isNegative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+                uint64_t magnitude = 0;
+                size_t i;
+                for (i = isNegative ? 1 : 0; i < token.length; i++)
+                {
+                    unsigned int digit = (unsigned int)(token.text[i] - '0');
+                    if (magnitude > (limit - digit) / 10)
+                    {
+                        break;
+                    }
+                    magnitude = magnitude * 10 + digit;
+                }
+
+                if (i < token.length)
+                {
+                    setError(reader, JSON_READER_TYPE_MISMATCH);
+                }
+                else
+                {
+                    int64_t number = isNegative ?
+                        ((magnitude == (uint64_t)INT64_MAX + 1) ? INT64_MIN : -(int64_t)magnitude) :
+                        (int64_t)magnitude;
+                    if ((number < minimum) ||
+                        (number > maximum))
+                    {
+                        setError(reader, JSON_READER_TYPE_MISMATCH);
+                    }
+                    else
+                    {
+                        *value = number;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void JSONReader_ReadBool(JSON_READER* reader, bool* value)
+{
+    if (canRead(reader))
+    {
+        JSON_TOKEN token;
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else if (readScalar(reader, &token))
+        {
+            /* Codes_SRS_JSON_READER_01_016: [ JSONReader_ReadBool shall read true or false. ]*/
+            if ((token.type == JSON_TOKEN_LITERAL) && (token.text[0] == 't'))
+            {
+                *value = true;
+            }
+            else if ((token.type == JSON_TOKEN_LITERAL) && (token.text[0] == 'f'))
+            {
+                *value = false;
+            }
+            else
+            {
+                setError(reader, JSON_READER_TYPE_MISMATCH);
+            }
+        }
+    }
+}
+
+static bool isToken(const JSON_TOKEN* token, const char* text)
+{
+    size_t length = strlen(text);
+    return (token->length == length) && (memcmp(token->text, text, length) == 0);
+}
+
+/* returns false when the token is neither a number nor one of the strings AgentDataTypes_ToString writes for NaN and infinity */
+static bool readFloatingPoint(JSON_READER* reader, double* value)
+{
+    bool result;
+    JSON_TOKEN token;
+    if (!readScalar(reader, &token))
+    {
+        result = false;
+    }
+    else if (isToken(&token, NaN_STRING))
+    {
+        *value = NAN;
+        result = true;
+    }
+    else if (isToken(&token, PLUSINF_STRING))
+    {
+        *value = INFINITY;
+        result = true;
+    }
+    else if (isToken(&token, MINUSINF_STRING))
+    {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4056) /* Known warning for INIFNITY */
+#endif
+        *value = -INFINITY;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+        result = true;
+    }
+    else if ((token.type != JSON_TOKEN_NUMBER) ||
+        (token.length >= MAX_NUMBER_TOKEN_LENGTH))
+    {
+        setError(reader, JSON_READER_TYPE_MISMATCH);
+        result = false;
+    }
+    else
+    {
+        /* strtod needs a '\0' after the number, the JSON text is not changed */
+        char number[MAX_NUMBER_TOKEN_LENGTH];
+        (void)memcpy(number, token.text, token.length);
+        number[token.length] = '\0';
+        *value = strtod(number, NULL);
+        result = true;
+    }
+    return result;
+}
+
+void JSONReader_ReadDouble(JSON_READER* reader, double* value)
+{
+    if (canRead(reader))
+    {
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_READER_01_017: [ JSONReader_ReadDouble and JSONReader_ReadFloat shall read a number or one of the strings "NaN", "INF" and "-INF". ]*/
+            double number;
+            if (readFloatingPoint(reader, &number))
+            {
+                *value = number;
+            }
+        }
+    }
+}
+
+void JSONReader_ReadFloat(JSON_READER* reader, float* value)
+{
+    if (canRead(reader))
+    {
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            double number;
+            if (readFloatingPoint(reader, &number))
+            {
+                *value = (float)number;
+            }
+        }
+    }
+}
+
+/* the buffer is reused when the string already there is long enough, as the buffers of a device are only ever freed with free */
+static void copyToCharz(JSON_READER* reader, const char* text, size_t length, char** value)
+{
+    char* destination;
+    if ((*value != NULL) &&
+        (strlen(*value) >= length))
+    {
+        destination = *value;
+    }
+    else if ((destination = (char*)realloc(*value, length + 1)) == NULL)
+    {
+        /* Codes_SRS_JSON_READER_01_020: [ If allocating memory fails, the JSONReader_Read functions shall set JSON_READER_ERROR and leave value unchanged. ]*/
+        setError(reader, JSON_READER_ERROR);
+    }
+    else
+    {
+        *value = destination;
+    }
+
+    if (destination != NULL)
+    {
+        (void)memcpy(destination, text, length);
+        destination[length] = '\0';
+    }
+}
+
+void JSONReader_ReadCharz(JSON_READER* reader, char** value)
+{
+    if (canRead(reader))
+    {
+        const char* text;
+        size_t length;
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_READER_01_018: [ JSONReader_ReadCharz shall copy the characters between the quotes of the next string into *value, '\0' terminated, reusing *value when the string it holds is at least as long and reallocating it otherwise. ]*/
+            JSONReader_ReadString(reader, &text, &length);
+            if (reader->result == JSON_READER_OK)
+            {
+                copyToCharz(reader, text, length, value);
+            }
+        }
+    }
+}
+
+void JSONReader_ReadCharzNoQuotes(JSON_READER* reader, char** value)
+{
+    if (canRead(reader))
+    {
+        JSON_TOKEN token;
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else if (readScalar(reader, &token))
+        {
+            /* Codes_SRS_JSON_READER_01_019: [ JSONReader_ReadCharzNoQuotes shall copy the text of the next string, number, true, false or null, with the quotes of a string, into *value in the same way. ]*/
+            copyToCharz(reader, token.text, token.length, value);
+        }
+    }
+}
+
+/* copies a string token with its quotes and has CreateAgentDataType_From_String parse it, which needs no memory for these types */
+static void readFromString(JSON_READER* reader, AGENT_DATA_TYPE_TYPE type, AGENT_DATA_TYPE* agentData)
+{
+    JSON_TOKEN token;
+    if (readScalar(reader, &token))
+    {
+        char text[MAX_STRING_TOKEN_LENGTH];
+        if ((token.type != JSON_TOKEN_STRING) ||
+            (token.length >= MAX_STRING_TOKEN_LENGTH))
+        {
+            setError(reader, JSON_READER_TYPE_MISMATCH);
+        }
+        else
+        {
+            (void)memcpy(text, token.text, token.length);
+            text[token.length] = '\0';
+            if (CreateAgentDataType_From_String(text, type, agentData) != AGENT_DATA_TYPES_OK)
+            {
+                setError(reader, JSON_READER_TYPE_MISMATCH);
+            }
+        }
+    }
+}
+
+void JSONReader_ReadDateTimeOffset(JSON_READER* reader, EDM_DATE_TIME_OFFSET* value)
+{
+    if (canRead(reader))
+    {
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_READER_01_021: [ JSONReader_ReadDateTimeOffset and JSONReader_ReadGuid shall accept the strings CreateAgentDataType_From_String accepts for EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE. ]*/
+            AGENT_DATA_TYPE agentData;
+            readFromString(reader, EDM_DATE_TIME_OFFSET_TYPE, &agentData);
+            if (reader->result == JSON_READER_OK)
+            {
+                *value = agentData.value.edmDateTimeOffset;
+            }
+        }
+    }
+}
+
+void JSONReader_ReadGuid(JSON_READER* reader, EDM_GUID* value)
+{
+    if (canRead(reader))
+    {
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            AGENT_DATA_TYPE agentData;
+            readFromString(reader, EDM_GUID_TYPE, &agentData);
+            if (reader->result == JSON_READER_OK)
+            {
+                *value = agentData.value.edmGuid;
+            }
+        }
+    }
+}
+
+/* the alphabet of AgentDataTypes_ToString, returns -1 for any other character */
+static int base64Value(char c)
+{
+    int result;
+    if ((c >= 'A') && (c <= 'Z'))
+    {
+        result = c - 'A';
+    }
+    else if ((c >= 'a') && (c <= 'z'))
+    {
+        result = 26 + (c - 'a');
+    }
+    else if ((c >= '0') && (c <= '9'))
+    {
+        result = 52 + (c - '0');
+    }
+    else if (c == '-')
+    {
+        result = 62;
+    }
+    else if (c == '_')
+    {
+        result = 63;
+    }
+    else
+    {
+        result = -1;
+    }
+    return result;
+}
+
+/* decodes the way CreateAgentDataType_From_String does: groups of 4 characters, then one optional
+   group of 2 characters and a last one of 'AEIMQUYcgkosw048' with an optional '=', or of 1 character
+   and a last one of 'AQgw' with an optional "==". With a NULL destination the bytes are only counted.
+   Returns false if the text is not all consumed. */
+static bool decodeBase64(const char* source, size_t sourceLength, unsigned char* destination, size_t* size)
+{
+    size_t sourcePosition = 0;
+    size_t destinationPosition = 0;
+    int b0, b1, b2, b3;
+
+    while ((sourceLength - sourcePosition >= 4) &&
+        ((b0 = base64Value(source[sourcePosition])) >= 0) &&
+        ((b1 = base64Value(source[sourcePosition + 1])) >= 0) &&
+        ((b2 = base64Value(source[sourcePosition + 2])) >= 0) &&
+        ((b3 = base64Value(source[sourcePosition + 3])) >= 0))
+    {
+        if (destination != NULL)
+        {
+            destination[destinationPosition] = (unsigned char)((b0 << 2) | ((b1 & 0x30) >> 4));
+            destination[destinationPosition + 1] = (unsigned char)(((b1 & 0x0F) << 4) | ((b2 & 0x3C) >> 2));
+            destination[destinationPosition + 2] = (unsigned char)(((b2 & 0x03) << 6) | b3);
+        }
+        sourcePosition += 4;
+        destinationPosition += 3;
+    }
+
+    if ((sourceLength - sourcePosition >= 3) &&
+        ((b0 = base64Value(source[sourcePosition])) >= 0) &&
+        ((b1 = base64Value(source[sourcePosition + 1])) >= 0) &&
+        ((b2 = base64Value(source[sourcePosition + 2])) >= 0) &&
+        ((b2 & 0x03) == 0))
+    {
+        if (destination != NULL)
+        {
+            destination[destinationPosition] = (unsigned char)((b0 << 2) | ((b1 & 0x30) >> 4));
+            destination[destinationPosition + 1] = (unsigned char)(((b1 & 0x0F) << 4) | (b2 >> 2));
+        }
+        sourcePosition += 3;
+        if ((sourcePosition < sourceLength) && (source[sourcePosition] == '='))
+        {
+            sourcePosition++;
+        }
+        destinationPosition += 2;
+    }
+    else if ((sourceLength - sourcePosition >= 2) &&
+        ((b0 = base64Value(source[sourcePosition])) >= 0) &&
+        ((b1 = base64Value(source[sourcePosition + 1])) >= 0) &&
+        ((b1 & 0x0F) == 0))
+    {
+        if (destination != NULL)
+        {
+            destination[destinationPosition] = (unsigned char)((b0 << 2) | (b1 >> 4));
+        }
+        sourcePosition += 2;
+        if ((sourceLength - sourcePosition >= 2) && (source[sourcePosition] == '=') && (source[sourcePosition + 1] == '='))
+        {
+            sourcePosition += 2;
+        }
+        destinationPosition += 1;
+    }
+
+    *size = destinationPosition;
+    return sourcePosition == sourceLength;
+}
+
+void JSONReader_ReadBinary(JSON_READER* reader, EDM_BINARY* value)
+{
+    if (canRead(reader))
+    {
+        const char* text;
+        size_t length;
+        size_t size;
+        if (value == NULL)
+        {
+            setError(reader, JSON_READER_INVALID_ARG);
+        }
+        else
+        {
+            JSONReader_ReadString(reader, &text, &length);
+            if (reader->result != JSON_READER_OK)
+            {
+                /* nothing to decode */
+            }
+            else if (!decodeBase64(text, length, NULL, &size))
+            {
+                setError(reader, JSON_READER_TYPE_MISMATCH);
+            }
+            else
+            {
+                /* Codes_SRS_JSON_READER_01_022: [ JSONReader_ReadBinary shall decode the next string as base64url the way CreateAgentDataType_From_String does, reusing value->data when value->size is at least the decoded size and reallocating it otherwise. ]*/
+                unsigned char* data;
+                if (size <= value->size)
+                {
+                    data = value->data;
+                }
+                else if ((data = (unsigned char*)realloc(value->data, size)) == NULL)
+                {
+                    setError(reader, JSON_READER_ERROR);
+                }
+                else
+                {
+                    value->data = data;
+                }
+
+                if (data != NULL)
+                {
+                    (void)decodeBase64(text, length, data, &size);
+                    value->size = size;
+                }
+                else if (size == 0)
+                {
+                    value->size = 0;
+                }
+            }
+        }
+    }
+}
+
+static int compareMembers(const void* left, const void* right)
+{
+    const JSON_READER_MEMBER* leftMember = (const JSON_READER_MEMBER*)left;
+    const JSON_READER_MEMBER* rightMember = (const JSON_READER_MEMBER*)right;
+    int result;
+    if (leftMember->nameLength != rightMember->nameLength)
+    {
+        result = (leftMember->nameLength < rightMember->nameLength) ? -1 : 1;
+    }
+    else
+    {
+        result = memcmp(leftMember->name, rightMember->name, leftMember->nameLength);
+    }
+    return result;
+}
+
+void JSONReader_SortMembers(JSON_READER_MEMBER_INDEX* memberIndex)
+{
+    if (memberIndex == NULL)
+    {
+        /* Codes_SRS_JSON_READER_01_026: [ If memberIndex is NULL, JSONReader_SortMembers shall return. ]*/
+        LogError("invalid argument JSON_READER_MEMBER_INDEX* memberIndex=%p", memberIndex);
+    }
+    /* Codes_SRS_JSON_READER_01_023: [ If memberIndex is not sorted yet, JSONReader_SortMembers shall sort its members by name length and then by name and mark it as sorted, otherwise it shall leave memberIndex unchanged. ]*/
+    else if (!memberIndex->isSorted)
+    {
+        qsort(memberIndex->members, memberIndex->count, sizeof(JSON_READER_MEMBER), compareMembers);
+        memberIndex->isSorted = true;
+    }
+}
+
+size_t JSONReader_FindMember(const JSON_READER_MEMBER_INDEX* memberIndex, const char* name, size_t nameLength)
+{
+    size_t result;
+    if ((memberIndex == NULL) ||
+        (name == NULL))
+    {
+        /* Codes_SRS_JSON_READER_01_025: [ If memberIndex or name is NULL, JSONReader_FindMember shall return 0. ]*/
+        LogError("invalid argument const JSON_READER_MEMBER_INDEX* memberIndex=%p, const char* name=%p", memberIndex, name);
+        result = 0;
+    }
+    else
+    {
+        JSON_READER_MEMBER key;
+        key.name = name;
+        key.nameLength = nameLength;
+        key.id = 0;
+        result = 0;
+
+        if (memberIndex->isSorted)
+        {
+            /* Codes_SRS_JSON_READER_01_024: [ If memberIndex is sorted, JSONReader_FindMember shall find the member named name by binary search and return its id, or 0 when there is no such member. ]*/
+            size_t low = 0;
+            size_t high = memberIndex->count;
+            while (low < high)
+            {
+                size_t middle = low + (high - low) / 2;
+                int comparison = compareMembers(&key, &memberIndex->members[middle]);
+                if (comparison == 0)
+                {
+                    result = memberIndex->members[middle].id;
+                    break;
+                }
+                else if (comparison < 0)
+                {
+                    high = middle;
+                }
+                else
+                {
+                    low = middle + 1;
+                }
+            }
+        }
+        else
+        {
+            /* Codes_SRS_JSON_READER_01_027: [ If memberIndex is not sorted, JSONReader_FindMember shall find the member named name by comparing it with every member. ]*/
+            size_t i;
+            for (i = 0; i < memberIndex->count; i++)
+            {
+                if (compareMembers(&key, &memberIndex->members[i]) == 0)
+                {
+                    result = memberIndex->members[i].id;
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
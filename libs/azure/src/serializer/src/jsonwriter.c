@@ -0,0 +1,560 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "jsonwriter.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+#define NaN_STRING "NaN"
+#define MINUSINF_STRING "-INF"
+#define PLUSINF_STRING "INF"
+
+/* sign, all the integer digits of the largest double, the decimal point, DBL_DIG decimals and '\0' */
+#define MAX_FLOATING_POINT_STRING_LENGTH (1 + (DBL_MAX_10_EXP + 1) + 1 + DBL_DIG + 1)
+
+/* the longest of the 4 date time offset formats, with every field printed at its widest */
+#define MAX_DATE_TIME_OFFSET_STRING_LENGTH 128
+
+static const char hexToASCII[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+/* the same alphabet as AgentDataTypes_ToString */
+static const char base64Chars[64] = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '-', '_'
+};
+
+static void writeBytes(JSON_WRITER* writer, const char* bytes, size_t length)
+{
+    /* once a write does not fit all the following ones do not fit either, so the buffer never has holes */
+    if ((writer->buffer != NULL) &&
+        (writer->length + length <= writer->bufferSize))
+    {
+        (void)memcpy(writer->buffer + writer->length, bytes, length);
+    }
+    writer->length += length;
+}
+
+static void setError(JSON_WRITER* writer, JSON_WRITER_RESULT result)
+{
+    writer->result = result;
+    LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+}
+
+void JSONWriter_Init(JSON_WRITER* writer, unsigned char* buffer, size_t bufferSize)
+{
+    if (writer == NULL)
+    {
+        LogError("NULL writer");
+    }
+    else
+    {
+        /* Codes_SRS_JSON_WRITER_01_001: [ JSONWriter_Init shall set the writer to write at most bufferSize bytes at buffer, with length 0 and result JSON_WRITER_OK. ]*/
+        /* Codes_SRS_JSON_WRITER_01_002: [ If buffer is NULL, the writer shall only count the bytes. ]*/
+        writer->buffer = buffer;
+        writer->bufferSize = (buffer == NULL) ? 0 : bufferSize;
+        writer->length = 0;
+        writer->result = JSON_WRITER_OK;
+    }
+}
+
+void JSONWriter_AppendRaw(JSON_WRITER* writer, const char* text, size_t length)
+{
+    /* Codes_SRS_JSON_WRITER_01_003: [ If writer is NULL or its result is not JSON_WRITER_OK, the JSONWriter_Append functions shall do nothing. ]*/
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if (text == NULL)
+        {
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_004: [ JSONWriter_AppendRaw shall copy the length bytes of text at the current length when they fit in the buffer, and add length to the length of the writer in all cases. ]*/
+            writeBytes(writer, text, length);
+        }
+    }
+}
+
+void JSONWriter_AppendMemberName(JSON_WRITER* writer, size_t memberIndex, const char* name, size_t nameLength)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if (name == NULL)
+        {
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_005: [ If memberIndex is not 0, JSONWriter_AppendMemberName shall first append ", ". ]*/
+            if (memberIndex > 0)
+            {
+                writeBytes(writer, ", ", 2);
+            }
+
+            /* Codes_SRS_JSON_WRITER_01_006: [ JSONWriter_AppendMemberName shall append the nameLength characters of name between quotes, followed by ':'. ]*/
+            writeBytes(writer, "\"", 1);
+            writeBytes(writer, name, nameLength);
+            writeBytes(writer, "\":", 2);
+        }
+    }
+}
+
+void JSONWriter_AppendInt64(JSON_WRITER* writer, int64_t value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        /* Codes_SRS_JSON_WRITER_01_007: [ JSONWriter_AppendInt64 shall append value in decimal, preceded by '-' when it is negative. ]*/
+        char digits[21]; /*because 19 digits and sign*/
+        size_t pos = sizeof(digits);
+        uint64_t positiveValue = (value < 0) ? ((uint64_t)0 - (uint64_t)value) : (uint64_t)value;
+
+        do
+        {
+            digits[--pos] = (char)('0' + (positiveValue % 10));
+            positiveValue /= 10;
+        } while (positiveValue > 0);
+
+        if (value < 0)
+        {
+            digits[--pos] = '-';
+        }
+
+        writeBytes(writer, digits + pos, sizeof(digits) - pos);
+    }
+}
+
+void JSONWriter_AppendBool(JSON_WRITER* writer, bool value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        /* Codes_SRS_JSON_WRITER_01_008: [ JSONWriter_AppendBool shall append true or false. ]*/
+        if (value)
+        {
+            writeBytes(writer, "true", sizeof("true") - 1);
+        }
+        else
+        {
+            writeBytes(writer, "false", sizeof("false") - 1);
+        }
+    }
+}
+
+static void appendFloatingPoint(JSON_WRITER* writer, double value, int digits)
+{
+#ifdef NO_FLOATS
+    (void)value;
+    (void)digits;
+    /* Codes_SRS_JSON_WRITER_01_011: [ When the serializer is built with NO_FLOATS, JSONWriter_AppendDouble and JSONWriter_AppendFloat shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+    setError(writer, JSON_WRITER_INVALID_ARG);
+#else
+    /* Codes_SRS_JSON_WRITER_01_009: [ NaN, negative and positive infinity shall be appended as NaN, -INF and INF. ]*/
+    if (ISNAN(value))
+    {
+        writeBytes(writer, NaN_STRING, sizeof(NaN_STRING) - 1);
+    }
+    else if (ISNEGATIVEINFINITY(value))
+    {
+        writeBytes(writer, MINUSINF_STRING, sizeof(MINUSINF_STRING) - 1);
+    }
+    else if (ISPOSITIVEINFINITY(value))
+    {
+        writeBytes(writer, PLUSINF_STRING, sizeof(PLUSINF_STRING) - 1);
+    }
+    else
+    {
+        /* Codes_SRS_JSON_WRITER_01_010: [ Other values shall be appended as printed by "%.*f" with DBL_DIG decimals for JSONWriter_AppendDouble and FLT_DIG decimals for JSONWriter_AppendFloat. ]*/
+        char temp[MAX_FLOATING_POINT_STRING_LENGTH];
+        int printed = sprintf_s(temp, sizeof(temp), "%.*f", digits, value);
+        if (printed < 0)
+        {
+            setError(writer, JSON_WRITER_ERROR);
+        }
+        else
+        {
+            writeBytes(writer, temp, (size_t)printed);
+        }
+    }
+#endif
+}
+
+void JSONWriter_AppendDouble(JSON_WRITER* writer, double value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        appendFloatingPoint(writer, value, DBL_DIG);
+    }
+}
+
+void JSONWriter_AppendFloat(JSON_WRITER* writer, float value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        appendFloatingPoint(writer, (double)value, FLT_DIG);
+    }
+}
+
+void JSONWriter_AppendString(JSON_WRITER* writer, const char* value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if (value == NULL)
+        {
+            /* Codes_SRS_JSON_WRITER_01_012: [ If value is NULL, JSONWriter_AppendString shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_014: [ JSONWriter_AppendString shall append value between quotes, with the characters up to 0x1F written as \u00XX and '"', '\' and '/' preceded by '\'. ]*/
+            const char* runStart = value;
+            const char* current = value;
+
+            writeBytes(writer, "\"", 1);
+            while (*current != '\0')
+            {
+                unsigned char c = (unsigned char)*current;
+                if ((c >= 0x20) && (c < 128) && (c != '"') && (c != '\\') && (c != '/'))
+                {
+                    current++;
+                }
+                else if (c >= 128)
+                {
+                    /* Codes_SRS_JSON_WRITER_01_013: [ If value has a character above 127, JSONWriter_AppendString shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+                    setError(writer, JSON_WRITER_INVALID_ARG);
+                    break;
+                }
+                else
+                {
+                    /* plain characters are copied in runs, only the ones to escape are written one by one */
+                    writeBytes(writer, runStart, (size_t)(current - runStart));
+                    if (c <= 0x1F)
+                    {
+                        char escaped[6] = { '\\', 'u', '0', '0', 0, 0 };
+                        escaped[4] = hexToASCII[(c & 0xF0) >> 4];
+                        escaped[5] = hexToASCII[c & 0x0F];
+                        writeBytes(writer, escaped, sizeof(escaped));
+                    }
+                    else
+                    {
+                        char escaped[2] = { '\\', 0 };
+                        escaped[1] = (char)c;
+                        writeBytes(writer, escaped, sizeof(escaped));
+                    }
+                    current++;
+                    runStart = current;
+                }
+            }
+
+            if (writer->result == JSON_WRITER_OK)
+            {
+                writeBytes(writer, runStart, (size_t)(current - runStart));
+                writeBytes(writer, "\"", 1);
+            }
+        }
+    }
+}
+
+void JSONWriter_AppendStringNoQuotes(JSON_WRITER* writer, const char* value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if (value == NULL)
+        {
+            /* Codes_SRS_JSON_WRITER_01_015: [ If value is NULL, JSONWriter_AppendStringNoQuotes shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_016: [ JSONWriter_AppendStringNoQuotes shall append value as it is. ]*/
+            writeBytes(writer, value, strlen(value));
+        }
+    }
+}
+
+void JSONWriter_AppendDateTimeOffset(JSON_WRITER* writer, const EDM_DATE_TIME_OFFSET* value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if (value == NULL)
+        {
+            /* Codes_SRS_JSON_WRITER_01_017: [ If value is NULL, JSONWriter_AppendDateTimeOffset shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_018: [ JSONWriter_AppendDateTimeOffset shall append value between quotes as YYYY-MM-DDThh:mm:ss, followed by .ffffffffffff when it has fractional seconds, and by +hh:mm when it has a time zone or by Z otherwise. ]*/
+            char temp[MAX_DATE_TIME_OFFSET_STRING_LENGTH];
+            int printed;
+            if (value->hasTimeZone)
+            {
+                if (value->hasFractionalSecond)
+                {
+                    printed = sprintf_s(temp, sizeof(temp), "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12llu%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
+                        value->dateTime.tm_year + 1900,
+                        value->dateTime.tm_mon + 1,
+                        value->dateTime.tm_mday,
+                        value->dateTime.tm_hour,
+                        value->dateTime.tm_min,
+                        value->dateTime.tm_sec,
+                        (unsigned long long)value->fractionalSecond,
+                        value->timeZoneHour,
+                        value->timeZoneMinute);
+                }
+                else
+                {
+                    printed = sprintf_s(temp, sizeof(temp), "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
+                        value->dateTime.tm_year + 1900,
+                        value->dateTime.tm_mon + 1,
+                        value->dateTime.tm_mday,
+                        value->dateTime.tm_hour,
+                        value->dateTime.tm_min,
+                        value->dateTime.tm_sec,
+                        value->timeZoneHour,
+                        value->timeZoneMinute);
+                }
+            }
+            else
+            {
+                if (value->hasFractionalSecond)
+                {
+                    printed = sprintf_s(temp, sizeof(temp), "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12lluZ\"",
+                        value->dateTime.tm_year + 1900,
+                        value->dateTime.tm_mon + 1,
+                        value->dateTime.tm_mday,
+                        value->dateTime.tm_hour,
+                        value->dateTime.tm_min,
+                        value->dateTime.tm_sec,
+                        (unsigned long long)value->fractionalSecond);
+                }
+                else
+                {
+                    printed = sprintf_s(temp, sizeof(temp), "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2dZ\"",
+                        value->dateTime.tm_year + 1900,
+                        value->dateTime.tm_mon + 1,
+                        value->dateTime.tm_mday,
+                        value->dateTime.tm_hour,
+                        value->dateTime.tm_min,
+                        value->dateTime.tm_sec);
+                }
+            }
+
+            if (printed < 0)
+            {
+                setError(writer, JSON_WRITER_ERROR);
+            }
+            else
+            {
+                writeBytes(writer, temp, (size_t)printed);
+            }
+        }
+    }
+}
+
+void JSONWriter_AppendGuid(JSON_WRITER* writer, const EDM_GUID* value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if (value == NULL)
+        {
+            /* Codes_SRS_JSON_WRITER_01_019: [ If value is NULL, JSONWriter_AppendGuid shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_020: [ JSONWriter_AppendGuid shall append value between quotes as 8HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 12HEXDIG, with upper case hex digits. ]*/
+            char temp[1 + 8 + 1 + 4 + 1 + 4 + 1 + 4 + 1 + 12 + 1];
+            size_t pos = 0;
+            size_t i;
+            temp[pos++] = '"';
+            for (i = 0; i < 16; i++)
+            {
+                if ((i == 4) || (i == 6) || (i == 8) || (i == 10))
+                {
+                    temp[pos++] = '-';
+                }
+                temp[pos++] = hexToASCII[value->GUID[i] >> 4];
+                temp[pos++] = hexToASCII[value->GUID[i] & 0x0F];
+            }
+            temp[pos++] = '"';
+            writeBytes(writer, temp, pos);
+        }
+    }
+}
+
+void JSONWriter_AppendBinary(JSON_WRITER* writer, const EDM_BINARY* value)
+{
+    if ((writer != NULL) &&
+        (writer->result == JSON_WRITER_OK))
+    {
+        if ((value == NULL) ||
+            ((value->data == NULL) && (value->size > 0)))
+        {
+            /* Codes_SRS_JSON_WRITER_01_021: [ If value is NULL, or its data is NULL while its size is not 0, JSONWriter_AppendBinary shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+            setError(writer, JSON_WRITER_INVALID_ARG);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_022: [ JSONWriter_AppendBinary shall append the base64 encoding of value between quotes, with '-' and '_' as the 62nd and 63rd characters and '=' padding. ]*/
+            const unsigned char* data = value->data;
+            size_t currentPosition = 0;
+            char group[4];
+
+            writeBytes(writer, "\"", 1);
+            while (value->size - currentPosition >= 3)
+            {
+                group[0] = base64Chars[data[currentPosition] >> 2];
+                group[1] = base64Chars[((data[currentPosition] & 0x03) << 4) | (data[currentPosition + 1] >> 4)];
+                group[2] = base64Chars[((data[currentPosition + 1] & 0x0F) << 2) | (data[currentPosition + 2] >> 6)];
+                group[3] = base64Chars[data[currentPosition + 2] & 0x3F];
+                writeBytes(writer, group, sizeof(group));
+                currentPosition += 3;
+            }
+
+            if (value->size - currentPosition == 2)
+            {
+                group[0] = base64Chars[data[currentPosition] >> 2];
+                group[1] = base64Chars[((data[currentPosition] & 0x03) << 4) | (data[currentPosition + 1] >> 4)];
+                group[2] = base64Chars[(data[currentPosition + 1] & 0x0F) << 2];
+                group[3] = '=';
+                writeBytes(writer, group, sizeof(group));
+            }
+            else if (value->size - currentPosition == 1)
+            {
+                group[0] = base64Chars[data[currentPosition] >> 2];
+                group[1] = base64Chars[(data[currentPosition] & 0x03) << 4];
+                group[2] = '=';
+                group[3] = '=';
+                writeBytes(writer, group, sizeof(group));
+            }
+            writeBytes(writer, "\"", 1);
+        }
+    }
+}
+
+JSON_WRITER_RESULT JSONWriter_Encode(unsigned char** destination, size_t* destinationSize, JSON_WRITER_VALUE_FUNC valueFunc, const void* value)
+{
+    JSON_WRITER_RESULT result;
+
+    /* Codes_SRS_JSON_WRITER_01_023: [ If destination, destinationSize, valueFunc or value is NULL, JSONWriter_Encode shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+    if ((destination == NULL) ||
+        (destinationSize == NULL) ||
+        (valueFunc == NULL) ||
+        (value == NULL))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+        JSON_WRITER writer;
+
+        /* Codes_SRS_JSON_WRITER_01_024: [ JSONWriter_Encode shall call valueFunc with a writer that has no buffer to measure the JSON. ]*/
+        JSONWriter_Init(&writer, NULL, 0);
+        valueFunc(&writer, value);
+        if (writer.result != JSON_WRITER_OK)
+        {
+            /* Codes_SRS_JSON_WRITER_01_025: [ If the measuring fails, JSONWriter_Encode shall fail and return the result of the writer. ]*/
+            result = writer.result;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_026: [ JSONWriter_Encode shall allocate exactly as many bytes as measured. ]*/
+            size_t measuredLength = writer.length;
+            unsigned char* temp = (unsigned char*)malloc((measuredLength == 0) ? 1 : measuredLength);
+            if (temp == NULL)
+            {
+                /* Codes_SRS_JSON_WRITER_01_027: [ If the allocation fails, JSONWriter_Encode shall fail and return JSON_WRITER_ERROR. ]*/
+                result = JSON_WRITER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+            }
+            else
+            {
+                /* Codes_SRS_JSON_WRITER_01_028: [ JSONWriter_Encode shall call valueFunc again with a writer on the allocated buffer. ]*/
+                JSONWriter_Init(&writer, temp, measuredLength);
+                valueFunc(&writer, value);
+                if ((writer.result != JSON_WRITER_OK) ||
+                    (writer.length != measuredLength))
+                {
+                    /* Codes_SRS_JSON_WRITER_01_029: [ If the second pass fails or does not write the measured length, JSONWriter_Encode shall free the buffer and return JSON_WRITER_ERROR. ]*/
+                    free(temp);
+                    result = JSON_WRITER_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+                }
+                else
+                {
+                    /* Codes_SRS_JSON_WRITER_01_030: [ On success JSONWriter_Encode shall set *destination to the buffer, which is not '\0' terminated, and *destinationSize to its length, and return JSON_WRITER_OK. ]*/
+                    *destination = temp;
+                    *destinationSize = measuredLength;
+                    result = JSON_WRITER_OK;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_EncodeToBuffer(unsigned char* buffer, size_t bufferSize, size_t* length, JSON_WRITER_VALUE_FUNC valueFunc, const void* value)
+{
+    JSON_WRITER_RESULT result;
+
+    /* Codes_SRS_JSON_WRITER_01_031: [ If length, valueFunc or value is NULL, or buffer is NULL while bufferSize is not 0, JSONWriter_EncodeToBuffer shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+    if ((length == NULL) ||
+        (valueFunc == NULL) ||
+        (value == NULL) ||
+        ((buffer == NULL) && (bufferSize > 0)))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+        JSON_WRITER writer;
+
+        /* Codes_SRS_JSON_WRITER_01_032: [ JSONWriter_EncodeToBuffer shall call valueFunc once with a writer on buffer. ]*/
+        JSONWriter_Init(&writer, buffer, bufferSize);
+        valueFunc(&writer, value);
+        if (writer.result != JSON_WRITER_OK)
+        {
+            /* Codes_SRS_JSON_WRITER_01_033: [ If writing fails, JSONWriter_EncodeToBuffer shall fail and return the result of the writer. ]*/
+            result = writer.result;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+        else
+        {
+            /* Codes_SRS_JSON_WRITER_01_034: [ JSONWriter_EncodeToBuffer shall set *length to the length of the JSON, which is not '\0' terminated. ]*/
+            *length = writer.length;
+            if (writer.length > bufferSize)
+            {
+                /* Codes_SRS_JSON_WRITER_01_035: [ If the JSON does not fit in bufferSize bytes, JSONWriter_EncodeToBuffer shall return JSON_WRITER_BUFFER_TOO_SMALL. ]*/
+                result = JSON_WRITER_BUFFER_TOO_SMALL;
+            }
+            else
+            {
+                /* Codes_SRS_JSON_WRITER_01_036: [ Otherwise JSONWriter_EncodeToBuffer shall return JSON_WRITER_OK. ]*/
+                result = JSON_WRITER_OK;
+            }
+        }
+    }
+
+    return result;
+}
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "schema.h"
@@ -12,6 +13,24 @@
 
 DEFINE_ENUM_STRINGS(SCHEMA_RESULT, SCHEMA_RESULT_VALUES);
 
+/*a name index is a table of the names of one collection of a schema (models, properties, actions...), sorted by length and then by content.
+It is built when the schema is frozen (see Schema_AddDeviceRef) and dropped whenever the collection grows. Until then (or if building it fails) lookups scan the collection*/
+typedef struct SCHEMA_NAME_INDEX_ENTRY_TAG
+{
+    const char* name;
+    size_t nameLength;
+    void* element; /*what the ByName function of the collection returns*/
+} SCHEMA_NAME_INDEX_ENTRY;
+
+typedef struct SCHEMA_NAME_INDEX_TAG
+{
+    SCHEMA_NAME_INDEX_ENTRY* entries; /*NULL when the index is not built*/
+    size_t count;
+} SCHEMA_NAME_INDEX;
+
+/*returns the element at position "index" of the collection and its name*/
+typedef void*(*SCHEMA_NAME_INDEX_GET_ELEMENT)(const void* collection, size_t index, const char** name);
+
 typedef struct SCHEMA_PROPERTY_HANDLE_DATA_TAG
 {
     const char* PropertyName;
@@ -81,6 +100,12 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    SCHEMA_NAME_INDEX propertyIndex;
+    SCHEMA_NAME_INDEX reportedPropertyIndex;
+    SCHEMA_NAME_INDEX desiredPropertyIndex;
+    SCHEMA_NAME_INDEX actionIndex;
+    SCHEMA_NAME_INDEX methodIndex;
+    SCHEMA_NAME_INDEX modelIndex;
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -88,6 +113,7 @@ typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
     const char* Name;
     SCHEMA_PROPERTY_HANDLE* Properties;
     size_t PropertyCount;
+    SCHEMA_NAME_INDEX propertyIndex;
 } SCHEMA_STRUCT_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_HANDLE_DATA_TAG
@@ -98,10 +124,213 @@ typedef struct SCHEMA_HANDLE_DATA_TAG
     size_t ModelTypeCount;
     SCHEMA_STRUCT_TYPE_HANDLE* StructTypes;
     size_t StructTypeCount;
+    SCHEMA_NAME_INDEX modelTypeIndex;
+    SCHEMA_NAME_INDEX structTypeIndex;
 } SCHEMA_HANDLE_DATA;
 
 static VECTOR_HANDLE g_schemas = NULL;
 
+static void InitNameIndex(SCHEMA_NAME_INDEX* nameIndex)
+{
+    nameIndex->entries = NULL;
+    nameIndex->count = 0;
+}
+
+static void DestroyNameIndex(SCHEMA_NAME_INDEX* nameIndex)
+{
+    if (nameIndex->entries != NULL)
+    {
+        free(nameIndex->entries);
+        nameIndex->entries = NULL;
+        nameIndex->count = 0;
+    }
+}
+
+static int CompareNames(const char* name, size_t nameLength, const char* otherName, size_t otherNameLength)
+{
+    int result;
+    if (nameLength != otherNameLength)
+    {
+        result = (nameLength < otherNameLength) ? -1 : 1;
+    }
+    else
+    {
+        result = memcmp(name, otherName, nameLength);
+    }
+    return result;
+}
+
+static int CompareNameIndexEntries(const void* left, const void* right)
+{
+    const SCHEMA_NAME_INDEX_ENTRY* leftEntry = (const SCHEMA_NAME_INDEX_ENTRY*)left;
+    const SCHEMA_NAME_INDEX_ENTRY* rightEntry = (const SCHEMA_NAME_INDEX_ENTRY*)right;
+    return CompareNames(leftEntry->name, leftEntry->nameLength, rightEntry->name, rightEntry->nameLength);
+}
+
+static void BuildNameIndex(SCHEMA_NAME_INDEX* nameIndex, const void* collection, size_t count, SCHEMA_NAME_INDEX_GET_ELEMENT getElement)
+{
+    if ((nameIndex->entries == NULL) && (count > 0))
+    {
+        SCHEMA_NAME_INDEX_ENTRY* entries = (SCHEMA_NAME_INDEX_ENTRY*)malloc(sizeof(SCHEMA_NAME_INDEX_ENTRY) * count);
+        if (entries == NULL)
+        {
+            /*not an error, lookups in this collection keep scanning it*/
+            LogError("unable to allocate the name index of %lu elements, lookups shall be linear", (unsigned long)count);
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < count; i++)
+            {
+                entries[i].element = getElement(collection, i, &entries[i].name);
+                entries[i].nameLength = strlen(entries[i].name);
+            }
+            qsort(entries, count, sizeof(SCHEMA_NAME_INDEX_ENTRY), CompareNameIndexEntries);
+            nameIndex->entries = entries;
+            nameIndex->count = count;
+        }
+    }
+}
+
+/*finds the element named by the first nameLength characters of name. Uses the index if it is built, otherwise scans the collection*/
+static void* FindByName(const SCHEMA_NAME_INDEX* nameIndex, const void* collection, size_t count, SCHEMA_NAME_INDEX_GET_ELEMENT getElement, const char* name, size_t nameLength)
+{
+    void* result = NULL;
+    if (nameIndex->entries != NULL)
+    {
+        size_t low = 0;
+        size_t high = nameIndex->count;
+        while (low < high)
+        {
+            size_t middle = low + (high - low) / 2;
+            const SCHEMA_NAME_INDEX_ENTRY* entry = &nameIndex->entries[middle];
+            int compareResult = CompareNames(name, nameLength, entry->name, entry->nameLength);
+            if (compareResult == 0)
+            {
+                result = entry->element;
+                break;
+            }
+            else if (compareResult < 0)
+            {
+                high = middle;
+            }
+            else
+            {
+                low = middle + 1;
+            }
+        }
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < count; i++)
+        {
+            const char* elementName;
+            void* element = getElement(collection, i, &elementName);
+            if ((strncmp(elementName, name, nameLength) == 0) && (elementName[nameLength] == '\0'))
+            {
+                result = element;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+static void* GetSchemaModelType(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)((const SCHEMA_HANDLE_DATA*)collection)->ModelTypes[index];
+    *name = modelType->Name;
+    return modelType;
+}
+
+static void* GetSchemaStructType(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)((const SCHEMA_HANDLE_DATA*)collection)->StructTypes[index];
+    *name = structType->Name;
+    return structType;
+}
+
+static void* GetModelProperty(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)collection)->Properties[index];
+    *name = property->PropertyName;
+    return property;
+}
+
+static void* GetStructTypeProperty(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)((const SCHEMA_STRUCT_TYPE_HANDLE_DATA*)collection)->Properties[index];
+    *name = property->PropertyName;
+    return property;
+}
+
+/*Schema_GetModelReportedPropertyByName returns the slot in the vector, so the index keeps the slot*/
+static void* GetModelReportedPropertySlot(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_REPORTED_PROPERTY_HANDLE_DATA** slot = (SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)VECTOR_element(((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)collection)->reportedProperties, index);
+    *name = (*slot)->reportedPropertyName;
+    return slot;
+}
+
+static void* GetModelDesiredProperty(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = *(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)collection)->desiredProperties, index);
+    *name = desiredProperty->desiredPropertyName;
+    return desiredProperty;
+}
+
+static void* GetModelAction(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_ACTION_HANDLE_DATA* action = (SCHEMA_ACTION_HANDLE_DATA*)((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)collection)->Actions[index];
+    *name = action->ActionName;
+    return action;
+}
+
+static void* GetModelMethod(const void* collection, size_t index, const char** name)
+{
+    SCHEMA_METHOD_HANDLE_DATA* method = *(SCHEMA_METHOD_HANDLE_DATA**)VECTOR_element(((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)collection)->methods, index);
+    *name = method->methodName;
+    return method;
+}
+
+static void* GetModelInModel(const void* collection, size_t index, const char** name)
+{
+    MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)collection)->models, index);
+    *name = modelInModel->propertyName;
+    return modelInModel;
+}
+
+static SCHEMA_PROPERTY_HANDLE_DATA* FindModelProperty(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    return (SCHEMA_PROPERTY_HANDLE_DATA*)FindByName(&modelType->propertyIndex, modelType, modelType->PropertyCount, GetModelProperty, name, nameLength);
+}
+
+static SCHEMA_REPORTED_PROPERTY_HANDLE_DATA** FindModelReportedPropertySlot(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    return (SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)FindByName(&modelType->reportedPropertyIndex, modelType, VECTOR_size(modelType->reportedProperties), GetModelReportedPropertySlot, name, nameLength);
+}
+
+static SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* FindModelDesiredProperty(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    return (SCHEMA_DESIRED_PROPERTY_HANDLE_DATA*)FindByName(&modelType->desiredPropertyIndex, modelType, VECTOR_size(modelType->desiredProperties), GetModelDesiredProperty, name, nameLength);
+}
+
+static SCHEMA_ACTION_HANDLE_DATA* FindModelAction(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    return (SCHEMA_ACTION_HANDLE_DATA*)FindByName(&modelType->actionIndex, modelType, modelType->ActionCount, GetModelAction, name, nameLength);
+}
+
+static SCHEMA_METHOD_HANDLE_DATA* FindModelMethod(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    return (SCHEMA_METHOD_HANDLE_DATA*)FindByName(&modelType->methodIndex, modelType, VECTOR_size(modelType->methods), GetModelMethod, name, nameLength);
+}
+
+static MODEL_IN_MODEL* FindModelInModel(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    return (MODEL_IN_MODEL*)FindByName(&modelType->modelIndex, modelType, VECTOR_size(modelType->models), GetModelInModel, name, nameLength);
+}
+
 static void DestroyProperty(SCHEMA_PROPERTY_HANDLE propertyHandle)
 {
     SCHEMA_PROPERTY_HANDLE_DATA* propertyType = (SCHEMA_PROPERTY_HANDLE_DATA*)propertyHandle;
@@ -184,6 +413,7 @@ static void DestroyStruct(SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle)
             DestroyProperty(structType->Properties[i]);
         }
         free(structType->Properties);
+        DestroyNameIndex(&structType->propertyIndex);
 
         free((void*)structType->Name);
 
@@ -243,6 +473,13 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_clear(modelType->models);
     VECTOR_destroy(modelType->models);
 
+    DestroyNameIndex(&modelType->propertyIndex);
+    DestroyNameIndex(&modelType->reportedPropertyIndex);
+    DestroyNameIndex(&modelType->desiredPropertyIndex);
+    DestroyNameIndex(&modelType->actionIndex);
+    DestroyNameIndex(&modelType->methodIndex);
+    DestroyNameIndex(&modelType->modelIndex);
+
     free(modelType->Actions);
     free(modelType);
 }
@@ -319,6 +556,8 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
                     {
                         modelType->Properties[modelType->PropertyCount] = (SCHEMA_PROPERTY_HANDLE)newProperty;
                         modelType->PropertyCount++;
+                        /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                        DestroyNameIndex(&modelType->propertyIndex);
 
                         /* Codes_SRS_SCHEMA_99_012:[On success, Schema_AddModelProperty shall return SCHEMA_OK.] */
                         result = SCHEMA_OK;
@@ -414,6 +653,8 @@ SCHEMA_HANDLE Schema_Create(const char* schemaNamespace, void* metadata)
             result->StructTypes = NULL;
             result->StructTypeCount = 0;
             result->metadata = metadata;
+            InitNameIndex(&result->modelTypeIndex);
+            InitNameIndex(&result->structTypeIndex);
         }
     }
 
@@ -488,6 +729,8 @@ void Schema_Destroy(SCHEMA_HANDLE schemaHandle)
         }
 
         free(schema->StructTypes);
+        DestroyNameIndex(&schema->modelTypeIndex);
+        DestroyNameIndex(&schema->structTypeIndex);
         free((void*)schema->Namespace);
         free(schema);
 
@@ -548,6 +791,33 @@ SCHEMA_RESULT Schema_DestroyIfUnused(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     return result;
 }
 
+static void BuildModelNameIndices(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    BuildNameIndex(&modelType->propertyIndex, modelType, modelType->PropertyCount, GetModelProperty);
+    BuildNameIndex(&modelType->reportedPropertyIndex, modelType, VECTOR_size(modelType->reportedProperties), GetModelReportedPropertySlot);
+    BuildNameIndex(&modelType->desiredPropertyIndex, modelType, VECTOR_size(modelType->desiredProperties), GetModelDesiredProperty);
+    BuildNameIndex(&modelType->actionIndex, modelType, modelType->ActionCount, GetModelAction);
+    BuildNameIndex(&modelType->methodIndex, modelType, VECTOR_size(modelType->methods), GetModelMethod);
+    BuildNameIndex(&modelType->modelIndex, modelType, VECTOR_size(modelType->models), GetModelInModel);
+}
+
+/*a schema is complete once a device is created from one of its models, so all the name indices of the schema are built then*/
+static void FreezeSchema(SCHEMA_HANDLE_DATA* schema)
+{
+    size_t i;
+    BuildNameIndex(&schema->modelTypeIndex, schema, schema->ModelTypeCount, GetSchemaModelType);
+    BuildNameIndex(&schema->structTypeIndex, schema, schema->StructTypeCount, GetSchemaStructType);
+    for (i = 0; i < schema->ModelTypeCount; i++)
+    {
+        BuildModelNameIndices((SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i]);
+    }
+    for (i = 0; i < schema->StructTypeCount; i++)
+    {
+        SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)schema->StructTypes[i];
+        BuildNameIndex(&structType->propertyIndex, structType, structType->PropertyCount, GetStructTypeProperty);
+    }
+}
+
 SCHEMA_RESULT Schema_AddDeviceRef(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
 {
     SCHEMA_RESULT result;
@@ -562,6 +832,10 @@ SCHEMA_RESULT Schema_AddDeviceRef(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /* Codes_SRS_SCHEMA_07_188: [If the modelTypeHandle is nonNULL, Schema_AddDeviceRef shall increment the SCHEMA_MODEL_TYPE_HANDLE_DATA DeviceCount variable.] */
         model->DeviceCount++;
+
+        /* Codes_SRS_SCHEMA_01_001: [ Schema_AddDeviceRef shall build the name indices of all the models and structs of the schema of modelTypeHandle and of their properties, reported properties, desired properties, actions, methods and models in model. ]*/
+        /* Codes_SRS_SCHEMA_01_002: [ If building a name index fails, Schema_AddDeviceRef shall still succeed and lookups in that collection shall scan it. ]*/
+        FreezeSchema((SCHEMA_HANDLE_DATA*)model->SchemaHandle);
         result = SCHEMA_OK;
     }
     return result;
@@ -712,9 +986,17 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
                                     modelType->Actions = NULL;
                                     modelType->SchemaHandle = schemaHandle;
                                     modelType->DeviceCount = 0;
+                                    InitNameIndex(&modelType->propertyIndex);
+                                    InitNameIndex(&modelType->reportedPropertyIndex);
+                                    InitNameIndex(&modelType->desiredPropertyIndex);
+                                    InitNameIndex(&modelType->actionIndex);
+                                    InitNameIndex(&modelType->methodIndex);
+                                    InitNameIndex(&modelType->modelIndex);
 
                                     schema->ModelTypes[schema->ModelTypeCount] = modelType;
                                     schema->ModelTypeCount++;
+                                    /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                                    DestroyNameIndex(&schema->modelTypeIndex);
                                     /* Codes_SRS_SCHEMA_99_008:[On success, a non-NULL handle shall be returned.] */
                                     result = (SCHEMA_MODEL_TYPE_HANDLE)modelType;
                                 }
@@ -840,6 +1122,8 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
                         else
                         {
                             /*Codes_SRS_SCHEMA_02_007: [ Otherwise Schema_AddModelReportedProperty shall succeed and return SCHEMA_OK. ]*/
+                            /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                            DestroyNameIndex(&modelType->reportedPropertyIndex);
                             result = SCHEMA_OK;
                         }
                     }
@@ -919,6 +1203,8 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
 
                         modelType->Actions[modelType->ActionCount] = newAction;
                         modelType->ActionCount++;
+                        /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                        DestroyNameIndex(&modelType->actionIndex);
                         result = (SCHEMA_ACTION_HANDLE)(newAction);
                     }
 
@@ -1025,6 +1311,8 @@ SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelType
                         {
                             /*Codes_SRS_SCHEMA_02_104: [ Otherwise, Schema_CreateModelMethod shall succeed and return a non-NULL SCHEMA_METHOD_HANDLE. ]*/
                             /*return as is*/
+                            /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                            DestroyNameIndex(&modelTypeHandle->methodIndex);
                         }
                     }
                 }
@@ -1243,29 +1531,16 @@ SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE mo
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_036:[Schema_GetModelPropertyByName shall return a non-NULL SCHEMA_PROPERTY_HANDLE corresponding to the model type identified by modelTypeHandle and matching the propertyName argument value.] */
-        for (i = 0; i < modelType->PropertyCount; i++)
-        {
-            SCHEMA_PROPERTY_HANDLE_DATA* modelProperty = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-            if (strcmp(modelProperty->PropertyName, propertyName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == modelType->PropertyCount)
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        result = (SCHEMA_PROPERTY_HANDLE)FindModelProperty(modelType, propertyName, strlen(propertyName));
+        if (result == NULL)
         {
             /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
-        }
     }
 
     return result;
@@ -1337,7 +1612,8 @@ SCHEMA_REPORTED_PROPERTY_HANDLE Schema_GetModelReportedPropertyByName(SCHEMA_MOD
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_013: [ If reported property by the name reportedPropertyName exists then Schema_GetModelReportedPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_014: [ Otherwise Schema_GetModelReportedPropertyByName shall fail and return NULL. ]*/
-        if((result = VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName))==NULL)
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        if((result = (SCHEMA_REPORTED_PROPERTY_HANDLE)FindModelReportedPropertySlot(modelType, reportedPropertyName, strlen(reportedPropertyName)))==NULL)
         {
             LogError("a reported property with name \"%s\" does not exist", reportedPropertyName);
         }
@@ -1411,42 +1687,21 @@ SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_040:[Schema_GetModelActionByName shall return a non-NULL SCHEMA_ACTION_HANDLE corresponding to the model type identified by modelTypeHandle and matching the actionName argument value.] */
-        for (i = 0; i < modelType->ActionCount; i++)
-        {
-            SCHEMA_ACTION_HANDLE_DATA* modelAction = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
-            if (strcmp(modelAction->ActionName, actionName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == modelType->ActionCount)
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        result = (SCHEMA_ACTION_HANDLE)FindModelAction(modelType, actionName, strlen(actionName));
+        if (result == NULL)
         {
             /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = modelType->Actions[i];
-        }
     }
 
     return result;
 }
 
-static bool matchModelMethod(const void* element, const void* value)
-{
-    /*element is a pointer to SCHEMA_METHOD_HANDLE_DATA*/
-    const SCHEMA_METHOD_HANDLE* decodedElement = (const SCHEMA_METHOD_HANDLE* )element;
-    const char* name = (const char*)value;
-    return (strcmp((*decodedElement)->methodName, name) == 0);
-}
-
 SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* methodName)
 {
     SCHEMA_METHOD_HANDLE result;
@@ -1462,16 +1717,12 @@ SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     else
     {
         /*Codes_SRS_SCHEMA_02_117: [ If a method with the name methodName exists then Schema_GetModelMethodByName shall succeed and returns its handle. ]*/
-        SCHEMA_METHOD_HANDLE* found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
-        if (found == NULL)
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        result = (SCHEMA_METHOD_HANDLE)FindModelMethod((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, methodName, strlen(methodName));
+        if (result == NULL)
         {
             /*Codes_SRS_SCHEMA_02_118: [ Otherwise, Schema_GetModelMethodByName shall fail and return NULL. ]*/
             LogError("no such method by name = %s", methodName);
-            result = NULL;
-        }
-        else
-        {
-            result = *found;
         }
     }
 
@@ -1823,6 +2074,9 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_CreateStructType(SCHEMA_HANDLE schemaHandle, co
                     schema->StructTypeCount++;
                     structType->PropertyCount = 0;
                     structType->Properties = NULL;
+                    InitNameIndex(&structType->propertyIndex);
+                    /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                    DestroyNameIndex(&schema->structTypeIndex);
 
                     /* Codes_SRS_SCHEMA_99_058:[On success, a non-NULL handle shall be returned.] */
                     result = (SCHEMA_STRUCT_TYPE_HANDLE)structType;
@@ -1913,28 +2167,14 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_GetStructTypeByName(SCHEMA_HANDLE schemaHandle,
     }
     else
     {
-        size_t i;
-
         /* Codes_SRS_SCHEMA_99_068:[Schema_GetStructTypeByName shall return a non-NULL handle corresponding to the struct type identified by the structTypeName in the schemaHandle schema.] */
-        for (i = 0; i < schema->StructTypeCount; i++)
-        {
-            SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)schema->StructTypes[i];
-            if (strcmp(structType->Name, name) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == schema->StructTypeCount)
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        result = (SCHEMA_STRUCT_TYPE_HANDLE)FindByName(&schema->structTypeIndex, schema, schema->StructTypeCount, GetSchemaStructType, name, strlen(name));
+        if (result == NULL)
         {
             /* Codes_SRS_SCHEMA_99_069:[Schema_GetStructTypeByName shall return NULL if unable to find a matching struct or if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = schema->StructTypes[i];
-        }
     }
 
     return result;
@@ -2033,6 +2273,8 @@ SCHEMA_RESULT Schema_AddStructTypeProperty(SCHEMA_STRUCT_TYPE_HANDLE structTypeH
                         /* Codes_SRS_SCHEMA_99_070:[Schema_AddStructTypeProperty shall add one property to the struct type identified by structTypeHandle.] */
                         structType->Properties[structType->PropertyCount] = (SCHEMA_PROPERTY_HANDLE)newProperty;
                         structType->PropertyCount++;
+                        /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                        DestroyNameIndex(&structType->propertyIndex);
 
                         /* Codes_SRS_SCHEMA_99_071:[On success, Schema_AddStructTypeProperty shall return SCHEMA_OK.] */
                         result = SCHEMA_OK;
@@ -2080,29 +2322,16 @@ SCHEMA_PROPERTY_HANDLE Schema_GetStructTypePropertyByName(SCHEMA_STRUCT_TYPE_HAN
     }
     else
     {
-        size_t i;
         SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)structTypeHandle;
 
-        for (i = 0; i < structType->PropertyCount; i++)
-        {
-            SCHEMA_PROPERTY_HANDLE_DATA* modelProperty = (SCHEMA_PROPERTY_HANDLE_DATA*)structType->Properties[i];
-            if (strcmp(modelProperty->PropertyName, propertyName) == 0)
-            {
-                break;
-            }
-        }
-
+        /* Codes_SRS_SCHEMA_99_075:[Schema_GetStructTypePropertyByName shall return a non-NULL handle corresponding to a property identified by the structTypeHandle and propertyName.] */
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        result = (SCHEMA_PROPERTY_HANDLE)FindByName(&structType->propertyIndex, structType, structType->PropertyCount, GetStructTypeProperty, propertyName, strlen(propertyName));
         /* Codes_SRS_SCHEMA_99_076:[Schema_GetStructTypePropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
-        if (i == structType->PropertyCount)
+        if (result == NULL)
         {
-            result = NULL;
             LogError("(Error code: %s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        /* Codes_SRS_SCHEMA_99_075:[Schema_GetStructTypePropertyByName shall return a non-NULL handle corresponding to a property identified by the structTypeHandle and propertyName.] */
-        else
-        {
-            result = structType->Properties[i];
-        }
     }
 
     return result;
@@ -2235,24 +2464,9 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelByName(SCHEMA_HANDLE schemaHandle, const
     {
         /* Codes_SRS_SCHEMA_99_124: [Schema_GetModelByName shall return a non-NULL SCHEMA_MODEL_TYPE_HANDLE corresponding to the model identified by schemaHandle and matching the modelName argument value.] */
         SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
-        size_t i;
-        for (i = 0; i < schema->ModelTypeCount; i++)
-        {
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i];
-            if (strcmp(modelName, modelType->Name)==0)
-            {
-                break;
-            }
-        }
-        if (i == schema->ModelTypeCount)
-        {
-            /* Codes_SRS_SCHEMA_99_125: [Schema_GetModelByName shall return NULL if unable to find a matching model, or if any of the arguments are NULL.] */
-            result = NULL;
-        }
-        else
-        {
-            result = schema->ModelTypes[i];
-        }
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        /* Codes_SRS_SCHEMA_99_125: [Schema_GetModelByName shall return NULL if unable to find a matching model, or if any of the arguments are NULL.] */
+        result = (SCHEMA_MODEL_TYPE_HANDLE)FindByName(&schema->modelTypeIndex, schema, schema->ModelTypeCount, GetSchemaModelType, modelName, strlen(modelName));
     }
     return result;
 }
@@ -2332,7 +2546,8 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         else
         {
             /*Codes_SRS_SCHEMA_99_164: [If the function succeeds, then the return value shall be SCHEMA_OK.]*/
-
+            /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+            DestroyNameIndex(&parentModel->modelIndex);
             result = SCHEMA_OK;
         }
     }
@@ -2363,13 +2578,6 @@ SCHEMA_RESULT Schema_GetModelModelCount(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle
     return result;
 }
 
-static bool matchModelName(const void* element, const void* value)
-{
-    MODEL_IN_MODEL* decodedElement = (MODEL_IN_MODEL*)element;
-    const char* name = (const char*)value;
-    return (strcmp(decodedElement->propertyName, name) == 0);
-}
-
 SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
 {
     SCHEMA_MODEL_TYPE_HANDLE result;
@@ -2387,7 +2595,8 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_99_170: [Schema_GetModelModelByName shall return a handle to the model identified by the property with the name propertyName in the model identified by the handle modelTypeHandle.]*/
         /*Codes_SRS_SCHEMA_99_171: [If Schema_GetModelModelByName is unable to provide the handle it shall return NULL.]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        MODEL_IN_MODEL* temp = FindModelInModel(model, propertyName, strlen(propertyName));
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2395,7 +2604,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
         }
         else
         {
-            result = ((MODEL_IN_MODEL*)temp)->modelHandle;
+            result = temp->modelHandle;
         }
     }
     return result;
@@ -2419,7 +2628,8 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_056: [ If propertyName is not a model then Schema_GetModelModelByName_Offset shall fail and return 0. ]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        MODEL_IN_MODEL* temp = FindModelInModel(model, propertyName, strlen(propertyName));
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2428,7 +2638,7 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
         else
         {
             /*Codes_SRS_SCHEMA_02_055: [ Otherwise Schema_GetModelModelByName_Offset shall succeed and return the offset. ]*/
-            result = ((MODEL_IN_MODEL*)temp)->offset;
+            result = temp->offset;
         }
     }
     return result;
@@ -2450,7 +2660,8 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        MODEL_IN_MODEL* temp = FindModelInModel(model, propertyName, strlen(propertyName));
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2459,7 +2670,7 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
         else
         {
             /*Codes_SRS_SCHEMA_02_089: [ Otherwise Schema_GetModelModelByName_OnDesiredProperty shall return the desired property callback. ]*/
-            result = ((MODEL_IN_MODEL*)temp)->onDesiredProperty;
+            result = temp->onDesiredProperty;
         }
     }
     return result;
@@ -2576,8 +2787,7 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             /* Codes_SRS_SCHEMA_99_179: [The propertyPath shall be assumed to be in the format model1/model2/.../propertyName.] */
@@ -2589,21 +2799,12 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             }
 
             /* get the child-model */
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+            childModel = FindModelInModel(modelType, propertyPath, (size_t)(endPos - propertyPath));
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, propertyPath, endPos - propertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - propertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2621,18 +2822,8 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             {
                 /* no model found, let's see if this is a property */
                 /* Codes_SRS_SCHEMA_99_178: [The argument propertyPath shall be used to find the leaf property.] */
-                for (i = 0; i < modelType->PropertyCount; i++)
-                {
-                    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-                    if ((strncmp(property->PropertyName, propertyPath, endPos - propertyPath) == 0) &&
-                        (strlen(property->PropertyName) == (size_t)(endPos - propertyPath)))
-                    {
-                        /* found property */
-                        /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
-                        result = true;
-                        break;
-                    }
-                }
+                /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
+                result = (FindModelProperty(modelType, propertyPath, (size_t)(endPos - propertyPath)) != NULL);
 
                 break;
             }
@@ -2670,8 +2861,7 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(reportedPropertyPath, '/');
@@ -2681,21 +2871,12 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
                 endPos = &reportedPropertyPath[strlen(reportedPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+            childModel = FindModelInModel(modelType, reportedPropertyPath, (size_t)(endPos - reportedPropertyPath));
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, reportedPropertyPath, endPos - reportedPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - reportedPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2713,7 +2894,7 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyPath) != NULL);
+                result = (FindModelReportedPropertySlot(modelType, reportedPropertyPath, strlen(reportedPropertyPath)) != NULL);
                 if (!result)
                 {
                     LogError("no such reported property \"%s\"", reportedPropertyPath);
@@ -2811,6 +2992,8 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                             desiredProperty->desiredPropertDeinitialize = desiredPropertyDeinitialize;
                             desiredProperty->onDesiredProperty = onDesiredProperty; /*NULL is a perfectly fine value*/
                             desiredProperty->offset = offset;
+                            /* Codes_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+                            DestroyNameIndex(&handleData->desiredPropertyIndex);
                             result = SCHEMA_OK;
                         }
                     }
@@ -2863,15 +3046,11 @@ SCHEMA_DESIRED_PROPERTY_HANDLE Schema_GetModelDesiredPropertyByName(SCHEMA_MODEL
         /*Codes_SRS_SCHEMA_02_036: [ If a desired property having the name desiredPropertyName exists then Schema_GetModelDesiredPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_037: [ Otherwise, Schema_GetModelDesiredPropertyByName shall fail and return NULL. ]*/
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName);
-        if (temp == NULL)
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        result = (SCHEMA_DESIRED_PROPERTY_HANDLE)FindModelDesiredProperty(handleData, desiredPropertyName, strlen(desiredPropertyName));
+        if (result == NULL)
         {
             LogError("no such desired property by name %s", desiredPropertyName);
-            result = NULL;
-        }
-        else
-        {
-            result = *temp;
         }
     }
     return result;
@@ -2934,8 +3113,7 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(desiredPropertyPath, '/');
@@ -2945,21 +3123,12 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                 endPos = &desiredPropertyPath[strlen(desiredPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+            childModel = FindModelInModel(modelType, desiredPropertyPath, (size_t)(endPos - desiredPropertyPath));
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, desiredPropertyPath, endPos - desiredPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - desiredPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2977,7 +3146,7 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyPath) != NULL);
+                result = (FindModelDesiredProperty(modelType, desiredPropertyPath, strlen(desiredPropertyPath)) != NULL);
                 if (!result)
                 {
                     LogError("no such desired property \"%s\"", desiredPropertyPath);
@@ -3059,12 +3228,6 @@ size_t Schema_GetModelDesiredProperty_offset(SCHEMA_DESIRED_PROPERTY_HANDLE desi
     return result;
 }
 
-static bool modelInModelExists(const void* element, const void* value)
-{
-    MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)element;
-    return (strcmp(modelInModel->propertyName, value) == 0);
-}
-
 SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* elementName)
 {
     SCHEMA_MODEL_ELEMENT result;
@@ -3082,31 +3245,19 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
-        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, elementName);
-        if (desiredPropertyHandle != NULL)
+        size_t elementNameLength = strlen(elementName);
+        /* Codes_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+        SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = FindModelDesiredProperty(handleData, elementName, elementNameLength);
+        if (desiredProperty != NULL)
         {
             /*Codes_SRS_SCHEMA_02_080: [ If elementName is a desired property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_DESIRED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.desiredPropertyHandle to the handle of the desired property. ]*/
             result.elementType = SCHEMA_DESIRED_PROPERTY;
-            result.elementHandle.desiredPropertyHandle = *desiredPropertyHandle;
+            result.elementHandle.desiredPropertyHandle = desiredProperty;
         }
         else
         {
-            size_t nProcessedProperties = 0;
-            SCHEMA_PROPERTY_HANDLE_DATA* property = NULL;
-            for (size_t i = 0; i < handleData->PropertyCount;i++)
-            {
-                property = (SCHEMA_PROPERTY_HANDLE_DATA*)(handleData->Properties[i]);
-                if (strcmp(property->PropertyName, elementName) == 0)
-                {
-                    i = handleData->PropertyCount; /*found it*/
-                }
-                else
-                {
-                    nProcessedProperties++;
-                }
-            }
-
-            if (nProcessedProperties < handleData->PropertyCount)
+            SCHEMA_PROPERTY_HANDLE_DATA* property = FindModelProperty(handleData, elementName, elementNameLength);
+            if (property != NULL)
             {
                 /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
                 result.elementType = SCHEMA_PROPERTY;
@@ -3115,7 +3266,7 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
             else
             {
 
-                SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle = VECTOR_find_if(handleData->reportedProperties, reportedPropertyExists, elementName);
+                SCHEMA_REPORTED_PROPERTY_HANDLE_DATA** reportedPropertyHandle = FindModelReportedPropertySlot(handleData, elementName, elementNameLength);
                 if (reportedPropertyHandle != NULL)
                 {
                     /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
@@ -3125,22 +3276,8 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
                 else
                 {
 
-                    size_t nProcessedActions = 0;
-                    SCHEMA_ACTION_HANDLE_DATA* actionHandleData = NULL;
-                    for (size_t i = 0;i < handleData->ActionCount; i++)
-                    {
-                        actionHandleData = (SCHEMA_ACTION_HANDLE_DATA*)(handleData->Actions[i]);
-                        if (strcmp(actionHandleData->ActionName, elementName) == 0)
-                        {
-                            i = handleData->ActionCount; /*get out quickly*/
-                        }
-                        else
-                        {
-                            nProcessedActions++;
-                        }
-                    }
-
-                    if (nProcessedActions < handleData->ActionCount)
+                    SCHEMA_ACTION_HANDLE_DATA* actionHandleData = FindModelAction(handleData, elementName, elementNameLength);
+                    if (actionHandleData != NULL)
                     {
                         /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
                         result.elementType = SCHEMA_MODEL_ACTION;
@@ -3148,7 +3285,7 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
                     }
                     else
                     {
-                        MODEL_IN_MODEL* modelInModel = VECTOR_find_if(handleData->models, modelInModelExists, elementName);
+                        MODEL_IN_MODEL* modelInModel = FindModelInModel(handleData, elementName, elementNameLength);
                         if (modelInModel != NULL)
                         {
                             /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
@@ -37,6 +37,23 @@ DEVICE_RESULT Device_PublishTransacted(TRANSACTION_HANDLE, const char*, const AG
 DEVICE_RESULT Device_EndTransaction(TRANSACTION_HANDLE) { return DEVICE_ERROR; }
 DEVICE_RESULT Device_CancelTransaction(TRANSACTION_HANDLE) { return DEVICE_ERROR; }
 
+void JSONReader_SetError(JSON_READER*, JSON_READER_RESULT) { }
+bool JSONReader_BeginObject(JSON_READER*) { return false; }
+bool JSONReader_NextMember(JSON_READER*, const char**, size_t*) { return false; }
+void JSONReader_SkipValue(JSON_READER*) { }
+void JSONReader_End(JSON_READER*) { }
+void JSONReader_ReadInt64(JSON_READER*, int64_t, int64_t, int64_t*) { }
+void JSONReader_ReadBool(JSON_READER*, bool*) { }
+void JSONReader_ReadDouble(JSON_READER*, double*) { }
+void JSONReader_ReadFloat(JSON_READER*, float*) { }
+void JSONReader_ReadCharz(JSON_READER*, char**) { }
+void JSONReader_ReadCharzNoQuotes(JSON_READER*, char**) { }
+void JSONReader_ReadDateTimeOffset(JSON_READER*, EDM_DATE_TIME_OFFSET*) { }
+void JSONReader_ReadGuid(JSON_READER*, EDM_GUID*) { }
+void JSONReader_ReadBinary(JSON_READER*, EDM_BINARY*) { }
+void JSONReader_SortMembers(JSON_READER_MEMBER_INDEX*) { }
+size_t JSONReader_FindMember(const JSON_READER_MEMBER_INDEX*, const char*, size_t) { return 0; }
+
 static const SCHEMA_HANDLE TEST_SCHEMA_HANDLE = (SCHEMA_HANDLE)0x4242;
 static const SCHEMA_MODEL_TYPE_HANDLE TEST_MODEL_HANDLE = (SCHEMA_MODEL_TYPE_HANDLE)0x4243;
 
@@ -694,6 +694,16 @@ static void my_Device_DestroyTransaction_ReportedProperties(REPORTED_PROPERTIES_
     my_gballoc_free(transactionHandle);
 }
 
+/*the device gets the JSON decoders of OuterType when its model is named "OuterType"*/
+static OuterType* createOuterTypeDeviceWithJSONDecoders(void)
+{
+    OuterType* device;
+    STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
+    device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
+    umock_c_reset_all_calls();
+    return device;
+}
+
 static SCHEMA_RESULT my_Schema_GetModelDesiredPropertyCount(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, size_t* desiredPropertyCount)
 {
     (void)modelTypeHandle;
@@ -1811,8 +1821,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_deviceHandle()
             .IgnoreArgument_methodCallbackContext()
             .IgnoreArgument_callbackUserContext();
-
-
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
 
@@ -1842,6 +1851,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_deviceHandle()
             .IgnoreArgument_methodCallbackContext()
             .IgnoreArgument_callbackUserContext();
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
 
@@ -1872,6 +1882,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_deviceHandle()
             .IgnoreArgument_methodCallbackContext()
             .IgnoreArgument_callbackUserContext();
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
 
@@ -3932,6 +3943,236 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_01_008: [ Before it creates a schema that is not registered yet, CodeFirst_RegisterSchema shall call the jsonMemberIndexSorter of every struct and model in metadata, so that the member indexes are sorted before any device can be created from the schema and the JSON decoders only read them. ]*/
+    /*Tests_SRS_SERIALIZER_H_01_012: [ DECLARE_STRUCT and DECLARE_MODEL shall define a jsonMemberIndexSorter SortJSONMembers_name that sorts every JSON_READER_MEMBER_INDEX of name with JSONReader_SortMembers. ]*/
+    TEST_FUNCTION(CodeFirst_RegisterSchema_sorts_the_member_indexes_of_all_the_structs_and_models)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        JSONFieldIndex_whereIsMyDevice_Struct.isSorted = false;
+        JSONFieldIndex_theCarIsBehindTheVan_Struct.isSorted = false;
+        JSONMemberIndex_truckType_Model.isSorted = false;
+        JSONActionIndex_truckType_Model.isSorted = false;
+        setSpeed_ActionJSONPARAMETERINDEX.isSorted = false;
+        JSONMemberIndex_SimpleDevice_Model.isSorted = false;
+        umock_c_reset_all_calls();
+
+        ///act
+        (void)CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
+
+        ///assert
+        ASSERT_IS_TRUE(JSONFieldIndex_whereIsMyDevice_Struct.isSorted);
+        ASSERT_IS_TRUE(JSONFieldIndex_theCarIsBehindTheVan_Struct.isSorted);
+        ASSERT_IS_TRUE(JSONMemberIndex_truckType_Model.isSorted);
+        ASSERT_IS_TRUE(JSONActionIndex_truckType_Model.isSorted);
+        ASSERT_IS_TRUE(setSpeed_ActionJSONPARAMETERINDEX.isSorted);
+        ASSERT_IS_TRUE(JSONMemberIndex_SimpleDevice_Model.isSorted);
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_008: [ Before it creates a schema that is not registered yet, CodeFirst_RegisterSchema shall call the jsonMemberIndexSorter of every struct and model in metadata, so that the member indexes are sorted before any device can be created from the schema and the JSON decoders only read them. ]*/
+    TEST_FUNCTION(CodeFirst_RegisterSchema_of_a_registered_schema_and_CodeFirst_CreateDevice_do_not_sort_the_member_indexes)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        JSONFieldIndex_whereIsMyDevice_Struct.isSorted = false;
+        JSONMemberIndex_SimpleDevice_Model.isSorted = false;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"))
+            .SetReturn((SCHEMA_HANDLE)TEST_SCHEMA_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE)).SetReturn("SimpleDevice_Model");
+
+        ///act
+        SCHEMA_HANDLE schema = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, TEST_SCHEMA_HANDLE, schema);
+        ASSERT_IS_NOT_NULL(device);
+        ASSERT_IS_FALSE(JSONFieldIndex_whereIsMyDevice_Struct.isSorted);
+        ASSERT_IS_FALSE(JSONMemberIndex_SimpleDevice_Model.isSorted);
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_002: [ CodeFirst_CreateDevice shall keep the JSON decoders of the model found in metadata with the name of model. ]*/
+    /*Tests_SRS_CODEFIRST_01_004: [ If the model of the device has JSON decoders, CodeFirst_ExecuteCommand shall read the action name and the parameters from the command JSON in place and call the action through the jsonActionDispatcher of the model. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteCommand_with_JSON_decoders_calls_the_action_without_Device_ExecuteCommand)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+        OuterType_reset_device = NULL;
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteCommand(device, "{\"Parameters\":{}, \"Name\":\"OuterType_reset_Action\"}");
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(void_ptr, device, OuterType_reset_device);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_004: [ If the model of the device has JSON decoders, CodeFirst_ExecuteCommand shall read the action name and the parameters from the command JSON in place and call the action through the jsonActionDispatcher of the model. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteCommand_with_JSON_decoders_calls_the_action_of_a_child_model)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+        InnerType_reset_device = NULL;
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteCommand(device, "{\"Name\":\"Inner/InnerType_reset_Action\", \"Parameters\":{}}");
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(void_ptr, &device->Inner, InnerType_reset_device);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_005: [ If the command is not valid JSON, has no string member "Name" or no member "Parameters", CodeFirst_ExecuteCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteCommand_with_JSON_decoders_and_invalid_commands_fails)
+    {
+        ///arrange
+        static const char* const commands[] =
+        {
+            "{\"Name\":\"OuterType_reset_Action\", \"Parameters\":{}",
+            "{\"Parameters\":{}}",
+            "{\"Name\":\"OuterType_reset_Action\"}",
+            "{\"Name\":3, \"Parameters\":{}}",
+            "{\"Name\":\"notAnAction\", \"Parameters\":{}}"
+        };
+        size_t i;
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+        OuterType_reset_device = NULL;
+
+        for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+        {
+            ///act
+            EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteCommand(device, commands[i]);
+
+            ///assert
+            ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        }
+        ASSERT_IS_NULL(OuterType_reset_device);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_006: [ If the model of the device has JSON decoders, CodeFirst_IngestDesiredProperties shall read the desired properties from jsonPayload in place into the device, only from the member "desired" when parseDesiredNode is true, and skip "$version". ]*/
+    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_JSON_decoders_writes_the_device_without_Device_IngestDesiredProperties)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_IngestDesiredProperties(device, "{\"Inner\":{\"this_is_desired_int_Property_2\":42}, \"$version\":3}", false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(int, 42, device->Inner.this_is_desired_int_Property_2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_006: [ If the model of the device has JSON decoders, CodeFirst_IngestDesiredProperties shall read the desired properties from jsonPayload in place into the device, only from the member "desired" when parseDesiredNode is true, and skip "$version". ]*/
+    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_JSON_decoders_reads_only_desired_of_a_twin)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_IngestDesiredProperties(device, "{\"reported\":{\"x\":[1,2]}, \"desired\":{\"Inner\":{\"this_is_desired_int_Property_2\":-7}, \"$version\":4}}", true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(int, -7, device->Inner.this_is_desired_int_Property_2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_007: [ If jsonPayload is not valid JSON, in which case the device is left unchanged, has a member that is not a desired property or a model in model of the device, repeats a member, or has no member "desired" when parseDesiredNode is true, CodeFirst_IngestDesiredProperties shall return CODEFIRST_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_JSON_decoders_and_invalid_JSON_does_not_change_the_device)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+        device->Inner.this_is_desired_int_Property_2 = 1;
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_IngestDesiredProperties(device, "{\"Inner\":{\"this_is_desired_int_Property_2\":42}", false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_ERROR, result);
+        ASSERT_ARE_EQUAL(int, 1, device->Inner.this_is_desired_int_Property_2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_01_007: [ If jsonPayload is not valid JSON, in which case the device is left unchanged, has a member that is not a desired property or a model in model of the device, repeats a member, or has no member "desired" when parseDesiredNode is true, CodeFirst_IngestDesiredProperties shall return CODEFIRST_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_JSON_decoders_and_unexpected_members_fails)
+    {
+        ///arrange
+        static const struct
+        {
+            const char* jsonPayload;
+            bool parseDesiredNode;
+        } payloads[] =
+        {
+            { "{\"Inner\":{\"notADesiredProperty\":42}}", false },
+            { "{\"Inner\":{\"this_is_int2\":42}}", false },
+            { "{\"Inner\":{\"this_is_desired_int_Property_2\":4, \"this_is_desired_int_Property_2\":5}}", false },
+            { "{\"Inner\":{\"this_is_desired_int_Property_2\":\"42\"}}", false },
+            { "{\"Inner\":{\"this_is_desired_int_Property_2\":42}}", true },
+            { "{\"desired\":{}, \"desired\":{}}", true }
+        };
+        size_t i;
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = createOuterTypeDeviceWithJSONDecoders();
+
+        for (i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++)
+        {
+            ///act
+            CODEFIRST_RESULT result = CodeFirst_IngestDesiredProperties(device, payloads[i].jsonPayload, payloads[i].parseDesiredNode);
+
+            ///assert
+            ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_ERROR, result);
+        }
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
     /* Tests_SRS_CODEFIRST_99_002:[ CodeFirst_RegisterSchema shall create the schema information and give it to the Schema module for one schema, identified by the metadata argument. On success, it shall return a handle to the model.] */
     TEST_FUNCTION(CodeFirst_CreateDevice_passes_onDesiredProperty_callbacks)
     {
@@ -4021,6 +4262,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_deviceHandle()
             .IgnoreArgument_methodCallbackContext()
             .IgnoreArgument_callbackUserContext();
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
 
@@ -0,0 +1,1150 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* s)
+{
+    free(s);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "agenttypesystem.h"
+#undef ENABLE_MOCKS
+
+#include "jsonreader.h"
+#include "testrunnerswitcher.h"
+
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+TEST_DEFINE_ENUM_TYPE(JSON_READER_RESULT, JSON_READER_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+/* the text CreateAgentDataType_From_String was last called with */
+static char lastSource[128];
+
+static AGENT_DATA_TYPES_RESULT my_CreateAgentDataType_From_String(const char* source, AGENT_DATA_TYPE_TYPE type, AGENT_DATA_TYPE* agentData)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    (void)strncpy(lastSource, source, sizeof(lastSource) - 1);
+    if (strcmp(source, "\"bad\"") == 0)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+    }
+    else
+    {
+        (void)memset(agentData, 0, sizeof(AGENT_DATA_TYPE));
+        agentData->type = type;
+        if (type == EDM_DATE_TIME_OFFSET_TYPE)
+        {
+            agentData->value.edmDateTimeOffset.dateTime.tm_year = 114;
+        }
+        else
+        {
+            agentData->value.edmGuid.GUID[0] = 0x42;
+        }
+        result = AGENT_DATA_TYPES_OK;
+    }
+    return result;
+}
+
+static void init_reader(JSON_READER* reader, const char* json)
+{
+    JSONReader_Init(reader, json, strlen(json));
+}
+
+BEGIN_TEST_SUITE(jsonreader_ut)
+
+TEST_SUITE_INITIALIZE(TestSuiteInitialize)
+{
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(CreateAgentDataType_From_String, my_CreateAgentDataType_From_String);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(Setup)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    lastSource[0] = '\0';
+}
+
+TEST_FUNCTION_CLEANUP(Cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* JSONReader_Init */
+
+/* Tests_SRS_JSON_READER_01_001: [ JSONReader_Init shall set the reader to read length bytes at json, from position 0 and with result JSON_READER_OK. ]*/
+TEST_FUNCTION(JSONReader_Init_sets_the_text)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* json = "{}";
+
+    ///act
+    JSONReader_Init(&reader, json, 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(void_ptr, json, reader.json);
+    ASSERT_ARE_EQUAL(size_t, 2, reader.length);
+    ASSERT_ARE_EQUAL(size_t, 0, reader.position);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_JSON_READER_01_002: [ If json is NULL, the result of the reader shall be JSON_READER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONReader_Init_with_NULL_json_sets_INVALID_ARG)
+{
+    ///arrange
+    JSON_READER reader;
+
+    ///act
+    JSONReader_Init(&reader, NULL, 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, reader.result);
+    ASSERT_ARE_EQUAL(size_t, 0, reader.length);
+}
+
+/* JSONReader_SetError */
+
+/* Tests_SRS_JSON_READER_01_004: [ JSONReader_SetError shall set the result of the reader, unless the reader already has an error. ]*/
+TEST_FUNCTION(JSONReader_SetError_sets_the_result)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "{}");
+
+    ///act
+    JSONReader_SetError(&reader, JSON_READER_MEMBER_NOT_FOUND);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_MEMBER_NOT_FOUND, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_004: [ JSONReader_SetError shall set the result of the reader, unless the reader already has an error. ]*/
+TEST_FUNCTION(JSONReader_SetError_keeps_the_first_error)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "{}");
+    JSONReader_SetError(&reader, JSON_READER_TYPE_MISMATCH);
+
+    ///act
+    JSONReader_SetError(&reader, JSON_READER_PARSE_ERROR);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_003: [ If reader is NULL or its result is not JSON_READER_OK, the JSONReader_ functions shall do nothing and JSONReader_BeginObject and JSONReader_NextMember shall return false. ]*/
+TEST_FUNCTION(JSONReader_functions_with_NULL_reader_do_nothing)
+{
+    ///arrange
+    const char* name;
+    size_t nameLength;
+    int64_t number = 0;
+    char* text = NULL;
+
+    ///act
+    JSONReader_Init(NULL, "{}", 2);
+    JSONReader_SetError(NULL, JSON_READER_ERROR);
+    JSONReader_SkipValue(NULL);
+    JSONReader_End(NULL);
+    JSONReader_ReadInt64(NULL, 0, 10, &number);
+    JSONReader_ReadCharz(NULL, &text);
+
+    ///assert
+    ASSERT_IS_FALSE(JSONReader_BeginObject(NULL));
+    ASSERT_IS_FALSE(JSONReader_NextMember(NULL, &name, &nameLength));
+    ASSERT_ARE_EQUAL(int, 0, (int)number);
+    ASSERT_IS_NULL(text);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_JSON_READER_01_003: [ If reader is NULL or its result is not JSON_READER_OK, the JSONReader_ functions shall do nothing and JSONReader_BeginObject and JSONReader_NextMember shall return false. ]*/
+TEST_FUNCTION(JSONReader_functions_do_nothing_after_an_error)
+{
+    ///arrange
+    JSON_READER reader;
+    int64_t number = 0;
+    bool flag = false;
+    init_reader(&reader, "{\"a\":1}");
+    JSONReader_SetError(&reader, JSON_READER_MEMBER_NOT_FOUND);
+
+    ///act
+    JSONReader_SkipValue(&reader);
+    JSONReader_ReadInt64(&reader, 0, 10, &number);
+    JSONReader_ReadBool(&reader, &flag);
+    JSONReader_End(&reader);
+
+    ///assert
+    ASSERT_IS_FALSE(JSONReader_BeginObject(&reader));
+    ASSERT_ARE_EQUAL(size_t, 0, reader.position);
+    ASSERT_ARE_EQUAL(int, 0, (int)number);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_MEMBER_NOT_FOUND, reader.result);
+}
+
+/* JSONReader_BeginObject / JSONReader_NextMember */
+
+/* Tests_SRS_JSON_READER_01_005: [ JSONReader_BeginObject shall skip white space and consume the '{' that opens an object. ]*/
+/* Tests_SRS_JSON_READER_01_007: [ When the next character is the '}' that closes the object, JSONReader_NextMember shall consume it and return false. ]*/
+TEST_FUNCTION(JSONReader_reads_an_empty_object)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, " \t\r\n{ } ");
+
+    ///act
+    bool isObject = JSONReader_BeginObject(&reader);
+    bool hasMember = JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_End(&reader);
+
+    ///assert
+    ASSERT_IS_TRUE(isObject);
+    ASSERT_IS_FALSE(hasMember);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_006: [ If the next value is not an object, JSONReader_BeginObject shall set JSON_READER_TYPE_MISMATCH and return false. ]*/
+TEST_FUNCTION(JSONReader_BeginObject_on_an_array_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "[1]");
+
+    ///act
+    bool isObject = JSONReader_BeginObject(&reader);
+
+    ///assert
+    ASSERT_IS_FALSE(isObject);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_008: [ Otherwise JSONReader_NextMember shall consume the ',' separating the members, the member name and the ':', set name and nameLength to the characters between the quotes of the name as they are in the JSON and return true. ]*/
+TEST_FUNCTION(JSONReader_NextMember_returns_the_names_in_order)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{ \"first\" : 1 , \"se\\\"cond\":2}");
+    (void)JSONReader_BeginObject(&reader);
+
+    ///act
+    bool hasFirst = JSONReader_NextMember(&reader, &name, &nameLength);
+    ASSERT_IS_TRUE(hasFirst);
+    ASSERT_ARE_EQUAL(size_t, 5, nameLength);
+    ASSERT_IS_TRUE(memcmp(name, "first", 5) == 0);
+    JSONReader_SkipValue(&reader);
+
+    bool hasSecond = JSONReader_NextMember(&reader, &name, &nameLength);
+    ASSERT_IS_TRUE(hasSecond);
+    ASSERT_ARE_EQUAL(size_t, 8, nameLength);
+    ASSERT_IS_TRUE(memcmp(name, "se\\\"cond", 8) == 0);
+    JSONReader_SkipValue(&reader);
+
+    bool hasThird = JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_End(&reader);
+
+    ///assert
+    ASSERT_IS_FALSE(hasThird);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_009: [ If the object is malformed, JSONReader_NextMember shall set JSON_READER_PARSE_ERROR and return false. ]*/
+TEST_FUNCTION(JSONReader_NextMember_with_a_missing_comma_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\":1 \"b\":2}");
+    (void)JSONReader_BeginObject(&reader);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_SkipValue(&reader);
+
+    ///act
+    bool hasMember = JSONReader_NextMember(&reader, &name, &nameLength);
+
+    ///assert
+    ASSERT_IS_FALSE(hasMember);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_009: [ If the object is malformed, JSONReader_NextMember shall set JSON_READER_PARSE_ERROR and return false. ]*/
+TEST_FUNCTION(JSONReader_NextMember_with_a_missing_colon_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\" 1}");
+    (void)JSONReader_BeginObject(&reader);
+
+    ///act
+    bool hasMember = JSONReader_NextMember(&reader, &name, &nameLength);
+
+    ///assert
+    ASSERT_IS_FALSE(hasMember);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_009: [ If the object is malformed, JSONReader_NextMember shall set JSON_READER_PARSE_ERROR and return false. ]*/
+TEST_FUNCTION(JSONReader_NextMember_with_a_trailing_comma_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\":1,}");
+    (void)JSONReader_BeginObject(&reader);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_SkipValue(&reader);
+
+    ///act
+    bool hasMember = JSONReader_NextMember(&reader, &name, &nameLength);
+
+    ///assert
+    ASSERT_IS_FALSE(hasMember);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_009: [ If the object is malformed, JSONReader_NextMember shall set JSON_READER_PARSE_ERROR and return false. ]*/
+TEST_FUNCTION(JSONReader_NextMember_on_truncated_text_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* name;
+    size_t nameLength;
+    /* the length stops the reader before the closing brace */
+    JSONReader_Init(&reader, "{\"a\":1}", 6);
+    (void)JSONReader_BeginObject(&reader);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_SkipValue(&reader);
+
+    ///act
+    bool hasMember = JSONReader_NextMember(&reader, &name, &nameLength);
+
+    ///assert
+    ASSERT_IS_FALSE(hasMember);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* JSONReader_SkipValue / JSONReader_End */
+
+/* Tests_SRS_JSON_READER_01_010: [ JSONReader_SkipValue shall consume the next value, of any type. ]*/
+TEST_FUNCTION(JSONReader_SkipValue_skips_nested_values)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "{\"a\":[1,-2.5e3,\"x\",true,false,null,{\"b\":[]},[[]]],\"c\":{}}");
+
+    ///act
+    JSONReader_SkipValue(&reader);
+    JSONReader_End(&reader);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(size_t, reader.length, reader.position);
+}
+
+/* Tests_SRS_JSON_READER_01_010: [ JSONReader_SkipValue shall consume the next value, of any type. ]*/
+TEST_FUNCTION(JSONReader_SkipValue_with_a_malformed_array_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "[1,,2]");
+
+    ///act
+    JSONReader_SkipValue(&reader);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_010: [ JSONReader_SkipValue shall consume the next value, of any type. ]*/
+TEST_FUNCTION(JSONReader_SkipValue_with_a_leading_zero_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "05");
+
+    ///act
+    JSONReader_SkipValue(&reader);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_011: [ JSONReader_End shall set JSON_READER_PARSE_ERROR if anything but white space follows the last value. ]*/
+TEST_FUNCTION(JSONReader_End_with_text_after_the_value_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    init_reader(&reader, "{} x");
+    JSONReader_SkipValue(&reader);
+
+    ///act
+    JSONReader_End(&reader);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* JSONReader_ReadString */
+
+/* Tests_SRS_JSON_READER_01_013: [ JSONReader_ReadString shall set value and valueLength to the characters between the quotes of the next string, as they are in the JSON. ]*/
+/* Tests_SRS_JSON_READER_01_012: [ Strings shall accept the escape sequences \", \\, \/, \b, \f, \n, \r and \t, any other escape sequence is a JSON_READER_PARSE_ERROR. ]*/
+TEST_FUNCTION(JSONReader_ReadString_returns_the_text_with_its_escapes)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* value = NULL;
+    size_t valueLength = 0;
+    const char* expected = "a\\\"\\\\\\/\\b\\f\\n\\r\\tz";
+    init_reader(&reader, "\"a\\\"\\\\\\/\\b\\f\\n\\r\\tz\"");
+
+    ///act
+    JSONReader_ReadString(&reader, &value, &valueLength);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(size_t, strlen(expected), valueLength);
+    ASSERT_IS_TRUE(memcmp(expected, value, valueLength) == 0);
+}
+
+/* Tests_SRS_JSON_READER_01_012: [ Strings shall accept the escape sequences \", \\, \/, \b, \f, \n, \r and \t, any other escape sequence is a JSON_READER_PARSE_ERROR. ]*/
+TEST_FUNCTION(JSONReader_ReadString_with_a_unicode_escape_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* value = NULL;
+    size_t valueLength = 0;
+    init_reader(&reader, "\"\\u0041\"");
+
+    ///act
+    JSONReader_ReadString(&reader, &value, &valueLength);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+    ASSERT_IS_NULL(value);
+}
+
+/* Tests_SRS_JSON_READER_01_012: [ Strings shall accept the escape sequences \", \\, \/, \b, \f, \n, \r and \t, any other escape sequence is a JSON_READER_PARSE_ERROR. ]*/
+TEST_FUNCTION(JSONReader_ReadString_without_the_closing_quote_sets_PARSE_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* value = NULL;
+    size_t valueLength = 0;
+    init_reader(&reader, "\"abc\\\"");
+
+    ///act
+    JSONReader_ReadString(&reader, &value, &valueLength);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_014: [ If the next value is not of the type a JSONReader_Read function reads, it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadString_on_a_number_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* value = NULL;
+    size_t valueLength = 0;
+    init_reader(&reader, "12");
+
+    ///act
+    JSONReader_ReadString(&reader, &value, &valueLength);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_014: [ If the next value is not of the type a JSONReader_Read function reads, it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadString_on_an_object_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    const char* value = NULL;
+    size_t valueLength = 0;
+    init_reader(&reader, "{\"a\":\"b\"}");
+
+    ///act
+    JSONReader_ReadString(&reader, &value, &valueLength);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+}
+
+/* JSONReader_ReadInt64 */
+
+/* Tests_SRS_JSON_READER_01_015: [ JSONReader_ReadInt64 shall read a number without fraction and exponent that is between minimum and maximum, otherwise it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadInt64_reads_the_int64_limits)
+{
+    ///arrange
+    JSON_READER reader;
+    int64_t smallest = 0;
+    int64_t largest = 0;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\":-9223372036854775808,\"b\":9223372036854775807}");
+    (void)JSONReader_BeginObject(&reader);
+
+    ///act
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadInt64(&reader, INT64_MIN, INT64_MAX, &smallest);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadInt64(&reader, INT64_MIN, INT64_MAX, &largest);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_IS_TRUE(smallest == INT64_MIN);
+    ASSERT_IS_TRUE(largest == INT64_MAX);
+}
+
+/* Tests_SRS_JSON_READER_01_015: [ JSONReader_ReadInt64 shall read a number without fraction and exponent that is between minimum and maximum, otherwise it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadInt64_past_int64_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    int64_t value = 7;
+    init_reader(&reader, "9223372036854775808");
+
+    ///act
+    JSONReader_ReadInt64(&reader, INT64_MIN, INT64_MAX, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+    ASSERT_IS_TRUE(value == 7);
+}
+
+/* Tests_SRS_JSON_READER_01_015: [ JSONReader_ReadInt64 shall read a number without fraction and exponent that is between minimum and maximum, otherwise it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadInt64_out_of_range_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    int64_t value = 7;
+    init_reader(&reader, "-129");
+
+    ///act
+    JSONReader_ReadInt64(&reader, -128, 127, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+    ASSERT_IS_TRUE(value == 7);
+}
+
+/* Tests_SRS_JSON_READER_01_015: [ JSONReader_ReadInt64 shall read a number without fraction and exponent that is between minimum and maximum, otherwise it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadInt64_with_a_fraction_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    int64_t value = 7;
+    init_reader(&reader, "5.0");
+
+    ///act
+    JSONReader_ReadInt64(&reader, INT64_MIN, INT64_MAX, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+}
+
+/* Tests_SRS_JSON_READER_01_014: [ If the next value is not of the type a JSONReader_Read function reads, it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadInt64_on_a_string_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    int64_t value = 7;
+    init_reader(&reader, "\"5\"");
+
+    ///act
+    JSONReader_ReadInt64(&reader, INT64_MIN, INT64_MAX, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+}
+
+/* JSONReader_ReadBool */
+
+/* Tests_SRS_JSON_READER_01_016: [ JSONReader_ReadBool shall read true or false. ]*/
+TEST_FUNCTION(JSONReader_ReadBool_reads_true_and_false)
+{
+    ///arrange
+    JSON_READER reader;
+    bool first = false;
+    bool second = true;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\":true,\"b\":false}");
+    (void)JSONReader_BeginObject(&reader);
+
+    ///act
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadBool(&reader, &first);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadBool(&reader, &second);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_IS_TRUE(first);
+    ASSERT_IS_FALSE(second);
+}
+
+/* Tests_SRS_JSON_READER_01_014: [ If the next value is not of the type a JSONReader_Read function reads, it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadBool_on_null_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    bool value = true;
+    init_reader(&reader, "null");
+
+    ///act
+    JSONReader_ReadBool(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+    ASSERT_IS_TRUE(value);
+}
+
+/* JSONReader_ReadDouble / JSONReader_ReadFloat */
+
+/* Tests_SRS_JSON_READER_01_017: [ JSONReader_ReadDouble and JSONReader_ReadFloat shall read a number or one of the strings "NaN", "INF" and "-INF". ]*/
+TEST_FUNCTION(JSONReader_ReadDouble_reads_a_number)
+{
+    ///arrange
+    JSON_READER reader;
+    double value = 0;
+    init_reader(&reader, "-1.25e2");
+
+    ///act
+    JSONReader_ReadDouble(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_IS_TRUE(value == -125.0);
+}
+
+/* Tests_SRS_JSON_READER_01_017: [ JSONReader_ReadDouble and JSONReader_ReadFloat shall read a number or one of the strings "NaN", "INF" and "-INF". ]*/
+TEST_FUNCTION(JSONReader_ReadDouble_reads_NaN_and_infinities)
+{
+    ///arrange
+    JSON_READER reader;
+    double notANumber = 0;
+    double plusInfinity = 0;
+    float minusInfinity = 0;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\":\"NaN\",\"b\":\"INF\",\"c\":\"-INF\"}");
+    (void)JSONReader_BeginObject(&reader);
+
+    ///act
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadDouble(&reader, &notANumber);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadDouble(&reader, &plusInfinity);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadFloat(&reader, &minusInfinity);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_IS_TRUE(isnan(notANumber));
+    ASSERT_IS_TRUE(isinf(plusInfinity) && (plusInfinity > 0));
+    ASSERT_IS_TRUE(isinf(minusInfinity) && (minusInfinity < 0));
+}
+
+/* Tests_SRS_JSON_READER_01_014: [ If the next value is not of the type a JSONReader_Read function reads, it shall set JSON_READER_TYPE_MISMATCH. ]*/
+TEST_FUNCTION(JSONReader_ReadFloat_on_another_string_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    float value = 1.0f;
+    init_reader(&reader, "\"1.5\"");
+
+    ///act
+    JSONReader_ReadFloat(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+    ASSERT_IS_TRUE(value == 1.0f);
+}
+
+/* JSONReader_ReadCharz / JSONReader_ReadCharzNoQuotes */
+
+/* Tests_SRS_JSON_READER_01_018: [ JSONReader_ReadCharz shall copy the characters between the quotes of the next string into *value, '\0' terminated, reusing *value when the string it holds is at least as long and reallocating it otherwise. ]*/
+TEST_FUNCTION(JSONReader_ReadCharz_allocates_the_string)
+{
+    ///arrange
+    JSON_READER reader;
+    char* value = NULL;
+    init_reader(&reader, "\"abc\"");
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 4));
+
+    ///act
+    JSONReader_ReadCharz(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(char_ptr, "abc", value);
+
+    ///cleanup
+    free(value);
+}
+
+/* Tests_SRS_JSON_READER_01_018: [ JSONReader_ReadCharz shall copy the characters between the quotes of the next string into *value, '\0' terminated, reusing *value when the string it holds is at least as long and reallocating it otherwise. ]*/
+TEST_FUNCTION(JSONReader_ReadCharz_reuses_a_long_enough_string)
+{
+    ///arrange
+    JSON_READER reader;
+    char* value = (char*)malloc(6);
+    char* previous = value;
+    (void)strcpy(value, "hello");
+    init_reader(&reader, "\"abc\"");
+    umock_c_reset_all_calls();
+
+    ///act
+    JSONReader_ReadCharz(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, previous, value);
+    ASSERT_ARE_EQUAL(char_ptr, "abc", value);
+
+    ///cleanup
+    free(value);
+}
+
+/* Tests_SRS_JSON_READER_01_018: [ JSONReader_ReadCharz shall copy the characters between the quotes of the next string into *value, '\0' terminated, reusing *value when the string it holds is at least as long and reallocating it otherwise. ]*/
+TEST_FUNCTION(JSONReader_ReadCharz_reallocates_a_shorter_string)
+{
+    ///arrange
+    JSON_READER reader;
+    char* value = (char*)malloc(2);
+    (void)strcpy(value, "a");
+    init_reader(&reader, "\"abc\"");
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 4))
+        .IgnoreArgument_ptr();
+
+    ///act
+    JSONReader_ReadCharz(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "abc", value);
+
+    ///cleanup
+    free(value);
+}
+
+/* Tests_SRS_JSON_READER_01_020: [ If allocating memory fails, the JSONReader_Read functions shall set JSON_READER_ERROR and leave value unchanged. ]*/
+TEST_FUNCTION(JSONReader_ReadCharz_when_realloc_fails_sets_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    char* value = (char*)malloc(2);
+    char* previous = value;
+    (void)strcpy(value, "a");
+    init_reader(&reader, "\"abc\"");
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 4))
+        .IgnoreArgument_ptr()
+        .SetReturn(NULL);
+
+    ///act
+    JSONReader_ReadCharz(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_ERROR, reader.result);
+    ASSERT_ARE_EQUAL(void_ptr, previous, value);
+    ASSERT_ARE_EQUAL(char_ptr, "a", value);
+
+    ///cleanup
+    free(value);
+}
+
+/* Tests_SRS_JSON_READER_01_019: [ JSONReader_ReadCharzNoQuotes shall copy the text of the next string, number, true, false or null, with the quotes of a string, into *value in the same way. ]*/
+TEST_FUNCTION(JSONReader_ReadCharzNoQuotes_copies_the_raw_text)
+{
+    ///arrange
+    JSON_READER reader;
+    char* number = NULL;
+    char* text = NULL;
+    const char* name;
+    size_t nameLength;
+    init_reader(&reader, "{\"a\":12.5e3,\"b\":\"q\"}");
+    (void)JSONReader_BeginObject(&reader);
+
+    ///act
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadCharzNoQuotes(&reader, &number);
+    (void)JSONReader_NextMember(&reader, &name, &nameLength);
+    JSONReader_ReadCharzNoQuotes(&reader, &text);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(char_ptr, "12.5e3", number);
+    ASSERT_ARE_EQUAL(char_ptr, "\"q\"", text);
+
+    ///cleanup
+    free(number);
+    free(text);
+}
+
+/* JSONReader_ReadDateTimeOffset / JSONReader_ReadGuid */
+
+/* Tests_SRS_JSON_READER_01_021: [ JSONReader_ReadDateTimeOffset and JSONReader_ReadGuid shall accept the strings CreateAgentDataType_From_String accepts for EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE. ]*/
+TEST_FUNCTION(JSONReader_ReadDateTimeOffset_parses_the_quoted_string)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_DATE_TIME_OFFSET value;
+    (void)memset(&value, 0, sizeof(value));
+    init_reader(&reader, "\"2014-02-03T04:05:06Z\"");
+
+    STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("\"2014-02-03T04:05:06Z\"", EDM_DATE_TIME_OFFSET_TYPE, IGNORED_PTR_ARG))
+        .IgnoreArgument_agentData();
+
+    ///act
+    JSONReader_ReadDateTimeOffset(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(char_ptr, "\"2014-02-03T04:05:06Z\"", lastSource);
+    ASSERT_ARE_EQUAL(int, 114, value.dateTime.tm_year);
+}
+
+/* Tests_SRS_JSON_READER_01_021: [ JSONReader_ReadDateTimeOffset and JSONReader_ReadGuid shall accept the strings CreateAgentDataType_From_String accepts for EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE. ]*/
+TEST_FUNCTION(JSONReader_ReadGuid_parses_the_quoted_string)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_GUID value;
+    (void)memset(&value, 0, sizeof(value));
+    init_reader(&reader, "\"00112233-4455-6677-8899-AABBCCDDEEFF\"");
+
+    STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("\"00112233-4455-6677-8899-AABBCCDDEEFF\"", EDM_GUID_TYPE, IGNORED_PTR_ARG))
+        .IgnoreArgument_agentData();
+
+    ///act
+    JSONReader_ReadGuid(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(int, 0x42, value.GUID[0]);
+}
+
+/* Tests_SRS_JSON_READER_01_021: [ JSONReader_ReadDateTimeOffset and JSONReader_ReadGuid shall accept the strings CreateAgentDataType_From_String accepts for EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE. ]*/
+TEST_FUNCTION(JSONReader_ReadGuid_with_a_rejected_string_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_GUID value;
+    (void)memset(&value, 0, sizeof(value));
+    init_reader(&reader, "\"bad\"");
+
+    ///act
+    JSONReader_ReadGuid(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+    ASSERT_ARE_EQUAL(int, 0, value.GUID[0]);
+}
+
+/* JSONReader_ReadBinary */
+
+/* Tests_SRS_JSON_READER_01_022: [ JSONReader_ReadBinary shall decode the next string as base64url the way CreateAgentDataType_From_String does, reusing value->data when value->size is at least the decoded size and reallocating it otherwise. ]*/
+TEST_FUNCTION(JSONReader_ReadBinary_decodes_base64url)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_BINARY value = { 0, NULL };
+    init_reader(&reader, "\"AQID-_8\"");
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 5));
+
+    ///act
+    JSONReader_ReadBinary(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(size_t, 5, value.size);
+    ASSERT_IS_TRUE(memcmp("\x01\x02\x03\xFB\xFF", value.data, 5) == 0);
+
+    ///cleanup
+    free(value.data);
+}
+
+/* Tests_SRS_JSON_READER_01_022: [ JSONReader_ReadBinary shall decode the next string as base64url the way CreateAgentDataType_From_String does, reusing value->data when value->size is at least the decoded size and reallocating it otherwise. ]*/
+TEST_FUNCTION(JSONReader_ReadBinary_reuses_a_large_enough_buffer)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_BINARY value;
+    unsigned char* previous;
+    value.size = 4;
+    value.data = (unsigned char*)malloc(4);
+    previous = value.data;
+    init_reader(&reader, "\"AQ==\"");
+    umock_c_reset_all_calls();
+
+    ///act
+    JSONReader_ReadBinary(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, reader.result);
+    ASSERT_ARE_EQUAL(void_ptr, previous, value.data);
+    ASSERT_ARE_EQUAL(size_t, 1, value.size);
+    ASSERT_ARE_EQUAL(int, 1, value.data[0]);
+
+    ///cleanup
+    free(value.data);
+}
+
+/* Tests_SRS_JSON_READER_01_022: [ JSONReader_ReadBinary shall decode the next string as base64url the way CreateAgentDataType_From_String does, reusing value->data when value->size is at least the decoded size and reallocating it otherwise. ]*/
+TEST_FUNCTION(JSONReader_ReadBinary_with_a_bad_tail_sets_TYPE_MISMATCH)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_BINARY value = { 0, NULL };
+    /* the last character of a 2 character tail has to be one of AQgw */
+    init_reader(&reader, "\"AQIDBB==\"");
+
+    ///act
+    JSONReader_ReadBinary(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_TYPE_MISMATCH, reader.result);
+    ASSERT_IS_NULL(value.data);
+}
+
+/* Tests_SRS_JSON_READER_01_020: [ If allocating memory fails, the JSONReader_Read functions shall set JSON_READER_ERROR and leave value unchanged. ]*/
+TEST_FUNCTION(JSONReader_ReadBinary_when_realloc_fails_sets_ERROR)
+{
+    ///arrange
+    JSON_READER reader;
+    EDM_BINARY value = { 0, NULL };
+    init_reader(&reader, "\"AQID\"");
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 3))
+        .SetReturn(NULL);
+
+    ///act
+    JSONReader_ReadBinary(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_ERROR, reader.result);
+    ASSERT_ARE_EQUAL(size_t, 0, value.size);
+    ASSERT_IS_NULL(value.data);
+}
+
+/* JSONReader_SortMembers */
+
+/* Tests_SRS_JSON_READER_01_023: [ If memberIndex is not sorted yet, JSONReader_SortMembers shall sort its members by name length and then by name and mark it as sorted, otherwise it shall leave memberIndex unchanged. ]*/
+TEST_FUNCTION(JSONReader_SortMembers_sorts_by_name_length_and_then_by_name)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { "speed", 5, 1 }, { "b", 1, 2 }, { "a", 1, 3 }, { "heading", 7, 4 }, { "zz", 2, 5 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, sizeof(members) / sizeof(members[0]), false };
+
+    ///act
+    JSONReader_SortMembers(&memberIndex);
+
+    ///assert
+    ASSERT_IS_TRUE(memberIndex.isSorted);
+    ASSERT_ARE_EQUAL(size_t, 3, members[0].id);
+    ASSERT_ARE_EQUAL(size_t, 2, members[1].id);
+    ASSERT_ARE_EQUAL(size_t, 5, members[2].id);
+    ASSERT_ARE_EQUAL(size_t, 1, members[3].id);
+    ASSERT_ARE_EQUAL(size_t, 4, members[4].id);
+}
+
+/* Tests_SRS_JSON_READER_01_023: [ If memberIndex is not sorted yet, JSONReader_SortMembers shall sort its members by name length and then by name and mark it as sorted, otherwise it shall leave memberIndex unchanged. ]*/
+TEST_FUNCTION(JSONReader_SortMembers_leaves_a_sorted_index_unchanged)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { "b", 1, 1 }, { "a", 1, 2 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, sizeof(members) / sizeof(members[0]), true };
+
+    ///act
+    JSONReader_SortMembers(&memberIndex);
+
+    ///assert
+    ASSERT_IS_TRUE(memberIndex.isSorted);
+    ASSERT_ARE_EQUAL(size_t, 1, members[0].id);
+    ASSERT_ARE_EQUAL(size_t, 2, members[1].id);
+}
+
+/* Tests_SRS_JSON_READER_01_026: [ If memberIndex is NULL, JSONReader_SortMembers shall return. ]*/
+TEST_FUNCTION(JSONReader_SortMembers_with_NULL_memberIndex_returns)
+{
+    ///act
+    JSONReader_SortMembers(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* JSONReader_FindMember */
+
+/* Tests_SRS_JSON_READER_01_024: [ If memberIndex is sorted, JSONReader_FindMember shall find the member named name by binary search and return its id, or 0 when there is no such member. ]*/
+TEST_FUNCTION(JSONReader_FindMember_finds_every_member)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { "speed", 5, 1 }, { "b", 1, 2 }, { "a", 1, 3 }, { "heading", 7, 4 }, { "zz", 2, 5 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, sizeof(members) / sizeof(members[0]), false };
+    JSONReader_SortMembers(&memberIndex);
+
+    ///act
+    size_t speed = JSONReader_FindMember(&memberIndex, "speed", 5);
+    size_t b = JSONReader_FindMember(&memberIndex, "b", 1);
+    size_t a = JSONReader_FindMember(&memberIndex, "a", 1);
+    size_t heading = JSONReader_FindMember(&memberIndex, "heading\"", 7);
+    size_t zz = JSONReader_FindMember(&memberIndex, "zz", 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, speed);
+    ASSERT_ARE_EQUAL(size_t, 2, b);
+    ASSERT_ARE_EQUAL(size_t, 3, a);
+    ASSERT_ARE_EQUAL(size_t, 4, heading);
+    ASSERT_ARE_EQUAL(size_t, 5, zz);
+}
+
+/* Tests_SRS_JSON_READER_01_024: [ If memberIndex is sorted, JSONReader_FindMember shall find the member named name by binary search and return its id, or 0 when there is no such member. ]*/
+TEST_FUNCTION(JSONReader_FindMember_returns_0_for_an_unknown_name)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { "speed", 5, 1 }, { "a", 1, 2 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, sizeof(members) / sizeof(members[0]), false };
+    JSONReader_SortMembers(&memberIndex);
+
+    ///act
+    size_t spee = JSONReader_FindMember(&memberIndex, "spee", 4);
+    size_t speeds = JSONReader_FindMember(&memberIndex, "speeds", 6);
+    size_t empty = JSONReader_FindMember(&memberIndex, "", 0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, spee);
+    ASSERT_ARE_EQUAL(size_t, 0, speeds);
+    ASSERT_ARE_EQUAL(size_t, 0, empty);
+}
+
+/* Tests_SRS_JSON_READER_01_024: [ If memberIndex is sorted, JSONReader_FindMember shall find the member named name by binary search and return its id, or 0 when there is no such member. ]*/
+TEST_FUNCTION(JSONReader_FindMember_in_an_empty_index_returns_0)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { NULL, 0, 0 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, 0, true };
+
+    ///act
+    size_t result = JSONReader_FindMember(&memberIndex, "a", 1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+}
+
+/* Tests_SRS_JSON_READER_01_027: [ If memberIndex is not sorted, JSONReader_FindMember shall find the member named name by comparing it with every member. ]*/
+TEST_FUNCTION(JSONReader_FindMember_in_an_unsorted_index_finds_the_member_and_does_not_sort_the_index)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { "speed", 5, 1 }, { "b", 1, 2 }, { "a", 1, 3 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, sizeof(members) / sizeof(members[0]), false };
+
+    ///act
+    size_t a = JSONReader_FindMember(&memberIndex, "a", 1);
+    size_t speed = JSONReader_FindMember(&memberIndex, "speed", 5);
+    size_t unknown = JSONReader_FindMember(&memberIndex, "c", 1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 3, a);
+    ASSERT_ARE_EQUAL(size_t, 1, speed);
+    ASSERT_ARE_EQUAL(size_t, 0, unknown);
+    ASSERT_IS_FALSE(memberIndex.isSorted);
+    ASSERT_ARE_EQUAL(size_t, 1, members[0].id);
+}
+
+/* Tests_SRS_JSON_READER_01_025: [ If memberIndex or name is NULL, JSONReader_FindMember shall return 0. ]*/
+TEST_FUNCTION(JSONReader_FindMember_with_NULL_arguments_returns_0)
+{
+    ///arrange
+    JSON_READER_MEMBER members[] = { { "a", 1, 1 } };
+    JSON_READER_MEMBER_INDEX memberIndex = { members, 1, true };
+
+    ///act
+    size_t withNullIndex = JSONReader_FindMember(NULL, "a", 1);
+    size_t withNullName = JSONReader_FindMember(&memberIndex, NULL, 1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, withNullIndex);
+    ASSERT_ARE_EQUAL(size_t, 0, withNullName);
+}
+
+END_TEST_SUITE(jsonreader_ut)
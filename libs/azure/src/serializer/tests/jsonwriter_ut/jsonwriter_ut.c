@@ -0,0 +1,686 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* s)
+{
+    free(s);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+
+#include "jsonwriter.h"
+#include "testrunnerswitcher.h"
+
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+TEST_DEFINE_ENUM_TYPE(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+static unsigned char testBuffer[256];
+
+/* writes {"a":value} */
+static void write_test_object(JSON_WRITER* writer, const void* value)
+{
+    JSONWriter_AppendRaw(writer, "{", 1);
+    JSONWriter_AppendMemberName(writer, 0, "a", 1);
+    JSONWriter_AppendString(writer, (const char*)value);
+    JSONWriter_AppendRaw(writer, "}", 1);
+}
+
+static void assert_written(const JSON_WRITER* writer, const char* expected)
+{
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, writer->result);
+    ASSERT_ARE_EQUAL(size_t, strlen(expected), writer->length);
+    ASSERT_IS_TRUE(memcmp(expected, writer->buffer, writer->length) == 0);
+}
+
+BEGIN_TEST_SUITE(jsonwriter_ut)
+
+TEST_SUITE_INITIALIZE(TestSuiteInitialize)
+{
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(Setup)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    (void)memset(testBuffer, 0, sizeof(testBuffer));
+}
+
+TEST_FUNCTION_CLEANUP(Cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* JSONWriter_Init */
+
+/* Tests_SRS_JSON_WRITER_01_001: [ JSONWriter_Init shall set the writer to write at most bufferSize bytes at buffer, with length 0 and result JSON_WRITER_OK. ]*/
+TEST_FUNCTION(JSONWriter_Init_sets_the_buffer)
+{
+    ///arrange
+    JSON_WRITER writer;
+
+    ///act
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///assert
+    ASSERT_ARE_EQUAL(void_ptr, testBuffer, writer.buffer);
+    ASSERT_ARE_EQUAL(size_t, sizeof(testBuffer), writer.bufferSize);
+    ASSERT_ARE_EQUAL(size_t, 0, writer.length);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, writer.result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_JSON_WRITER_01_002: [ If buffer is NULL, the writer shall only count the bytes. ]*/
+TEST_FUNCTION(JSONWriter_with_a_NULL_buffer_only_counts)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, NULL, 100);
+
+    ///act
+    JSONWriter_AppendRaw(&writer, "{}", 2);
+    JSONWriter_AppendInt64(&writer, 12345);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, writer.result);
+    ASSERT_ARE_EQUAL(size_t, 7, writer.length);
+    ASSERT_ARE_EQUAL(size_t, 0, writer.bufferSize);
+}
+
+/* JSONWriter_AppendRaw */
+
+/* Tests_SRS_JSON_WRITER_01_004: [ JSONWriter_AppendRaw shall copy the length bytes of text at the current length when they fit in the buffer, and add length to the length of the writer in all cases. ]*/
+TEST_FUNCTION(JSONWriter_AppendRaw_appends_the_text)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendRaw(&writer, "{", 1);
+    JSONWriter_AppendRaw(&writer, "}", 1);
+
+    ///assert
+    assert_written(&writer, "{}");
+}
+
+/* Tests_SRS_JSON_WRITER_01_004: [ JSONWriter_AppendRaw shall copy the length bytes of text at the current length when they fit in the buffer, and add length to the length of the writer in all cases. ]*/
+TEST_FUNCTION(JSONWriter_AppendRaw_does_not_write_past_the_buffer_but_counts)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, 4);
+
+    ///act
+    JSONWriter_AppendRaw(&writer, "abc", 3);
+    JSONWriter_AppendRaw(&writer, "de", 2);
+    JSONWriter_AppendRaw(&writer, "f", 1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, writer.result);
+    ASSERT_ARE_EQUAL(size_t, 6, writer.length);
+    ASSERT_IS_TRUE(memcmp("abc", testBuffer, 3) == 0);
+    ASSERT_ARE_EQUAL(int, 0, testBuffer[3]);
+}
+
+/* Tests_SRS_JSON_WRITER_01_003: [ If writer is NULL or its result is not JSON_WRITER_OK, the JSONWriter_Append functions shall do nothing. ]*/
+TEST_FUNCTION(JSONWriter_Append_functions_do_nothing_after_an_error)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+    JSONWriter_AppendString(&writer, NULL);
+
+    ///act
+    JSONWriter_AppendRaw(&writer, "{", 1);
+    JSONWriter_AppendMemberName(&writer, 0, "a", 1);
+    JSONWriter_AppendInt64(&writer, 1);
+    JSONWriter_AppendBool(&writer, true);
+    JSONWriter_AppendDouble(&writer, 1.0);
+    JSONWriter_AppendString(&writer, "a");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+    ASSERT_ARE_EQUAL(size_t, 0, writer.length);
+}
+
+/* Tests_SRS_JSON_WRITER_01_003: [ If writer is NULL or its result is not JSON_WRITER_OK, the JSONWriter_Append functions shall do nothing. ]*/
+TEST_FUNCTION(JSONWriter_Append_functions_with_NULL_writer_do_nothing)
+{
+    ///arrange
+
+    ///act
+    JSONWriter_AppendRaw(NULL, "{", 1);
+    JSONWriter_AppendInt64(NULL, 1);
+    JSONWriter_AppendString(NULL, "a");
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* JSONWriter_AppendMemberName */
+
+/* Tests_SRS_JSON_WRITER_01_005: [ If memberIndex is not 0, JSONWriter_AppendMemberName shall first append ", ". ]*/
+/* Tests_SRS_JSON_WRITER_01_006: [ JSONWriter_AppendMemberName shall append the nameLength characters of name between quotes, followed by ':'. ]*/
+TEST_FUNCTION(JSONWriter_AppendMemberName_separates_the_members)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendMemberName(&writer, 0, "first", 5);
+    JSONWriter_AppendInt64(&writer, 1);
+    JSONWriter_AppendMemberName(&writer, 1, "second", 6);
+    JSONWriter_AppendInt64(&writer, 2);
+
+    ///assert
+    assert_written(&writer, "\"first\":1, \"second\":2");
+}
+
+/* JSONWriter_AppendInt64 */
+
+/* Tests_SRS_JSON_WRITER_01_007: [ JSONWriter_AppendInt64 shall append value in decimal, preceded by '-' when it is negative. ]*/
+TEST_FUNCTION(JSONWriter_AppendInt64_appends_decimal_values)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendInt64(&writer, 0);
+    JSONWriter_AppendRaw(&writer, " ", 1);
+    JSONWriter_AppendInt64(&writer, -42);
+    JSONWriter_AppendRaw(&writer, " ", 1);
+    JSONWriter_AppendInt64(&writer, INT64_MAX);
+    JSONWriter_AppendRaw(&writer, " ", 1);
+    JSONWriter_AppendInt64(&writer, INT64_MIN);
+
+    ///assert
+    assert_written(&writer, "0 -42 9223372036854775807 -9223372036854775808");
+}
+
+/* JSONWriter_AppendBool */
+
+/* Tests_SRS_JSON_WRITER_01_008: [ JSONWriter_AppendBool shall append true or false. ]*/
+TEST_FUNCTION(JSONWriter_AppendBool_appends_true_and_false)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendBool(&writer, true);
+    JSONWriter_AppendBool(&writer, false);
+
+    ///assert
+    assert_written(&writer, "truefalse");
+}
+
+/* JSONWriter_AppendDouble / JSONWriter_AppendFloat */
+
+/* Tests_SRS_JSON_WRITER_01_010: [ Other values shall be appended as printed by "%.*f" with DBL_DIG decimals for JSONWriter_AppendDouble and FLT_DIG decimals for JSONWriter_AppendFloat. ]*/
+TEST_FUNCTION(JSONWriter_AppendDouble_and_AppendFloat_print_DBL_DIG_and_FLT_DIG_decimals)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendDouble(&writer, -1.5);
+    JSONWriter_AppendRaw(&writer, " ", 1);
+    JSONWriter_AppendFloat(&writer, 3.5f);
+
+    ///assert
+    assert_written(&writer, "-1.500000000000000 3.500000");
+}
+
+/* Tests_SRS_JSON_WRITER_01_009: [ NaN, negative and positive infinity shall be appended as NaN, -INF and INF. ]*/
+TEST_FUNCTION(JSONWriter_AppendDouble_appends_NaN_and_infinities)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendDouble(&writer, NAN);
+    JSONWriter_AppendRaw(&writer, " ", 1);
+    JSONWriter_AppendDouble(&writer, -INFINITY);
+    JSONWriter_AppendRaw(&writer, " ", 1);
+    JSONWriter_AppendFloat(&writer, INFINITY);
+
+    ///assert
+    assert_written(&writer, "NaN -INF INF");
+}
+
+/* JSONWriter_AppendString */
+
+/* Tests_SRS_JSON_WRITER_01_014: [ JSONWriter_AppendString shall append value between quotes, with the characters up to 0x1F written as \u00XX and '"', '\' and '/' preceded by '\'. ]*/
+TEST_FUNCTION(JSONWriter_AppendString_escapes_the_string)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendString(&writer, "a\"b\\c/d\x01\x1F" "e");
+
+    ///assert
+    assert_written(&writer, "\"a\\\"b\\\\c\\/d\\u0001\\u001Fe\"");
+}
+
+/* Tests_SRS_JSON_WRITER_01_014: [ JSONWriter_AppendString shall append value between quotes, with the characters up to 0x1F written as \u00XX and '"', '\' and '/' preceded by '\'. ]*/
+TEST_FUNCTION(JSONWriter_AppendString_with_an_empty_string_appends_2_quotes)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendString(&writer, "");
+
+    ///assert
+    assert_written(&writer, "\"\"");
+}
+
+/* Tests_SRS_JSON_WRITER_01_012: [ If value is NULL, JSONWriter_AppendString shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendString_with_NULL_value_fails)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendString(&writer, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+}
+
+/* Tests_SRS_JSON_WRITER_01_013: [ If value has a character above 127, JSONWriter_AppendString shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendString_with_a_character_above_127_fails)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendString(&writer, "caf\xC3\xA9");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+}
+
+/* JSONWriter_AppendStringNoQuotes */
+
+/* Tests_SRS_JSON_WRITER_01_016: [ JSONWriter_AppendStringNoQuotes shall append value as it is. ]*/
+TEST_FUNCTION(JSONWriter_AppendStringNoQuotes_appends_the_string_as_it_is)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendStringNoQuotes(&writer, "[1, \"x\"]");
+
+    ///assert
+    assert_written(&writer, "[1, \"x\"]");
+}
+
+/* Tests_SRS_JSON_WRITER_01_015: [ If value is NULL, JSONWriter_AppendStringNoQuotes shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendStringNoQuotes_with_NULL_value_fails)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendStringNoQuotes(&writer, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+}
+
+/* JSONWriter_AppendDateTimeOffset */
+
+/* Tests_SRS_JSON_WRITER_01_018: [ JSONWriter_AppendDateTimeOffset shall append value between quotes as YYYY-MM-DDThh:mm:ss, followed by .ffffffffffff when it has fractional seconds, and by +hh:mm when it has a time zone or by Z otherwise. ]*/
+TEST_FUNCTION(JSONWriter_AppendDateTimeOffset_without_time_zone_and_fractional_seconds)
+{
+    ///arrange
+    JSON_WRITER writer;
+    EDM_DATE_TIME_OFFSET value;
+    (void)memset(&value, 0, sizeof(value));
+    value.dateTime.tm_year = 2017 - 1900;
+    value.dateTime.tm_mon = 11 - 1;
+    value.dateTime.tm_mday = 2;
+    value.dateTime.tm_hour = 13;
+    value.dateTime.tm_min = 4;
+    value.dateTime.tm_sec = 5;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendDateTimeOffset(&writer, &value);
+
+    ///assert
+    assert_written(&writer, "\"2017-11-02T13:04:05Z\"");
+}
+
+/* Tests_SRS_JSON_WRITER_01_018: [ JSONWriter_AppendDateTimeOffset shall append value between quotes as YYYY-MM-DDThh:mm:ss, followed by .ffffffffffff when it has fractional seconds, and by +hh:mm when it has a time zone or by Z otherwise. ]*/
+TEST_FUNCTION(JSONWriter_AppendDateTimeOffset_with_time_zone_and_fractional_seconds)
+{
+    ///arrange
+    JSON_WRITER writer;
+    EDM_DATE_TIME_OFFSET value;
+    (void)memset(&value, 0, sizeof(value));
+    value.dateTime.tm_year = 2017 - 1900;
+    value.dateTime.tm_mon = 11 - 1;
+    value.dateTime.tm_mday = 2;
+    value.dateTime.tm_hour = 13;
+    value.dateTime.tm_min = 4;
+    value.dateTime.tm_sec = 5;
+    value.hasFractionalSecond = 1;
+    value.fractionalSecond = 123;
+    value.hasTimeZone = 1;
+    value.timeZoneHour = -8;
+    value.timeZoneMinute = 30;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendDateTimeOffset(&writer, &value);
+
+    ///assert
+    assert_written(&writer, "\"2017-11-02T13:04:05.000000000123-08:30\"");
+}
+
+/* Tests_SRS_JSON_WRITER_01_017: [ If value is NULL, JSONWriter_AppendDateTimeOffset shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendDateTimeOffset_with_NULL_value_fails)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendDateTimeOffset(&writer, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+}
+
+/* JSONWriter_AppendGuid */
+
+/* Tests_SRS_JSON_WRITER_01_020: [ JSONWriter_AppendGuid shall append value between quotes as 8HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 12HEXDIG, with upper case hex digits. ]*/
+TEST_FUNCTION(JSONWriter_AppendGuid_appends_the_guid)
+{
+    ///arrange
+    JSON_WRITER writer;
+    EDM_GUID value = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF } };
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendGuid(&writer, &value);
+
+    ///assert
+    assert_written(&writer, "\"00112233-4455-6677-8899-AABBCCDDEEFF\"");
+}
+
+/* Tests_SRS_JSON_WRITER_01_019: [ If value is NULL, JSONWriter_AppendGuid shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendGuid_with_NULL_value_fails)
+{
+    ///arrange
+    JSON_WRITER writer;
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendGuid(&writer, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+}
+
+/* JSONWriter_AppendBinary */
+
+/* Tests_SRS_JSON_WRITER_01_022: [ JSONWriter_AppendBinary shall append the base64 encoding of value between quotes, with '-' and '_' as the 62nd and 63rd characters and '=' padding. ]*/
+TEST_FUNCTION(JSONWriter_AppendBinary_appends_base64_with_padding)
+{
+    ///arrange
+    JSON_WRITER writer;
+    unsigned char data[] = { 0xFB, 0xFF, 0xBF, 0x01, 0x02 };
+    EDM_BINARY value3 = { 3, data };
+    EDM_BINARY value1 = { 1, data + 3 };
+    EDM_BINARY value5 = { 5, data };
+    EDM_BINARY value0 = { 0, NULL };
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendBinary(&writer, &value3);
+    JSONWriter_AppendBinary(&writer, &value1);
+    JSONWriter_AppendBinary(&writer, &value5);
+    JSONWriter_AppendBinary(&writer, &value0);
+
+    ///assert
+    assert_written(&writer, "\"-_-_\"\"AQ==\"\"-_-_AQI=\"\"\"");
+}
+
+/* Tests_SRS_JSON_WRITER_01_021: [ If value is NULL, or its data is NULL while its size is not 0, JSONWriter_AppendBinary shall set the result of the writer to JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendBinary_with_NULL_data_fails)
+{
+    ///arrange
+    JSON_WRITER writer;
+    EDM_BINARY value = { 2, NULL };
+    JSONWriter_Init(&writer, testBuffer, sizeof(testBuffer));
+
+    ///act
+    JSONWriter_AppendBinary(&writer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, writer.result);
+}
+
+/* JSONWriter_Encode */
+
+/* Tests_SRS_JSON_WRITER_01_023: [ If destination, destinationSize, valueFunc or value is NULL, JSONWriter_Encode shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_Encode_with_NULL_arguments_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    size_t destinationSize;
+
+    ///act
+    JSON_WRITER_RESULT result1 = JSONWriter_Encode(NULL, &destinationSize, write_test_object, "x");
+    JSON_WRITER_RESULT result2 = JSONWriter_Encode(&destination, NULL, write_test_object, "x");
+    JSON_WRITER_RESULT result3 = JSONWriter_Encode(&destination, &destinationSize, NULL, "x");
+    JSON_WRITER_RESULT result4 = JSONWriter_Encode(&destination, &destinationSize, write_test_object, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result4);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_JSON_WRITER_01_024: [ JSONWriter_Encode shall call valueFunc with a writer that has no buffer to measure the JSON. ]*/
+/* Tests_SRS_JSON_WRITER_01_026: [ JSONWriter_Encode shall allocate exactly as many bytes as measured. ]*/
+/* Tests_SRS_JSON_WRITER_01_028: [ JSONWriter_Encode shall call valueFunc again with a writer on the allocated buffer. ]*/
+/* Tests_SRS_JSON_WRITER_01_030: [ On success JSONWriter_Encode shall set *destination to the buffer, which is not '\0' terminated, and *destinationSize to its length, and return JSON_WRITER_OK. ]*/
+TEST_FUNCTION(JSONWriter_Encode_allocates_the_measured_size_and_writes_the_JSON)
+{
+    ///arrange
+    unsigned char* destination = NULL;
+    size_t destinationSize = 0;
+    JSON_WRITER_RESULT result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("{\"a\":\"x\"}") - 1));
+
+    ///act
+    result = JSONWriter_Encode(&destination, &destinationSize, write_test_object, "x");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, sizeof("{\"a\":\"x\"}") - 1, destinationSize);
+    ASSERT_IS_TRUE(memcmp("{\"a\":\"x\"}", destination, destinationSize) == 0);
+
+    ///cleanup
+    my_gballoc_free(destination);
+}
+
+/* Tests_SRS_JSON_WRITER_01_025: [ If the measuring fails, JSONWriter_Encode shall fail and return the result of the writer. ]*/
+TEST_FUNCTION(JSONWriter_Encode_fails_without_allocating_when_the_value_cannot_be_written)
+{
+    ///arrange
+    unsigned char* destination = NULL;
+    size_t destinationSize = 0;
+    JSON_WRITER_RESULT result;
+
+    ///act
+    result = JSONWriter_Encode(&destination, &destinationSize, write_test_object, "\xFF");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(destination);
+}
+
+/* Tests_SRS_JSON_WRITER_01_027: [ If the allocation fails, JSONWriter_Encode shall fail and return JSON_WRITER_ERROR. ]*/
+TEST_FUNCTION(when_allocating_fails_JSONWriter_Encode_fails)
+{
+    ///arrange
+    unsigned char* destination = NULL;
+    size_t destinationSize = 0;
+    JSON_WRITER_RESULT result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size()
+        .SetReturn(NULL);
+
+    ///act
+    result = JSONWriter_Encode(&destination, &destinationSize, write_test_object, "x");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(destination);
+}
+
+/* JSONWriter_EncodeToBuffer */
+
+/* Tests_SRS_JSON_WRITER_01_031: [ If length, valueFunc or value is NULL, or buffer is NULL while bufferSize is not 0, JSONWriter_EncodeToBuffer shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_EncodeToBuffer_with_NULL_arguments_fails)
+{
+    ///arrange
+    size_t length;
+
+    ///act
+    JSON_WRITER_RESULT result1 = JSONWriter_EncodeToBuffer(testBuffer, sizeof(testBuffer), NULL, write_test_object, "x");
+    JSON_WRITER_RESULT result2 = JSONWriter_EncodeToBuffer(testBuffer, sizeof(testBuffer), &length, NULL, "x");
+    JSON_WRITER_RESULT result3 = JSONWriter_EncodeToBuffer(testBuffer, sizeof(testBuffer), &length, write_test_object, NULL);
+    JSON_WRITER_RESULT result4 = JSONWriter_EncodeToBuffer(NULL, 1, &length, write_test_object, "x");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result4);
+}
+
+/* Tests_SRS_JSON_WRITER_01_032: [ JSONWriter_EncodeToBuffer shall call valueFunc once with a writer on buffer. ]*/
+/* Tests_SRS_JSON_WRITER_01_034: [ JSONWriter_EncodeToBuffer shall set *length to the length of the JSON, which is not '\0' terminated. ]*/
+/* Tests_SRS_JSON_WRITER_01_036: [ Otherwise JSONWriter_EncodeToBuffer shall return JSON_WRITER_OK. ]*/
+TEST_FUNCTION(JSONWriter_EncodeToBuffer_writes_the_JSON_without_allocating)
+{
+    ///arrange
+    size_t length = 0;
+    JSON_WRITER_RESULT result;
+
+    ///act
+    result = JSONWriter_EncodeToBuffer(testBuffer, sizeof(testBuffer), &length, write_test_object, "x");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, sizeof("{\"a\":\"x\"}") - 1, length);
+    ASSERT_IS_TRUE(memcmp("{\"a\":\"x\"}", testBuffer, length) == 0);
+}
+
+/* Tests_SRS_JSON_WRITER_01_035: [ If the JSON does not fit in bufferSize bytes, JSONWriter_EncodeToBuffer shall return JSON_WRITER_BUFFER_TOO_SMALL. ]*/
+TEST_FUNCTION(JSONWriter_EncodeToBuffer_with_a_small_buffer_returns_the_size_needed)
+{
+    ///arrange
+    size_t length = 0;
+    JSON_WRITER_RESULT result;
+
+    ///act
+    result = JSONWriter_EncodeToBuffer(testBuffer, 4, &length, write_test_object, "x");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_BUFFER_TOO_SMALL, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof("{\"a\":\"x\"}") - 1, length);
+    ASSERT_ARE_EQUAL(int, 0, testBuffer[4]);
+}
+
+/* Tests_SRS_JSON_WRITER_01_033: [ If writing fails, JSONWriter_EncodeToBuffer shall fail and return the result of the writer. ]*/
+TEST_FUNCTION(JSONWriter_EncodeToBuffer_fails_when_the_value_cannot_be_written)
+{
+    ///arrange
+    size_t length = 0;
+    JSON_WRITER_RESULT result;
+
+    ///act
+    result = JSONWriter_EncodeToBuffer(testBuffer, sizeof(testBuffer), &length, write_test_object, "\xFF");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+}
+
+END_TEST_SUITE(jsonwriter_ut)
@@ -3875,6 +3875,137 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_Destroy(schemaHandle);
     }
 
+    /* Tests_SRS_SCHEMA_01_001: [ Schema_AddDeviceRef shall build the name indices of all the models and structs of the schema of modelTypeHandle and of their properties, reported properties, desired properties, actions, methods and models in model. ]*/
+    /* Tests_SRS_SCHEMA_01_004: [ When the name index of the searched collection is built, the ByName and ByPath lookups shall find the element by binary search in the index. ]*/
+    TEST_FUNCTION(Schema_AddDeviceRef_builds_the_name_indices_and_the_lookups_find_all_the_elements)
+    {
+        ///arrange
+        SCHEMA_RESULT result;
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE bigModel = Schema_CreateModelType(schemaHandle, "someBigModel");
+        SCHEMA_MODEL_TYPE_HANDLE mediumModel = Schema_CreateModelType(schemaHandle, "someMediumModel");
+        SCHEMA_STRUCT_TYPE_HANDLE structType = Schema_CreateStructType(schemaHandle, "someStruct");
+        SCHEMA_ACTION_HANDLE zAction = Schema_CreateModelAction(bigModel, "zAction");
+        SCHEMA_ACTION_HANDLE aAction = Schema_CreateModelAction(bigModel, "aAction");
+        SCHEMA_METHOD_HANDLE longMethod = Schema_CreateModelMethod(bigModel, "aLongerMethodName");
+        SCHEMA_METHOD_HANDLE method = Schema_CreateModelMethod(bigModel, "m");
+        (void)Schema_AddModelProperty(bigModel, "zProperty", "int");
+        (void)Schema_AddModelProperty(bigModel, "aProperty", "int");
+        (void)Schema_AddModelProperty(bigModel, "p", "int");
+        (void)Schema_AddModelReportedProperty(bigModel, "zReported", "int");
+        (void)Schema_AddModelReportedProperty(bigModel, "aReported", "int");
+        (void)Schema_AddModelDesiredProperty(bigModel, "zDesired", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 0, NULL);
+        (void)Schema_AddModelDesiredProperty(bigModel, "aDesired", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 4, NULL);
+        (void)Schema_AddModelModel(bigModel, "theMediumModel", mediumModel, 8, NULL);
+        (void)Schema_AddModelProperty(mediumModel, "propertyName", "type");
+        (void)Schema_AddModelReportedProperty(mediumModel, "reportedName", "type");
+        (void)Schema_AddModelDesiredProperty(mediumModel, "desiredName", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 0, NULL);
+        (void)Schema_AddStructTypeProperty(structType, "zField", "int");
+        (void)Schema_AddStructTypeProperty(structType, "aField", "int");
+
+        ///act
+        result = Schema_AddDeviceRef(bigModel);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        ASSERT_ARE_EQUAL(void_ptr, bigModel, Schema_GetModelByName(schemaHandle, "someBigModel"));
+        ASSERT_ARE_EQUAL(void_ptr, mediumModel, Schema_GetModelByName(schemaHandle, "someMediumModel"));
+        ASSERT_IS_NULL(Schema_GetModelByName(schemaHandle, "someModel"));
+        ASSERT_ARE_EQUAL(void_ptr, structType, Schema_GetStructTypeByName(schemaHandle, "someStruct"));
+        ASSERT_IS_NULL(Schema_GetStructTypeByName(schemaHandle, "someStruct2"));
+        ASSERT_ARE_EQUAL(char_ptr, "zField", Schema_GetPropertyName(Schema_GetStructTypePropertyByName(structType, "zField")));
+        ASSERT_ARE_EQUAL(char_ptr, "aField", Schema_GetPropertyName(Schema_GetStructTypePropertyByName(structType, "aField")));
+        ASSERT_ARE_EQUAL(char_ptr, "zProperty", Schema_GetPropertyName(Schema_GetModelPropertyByName(bigModel, "zProperty")));
+        ASSERT_ARE_EQUAL(char_ptr, "aProperty", Schema_GetPropertyName(Schema_GetModelPropertyByName(bigModel, "aProperty")));
+        ASSERT_ARE_EQUAL(char_ptr, "p", Schema_GetPropertyName(Schema_GetModelPropertyByName(bigModel, "p")));
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(bigModel, "q"));
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(bigModel, "aPropert"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(bigModel, "zReported"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(bigModel, "aReported"));
+        ASSERT_IS_NULL(Schema_GetModelReportedPropertyByName(bigModel, "aReported2"));
+        ASSERT_ARE_EQUAL(size_t, 4, Schema_GetModelDesiredProperty_offset(Schema_GetModelDesiredPropertyByName(bigModel, "aDesired")));
+        ASSERT_ARE_EQUAL(size_t, 0, Schema_GetModelDesiredProperty_offset(Schema_GetModelDesiredPropertyByName(bigModel, "zDesired")));
+        ASSERT_IS_NULL(Schema_GetModelDesiredPropertyByName(bigModel, "zReported"));
+        ASSERT_ARE_EQUAL(void_ptr, zAction, Schema_GetModelActionByName(bigModel, "zAction"));
+        ASSERT_ARE_EQUAL(void_ptr, aAction, Schema_GetModelActionByName(bigModel, "aAction"));
+        ASSERT_IS_NULL(Schema_GetModelActionByName(bigModel, "bAction"));
+        ASSERT_ARE_EQUAL(void_ptr, longMethod, Schema_GetModelMethodByName(bigModel, "aLongerMethodName"));
+        ASSERT_ARE_EQUAL(void_ptr, method, Schema_GetModelMethodByName(bigModel, "m"));
+        ASSERT_IS_NULL(Schema_GetModelMethodByName(bigModel, "n"));
+        ASSERT_ARE_EQUAL(void_ptr, mediumModel, Schema_GetModelModelByName(bigModel, "theMediumModel"));
+        ASSERT_ARE_EQUAL(size_t, 8, Schema_GetModelModelByName_Offset(bigModel, "theMediumModel"));
+        ASSERT_IS_NULL(Schema_GetModelModelByName(bigModel, "theMedium"));
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_ACTION, Schema_GetModelElementByName(bigModel, "aAction").elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, Schema_GetModelElementByName(bigModel, "aDesired").elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, Schema_GetModelElementByName(bigModel, "aDesire").elementType);
+        ASSERT_IS_TRUE(Schema_ModelPropertyByPathExists(bigModel, "/theMediumModel/propertyName"));
+        ASSERT_IS_TRUE(Schema_ModelPropertyByPathExists(bigModel, "aProperty"));
+        ASSERT_IS_FALSE(Schema_ModelPropertyByPathExists(bigModel, "theMediumModel/aProperty"));
+        ASSERT_IS_TRUE(Schema_ModelReportedPropertyByPathExists(bigModel, "theMediumModel/reportedName"));
+        ASSERT_IS_FALSE(Schema_ModelReportedPropertyByPathExists(bigModel, "theMediumModel/propertyName"));
+        ASSERT_IS_TRUE(Schema_ModelDesiredPropertyByPathExists(bigModel, "theMediumModel/desiredName"));
+        ASSERT_IS_FALSE(Schema_ModelDesiredPropertyByPathExists(bigModel, "theMediumMode/desiredName"));
+
+        ///cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
+    /* Tests_SRS_SCHEMA_01_002: [ If building a name index fails, Schema_AddDeviceRef shall still succeed and lookups in that collection shall scan it. ]*/
+    TEST_FUNCTION(Schema_AddDeviceRef_when_building_a_name_index_fails_succeeds)
+    {
+        ///arrange
+        SCHEMA_RESULT result;
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE bigModel = Schema_CreateModelType(schemaHandle, "someBigModel");
+        SCHEMA_MODEL_TYPE_HANDLE mediumModel = Schema_CreateModelType(schemaHandle, "someMediumModel");
+        (void)Schema_AddModelModel(bigModel, "theMediumModel", mediumModel, 0, NULL);
+        (void)Schema_AddModelProperty(mediumModel, "propertyName", "type");
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .SetReturn(NULL);
+
+        ///act
+        result = Schema_AddDeviceRef(bigModel);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        ASSERT_ARE_EQUAL(void_ptr, bigModel, Schema_GetModelByName(schemaHandle, "someBigModel"));
+        ASSERT_ARE_EQUAL(void_ptr, mediumModel, Schema_GetModelByName(schemaHandle, "someMediumModel"));
+        ASSERT_IS_TRUE(Schema_ModelPropertyByPathExists(bigModel, "theMediumModel/propertyName"));
+
+        ///cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
+    /* Tests_SRS_SCHEMA_01_003: [ Adding a model, struct, property, reported property, desired property, action, method or model in model shall drop the name index of the collection it is added to. ]*/
+    TEST_FUNCTION(Schema_AddModelProperty_after_Schema_AddDeviceRef_the_new_property_is_found)
+    {
+        ///arrange
+        SCHEMA_RESULT result;
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE bigModel = Schema_CreateModelType(schemaHandle, "someBigModel");
+        SCHEMA_MODEL_TYPE_HANDLE mediumModel = Schema_CreateModelType(schemaHandle, "someMediumModel");
+        SCHEMA_MODEL_TYPE_HANDLE lateModel;
+        (void)Schema_AddModelModel(bigModel, "theMediumModel", mediumModel, 0, NULL);
+        (void)Schema_AddModelProperty(bigModel, "propertyName", "type");
+        (void)Schema_AddDeviceRef(bigModel);
+
+        ///act
+        result = Schema_AddModelProperty(bigModel, "anotherPropertyName", "type");
+        lateModel = Schema_CreateModelType(schemaHandle, "aLateModel");
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(bigModel, "anotherPropertyName"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(bigModel, "propertyName"));
+        ASSERT_ARE_EQUAL(void_ptr, lateModel, Schema_GetModelByName(schemaHandle, "aLateModel"));
+        ASSERT_ARE_EQUAL(void_ptr, bigModel, Schema_GetModelByName(schemaHandle, "someBigModel"));
+
+        ///cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
     TEST_FUNCTION(Schema_ReleaseDeviceRef_NULL_SCHEMA_MODEL_TYPE_HANDLE_Fail)
     {
         ///arrange
@@ -0,0 +1,346 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Measures the schema lookups done for every message of a large model: SEND of single properties and of
+   the whole device (each property is checked by path in the schema), EXECUTE_COMMAND and EXECUTE_METHOD
+   (each command and method is found by name in the schema). The elements searched for are the last ones
+   declared, the worst case for a linear search. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "serializer.h"
+
+#define PERF_ITERATIONS     20000
+
+BEGIN_NAMESPACE(PerfLargeModel);
+
+DECLARE_MODEL(LargeModel,
+    WITH_DATA(int, property00),
+    WITH_DATA(int, property01),
+    WITH_DATA(int, property02),
+    WITH_DATA(int, property03),
+    WITH_DATA(int, property04),
+    WITH_DATA(int, property05),
+    WITH_DATA(int, property06),
+    WITH_DATA(int, property07),
+    WITH_DATA(int, property08),
+    WITH_DATA(int, property09),
+    WITH_DATA(int, property10),
+    WITH_DATA(int, property11),
+    WITH_DATA(int, property12),
+    WITH_DATA(int, property13),
+    WITH_DATA(int, property14),
+    WITH_DATA(int, property15),
+    WITH_DATA(int, property16),
+    WITH_DATA(int, property17),
+    WITH_DATA(int, property18),
+    WITH_DATA(int, property19),
+    WITH_DATA(int, property20),
+    WITH_DATA(int, property21),
+    WITH_DATA(int, property22),
+    WITH_DATA(int, property23),
+    WITH_DATA(int, property24),
+    WITH_DATA(int, property25),
+    WITH_DATA(int, property26),
+    WITH_DATA(int, property27),
+    WITH_DATA(int, property28),
+    WITH_DATA(int, property29),
+    WITH_DATA(int, property30),
+    WITH_DATA(int, property31),
+    WITH_DATA(int, property32),
+    WITH_DATA(int, property33),
+    WITH_DATA(int, property34),
+    WITH_DATA(int, property35),
+    WITH_DATA(int, property36),
+    WITH_DATA(int, property37),
+    WITH_DATA(int, property38),
+    WITH_DATA(int, property39),
+    WITH_ACTION(action00),
+    WITH_ACTION(action01),
+    WITH_ACTION(action02),
+    WITH_ACTION(action03),
+    WITH_ACTION(action04),
+    WITH_ACTION(action05),
+    WITH_ACTION(action06),
+    WITH_ACTION(action07),
+    WITH_ACTION(action08),
+    WITH_ACTION(action09),
+    WITH_METHOD(method00),
+    WITH_METHOD(method01),
+    WITH_METHOD(method02),
+    WITH_METHOD(method03),
+    WITH_METHOD(method04),
+    WITH_METHOD(method05),
+    WITH_METHOD(method06),
+    WITH_METHOD(method07),
+    WITH_METHOD(method08),
+    WITH_METHOD(method09),
+    WITH_DATA(int, actionCalls),
+    WITH_DATA(int, methodCalls)
+);
+
+END_NAMESPACE(PerfLargeModel);
+
+EXECUTE_COMMAND_RESULT action00(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action01(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action02(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action03(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action04(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action05(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action06(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action07(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action08(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+EXECUTE_COMMAND_RESULT action09(LargeModel* device)
+{
+    device->actionCalls++;
+    return EXECUTE_COMMAND_SUCCESS;
+}
+
+METHODRETURN_HANDLE method00(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method01(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method02(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method03(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method04(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method05(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method06(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method07(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method08(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+METHODRETURN_HANDLE method09(LargeModel* device)
+{
+    device->methodCalls++;
+    return MethodReturn_Create(0, NULL);
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, double start, size_t iterations)
+{
+    double elapsed = now_seconds() - start;
+    (void)printf("%-32s %10.1f ns/op\n", name, elapsed * 1e9 / iterations);
+}
+
+int main(void)
+{
+    int result = 0;
+    LargeModel* device;
+
+    if (serializer_init(NULL) != SERIALIZER_OK)
+    {
+        (void)printf("failed to initialize the serializer\n");
+        result = 1;
+    }
+    else
+    {
+        if ((device = CREATE_MODEL_INSTANCE(PerfLargeModel, LargeModel)) == NULL)
+        {
+            (void)printf("failed to create the device\n");
+            result = 1;
+        }
+        else
+        {
+            unsigned char* destination;
+            size_t destinationSize;
+            size_t i;
+            size_t failures = 0;
+            /* keeps the compiler from dropping the loops */
+            size_t checksum = 0;
+            double start;
+
+            device->property36 = 36;
+            device->property37 = 37;
+            device->property38 = 38;
+            device->property39 = 39;
+            device->actionCalls = 0;
+            device->methodCalls = 0;
+
+            if ((EXECUTE_COMMAND(device, "{\"Name\":\"action09\",\"Parameters\":{}}") != EXECUTE_COMMAND_SUCCESS) ||
+                (device->actionCalls != 1))
+            {
+                (void)printf("EXECUTE_COMMAND failed\n");
+                result = 1;
+            }
+            else
+            {
+                METHODRETURN_HANDLE methodReturn;
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    if (SERIALIZE(&destination, &destinationSize, device->property39) != CODEFIRST_OK)
+                    {
+                        failures++;
+                    }
+                    else
+                    {
+                        checksum += destinationSize;
+                        free(destination);
+                    }
+                }
+                report("SEND 1 property", start, PERF_ITERATIONS);
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    if (SERIALIZE(&destination, &destinationSize, device->property36, device->property37, device->property38, device->property39) != CODEFIRST_OK)
+                    {
+                        failures++;
+                    }
+                    else
+                    {
+                        checksum += destinationSize;
+                        free(destination);
+                    }
+                }
+                report("SEND 4 properties", start, PERF_ITERATIONS);
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS / 10; i++)
+                {
+                    if (SERIALIZE(&destination, &destinationSize, *device) != CODEFIRST_OK)
+                    {
+                        failures++;
+                    }
+                    else
+                    {
+                        checksum += destinationSize;
+                        free(destination);
+                    }
+                }
+                /* the whole device is 42 properties */
+                report("SEND whole device", start, PERF_ITERATIONS / 10);
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    checksum += EXECUTE_COMMAND(device, "{\"Name\":\"action09\",\"Parameters\":{}}");
+                }
+                report("EXECUTE_COMMAND", start, PERF_ITERATIONS);
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    methodReturn = EXECUTE_METHOD(device, "method09", NULL);
+                    if (methodReturn != NULL)
+                    {
+                        checksum++;
+                        MethodReturn_Destroy(methodReturn);
+                    }
+                }
+                report("EXECUTE_METHOD", start, PERF_ITERATIONS);
+
+                if ((failures != 0) ||
+                    (device->actionCalls != PERF_ITERATIONS + 1) ||
+                    (device->methodCalls != PERF_ITERATIONS))
+                {
+                    (void)printf("not every message, command or method went through\n");
+                    result = 1;
+                }
+            }
+
+            (void)printf("checksum %lu\n", (unsigned long)checksum);
+            DESTROY_MODEL_INSTANCE(device);
+        }
+
+        serializer_deinit();
+    }
+
+    return result;
+}
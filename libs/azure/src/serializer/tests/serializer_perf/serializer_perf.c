@@ -0,0 +1,208 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Measures the serialization of a 20 property telemetry model, once through SERIALIZE, which builds an
+   AGENT_DATA_TYPE per property, a MULTITREE and a STRING, and once through the ToJSON_ functions
+   generated by DECLARE_MODEL, which write the JSON straight from the fields of the device. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "serializer.h"
+#include "parson.h"
+
+#define PERF_ITERATIONS     100000
+
+BEGIN_NAMESPACE(PerfTelemetry);
+
+DECLARE_MODEL(Telemetry,
+    WITH_DATA(ascii_char_ptr, deviceId),
+    WITH_DATA(ascii_char_ptr, firmware),
+    WITH_DATA(ascii_char_ptr, status),
+    WITH_DATA(double, temperature),
+    WITH_DATA(double, humidity),
+    WITH_DATA(double, pressure),
+    WITH_DATA(double, latitude),
+    WITH_DATA(double, longitude),
+    WITH_DATA(double, altitude),
+    WITH_DATA(float, batteryVoltage),
+    WITH_DATA(float, signalQuality),
+    WITH_DATA(int, rssi),
+    WITH_DATA(int, satellites),
+    WITH_DATA(int, errorCount),
+    WITH_DATA(int32_t, uptime),
+    WITH_DATA(int64_t, messageId),
+    WITH_DATA(int64_t, bytesSent),
+    WITH_DATA(uint8_t, cellId),
+    WITH_DATA(bool, charging),
+    WITH_DATA(bool, moving)
+);
+
+END_NAMESPACE(PerfTelemetry);
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, double start, size_t bytes)
+{
+    double elapsed = now_seconds() - start;
+    (void)printf("%-32s %8.1f ns/op %8.1f MB/s\n", name,
+        elapsed * 1e9 / PERF_ITERATIONS,
+        (double)bytes * PERF_ITERATIONS / elapsed / 1e6);
+}
+
+static int same_json(const unsigned char* left, size_t leftSize, const unsigned char* right, size_t rightSize)
+{
+    int result;
+    char* leftText = (char*)malloc(leftSize + 1);
+    char* rightText = (char*)malloc(rightSize + 1);
+    if ((leftText == NULL) || (rightText == NULL))
+    {
+        result = 0;
+    }
+    else
+    {
+        JSON_Value* leftValue;
+        JSON_Value* rightValue;
+        (void)memcpy(leftText, left, leftSize);
+        leftText[leftSize] = '\0';
+        (void)memcpy(rightText, right, rightSize);
+        rightText[rightSize] = '\0';
+        leftValue = json_parse_string(leftText);
+        rightValue = json_parse_string(rightText);
+        result = (leftValue != NULL) && (rightValue != NULL) && json_value_equals(leftValue, rightValue);
+        json_value_free(leftValue);
+        json_value_free(rightValue);
+    }
+    free(leftText);
+    free(rightText);
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+    Telemetry* device;
+
+    if (serializer_init(NULL) != SERIALIZER_OK)
+    {
+        (void)printf("failed to initialize the serializer\n");
+        result = 1;
+    }
+    else
+    {
+        if ((device = CREATE_MODEL_INSTANCE(PerfTelemetry, Telemetry)) == NULL)
+        {
+            (void)printf("failed to create the device\n");
+            result = 1;
+        }
+        else
+        {
+            unsigned char buffer[1024];
+            unsigned char* destination;
+            size_t destinationSize;
+            unsigned char* reference = NULL;
+            size_t referenceSize = 0;
+            size_t length = 0;
+            size_t i;
+            /* keeps the compiler from dropping the loops */
+            size_t checksum = 0;
+            double start;
+
+            device->deviceId = "gprs-a9-tracker-0042";
+            device->firmware = "1.4.2/rc1";
+            device->status = "moving \"fast\"";
+            device->temperature = 23.5;
+            device->humidity = 41.25;
+            device->pressure = 1013.2;
+            device->latitude = 47.639722;
+            device->longitude = -122.128333;
+            device->altitude = 52.3;
+            device->batteryVoltage = 3.7f;
+            device->signalQuality = 0.75f;
+            device->rssi = -71;
+            device->satellites = 9;
+            device->errorCount = 0;
+            device->uptime = 86400;
+            device->messageId = 1234567890123LL;
+            device->bytesSent = 987654321LL;
+            device->cellId = 17;
+            device->charging = false;
+            device->moving = true;
+
+            if (SERIALIZE(&reference, &referenceSize, *device) != CODEFIRST_OK)
+            {
+                (void)printf("SERIALIZE failed\n");
+                result = 1;
+            }
+            else
+            {
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    (void)SERIALIZE(&destination, &destinationSize, *device);
+                    checksum += destination[i % destinationSize];
+                    free(destination);
+                }
+                report("SERIALIZE", start, referenceSize);
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    (void)SERIALIZE_MODEL(&destination, &destinationSize, Telemetry, device);
+                    checksum += destination[i % destinationSize];
+                    free(destination);
+                }
+                report("SERIALIZE_MODEL", start, referenceSize);
+
+                start = now_seconds();
+                for (i = 0; i < PERF_ITERATIONS; i++)
+                {
+                    (void)SERIALIZE_MODEL_TO_BUFFER(buffer, sizeof(buffer), &length, Telemetry, device);
+                    checksum += buffer[i % length];
+                }
+                report("SERIALIZE_MODEL_TO_BUFFER", start, referenceSize);
+
+                /* the members come in another order, the JSON values have to be the same */
+                if (SERIALIZE_MODEL(&destination, &destinationSize, Telemetry, device) != JSON_WRITER_OK)
+                {
+                    (void)printf("SERIALIZE_MODEL failed\n");
+                    result = 1;
+                }
+                else
+                {
+                    if ((destinationSize != referenceSize) ||
+                        (!same_json(reference, referenceSize, destination, destinationSize)))
+                    {
+                        (void)printf("SERIALIZE_MODEL does not match SERIALIZE\n");
+                        result = 1;
+                    }
+                    free(destination);
+                }
+
+                if ((SERIALIZE_MODEL_TO_BUFFER(buffer, sizeof(buffer), &length, Telemetry, device) != JSON_WRITER_OK) ||
+                    (length != referenceSize) ||
+                    (!same_json(reference, referenceSize, buffer, length)))
+                {
+                    (void)printf("SERIALIZE_MODEL_TO_BUFFER does not match SERIALIZE\n");
+                    result = 1;
+                }
+
+                free(reference);
+            }
+
+            (void)printf("checksum %lu\n", (unsigned long)checksum);
+            DESTROY_MODEL_INSTANCE(device);
+        }
+
+        serializer_deinit();
+    }
+
+    return result;
+}
@@ -92,6 +92,7 @@ extern "C" {
 
     MOCKABLE_FUNCTION(, int, amqpvalue_encode, AMQP_VALUE, value, AMQPVALUE_ENCODER_OUTPUT, encoder_output, void*, context);
     MOCKABLE_FUNCTION(, int, amqpvalue_get_encoded_size, AMQP_VALUE, value, size_t*, encoded_size);
+    MOCKABLE_FUNCTION(, int, amqpvalue_encode_to_buffer, AMQP_VALUE, value, unsigned char*, buffer, size_t, buffer_size, size_t*, encoded_size);
 
     /* decoding */
     typedef struct AMQPVALUE_DECODER_HANDLE_DATA_TAG* AMQPVALUE_DECODER_HANDLE;
@@ -101,6 +102,14 @@ extern "C" {
     MOCKABLE_FUNCTION(, void, amqpvalue_decoder_destroy, AMQPVALUE_DECODER_HANDLE, handle);
     MOCKABLE_FUNCTION(, int, amqpvalue_decode_bytes, AMQPVALUE_DECODER_HANDLE, handle, const unsigned char*, buffer, size_t, size);
 
+    /* decoding in place */
+    typedef struct AMQPVALUE_DECODE_ARENA_DATA_TAG* AMQPVALUE_DECODE_ARENA_HANDLE;
+
+    MOCKABLE_FUNCTION(, AMQPVALUE_DECODE_ARENA_HANDLE, amqpvalue_decode_arena_create);
+    MOCKABLE_FUNCTION(, void, amqpvalue_decode_arena_destroy, AMQPVALUE_DECODE_ARENA_HANDLE, arena);
+    MOCKABLE_FUNCTION(, int, amqpvalue_decode_in_place, AMQPVALUE_DECODE_ARENA_HANDLE, arena, const unsigned char*, buffer, size_t, size, AMQP_VALUE*, value, size_t*, used_bytes);
+    MOCKABLE_FUNCTION(, void, amqpvalue_decode_arena_reset, AMQPVALUE_DECODE_ARENA_HANDLE, arena);
+
     /* misc for now, not spec'd */
     MOCKABLE_FUNCTION(, AMQP_VALUE, amqpvalue_get_inplace_descriptor, AMQP_VALUE, value);
     MOCKABLE_FUNCTION(, AMQP_VALUE, amqpvalue_get_inplace_described_value, AMQP_VALUE, value);
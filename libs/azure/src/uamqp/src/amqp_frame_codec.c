@@ -27,33 +27,10 @@ typedef struct AMQP_FRAME_CODEC_TAG
     AMQP_EMPTY_FRAME_RECEIVED_CALLBACK empty_frame_received_callback;
     AMQP_FRAME_CODEC_ERROR_CALLBACK error_callback;
     void* callback_context;
-    AMQPVALUE_DECODER_HANDLE decoder;
+    AMQPVALUE_DECODE_ARENA_HANDLE decode_arena;
     AMQP_FRAME_DECODE_STATE decode_state;
-    AMQP_VALUE decoded_performative;
 } AMQP_FRAME_CODEC;
 
-static void amqp_value_decoded(void* context, AMQP_VALUE decoded_value)
-{
-    AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = (AMQP_FRAME_CODEC_HANDLE)context;
-    uint64_t performative_descriptor_ulong;
-    AMQP_VALUE descriptor = amqpvalue_get_inplace_descriptor(decoded_value);
-
-    /* Codes_SRS_AMQP_FRAME_CODEC_01_060: [If any error occurs while decoding a frame, the decoder shall switch to an error state where decoding shall not be possible anymore.] */
-    if ((descriptor == NULL) ||
-        (amqpvalue_get_ulong(descriptor, &performative_descriptor_ulong) != 0) ||
-        /* Codes_SRS_AMQP_FRAME_CODEC_01_003: [The performative MUST be one of those defined in section 2.7 and is encoded as a described type in the AMQP type system.] */
-        (performative_descriptor_ulong < AMQP_OPEN) ||
-        (performative_descriptor_ulong > AMQP_CLOSE))
-    {
-        /* Codes_SRS_AMQP_FRAME_CODEC_01_060: [If any error occurs while decoding a frame, the decoder shall switch to an error state where decoding shall not be possible anymore.] */
-        amqp_frame_codec->decode_state = AMQP_FRAME_DECODE_ERROR;
-    }
-    else
-    {
-        amqp_frame_codec->decoded_performative = decoded_value;
-    }
-}
-
 static void frame_received(void* context, const unsigned char* type_specific, uint32_t type_specific_size, const unsigned char* frame_body, uint32_t frame_body_size)
 {
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = (AMQP_FRAME_CODEC_HANDLE)context;
@@ -91,27 +68,22 @@ static void frame_received(void* context, const unsigned char* type_specific, ui
             {
                 /* Codes_SRS_AMQP_FRAME_CODEC_01_051: [If the frame payload is greater than 0, amqp_frame_codec shall decode the performative as a described AMQP type.] */
                 /* Codes_SRS_AMQP_FRAME_CODEC_01_002: [The frame body is defined as a performative followed by an opaque payload.] */
-                amqp_frame_codec->decoded_performative = NULL;
-
-                while ((frame_body_size > 0) &&
-                       (amqp_frame_codec->decoded_performative == NULL) &&
-                       (amqp_frame_codec->decode_state != AMQP_FRAME_DECODE_ERROR))
+                AMQP_VALUE performative;
+                size_t performative_size;
+                uint64_t performative_descriptor_ulong;
+                AMQP_VALUE descriptor;
+
+                /* Codes_SRS_AMQP_FRAME_CODEC_01_052: [Decoding the performative shall be done by calling amqpvalue_decode_in_place with the arena created in amqp_frame_codec_create and the frame body bytes.] */
+                if ((amqpvalue_decode_in_place(amqp_frame_codec->decode_arena, frame_body, frame_body_size, &performative, &performative_size) != 0) ||
+                    ((descriptor = amqpvalue_get_inplace_descriptor(performative)) == NULL) ||
+                    (amqpvalue_get_ulong(descriptor, &performative_descriptor_ulong) != 0) ||
+                    /* Codes_SRS_AMQP_FRAME_CODEC_01_003: [The performative MUST be one of those defined in section 2.7 and is encoded as a described type in the AMQP type system.] */
+                    (performative_descriptor_ulong < AMQP_OPEN) ||
+                    (performative_descriptor_ulong > AMQP_CLOSE))
                 {
-                    /* Codes_SRS_AMQP_FRAME_CODEC_01_052: [Decoding the performative shall be done by feeding the bytes to the decoder create in amqp_frame_codec_create.] */
-                    if (amqpvalue_decode_bytes(amqp_frame_codec->decoder, frame_body, 1) != 0)
-                    {
-                        /* Codes_SRS_AMQP_FRAME_CODEC_01_060: [If any error occurs while decoding a frame, the decoder shall switch to an error state where decoding shall not be possible anymore.] */
-                        amqp_frame_codec->decode_state = AMQP_FRAME_DECODE_ERROR;
-                    }
-                    else
-                    {
-                        frame_body_size--;
-                        frame_body++;
-                    }
-                }
+                    /* Codes_SRS_AMQP_FRAME_CODEC_01_060: [If any error occurs while decoding a frame, the decoder shall switch to an error state where decoding shall not be possible anymore.] */
+                    amqp_frame_codec->decode_state = AMQP_FRAME_DECODE_ERROR;
 
-                if (amqp_frame_codec->decode_state == AMQP_FRAME_DECODE_ERROR)
-                {
                     /* Codes_SRS_AMQP_FRAME_CODEC_01_069: [If any error occurs while decoding a frame, the decoder shall indicate the error by calling the amqp_frame_codec_error_callback  and passing to it the callback context argument that was given in amqp_frame_codec_create.] */
                     amqp_frame_codec->error_callback(amqp_frame_codec->callback_context);
                 }
@@ -121,8 +93,12 @@ static void frame_received(void* context, const unsigned char* type_specific, ui
                     /* Codes_SRS_AMQP_FRAME_CODEC_01_067: [When the performative is decoded, the rest of the frame_bytes shall not be given to the AMQP decoder, but they shall be buffered so that later they are given to the frame_received callback.] */
                     /* Codes_SRS_AMQP_FRAME_CODEC_01_054: [Once the performative is decoded and all frame payload bytes are received, the callback frame_received_callback shall be called.] */
                     /* Codes_SRS_AMQP_FRAME_CODEC_01_068: [A pointer to all the payload bytes shall also be passed to frame_received_callback.] */
-                    amqp_frame_codec->frame_received_callback(amqp_frame_codec->callback_context, channel, amqp_frame_codec->decoded_performative, frame_body, frame_body_size);
+                    amqp_frame_codec->frame_received_callback(amqp_frame_codec->callback_context, channel, performative, frame_body + performative_size, frame_body_size - (uint32_t)performative_size);
                 }
+
+                /* Codes_SRS_AMQP_FRAME_CODEC_01_071: [Once frame_received_callback returns or decoding the performative fails, the values decoded for the frame shall be released by calling amqpvalue_decode_arena_reset, while the frame body bytes are still valid.] */
+                /* frame_body points into a receive buffer that is reused for the next frame, so nothing decoded may refer to it past this point */
+                amqpvalue_decode_arena_reset(amqp_frame_codec->decode_arena);
             }
         }
         break;
@@ -170,12 +146,12 @@ AMQP_FRAME_CODEC_HANDLE amqp_frame_codec_create(FRAME_CODEC_HANDLE frame_codec,
             result->callback_context = callback_context;
             result->decode_state = AMQP_FRAME_DECODE_FRAME;
 
-            /* Codes_SRS_AMQP_FRAME_CODEC_01_018: [amqp_frame_codec_create shall create a decoder to be used for decoding AMQP values.] */
-            result->decoder = amqpvalue_decoder_create(amqp_value_decoded, result);
-            if (result->decoder == NULL)
+            /* Codes_SRS_AMQP_FRAME_CODEC_01_018: [amqp_frame_codec_create shall create a decode arena to be used for decoding performatives in place by calling amqpvalue_decode_arena_create.] */
+            result->decode_arena = amqpvalue_decode_arena_create();
+            if (result->decode_arena == NULL)
             {
-                /* Codes_SRS_AMQP_FRAME_CODEC_01_019: [If creating the decoder fails, amqp_frame_codec_create shall fail and return NULL.] */
-                LogError("Could not create AMQP decoder");
+                /* Codes_SRS_AMQP_FRAME_CODEC_01_019: [If creating the decode arena fails, amqp_frame_codec_create shall fail and return NULL.] */
+                LogError("Could not create AMQP decode arena");
                 free(result);
                 result = NULL;
             }
@@ -186,7 +162,7 @@ AMQP_FRAME_CODEC_HANDLE amqp_frame_codec_create(FRAME_CODEC_HANDLE frame_codec,
                 {
                     /* Codes_SRS_AMQP_FRAME_CODEC_01_014: [If subscribing for AMQP frames fails, amqp_frame_codec_create shall fail and return NULL.] */
                     LogError("Could not subscribe for received AMQP frames");
-                    amqpvalue_decoder_destroy(result->decoder);
+                    amqpvalue_decode_arena_destroy(result->decode_arena);
                     free(result);
                     result = NULL;
                 }
@@ -209,8 +185,8 @@ void amqp_frame_codec_destroy(AMQP_FRAME_CODEC_HANDLE amqp_frame_codec)
         /* Codes_SRS_AMQP_FRAME_CODEC_01_017: [amqp_frame_codec_destroy shall unsubscribe from receiving AMQP frames from the frame_codec that was passed to amqp_frame_codec_create.] */
         (void)frame_codec_unsubscribe(amqp_frame_codec->frame_codec, FRAME_TYPE_AMQP);
 
-        /* Codes_SRS_AMQP_FRAME_CODEC_01_021: [The decoder created in amqp_frame_codec_create shall be destroyed by amqp_frame_codec_destroy.] */
-        amqpvalue_decoder_destroy(amqp_frame_codec->decoder);
+        /* Codes_SRS_AMQP_FRAME_CODEC_01_021: [The decode arena created in amqp_frame_codec_create shall be destroyed by amqp_frame_codec_destroy.] */
+        amqpvalue_decode_arena_destroy(amqp_frame_codec->decode_arena);
 
         /* Codes_SRS_AMQP_FRAME_CODEC_01_015: [amqp_frame_codec_destroy shall free all resources associated with the amqp_frame_codec instance.] */
         free(amqp_frame_codec);
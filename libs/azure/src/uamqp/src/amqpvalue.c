@@ -21,12 +21,16 @@ typedef struct AMQP_LIST_VALUE_TAG
 {
     AMQP_VALUE* items;
     uint32_t count;
+    /* encoded size of the items, computed before each encode */
+    uint32_t encoded_size;
 } AMQP_LIST_VALUE;
 
 typedef struct AMQP_ARRAY_VALUE_TAG
 {
     AMQP_VALUE* items;
     uint32_t count;
+    /* encoded size of the items, computed before each encode */
+    uint32_t encoded_size;
 } AMQP_ARRAY_VALUE;
 
 typedef struct AMQP_MAP_KEY_VALUE_PAIR_TAG
@@ -39,6 +43,8 @@ typedef struct AMQP_MAP_VALUE_TAG
 {
     AMQP_MAP_KEY_VALUE_PAIR* pairs;
     uint32_t pair_count;
+    /* encoded size of the items, computed before each encode */
+    uint32_t encoded_size;
 } AMQP_MAP_VALUE;
 
 typedef struct AMQP_STRING_VALUE_TAG
@@ -162,11 +168,55 @@ typedef union DECODE_VALUE_STATE_UNION_TAG
 typedef struct AMQP_VALUE_DATA_TAG
 {
     AMQP_TYPE type;
+    /* true for values decoded in place, which live in a decode arena and are not ref counted */
+    bool in_arena;
     AMQP_VALUE_UNION value;
 } AMQP_VALUE_DATA;
 
 DEFINE_REFCOUNT_TYPE(AMQP_VALUE_DATA);
 
+/* values decoded in place are carved out of blocks of this size, bigger items get a block of their own */
+#define DECODE_ARENA_BLOCK_SIZE 1024
+#define DECODE_ARENA_ALIGNMENT 8
+#define DECODE_ARENA_ALIGN(size) (((size) + (DECODE_ARENA_ALIGNMENT - 1)) & ~(size_t)(DECODE_ARENA_ALIGNMENT - 1))
+
+typedef struct DECODE_ARENA_BLOCK_TAG
+{
+    struct DECODE_ARENA_BLOCK_TAG* next;
+    size_t size;
+    size_t used;
+} DECODE_ARENA_BLOCK;
+
+#define DECODE_ARENA_BLOCK_HEADER_SIZE DECODE_ARENA_ALIGN(sizeof(DECODE_ARENA_BLOCK))
+
+typedef struct ARENA_VALUE_DATA_TAG ARENA_VALUE_DATA;
+
+/* Everything decoded between two resets of an arena. If clones of its values are still alive when the arena
+   is reset, the generation is retired and stays allocated until the last clone is destroyed. */
+typedef struct DECODE_ARENA_GENERATION_TAG
+{
+    DECODE_ARENA_BLOCK* blocks;
+    DECODE_ARENA_BLOCK* current_block;
+    uint32_t clone_count;
+    bool is_retired;
+    /* binary values that point into the decoded buffer */
+    ARENA_VALUE_DATA* borrowed_values;
+} DECODE_ARENA_GENERATION;
+
+struct ARENA_VALUE_DATA_TAG
+{
+    AMQP_VALUE_DATA value_data;
+    DECODE_ARENA_GENERATION* generation;
+    ARENA_VALUE_DATA* next_borrowed;
+};
+
+typedef struct AMQPVALUE_DECODE_ARENA_DATA_TAG
+{
+    DECODE_ARENA_GENERATION* generation;
+} AMQPVALUE_DECODE_ARENA_DATA;
+
+static void* decode_arena_allocate(DECODE_ARENA_GENERATION* generation, size_t size);
+
 typedef enum DECODER_STATE_TAG
 {
     DECODER_STATE_CONSTRUCTOR,
@@ -196,10 +246,21 @@ typedef struct AMQPVALUE_DECODER_HANDLE_DATA_TAG
     AMQP_VALUE_DATA* decode_to_value;
 } AMQPVALUE_DECODER_HANDLE_DATA;
 
+static AMQP_VALUE_DATA* create_value_data(void)
+{
+    AMQP_VALUE_DATA* result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    if (result != NULL)
+    {
+        result->in_arena = false;
+    }
+
+    return result;
+}
+
 /* Codes_SRS_AMQPVALUE_01_003: [1.6.1 null Indicates an empty value.] */
 AMQP_VALUE amqpvalue_create_null(void)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_002: [If allocating the AMQP_VALUE fails then amqpvalue_create_null shall return NULL.] */
@@ -217,7 +278,7 @@ AMQP_VALUE amqpvalue_create_null(void)
 /* Codes_SRS_AMQPVALUE_01_004: [1.6.2 boolean Represents a true or false value.] */
 AMQP_VALUE amqpvalue_create_boolean(bool value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_007: [If allocating the AMQP_VALUE fails then amqpvalue_create_boolean shall return NULL.] */
@@ -270,7 +331,7 @@ int amqpvalue_get_boolean(AMQP_VALUE value, bool* bool_value)
 /* Codes_SRS_AMQPVALUE_01_005: [1.6.3 ubyte Integer in the range 0 to 28 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_ubyte(unsigned char value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result != NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_032: [amqpvalue_create_ubyte shall return a handle to an AMQP_VALUE that stores a unsigned char value.] */
@@ -318,7 +379,7 @@ int amqpvalue_get_ubyte(AMQP_VALUE value, unsigned char* ubyte_value)
 /* Codes_SRS_AMQPVALUE_01_012: [1.6.4 ushort Integer in the range 0 to 216 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_ushort(uint16_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_039: [If allocating the AMQP_VALUE fails then amqpvalue_create_ushort shall return NULL.] */
@@ -371,7 +432,7 @@ int amqpvalue_get_ushort(AMQP_VALUE value, uint16_t* ushort_value)
 /* Codes_SRS_AMQPVALUE_01_013: [1.6.5 uint Integer in the range 0 to 232 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_uint(uint32_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_045: [If allocating the AMQP_VALUE fails then amqpvalue_create_uint shall return NULL.] */
@@ -424,7 +485,7 @@ int amqpvalue_get_uint(AMQP_VALUE value, uint32_t* uint_value)
 /* Codes_SRS_AMQPVALUE_01_014: [1.6.6 ulong Integer in the range 0 to 264 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_ulong(uint64_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_050: [If allocating the AMQP_VALUE fails then amqpvalue_create_ulong shall return NULL.] */
@@ -477,7 +538,7 @@ int amqpvalue_get_ulong(AMQP_VALUE value, uint64_t* ulong_value)
 /* Codes_SRS_AMQPVALUE_01_015: [1.6.7 byte Integer in the range -(27) to 27 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_byte(char value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_056: [If allocating the AMQP_VALUE fails then amqpvalue_create_byte shall return NULL.] */
@@ -530,7 +591,7 @@ int amqpvalue_get_byte(AMQP_VALUE value, char* byte_value)
 /* Codes_SRS_AMQPVALUE_01_016: [1.6.8 short Integer in the range -(215) to 215 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_short(int16_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_062: [If allocating the AMQP_VALUE fails then amqpvalue_create_short shall return NULL.] */
@@ -582,7 +643,7 @@ int amqpvalue_get_short(AMQP_VALUE value, int16_t* short_value)
 /* Codes_SRS_AMQPVALUE_01_017: [1.6.9 int Integer in the range -(231) to 231 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_int(int32_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_068: [If allocating the AMQP_VALUE fails then amqpvalue_create_int shall return NULL.] */
@@ -635,7 +696,7 @@ int amqpvalue_get_int(AMQP_VALUE value, int32_t* int_value)
 /* Codes_SRS_AMQPVALUE_01_018: [1.6.10 long Integer in the range -(263) to 263 - 1 inclusive.] */
 AMQP_VALUE amqpvalue_create_long(int64_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_074: [If allocating the AMQP_VALUE fails then amqpvalue_create_long shall return NULL.] */
@@ -688,7 +749,7 @@ int amqpvalue_get_long(AMQP_VALUE value, int64_t* long_value)
 /* Codes_SRS_AMQPVALUE_01_019: [1.6.11 float 32-bit floating point number (IEEE 754-2008 binary32).]  */
 AMQP_VALUE amqpvalue_create_float(float value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_081: [If allocating the AMQP_VALUE fails then amqpvalue_create_float shall return NULL.] */
@@ -741,7 +802,7 @@ int amqpvalue_get_float(AMQP_VALUE value, float* float_value)
 /* Codes_SRS_AMQPVALUE_01_020: [1.6.12 double 64-bit floating point number (IEEE 754-2008 binary64).] */
 AMQP_VALUE amqpvalue_create_double(double value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_087: [If allocating the AMQP_VALUE fails then amqpvalue_create_double shall return NULL.] */
@@ -804,7 +865,7 @@ AMQP_VALUE amqpvalue_create_char(uint32_t value)
     }
     else
     {
-        result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+        result = create_value_data();
         if (result == NULL)
         {
             /* Codes_SRS_AMQPVALUE_01_093: [If allocating the AMQP_VALUE fails then amqpvalue_create_char shall return NULL.] */
@@ -858,7 +919,7 @@ int amqpvalue_get_char(AMQP_VALUE value, uint32_t* char_value)
 /* Codes_SRS_AMQPVALUE_01_025: [1.6.17 timestamp An absolute point in time.] */
 AMQP_VALUE amqpvalue_create_timestamp(int64_t value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_108: [If allocating the AMQP_VALUE fails then amqpvalue_create_timestamp shall return NULL.] */
@@ -911,7 +972,7 @@ int amqpvalue_get_timestamp(AMQP_VALUE value, int64_t* timestamp_value)
 /* Codes_SRS_AMQPVALUE_01_026: [1.6.18 uuid A universally unique identifier as defined by RFC-4122 section 4.1.2 .] */
 AMQP_VALUE amqpvalue_create_uuid(uuid value)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_114: [If allocating the AMQP_VALUE fails then amqpvalue_create_uuid shall return NULL.] */
@@ -974,7 +1035,7 @@ AMQP_VALUE amqpvalue_create_binary(amqp_binary value)
     }
     else
     {
-        result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+        result = create_value_data();
         if (result == NULL)
         {
             /* Codes_SRS_AMQPVALUE_01_128: [If allocating the AMQP_VALUE fails then amqpvalue_create_binary shall return NULL.] */
@@ -1063,7 +1124,7 @@ AMQP_VALUE amqpvalue_create_string(const char* value)
     {
         size_t length = strlen(value);
 
-        result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+        result = create_value_data();
         if (result == NULL)
         {
             /* Codes_SRS_AMQPVALUE_01_136: [If allocating the AMQP_VALUE fails then amqpvalue_create_string shall return NULL.] */
@@ -1147,7 +1208,7 @@ AMQP_VALUE amqpvalue_create_symbol(const char* value)
         else
         {
             /* Codes_SRS_AMQPVALUE_01_143: [If allocating the AMQP_VALUE fails then amqpvalue_create_symbol shall return NULL.] */
-            result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+            result = create_value_data();
             if (result == NULL)
             {
                 LogError("Cannot allocate memory for AMQP value");
@@ -1213,7 +1274,7 @@ int amqpvalue_get_symbol(AMQP_VALUE value, const char** symbol_value)
 /* Codes_SRS_AMQPVALUE_01_030: [1.6.22 list A sequence of polymorphic values.] */
 AMQP_VALUE amqpvalue_create_list(void)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_150: [If allocating the AMQP_VALUE fails then amqpvalue_create_list shall return NULL.] */
@@ -1251,6 +1312,12 @@ int amqpvalue_set_list_item_count(AMQP_VALUE value, uint32_t list_size)
             LogError("Value is not of type LIST");
             result = __FAILURE__;
         }
+        else if (value_data->in_arena)
+        {
+            /* Codes_SRS_AMQPVALUE_01_449: [ Values decoded in place shall not be modified: amqpvalue_set_list_item_count, amqpvalue_set_list_item, amqpvalue_set_map_value, amqpvalue_add_array_item and amqpvalue_set_composite_item shall fail and return a non-zero value for them. ]*/
+            LogError("Cannot modify a value decoded in place");
+            result = __FAILURE__;
+        }
         else
         {
             if (value_data->value.list_value.count < list_size)
@@ -1380,6 +1447,12 @@ int amqpvalue_set_list_item(AMQP_VALUE value, uint32_t index, AMQP_VALUE list_it
             LogError("Value is not of type LIST");
             result = __FAILURE__;
         }
+        else if (value_data->in_arena)
+        {
+            /* Codes_SRS_AMQPVALUE_01_449: [ Values decoded in place shall not be modified: amqpvalue_set_list_item_count, amqpvalue_set_list_item, amqpvalue_set_map_value, amqpvalue_add_array_item and amqpvalue_set_composite_item shall fail and return a non-zero value for them. ]*/
+            LogError("Cannot modify a value decoded in place");
+            result = __FAILURE__;
+        }
         else
         {
             /* Codes_SRS_AMQPVALUE_01_168: [The item stored at the index-th position in the list shall be a clone of list_item_value.] */
@@ -1503,7 +1576,7 @@ AMQP_VALUE amqpvalue_get_list_item(AMQP_VALUE value, size_t index)
 /* Codes_SRS_AMQPVALUE_01_031: [1.6.23 map A polymorphic mapping from distinct keys to values.] */
 AMQP_VALUE amqpvalue_create_map(void)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_179: [If allocating memory for the map fails, then amqpvalue_create_map shall return NULL.] */
@@ -1544,6 +1617,12 @@ int amqpvalue_set_map_value(AMQP_VALUE map, AMQP_VALUE key, AMQP_VALUE value)
             LogError("Value is not of type MAP");
             result = __FAILURE__;
         }
+        else if (value_data->in_arena)
+        {
+            /* Codes_SRS_AMQPVALUE_01_449: [ Values decoded in place shall not be modified: amqpvalue_set_list_item_count, amqpvalue_set_list_item, amqpvalue_set_map_value, amqpvalue_add_array_item and amqpvalue_set_composite_item shall fail and return a non-zero value for them. ]*/
+            LogError("Cannot modify a value decoded in place");
+            result = __FAILURE__;
+        }
         else
         {
             AMQP_VALUE cloned_value;
@@ -1802,7 +1881,7 @@ int amqpvalue_get_map(AMQP_VALUE value, AMQP_VALUE* map_value)
 /* Codes_SRS_AMQPVALUE_01_397: [1.6.24 array A sequence of values of a single type.] */
 AMQP_VALUE amqpvalue_create_array(void)
 {
-    AMQP_VALUE result = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE result = create_value_data();
     if (result == NULL)
     {
         /* Codes_SRS_AMQPVALUE_01_405: [ If allocating memory for the array fails, then `amqpvalue_create_array` shall return NULL. ] */
@@ -1875,6 +1954,12 @@ int amqpvalue_add_array_item(AMQP_VALUE value, AMQP_VALUE array_item_value)
             LogError("Value is not of type ARRAY");
             result = __FAILURE__;
         }
+        else if (value_data->in_arena)
+        {
+            /* Codes_SRS_AMQPVALUE_01_449: [ Values decoded in place shall not be modified: amqpvalue_set_list_item_count, amqpvalue_set_list_item, amqpvalue_set_map_value, amqpvalue_add_array_item and amqpvalue_set_composite_item shall fail and return a non-zero value for them. ]*/
+            LogError("Cannot modify a value decoded in place");
+            result = __FAILURE__;
+        }
         else
         {
             /* Codes_SRS_AMQPVALUE_01_425: [ If the type of `array_item_value` does not match that of items already in the array then `amqpvalue_add_array_item` shall fail and return a non-zero value. ] */
@@ -2206,6 +2291,31 @@ bool amqpvalue_are_equal(AMQP_VALUE value1, AMQP_VALUE value2)
     return result;
 }
 
+/* copies the binary values that still point into a decoded buffer in the arena memory */
+static int decode_arena_copy_borrowed_values(DECODE_ARENA_GENERATION* generation)
+{
+    int result = 0;
+
+    while (generation->borrowed_values != NULL)
+    {
+        ARENA_VALUE_DATA* borrowed_value = generation->borrowed_values;
+        amqp_binary* binary_value = &borrowed_value->value_data.value.binary_value;
+        void* bytes = decode_arena_allocate(generation, binary_value->length);
+        if (bytes == NULL)
+        {
+            LogError("Could not copy binary value of %u bytes out of the decoded buffer", (unsigned int)binary_value->length);
+            result = __FAILURE__;
+            break;
+        }
+
+        (void)memcpy(bytes, binary_value->bytes, binary_value->length);
+        binary_value->bytes = bytes;
+        generation->borrowed_values = borrowed_value->next_borrowed;
+    }
+
+    return result;
+}
+
 AMQP_VALUE amqpvalue_clone(AMQP_VALUE value)
 {
     AMQP_VALUE result;
@@ -2216,6 +2326,24 @@ AMQP_VALUE amqpvalue_clone(AMQP_VALUE value)
         LogError("NULL value");
         result = NULL;
     }
+    else if (((AMQP_VALUE_DATA*)value)->in_arena)
+    {
+        DECODE_ARENA_GENERATION* generation = ((ARENA_VALUE_DATA*)value)->generation;
+
+        /* Codes_SRS_AMQPVALUE_01_447: [ When a value decoded in place is cloned, the binary values pointing into the decoded buffers shall be copied in the arena memory, so that the clone does not refer to the buffer anymore. ]*/
+        if (decode_arena_copy_borrowed_values(generation) != 0)
+        {
+            /* Codes_SRS_AMQPVALUE_01_450: [ If copying the binary values fails, amqpvalue_clone shall return NULL. ]*/
+            LogError("Could not copy binary values out of the decoded buffer");
+            result = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_AMQPVALUE_01_445: [ Cloning a value decoded in place shall keep the memory of its arena alive until the clone is destroyed, even if the arena is reset or destroyed meanwhile. ]*/
+            generation->clone_count++;
+            result = value;
+        }
+    }
     else
     {
         /* Codes_SRS_AMQPVALUE_01_235: [amqpvalue_clone shall clone the value passed as argument and return a new non-NULL handle to the cloned AMQP value.] */
@@ -2232,67 +2360,73 @@ AMQP_TYPE amqpvalue_get_type(AMQP_VALUE value)
     return amqpvalue_data->type;
 }
 
-static int output_byte(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, unsigned char b)
+/* amqpvalue_encode gathers the encoded bytes in a buffer of this size before passing them to the encoder output */
+#define ENCODE_STAGING_BUFFER_SIZE 256
+
+typedef struct ENCODE_BUFFER_TAG
+{
+    unsigned char* bytes;
+    size_t size;
+    size_t pos;
+    AMQPVALUE_ENCODER_OUTPUT encoder_output;
+    void* context;
+} ENCODE_BUFFER;
+
+static int flush_encode_buffer(ENCODE_BUFFER* encode_buffer)
 {
     int result;
 
-    if (encoder_output != NULL)
-    {
-        /* Codes_SRS_AMQPVALUE_01_267: [amqpvalue_encode shall pass the encoded bytes to the encoder_output function.] */
-        /* Codes_SRS_AMQPVALUE_01_268: [On each call to the encoder_output function, amqpvalue_encode shall also pass the context argument.] */
-        result = encoder_output(context, &b, 1);
-    }
-    else
+    if (encode_buffer->pos == 0)
     {
         result = 0;
     }
-
-    return result;
-}
-
-static int output_bytes(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, const void* bytes, size_t length)
-{
-    int result;
-
-    if (encoder_output != NULL)
+    /* Codes_SRS_AMQPVALUE_01_267: [amqpvalue_encode shall pass the encoded bytes to the encoder_output function.] */
+    /* Codes_SRS_AMQPVALUE_01_268: [On each call to the encoder_output function, amqpvalue_encode shall also pass the context argument.] */
+    else if (encode_buffer->encoder_output(encode_buffer->context, encode_buffer->bytes, encode_buffer->pos) != 0)
     {
-        /* Codes_SRS_AMQPVALUE_01_267: [amqpvalue_encode shall pass the encoded bytes to the encoder_output function.] */
-        /* Codes_SRS_AMQPVALUE_01_268: [On each call to the encoder_output function, amqpvalue_encode shall also pass the context argument.] */
-        result = encoder_output(context, (const unsigned char*)bytes, length);
+        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
+        LogError("Encoder output failed");
+        result = __FAILURE__;
     }
     else
     {
+        encode_buffer->pos = 0;
         result = 0;
     }
 
     return result;
 }
 
-static int encode_boolean(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, bool value)
+static int output_bytes(ENCODE_BUFFER* encode_buffer, const void* bytes, size_t length)
 {
     int result;
 
-    if (value == false)
+    if (length <= encode_buffer->size - encode_buffer->pos)
     {
-        /* Codes_SRS_AMQPVALUE_01_273: [<encoding name="false" code="0x42" category="fixed" width="0" label="the boolean value false"/>] */
-        if (output_byte(encoder_output, context, 0x42) != 0)
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding boolean");
-            result = __FAILURE__;
-        }
-        else
+        if (length > 0)
         {
-            result = 0;
+            (void)memcpy(encode_buffer->bytes + encode_buffer->pos, bytes, length);
+            encode_buffer->pos += length;
         }
+
+        result = 0;
     }
-    else
+    else if (encode_buffer->encoder_output == NULL)
     {
-        /* Codes_SRS_AMQPVALUE_01_272: [<encoding name="true" code="0x41" category="fixed" width="0" label="the boolean value true"/>] */
-        if (output_byte(encoder_output, context, 0x41) != 0)
+        LogError("Encoded value does not fit in the buffer");
+        result = __FAILURE__;
+    }
+    else if (flush_encode_buffer(encode_buffer) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else if (length > encode_buffer->size)
+    {
+        /* Codes_SRS_AMQPVALUE_01_429: [amqpvalue_encode shall gather the encoded bytes and pass them to the encoder_output function in as few calls as possible, passing binary, string and symbol contents that do not fit in its buffer without copying them.] */
+        if (encode_buffer->encoder_output(encode_buffer->context, (const unsigned char*)bytes, length) != 0)
         {
             /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding boolean");
+            LogError("Encoder output failed");
             result = __FAILURE__;
         }
         else
@@ -2300,54 +2434,95 @@ static int encode_boolean(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context
             result = 0;
         }
     }
+    else
+    {
+        (void)memcpy(encode_buffer->bytes, bytes, length);
+        encode_buffer->pos = length;
+        result = 0;
+    }
 
     return result;
 }
 
-static int encode_ubyte(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, unsigned char value)
+static int output_byte(ENCODE_BUFFER* encode_buffer, unsigned char b)
 {
     int result;
 
-    /* Codes_SRS_AMQPVALUE_01_275: [<encoding code="0x50" category="fixed" width="1" label="8-bit unsigned integer"/>] */
-    if ((output_byte(encoder_output, context, 0x50) != 0) ||
-        (output_byte(encoder_output, context, value) != 0))
+    if (encode_buffer->pos < encode_buffer->size)
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failed encoding ubyte");
-        result = __FAILURE__;
+        encode_buffer->bytes[encode_buffer->pos++] = b;
+        result = 0;
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-        result = 0;
+        result = output_bytes(encode_buffer, &b, 1);
     }
 
     return result;
 }
 
-static int encode_ushort(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uint16_t value)
+static int output_constructor_and_uint32(ENCODE_BUFFER* encode_buffer, unsigned char constructor, uint32_t value)
+{
+    unsigned char bytes[5];
+    bytes[0] = constructor;
+    bytes[1] = (value >> 24) & 0xFF;
+    bytes[2] = (value >> 16) & 0xFF;
+    bytes[3] = (value >> 8) & 0xFF;
+    bytes[4] = value & 0xFF;
+    return output_bytes(encode_buffer, bytes, sizeof(bytes));
+}
+
+static int output_constructor_and_uint64(ENCODE_BUFFER* encode_buffer, unsigned char constructor, uint64_t value)
+{
+    unsigned char bytes[9];
+    bytes[0] = constructor;
+    bytes[1] = (value >> 56) & 0xFF;
+    bytes[2] = (value >> 48) & 0xFF;
+    bytes[3] = (value >> 40) & 0xFF;
+    bytes[4] = (value >> 32) & 0xFF;
+    bytes[5] = (value >> 24) & 0xFF;
+    bytes[6] = (value >> 16) & 0xFF;
+    bytes[7] = (value >> 8) & 0xFF;
+    bytes[8] = value & 0xFF;
+    return output_bytes(encode_buffer, bytes, sizeof(bytes));
+}
+
+static int output_constructor_and_ubyte(ENCODE_BUFFER* encode_buffer, unsigned char constructor, unsigned char value)
+{
+    unsigned char bytes[2];
+    bytes[0] = constructor;
+    bytes[1] = value;
+    return output_bytes(encode_buffer, bytes, sizeof(bytes));
+}
+
+static int encode_boolean(ENCODE_BUFFER* encode_buffer, bool value)
 {
     int result;
 
-    /* Codes_SRS_AMQPVALUE_01_276: [<encoding code="0x60" category="fixed" width="2" label="16-bit unsigned integer in network byte order"/>] */
-    if ((output_byte(encoder_output, context, 0x60) != 0) ||
-        (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value & 0xFF)) != 0))
+    if (value == false)
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failed encoding ushort");
-        result = __FAILURE__;
+        /* Codes_SRS_AMQPVALUE_01_273: [<encoding name="false" code="0x42" category="fixed" width="0" label="the boolean value false"/>] */
+        result = output_byte(encode_buffer, 0x42);
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-        result = 0;
+        /* Codes_SRS_AMQPVALUE_01_272: [<encoding name="true" code="0x41" category="fixed" width="0" label="the boolean value true"/>] */
+        result = output_byte(encode_buffer, 0x41);
     }
 
     return result;
 }
 
-static int encode_uint(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uint32_t value)
+static int encode_ushort(ENCODE_BUFFER* encode_buffer, unsigned char constructor, uint16_t value)
+{
+    unsigned char bytes[3];
+    bytes[0] = constructor;
+    bytes[1] = (value >> 8) & 0xFF;
+    bytes[2] = value & 0xFF;
+    return output_bytes(encode_buffer, bytes, sizeof(bytes));
+}
+
+static int encode_uint(ENCODE_BUFFER* encode_buffer, uint32_t value)
 {
     int result;
 
@@ -2355,612 +2530,645 @@ static int encode_uint(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, u
     {
         /* uint0 */
         /* Codes_SRS_AMQPVALUE_01_279: [<encoding name="uint0" code="0x43" category="fixed" width="0" label="the uint value 0"/>] */
-        if (output_byte(encoder_output, context, 0x43) != 0)
-        {
-            LogError("Failed encoding uint");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        result = output_byte(encode_buffer, 0x43);
     }
     else if (value <= 255)
     {
         /* smalluint */
         /* Codes_SRS_AMQPVALUE_01_278: [<encoding name="smalluint" code="0x52" category="fixed" width="1" label="unsigned integer value in the range 0 to 255 inclusive"/>] */
-        if ((output_byte(encoder_output, context, 0x52) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding uint");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        result = output_constructor_and_ubyte(encode_buffer, 0x52, value & 0xFF);
     }
     else
     {
         /* Codes_SRS_AMQPVALUE_01_277: [<encoding code="0x70" category="fixed" width="4" label="32-bit unsigned integer in network byte order"/>] */
-        if ((output_byte(encoder_output, context, 0x70) != 0) ||
-            (output_byte(encoder_output, context, (value >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding uint");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        result = output_constructor_and_uint32(encode_buffer, 0x70, value);
     }
 
     return result;
 }
 
-static int encode_ulong(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uint64_t value)
+static int encode_ulong(ENCODE_BUFFER* encode_buffer, uint64_t value)
 {
     int result;
+
     if (value == 0)
     {
         /* ulong0 */
         /* Codes_SRS_AMQPVALUE_01_282: [<encoding name="ulong0" code="0x44" category="fixed" width="0" label="the ulong value 0"/>] */
-        if (output_byte(encoder_output, context, 0x44) != 0)
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding ulong");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        result = output_byte(encode_buffer, 0x44);
     }
     else if (value <= 255)
     {
         /* smallulong */
         /* Codes_SRS_AMQPVALUE_01_281: [<encoding name="smallulong" code="0x53" category="fixed" width="1" label="unsigned long value in the range 0 to 255 inclusive"/>] */
-        if ((output_byte(encoder_output, context, 0x53) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding ulong");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        result = output_constructor_and_ubyte(encode_buffer, 0x53, value & 0xFF);
     }
     else
     {
         /* Codes_SRS_AMQPVALUE_01_280: [<encoding code="0x80" category="fixed" width="8" label="64-bit unsigned integer in network byte order"/>] */
-        if ((output_byte(encoder_output, context, 0x80) != 0) ||
-            (output_byte(encoder_output, context, (value >> 56) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 48) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 40) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 32) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding ulong");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        result = output_constructor_and_uint64(encode_buffer, 0x80, value);
     }
 
     return result;
 }
 
-static int encode_byte(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, char value)
+static int encode_int(ENCODE_BUFFER* encode_buffer, int32_t value)
 {
     int result;
 
-    /* Codes_SRS_AMQPVALUE_01_283: [<encoding code="0x51" category="fixed" width="1" label="8-bit two's-complement integer"/>] */
-    if ((output_byte(encoder_output, context, 0x51) != 0) ||
-        (output_byte(encoder_output, context, value) != 0))
+    if ((value <= 127) && (value >= -128))
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failed encoding byte");
-        result = __FAILURE__;
+        /* Codes_SRS_AMQPVALUE_01_286: [<encoding name="smallint" code="0x54" category="fixed" width="1" label="8-bit two's-complement integer"/>] */
+        result = output_constructor_and_ubyte(encode_buffer, 0x54, value & 0xFF);
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-        result = 0;
+        /* Codes_SRS_AMQPVALUE_01_285: [<encoding code="0x71" category="fixed" width="4" label="32-bit two's-complement integer in network byte order"/>] */
+        result = output_constructor_and_uint32(encode_buffer, 0x71, (uint32_t)value);
     }
 
     return result;
 }
 
-static int encode_short(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, int16_t value)
+static int encode_long(ENCODE_BUFFER* encode_buffer, int64_t value)
 {
     int result;
 
-    /* Codes_SRS_AMQPVALUE_01_284: [<encoding code="0x61" category="fixed" width="2" label="16-bit two's-complement integer in network byte order"/>] */
-    if ((output_byte(encoder_output, context, 0x61) != 0) ||
-        (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value & 0xFF)) != 0))
+    if ((value <= 127) && (value >= -128))
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failed encoding short");
-        result = __FAILURE__;
+        /* Codes_SRS_AMQPVALUE_01_288: [<encoding name="smalllong" code="0x55" category="fixed" width="1" label="8-bit two's-complement integer"/>] */
+        result = output_constructor_and_ubyte(encode_buffer, 0x55, value & 0xFF);
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-        result = 0;
+        /* Codes_SRS_AMQPVALUE_01_287: [<encoding code="0x81" category="fixed" width="8" label="64-bit two's-complement integer in network byte order"/>] */
+        result = output_constructor_and_uint64(encode_buffer, 0x81, (uint64_t)value);
     }
 
     return result;
 }
 
-static int encode_int(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, int32_t value)
+static int encode_variable(ENCODE_BUFFER* encode_buffer, unsigned char constructor8, unsigned char constructor32, const void* value, size_t length)
 {
     int result;
 
-    if ((value <= 127) && (value >= -128))
+    if (length <= 255)
     {
-        /* Codes_SRS_AMQPVALUE_01_286: [<encoding name="smallint" code="0x54" category="fixed" width="1" label="8-bit two's-complement integer"/>] */
-        if ((output_byte(encoder_output, context, 0x54) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
+        if (output_constructor_and_ubyte(encode_buffer, constructor8, (unsigned char)length) != 0)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding int");
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
+            result = output_bytes(encode_buffer, value, length);
         }
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_285: [<encoding code="0x71" category="fixed" width="4" label="32-bit two's-complement integer in network byte order"/>] */
-        if ((output_byte(encoder_output, context, 0x71) != 0) ||
-            (output_byte(encoder_output, context, (value >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
+        if (output_constructor_and_uint32(encode_buffer, constructor32, (uint32_t)length) != 0)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding int");
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
+            result = output_bytes(encode_buffer, value, length);
         }
     }
 
     return result;
 }
 
-static int encode_long(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, int64_t value)
+static int encode_compound_header(ENCODE_BUFFER* encode_buffer, unsigned char constructor8, unsigned char constructor32, uint32_t count, uint32_t items_size)
 {
     int result;
 
-    if ((value <= 127) && (value >= -128))
+    if ((count <= 255) && (items_size < 255))
     {
-        /* Codes_SRS_AMQPVALUE_01_288: [<encoding name="smalllong" code="0x55" category="fixed" width="1" label="8-bit two's-complement integer"/>] */
-        if ((output_byte(encoder_output, context, 0x55) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding long");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        unsigned char bytes[3];
+        bytes[0] = constructor8;
+        /* size */
+        bytes[1] = (unsigned char)(items_size + 1);
+        /* count */
+        bytes[2] = (unsigned char)count;
+        result = output_bytes(encode_buffer, bytes, sizeof(bytes));
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_287: [<encoding code="0x81" category="fixed" width="8" label="64-bit two's-complement integer in network byte order"/>] */
-        if ((output_byte(encoder_output, context, 0x81) != 0) ||
-            (output_byte(encoder_output, context, (value >> 56) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 48) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 40) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 32) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, value & 0xFF) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding long");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        unsigned char bytes[9];
+        uint32_t size = items_size + 4;
+        bytes[0] = constructor32;
+        /* size */
+        bytes[1] = (size >> 24) & 0xFF;
+        bytes[2] = (size >> 16) & 0xFF;
+        bytes[3] = (size >> 8) & 0xFF;
+        bytes[4] = size & 0xFF;
+        /* count */
+        bytes[5] = (count >> 24) & 0xFF;
+        bytes[6] = (count >> 16) & 0xFF;
+        bytes[7] = (count >> 8) & 0xFF;
+        bytes[8] = count & 0xFF;
+        result = output_bytes(encode_buffer, bytes, sizeof(bytes));
     }
 
     return result;
 }
 
-static int encode_float(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, float value)
+static int get_compound_encoded_size(uint32_t count, uint32_t items_size, size_t* encoded_size)
 {
     int result;
 
-    uint32_t value_as_uint32 = *((uint32_t*)(void*)&value);
-    /* Codes_SRS_AMQPVALUE_01_289: [\<encoding name="ieee-754" code="0x72" category="fixed" width="4" label="IEEE 754-2008 binary32"/>] */
-    if ((output_byte(encoder_output, context, 0x72) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint32 >> 24) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint32 >> 16) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint32 >> 8) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint32) & 0xFF) != 0))
+    if ((count <= 255) && (items_size < 255))
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failure encoding bytes for float");
+        *encoded_size = (size_t)items_size + 3;
+        result = 0;
+    }
+    else if (items_size > UINT32_MAX - 4)
+    {
+        LogError("Encoded data is more than the max size for a compound value");
         result = __FAILURE__;
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
+        *encoded_size = (size_t)items_size + 9;
         result = 0;
     }
 
     return result;
 }
 
-static int encode_double(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, double value)
+static int compute_encoded_size(AMQP_VALUE value, size_t* encoded_size);
+
+static int compute_items_encoded_size(AMQP_VALUE* items, uint32_t count, uint32_t* items_size)
 {
+    uint32_t i;
     int result;
 
-    uint64_t value_as_uint64 = *((uint64_t*)(void*)&value);
-    /* Codes_SRS_AMQPVALUE_01_290: [\<encoding name="ieee-754" code="0x82" category="fixed" width="8" label="IEEE 754-2008 binary64"/>] */
-    if ((output_byte(encoder_output, context, 0x82) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 56) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 48) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 40) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 32) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 24) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 16) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64 >> 8) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value_as_uint64) & 0xFF) != 0))
-    {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failure encoding bytes for double");
-        result = __FAILURE__;
-    }
-    else
+    *items_size = 0;
+    for (i = 0; i < count; i++)
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-        result = 0;
-    }
+        size_t item_size;
+        if (compute_encoded_size(items[i], &item_size) != 0)
+        {
+            LogError("Could not get encoded size for element %u", (unsigned int)i);
+            break;
+        }
 
-    return result;
-}
+        if ((item_size > UINT32_MAX) ||
+            (*items_size + (uint32_t)item_size < *items_size))
+        {
+            LogError("Overflow in compound size computation");
+            break;
+        }
 
-static int encode_timestamp(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, int64_t value)
-{
-    int result;
+        *items_size = (uint32_t)(*items_size + item_size);
+    }
 
-    /* Codes_SRS_AMQPVALUE_01_295: [<encoding name="ms64" code="0x83" category="fixed" width="8" label="64-bit two's-complement integer representing milliseconds since the unix epoch"/>] */
-    if ((output_byte(encoder_output, context, 0x83) != 0) ||
-        (output_byte(encoder_output, context, (value >> 56) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value >> 48) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value >> 40) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value >> 32) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value >> 24) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value >> 16) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, (value >> 8) & 0xFF) != 0) ||
-        (output_byte(encoder_output, context, value & 0xFF) != 0))
+    if (i < count)
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failed encoding timestamp");
         result = __FAILURE__;
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
         result = 0;
     }
 
     return result;
 }
 
-static int encode_uuid(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uuid uuid)
+/* The sizes are computed in one bottom-up pass. The size of the items of each list, map and array is kept in
+   that value, so that its header can be written without walking the items again. */
+static int compute_encoded_size(AMQP_VALUE value, size_t* encoded_size)
 {
     int result;
 
-    /* Codes_SRS_AMQPVALUE_01_296: [<encoding code="0x98" category="fixed" width="16" label="UUID as defined in section 4.1.2 of RFC-4122"/>] */
-    if ((output_byte(encoder_output, context, 0x98) != 0) ||
-        (output_bytes(encoder_output, context, uuid, 16)  != 0))
+    if (value == NULL)
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        LogError("Failed encoding uuid");
+        LogError("NULL value in the value to encode");
         result = __FAILURE__;
     }
     else
     {
-        /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
+        AMQP_VALUE_DATA* value_data = (AMQP_VALUE_DATA*)value;
         result = 0;
-    }
 
-    return result;
-}
-
-static int encode_binary(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, const unsigned char* value, uint32_t length)
-{
-    int result;
-    if (length <= 255)
-    {
-        /* Codes_SRS_AMQPVALUE_01_297: [<encoding name="vbin8" code="0xa0" category="variable" width="1" label="up to 2^8 - 1 octets of binary data"/>] */
-        if ((output_byte(encoder_output, context, 0xA0) != 0) ||
-            (output_byte(encoder_output, context, (unsigned char)length) != 0) ||
-            ((length > 0) && (output_bytes(encoder_output, context, value, length) != 0)))
+        switch (value_data->type)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding binary");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
-    }
-    else
-    {
-        /* Codes_SRS_AMQPVALUE_01_298: [<encoding name="vbin32" code="0xb0" category="variable" width="4" label="up to 2^32 - 1 octets of binary data"/>] */
-        if ((output_byte(encoder_output, context, 0xB0) != 0) ||
-            (output_byte(encoder_output, context, (length >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (length >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (length >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, length & 0xFF) != 0) ||
-            (output_bytes(encoder_output, context, value, length) != 0))
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding binary");
+        default:
+            /* Codes_SRS_AMQPVALUE_01_271: [If encoding fails due to any error not specifically mentioned here, it shall return a non-zero value.] */
+            LogError("Invalid type: %d", (int)value_data->type);
             result = __FAILURE__;
+            break;
+
+        case AMQP_TYPE_NULL:
+        case AMQP_TYPE_BOOL:
+            *encoded_size = 1;
+            break;
+
+        case AMQP_TYPE_UBYTE:
+        case AMQP_TYPE_BYTE:
+            *encoded_size = 2;
+            break;
+
+        case AMQP_TYPE_USHORT:
+        case AMQP_TYPE_SHORT:
+            *encoded_size = 3;
+            break;
+
+        case AMQP_TYPE_UINT:
+            *encoded_size = (value_data->value.uint_value == 0) ? 1 : (value_data->value.uint_value <= 255) ? 2 : 5;
+            break;
+
+        case AMQP_TYPE_ULONG:
+            *encoded_size = (value_data->value.ulong_value == 0) ? 1 : (value_data->value.ulong_value <= 255) ? 2 : 9;
+            break;
+
+        case AMQP_TYPE_INT:
+            *encoded_size = ((value_data->value.int_value <= 127) && (value_data->value.int_value >= -128)) ? 2 : 5;
+            break;
+
+        case AMQP_TYPE_LONG:
+            *encoded_size = ((value_data->value.long_value <= 127) && (value_data->value.long_value >= -128)) ? 2 : 9;
+            break;
+
+        case AMQP_TYPE_FLOAT:
+            *encoded_size = 5;
+            break;
+
+        case AMQP_TYPE_DOUBLE:
+        case AMQP_TYPE_TIMESTAMP:
+            *encoded_size = 9;
+            break;
+
+        case AMQP_TYPE_UUID:
+            *encoded_size = 17;
+            break;
+
+        case AMQP_TYPE_BINARY:
+            *encoded_size = (size_t)value_data->value.binary_value.length + ((value_data->value.binary_value.length <= 255) ? 2 : 5);
+            break;
+
+        case AMQP_TYPE_STRING:
+        case AMQP_TYPE_SYMBOL:
+        {
+            size_t length = strlen((value_data->type == AMQP_TYPE_STRING) ? value_data->value.string_value.chars : value_data->value.symbol_value.chars);
+            *encoded_size = length + ((length <= 255) ? 2 : 5);
+            break;
         }
-        else
+
+        case AMQP_TYPE_LIST:
+            if (value_data->value.list_value.count == 0)
+            {
+                *encoded_size = 1;
+            }
+            else if ((compute_items_encoded_size(value_data->value.list_value.items, value_data->value.list_value.count, &value_data->value.list_value.encoded_size) != 0) ||
+                (get_compound_encoded_size(value_data->value.list_value.count, value_data->value.list_value.encoded_size, encoded_size) != 0))
+            {
+                LogError("Could not get encoded size for list");
+                result = __FAILURE__;
+            }
+            break;
+
+        case AMQP_TYPE_ARRAY:
+            if ((compute_items_encoded_size(value_data->value.array_value.items, value_data->value.array_value.count, &value_data->value.array_value.encoded_size) != 0) ||
+                (get_compound_encoded_size(value_data->value.array_value.count, value_data->value.array_value.encoded_size, encoded_size) != 0))
+            {
+                LogError("Could not get encoded size for array");
+                result = __FAILURE__;
+            }
+            break;
+
+        case AMQP_TYPE_MAP:
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
+            uint32_t i;
+            uint32_t items_size = 0;
+
+            for (i = 0; i < value_data->value.map_value.pair_count; i++)
+            {
+                size_t key_size;
+                size_t value_size;
+                if ((compute_encoded_size(value_data->value.map_value.pairs[i].key, &key_size) != 0) ||
+                    (compute_encoded_size(value_data->value.map_value.pairs[i].value, &value_size) != 0))
+                {
+                    LogError("Could not get encoded size for element %u of the map", (unsigned int)i);
+                    break;
+                }
+
+                if ((key_size > UINT32_MAX) ||
+                    (value_size > UINT32_MAX - (uint32_t)key_size) ||
+                    (items_size + (uint32_t)(key_size + value_size) < items_size))
+                {
+                    LogError("Encoded data is more than the max size for a map");
+                    break;
+                }
+
+                items_size += (uint32_t)(key_size + value_size);
+            }
+
+            /* Codes_SRS_AMQPVALUE_01_124: [Map encodings MUST contain an even number of items (i.e. an equal number of keys and values).] */
+            if ((i < value_data->value.map_value.pair_count) ||
+                (value_data->value.map_value.pair_count > UINT32_MAX / 2) ||
+                (get_compound_encoded_size(value_data->value.map_value.pair_count * 2, items_size, encoded_size) != 0))
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                value_data->value.map_value.encoded_size = items_size;
+            }
+            break;
+        }
+
+        case AMQP_TYPE_COMPOSITE:
+        case AMQP_TYPE_DESCRIBED:
+        {
+            size_t descriptor_size;
+            size_t described_size;
+            if ((compute_encoded_size(value_data->value.described_value.descriptor, &descriptor_size) != 0) ||
+                (compute_encoded_size(value_data->value.described_value.value, &described_size) != 0))
+            {
+                LogError("Could not get encoded size for described or composite type");
+                result = __FAILURE__;
+            }
+            else
+            {
+                *encoded_size = 1 + descriptor_size + described_size;
+            }
+            break;
+        }
         }
     }
 
     return result;
 }
 
-static int encode_string(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, const char* value)
+/* Writes a value whose size has just been computed by compute_encoded_size */
+static int encode_value(ENCODE_BUFFER* encode_buffer, AMQP_VALUE value)
 {
     int result;
-    size_t length = strlen(value);
+    AMQP_VALUE_DATA* value_data = (AMQP_VALUE_DATA*)value;
 
-    if (length <= 255)
+    switch (value_data->type)
     {
-        /* Codes_SRS_AMQPVALUE_01_299: [<encoding name="str8-utf8" code="0xa1" category="variable" width="1" label="up to 2^8 - 1 octets worth of UTF-8 Unicode (with no byte order mark)"/>] */
-        if ((output_byte(encoder_output, context, (unsigned char)0xA1) != 0) ||
-            (output_byte(encoder_output, context, (unsigned char)length) != 0) ||
-            (output_bytes(encoder_output, context, value, length) != 0))
+    default:
+        /* Codes_SRS_AMQPVALUE_01_271: [If encoding fails due to any error not specifically mentioned here, it shall return a non-zero value.] */
+        LogError("Invalid type: %d", (int)value_data->type);
+        result = __FAILURE__;
+        break;
+
+    case AMQP_TYPE_NULL:
+        /* Codes_SRS_AMQPVALUE_01_264: [<encoding code="0x40" category="fixed" width="0" label="the null value"/>] */
+        result = output_byte(encode_buffer, 0x40);
+        break;
+
+    case AMQP_TYPE_BOOL:
+        result = encode_boolean(encode_buffer, value_data->value.bool_value);
+        break;
+
+    case AMQP_TYPE_UBYTE:
+        /* Codes_SRS_AMQPVALUE_01_275: [<encoding code="0x50" category="fixed" width="1" label="8-bit unsigned integer"/>] */
+        result = output_constructor_and_ubyte(encode_buffer, 0x50, value_data->value.ubyte_value);
+        break;
+
+    case AMQP_TYPE_USHORT:
+        /* Codes_SRS_AMQPVALUE_01_276: [<encoding code="0x60" category="fixed" width="2" label="16-bit unsigned integer in network byte order"/>] */
+        result = encode_ushort(encode_buffer, 0x60, value_data->value.ushort_value);
+        break;
+
+    case AMQP_TYPE_UINT:
+        result = encode_uint(encode_buffer, value_data->value.uint_value);
+        break;
+
+    case AMQP_TYPE_ULONG:
+        result = encode_ulong(encode_buffer, value_data->value.ulong_value);
+        break;
+
+    case AMQP_TYPE_BYTE:
+        /* Codes_SRS_AMQPVALUE_01_283: [<encoding code="0x51" category="fixed" width="1" label="8-bit two's-complement integer"/>] */
+        result = output_constructor_and_ubyte(encode_buffer, 0x51, (unsigned char)value_data->value.byte_value);
+        break;
+
+    case AMQP_TYPE_SHORT:
+        /* Codes_SRS_AMQPVALUE_01_284: [<encoding code="0x61" category="fixed" width="2" label="16-bit two's-complement integer in network byte order"/>] */
+        result = encode_ushort(encode_buffer, 0x61, (uint16_t)value_data->value.short_value);
+        break;
+
+    case AMQP_TYPE_INT:
+        result = encode_int(encode_buffer, value_data->value.int_value);
+        break;
+
+    case AMQP_TYPE_LONG:
+        result = encode_long(encode_buffer, value_data->value.long_value);
+        break;
+
+    case AMQP_TYPE_FLOAT:
+    {
+        uint32_t value_as_uint32;
+        (void)memcpy(&value_as_uint32, &value_data->value.float_value, sizeof(value_as_uint32));
+        /* Codes_SRS_AMQPVALUE_01_289: [\<encoding name="ieee-754" code="0x72" category="fixed" width="4" label="IEEE 754-2008 binary32"/>] */
+        result = output_constructor_and_uint32(encode_buffer, 0x72, value_as_uint32);
+        break;
+    }
+
+    case AMQP_TYPE_DOUBLE:
+    {
+        uint64_t value_as_uint64;
+        (void)memcpy(&value_as_uint64, &value_data->value.double_value, sizeof(value_as_uint64));
+        /* Codes_SRS_AMQPVALUE_01_290: [\<encoding name="ieee-754" code="0x82" category="fixed" width="8" label="IEEE 754-2008 binary64"/>] */
+        result = output_constructor_and_uint64(encode_buffer, 0x82, value_as_uint64);
+        break;
+    }
+
+    case AMQP_TYPE_TIMESTAMP:
+        /* Codes_SRS_AMQPVALUE_01_295: [<encoding name="ms64" code="0x83" category="fixed" width="8" label="64-bit two's-complement integer representing milliseconds since the unix epoch"/>] */
+        result = output_constructor_and_uint64(encode_buffer, 0x83, (uint64_t)value_data->value.timestamp_value);
+        break;
+
+    case AMQP_TYPE_UUID:
+        /* Codes_SRS_AMQPVALUE_01_296: [<encoding code="0x98" category="fixed" width="16" label="UUID as defined in section 4.1.2 of RFC-4122"/>] */
+        if (output_byte(encode_buffer, 0x98) != 0)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding string");
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
+            result = output_bytes(encode_buffer, value_data->value.uuid_value, 16);
         }
-    }
-    else
-    {
+        break;
+
+    case AMQP_TYPE_BINARY:
+        /* Codes_SRS_AMQPVALUE_01_297: [<encoding name="vbin8" code="0xa0" category="variable" width="1" label="up to 2^8 - 1 octets of binary data"/>] */
+        /* Codes_SRS_AMQPVALUE_01_298: [<encoding name="vbin32" code="0xb0" category="variable" width="4" label="up to 2^32 - 1 octets of binary data"/>] */
+        result = encode_variable(encode_buffer, 0xA0, 0xB0, value_data->value.binary_value.bytes, value_data->value.binary_value.length);
+        break;
+
+    case AMQP_TYPE_STRING:
+        /* Codes_SRS_AMQPVALUE_01_299: [<encoding name="str8-utf8" code="0xa1" category="variable" width="1" label="up to 2^8 - 1 octets worth of UTF-8 Unicode (with no byte order mark)"/>] */
         /* Codes_SRS_AMQPVALUE_01_300: [<encoding name="str32-utf8" code="0xb1" category="variable" width="4" label="up to 2^32 - 1 octets worth of UTF-8 Unicode (with no byte order mark)"/>] */
-        if ((output_byte(encoder_output, context, 0xB1) != 0) ||
-            (output_byte(encoder_output, context, (length >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (length >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (length >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, length & 0xFF) != 0) ||
-            (output_bytes(encoder_output, context, value, length) != 0))
+        result = encode_variable(encode_buffer, 0xA1, 0xB1, value_data->value.string_value.chars, strlen(value_data->value.string_value.chars));
+        break;
+
+    case AMQP_TYPE_SYMBOL:
+        /* Codes_SRS_AMQPVALUE_01_301: [<encoding name="sym8" code="0xa3" category="variable" width="1" label="up to 2^8 - 1 seven bit ASCII characters representing a symbolic value"/>] */
+        /* Codes_SRS_AMQPVALUE_01_302: [<encoding name="sym32" code="0xb3" category="variable" width="4" label="up to 2^32 - 1 seven bit ASCII characters representing a symbolic value"/>] */
+        /* Codes_SRS_AMQPVALUE_01_122: [Symbols are encoded as ASCII characters [ASCII].] */
+        result = encode_variable(encode_buffer, 0xA3, 0xB3, value_data->value.symbol_value.chars, strlen(value_data->value.symbol_value.chars));
+        break;
+
+    case AMQP_TYPE_LIST:
+    {
+        uint32_t i;
+
+        if (value_data->value.list_value.count == 0)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding string");
+            /* Codes_SRS_AMQPVALUE_01_303: [<encoding name="list0" code="0x45" category="fixed" width="0" label="the empty list (i.e. the list with no elements)"/>] */
+            result = output_byte(encode_buffer, 0x45);
+        }
+        /* Codes_SRS_AMQPVALUE_01_304: [<encoding name="list8" code="0xc0" category="compound" width="1" label="up to 2^8 - 1 list elements with total size less than 2^8 octets"/>] */
+        /* Codes_SRS_AMQPVALUE_01_305: [<encoding name="list32" code="0xd0" category="compound" width="4" label="up to 2^32 - 1 list elements with total size less than 2^32 octets"/>] */
+        else if (encode_compound_header(encode_buffer, 0xC0, 0xD0, value_data->value.list_value.count, value_data->value.list_value.encoded_size) != 0)
+        {
+            LogError("Failed encoding list");
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
+            for (i = 0; i < value_data->value.list_value.count; i++)
+            {
+                if (encode_value(encode_buffer, value_data->value.list_value.items[i]) != 0)
+                {
+                    LogError("Failed encoding element %u of the list", (unsigned int)i);
+                    break;
+                }
+            }
+
+            result = (i < value_data->value.list_value.count) ? __FAILURE__ : 0;
         }
+        break;
     }
 
-    return result;
-}
+    case AMQP_TYPE_ARRAY:
+    {
+        uint32_t i;
 
-static int encode_symbol(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, const char* value)
-{
-    int result;
-    size_t length = strlen(value);
+        /* Codes_SRS_AMQPVALUE_01_306: [<encoding name="map8" code="0xE0" category="compound" width="1" label="up to 2^8 - 1 octets of encoded map data"/>] */
+        /* Codes_SRS_AMQPVALUE_01_307: [<encoding name="map32" code="0xF0" category="compound" width="4" label="up to 2^32 - 1 octets of encoded map data"/>] */
+        if (encode_compound_header(encode_buffer, 0xE0, 0xF0, value_data->value.array_value.count, value_data->value.array_value.encoded_size) != 0)
+        {
+            LogError("Could not encode array");
+            result = __FAILURE__;
+        }
+        else
+        {
+            for (i = 0; i < value_data->value.array_value.count; i++)
+            {
+                if (encode_value(encode_buffer, value_data->value.array_value.items[i]) != 0)
+                {
+                    LogError("Failed encoding element %u of the array", (unsigned int)i);
+                    break;
+                }
+            }
 
-    if (length <= 255)
+            result = (i < value_data->value.array_value.count) ? __FAILURE__ : 0;
+        }
+        break;
+    }
+
+    case AMQP_TYPE_MAP:
     {
-        /* Codes_SRS_AMQPVALUE_01_301: [<encoding name="sym8" code="0xa3" category="variable" width="1" label="up to 2^8 - 1 seven bit ASCII characters representing a symbolic value"/>] */
-        if ((output_byte(encoder_output, context, (unsigned char)0xA3) != 0) ||
-            (output_byte(encoder_output, context, (unsigned char)length) != 0) ||
-            (output_bytes(encoder_output, context, value, length) != 0))
+        uint32_t i;
+
+        /* Codes_SRS_AMQPVALUE_01_306: [<encoding name="map8" code="0xc1" category="compound" width="1" label="up to 2^8 - 1 octets of encoded map data"/>] */
+        /* Codes_SRS_AMQPVALUE_01_307: [<encoding name="map32" code="0xd1" category="compound" width="4" label="up to 2^32 - 1 octets of encoded map data"/>] */
+        if (encode_compound_header(encode_buffer, 0xC1, 0xD1, value_data->value.map_value.pair_count * 2, value_data->value.map_value.encoded_size) != 0)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding symbol");
+            LogError("Could not encode map header");
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
+            /* Codes_SRS_AMQPVALUE_01_123: [A map is encoded as a compound value where the constituent elements form alternating key value pairs.] */
+            for (i = 0; i < value_data->value.map_value.pair_count; i++)
+            {
+                if ((encode_value(encode_buffer, value_data->value.map_value.pairs[i].key) != 0) ||
+                    (encode_value(encode_buffer, value_data->value.map_value.pairs[i].value) != 0))
+                {
+                    LogError("Failed encoding map element %u", (unsigned int)i);
+                    break;
+                }
+            }
+
+            result = (i < value_data->value.map_value.pair_count) ? __FAILURE__ : 0;
         }
+        break;
     }
-    else
+
+    case AMQP_TYPE_COMPOSITE:
+    case AMQP_TYPE_DESCRIBED:
     {
-        /* Codes_SRS_AMQPVALUE_01_302: [<encoding name="sym32" code="0xb3" category="variable" width="4" label="up to 2^32 - 1 seven bit ASCII characters representing a symbolic value"/>] */
-        if ((output_byte(encoder_output, context, 0xB3) != 0) ||
-            (output_byte(encoder_output, context, (length >> 24) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (length >> 16) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, (length >> 8) & 0xFF) != 0) ||
-            (output_byte(encoder_output, context, length & 0xFF) != 0) ||
-            /* Codes_SRS_AMQPVALUE_01_122: [Symbols are encoded as ASCII characters [ASCII].] */
-            (output_bytes(encoder_output, context, value, length) != 0))
+        if ((output_byte(encode_buffer, 0x00) != 0) ||
+            (encode_value(encode_buffer, value_data->value.described_value.descriptor) != 0) ||
+            (encode_value(encode_buffer, value_data->value.described_value.value) != 0))
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Failed encoding symbol");
+            LogError("Failed encoding described or composite type");
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
             result = 0;
         }
+
+        break;
+    }
     }
 
     return result;
 }
 
-static int encode_list(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uint32_t count, AMQP_VALUE* items)
+/* Codes_SRS_AMQPVALUE_01_265: [amqpvalue_encode shall encode the value per the ISO.] */
+int amqpvalue_encode(AMQP_VALUE value, AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context)
 {
-    size_t i;
     int result;
 
-    if (count == 0)
+    /* Codes_SRS_AMQPVALUE_01_269: [If value or encoder_output are NULL, amqpvalue_encode shall fail and return a non-zero value.] */
+    if ((value == NULL) ||
+        (encoder_output == NULL))
     {
-        /* Codes_SRS_AMQPVALUE_01_303: [<encoding name="list0" code="0x45" category="fixed" width="0" label="the empty list (i.e. the list with no elements)"/>] */
-        if (output_byte(encoder_output, context, 0x45) != 0)
-        {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-            LogError("Could not output list constructor byte");
-            result = __FAILURE__;
-        }
-        else
-        {
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = 0;
-        }
+        LogError("Bad arguments: value = %p, encoder_output = %p",
+            value, encoder_output);
+        result = __FAILURE__;
     }
     else
     {
-        uint32_t size = 0;
-
-        /* get the size of all items in the list */
-        for (i = 0; i < count; i++)
-        {
-            size_t item_size;
-            if (amqpvalue_get_encoded_size(items[i], &item_size) != 0)
-            {
-                LogError("Could not get encoded size for element %u of the list", (unsigned int)i);
-                break;
-            }
-
-            if ((item_size > UINT32_MAX) ||
-                size + (uint32_t)item_size < size)
-            {
-                LogError("Overflow in list size computation");
-                break;
-            }
-
-            size = (uint32_t)(size + item_size);
-        }
+        size_t encoded_size;
 
-        if (i < count)
+        if (compute_encoded_size(value, &encoded_size) != 0)
         {
-            /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
+            /* Codes_SRS_AMQPVALUE_01_271: [If encoding fails due to any error not specifically mentioned here, it shall return a non-zero value.] */
+            LogError("Could not compute the encoded size");
             result = __FAILURE__;
         }
         else
         {
-            if ((count <= 255) && (size < 255))
+            unsigned char staging_bytes[ENCODE_STAGING_BUFFER_SIZE];
+            ENCODE_BUFFER encode_buffer;
+            encode_buffer.bytes = staging_bytes;
+            encode_buffer.size = sizeof(staging_bytes);
+            encode_buffer.pos = 0;
+            encode_buffer.encoder_output = encoder_output;
+            encode_buffer.context = context;
+
+            /* Codes_SRS_AMQPVALUE_01_429: [amqpvalue_encode shall gather the encoded bytes and pass them to the encoder_output function in as few calls as possible, passing binary, string and symbol contents that do not fit in its buffer without copying them.] */
+            if ((encode_value(&encode_buffer, value) != 0) ||
+                (flush_encode_buffer(&encode_buffer) != 0))
             {
-                size++;
-
-                /* Codes_SRS_AMQPVALUE_01_304: [<encoding name="list8" code="0xc0" category="compound" width="1" label="up to 2^8 - 1 list elements with total size less than 2^8 octets"/>] */
-                if ((output_byte(encoder_output, context, 0xC0) != 0) ||
-                    /* size */
-                    (output_byte(encoder_output, context, (size & 0xFF)) != 0) ||
-                    /* count */
-                    (output_byte(encoder_output, context, (count & 0xFF)) != 0))
-                {
-                    /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-                    LogError("Failed encoding list");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-                    result = 0;
-                }
+                /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
+                LogError("Failed encoding value");
+                result = __FAILURE__;
             }
             else
             {
-                size += 4;
-
-                /* Codes_SRS_AMQPVALUE_01_305: [<encoding name="list32" code="0xd0" category="compound" width="4" label="up to 2^32 - 1 list elements with total size less than 2^32 octets"/>] */
-                if ((output_byte(encoder_output, context, 0xD0) != 0) ||
-                    /* size */
-                    (output_byte(encoder_output, context, (size >> 24) & 0xFF) != 0) ||
-                    (output_byte(encoder_output, context, (size >> 16) & 0xFF) != 0) ||
-                    (output_byte(encoder_output, context, (size >> 8) & 0xFF) != 0) ||
-                    (output_byte(encoder_output, context, size & 0xFF) != 0) ||
-                    /* count */
-                    (output_byte(encoder_output, context, (count >> 24) & 0xFF) != 0) ||
-                    (output_byte(encoder_output, context, (count >> 16) & 0xFF) != 0) ||
-                    (output_byte(encoder_output, context, (count >> 8) & 0xFF) != 0) ||
-                    (output_byte(encoder_output, context, count & 0xFF) != 0))
-                {
-                    /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-                    LogError("Failed encoding list");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-                    result = 0;
-                }
-            }
-
-            if (result == 0)
-            {
-                for (i = 0; i < count; i++)
-                {
-                    if (amqpvalue_encode(items[i], encoder_output, context) != 0)
-                    {
-                        break;
-                    }
-                }
-
-                if (i < count)
-                {
-                    LogError("Failed encoding element %u of the list", (unsigned int)i);
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    result = 0;
-                }
+                /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
+                result = 0;
             }
         }
     }
@@ -2968,127 +3176,55 @@ static int encode_list(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, u
     return result;
 }
 
-static int encode_map(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uint32_t count, AMQP_MAP_KEY_VALUE_PAIR* pairs)
+int amqpvalue_encode_to_buffer(AMQP_VALUE value, unsigned char* buffer, size_t buffer_size, size_t* encoded_size)
 {
-    size_t i;
     int result;
 
-    uint32_t size = 0;
-
-    /* Codes_SRS_AMQPVALUE_01_124: [Map encodings MUST contain an even number of items (i.e. an equal number of keys and values).] */
-    uint32_t elements = count * 2;
-
-    /* get the size of all items in the list */
-    for (i = 0; i < count; i++)
-    {
-        size_t item_size;
-        if (amqpvalue_get_encoded_size(pairs[i].key, &item_size) != 0)
-        {
-            LogError("Could not get encoded size for key element %u of the map", (unsigned int)i);
-            break;
-        }
-
-        if ((item_size > UINT32_MAX) ||
-            size + (uint32_t)item_size < size)
-        {
-            LogError("Encoded data is more than the max size for a map");
-            break;
-        }
-
-        size = (uint32_t)(size + item_size);
-
-        if (amqpvalue_get_encoded_size(pairs[i].value, &item_size) != 0)
-        {
-            LogError("Could not get encoded size for value element %u of the map", (unsigned int)i);
-            break;
-        }
-
-        if ((item_size > UINT32_MAX) ||
-            size + (uint32_t)item_size < size)
-        {
-            LogError("Encoded data is more than the max size for a map");
-            break;
-        }
-
-        size = (uint32_t)(size + item_size);
-    }
-
-    if (i < count)
+    /* Codes_SRS_AMQPVALUE_01_432: [If value, buffer or encoded_size is NULL, amqpvalue_encode_to_buffer shall fail and return a non-zero value.] */
+    if ((value == NULL) ||
+        (buffer == NULL) ||
+        (encoded_size == NULL))
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
+        LogError("Bad arguments: value = %p, buffer = %p, encoded_size = %p",
+            value, buffer, encoded_size);
         result = __FAILURE__;
     }
     else
     {
-        if ((elements <= 255) && (size < 255))
-        {
-            size++;
+        size_t needed_size;
 
-            /* Codes_SRS_AMQPVALUE_01_306: [<encoding name="map8" code="0xc1" category="compound" width="1" label="up to 2^8 - 1 octets of encoded map data"/>] */
-            if ((output_byte(encoder_output, context, 0xC1) != 0) ||
-                /* size */
-                (output_byte(encoder_output, context, (size & 0xFF)) != 0) ||
-                /* count */
-                (output_byte(encoder_output, context, (elements & 0xFF)) != 0))
-            {
-                /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-                LogError("Could not encode map header");
-                result = __FAILURE__;
-            }
-            else
-            {
-                /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-                result = 0;
-            }
+        /* Codes_SRS_AMQPVALUE_01_434: [If encoding fails due to any error not specifically mentioned here, amqpvalue_encode_to_buffer shall fail and return a non-zero value.] */
+        if (compute_encoded_size(value, &needed_size) != 0)
+        {
+            LogError("Could not compute the encoded size");
+            result = __FAILURE__;
         }
-        else
+        /* Codes_SRS_AMQPVALUE_01_433: [If buffer_size is smaller than the encoded size of value, amqpvalue_encode_to_buffer shall fail and return a non-zero value without writing to buffer.] */
+        else if (needed_size > buffer_size)
         {
-            size += 4;
-
-            /* Codes_SRS_AMQPVALUE_01_307: [<encoding name="map32" code="0xd1" category="compound" width="4" label="up to 2^32 - 1 octets of encoded map data"/>] */
-            if ((output_byte(encoder_output, context, 0xD1) != 0) ||
-                /* size */
-                (output_byte(encoder_output, context, (size >> 24) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (size >> 16) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (size >> 8) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, size & 0xFF) != 0) ||
-                /* count */
-                (output_byte(encoder_output, context, (elements >> 24) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (elements >> 16) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (elements >> 8) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, elements & 0xFF) != 0))
-            {
-                /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-                LogError("Could not encode map header");
-                result = __FAILURE__;
-            }
-            else
-            {
-                /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-                result = 0;
-            }
+            LogError("Buffer too small: %u bytes needed, %u bytes available", (unsigned int)needed_size, (unsigned int)buffer_size);
+            result = __FAILURE__;
         }
-
-        if (result == 0)
+        else
         {
-            /* Codes_SRS_AMQPVALUE_01_123: [A map is encoded as a compound value where the constituent elements form alternating key value pairs.] */
-            for (i = 0; i < count; i++)
-            {
-                if ((amqpvalue_encode(pairs[i].key, encoder_output, context) != 0) ||
-                    (amqpvalue_encode(pairs[i].value, encoder_output, context) != 0))
-                {
-                    LogError("Failed encoding map element %u", (unsigned int)i);
-                    break;
-                }
-            }
+            ENCODE_BUFFER encode_buffer;
+            encode_buffer.bytes = buffer;
+            encode_buffer.size = needed_size;
+            encode_buffer.pos = 0;
+            encode_buffer.encoder_output = NULL;
+            encode_buffer.context = NULL;
 
-            if (i < count)
+            /* Codes_SRS_AMQPVALUE_01_430: [amqpvalue_encode_to_buffer shall encode the value per the ISO into buffer and fill in encoded_size the number of bytes written.] */
+            if (encode_value(&encode_buffer, value) != 0)
             {
-                LogError("Could not encode map");
+                LogError("Failed encoding value");
                 result = __FAILURE__;
             }
             else
             {
+                *encoded_size = encode_buffer.pos;
+
+                /* Codes_SRS_AMQPVALUE_01_431: [On success amqpvalue_encode_to_buffer shall return 0.] */
                 result = 0;
             }
         }
@@ -3097,372 +3233,216 @@ static int encode_map(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, ui
     return result;
 }
 
-static int encode_array(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context, uint32_t count, AMQP_VALUE* items)
+int amqpvalue_get_encoded_size(AMQP_VALUE value, size_t* encoded_size)
 {
-    size_t i;
     int result;
 
-    uint32_t size = 0;
-
-    /* get the size of all items in the array */
-    for (i = 0; i < count; i++)
+    /* Codes_SRS_AMQPVALUE_01_309: [If any argument is NULL, amqpvalue_get_encoded_size shall return a non-zero value.] */
+    if ((value == NULL) ||
+        (encoded_size == NULL))
     {
-        size_t item_size;
-        if (amqpvalue_get_encoded_size(items[i], &item_size) != 0)
-        {
-            LogError("Could not get encoded size for element %u of the array", (unsigned int)i);
-            break;
-        }
-
-        if ((item_size > UINT32_MAX) ||
-            size + (uint32_t)item_size < size)
-        {
-            LogError("Overflow in array size computation");
-            break;
-        }
+        LogError("Bad arguments: value = %p, encoded_size = %p",
+            value, encoded_size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_AMQPVALUE_01_308: [amqpvalue_get_encoded_size shall fill in the encoded_size argument the number of bytes required to encode the given AMQP value.] */
+        result = compute_encoded_size(value, encoded_size);
+    }
 
-        size = (uint32_t)(size + item_size);
+    return result;
+}
 
+static void decode_arena_generation_destroy(DECODE_ARENA_GENERATION* generation)
+{
+    DECODE_ARENA_BLOCK* block = generation->blocks;
+    while (block != NULL)
+    {
+        DECODE_ARENA_BLOCK* next_block = block->next;
+        free(block);
+        block = next_block;
     }
 
-    if (i < count)
+    free(generation);
+}
+
+static void* decode_arena_allocate(DECODE_ARENA_GENERATION* generation, size_t size)
+{
+    void* result;
+    DECODE_ARENA_BLOCK* block = generation->current_block;
+    size_t aligned_size = DECODE_ARENA_ALIGN(size);
+
+    if (aligned_size < size)
     {
-        /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-        result = __FAILURE__;
+        LogError("Arena allocation size too big: %lu", (unsigned long)size);
+        result = NULL;
     }
     else
     {
-        if ((count <= 255) && (size < 255))
-        {
-            size++;
-
-            /* Codes_SRS_AMQPVALUE_01_306: [<encoding name="map8" code="0xE0" category="compound" width="1" label="up to 2^8 - 1 octets of encoded map data"/>] */
-            if ((output_byte(encoder_output, context, 0xE0) != 0) ||
-                /* size */
-                (output_byte(encoder_output, context, (size & 0xFF)) != 0) ||
-                /* count */
-                (output_byte(encoder_output, context, (count & 0xFF)) != 0))
-            {
-                /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-                LogError("Could not encode map header");
-                result = __FAILURE__;
-            }
-            else
-            {
-                /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-                result = 0;
-            }
-        }
-        else
+        if ((block == NULL) ||
+            (block->size - block->used < aligned_size))
         {
-            size += 4;
-
-            /* Codes_SRS_AMQPVALUE_01_307: [<encoding name="map32" code="0xF0" category="compound" width="4" label="up to 2^32 - 1 octets of encoded map data"/>] */
-            if ((output_byte(encoder_output, context, 0xF0) != 0) ||
-                /* size */
-                (output_byte(encoder_output, context, (size >> 24) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (size >> 16) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (size >> 8) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, size & 0xFF) != 0) ||
-                /* count */
-                (output_byte(encoder_output, context, (count >> 24) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (count >> 16) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, (count >> 8) & 0xFF) != 0) ||
-                (output_byte(encoder_output, context, count & 0xFF) != 0))
+            /* blocks left over from previous values are reused before allocating new ones */
+            DECODE_ARENA_BLOCK* next_block = (block == NULL) ? generation->blocks : block->next;
+            if ((next_block != NULL) &&
+                (next_block->size >= aligned_size))
             {
-                /* Codes_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
-                LogError("Could not encode array");
-                result = __FAILURE__;
+                block = next_block;
             }
             else
             {
-                /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-                result = 0;
-            }
-        }
+                size_t block_size = (aligned_size > DECODE_ARENA_BLOCK_SIZE) ? aligned_size : DECODE_ARENA_BLOCK_SIZE;
+                DECODE_ARENA_BLOCK* new_block;
 
-        if (result == 0)
-        {
-            for (i = 0; i < count; i++)
-            {
-                if (amqpvalue_encode(items[i], encoder_output, context) != 0)
+                if (block_size > SIZE_MAX - DECODE_ARENA_BLOCK_HEADER_SIZE)
                 {
-                    break;
+                    new_block = NULL;
+                }
+                else
+                {
+                    new_block = (DECODE_ARENA_BLOCK*)malloc(DECODE_ARENA_BLOCK_HEADER_SIZE + block_size);
                 }
-            }
 
-            if (i < count)
-            {
-                LogError("Failed encoding element %u of the array", (unsigned int)i);
-                result = __FAILURE__;
+                if (new_block == NULL)
+                {
+                    LogError("Could not allocate arena block of %lu bytes", (unsigned long)block_size);
+                    block = NULL;
+                }
+                else
+                {
+                    new_block->size = block_size;
+                    new_block->used = 0;
+                    new_block->next = next_block;
+                    if (generation->current_block == NULL)
+                    {
+                        generation->blocks = new_block;
+                    }
+                    else
+                    {
+                        generation->current_block->next = new_block;
+                    }
+
+                    block = new_block;
+                }
             }
-            else
+
+            if (block != NULL)
             {
-                result = 0;
+                generation->current_block = block;
             }
         }
+
+        if (block == NULL)
+        {
+            result = NULL;
+        }
+        else
+        {
+            result = (unsigned char*)block + DECODE_ARENA_BLOCK_HEADER_SIZE + block->used;
+            block->used += aligned_size;
+        }
     }
 
     return result;
 }
 
-static int encode_descriptor_header(AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context)
+static void amqpvalue_clear(AMQP_VALUE_DATA* value_data)
 {
-    int result;
+    switch (value_data->type)
+    {
+    default:
+        break;
+
+    case AMQP_TYPE_BINARY:
+        if (value_data->value.binary_value.bytes != NULL)
+        {
+            free((void*)value_data->value.binary_value.bytes);
+        }
+        break;
+    case AMQP_TYPE_STRING:
+        if (value_data->value.string_value.chars != NULL)
+        {
+            free(value_data->value.string_value.chars);
+        }
+        break;
+    case AMQP_TYPE_SYMBOL:
+        if (value_data->value.symbol_value.chars != NULL)
+        {
+            free(value_data->value.symbol_value.chars);
+        }
+        break;
+    case AMQP_TYPE_LIST:
+    {
+        size_t i;
+        for (i = 0; i < value_data->value.list_value.count; i++)
+        {
+            amqpvalue_destroy(value_data->value.list_value.items[i]);
+        }
 
-    if (output_byte(encoder_output, context, 0x00) != 0)
+        free(value_data->value.list_value.items);
+        value_data->value.list_value.items = NULL;
+        break;
+    }
+    case AMQP_TYPE_MAP:
     {
-        LogError("Failed encoding descriptor header");
-        result = __FAILURE__;
+        size_t i;
+        for (i = 0; i < value_data->value.map_value.pair_count; i++)
+        {
+            amqpvalue_destroy(value_data->value.map_value.pairs[i].key);
+            amqpvalue_destroy(value_data->value.map_value.pairs[i].value);
+        }
+
+        free(value_data->value.map_value.pairs);
+        value_data->value.map_value.pairs = NULL;
+        break;
     }
-    else
+    case AMQP_TYPE_ARRAY:
     {
-        result = 0;
+        size_t i;
+        for (i = 0; i < value_data->value.array_value.count; i++)
+        {
+            amqpvalue_destroy(value_data->value.array_value.items[i]);
+        }
+
+        free(value_data->value.array_value.items);
+        value_data->value.array_value.items = NULL;
+        break;
+    }
+    case AMQP_TYPE_COMPOSITE:
+    case AMQP_TYPE_DESCRIBED:
+        amqpvalue_destroy(value_data->value.described_value.descriptor);
+        amqpvalue_destroy(value_data->value.described_value.value);
+        break;
     }
 
-    return result;
+    value_data->type = AMQP_TYPE_UNKNOWN;
 }
 
-/* Codes_SRS_AMQPVALUE_01_265: [amqpvalue_encode shall encode the value per the ISO.] */
-int amqpvalue_encode(AMQP_VALUE value, AMQPVALUE_ENCODER_OUTPUT encoder_output, void* context)
+void amqpvalue_destroy(AMQP_VALUE value)
 {
-    int result;
-
-    /* Codes_SRS_AMQPVALUE_01_269: [If value or encoder_output are NULL, amqpvalue_encode shall fail and return a non-zero value.] */
-    if ((value == NULL) ||
-        (encoder_output == NULL))
+    /* Codes_SRS_AMQPVALUE_01_315: [If the value argument is NULL, amqpvalue_destroy shall do nothing.] */
+    if (value == NULL)
     {
-        LogError("Bad arguments: value = %p, encoder_output = %p",
-            value, encoder_output);
-        result = __FAILURE__;
+        LogError("NULL value");
     }
-    else
+    else if (((AMQP_VALUE_DATA*)value)->in_arena)
     {
-        AMQP_VALUE_DATA* value_data = (AMQP_VALUE_DATA*)value;
-
-        switch (value_data->type)
+        /* Codes_SRS_AMQPVALUE_01_444: [ Values decoded in place are owned by their arena, amqpvalue_destroy shall only release the references obtained by cloning them. ]*/
+        DECODE_ARENA_GENERATION* generation = ((ARENA_VALUE_DATA*)value)->generation;
+        if (generation->clone_count == 0)
         {
-        default:
-            /* Codes_SRS_AMQPVALUE_01_271: [If encoding fails due to any error not specifically mentioned here, it shall return a non-zero value.] */
-            LogError("Invalid type: %d", (int)value_data->type);
-            result = __FAILURE__;
-            break;
-
-        case AMQP_TYPE_NULL:
-            /* Codes_SRS_AMQPVALUE_01_264: [<encoding code="0x40" category="fixed" width="0" label="the null value"/>] */
-            /* Codes_SRS_AMQPVALUE_01_266: [On success amqpvalue_encode shall return 0.] */
-            result = output_byte(encoder_output, context, (unsigned char)0x40);
-            break;
-
-        case AMQP_TYPE_BOOL:
-            result = encode_boolean(encoder_output, context, value_data->value.bool_value);
-            break;
-
-        case AMQP_TYPE_UBYTE:
-            result = encode_ubyte(encoder_output, context, value_data->value.ubyte_value);
-            break;
-
-        case AMQP_TYPE_USHORT:
-            result = encode_ushort(encoder_output, context, value_data->value.ushort_value);
-            break;
-
-        case AMQP_TYPE_UINT:
-            result = encode_uint(encoder_output, context, value_data->value.uint_value);
-            break;
-
-        case AMQP_TYPE_ULONG:
-            result = encode_ulong(encoder_output, context, value_data->value.ulong_value);
-            break;
-
-        case AMQP_TYPE_BYTE:
-            result = encode_byte(encoder_output, context, value_data->value.byte_value);
-            break;
-
-        case AMQP_TYPE_SHORT:
-            result = encode_short(encoder_output, context, value_data->value.short_value);
-            break;
-
-        case AMQP_TYPE_INT:
-            result = encode_int(encoder_output, context, value_data->value.int_value);
-            break;
-
-        case AMQP_TYPE_LONG:
-            result = encode_long(encoder_output, context, value_data->value.long_value);
-            break;
-
-        case AMQP_TYPE_FLOAT:
-            result = encode_float(encoder_output, context, value_data->value.float_value);
-            break;
-
-        case AMQP_TYPE_DOUBLE:
-            result = encode_double(encoder_output, context, value_data->value.double_value);
-            break;
-
-        case AMQP_TYPE_TIMESTAMP:
-            result = encode_timestamp(encoder_output, context, value_data->value.timestamp_value);
-            break;
-
-        case AMQP_TYPE_UUID:
-            result = encode_uuid(encoder_output, context, value_data->value.uuid_value);
-            break;
-
-        case AMQP_TYPE_BINARY:
-            result = encode_binary(encoder_output, context, (const unsigned char*)value_data->value.binary_value.bytes, value_data->value.binary_value.length);
-            break;
-
-        case AMQP_TYPE_STRING:
-            result = encode_string(encoder_output, context, value_data->value.string_value.chars);
-            break;
-
-        case AMQP_TYPE_SYMBOL:
-            result = encode_symbol(encoder_output, context, value_data->value.symbol_value.chars);
-            break;
-
-        case AMQP_TYPE_LIST:
-            result = encode_list(encoder_output, context, value_data->value.list_value.count, value_data->value.list_value.items);
-            break;
-
-        case AMQP_TYPE_ARRAY:
-            result = encode_array(encoder_output, context, value_data->value.array_value.count, value_data->value.array_value.items);
-            break;
-
-        case AMQP_TYPE_MAP:
-            result = encode_map(encoder_output, context, value_data->value.map_value.pair_count, value_data->value.map_value.pairs);
-            break;
-
-        case AMQP_TYPE_COMPOSITE:
-        case AMQP_TYPE_DESCRIBED:
+            LogError("Value decoded in place destroyed without being cloned");
+        }
+        else
         {
-            if ((encode_descriptor_header(encoder_output, context) != 0) ||
-                (amqpvalue_encode(value_data->value.described_value.descriptor, encoder_output, context) != 0) ||
-                (amqpvalue_encode(value_data->value.described_value.value, encoder_output, context) != 0))
-            {
-                LogError("Failed encoding described or composite type");
-                result = __FAILURE__;
-            }
-            else
+            generation->clone_count--;
+            if ((generation->clone_count == 0) && generation->is_retired)
             {
-                result = 0;
+                /* Codes_SRS_AMQPVALUE_01_447: [ If clones of values decoded in place are still alive when the arena is reset, the binary values pointing into the decoded buffers shall be copied in the arena memory and that memory shall be freed when the last clone is destroyed. ]*/
+                decode_arena_generation_destroy(generation);
             }
-
-            break;
-        }
-        }
-    }
-
-    return result;
-}
-
-static int count_bytes(void* context, const unsigned char* bytes, size_t length)
-{
-    size_t* byte_count;
-    (void)bytes;
-
-    byte_count = (size_t*)context;
-    *byte_count += length;
-
-    return 0;
-}
-
-int amqpvalue_get_encoded_size(AMQP_VALUE value, size_t* encoded_size)
-{
-    int result;
-
-    /* Codes_SRS_AMQPVALUE_01_309: [If any argument is NULL, amqpvalue_get_encoded_size shall return a non-zero value.] */
-    if ((value == NULL) ||
-        (encoded_size == NULL))
-    {
-        LogError("Bad arguments: value = %p, encoded_size = %p",
-            value, encoded_size);
-        result = __FAILURE__;
-    }
-    else
-    {
-        *encoded_size = 0;
-        result = amqpvalue_encode(value, count_bytes, encoded_size);
-    }
-
-    return result;
-}
-
-static void amqpvalue_clear(AMQP_VALUE_DATA* value_data)
-{
-    switch (value_data->type)
-    {
-    default:
-        break;
-
-    case AMQP_TYPE_BINARY:
-        if (value_data->value.binary_value.bytes != NULL)
-        {
-            free((void*)value_data->value.binary_value.bytes);
-        }
-        break;
-    case AMQP_TYPE_STRING:
-        if (value_data->value.string_value.chars != NULL)
-        {
-            free(value_data->value.string_value.chars);
-        }
-        break;
-    case AMQP_TYPE_SYMBOL:
-        if (value_data->value.symbol_value.chars != NULL)
-        {
-            free(value_data->value.symbol_value.chars);
-        }
-        break;
-    case AMQP_TYPE_LIST:
-    {
-        size_t i;
-        for (i = 0; i < value_data->value.list_value.count; i++)
-        {
-            amqpvalue_destroy(value_data->value.list_value.items[i]);
-        }
-
-        free(value_data->value.list_value.items);
-        value_data->value.list_value.items = NULL;
-        break;
-    }
-    case AMQP_TYPE_MAP:
-    {
-        size_t i;
-        for (i = 0; i < value_data->value.map_value.pair_count; i++)
-        {
-            amqpvalue_destroy(value_data->value.map_value.pairs[i].key);
-            amqpvalue_destroy(value_data->value.map_value.pairs[i].value);
-        }
-
-        free(value_data->value.map_value.pairs);
-        value_data->value.map_value.pairs = NULL;
-        break;
-    }
-    case AMQP_TYPE_ARRAY:
-    {
-        size_t i;
-        for (i = 0; i < value_data->value.array_value.count; i++)
-        {
-            amqpvalue_destroy(value_data->value.array_value.items[i]);
         }
-
-        free(value_data->value.array_value.items);
-        value_data->value.array_value.items = NULL;
-        break;
-    }
-    case AMQP_TYPE_COMPOSITE:
-    case AMQP_TYPE_DESCRIBED:
-        amqpvalue_destroy(value_data->value.described_value.descriptor);
-        amqpvalue_destroy(value_data->value.described_value.value);
-        break;
-    }
-
-    value_data->type = AMQP_TYPE_UNKNOWN;
-}
-
-void amqpvalue_destroy(AMQP_VALUE value)
-{
-    /* Codes_SRS_AMQPVALUE_01_315: [If the value argument is NULL, amqpvalue_destroy shall do nothing.] */
-    if (value == NULL)
-    {
-        LogError("NULL value");
     }
     else
     {
@@ -3549,7 +3529,7 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
 
                 if (internal_decoder_data->decode_to_value == NULL)
                 {
-                    internal_decoder_data->decode_to_value = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+                    internal_decoder_data->decode_to_value = create_value_data();
                 }
 
                 if (internal_decoder_data->decode_to_value == NULL)
@@ -3575,7 +3555,7 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
                 {
                     AMQP_VALUE_DATA* descriptor;
                     internal_decoder_data->decode_to_value->type = AMQP_TYPE_DESCRIBED;
-                    descriptor = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+                    descriptor = create_value_data();
                     if (descriptor == NULL)
                     {
                         internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
@@ -4026,7 +4006,7 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
                                 AMQP_VALUE described_value;
                                 internal_decoder_destroy(inner_decoder);
 
-                                described_value = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+                                described_value = create_value_data();
                                 if (described_value == NULL)
                                 {
                                     internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
@@ -4959,7 +4939,7 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
 
                         if (internal_decoder_data->bytes_decoded == 0)
                         {
-                            AMQP_VALUE_DATA* list_item = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+                            AMQP_VALUE_DATA* list_item = create_value_data();
                             if (list_item == NULL)
                             {
                                 internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
@@ -5167,7 +5147,7 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
 
                         if (internal_decoder_data->bytes_decoded == 0)
                         {
-                            AMQP_VALUE_DATA* map_item = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+                            AMQP_VALUE_DATA* map_item = create_value_data();
                             if (map_item == NULL)
                             {
                                 LogError("Could not allocate memory for map item");
@@ -5319,286 +5299,957 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
                                         internal_decoder_data->decode_to_value->value.array_value.items[i] = NULL;
                                     }
 
-                                    internal_decoder_data->decode_value_state.array_value_state.array_value_state = DECODE_ARRAY_STEP_ITEMS;
-                                    internal_decoder_data->bytes_decoded = 0;
-                                    internal_decoder_data->inner_decoder = NULL;
-                                    internal_decoder_data->decode_value_state.array_value_state.item = 0;
-                                    result = 0;
-                                }
-                            }
+                                    internal_decoder_data->decode_value_state.array_value_state.array_value_state = DECODE_ARRAY_STEP_ITEMS;
+                                    internal_decoder_data->bytes_decoded = 0;
+                                    internal_decoder_data->inner_decoder = NULL;
+                                    internal_decoder_data->decode_value_state.array_value_state.item = 0;
+                                    result = 0;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            if (internal_decoder_data->bytes_decoded == 4)
+                            {
+                                if (internal_decoder_data->decode_to_value->value.array_value.count == 0)
+                                {
+                                    internal_decoder_data->decoder_state = DECODER_STATE_CONSTRUCTOR;
+                                    internal_decoder_data->on_value_decoded(internal_decoder_data->on_value_decoded_context, internal_decoder_data->decode_to_value);
+                                    result = 0;
+                                }
+                                else
+                                {
+                                    uint32_t i;
+                                    internal_decoder_data->decode_to_value->value.array_value.items = (AMQP_VALUE*)malloc(sizeof(AMQP_VALUE) * internal_decoder_data->decode_to_value->value.array_value.count);
+                                    if (internal_decoder_data->decode_to_value->value.array_value.items == NULL)
+                                    {
+                                        LogError("Could not allocate memory for array items");
+                                        result = __FAILURE__;
+                                    }
+                                    else
+                                    {
+                                        for (i = 0; i < internal_decoder_data->decode_to_value->value.array_value.count; i++)
+                                        {
+                                            internal_decoder_data->decode_to_value->value.array_value.items[i] = NULL;
+                                        }
+                                        internal_decoder_data->decode_value_state.array_value_state.array_value_state = DECODE_ARRAY_STEP_ITEMS;
+                                        internal_decoder_data->bytes_decoded = 0;
+                                        internal_decoder_data->inner_decoder = NULL;
+                                        internal_decoder_data->decode_value_state.array_value_state.item = 0;
+                                        result = 0;
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                result = 0;
+                            }
+                        }
+                        break;
+
+                    case DECODE_ARRAY_STEP_ITEMS:
+                    {
+                        size_t inner_used_bytes;
+
+                        if (internal_decoder_data->bytes_decoded == 0)
+                        {
+                            AMQP_VALUE_DATA* array_item;
+                            internal_decoder_data->decode_value_state.array_value_state.constructor_byte = buffer[0];
+
+                            array_item = create_value_data();
+                            if (array_item == NULL)
+                            {
+                                LogError("Could not allocate memory for array item to be decoded");
+                                internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
+                                result = __FAILURE__;
+                            }
+                            else
+                            {
+                                array_item->type = AMQP_TYPE_UNKNOWN;
+                                internal_decoder_data->decode_to_value->value.array_value.items[internal_decoder_data->decode_value_state.array_value_state.item] = array_item;
+                                internal_decoder_data->inner_decoder = internal_decoder_create(inner_decoder_callback, internal_decoder_data, array_item, true);
+                                if (internal_decoder_data->inner_decoder == NULL)
+                                {
+                                    internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
+                                    LogError("Could not create inner decoder for array items");
+                                    result = __FAILURE__;
+                                }
+                                else
+                                {
+                                    result = 0;
+                                }
+                            }
+                        }
+
+                        if (internal_decoder_data->inner_decoder == NULL)
+                        {
+                            LogError("NULL inner decoder. This should not happen under normal circumstances");
+                            result = __FAILURE__;
+                        }
+                        else if (internal_decoder_decode_bytes(internal_decoder_data->inner_decoder, buffer, size, &inner_used_bytes) != 0)
+                        {
+                            LogError("Could not decode array item");
+                            result = __FAILURE__;
+                        }
+                        else
+                        {
+                            INTERNAL_DECODER_DATA* inner_decoder = (INTERNAL_DECODER_DATA*)internal_decoder_data->inner_decoder;
+                            internal_decoder_data->bytes_decoded += inner_used_bytes;
+                            buffer += inner_used_bytes;
+                            size -= inner_used_bytes;
+
+                            if (inner_decoder->decoder_state == DECODER_STATE_DONE)
+                            {
+                                internal_decoder_destroy(inner_decoder);
+                                internal_decoder_data->inner_decoder = NULL;
+
+                                internal_decoder_data->decode_value_state.array_value_state.item++;
+                                if (internal_decoder_data->decode_value_state.array_value_state.item == internal_decoder_data->decode_to_value->value.array_value.count)
+                                {
+                                    internal_decoder_data->decoder_state = DECODER_STATE_CONSTRUCTOR;
+                                    internal_decoder_data->on_value_decoded(internal_decoder_data->on_value_decoded_context, internal_decoder_data->decode_to_value);
+
+                                    result = 0;
+                                }
+                                else
+                                {
+                                    AMQP_VALUE_DATA* array_item = create_value_data();
+                                    if (array_item == NULL)
+                                    {
+                                        LogError("Could not allocate memory for array item");
+                                        internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
+                                        result = __FAILURE__;
+                                    }
+                                    else
+                                    {
+                                        array_item->type = AMQP_TYPE_UNKNOWN;
+                                        internal_decoder_data->decode_to_value->value.array_value.items[internal_decoder_data->decode_value_state.array_value_state.item] = array_item;
+                                        internal_decoder_data->inner_decoder = internal_decoder_create(inner_decoder_callback, internal_decoder_data, array_item, true);
+                                        if (internal_decoder_data->inner_decoder == NULL)
+                                        {
+                                            LogError("Could not create inner decoder for array item");
+                                            internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
+                                            result = __FAILURE__;
+                                        }
+                                        else
+                                        {
+                                            if (internal_decoder_decode_bytes(internal_decoder_data->inner_decoder, &internal_decoder_data->decode_value_state.array_value_state.constructor_byte, 1, NULL) != 0)
+                                            {
+                                                LogError("Could not decode array item data");
+                                                result = __FAILURE__;
+                                            }
+                                            else
+                                            {
+                                                result = 0;
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                result = 0;
+                            }
+                        }
+
+                        break;
+                    }
+                    }
+
+                    break;
+                }
+                }
+                break;
+            }
+            }
+
+            if (result != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    if (used_bytes != NULL)
+    {
+        *used_bytes = initial_size - size;
+    }
+
+    return result;
+}
+
+AMQPVALUE_DECODER_HANDLE amqpvalue_decoder_create(ON_VALUE_DECODED on_value_decoded, void* callback_context)
+{
+    AMQPVALUE_DECODER_HANDLE_DATA* decoder_instance;
+
+    /* Codes_SRS_AMQPVALUE_01_312: [If the on_value_decoded argument is NULL, amqpvalue_decoder_create shall return NULL.] */
+    if (on_value_decoded == NULL)
+    {
+        LogError("NULL on_value_decoded");
+        decoder_instance = NULL;
+    }
+    else
+    {
+        decoder_instance = (AMQPVALUE_DECODER_HANDLE_DATA*)malloc(sizeof(AMQPVALUE_DECODER_HANDLE_DATA));
+        /* Codes_SRS_AMQPVALUE_01_313: [If creating the decoder fails, amqpvalue_decoder_create shall return NULL.] */
+        if (decoder_instance == NULL)
+        {
+            LogError("Could not allocate memory for AMQP value decoder");
+        }
+        else
+        {
+            decoder_instance->decode_to_value = create_value_data();
+            if (decoder_instance->decode_to_value == NULL)
+            {
+                /* Codes_SRS_AMQPVALUE_01_313: [If creating the decoder fails, amqpvalue_decoder_create shall return NULL.] */
+                LogError("Could not allocate memory for decoded AMQP value");
+                free(decoder_instance);
+                decoder_instance = NULL;
+            }
+            else
+            {
+                decoder_instance->decode_to_value->type = AMQP_TYPE_UNKNOWN;
+                decoder_instance->internal_decoder = internal_decoder_create(on_value_decoded, callback_context, decoder_instance->decode_to_value, false);
+                if (decoder_instance->internal_decoder == NULL)
+                {
+                    /* Codes_SRS_AMQPVALUE_01_313: [If creating the decoder fails, amqpvalue_decoder_create shall return NULL.] */
+                    LogError("Could not create the internal decoder");
+                    free(decoder_instance->decode_to_value);
+                    free(decoder_instance);
+                    decoder_instance = NULL;
+                }
+            }
+        }
+    }
+
+    /* Codes_SRS_AMQPVALUE_01_311: [amqpvalue_decoder_create shall create a new amqp value decoder and return a non-NULL handle to it.] */
+    return decoder_instance;
+}
+
+void amqpvalue_decoder_destroy(AMQPVALUE_DECODER_HANDLE handle)
+{
+    if (handle == NULL)
+    {
+        /* Codes_SRS_AMQPVALUE_01_317: [If handle is NULL, amqpvalue_decoder_destroy shall do nothing.] */
+        LogError("NULL handle");
+    }
+    else
+    {
+        AMQPVALUE_DECODER_HANDLE_DATA* decoder_instance = (AMQPVALUE_DECODER_HANDLE_DATA*)handle;
+        /* Codes_SRS_AMQPVALUE_01_316: [amqpvalue_decoder_destroy shall free all resources associated with the amqpvalue_decoder.] */
+        amqpvalue_destroy(decoder_instance->internal_decoder->decode_to_value);
+        internal_decoder_destroy(decoder_instance->internal_decoder);
+        free(handle);
+    }
+}
+
+/* Codes_SRS_AMQPVALUE_01_318: [amqpvalue_decode_bytes shall decode size bytes that are passed in the buffer argument.] */
+int amqpvalue_decode_bytes(AMQPVALUE_DECODER_HANDLE handle, const unsigned char* buffer, size_t size)
+{
+    int result;
+
+    AMQPVALUE_DECODER_HANDLE_DATA* decoder_instance = (AMQPVALUE_DECODER_HANDLE_DATA*)handle;
+    /* Codes_SRS_AMQPVALUE_01_320: [If handle or buffer are NULL, amqpvalue_decode_bytes shall return a non-zero value.] */
+    if ((decoder_instance == NULL) ||
+        (buffer == NULL) ||
+        /* Codes_SRS_AMQPVALUE_01_321: [If size is 0, amqpvalue_decode_bytes shall return a non-zero value.] */
+        (size == 0))
+    {
+        LogError("Bad arguments: decoder_instance = %p, buffer = %p, size = %lu",
+            decoder_instance, buffer, (unsigned long)size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t used_bytes;
+
+        /* Codes_SRS_AMQPVALUE_01_318: [amqpvalue_decode_bytes shall decode size bytes that are passed in the buffer argument.] */
+        if (internal_decoder_decode_bytes(decoder_instance->internal_decoder, buffer, size, &used_bytes) != 0)
+        {
+            LogError("Failed decoding bytes");
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_AMQPVALUE_01_319: [On success, amqpvalue_decode_bytes shall return 0.] */
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static size_t get_constructor_width(unsigned char constructor)
+{
+    size_t result;
+
+    /* the upper nibble of a constructor gives the width of the fixed part of the encoding */
+    switch (constructor >> 4)
+    {
+    default:
+    case 0x4:
+        result = 0;
+        break;
+    case 0x5:
+    case 0xA:
+    case 0xC:
+    case 0xE:
+        result = 1;
+        break;
+    case 0x6:
+        result = 2;
+        break;
+    case 0x7:
+    case 0xB:
+    case 0xD:
+    case 0xF:
+        result = 4;
+        break;
+    case 0x8:
+        result = 8;
+        break;
+    case 0x9:
+        result = 16;
+        break;
+    }
+
+    return result;
+}
+
+static uint16_t read_uint16(const unsigned char* bytes)
+{
+    return (uint16_t)(((uint16_t)bytes[0] << 8) | bytes[1]);
+}
+
+static uint32_t read_uint32(const unsigned char* bytes)
+{
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+static uint64_t read_uint64(const unsigned char* bytes)
+{
+    return ((uint64_t)read_uint32(bytes) << 32) | read_uint32(bytes + 4);
+}
+
+static ARENA_VALUE_DATA* decode_arena_create_value(DECODE_ARENA_GENERATION* generation)
+{
+    ARENA_VALUE_DATA* result = (ARENA_VALUE_DATA*)decode_arena_allocate(generation, sizeof(ARENA_VALUE_DATA));
+    if (result == NULL)
+    {
+        LogError("Could not allocate decoded value");
+    }
+    else
+    {
+        result->value_data.type = AMQP_TYPE_UNKNOWN;
+        result->value_data.in_arena = true;
+        result->generation = generation;
+        result->next_borrowed = NULL;
+    }
+
+    return result;
+}
+
+static int decode_value_in_place(DECODE_ARENA_GENERATION* generation, unsigned char constructor, const unsigned char* buffer, size_t size, AMQP_VALUE* value, size_t* used_bytes);
+
+static int decode_item_in_place(DECODE_ARENA_GENERATION* generation, const unsigned char* buffer, size_t size, AMQP_VALUE* value, size_t* used_bytes)
+{
+    int result;
+    size_t value_used_bytes;
+
+    if (size == 0)
+    {
+        LogError("Not enough bytes for the constructor");
+        result = __FAILURE__;
+    }
+    else if (decode_value_in_place(generation, buffer[0], buffer + 1, size - 1, value, &value_used_bytes) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        *used_bytes = value_used_bytes + 1;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int decode_items_in_place(DECODE_ARENA_GENERATION* generation, const unsigned char* buffer, size_t size, AMQP_VALUE* items, uint32_t count, size_t* used_bytes)
+{
+    int result;
+    uint32_t i;
+    size_t pos = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        size_t item_used_bytes;
+        if (decode_item_in_place(generation, buffer + pos, size - pos, &items[i], &item_used_bytes) != 0)
+        {
+            LogError("Could not decode item %u", (unsigned int)i);
+            break;
+        }
+
+        pos += item_used_bytes;
+    }
+
+    if (i < count)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        *used_bytes = pos;
+        result = 0;
+    }
+
+    return result;
+}
+
+/* The whole value is in the buffer, so it is decoded recursively, with all the values, item arrays and string
+   contents allocated in the arena and the binary contents left in the buffer. The constructors and
+   the handling of the compound sizes are the same as for the streaming decoder. */
+static int decode_value_in_place(DECODE_ARENA_GENERATION* generation, unsigned char constructor, const unsigned char* buffer, size_t size, AMQP_VALUE* value, size_t* used_bytes)
+{
+    int result;
+    ARENA_VALUE_DATA* arena_value = decode_arena_create_value(generation);
+
+    if (arena_value == NULL)
+    {
+        /* Codes_SRS_AMQPVALUE_01_443: [ If allocating memory in the arena fails, amqpvalue_decode_in_place shall fail and return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    else
+    {
+        AMQP_VALUE_DATA* value_data = &arena_value->value_data;
+        size_t width = get_constructor_width(constructor);
+
+        if (size < width)
+        {
+            LogError("Not enough bytes to decode value with constructor 0x%02x", constructor);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+            *used_bytes = width;
+
+            switch (constructor)
+            {
+            default:
+                LogError("Invalid constructor byte: 0x%02x", constructor);
+                result = __FAILURE__;
+                break;
+
+            case 0x00:
+            {
+                size_t descriptor_used_bytes;
+                size_t described_used_bytes;
+
+                value_data->type = AMQP_TYPE_DESCRIBED;
+                if ((decode_item_in_place(generation, buffer, size, &value_data->value.described_value.descriptor, &descriptor_used_bytes) != 0) ||
+                    (decode_item_in_place(generation, buffer + descriptor_used_bytes, size - descriptor_used_bytes, &value_data->value.described_value.value, &described_used_bytes) != 0))
+                {
+                    LogError("Could not decode described value");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    *used_bytes = descriptor_used_bytes + described_used_bytes;
+                }
+                break;
+            }
+            case 0x40:
+                value_data->type = AMQP_TYPE_NULL;
+                break;
+            case 0x41:
+            case 0x42:
+                value_data->type = AMQP_TYPE_BOOL;
+                value_data->value.bool_value = (constructor == 0x41);
+                break;
+            case 0x56:
+                if (buffer[0] >= 2)
+                {
+                    LogError("Bad boolean value: %02X", buffer[0]);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    value_data->type = AMQP_TYPE_BOOL;
+                    value_data->value.bool_value = (buffer[0] != 0);
+                }
+                break;
+            case 0x50:
+                value_data->type = AMQP_TYPE_UBYTE;
+                value_data->value.ubyte_value = buffer[0];
+                break;
+            case 0x60:
+                value_data->type = AMQP_TYPE_USHORT;
+                value_data->value.ushort_value = read_uint16(buffer);
+                break;
+            case 0x70:
+                value_data->type = AMQP_TYPE_UINT;
+                value_data->value.uint_value = read_uint32(buffer);
+                break;
+            case 0x52:
+                value_data->type = AMQP_TYPE_UINT;
+                value_data->value.uint_value = buffer[0];
+                break;
+            case 0x43:
+                value_data->type = AMQP_TYPE_UINT;
+                value_data->value.uint_value = 0;
+                break;
+            case 0x80:
+                value_data->type = AMQP_TYPE_ULONG;
+                value_data->value.ulong_value = read_uint64(buffer);
+                break;
+            case 0x53:
+                value_data->type = AMQP_TYPE_ULONG;
+                value_data->value.ulong_value = buffer[0];
+                break;
+            case 0x44:
+                value_data->type = AMQP_TYPE_ULONG;
+                value_data->value.ulong_value = 0;
+                break;
+            case 0x51:
+                value_data->type = AMQP_TYPE_BYTE;
+                value_data->value.byte_value = (char)buffer[0];
+                break;
+            case 0x61:
+                value_data->type = AMQP_TYPE_SHORT;
+                value_data->value.short_value = (int16_t)read_uint16(buffer);
+                break;
+            case 0x71:
+                value_data->type = AMQP_TYPE_INT;
+                value_data->value.int_value = (int32_t)read_uint32(buffer);
+                break;
+            case 0x54:
+                value_data->type = AMQP_TYPE_INT;
+                value_data->value.int_value = (int32_t)((int8_t)buffer[0]);
+                break;
+            case 0x81:
+                value_data->type = AMQP_TYPE_LONG;
+                value_data->value.long_value = (int64_t)read_uint64(buffer);
+                break;
+            case 0x55:
+                value_data->type = AMQP_TYPE_LONG;
+                value_data->value.long_value = (int64_t)((int8_t)buffer[0]);
+                break;
+            case 0x72:
+            {
+                uint32_t float_bits = read_uint32(buffer);
+                value_data->type = AMQP_TYPE_FLOAT;
+                (void)memcpy(&value_data->value.float_value, &float_bits, sizeof(float_bits));
+                break;
+            }
+            case 0x82:
+            {
+                uint64_t double_bits = read_uint64(buffer);
+                value_data->type = AMQP_TYPE_DOUBLE;
+                (void)memcpy(&value_data->value.double_value, &double_bits, sizeof(double_bits));
+                break;
+            }
+            case 0x83:
+                value_data->type = AMQP_TYPE_TIMESTAMP;
+                value_data->value.timestamp_value = (int64_t)read_uint64(buffer);
+                break;
+            case 0x98:
+                value_data->type = AMQP_TYPE_UUID;
+                (void)memcpy(value_data->value.uuid_value, buffer, 16);
+                break;
+            case 0xA0:
+            case 0xB0:
+            {
+                uint32_t length = (width == 1) ? buffer[0] : read_uint32(buffer);
+                if (size - width < length)
+                {
+                    LogError("Not enough bytes for binary value of %u bytes", (unsigned int)length);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    value_data->type = AMQP_TYPE_BINARY;
+                    value_data->value.binary_value.length = length;
+                    if (length == 0)
+                    {
+                        value_data->value.binary_value.bytes = NULL;
+                    }
+                    else
+                    {
+                        /* Codes_SRS_AMQPVALUE_01_442: [ Binary values shall point to their bytes in buffer instead of copying them, while strings and symbols shall be copied in the arena. ]*/
+                        value_data->value.binary_value.bytes = buffer + width;
+                        arena_value->next_borrowed = generation->borrowed_values;
+                        generation->borrowed_values = arena_value;
+                    }
+
+                    *used_bytes = width + length;
+                }
+                break;
+            }
+            case 0xA1:
+            case 0xB1:
+            case 0xA3:
+            case 0xB3:
+            {
+                uint32_t length = (width == 1) ? buffer[0] : read_uint32(buffer);
+                if (size - width < length)
+                {
+                    LogError("Not enough bytes for string or symbol value of %u bytes", (unsigned int)length);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    /* strings are handed out NULL terminated, so their characters cannot stay in the buffer */
+                    char* chars = (char*)decode_arena_allocate(generation, (size_t)length + 1);
+                    if (chars == NULL)
+                    {
+                        LogError("Could not allocate string or symbol characters");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        (void)memcpy(chars, buffer + width, length);
+                        chars[length] = '\0';
+                        if ((constructor & 0x0F) == 0x01)
+                        {
+                            value_data->type = AMQP_TYPE_STRING;
+                            value_data->value.string_value.chars = chars;
+                        }
+                        else
+                        {
+                            value_data->type = AMQP_TYPE_SYMBOL;
+                            value_data->value.symbol_value.chars = chars;
+                        }
+
+                        *used_bytes = width + length;
+                    }
+                }
+                break;
+            }
+            case 0x45:
+                value_data->type = AMQP_TYPE_LIST;
+                value_data->value.list_value.items = NULL;
+                value_data->value.list_value.count = 0;
+                break;
+            case 0xC0:
+            case 0xD0:
+            case 0xC1:
+            case 0xD1:
+            case 0xE0:
+            case 0xF0:
+            {
+                /* compound values have a size followed by a count, both of the constructor width */
+                size_t pos = width * 2;
+                uint32_t count;
+
+                if (size < pos)
+                {
+                    LogError("Not enough bytes for the count of the compound value");
+                    result = __FAILURE__;
+                    break;
+                }
+
+                count = (width == 1) ? buffer[1] : read_uint32(buffer + 4);
+                if ((constructor & 0xE0) == 0xC0)
+                {
+                    /* each list or map item has at least a constructor */
+                    if (count > size - pos)
+                    {
+                        LogError("Compound value claims %u items in %lu bytes", (unsigned int)count, (unsigned long)(size - pos));
+                        result = __FAILURE__;
+                    }
+                    else if ((constructor & 0x0F) == 0x00)
+                    {
+                        size_t items_used_bytes = 0;
+
+                        value_data->type = AMQP_TYPE_LIST;
+                        value_data->value.list_value.count = count;
+                        value_data->value.list_value.items = NULL;
+                        if ((count > 0) &&
+                            ((value_data->value.list_value.items = (AMQP_VALUE*)decode_arena_allocate(generation, sizeof(AMQP_VALUE) * count)) == NULL))
+                        {
+                            LogError("Could not allocate list items");
+                            result = __FAILURE__;
+                        }
+                        else if (decode_items_in_place(generation, buffer + pos, size - pos, value_data->value.list_value.items, count, &items_used_bytes) != 0)
+                        {
+                            LogError("Could not decode list items");
+                            result = __FAILURE__;
+                        }
+                        else
+                        {
+                            *used_bytes = pos + items_used_bytes;
+                        }
+                    }
+                    else if ((count % 2) != 0)
+                    {
+                        LogError("Map has an odd number of elements: %u", (unsigned int)count);
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        uint32_t i;
+
+                        value_data->type = AMQP_TYPE_MAP;
+                        value_data->value.map_value.pair_count = count / 2;
+                        value_data->value.map_value.pairs = NULL;
+                        if ((count > 0) &&
+                            ((value_data->value.map_value.pairs = (AMQP_MAP_KEY_VALUE_PAIR*)decode_arena_allocate(generation, sizeof(AMQP_MAP_KEY_VALUE_PAIR) * (count / 2))) == NULL))
+                        {
+                            LogError("Could not allocate map pairs");
+                            result = __FAILURE__;
                         }
                         else
                         {
-                            if (internal_decoder_data->bytes_decoded == 4)
+                            for (i = 0; i < count / 2; i++)
                             {
-                                if (internal_decoder_data->decode_to_value->value.array_value.count == 0)
-                                {
-                                    internal_decoder_data->decoder_state = DECODER_STATE_CONSTRUCTOR;
-                                    internal_decoder_data->on_value_decoded(internal_decoder_data->on_value_decoded_context, internal_decoder_data->decode_to_value);
-                                    result = 0;
-                                }
-                                else
+                                size_t key_used_bytes;
+                                size_t value_used_bytes;
+                                if ((decode_item_in_place(generation, buffer + pos, size - pos, &value_data->value.map_value.pairs[i].key, &key_used_bytes) != 0) ||
+                                    (decode_item_in_place(generation, buffer + pos + key_used_bytes, size - pos - key_used_bytes, &value_data->value.map_value.pairs[i].value, &value_used_bytes) != 0))
                                 {
-                                    uint32_t i;
-                                    internal_decoder_data->decode_to_value->value.array_value.items = (AMQP_VALUE*)malloc(sizeof(AMQP_VALUE) * internal_decoder_data->decode_to_value->value.array_value.count);
-                                    if (internal_decoder_data->decode_to_value->value.array_value.items == NULL)
-                                    {
-                                        LogError("Could not allocate memory for array items");
-                                        result = __FAILURE__;
-                                    }
-                                    else
-                                    {
-                                        for (i = 0; i < internal_decoder_data->decode_to_value->value.array_value.count; i++)
-                                        {
-                                            internal_decoder_data->decode_to_value->value.array_value.items[i] = NULL;
-                                        }
-                                        internal_decoder_data->decode_value_state.array_value_state.array_value_state = DECODE_ARRAY_STEP_ITEMS;
-                                        internal_decoder_data->bytes_decoded = 0;
-                                        internal_decoder_data->inner_decoder = NULL;
-                                        internal_decoder_data->decode_value_state.array_value_state.item = 0;
-                                        result = 0;
-                                    }
+                                    LogError("Could not decode map pair %u", (unsigned int)i);
+                                    break;
                                 }
-                            }
-                            else
-                            {
-                                result = 0;
-                            }
-                        }
-                        break;
-
-                    case DECODE_ARRAY_STEP_ITEMS:
-                    {
-                        size_t inner_used_bytes;
 
-                        if (internal_decoder_data->bytes_decoded == 0)
-                        {
-                            AMQP_VALUE_DATA* array_item;
-                            internal_decoder_data->decode_value_state.array_value_state.constructor_byte = buffer[0];
+                                pos += key_used_bytes + value_used_bytes;
+                            }
 
-                            array_item = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
-                            if (array_item == NULL)
+                            if (i < count / 2)
                             {
-                                LogError("Could not allocate memory for array item to be decoded");
-                                internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
                                 result = __FAILURE__;
                             }
                             else
                             {
-                                array_item->type = AMQP_TYPE_UNKNOWN;
-                                internal_decoder_data->decode_to_value->value.array_value.items[internal_decoder_data->decode_value_state.array_value_state.item] = array_item;
-                                internal_decoder_data->inner_decoder = internal_decoder_create(inner_decoder_callback, internal_decoder_data, array_item, true);
-                                if (internal_decoder_data->inner_decoder == NULL)
-                                {
-                                    internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
-                                    LogError("Could not create inner decoder for array items");
-                                    result = __FAILURE__;
-                                }
-                                else
-                                {
-                                    result = 0;
-                                }
+                                *used_bytes = pos;
                             }
                         }
+                    }
+                }
+                else
+                {
+                    value_data->type = AMQP_TYPE_ARRAY;
+                    value_data->value.array_value.count = count;
+                    value_data->value.array_value.items = NULL;
+                    *used_bytes = pos;
 
-                        if (internal_decoder_data->inner_decoder == NULL)
+                    if (count > 0)
+                    {
+                        /* all the array elements share the constructor that follows the count */
+                        size_t items_size = (size_t)count * sizeof(AMQP_VALUE);
+                        unsigned char item_constructor;
+
+                        if (size == pos)
                         {
-                            LogError("NULL inner decoder. This should not happen under normal circumstances");
+                            LogError("Not enough bytes for the array item constructor");
                             result = __FAILURE__;
                         }
-                        else if (internal_decoder_decode_bytes(internal_decoder_data->inner_decoder, buffer, size, &inner_used_bytes) != 0)
+                        else if ((item_constructor = buffer[pos]) == 0x00)
                         {
-                            LogError("Could not decode array item");
+                            LogError("Arrays of described values are not supported");
+                            result = __FAILURE__;
+                        }
+                        else if (((get_constructor_width(item_constructor) > 0) && (count > size - pos - 1)) ||
+                            (items_size / sizeof(AMQP_VALUE) != count))
+                        {
+                            LogError("Array claims %u items in %lu bytes", (unsigned int)count, (unsigned long)(size - pos - 1));
+                            result = __FAILURE__;
+                        }
+                        else if ((value_data->value.array_value.items = (AMQP_VALUE*)decode_arena_allocate(generation, items_size)) == NULL)
+                        {
+                            LogError("Could not allocate array items");
                             result = __FAILURE__;
                         }
                         else
                         {
-                            INTERNAL_DECODER_DATA* inner_decoder = (INTERNAL_DECODER_DATA*)internal_decoder_data->inner_decoder;
-                            internal_decoder_data->bytes_decoded += inner_used_bytes;
-                            buffer += inner_used_bytes;
-                            size -= inner_used_bytes;
+                            uint32_t i;
 
-                            if (inner_decoder->decoder_state == DECODER_STATE_DONE)
+                            pos++;
+                            for (i = 0; i < count; i++)
                             {
-                                internal_decoder_destroy(inner_decoder);
-                                internal_decoder_data->inner_decoder = NULL;
-
-                                internal_decoder_data->decode_value_state.array_value_state.item++;
-                                if (internal_decoder_data->decode_value_state.array_value_state.item == internal_decoder_data->decode_to_value->value.array_value.count)
+                                size_t item_used_bytes;
+                                if (decode_value_in_place(generation, item_constructor, buffer + pos, size - pos, &value_data->value.array_value.items[i], &item_used_bytes) != 0)
                                 {
-                                    internal_decoder_data->decoder_state = DECODER_STATE_CONSTRUCTOR;
-                                    internal_decoder_data->on_value_decoded(internal_decoder_data->on_value_decoded_context, internal_decoder_data->decode_to_value);
-
-                                    result = 0;
-                                }
-                                else
-                                {
-                                    AMQP_VALUE_DATA* array_item = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
-                                    if (array_item == NULL)
-                                    {
-                                        LogError("Could not allocate memory for array item");
-                                        internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
-                                        result = __FAILURE__;
-                                    }
-                                    else
-                                    {
-                                        array_item->type = AMQP_TYPE_UNKNOWN;
-                                        internal_decoder_data->decode_to_value->value.array_value.items[internal_decoder_data->decode_value_state.array_value_state.item] = array_item;
-                                        internal_decoder_data->inner_decoder = internal_decoder_create(inner_decoder_callback, internal_decoder_data, array_item, true);
-                                        if (internal_decoder_data->inner_decoder == NULL)
-                                        {
-                                            LogError("Could not create inner decoder for array item");
-                                            internal_decoder_data->decoder_state = DECODER_STATE_ERROR;
-                                            result = __FAILURE__;
-                                        }
-                                        else
-                                        {
-                                            if (internal_decoder_decode_bytes(internal_decoder_data->inner_decoder, &internal_decoder_data->decode_value_state.array_value_state.constructor_byte, 1, NULL) != 0)
-                                            {
-                                                LogError("Could not decode array item data");
-                                                result = __FAILURE__;
-                                            }
-                                            else
-                                            {
-                                                result = 0;
-                                            }
-                                        }
-                                    }
+                                    LogError("Could not decode array item %u", (unsigned int)i);
+                                    break;
                                 }
+
+                                pos += item_used_bytes;
+                            }
+
+                            if (i < count)
+                            {
+                                result = __FAILURE__;
                             }
                             else
                             {
-                                result = 0;
+                                *used_bytes = pos;
                             }
                         }
-
-                        break;
-                    }
                     }
-
-                    break;
-                }
                 }
                 break;
             }
             }
-
-            if (result != 0)
-            {
-                break;
-            }
         }
-    }
 
-    if (used_bytes != NULL)
-    {
-        *used_bytes = initial_size - size;
+        if (result == 0)
+        {
+            *value = (AMQP_VALUE)value_data;
+        }
     }
 
     return result;
 }
 
-AMQPVALUE_DECODER_HANDLE amqpvalue_decoder_create(ON_VALUE_DECODED on_value_decoded, void* callback_context)
+static void decode_arena_release_values(AMQPVALUE_DECODE_ARENA_DATA* arena)
 {
-    AMQPVALUE_DECODER_HANDLE_DATA* decoder_instance;
+    DECODE_ARENA_GENERATION* generation = arena->generation;
 
-    /* Codes_SRS_AMQPVALUE_01_312: [If the on_value_decoded argument is NULL, amqpvalue_decoder_create shall return NULL.] */
-    if (on_value_decoded == NULL)
-    {
-        LogError("NULL on_value_decoded");
-        decoder_instance = NULL;
-    }
-    else
+    if (generation != NULL)
     {
-        decoder_instance = (AMQPVALUE_DECODER_HANDLE_DATA*)malloc(sizeof(AMQPVALUE_DECODER_HANDLE_DATA));
-        /* Codes_SRS_AMQPVALUE_01_313: [If creating the decoder fails, amqpvalue_decoder_create shall return NULL.] */
-        if (decoder_instance == NULL)
-        {
-            LogError("Could not allocate memory for AMQP value decoder");
-        }
-        else
+        if (generation->clone_count == 0)
         {
-            decoder_instance->decode_to_value = REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
-            if (decoder_instance->decode_to_value == NULL)
-            {
-                /* Codes_SRS_AMQPVALUE_01_313: [If creating the decoder fails, amqpvalue_decoder_create shall return NULL.] */
-                LogError("Could not allocate memory for decoded AMQP value");
-                free(decoder_instance);
-                decoder_instance = NULL;
-            }
-            else
+            /* Codes_SRS_AMQPVALUE_01_446: [ amqpvalue_decode_arena_reset shall release all the values decoded in place with the arena at once, keeping the arena memory for the values decoded next. ]*/
+            DECODE_ARENA_BLOCK* block = generation->blocks;
+            while (block != NULL)
             {
-                decoder_instance->decode_to_value->type = AMQP_TYPE_UNKNOWN;
-                decoder_instance->internal_decoder = internal_decoder_create(on_value_decoded, callback_context, decoder_instance->decode_to_value, false);
-                if (decoder_instance->internal_decoder == NULL)
+                block->used = 0;
+                if (block == generation->current_block)
                 {
-                    /* Codes_SRS_AMQPVALUE_01_313: [If creating the decoder fails, amqpvalue_decoder_create shall return NULL.] */
-                    LogError("Could not create the internal decoder");
-                    free(decoder_instance->decode_to_value);
-                    free(decoder_instance);
-                    decoder_instance = NULL;
+                    break;
                 }
+
+                block = block->next;
             }
+
+            generation->current_block = generation->blocks;
+            generation->borrowed_values = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_AMQPVALUE_01_445: [ Cloning a value decoded in place shall keep the memory of its arena alive until the clone is destroyed, even if the arena is reset or destroyed meanwhile. ]*/
+            /* the binary values reachable from clones were copied out of the buffer when cloning */
+            generation->borrowed_values = NULL;
+            generation->is_retired = true;
+            arena->generation = NULL;
         }
     }
+}
 
-    /* Codes_SRS_AMQPVALUE_01_311: [amqpvalue_decoder_create shall create a new amqp value decoder and return a non-NULL handle to it.] */
-    return decoder_instance;
+AMQPVALUE_DECODE_ARENA_HANDLE amqpvalue_decode_arena_create(void)
+{
+    AMQPVALUE_DECODE_ARENA_DATA* result = (AMQPVALUE_DECODE_ARENA_DATA*)malloc(sizeof(AMQPVALUE_DECODE_ARENA_DATA));
+    if (result == NULL)
+    {
+        /* Codes_SRS_AMQPVALUE_01_436: [ If allocating memory for the arena fails, amqpvalue_decode_arena_create shall return NULL. ]*/
+        LogError("Could not allocate memory for decode arena");
+    }
+    else
+    {
+        /* Codes_SRS_AMQPVALUE_01_435: [ amqpvalue_decode_arena_create shall create a new decode arena and return a non-NULL handle to it. ]*/
+        /* the arena memory is allocated on the first decode */
+        result->generation = NULL;
+    }
+
+    return result;
 }
 
-void amqpvalue_decoder_destroy(AMQPVALUE_DECODER_HANDLE handle)
+void amqpvalue_decode_arena_destroy(AMQPVALUE_DECODE_ARENA_HANDLE arena)
 {
-    if (handle == NULL)
+    if (arena == NULL)
     {
-        /* Codes_SRS_AMQPVALUE_01_317: [If handle is NULL, amqpvalue_decoder_destroy shall do nothing.] */
-        LogError("NULL handle");
+        /* Codes_SRS_AMQPVALUE_01_438: [ If arena is NULL, amqpvalue_decode_arena_destroy shall do nothing. ]*/
+        LogError("NULL arena");
     }
     else
     {
-        AMQPVALUE_DECODER_HANDLE_DATA* decoder_instance = (AMQPVALUE_DECODER_HANDLE_DATA*)handle;
-        /* Codes_SRS_AMQPVALUE_01_316: [amqpvalue_decoder_destroy shall free all resources associated with the amqpvalue_decoder.] */
-        amqpvalue_destroy(decoder_instance->internal_decoder->decode_to_value);
-        internal_decoder_destroy(decoder_instance->internal_decoder);
-        free(handle);
+        /* Codes_SRS_AMQPVALUE_01_437: [ amqpvalue_decode_arena_destroy shall release the values decoded in place with the arena and free all the arena resources that are not kept alive by clones. ]*/
+        decode_arena_release_values(arena);
+        if (arena->generation != NULL)
+        {
+            decode_arena_generation_destroy(arena->generation);
+        }
+
+        free(arena);
     }
 }
 
-/* Codes_SRS_AMQPVALUE_01_318: [amqpvalue_decode_bytes shall decode size bytes that are passed in the buffer argument.] */
-int amqpvalue_decode_bytes(AMQPVALUE_DECODER_HANDLE handle, const unsigned char* buffer, size_t size)
+int amqpvalue_decode_in_place(AMQPVALUE_DECODE_ARENA_HANDLE arena, const unsigned char* buffer, size_t size, AMQP_VALUE* value, size_t* used_bytes)
 {
     int result;
 
-    AMQPVALUE_DECODER_HANDLE_DATA* decoder_instance = (AMQPVALUE_DECODER_HANDLE_DATA*)handle;
-    /* Codes_SRS_AMQPVALUE_01_320: [If handle or buffer are NULL, amqpvalue_decode_bytes shall return a non-zero value.] */
-    if ((decoder_instance == NULL) ||
+    if ((arena == NULL) ||
         (buffer == NULL) ||
-        /* Codes_SRS_AMQPVALUE_01_321: [If size is 0, amqpvalue_decode_bytes shall return a non-zero value.] */
+        (value == NULL) ||
+        (used_bytes == NULL) ||
         (size == 0))
     {
-        LogError("Bad arguments: decoder_instance = %p, buffer = %p, size = %lu",
-            decoder_instance, buffer, (unsigned long)size);
+        /* Codes_SRS_AMQPVALUE_01_440: [ If arena, buffer, value or used_bytes is NULL or size is 0, amqpvalue_decode_in_place shall fail and return a non-zero value. ]*/
+        LogError("Bad arguments: arena = %p, buffer = %p, size = %lu, value = %p, used_bytes = %p",
+            arena, buffer, (unsigned long)size, value, used_bytes);
         result = __FAILURE__;
     }
     else
     {
-        size_t used_bytes;
+        if (arena->generation == NULL)
+        {
+            arena->generation = (DECODE_ARENA_GENERATION*)malloc(sizeof(DECODE_ARENA_GENERATION));
+            if (arena->generation == NULL)
+            {
+                LogError("Could not allocate memory for the arena");
+            }
+            else
+            {
+                arena->generation->blocks = NULL;
+                arena->generation->current_block = NULL;
+                arena->generation->clone_count = 0;
+                arena->generation->is_retired = false;
+                arena->generation->borrowed_values = NULL;
+            }
+        }
 
-        /* Codes_SRS_AMQPVALUE_01_318: [amqpvalue_decode_bytes shall decode size bytes that are passed in the buffer argument.] */
-        if (internal_decoder_decode_bytes(decoder_instance->internal_decoder, buffer, size, &used_bytes) != 0)
+        if (arena->generation == NULL)
         {
-            LogError("Failed decoding bytes");
+            /* Codes_SRS_AMQPVALUE_01_443: [ If allocating memory in the arena fails, amqpvalue_decode_in_place shall fail and return a non-zero value. ]*/
             result = __FAILURE__;
         }
         else
         {
-            /* Codes_SRS_AMQPVALUE_01_319: [On success, amqpvalue_decode_bytes shall return 0.] */
-            result = 0;
+            AMQP_VALUE decoded_value;
+            size_t decoded_size;
+
+            /* Codes_SRS_AMQPVALUE_01_439: [ amqpvalue_decode_in_place shall decode the value encoded at the start of buffer, allocating the value and all its items in the arena, and on success fill in value the decoded value, fill in used_bytes the number of bytes it was encoded in and return 0. ]*/
+            if (decode_item_in_place(arena->generation, buffer, size, &decoded_value, &decoded_size) != 0)
+            {
+                /* Codes_SRS_AMQPVALUE_01_441: [ If buffer does not start with a complete and valid encoded value, amqpvalue_decode_in_place shall fail and return a non-zero value. ]*/
+                LogError("Could not decode value in place");
+                result = __FAILURE__;
+            }
+            else
+            {
+                *value = decoded_value;
+                *used_bytes = decoded_size;
+                result = 0;
+            }
         }
     }
 
     return result;
 }
 
+void amqpvalue_decode_arena_reset(AMQPVALUE_DECODE_ARENA_HANDLE arena)
+{
+    if (arena == NULL)
+    {
+        /* Codes_SRS_AMQPVALUE_01_448: [ If arena is NULL, amqpvalue_decode_arena_reset shall do nothing. ]*/
+        LogError("NULL arena");
+    }
+    else
+    {
+        decode_arena_release_values(arena);
+    }
+}
+
 AMQP_VALUE amqpvalue_get_inplace_descriptor(AMQP_VALUE value)
 {
     AMQP_VALUE result;
@@ -5655,7 +6306,7 @@ AMQP_VALUE amqpvalue_get_inplace_described_value(AMQP_VALUE value)
 
 AMQP_VALUE amqpvalue_create_described(AMQP_VALUE descriptor, AMQP_VALUE value)
 {
-    AMQP_VALUE_DATA* result = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE_DATA* result = create_value_data();
     if (result == NULL)
     {
         LogError("Cannot allocate memory for described type");
@@ -5672,7 +6323,7 @@ AMQP_VALUE amqpvalue_create_described(AMQP_VALUE descriptor, AMQP_VALUE value)
 
 AMQP_VALUE amqpvalue_create_composite(AMQP_VALUE descriptor, uint32_t list_size)
 {
-    AMQP_VALUE_DATA* result = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE_DATA* result = create_value_data();
     if (result == NULL)
     {
         LogError("Cannot allocate memory for composite type");
@@ -5716,7 +6367,7 @@ AMQP_VALUE amqpvalue_create_composite(AMQP_VALUE descriptor, uint32_t list_size)
 
 AMQP_VALUE amqpvalue_create_composite_with_ulong_descriptor(uint64_t descriptor)
 {
-    AMQP_VALUE_DATA* result = (AMQP_VALUE_DATA*)REFCOUNT_TYPE_CREATE(AMQP_VALUE_DATA);
+    AMQP_VALUE_DATA* result = create_value_data();
     if (result == NULL)
     {
         LogError("Cannot allocate memory for composite type");
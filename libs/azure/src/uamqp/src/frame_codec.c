@@ -9,7 +9,6 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
-#include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_uamqp_c/frame_codec.h"
 #include "azure_uamqp_c/amqpvalue.h"
 
@@ -28,15 +27,17 @@ typedef enum RECEIVE_FRAME_STATE_TAG
 
 typedef struct SUBSCRIPTION_TAG
 {
-    uint8_t frame_type;
     ON_FRAME_RECEIVED on_frame_received;
     void* callback_context;
 } SUBSCRIPTION;
 
+/* the frame type is a single byte, so subscriptions are kept in a table indexed by it */
+#define FRAME_TYPE_COUNT    256
+
 typedef struct FRAME_CODEC_INSTANCE_TAG
 {
     /* subscriptions */
-    SINGLYLINKEDLIST_HANDLE subscription_list;
+    SUBSCRIPTION* subscriptions[FRAME_TYPE_COUNT];
 
     /* decode frame */
     RECEIVE_FRAME_STATE receive_frame_state;
@@ -45,8 +46,9 @@ typedef struct FRAME_CODEC_INSTANCE_TAG
     uint32_t type_specific_size;
     uint8_t receive_frame_doff;
     uint8_t receive_frame_type;
-    SUBSCRIPTION* receive_frame_subscription;
+    bool receive_frame_subscribed;
     unsigned char* receive_frame_bytes;
+    size_t receive_frame_bytes_capacity;
     ON_FRAME_CODEC_ERROR on_frame_codec_error;
     void* on_frame_codec_error_callback_context;
 
@@ -54,22 +56,42 @@ typedef struct FRAME_CODEC_INSTANCE_TAG
     uint32_t max_frame_size;
 } FRAME_CODEC_INSTANCE;
 
-static bool find_subscription_by_frame_type(LIST_ITEM_HANDLE list_item, const void* match_context)
+static void set_decode_error(FRAME_CODEC_INSTANCE* frame_codec_data)
 {
-    bool result;
-    SUBSCRIPTION* subscription = (SUBSCRIPTION*)singlylinkedlist_item_get_value(list_item);
+    /* Codes_SRS_FRAME_CODEC_01_074: [If a decoding error is detected, any subsequent calls on frame_codec_data_receive_bytes shall fail.] */
+    frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_ERROR;
 
-    if (subscription == NULL)
-    {
-        LogError("Could not get subscription information from the list item");
-        result = false;
-    }
-    else
+    /* Codes_SRS_FRAME_CODEC_01_103: [Upon any decode error, if an error callback has been passed to frame_codec_create, then the error callback shall be called with the context argument being the on_frame_codec_error_callback_context argument passed to frame_codec_create.] */
+    frame_codec_data->on_frame_codec_error(frame_codec_data->on_frame_codec_error_callback_context);
+}
+
+static bool is_frame_header_valid(const FRAME_CODEC_INSTANCE* frame_codec_data, uint32_t frame_size, uint8_t doff)
+{
+    /* Codes_SRS_FRAME_CODEC_01_010: [The frame is malformed if the size is less than the size of the frame header (8 bytes).] */
+    return (frame_size >= FRAME_HEADER_SIZE) &&
+        /* Codes_SRS_FRAME_CODEC_01_096: [If a frame bigger than the current max frame size is received, frame_codec_receive_bytes shall fail and return a non-zero value.] */
+        (frame_size <= frame_codec_data->max_frame_size) &&
+        /* Codes_SRS_FRAME_CODEC_01_014: [Due to the mandatory 8-byte frame header, the frame is malformed if the value is less than 2.] */
+        (doff >= 2) &&
+        /* Codes_SRS_FRAME_CODEC_01_112: [ The frame is malformed if the data offset points past the end of the frame. ]*/
+        ((uint32_t)doff * 4 <= frame_size);
+}
+
+static void deliver_frame(FRAME_CODEC_INSTANCE* frame_codec_data, uint8_t frame_type, const unsigned char* frame_bytes, uint32_t type_specific_size, uint32_t frame_body_size)
+{
+    /* Codes_SRS_FRAME_CODEC_01_035: [After successfully registering a callback for a certain frame type, when subsequently that frame type is received the callbacks shall be invoked, passing to it the received frame and the callback_context value.] */
+    SUBSCRIPTION* subscription = frame_codec_data->subscriptions[frame_type];
+    if (subscription != NULL)
     {
-        result = subscription->frame_type == *((uint8_t*)match_context) ? true : false;
+        /* Codes_SRS_FRAME_CODEC_01_031: [When a complete frame is successfully decoded it shall be indicated to the upper layer by invoking the on_frame_received passed to frame_codec_subscribe.] */
+        /* Codes_SRS_FRAME_CODEC_01_032: [Besides passing the frame information, the callback_context value passed to frame_codec_data_subscribe shall be passed to the on_frame_received function.] */
+        /* Codes_SRS_FRAME_CODEC_01_005: [This is an extension point defined for future expansion.] */
+        /* Codes_SRS_FRAME_CODEC_01_006: [The treatment of this area depends on the frame type.] */
+        /* Codes_SRS_FRAME_CODEC_01_099: [A pointer to the frame_body bytes shall also be passed to the on_frame_received.] */
+        /* Codes_SRS_FRAME_CODEC_01_100: [If the frame body size is 0, the frame_body pointer passed to on_frame_received shall be NULL.] */
+        subscription->on_frame_received(subscription->callback_context, frame_bytes, type_specific_size,
+            (frame_body_size == 0) ? NULL : frame_bytes + type_specific_size, frame_body_size);
     }
-
-    return result;
 }
 
 FRAME_CODEC_HANDLE frame_codec_create(ON_FRAME_CODEC_ERROR on_frame_codec_error, void* callback_context)
@@ -94,13 +116,15 @@ FRAME_CODEC_HANDLE frame_codec_create(ON_FRAME_CODEC_ERROR on_frame_codec_error,
         else
         {
             /* Codes_SRS_FRAME_CODEC_01_021: [frame_codec_create shall create a new instance of frame_codec and return a non-NULL handle to it on success.] */
+            (void)memset(result->subscriptions, 0, sizeof(result->subscriptions));
             result->receive_frame_state = RECEIVE_FRAME_STATE_FRAME_SIZE;
             result->on_frame_codec_error = on_frame_codec_error;
             result->on_frame_codec_error_callback_context = callback_context;
             result->receive_frame_pos = 0;
             result->receive_frame_size = 0;
+            result->receive_frame_subscribed = false;
             result->receive_frame_bytes = NULL;
-            result->subscription_list = singlylinkedlist_create();
+            result->receive_frame_bytes_capacity = 0;
 
             /* Codes_SRS_FRAME_CODEC_01_082: [The initial max_frame_size_shall be 512.] */
             result->max_frame_size = 512;
@@ -120,8 +144,16 @@ void frame_codec_destroy(FRAME_CODEC_HANDLE frame_codec)
     else
     {
         FRAME_CODEC_INSTANCE* frame_codec_data = (FRAME_CODEC_INSTANCE*)frame_codec;
+        size_t i;
+
+        for (i = 0; i < FRAME_TYPE_COUNT; i++)
+        {
+            if (frame_codec_data->subscriptions[i] != NULL)
+            {
+                free(frame_codec_data->subscriptions[i]);
+            }
+        }
 
-        singlylinkedlist_destroy(frame_codec_data->subscription_list);
         if (frame_codec_data->receive_frame_bytes != NULL)
         {
             free(frame_codec_data->receive_frame_bytes);
@@ -208,11 +240,35 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
 
                 /* Codes_SRS_FRAME_CODEC_01_008: [SIZE Bytes 0-3 of the frame header contain the frame size.] */
             case RECEIVE_FRAME_STATE_FRAME_SIZE:
+                if ((frame_codec_data->receive_frame_pos == 0) &&
+                    (size >= FRAME_HEADER_SIZE))
+                {
+                    uint32_t frame_size = ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | (uint32_t)buffer[3];
+                    uint8_t doff = buffer[4];
+
+                    /* Codes_SRS_FRAME_CODEC_01_113: [ When a complete and valid frame is contained in the bytes passed to frame_codec_receive_bytes, the frame shall be indicated to the subscriber directly from those bytes, without copying it. ]*/
+                    if ((frame_size <= size) &&
+                        is_frame_header_valid(frame_codec_data, frame_size, doff))
+                    {
+                        uint32_t type_specific_size = ((uint32_t)doff * 4) - 6;
+
+                        deliver_frame(frame_codec_data, buffer[5], buffer + 6, type_specific_size, frame_size - ((uint32_t)doff * 4));
+
+                        buffer += frame_size;
+                        size -= frame_size;
+                        result = 0;
+                        break;
+                    }
+                }
+
                 /* Codes_SRS_FRAME_CODEC_01_009: [This is an unsigned 32-bit integer that MUST contain the total frame size of the frame header, extended header, and frame body.] */
-                frame_codec_data->receive_frame_size += buffer[0] << (24 - frame_codec_data->receive_frame_pos * 8);
-                buffer++;
-                size--;
-                frame_codec_data->receive_frame_pos++;
+                while ((size > 0) && (frame_codec_data->receive_frame_pos < 4))
+                {
+                    frame_codec_data->receive_frame_size += (uint32_t)buffer[0] << (24 - frame_codec_data->receive_frame_pos * 8);
+                    buffer++;
+                    size--;
+                    frame_codec_data->receive_frame_pos++;
+                }
 
                 if (frame_codec_data->receive_frame_pos == 4)
                 {
@@ -221,10 +277,7 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
                         /* Codes_SRS_FRAME_CODEC_01_096: [If a frame bigger than the current max frame size is received, frame_codec_receive_bytes shall fail and return a non-zero value.] */
                         (frame_codec_data->receive_frame_size > frame_codec_data->max_frame_size))
                     {
-                        /* Codes_SRS_FRAME_CODEC_01_074: [If a decoding error is detected, any subsequent calls on frame_codec_data_receive_bytes shall fail.] */
-                        frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_ERROR;
-                        /* Codes_SRS_FRAME_CODEC_01_103: [Upon any decode error, if an error callback has been passed to frame_codec_create, then the error callback shall be called with the context argument being the on_frame_codec_error_callback_context argument passed to frame_codec_create.] */
-                        frame_codec_data->on_frame_codec_error(frame_codec_data->on_frame_codec_error_callback_context);
+                        set_decode_error(frame_codec_data);
                         LogError("Received frame size is too big");
                         result = __FAILURE__;
                     }
@@ -250,14 +303,11 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
                 size--;
 
                 /* Codes_SRS_FRAME_CODEC_01_014: [Due to the mandatory 8-byte frame header, the frame is malformed if the value is less than 2.] */
-                if (frame_codec_data->receive_frame_doff < 2)
+                if ((frame_codec_data->receive_frame_doff < 2) ||
+                    /* Codes_SRS_FRAME_CODEC_01_112: [ The frame is malformed if the data offset points past the end of the frame. ]*/
+                    ((uint32_t)frame_codec_data->receive_frame_doff * 4 > frame_codec_data->receive_frame_size))
                 {
-                    /* Codes_SRS_FRAME_CODEC_01_074: [If a decoding error is detected, any subsequent calls on frame_codec_data_receive_bytes shall fail.] */
-                    frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_ERROR;
-
-                    /* Codes_SRS_FRAME_CODEC_01_103: [Upon any decode error, if an error callback has been passed to frame_codec_create, then the error callback shall be called with the context argument being the on_frame_codec_error_callback_context argument passed to frame_codec_create.] */
-                    frame_codec_data->on_frame_codec_error(frame_codec_data->on_frame_codec_error_callback_context);
-
+                    set_decode_error(frame_codec_data);
                     LogError("Malformed frame received");
                     result = __FAILURE__;
                 }
@@ -271,7 +321,6 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
 
             case RECEIVE_FRAME_STATE_FRAME_TYPE:
             {
-                LIST_ITEM_HANDLE item_handle;
                 frame_codec_data->type_specific_size = (frame_codec_data->receive_frame_doff * 4) - 6;
 
                 /* Codes_SRS_FRAME_CODEC_01_015: [TYPE Byte 5 of the frame header is a type code.] */
@@ -279,52 +328,38 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
                 buffer++;
                 size--;
 
-                /* Codes_SRS_FRAME_CODEC_01_035: [After successfully registering a callback for a certain frame type, when subsequently that frame type is received the callbacks shall be invoked, passing to it the received frame and the callback_context value.] */
-                item_handle = singlylinkedlist_find(frame_codec_data->subscription_list, find_subscription_by_frame_type, &frame_codec_data->receive_frame_type);
-                if (item_handle == NULL)
-                {
-                    frame_codec_data->receive_frame_subscription = NULL;
-                    frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_TYPE_SPECIFIC;
-                    result = 0;
-                    break;
-                }
-                else
+                frame_codec_data->receive_frame_pos = 0;
+                frame_codec_data->receive_frame_subscribed = (frame_codec_data->subscriptions[frame_codec_data->receive_frame_type] != NULL);
+
+                if (frame_codec_data->receive_frame_subscribed &&
+                    (frame_codec_data->receive_frame_bytes_capacity < frame_codec_data->receive_frame_size - 6))
                 {
-                    frame_codec_data->receive_frame_subscription = (SUBSCRIPTION*)singlylinkedlist_item_get_value(item_handle);
-                    if (frame_codec_data->receive_frame_subscription == NULL)
+                    /* Codes_SRS_FRAME_CODEC_01_102: [frame_codec_receive_bytes shall allocate memory to hold the frame_body bytes.] */
+                    /* Codes_SRS_FRAME_CODEC_01_114: [ The memory holding the frame bytes shall be kept and reused for the following frames, and shall only be reallocated when a frame does not fit in it. ]*/
+                    if (frame_codec_data->receive_frame_bytes != NULL)
                     {
-                        frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_TYPE_SPECIFIC;
-                        result = 0;
-                        break;
+                        free(frame_codec_data->receive_frame_bytes);
                     }
-                    else
-                    {
-                        frame_codec_data->receive_frame_pos = 0;
-
-                        /* Codes_SRS_FRAME_CODEC_01_102: [frame_codec_receive_bytes shall allocate memory to hold the frame_body bytes.] */
-                        frame_codec_data->receive_frame_bytes = (unsigned char*)malloc(frame_codec_data->receive_frame_size - 6);
-                        if (frame_codec_data->receive_frame_bytes == NULL)
-                        {
-                            /* Codes_SRS_FRAME_CODEC_01_101: [If the memory for the frame_body bytes cannot be allocated, frame_codec_receive_bytes shall fail and return a non-zero value.] */
-                            /* Codes_SRS_FRAME_CODEC_01_030: [If a decoding error occurs, frame_codec_data_receive_bytes shall return a non-zero value.] */
-                            /* Codes_SRS_FRAME_CODEC_01_074: [If a decoding error is detected, any subsequent calls on frame_codec_data_receive_bytes shall fail.] */
-                            frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_ERROR;
 
-                            /* Codes_SRS_FRAME_CODEC_01_103: [Upon any decode error, if an error callback has been passed to frame_codec_create, then the error callback shall be called with the context argument being the on_frame_codec_error_callback_context argument passed to frame_codec_create.] */
-                            frame_codec_data->on_frame_codec_error(frame_codec_data->on_frame_codec_error_callback_context);
+                    frame_codec_data->receive_frame_bytes = (unsigned char*)malloc(frame_codec_data->receive_frame_size - 6);
+                    if (frame_codec_data->receive_frame_bytes == NULL)
+                    {
+                        /* Codes_SRS_FRAME_CODEC_01_101: [If the memory for the frame_body bytes cannot be allocated, frame_codec_receive_bytes shall fail and return a non-zero value.] */
+                        /* Codes_SRS_FRAME_CODEC_01_030: [If a decoding error occurs, frame_codec_data_receive_bytes shall return a non-zero value.] */
+                        frame_codec_data->receive_frame_bytes_capacity = 0;
+                        set_decode_error(frame_codec_data);
 
-                            LogError("Cannot allocate memort for frame bytes");
-                            result = __FAILURE__;
-                            break;
-                        }
-                        else
-                        {
-                            frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_TYPE_SPECIFIC;
-                            result = 0;
-                            break;
-                        }
+                        LogError("Cannot allocate memory for frame bytes");
+                        result = __FAILURE__;
+                        break;
                     }
+
+                    frame_codec_data->receive_frame_bytes_capacity = frame_codec_data->receive_frame_size - 6;
                 }
+
+                frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_TYPE_SPECIFIC;
+                result = 0;
+                break;
             }
 
             case RECEIVE_FRAME_STATE_TYPE_SPECIFIC:
@@ -335,34 +370,22 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
                     to_copy = size;
                 }
 
-                if (frame_codec_data->receive_frame_subscription != NULL)
+                if (frame_codec_data->receive_frame_subscribed)
                 {
                     (void)memcpy(&frame_codec_data->receive_frame_bytes[frame_codec_data->receive_frame_pos], buffer, to_copy);
-                    frame_codec_data->receive_frame_pos += to_copy;
-                    buffer += to_copy;
-                    size -= to_copy;
-                }
-                else
-                {
-                    frame_codec_data->receive_frame_pos += to_copy;
-                    buffer += to_copy;
-                    size -= to_copy;
                 }
 
+                frame_codec_data->receive_frame_pos += to_copy;
+                buffer += to_copy;
+                size -= to_copy;
+
                 if (frame_codec_data->receive_frame_pos == frame_codec_data->type_specific_size)
                 {
-                    if (frame_codec_data->receive_frame_size == FRAME_HEADER_SIZE)
+                    if (frame_codec_data->receive_frame_size == frame_codec_data->receive_frame_doff * 4)
                     {
-                        if (frame_codec_data->receive_frame_subscription != NULL)
+                        if (frame_codec_data->receive_frame_subscribed)
                         {
-                            /* Codes_SRS_FRAME_CODEC_01_031: [When a complete frame is successfully decoded it shall be indicated to the upper layer by invoking the on_frame_received passed to frame_codec_subscribe.] */
-                            /* Codes_SRS_FRAME_CODEC_01_032: [Besides passing the frame information, the callback_context value passed to frame_codec_data_subscribe shall be passed to the on_frame_received function.] */
-                            /* Codes_SRS_FRAME_CODEC_01_005: [This is an extension point defined for future expansion.] */
-                            /* Codes_SRS_FRAME_CODEC_01_006: [The treatment of this area depends on the frame type.] */
-                            /* Codes_SRS_FRAME_CODEC_01_100: [If the frame body size is 0, the frame_body pointer passed to on_frame_received shall be NULL.] */
-                            frame_codec_data->receive_frame_subscription->on_frame_received(frame_codec_data->receive_frame_subscription->callback_context, frame_codec_data->receive_frame_bytes, frame_codec_data->type_specific_size, NULL, 0);
-                            free(frame_codec_data->receive_frame_bytes);
-                            frame_codec_data->receive_frame_bytes = NULL;
+                            deliver_frame(frame_codec_data, frame_codec_data->receive_frame_type, frame_codec_data->receive_frame_bytes, frame_codec_data->type_specific_size, 0);
                         }
 
                         frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_FRAME_SIZE;
@@ -390,7 +413,10 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
                     to_copy = size;
                 }
 
-                (void)memcpy(frame_codec_data->receive_frame_bytes + frame_codec_data->receive_frame_pos + frame_codec_data->type_specific_size, buffer, to_copy);
+                if (frame_codec_data->receive_frame_subscribed)
+                {
+                    (void)memcpy(frame_codec_data->receive_frame_bytes + frame_codec_data->receive_frame_pos + frame_codec_data->type_specific_size, buffer, to_copy);
+                }
 
                 buffer += to_copy;
                 size -= to_copy;
@@ -398,16 +424,9 @@ int frame_codec_receive_bytes(FRAME_CODEC_HANDLE frame_codec, const unsigned cha
 
                 if (frame_codec_data->receive_frame_pos == frame_body_size)
                 {
-                    if (frame_codec_data->receive_frame_subscription != NULL)
+                    if (frame_codec_data->receive_frame_subscribed)
                     {
-                        /* Codes_SRS_FRAME_CODEC_01_031: [When a complete frame is successfully decoded it shall be indicated to the upper layer by invoking the on_frame_received passed to frame_codec_subscribe.] */
-                        /* Codes_SRS_FRAME_CODEC_01_032: [Besides passing the frame information, the callback_context value passed to frame_codec_data_subscribe shall be passed to the on_frame_received function.] */
-                        /* Codes_SRS_FRAME_CODEC_01_005: [This is an extension point defined for future expansion.] */
-                        /* Codes_SRS_FRAME_CODEC_01_006: [The treatment of this area depends on the frame type.] */
-                        /* Codes_SRS_FRAME_CODEC_01_099: [A pointer to the frame_body bytes shall also be passed to the on_frame_received.] */
-                        frame_codec_data->receive_frame_subscription->on_frame_received(frame_codec_data->receive_frame_subscription->callback_context, frame_codec_data->receive_frame_bytes, frame_codec_data->type_specific_size, frame_codec_data->receive_frame_bytes + frame_codec_data->type_specific_size, frame_body_size);
-                        free(frame_codec_data->receive_frame_bytes);
-                        frame_codec_data->receive_frame_bytes = NULL;
+                        deliver_frame(frame_codec_data, frame_codec_data->receive_frame_type, frame_codec_data->receive_frame_bytes, frame_codec_data->type_specific_size, frame_body_size);
                     }
 
                     frame_codec_data->receive_frame_state = RECEIVE_FRAME_STATE_FRAME_SIZE;
@@ -441,29 +460,17 @@ int frame_codec_subscribe(FRAME_CODEC_HANDLE frame_codec, uint8_t type, ON_FRAME
     else
     {
         FRAME_CODEC_INSTANCE* frame_codec_data = (FRAME_CODEC_INSTANCE*)frame_codec;
-        SUBSCRIPTION* subscription;
 
         /* Codes_SRS_FRAME_CODEC_01_036: [Only one callback pair shall be allowed to be registered for a given frame type.] */
-        /* find the subscription for this frame type */
-        LIST_ITEM_HANDLE list_item = singlylinkedlist_find(frame_codec_data->subscription_list, find_subscription_by_frame_type, &type);
-        if (list_item != NULL)
+        SUBSCRIPTION* subscription = frame_codec_data->subscriptions[type];
+        if (subscription != NULL)
         {
-            subscription = (SUBSCRIPTION*)singlylinkedlist_item_get_value(list_item);
-            if (subscription == NULL)
-            {
-                /* Codes_SRS_FRAME_CODEC_01_037: [If any failure occurs while performing the subscribe operation, frame_codec_subscribe shall return a non-zero value.] */
-                LogError("Cannot retrieve subscription information from the list for type %u", (unsigned int)type);
-                result = __FAILURE__;
-            }
-            else
-            {
-                /* a subscription was found */
-                subscription->on_frame_received = on_frame_received;
-                subscription->callback_context = callback_context;
+            /* a subscription was found */
+            subscription->on_frame_received = on_frame_received;
+            subscription->callback_context = callback_context;
 
-                /* Codes_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
-                result = 0;
-            }
+            /* Codes_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
+            result = 0;
         }
         else
         {
@@ -479,20 +486,10 @@ int frame_codec_subscribe(FRAME_CODEC_HANDLE frame_codec, uint8_t type, ON_FRAME
             {
                 subscription->on_frame_received = on_frame_received;
                 subscription->callback_context = callback_context;
-                subscription->frame_type = type;
+                frame_codec_data->subscriptions[type] = subscription;
 
-                /* Codes_SRS_FRAME_CODEC_01_037: [If any failure occurs while performing the subscribe operation, frame_codec_subscribe shall return a non-zero value.] */
-                if (singlylinkedlist_add(frame_codec_data->subscription_list, subscription) == NULL)
-                {
-                    free(subscription);
-                    LogError("Cannot add subscription to list");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    /* Codes_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
-                    result = 0;
-                }
+                /* Codes_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
+                result = 0;
             }
         }
     }
@@ -513,9 +510,8 @@ int frame_codec_unsubscribe(FRAME_CODEC_HANDLE frame_codec, uint8_t type)
     else
     {
         FRAME_CODEC_INSTANCE* frame_codec_data = (FRAME_CODEC_INSTANCE*)frame_codec;
-        LIST_ITEM_HANDLE list_item = singlylinkedlist_find(frame_codec_data->subscription_list, find_subscription_by_frame_type, &type);
 
-        if (list_item == NULL)
+        if (frame_codec_data->subscriptions[type] == NULL)
         {
             /* Codes_SRS_FRAME_CODEC_01_040: [If no subscription for the type frame type exists, frame_codec_unsubscribe shall return a non-zero value.] */
             /* Codes_SRS_FRAME_CODEC_01_041: [If any failure occurs while performing the unsubscribe operation, frame_codec_unsubscribe shall return a non-zero value.] */
@@ -524,28 +520,11 @@ int frame_codec_unsubscribe(FRAME_CODEC_HANDLE frame_codec, uint8_t type)
         }
         else
         {
-            SUBSCRIPTION* subscription = (SUBSCRIPTION*)singlylinkedlist_item_get_value(list_item);
-            if (subscription == NULL)
-            {
-                /* Codes_SRS_FRAME_CODEC_01_041: [If any failure occurs while performing the unsubscribe operation, frame_codec_unsubscribe shall return a non-zero value.] */
-                LogError("singlylinkedlist_item_get_value failed when unsubscribing");
-                result = __FAILURE__;
-            }
-            else
-            {
-                free(subscription);
-                if (singlylinkedlist_remove(frame_codec_data->subscription_list, list_item) != 0)
-                {
-                    /* Codes_SRS_FRAME_CODEC_01_041: [If any failure occurs while performing the unsubscribe operation, frame_codec_unsubscribe shall return a non-zero value.] */
-                    LogError("Cannot remove subscription from list");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    /* Codes_SRS_FRAME_CODEC_01_038: [frame_codec_unsubscribe removes a previous subscription for frames of type type and on success it shall return 0.] */
-                    result = 0;
-                }
-            }
+            free(frame_codec_data->subscriptions[type]);
+            frame_codec_data->subscriptions[type] = NULL;
+
+            /* Codes_SRS_FRAME_CODEC_01_038: [frame_codec_unsubscribe removes a previous subscription for frames of type type and on success it shall return 0.] */
+            result = 0;
         }
     }
 
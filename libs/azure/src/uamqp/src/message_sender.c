@@ -153,12 +153,23 @@ static void on_delivery_settled(void* context, delivery_number delivery_no, LINK
     remove_pending_message(message_sender, pending_send);
 }
 
-static int encode_bytes(void* context, const unsigned char* bytes, size_t length)
+static int encode_to_payload(AMQP_VALUE value, PAYLOAD* payload, size_t payload_capacity)
 {
-    PAYLOAD* payload = (PAYLOAD*)context;
-    (void)memcpy((unsigned char*)payload->bytes + payload->length, bytes, length);
-    payload->length += length;
-    return 0;
+    int result;
+    size_t encoded_size;
+
+    if (amqpvalue_encode_to_buffer(value, (unsigned char*)payload->bytes + payload->length, payload_capacity - payload->length, &encoded_size) != 0)
+    {
+        LogError("Cannot encode value into the message payload");
+        result = __FAILURE__;
+    }
+    else
+    {
+        payload->length += encoded_size;
+        result = 0;
+    }
+
+    return result;
 }
 
 static void log_message_chunk(MESSAGE_SENDER_INSTANCE* message_sender, const char* name, AMQP_VALUE value)
@@ -416,11 +427,20 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
                 PAYLOAD payload;
                 payload.bytes = (const unsigned char*)data_bytes;
                 payload.length = 0;
-                result = SEND_ONE_MESSAGE_OK;
 
-                if (header != NULL)
+                if (data_bytes == NULL)
+                {
+                    LogError("Cannot allocate memory for the encoded message");
+                    result = SEND_ONE_MESSAGE_ERROR;
+                }
+                else
                 {
-                    if (amqpvalue_encode(header_amqp_value, encode_bytes, &payload) != 0)
+                    result = SEND_ONE_MESSAGE_OK;
+                }
+
+                if ((result == SEND_ONE_MESSAGE_OK) && (header != NULL))
+                {
+                    if (encode_to_payload(header_amqp_value, &payload, total_encoded_size) != 0)
                     {
                         LogError("Cannot encode header value");
                         result = SEND_ONE_MESSAGE_ERROR;
@@ -431,7 +451,7 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
 
                 if ((result == SEND_ONE_MESSAGE_OK) && (msg_annotations != NULL))
                 {
-                    if (amqpvalue_encode(msg_annotations, encode_bytes, &payload) != 0)
+                    if (encode_to_payload(msg_annotations, &payload, total_encoded_size) != 0)
                     {
                         LogError("Cannot encode message annotations value");
                         result = SEND_ONE_MESSAGE_ERROR;
@@ -442,7 +462,7 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
 
                 if ((result == SEND_ONE_MESSAGE_OK) && (properties != NULL))
                 {
-                    if (amqpvalue_encode(properties_amqp_value, encode_bytes, &payload) != 0)
+                    if (encode_to_payload(properties_amqp_value, &payload, total_encoded_size) != 0)
                     {
                         LogError("Cannot encode message properties value");
                         result = SEND_ONE_MESSAGE_ERROR;
@@ -453,7 +473,7 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
 
                 if ((result == SEND_ONE_MESSAGE_OK) && (application_properties != NULL))
                 {
-                    if (amqpvalue_encode(application_properties_value, encode_bytes, &payload) != 0)
+                    if (encode_to_payload(application_properties_value, &payload, total_encoded_size) != 0)
                     {
                         LogError("Cannot encode application properties value");
                         result = SEND_ONE_MESSAGE_ERROR;
@@ -473,7 +493,7 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
 
                     case MESSAGE_BODY_TYPE_VALUE:
                     {
-                        if (amqpvalue_encode(body_amqp_value, encode_bytes, &payload) != 0)
+                        if (encode_to_payload(body_amqp_value, &payload, total_encoded_size) != 0)
                         {
                             LogError("Cannot encode body AMQP value");
                             result = SEND_ONE_MESSAGE_ERROR;
@@ -487,7 +507,7 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
                         BINARY_DATA binary_data;
                         size_t i;
 
-                        for (i = 0; i < body_data_count; i++)
+                        for (i = 0; (i < body_data_count) && (result == SEND_ONE_MESSAGE_OK); i++)
                         {
                             if (message_get_body_amqp_data_in_place(message, i, &binary_data) != 0)
                             {
@@ -508,11 +528,10 @@ static SEND_ONE_MESSAGE_RESULT send_one_message(MESSAGE_SENDER_INSTANCE* message
                                 }
                                 else
                                 {
-                                    if (amqpvalue_encode(body_amqp_data, encode_bytes, &payload) != 0)
+                                    if (encode_to_payload(body_amqp_data, &payload, total_encoded_size) != 0)
                                     {
                                         LogError("Cannot encode body AMQP data %u", (unsigned int)i);
                                         result = SEND_ONE_MESSAGE_ERROR;
-                                        break;
                                     }
 
                                     amqpvalue_destroy(body_amqp_data);
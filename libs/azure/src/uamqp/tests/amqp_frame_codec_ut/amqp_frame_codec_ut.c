@@ -44,7 +44,7 @@ static void my_gballoc_free(void* ptr)
 
 #define TEST_FRAME_CODEC_HANDLE            (FRAME_CODEC_HANDLE)0x4242
 #define TEST_DESCRIPTOR_AMQP_VALUE        (AMQP_VALUE)0x4243
-#define TEST_DECODER_HANDLE                (AMQPVALUE_DECODER_HANDLE)0x4244
+#define TEST_DECODE_ARENA_HANDLE           (AMQPVALUE_DECODE_ARENA_HANDLE)0x4244
 #define TEST_ENCODER_HANDLE                (ENCODER_HANDLE)0x4245
 #define TEST_AMQP_VALUE                    (AMQP_VALUE)0x4246
 #define TEST_CONTEXT                    (void*)0x4247
@@ -54,9 +54,6 @@ static const unsigned char test_encoded_bytes[2] = { 0x42, 0x43 };
 static ON_FRAME_RECEIVED saved_on_frame_received;
 static void* saved_callback_context;
 
-static ON_VALUE_DECODED saved_value_decoded_callback;
-static void* saved_value_decoded_callback_context;
-static size_t total_bytes;
 static PAYLOAD* actual_payloads;
 static size_t actual_payload_count;
 
@@ -275,30 +272,24 @@ static int my_frame_codec_encode_frame(FRAME_CODEC_HANDLE frame_codec, uint8_t t
     return 0;
 }
 
-static AMQPVALUE_DECODER_HANDLE my_amqpvalue_decoder_create(ON_VALUE_DECODED value_decoded_callback, void* value_decoded_callback_context)
+static AMQPVALUE_DECODE_ARENA_HANDLE my_amqpvalue_decode_arena_create(void)
 {
-    saved_value_decoded_callback = value_decoded_callback;
-    saved_value_decoded_callback_context = value_decoded_callback_context;
-    total_bytes = 0;
-    return TEST_DECODER_HANDLE;
+    return TEST_DECODE_ARENA_HANDLE;
 }
 
-static int my_amqpvalue_decode_bytes(AMQPVALUE_DECODER_HANDLE handle, const unsigned char* buffer, size_t size)
+static int my_amqpvalue_decode_in_place(AMQPVALUE_DECODE_ARENA_HANDLE arena, const unsigned char* buffer, size_t size, AMQP_VALUE* value, size_t* used_bytes)
 {
-    unsigned char* new_bytes = (unsigned char*)my_gballoc_realloc(performative_decoded_bytes, performative_decoded_byte_count + size);
-    (void)handle;
+    size_t performative_size = (size < sizeof(test_performative)) ? size : sizeof(test_performative);
+    unsigned char* new_bytes = (unsigned char*)my_gballoc_realloc(performative_decoded_bytes, performative_decoded_byte_count + performative_size);
+    (void)arena;
     if (new_bytes != NULL)
     {
         performative_decoded_bytes = new_bytes;
-        (void)memcpy(performative_decoded_bytes + performative_decoded_byte_count, buffer, size);
-        performative_decoded_byte_count += size;
-    }
-    total_bytes += size;
-    if (total_bytes == sizeof(test_performative))
-    {
-        saved_value_decoded_callback(saved_value_decoded_callback_context, TEST_AMQP_VALUE);
-        total_bytes = 0;
+        (void)memcpy(performative_decoded_bytes + performative_decoded_byte_count, buffer, performative_size);
+        performative_decoded_byte_count += performative_size;
     }
+    *value = TEST_AMQP_VALUE;
+    *used_bytes = performative_size;
 
     return 0;
 }
@@ -355,8 +346,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_ulong, my_amqpvalue_get_ulong);
     REGISTER_GLOBAL_MOCK_HOOK(frame_codec_subscribe, my_frame_codec_subscribe);
     REGISTER_GLOBAL_MOCK_HOOK(frame_codec_encode_frame, my_frame_codec_encode_frame);
-    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_decoder_create, my_amqpvalue_decoder_create);
-    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_decode_bytes, my_amqpvalue_decode_bytes);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_decode_arena_create, my_amqpvalue_decode_arena_create);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_decode_in_place, my_amqpvalue_decode_in_place);
     REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_encode, my_amqpvalue_encode);
 
     REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_create_ulong, TEST_AMQP_VALUE);
@@ -367,10 +358,9 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_TYPE(PAYLOAD*, PAYLOAD_ptr);
 
-    REGISTER_UMOCK_ALIAS_TYPE(ON_VALUE_DECODED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(FRAME_CODEC_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_FRAME_RECEIVED, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(AMQPVALUE_DECODER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(AMQPVALUE_DECODE_ARENA_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(AMQP_VALUE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_BYTES_ENCODED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(AMQPVALUE_ENCODER_OUTPUT, void*);
@@ -415,14 +405,14 @@ TEST_FUNCTION_CLEANUP(method_cleanup)
 
 /* Tests_SRS_AMQP_FRAME_CODEC_01_011: [amqp_frame_codec_create shall create an instance of an amqp_frame_codec and return a non-NULL handle to it.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_013: [amqp_frame_codec_create shall subscribe for AMQP frames with the given frame_codec.] */
-/* Tests_SRS_AMQP_FRAME_CODEC_01_018: [amqp_frame_codec_create shall create a decoder to be used for decoding AMQP values.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_018: [amqp_frame_codec_create shall create a decode arena to be used for decoding performatives in place by calling amqpvalue_decode_arena_create.] */
 TEST_FUNCTION(amqp_frame_codec_create_with_valid_args_succeeds)
 {
     // arrange
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec;
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_create());
     STRICT_EXPECTED_CALL(frame_codec_subscribe(TEST_FRAME_CODEC_HANDLE, FRAME_TYPE_AMQP, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     // act
@@ -438,14 +428,14 @@ TEST_FUNCTION(amqp_frame_codec_create_with_valid_args_succeeds)
 
 /* Tests_SRS_AMQP_FRAME_CODEC_01_011: [amqp_frame_codec_create shall create an instance of an amqp_frame_codec and return a non-NULL handle to it.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_013: [amqp_frame_codec_create shall subscribe for AMQP frames with the given frame_codec.] */
-/* Tests_SRS_AMQP_FRAME_CODEC_01_018: [amqp_frame_codec_create shall create a decoder to be used for decoding AMQP values.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_018: [amqp_frame_codec_create shall create a decode arena to be used for decoding performatives in place by calling amqpvalue_decode_arena_create.] */
 TEST_FUNCTION(amqp_frame_codec_create_with_valid_args_and_NULL_context_succeeds)
 {
     // arrange
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec;
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_create());
     STRICT_EXPECTED_CALL(frame_codec_subscribe(TEST_FRAME_CODEC_HANDLE, FRAME_TYPE_AMQP, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     // act
@@ -518,11 +508,11 @@ TEST_FUNCTION(when_frame_codec_subscribe_fails_then_amqp_frame_codec_create_fail
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec;
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_create());
     STRICT_EXPECTED_CALL(frame_codec_subscribe(TEST_FRAME_CODEC_HANDLE, FRAME_TYPE_AMQP, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .SetReturn(1);
 
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_destroy(TEST_DECODER_HANDLE));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_destroy(TEST_DECODE_ARENA_HANDLE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
@@ -533,15 +523,15 @@ TEST_FUNCTION(when_frame_codec_subscribe_fails_then_amqp_frame_codec_create_fail
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/* Tests_SRS_AMQP_FRAME_CODEC_01_019: [If creating the decoder fails, amqp_frame_codec_create shall fail and return NULL.] */
-TEST_FUNCTION(when_creating_the_decoder_fails_then_amqp_frame_codec_create_fails)
+/* Tests_SRS_AMQP_FRAME_CODEC_01_019: [If creating the decode arena fails, amqp_frame_codec_create shall fail and return NULL.] */
+TEST_FUNCTION(when_creating_the_decode_arena_fails_then_amqp_frame_codec_create_fails)
 {
     // arrange
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec;
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .SetReturn((AMQPVALUE_DECODER_HANDLE)NULL);
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_create())
+        .SetReturn((AMQPVALUE_DECODE_ARENA_HANDLE)NULL);
 
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
@@ -573,16 +563,16 @@ TEST_FUNCTION(when_allocating_memory_for_amqp_frame_codec_fails_then_amqp_frame_
 /* amqp_frame_codec_destroy */
 
 /* Tests_SRS_AMQP_FRAME_CODEC_01_015: [amqp_frame_codec_destroy shall free all resources associated with the amqp_frame_codec instance.] */
-/* Tests_SRS_AMQP_FRAME_CODEC_01_021: [The decoder created in amqp_frame_codec_create shall be destroyed by amqp_frame_codec_destroy.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_021: [The decode arena created in amqp_frame_codec_create shall be destroyed by amqp_frame_codec_destroy.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_017: [amqp_frame_codec_destroy shall unsubscribe from receiving AMQP frames from the frame_codec that was passed to amqp_frame_codec_create.] */
-TEST_FUNCTION(amqp_frame_codec_destroy_frees_the_decoder_and_unsubscribes_from_AMQP_frames)
+TEST_FUNCTION(amqp_frame_codec_destroy_frees_the_decode_arena_and_unsubscribes_from_AMQP_frames)
 {
     // arrange
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(frame_codec_unsubscribe(TEST_FRAME_CODEC_HANDLE, FRAME_TYPE_AMQP));
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_destroy(TEST_DECODER_HANDLE));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_destroy(TEST_DECODE_ARENA_HANDLE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
@@ -593,7 +583,7 @@ TEST_FUNCTION(amqp_frame_codec_destroy_frees_the_decoder_and_unsubscribes_from_A
 }
 
 /* Tests_SRS_AMQP_FRAME_CODEC_01_015: [amqp_frame_codec_destroy shall free all resources associated with the amqp_frame_codec instance.] */
-/* Tests_SRS_AMQP_FRAME_CODEC_01_021: [The decoder created in amqp_frame_codec_create shall be destroyed by amqp_frame_codec_destroy.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_021: [The decode arena created in amqp_frame_codec_create shall be destroyed by amqp_frame_codec_destroy.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_017: [amqp_frame_codec_destroy shall unsubscribe from receiving AMQP frames from the frame_codec that was passed to amqp_frame_codec_create.] */
 TEST_FUNCTION(when_unsubscribe_fails_amqp_frame_codec_destroy_still_frees_everything)
 {
@@ -603,7 +593,7 @@ TEST_FUNCTION(when_unsubscribe_fails_amqp_frame_codec_destroy_still_frees_everyt
 
     STRICT_EXPECTED_CALL(frame_codec_unsubscribe(TEST_FRAME_CODEC_HANDLE, FRAME_TYPE_AMQP))
         .SetReturn(1);
-    STRICT_EXPECTED_CALL(amqpvalue_decoder_destroy(TEST_DECODER_HANDLE));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_destroy(TEST_DECODE_ARENA_HANDLE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
@@ -1250,7 +1240,7 @@ TEST_FUNCTION(when_an_empty_frame_with_only_1_byte_of_type_specific_data_is_rece
     amqp_frame_codec_destroy(amqp_frame_codec);
 }
 
-/* Tests_SRS_AMQP_FRAME_CODEC_01_052: [Decoding the performative shall be done by feeding the bytes to the decoder create in amqp_frame_codec_create.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_052: [Decoding the performative shall be done by calling amqpvalue_decode_in_place with the arena created in amqp_frame_codec_create and the frame body bytes.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_054: [Once the performative is decoded, the callback frame_received_callback shall be called.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_055: [The decoded channel and performative shall be passed to frame_received_callback.]  */
 TEST_FUNCTION(when_all_performative_bytes_are_received_and_AMQP_frame_payload_is_0_callback_is_triggered)
@@ -1259,17 +1249,14 @@ TEST_FUNCTION(when_all_performative_bytes_are_received_and_AMQP_frame_payload_is
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
     uint64_t descriptor_ulong = AMQP_OPEN;
-    size_t i;
     umock_c_reset_all_calls();
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &descriptor_ulong, sizeof(descriptor_ulong));
     STRICT_EXPECTED_CALL(amqp_frame_received_callback_1(TEST_CONTEXT, 0x4243, TEST_AMQP_VALUE, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_performative, sizeof(test_performative));
@@ -1294,19 +1281,16 @@ TEST_FUNCTION(amqp_frame_with_1_payload_bytes_are_reported_via_the_amqp_frame_pa
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
     uint64_t descriptor_ulong = AMQP_OPEN;
-    size_t i;
     umock_c_reset_all_calls();
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &descriptor_ulong, sizeof(descriptor_ulong));
 
     STRICT_EXPECTED_CALL(amqp_frame_received_callback_1(TEST_CONTEXT, 0x4243, TEST_AMQP_VALUE, test_frame_payload_bytes, 1))
         .ValidateArgumentBuffer(4, test_frame_payload_bytes, 1);
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 1);
@@ -1328,19 +1312,16 @@ TEST_FUNCTION(amqp_frame_with_2_payload_bytes_are_reported_via_the_amqp_frame_pa
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
     uint64_t descriptor_ulong = AMQP_OPEN;
-    size_t i;
     umock_c_reset_all_calls();
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &descriptor_ulong, sizeof(descriptor_ulong));
 
     STRICT_EXPECTED_CALL(amqp_frame_received_callback_1(TEST_CONTEXT, 0x4243, TEST_AMQP_VALUE, test_frame_payload_bytes, 2))
         .ValidateArgumentBuffer(4, test_frame_payload_bytes, 2);
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1353,38 +1334,34 @@ TEST_FUNCTION(amqp_frame_with_2_payload_bytes_are_reported_via_the_amqp_frame_pa
 }
 
 /* Tests_SRS_AMQP_FRAME_CODEC_01_002: [The frame body is defined as a performative followed by an opaque payload.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_071: [Once frame_received_callback returns or decoding the performative fails, the values decoded for the frame shall be released by calling amqpvalue_decode_arena_reset, while the frame body bytes are still valid.] */
 TEST_FUNCTION(after_decoding_succesfully_a_second_frame_can_be_decoded)
 {
     // arrange
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
     uint64_t descriptor_ulong = AMQP_OPEN;
-    size_t i;
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &descriptor_ulong, sizeof(descriptor_ulong));
 
     STRICT_EXPECTED_CALL(amqp_frame_received_callback_1(TEST_CONTEXT, 0x4243, TEST_AMQP_VALUE, test_frame_payload_bytes, 2))
         .ValidateArgumentBuffer(4, test_frame_payload_bytes, 2);
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     (void)saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
     umock_c_reset_all_calls();
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &descriptor_ulong, sizeof(descriptor_ulong));
 
     STRICT_EXPECTED_CALL(amqp_frame_received_callback_1(TEST_CONTEXT, 0x4243, TEST_AMQP_VALUE, test_frame_payload_bytes, 2))
         .ValidateArgumentBuffer(4, test_frame_payload_bytes, 2);
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1407,21 +1384,18 @@ TEST_FUNCTION(valid_performative_codes_trigger_callbacks)
 
     for (i = 0; i < 2; i++)
     {
-        size_t j;
         umock_c_reset_all_calls();
 
         performative_ulong = valid_performatives[i];
 
-        for (j = 0; j < sizeof(test_performative); j++)
-        {
-            STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-        }
+        STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
         STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
             .CopyOutArgumentBuffer(2, &performative_ulong, sizeof(performative_ulong));
 
         STRICT_EXPECTED_CALL(amqp_frame_received_callback_1(TEST_CONTEXT, 0x4243, TEST_AMQP_VALUE, test_frame_payload_bytes, 2))
             .ValidateArgumentBuffer(4, test_frame_payload_bytes, 2);
+        STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
         // act
         saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1441,19 +1415,16 @@ TEST_FUNCTION(performative_0x09_can_not_be_decoded)
     // arrange
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
-    size_t i;
     umock_c_reset_all_calls();
     performative_ulong = 0x09;
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &performative_ulong, sizeof(performative_ulong));
 
     STRICT_EXPECTED_CALL(test_amqp_frame_codec_error(TEST_CONTEXT));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1472,20 +1443,17 @@ TEST_FUNCTION(performative_0x19_can_not_be_decoded)
     // arrange
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
-    size_t i;
     umock_c_reset_all_calls();
     performative_ulong = 0x19;
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &performative_ulong, sizeof(performative_ulong));
 
     STRICT_EXPECTED_CALL(test_amqp_frame_codec_error(TEST_CONTEXT));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1499,6 +1467,7 @@ TEST_FUNCTION(performative_0x19_can_not_be_decoded)
 
 /* Tests_SRS_AMQP_FRAME_CODEC_01_060: [If any error occurs while decoding a frame, the decoder shall switch to an error state where decoding shall not be possible anymore.] */
 /* Tests_SRS_AMQP_FRAME_CODEC_01_069: [If any error occurs while decoding a frame, the decoder shall indicate the error by calling the amqp_frame_codec_error_callback  and passing to it the callback context argument that was given in amqp_frame_codec_create.] */
+/* Tests_SRS_AMQP_FRAME_CODEC_01_071: [Once frame_received_callback returns or decoding the performative fails, the values decoded for the frame shall be released by calling amqpvalue_decode_arena_reset, while the frame body bytes are still valid.] */
 TEST_FUNCTION(when_amqp_value_decoding_for_the_performative_fails_decoder_fails)
 {
     // arrange
@@ -1507,36 +1476,11 @@ TEST_FUNCTION(when_amqp_value_decoding_for_the_performative_fails_decoder_fails)
     umock_c_reset_all_calls();
 
     performative_ulong = AMQP_OPEN;
-    STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
-        .SetReturn(1);
-
-    STRICT_EXPECTED_CALL(test_amqp_frame_codec_error(TEST_CONTEXT));
-
-    // act
-    saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
-
-    // assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    // cleanup
-    amqp_frame_codec_destroy(amqp_frame_codec);
-}
-
-/* Tests_SRS_AMQP_FRAME_CODEC_01_060: [If any error occurs while decoding a frame, the decoder shall switch to an error state where decoding shall not be possible anymore.] */
-/* Tests_SRS_AMQP_FRAME_CODEC_01_069: [If any error occurs while decoding a frame, the decoder shall indicate the error by calling the amqp_frame_codec_error_callback  and passing to it the callback context argument that was given in amqp_frame_codec_create.] */
-TEST_FUNCTION(when_second_amqp_value_decoding_for_the_performative_fails_decoder_fails)
-{
-    // arrange
-    unsigned char channel_bytes[] = { 0x42, 0x43 };
-    AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
-    umock_c_reset_all_calls();
-
-    performative_ulong = AMQP_OPEN;
-    STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .SetReturn(1);
 
     STRICT_EXPECTED_CALL(test_amqp_frame_codec_error(TEST_CONTEXT));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1555,19 +1499,16 @@ TEST_FUNCTION(when_getting_the_descriptor_fails_decoder_fails)
     // arrange
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
-    size_t i;
     umock_c_reset_all_calls();
     performative_ulong = AMQP_OPEN;
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE))
         .SetReturn(NULL);
 
     STRICT_EXPECTED_CALL(test_amqp_frame_codec_error(TEST_CONTEXT));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1586,14 +1527,10 @@ TEST_FUNCTION(when_getting_the_ulong_value_of_the_descriptor_fails_decoder_fails
     // arrange
     unsigned char channel_bytes[] = { 0x42, 0x43 };
     AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = amqp_frame_codec_create(TEST_FRAME_CODEC_HANDLE, amqp_frame_received_callback_1, amqp_empty_frame_received_callback_1, test_amqp_frame_codec_error, TEST_CONTEXT);
-    size_t i;
     umock_c_reset_all_calls();
     performative_ulong = AMQP_OPEN;
 
-    for (i = 0; i < sizeof(test_performative); i++)
-    {
-        STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    }
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_AMQP_VALUE));
     STRICT_EXPECTED_CALL(amqpvalue_get_ulong(TEST_DESCRIPTOR_AMQP_VALUE, IGNORED_PTR_ARG))
@@ -1601,6 +1538,7 @@ TEST_FUNCTION(when_getting_the_ulong_value_of_the_descriptor_fails_decoder_fails
         .SetReturn(1);
 
     STRICT_EXPECTED_CALL(test_amqp_frame_codec_error(TEST_CONTEXT));
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     // act
     saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
@@ -1621,8 +1559,9 @@ TEST_FUNCTION(when_amqp_value_decoding_fails_subsequent_decoding_fails_even_if_t
     umock_c_reset_all_calls();
 
     performative_ulong = AMQP_OPEN;
-    STRICT_EXPECTED_CALL(amqpvalue_decode_bytes(TEST_DECODER_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+    STRICT_EXPECTED_CALL(amqpvalue_decode_in_place(TEST_DECODE_ARENA_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .SetReturn(1);
+    STRICT_EXPECTED_CALL(amqpvalue_decode_arena_reset(TEST_DECODE_ARENA_HANDLE));
 
     (void)saved_on_frame_received(saved_callback_context, channel_bytes, sizeof(channel_bytes), test_frame, sizeof(test_performative) + 2);
     umock_c_reset_all_calls();
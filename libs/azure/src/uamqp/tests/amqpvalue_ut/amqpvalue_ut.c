@@ -9465,6 +9465,98 @@ TEST_FUNCTION(amqpvalue_encode_array_with_2_different_items_fails)
     test_amqpvalue_encode_failure(source);
 }
 
+/* Tests_SRS_AMQPVALUE_01_429: [amqpvalue_encode shall gather the encoded bytes and pass them to the encoder_output function in as few calls as possible, passing binary, string and symbol contents that do not fit in its buffer without copying them.] */
+TEST_FUNCTION(amqpvalue_encode_list_with_2_different_items_passes_the_bytes_in_one_call)
+{
+    // arrange
+    int result;
+    AMQP_VALUE source = amqpvalue_create_list();
+    unsigned char bytes[] = { 0x42 };
+    amqp_binary binary;
+    AMQP_VALUE item;
+    binary.bytes = &bytes;
+    binary.length = sizeof(bytes);
+    item = amqpvalue_create_binary(binary);
+    amqpvalue_set_list_item(source, 0, item);
+    amqpvalue_destroy(item);
+    item = amqpvalue_create_null();
+    amqpvalue_set_list_item(source, 1, item);
+    amqpvalue_destroy(item);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_encoder_output(test_context, IGNORED_PTR_ARG, 7));
+
+    // act
+    result = amqpvalue_encode(source, test_encoder_output, test_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    stringify_bytes(encoded_bytes, encoded_byte_count, actual_stringified);
+    ASSERT_ARE_EQUAL(char_ptr, "[0xC0,0x05,0x02,0xA0,0x01,0x42,0x40]", actual_stringified);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_429: [amqpvalue_encode shall gather the encoded bytes and pass them to the encoder_output function in as few calls as possible, passing binary, string and symbol contents that do not fit in its buffer without copying them.] */
+TEST_FUNCTION(amqpvalue_encode_passes_a_big_binary_to_the_encoder_output_without_copying_it)
+{
+    // arrange
+    int result;
+    unsigned char bytes[1024] = { 0 };
+    amqp_binary binary;
+    amqp_binary binary_in_value;
+    AMQP_VALUE source;
+    binary.bytes = &bytes;
+    binary.length = sizeof(bytes);
+    source = amqpvalue_create_binary(binary);
+    (void)amqpvalue_get_binary(source, &binary_in_value);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_encoder_output(NULL, IGNORED_PTR_ARG, 5));
+    STRICT_EXPECTED_CALL(test_encoder_output(NULL, (const unsigned char*)binary_in_value.bytes, sizeof(bytes)));
+
+    // act
+    result = amqpvalue_encode(source, test_encoder_output, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(bytes) + 5, encoded_byte_count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_274: [When the encoder output function fails, amqpvalue_encode shall fail and return a non-zero value.] */
+TEST_FUNCTION(when_passing_a_big_binary_to_the_encoder_output_fails_amqpvalue_encode_fails)
+{
+    // arrange
+    int result;
+    unsigned char bytes[1024] = { 0 };
+    amqp_binary binary;
+    AMQP_VALUE source;
+    binary.bytes = &bytes;
+    binary.length = sizeof(bytes);
+    source = amqpvalue_create_binary(binary);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_encoder_output(NULL, IGNORED_PTR_ARG, 5));
+    STRICT_EXPECTED_CALL(test_encoder_output(NULL, IGNORED_PTR_ARG, sizeof(bytes)))
+        .SetReturn(1);
+
+    // act
+    result = amqpvalue_encode(source, test_encoder_output, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
 /* amqpvalue_get_encoded_size */
 
 /* Tests_SRS_AMQPVALUE_01_309: [If any argument is NULL, amqpvalue_get_encoded_size shall return a non-zero value.] */
@@ -10095,6 +10187,197 @@ TEST_FUNCTION(amqpvalue_get_encoded_size_with_array_value_with_255_null_items_su
     test_amqpvalue_get_encoded_size(source, 264);
 }
 
+/* Tests_SRS_AMQPVALUE_01_308: [amqpvalue_get_encoded_size shall fill in the encoded_size argument the number of bytes required to encode the given AMQP value.] */
+TEST_FUNCTION(amqpvalue_get_encoded_size_with_a_list_nested_in_a_list_succeeds)
+{
+    // arrange
+    AMQP_VALUE source = amqpvalue_create_list();
+    AMQP_VALUE inner_list = amqpvalue_create_list();
+    AMQP_VALUE item = amqpvalue_create_uint(0x1000);
+    (void)amqpvalue_set_list_item(inner_list, 0, item);
+    (void)amqpvalue_set_list_item(inner_list, 1, item);
+    amqpvalue_destroy(item);
+    (void)amqpvalue_set_list_item(source, 0, inner_list);
+    amqpvalue_destroy(inner_list);
+    test_amqpvalue_get_encoded_size(source, 16);
+}
+
+/* amqpvalue_encode_to_buffer */
+
+/* Tests_SRS_AMQPVALUE_01_432: [If value, buffer or encoded_size is NULL, amqpvalue_encode_to_buffer shall fail and return a non-zero value.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_NULL_value_fails)
+{
+    // arrange
+    unsigned char buffer[16];
+    size_t encoded_size;
+
+    // act
+    int result = amqpvalue_encode_to_buffer(NULL, buffer, sizeof(buffer), &encoded_size);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_AMQPVALUE_01_432: [If value, buffer or encoded_size is NULL, amqpvalue_encode_to_buffer shall fail and return a non-zero value.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_NULL_buffer_fails)
+{
+    // arrange
+    int result;
+    size_t encoded_size;
+    AMQP_VALUE source = amqpvalue_create_null();
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_encode_to_buffer(source, NULL, 16, &encoded_size);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_432: [If value, buffer or encoded_size is NULL, amqpvalue_encode_to_buffer shall fail and return a non-zero value.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_NULL_encoded_size_fails)
+{
+    // arrange
+    int result;
+    unsigned char buffer[16];
+    AMQP_VALUE source = amqpvalue_create_null();
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_encode_to_buffer(source, buffer, sizeof(buffer), NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_430: [amqpvalue_encode_to_buffer shall encode the value per the ISO into buffer and fill in encoded_size the number of bytes written.] */
+/* Tests_SRS_AMQPVALUE_01_431: [On success amqpvalue_encode_to_buffer shall return 0.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_a_list_nested_in_a_list_succeeds)
+{
+    // arrange
+    int result;
+    unsigned char buffer[32];
+    size_t encoded_size;
+    AMQP_VALUE source = amqpvalue_create_list();
+    AMQP_VALUE inner_list = amqpvalue_create_list();
+    AMQP_VALUE item = amqpvalue_create_uint(0x1000);
+    (void)amqpvalue_set_list_item(inner_list, 0, item);
+    (void)amqpvalue_set_list_item(inner_list, 1, item);
+    amqpvalue_destroy(item);
+    (void)amqpvalue_set_list_item(source, 0, inner_list);
+    amqpvalue_destroy(inner_list);
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_encode_to_buffer(source, buffer, sizeof(buffer), &encoded_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 16, encoded_size);
+    stringify_bytes(buffer, encoded_size, actual_stringified);
+    ASSERT_ARE_EQUAL(char_ptr, "[0xC0,0x0E,0x01,0xC0,0x0B,0x02,0x70,0x00,0x00,0x10,0x00,0x70,0x00,0x00,0x10,0x00]", actual_stringified);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_430: [amqpvalue_encode_to_buffer shall encode the value per the ISO into buffer and fill in encoded_size the number of bytes written.] */
+/* Tests_SRS_AMQPVALUE_01_431: [On success amqpvalue_encode_to_buffer shall return 0.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_a_described_binary_succeeds)
+{
+    // arrange
+    int result;
+    unsigned char buffer[400];
+    unsigned char bytes[300];
+    unsigned char expected_bytes[308] = { 0x00, 0x53, 0x75, 0xB0, 0x00, 0x00, 0x01, 0x2C };
+    size_t encoded_size;
+    amqp_binary binary;
+    AMQP_VALUE descriptor = amqpvalue_create_ulong(0x75);
+    AMQP_VALUE data;
+    AMQP_VALUE source;
+    size_t i;
+    for (i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = (unsigned char)i;
+        expected_bytes[i + 8] = (unsigned char)i;
+    }
+    binary.bytes = bytes;
+    binary.length = sizeof(bytes);
+    data = amqpvalue_create_binary(binary);
+    source = amqpvalue_create_described(descriptor, data);
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_encode_to_buffer(source, buffer, sizeof(buffer), &encoded_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected_bytes), encoded_size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected_bytes, buffer, sizeof(expected_bytes)));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_433: [If buffer_size is smaller than the encoded size of value, amqpvalue_encode_to_buffer shall fail and return a non-zero value without writing to buffer.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_a_buffer_too_small_fails)
+{
+    // arrange
+    int result;
+    unsigned char buffer[6];
+    size_t encoded_size;
+    size_t i;
+    AMQP_VALUE source = amqpvalue_create_string("abcde");
+    (void)memset(buffer, 0xAA, sizeof(buffer));
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_encode_to_buffer(source, buffer, sizeof(buffer), &encoded_size);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    for (i = 0; i < sizeof(buffer); i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0xAA, buffer[i]);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
+/* Tests_SRS_AMQPVALUE_01_434: [If encoding fails due to any error not specifically mentioned here, amqpvalue_encode_to_buffer shall fail and return a non-zero value.] */
+TEST_FUNCTION(amqpvalue_encode_to_buffer_with_a_value_that_cannot_be_encoded_fails)
+{
+    // arrange
+    int result;
+    unsigned char buffer[16];
+    size_t encoded_size;
+    AMQP_VALUE source = amqpvalue_create_char(0x42);
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_encode_to_buffer(source, buffer, sizeof(buffer), &encoded_size);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(source);
+}
+
 /* amqpvalue_destroy */
 
 /* Tests_SRS_AMQPVALUE_01_315: [If the value argument is NULL, amqpvalue_destroy shall do nothing.] */
@@ -16373,4 +16656,546 @@ TEST_FUNCTION(amqpvalue_decode_array_0xF0_256_null_items_succeeds)
     amqpvalue_decoder_destroy(amqpvalue_decoder);
 }
 
+/* amqpvalue_decode_arena_create */
+
+/* Tests_SRS_AMQPVALUE_01_435: [amqpvalue_decode_arena_create shall create a new decode arena and return a non-NULL handle to it.]*/
+TEST_FUNCTION(amqpvalue_decode_arena_create_succeeds)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    // act
+    arena = amqpvalue_decode_arena_create();
+
+    // assert
+    ASSERT_IS_NOT_NULL(arena);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_436: [If allocating memory for the arena fails, amqpvalue_decode_arena_create shall return NULL.]*/
+TEST_FUNCTION(when_allocating_memory_fails_then_amqpvalue_decode_arena_create_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    arena = amqpvalue_decode_arena_create();
+
+    // assert
+    ASSERT_IS_NULL(arena);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* amqpvalue_decode_arena_destroy */
+
+/* Tests_SRS_AMQPVALUE_01_437: [amqpvalue_decode_arena_destroy shall release the values decoded in place with the arena and free all the arena resources that are not kept alive by clones.]*/
+TEST_FUNCTION(amqpvalue_decode_arena_destroy_frees_the_arena)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(arena));
+
+    // act
+    amqpvalue_decode_arena_destroy(arena);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_AMQPVALUE_01_437: [amqpvalue_decode_arena_destroy shall release the values decoded in place with the arena and free all the arena resources that are not kept alive by clones.]*/
+TEST_FUNCTION(amqpvalue_decode_arena_destroy_frees_the_memory_of_the_decoded_values)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    unsigned char bytes[] = { 0x45 };
+    AMQP_VALUE value;
+    size_t used_bytes;
+    (void)amqpvalue_decode_in_place(arena, bytes, sizeof(bytes), &value, &used_bytes);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(arena));
+
+    // act
+    amqpvalue_decode_arena_destroy(arena);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_AMQPVALUE_01_438: [If arena is NULL, amqpvalue_decode_arena_destroy shall do nothing.]*/
+TEST_FUNCTION(amqpvalue_decode_arena_destroy_with_NULL_arena_does_nothing)
+{
+    // arrange
+
+    // act
+    amqpvalue_decode_arena_destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* amqpvalue_decode_in_place */
+
+static unsigned char test_performative_bytes[] = { 0x00, 0x53, 0x14, 0xC0, 0x0B, 0x03, 0x52, 0x01, 0xA0, 0x02, 0xAB, 0xCD, 0xA1, 0x02, 'h', 'i', 0x42 };
+
+/* Tests_SRS_AMQPVALUE_01_439: [amqpvalue_decode_in_place shall decode the value encoded at the start of buffer, allocating the value and all its items in the arena, and on success fill in value the decoded value, fill in used_bytes the number of bytes it was encoded in and return 0.]*/
+/* Tests_SRS_AMQPVALUE_01_442: [Binary values shall point to their bytes in buffer instead of copying them, while strings and symbols shall be copied in the arena.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_decodes_a_described_list)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    AMQP_VALUE list;
+    AMQP_VALUE item;
+    size_t used_bytes;
+    uint64_t descriptor_value;
+    uint32_t item_count;
+    uint32_t uint_value;
+    amqp_binary binary_value;
+    const char* string_value;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreAllCalls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, sizeof(test_performative_bytes) - 1, used_bytes);
+    ASSERT_ARE_EQUAL(int, (int)AMQP_TYPE_DESCRIBED, (int)amqpvalue_get_type(value));
+    (void)amqpvalue_get_ulong(amqpvalue_get_inplace_descriptor(value), &descriptor_value);
+    ASSERT_ARE_EQUAL(int, 0x14, (int)descriptor_value);
+    list = amqpvalue_get_inplace_described_value(value);
+    (void)amqpvalue_get_list_item_count(list, &item_count);
+    ASSERT_ARE_EQUAL(uint32_t, 3, item_count);
+    item = amqpvalue_get_list_item(list, 0);
+    (void)amqpvalue_get_uint(item, &uint_value);
+    ASSERT_ARE_EQUAL(uint32_t, 1, uint_value);
+    amqpvalue_destroy(item);
+    item = amqpvalue_get_list_item(list, 1);
+    (void)amqpvalue_get_binary(item, &binary_value);
+    ASSERT_ARE_EQUAL(uint32_t, 2, binary_value.length);
+    ASSERT_IS_TRUE((const unsigned char*)binary_value.bytes == &test_performative_bytes[10]);
+    amqpvalue_destroy(item);
+    item = amqpvalue_get_list_item(list, 2);
+    (void)amqpvalue_get_string(item, &string_value);
+    ASSERT_ARE_EQUAL(char_ptr, "hi", string_value);
+    amqpvalue_destroy(item);
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_439: [amqpvalue_decode_in_place shall decode the value encoded at the start of buffer, allocating the value and all its items in the arena, and on success fill in value the decoded value, fill in used_bytes the number of bytes it was encoded in and return 0.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_gives_the_same_value_as_amqpvalue_decode_bytes)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQPVALUE_DECODER_HANDLE amqpvalue_decoder = amqpvalue_decoder_create(value_decoded_callback, test_context);
+    unsigned char bytes[] = { 0xC1, 0x14, 0x04, 0xA3, 0x01, 'k', 0x71, 0x00, 0x00, 0x01, 0x00, 0x53, 0x07, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    (void)amqpvalue_decode_bytes(amqpvalue_decoder, bytes, sizeof(bytes));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreAllCalls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, bytes, sizeof(bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, sizeof(bytes), used_bytes);
+    ASSERT_IS_TRUE(amqpvalue_are_equal(decoded_values[0], value));
+
+    // cleanup
+    amqpvalue_decoder_destroy(amqpvalue_decoder);
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_440: [If arena, buffer, value or used_bytes is NULL or size is 0, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_NULL_arena_fails)
+{
+    // arrange
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+
+    // act
+    result = amqpvalue_decode_in_place(NULL, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_AMQPVALUE_01_440: [If arena, buffer, value or used_bytes is NULL or size is 0, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_NULL_buffer_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, NULL, sizeof(test_performative_bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_440: [If arena, buffer, value or used_bytes is NULL or size is 0, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_0_size_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, 0, &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_440: [If arena, buffer, value or used_bytes is NULL or size is 0, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_NULL_value_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), NULL, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_440: [If arena, buffer, value or used_bytes is NULL or size is 0, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_NULL_used_bytes_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_441: [If buffer does not start with a complete and valid encoded value, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_an_incomplete_value_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreAllCalls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes) - 2, &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_441: [If buffer does not start with a complete and valid encoded value, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_an_invalid_constructor_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    unsigned char bytes[] = { 0x01 };
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreAllCalls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, bytes, sizeof(bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_441: [If buffer does not start with a complete and valid encoded value, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(amqpvalue_decode_in_place_with_a_list_count_larger_than_the_buffer_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    unsigned char bytes[] = { 0xD0, 0x00, 0x00, 0x00, 0x05, 0xFF, 0xFF, 0xFF, 0xFF, 0x40 };
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreAllCalls();
+
+    // act
+    result = amqpvalue_decode_in_place(arena, bytes, sizeof(bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_443: [If allocating memory in the arena fails, amqpvalue_decode_in_place shall fail and return a non-zero value.]*/
+TEST_FUNCTION(when_allocating_the_arena_memory_fails_then_amqpvalue_decode_in_place_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_444: [Values decoded in place are owned by their arena, amqpvalue_destroy shall only release the references obtained by cloning them.]*/
+TEST_FUNCTION(destroying_a_clone_of_a_value_decoded_in_place_does_not_free_memory)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    AMQP_VALUE cloned_value;
+    size_t used_bytes;
+    (void)amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+    cloned_value = amqpvalue_clone(value);
+    umock_c_reset_all_calls();
+
+    // act
+    amqpvalue_destroy(cloned_value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_449: [Values decoded in place shall not be modified: amqpvalue_set_list_item_count, amqpvalue_set_list_item, amqpvalue_set_map_value, amqpvalue_add_array_item and amqpvalue_set_composite_item shall fail and return a non-zero value for them.]*/
+TEST_FUNCTION(amqpvalue_set_list_item_on_a_list_decoded_in_place_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    AMQP_VALUE null_value = amqpvalue_create_null();
+    size_t used_bytes;
+    int result;
+    (void)amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_set_list_item(amqpvalue_get_inplace_described_value(value), 0, null_value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(null_value);
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_449: [Values decoded in place shall not be modified: amqpvalue_set_list_item_count, amqpvalue_set_list_item, amqpvalue_set_map_value, amqpvalue_add_array_item and amqpvalue_set_composite_item shall fail and return a non-zero value for them.]*/
+TEST_FUNCTION(amqpvalue_set_composite_item_on_a_value_decoded_in_place_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    AMQP_VALUE null_value = amqpvalue_create_null();
+    size_t used_bytes;
+    int result;
+    (void)amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+    umock_c_reset_all_calls();
+
+    // act
+    result = amqpvalue_set_composite_item(value, 0, null_value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_destroy(null_value);
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* amqpvalue_decode_arena_reset */
+
+/* Tests_SRS_AMQPVALUE_01_446: [amqpvalue_decode_arena_reset shall release all the values decoded in place with the arena at once, keeping the arena memory for the values decoded next.]*/
+TEST_FUNCTION(decoding_in_place_after_amqpvalue_decode_arena_reset_does_not_allocate_memory)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    AMQP_VALUE value;
+    size_t used_bytes;
+    int result;
+    (void)amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+    umock_c_reset_all_calls();
+
+    // act
+    amqpvalue_decode_arena_reset(arena);
+    result = amqpvalue_decode_in_place(arena, test_performative_bytes, sizeof(test_performative_bytes), &value, &used_bytes);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, (int)AMQP_TYPE_DESCRIBED, (int)amqpvalue_get_type(value));
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_445: [Cloning a value decoded in place shall keep the memory of its arena alive until the clone is destroyed, even if the arena is reset or destroyed meanwhile.]*/
+/* Tests_SRS_AMQPVALUE_01_447: [When a value decoded in place is cloned, the binary values pointing into the decoded buffers shall be copied in the arena memory, so that the clone does not refer to the buffer anymore.]*/
+TEST_FUNCTION(a_clone_of_a_value_decoded_in_place_outlives_the_arena_and_the_buffer)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    unsigned char bytes[] = { 0xA0, 0x02, 0xAB, 0xCD };
+    unsigned char expected_bytes[] = { 0xAB, 0xCD };
+    AMQP_VALUE value;
+    AMQP_VALUE cloned_value;
+    amqp_binary binary_value;
+    size_t used_bytes;
+    (void)amqpvalue_decode_in_place(arena, bytes, sizeof(bytes), &value, &used_bytes);
+    cloned_value = amqpvalue_clone(value);
+    /* the buffer goes away before the arena is reset, like a receive buffer reused for the next frame */
+    (void)memset(bytes, 0, sizeof(bytes));
+    amqpvalue_decode_arena_reset(arena);
+    amqpvalue_decode_arena_destroy(arena);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    (void)amqpvalue_get_binary(cloned_value, &binary_value);
+    stringify_bytes((const unsigned char*)binary_value.bytes, binary_value.length, actual_stringified);
+    amqpvalue_destroy(cloned_value);
+
+    // assert
+    stringify_bytes(expected_bytes, sizeof(expected_bytes), expected_stringified);
+    ASSERT_ARE_EQUAL(char_ptr, expected_stringified, actual_stringified);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_AMQPVALUE_01_450: [If copying the binary values fails, amqpvalue_clone shall return NULL.]*/
+TEST_FUNCTION(when_copying_the_binary_values_fails_amqpvalue_clone_of_a_value_decoded_in_place_fails)
+{
+    // arrange
+    AMQPVALUE_DECODE_ARENA_HANDLE arena = amqpvalue_decode_arena_create();
+    /* a binary larger than an arena block, so that copying it needs a new block */
+    static unsigned char bytes[5 + 1100] = { 0xB0, 0x00, 0x00, 0x04, 0x4C };
+    AMQP_VALUE value;
+    AMQP_VALUE cloned_value;
+    size_t used_bytes;
+    (void)amqpvalue_decode_in_place(arena, bytes, sizeof(bytes), &value, &used_bytes);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    cloned_value = amqpvalue_clone(value);
+
+    // assert
+    ASSERT_IS_NULL(cloned_value);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    amqpvalue_decode_arena_destroy(arena);
+}
+
+/* Tests_SRS_AMQPVALUE_01_448: [If arena is NULL, amqpvalue_decode_arena_reset shall do nothing.]*/
+TEST_FUNCTION(amqpvalue_decode_arena_reset_with_NULL_arena_does_nothing)
+{
+    // arrange
+
+    // act
+    amqpvalue_decode_arena_reset(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(amqpvalue_ut)
@@ -0,0 +1,513 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Measures frame_codec_receive_bytes on AMQP byte streams recorded from the frame encoders: a link setup
+   and teardown (small performatives), device telemetry (transfers of a few hundred bytes with periodic
+   dispositions and heartbeats) and large messages (transfers of 16KB). Each stream is fed as a whole,
+   in TCP segment sized chunks and in small chunks, to exercise both the whole frame and the split frame paths. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "azure_uamqp_c/frame_codec.h"
+#include "azure_uamqp_c/amqp_frame_codec.h"
+#include "azure_uamqp_c/amqp_definitions.h"
+#include "azure_uamqp_c/amqpvalue.h"
+#include "azure_uamqp_c/messaging.h"
+
+#define PERF_MAX_FRAME_SIZE     65536
+#define PERF_BYTES_PER_RUN      (64 * 1024 * 1024)
+#define TELEMETRY_MESSAGE_COUNT 200
+#define TELEMETRY_PAYLOAD_SIZE  256
+#define LARGE_MESSAGE_COUNT     20
+#define LARGE_PAYLOAD_SIZE      (16 * 1024)
+
+typedef struct STREAM_TAG
+{
+    unsigned char* bytes;
+    size_t length;
+    size_t frame_count;
+    bool failed;
+} STREAM;
+
+static size_t frames_received;
+static size_t frame_bytes_received;
+
+static void on_bytes_encoded(void* context, const unsigned char* bytes, size_t length, bool encode_complete)
+{
+    STREAM* stream = (STREAM*)context;
+    unsigned char* new_bytes = (unsigned char*)realloc(stream->bytes, stream->length + length);
+    (void)encode_complete;
+
+    if (new_bytes == NULL)
+    {
+        stream->failed = true;
+    }
+    else
+    {
+        stream->bytes = new_bytes;
+        (void)memcpy(stream->bytes + stream->length, bytes, length);
+        stream->length += length;
+    }
+}
+
+static void on_amqp_frame_received(void* context, uint16_t channel, AMQP_VALUE performative, const unsigned char* payload_bytes, uint32_t frame_payload_size)
+{
+    (void)context;
+    (void)channel;
+    (void)performative;
+    (void)payload_bytes;
+    (void)frame_payload_size;
+}
+
+static void on_empty_amqp_frame_received(void* context, uint16_t channel)
+{
+    (void)context;
+    (void)channel;
+}
+
+static void on_amqp_frame_codec_error(void* context)
+{
+    (void)context;
+}
+
+static void on_frame_codec_error(void* context)
+{
+    (void)context;
+    (void)printf("frame_codec reported a decode error\n");
+}
+
+static void on_frame_received(void* context, const unsigned char* type_specific, uint32_t type_specific_size, const unsigned char* frame_body, uint32_t frame_body_size)
+{
+    (void)context;
+    (void)type_specific;
+    (void)frame_body;
+    frames_received++;
+    frame_bytes_received += type_specific_size + frame_body_size;
+}
+
+static void record_frame(AMQP_FRAME_CODEC_HANDLE amqp_frame_codec, STREAM* stream, AMQP_VALUE performative, const PAYLOAD* payloads, size_t payload_count)
+{
+    if ((performative == NULL) ||
+        (amqp_frame_codec_encode_frame(amqp_frame_codec, 0, performative, payloads, payload_count, on_bytes_encoded, stream) != 0))
+    {
+        stream->failed = true;
+    }
+    else
+    {
+        stream->frame_count++;
+    }
+
+    if (performative != NULL)
+    {
+        amqpvalue_destroy(performative);
+    }
+}
+
+static void record_heartbeat(AMQP_FRAME_CODEC_HANDLE amqp_frame_codec, STREAM* stream)
+{
+    if (amqp_frame_codec_encode_empty_frame(amqp_frame_codec, 0, on_bytes_encoded, stream) != 0)
+    {
+        stream->failed = true;
+    }
+    else
+    {
+        stream->frame_count++;
+    }
+}
+
+static AMQP_VALUE create_attach(void)
+{
+    AMQP_VALUE result = NULL;
+    ATTACH_HANDLE attach = attach_create("sender-link", 0, role_sender);
+    SOURCE_HANDLE source = source_create();
+    TARGET_HANDLE target = target_create();
+
+    if ((attach != NULL) && (source != NULL) && (target != NULL))
+    {
+        AMQP_VALUE source_address = amqpvalue_create_string("ingress");
+        AMQP_VALUE target_address = amqpvalue_create_string("amqps://contoso.azure-devices.net/devices/device-01/messages/events");
+        AMQP_VALUE source_value;
+        AMQP_VALUE target_value;
+
+        (void)source_set_address(source, source_address);
+        (void)target_set_address(target, target_address);
+        source_value = amqpvalue_create_source(source);
+        target_value = amqpvalue_create_target(target);
+        (void)attach_set_source(attach, source_value);
+        (void)attach_set_target(attach, target_value);
+        (void)attach_set_max_message_size(attach, 262144);
+        result = amqpvalue_create_attach(attach);
+
+        amqpvalue_destroy(source_address);
+        amqpvalue_destroy(target_address);
+        amqpvalue_destroy(source_value);
+        amqpvalue_destroy(target_value);
+    }
+
+    if (attach != NULL)
+    {
+        attach_destroy(attach);
+    }
+    if (source != NULL)
+    {
+        source_destroy(source);
+    }
+    if (target != NULL)
+    {
+        target_destroy(target);
+    }
+
+    return result;
+}
+
+static AMQP_VALUE create_flow(uint32_t link_credit)
+{
+    AMQP_VALUE result = NULL;
+    FLOW_HANDLE flow = flow_create(100, 0, 100);
+    if (flow != NULL)
+    {
+        (void)flow_set_handle(flow, 0);
+        (void)flow_set_link_credit(flow, link_credit);
+        result = amqpvalue_create_flow(flow);
+        flow_destroy(flow);
+    }
+
+    return result;
+}
+
+static AMQP_VALUE create_transfer(uint32_t delivery_id)
+{
+    AMQP_VALUE result = NULL;
+    TRANSFER_HANDLE transfer = transfer_create(0);
+    if (transfer != NULL)
+    {
+        delivery_tag tag;
+        tag.bytes = &delivery_id;
+        tag.length = sizeof(delivery_id);
+        (void)transfer_set_delivery_id(transfer, delivery_id);
+        (void)transfer_set_delivery_tag(transfer, tag);
+        (void)transfer_set_message_format(transfer, 0);
+        (void)transfer_set_settled(transfer, false);
+        result = amqpvalue_create_transfer(transfer);
+        transfer_destroy(transfer);
+    }
+
+    return result;
+}
+
+static AMQP_VALUE create_disposition(uint32_t first, uint32_t last)
+{
+    AMQP_VALUE result = NULL;
+    DISPOSITION_HANDLE disposition = disposition_create(role_receiver, first);
+    if (disposition != NULL)
+    {
+        AMQP_VALUE accepted = messaging_delivery_accepted();
+        (void)disposition_set_last(disposition, last);
+        (void)disposition_set_settled(disposition, true);
+        (void)disposition_set_state(disposition, accepted);
+        result = amqpvalue_create_disposition(disposition);
+        amqpvalue_destroy(accepted);
+        disposition_destroy(disposition);
+    }
+
+    return result;
+}
+
+static int encode_to_buffer(void* context, const unsigned char* bytes, size_t length)
+{
+    STREAM* buffer = (STREAM*)context;
+    (void)memcpy(buffer->bytes + buffer->length, bytes, length);
+    buffer->length += length;
+    return 0;
+}
+
+/* a message as sent by the message sender: a data section holding the payload */
+static int create_message_payload(STREAM* message, size_t payload_size)
+{
+    int result;
+    unsigned char* payload = (unsigned char*)malloc(payload_size);
+    if (payload == NULL)
+    {
+        result = 1;
+    }
+    else
+    {
+        data body;
+        AMQP_VALUE data_section;
+        size_t encoded_size;
+        size_t i;
+
+        for (i = 0; i < payload_size; i++)
+        {
+            payload[i] = (unsigned char)("{\"deviceId\":\"device-01\",\"temperature\":21.5}"[i % 44]);
+        }
+
+        body.bytes = payload;
+        body.length = (uint32_t)payload_size;
+        data_section = amqpvalue_create_data(body);
+        if ((data_section == NULL) ||
+            (amqpvalue_get_encoded_size(data_section, &encoded_size) != 0) ||
+            ((message->bytes = (unsigned char*)malloc(encoded_size)) == NULL))
+        {
+            result = 1;
+        }
+        else
+        {
+            message->length = 0;
+            result = amqpvalue_encode(data_section, encode_to_buffer, message);
+        }
+
+        if (data_section != NULL)
+        {
+            amqpvalue_destroy(data_section);
+        }
+        free(payload);
+    }
+
+    return result;
+}
+
+static void record_transfers(AMQP_FRAME_CODEC_HANDLE amqp_frame_codec, STREAM* stream, size_t message_count, size_t payload_size)
+{
+    STREAM message = { NULL, 0, 0, false };
+
+    if (create_message_payload(&message, payload_size) != 0)
+    {
+        stream->failed = true;
+    }
+    else
+    {
+        PAYLOAD payload;
+        uint32_t i;
+
+        payload.bytes = message.bytes;
+        payload.length = message.length;
+
+        record_frame(amqp_frame_codec, stream, create_attach(), NULL, 0);
+        record_frame(amqp_frame_codec, stream, create_flow((uint32_t)message_count), NULL, 0);
+        for (i = 0; i < message_count; i++)
+        {
+            record_frame(amqp_frame_codec, stream, create_transfer(i), &payload, 1);
+            if ((i % 10) == 9)
+            {
+                record_frame(amqp_frame_codec, stream, create_disposition(i - 9, i), NULL, 0);
+            }
+            if ((i % 50) == 49)
+            {
+                record_heartbeat(amqp_frame_codec, stream);
+            }
+        }
+    }
+
+    free(message.bytes);
+}
+
+static void record_link_setup(AMQP_FRAME_CODEC_HANDLE amqp_frame_codec, STREAM* stream)
+{
+    OPEN_HANDLE open = open_create("device-01-container");
+    BEGIN_HANDLE begin = begin_create(0, 100, 100);
+    DETACH_HANDLE detach = detach_create(0);
+    END_HANDLE end = end_create();
+    CLOSE_HANDLE close = close_create();
+
+    if ((open == NULL) || (begin == NULL) || (detach == NULL) || (end == NULL) || (close == NULL))
+    {
+        stream->failed = true;
+    }
+    else
+    {
+        (void)open_set_hostname(open, "contoso.azure-devices.net");
+        (void)open_set_max_frame_size(open, PERF_MAX_FRAME_SIZE);
+        (void)open_set_channel_max(open, 65535);
+        (void)open_set_idle_time_out(open, 240000);
+        (void)detach_set_closed(detach, true);
+
+        record_frame(amqp_frame_codec, stream, amqpvalue_create_open(open), NULL, 0);
+        record_frame(amqp_frame_codec, stream, amqpvalue_create_begin(begin), NULL, 0);
+        record_frame(amqp_frame_codec, stream, create_attach(), NULL, 0);
+        record_frame(amqp_frame_codec, stream, create_flow(100), NULL, 0);
+        record_heartbeat(amqp_frame_codec, stream);
+        record_frame(amqp_frame_codec, stream, amqpvalue_create_detach(detach), NULL, 0);
+        record_frame(amqp_frame_codec, stream, amqpvalue_create_end(end), NULL, 0);
+        record_frame(amqp_frame_codec, stream, amqpvalue_create_close(close), NULL, 0);
+    }
+
+    if (open != NULL)
+    {
+        open_destroy(open);
+    }
+    if (begin != NULL)
+    {
+        begin_destroy(begin);
+    }
+    if (detach != NULL)
+    {
+        detach_destroy(detach);
+    }
+    if (end != NULL)
+    {
+        end_destroy(end);
+    }
+    if (close != NULL)
+    {
+        close_destroy(close);
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* chunk_size 0 feeds the whole stream in one call */
+static int run_stream(const char* name, const STREAM* stream, size_t chunk_size)
+{
+    int result = 0;
+    size_t iterations = PERF_BYTES_PER_RUN / stream->length;
+    size_t expected_frames = iterations * stream->frame_count;
+    size_t i;
+    double start;
+    double elapsed;
+
+    if (iterations == 0)
+    {
+        iterations = 1;
+        expected_frames = stream->frame_count;
+    }
+
+    frames_received = 0;
+    frame_bytes_received = 0;
+
+    start = now_seconds();
+    for (i = 0; i < iterations; i++)
+    {
+        FRAME_CODEC_HANDLE frame_codec = frame_codec_create(on_frame_codec_error, NULL);
+        if ((frame_codec == NULL) ||
+            (frame_codec_set_max_frame_size(frame_codec, PERF_MAX_FRAME_SIZE) != 0) ||
+            (frame_codec_subscribe(frame_codec, FRAME_TYPE_AMQP, on_frame_received, NULL) != 0))
+        {
+            result = 1;
+        }
+        else
+        {
+            size_t pos = 0;
+            while (pos < stream->length)
+            {
+                size_t to_feed = ((chunk_size == 0) || (stream->length - pos < chunk_size)) ? stream->length - pos : chunk_size;
+                if (frame_codec_receive_bytes(frame_codec, stream->bytes + pos, to_feed) != 0)
+                {
+                    result = 1;
+                    break;
+                }
+                pos += to_feed;
+            }
+        }
+
+        if (frame_codec != NULL)
+        {
+            frame_codec_destroy(frame_codec);
+        }
+
+        if (result != 0)
+        {
+            break;
+        }
+    }
+    elapsed = now_seconds() - start;
+
+    if ((result == 0) && (frames_received != expected_frames))
+    {
+        (void)printf("%s: received %lu frames, expected %lu\n", name, (unsigned long)frames_received, (unsigned long)expected_frames);
+        result = 1;
+    }
+
+    if (result == 0)
+    {
+        char label[64];
+        if (chunk_size == 0)
+        {
+            (void)snprintf(label, sizeof(label), "%s, whole stream", name);
+        }
+        else
+        {
+            (void)snprintf(label, sizeof(label), "%s, %lu byte chunks", name, (unsigned long)chunk_size);
+        }
+        (void)printf("%-40s %10.1f ns/frame %10.1f MB/s\n", label,
+            elapsed * 1e9 / frames_received,
+            (double)(iterations * stream->length) / elapsed / (1024 * 1024));
+    }
+    else
+    {
+        (void)printf("%s failed\n", name);
+    }
+
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+    STREAM link_setup = { NULL, 0, 0, false };
+    STREAM telemetry = { NULL, 0, 0, false };
+    STREAM large_messages = { NULL, 0, 0, false };
+    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(on_frame_codec_error, NULL);
+    AMQP_FRAME_CODEC_HANDLE amqp_frame_codec = (frame_codec == NULL) ? NULL :
+        amqp_frame_codec_create(frame_codec, on_amqp_frame_received, on_empty_amqp_frame_received, on_amqp_frame_codec_error, NULL);
+
+    if ((amqp_frame_codec == NULL) ||
+        (frame_codec_set_max_frame_size(frame_codec, PERF_MAX_FRAME_SIZE) != 0))
+    {
+        (void)printf("failed to create the frame encoders\n");
+        result = 1;
+    }
+    else
+    {
+        record_link_setup(amqp_frame_codec, &link_setup);
+        record_transfers(amqp_frame_codec, &telemetry, TELEMETRY_MESSAGE_COUNT, TELEMETRY_PAYLOAD_SIZE);
+        record_transfers(amqp_frame_codec, &large_messages, LARGE_MESSAGE_COUNT, LARGE_PAYLOAD_SIZE);
+
+        if (link_setup.failed || telemetry.failed || large_messages.failed)
+        {
+            (void)printf("failed to record the AMQP streams\n");
+            result = 1;
+        }
+        else
+        {
+            (void)printf("link setup: %lu frames, %lu bytes; telemetry: %lu frames, %lu bytes; large messages: %lu frames, %lu bytes\n",
+                (unsigned long)link_setup.frame_count, (unsigned long)link_setup.length,
+                (unsigned long)telemetry.frame_count, (unsigned long)telemetry.length,
+                (unsigned long)large_messages.frame_count, (unsigned long)large_messages.length);
+
+            result |= run_stream("link setup", &link_setup, 0);
+            result |= run_stream("link setup", &link_setup, 1460);
+            result |= run_stream("link setup", &link_setup, 64);
+            result |= run_stream("telemetry", &telemetry, 0);
+            result |= run_stream("telemetry", &telemetry, 1460);
+            result |= run_stream("telemetry", &telemetry, 64);
+            result |= run_stream("large messages", &large_messages, 0);
+            result |= run_stream("large messages", &large_messages, 1460);
+            result |= run_stream("large messages", &large_messages, 64);
+        }
+    }
+
+    if (amqp_frame_codec != NULL)
+    {
+        amqp_frame_codec_destroy(amqp_frame_codec);
+    }
+    if (frame_codec != NULL)
+    {
+        frame_codec_destroy(frame_codec);
+    }
+
+    free(link_setup.bytes);
+    free(telemetry.bytes);
+    free(large_messages.bytes);
+
+    return result;
+}
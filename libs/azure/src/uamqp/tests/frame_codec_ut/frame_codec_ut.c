@@ -32,7 +32,6 @@ static void my_gballoc_free(void* ptr)
 #define ENABLE_MOCKS
 
 #include "azure_c_shared_utility/gballoc.h"
-#include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_uamqp_c/amqpvalue.h"
 
 #undef ENABLE_MOCKS
@@ -40,18 +39,9 @@ static void my_gballoc_free(void* ptr)
 #include "azure_uamqp_c/frame_codec.h"
 
 #define TEST_DESCRIPTION_AMQP_VALUE        (AMQP_VALUE)0x4243
-#define TEST_LIST_HANDLE                (SINGLYLINKEDLIST_HANDLE)0x4246
 #define TEST_SUBSCRIPTION_ITEM            (void*)0x4247
 #define TEST_ERROR_CONTEXT                (void*)0x4248
-#define TEST_LIST_ITEM_HANDLE            (LIST_ITEM_HANDLE)0x4249
 
-typedef struct TEST_LIST_ITEM_TAG
-{
-    const void* item_value;
-} TEST_LIST_ITEM;
-
-static TEST_LIST_ITEM** list_items = NULL;
-static size_t list_item_count = 0;
 static unsigned char* sent_io_bytes;
 static size_t sent_io_byte_count;
 static char expected_stringified_io[8192];
@@ -94,73 +84,6 @@ MOCK_FUNCTION_WITH_CODE(, void, test_on_bytes_encoded, void*, context, const uns
     }
 MOCK_FUNCTION_END();
 
-static LIST_ITEM_HANDLE my_singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void* item)
-{
-    TEST_LIST_ITEM** items = (TEST_LIST_ITEM**)my_gballoc_realloc(list_items, (list_item_count + 1) * sizeof(TEST_LIST_ITEM*));
-    LIST_ITEM_HANDLE to_return = NULL;
-    (void)list;
-    if (items != NULL)
-    {
-        list_items = items;
-        list_items[list_item_count] = (TEST_LIST_ITEM*)my_gballoc_malloc(sizeof(TEST_LIST_ITEM));
-        if (list_items[list_item_count] != NULL)
-        {
-            list_items[list_item_count]->item_value = item;
-            to_return = (LIST_ITEM_HANDLE)list_items[list_item_count];
-            list_item_count++;
-        }
-    }
-    return to_return;
-}
-
-static const void* my_singlylinkedlist_item_get_value(LIST_ITEM_HANDLE item_handle)
-{
-    return ((TEST_LIST_ITEM*)item_handle)->item_value;
-}
-
-static LIST_ITEM_HANDLE my_singlylinkedlist_find(SINGLYLINKEDLIST_HANDLE handle, LIST_MATCH_FUNCTION match_function, const void* match_context)
-{
-    size_t i;
-    LIST_ITEM_HANDLE found_item = NULL;
-    (void)handle;
-
-    for (i = 0; i < list_item_count; i++)
-    {
-        if (match_function((LIST_ITEM_HANDLE)list_items[i], match_context))
-        {
-            found_item = (LIST_ITEM_HANDLE)list_items[i];
-            break;
-        }
-    }
-    return found_item;
-}
-
-static int my_singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE list_item)
-{
-    size_t i;
-    (void)list;
-
-    for (i = 0; i < list_item_count; i++)
-    {
-        if (((LIST_ITEM_HANDLE)list_items[i]) == list_item)
-        {
-            break;
-        }
-    }
-    if (i < list_item_count)
-    {
-        my_gballoc_free(list_items[i]);
-        memmove(&list_items[i], &list_items[i + 1], (list_item_count - i - 1) * sizeof(TEST_LIST_ITEM*));
-        list_item_count--;
-        if (list_item_count == 0)
-        {
-            my_gballoc_free(list_items);
-            list_items = NULL;
-        }
-    }
-    return 0;
-}
-
 static TEST_MUTEX_HANDLE g_testByTest;
 
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
@@ -191,15 +114,6 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
-    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_create, TEST_LIST_HANDLE);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, my_singlylinkedlist_add);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_item_get_value, my_singlylinkedlist_item_get_value);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_find, my_singlylinkedlist_find);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_remove, my_singlylinkedlist_remove);
-
-    REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_MATCH_FUNCTION, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -221,20 +135,11 @@ TEST_FUNCTION_INITIALIZE(method_init)
 
 TEST_FUNCTION_CLEANUP(method_cleanup)
 {
-    size_t i;
     if (sent_io_bytes != NULL)
     {
         free(sent_io_bytes);
         sent_io_bytes = NULL;
     }
-    for (i = 0; i < list_item_count; i++)
-    {
-        free(list_items[i]);
-    }
-    free(list_items);
-    list_items = NULL;
-    list_item_count = 0;
-
     sent_io_byte_count = 0;
 
     TEST_MUTEX_RELEASE(g_testByTest);
@@ -248,7 +153,6 @@ TEST_FUNCTION(frame_codec_create_with_valid_args_succeeds)
     // arrange
     FRAME_CODEC_HANDLE frame_codec;
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_create());
 
     // act
     frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
@@ -280,7 +184,6 @@ TEST_FUNCTION(frame_codec_create_with_NULL_frame_codec_decode_error_calback_cont
     // arrange
     FRAME_CODEC_HANDLE frame_codec;
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_create());
 
     // act
     frame_codec = frame_codec_create(test_frame_codec_decode_error, NULL);
@@ -404,15 +307,9 @@ TEST_FUNCTION(receiving_a_frame_with_exactly_512_bytes_of_total_frame_size_immed
     umock_c_reset_all_calls();
     (void)memset(frame + 6, 0, 506);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 504))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[8], 504);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -435,7 +332,26 @@ TEST_FUNCTION(frame_codec_destroy_frees_the_memory_for_frame_codec)
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_LIST_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    frame_codec_destroy(frame_codec);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_FRAME_CODEC_01_023: [frame_codec_destroy shall free all resources associated with a frame_codec instance.] */
+TEST_FUNCTION(frame_codec_destroy_frees_the_existing_subscriptions)
+{
+    // arrange
+    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
+    (void)frame_codec_subscribe(frame_codec, FRAME_TYPE_AMQP, on_frame_received_1, frame_codec);
+    (void)frame_codec_subscribe(frame_codec, FRAME_TYPE_SASL, on_frame_received_2, frame_codec);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
@@ -468,7 +384,6 @@ TEST_FUNCTION(frame_codec_destroy_while_receiving_type_specific_data_frees_the_t
     (void)frame_codec_unsubscribe(frame_codec, 0);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_LIST_HANDLE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
@@ -588,15 +503,9 @@ TEST_FUNCTION(receiving_a_frame_with_exactly_max_frame_size_bytes_of_total_frame
     umock_c_reset_all_calls();
     (void)memset(frame + 6, 0, 1016);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 1016))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[8], 1016);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -773,14 +682,8 @@ TEST_FUNCTION(frame_codec_receive_bytes_decodes_one_empty_frame)
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -805,10 +708,6 @@ TEST_FUNCTION(frame_codec_receive_bytes_with_not_enough_bytes_for_a_frame_does_n
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
     // act
@@ -892,14 +791,9 @@ TEST_FUNCTION(when_frame_codec_receive_1_byte_in_one_call_and_the_rest_of_the_fr
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     (void)frame_codec_receive_bytes(frame_codec, frame, 1);
 
@@ -926,14 +820,9 @@ TEST_FUNCTION(when_frame_codec_receive_the_frame_bytes_in_1_byte_per_call_a_succ
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     for (i = 0; i < sizeof(frame) - 1; i++)
     {
@@ -962,14 +851,8 @@ TEST_FUNCTION(a_frame_codec_receive_bytes_call_with_bad_args_before_any_real_fra
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     (void)frame_codec_receive_bytes(frame_codec, NULL, 1);
 
@@ -995,14 +878,9 @@ TEST_FUNCTION(a_frame_codec_receive_bytes_call_with_bad_args_in_the_middle_of_th
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     (void)frame_codec_receive_bytes(frame_codec, frame, 1);
     (void)frame_codec_receive_bytes(frame_codec, NULL, 1);
@@ -1030,22 +908,10 @@ TEST_FUNCTION(frame_codec_receive_bytes_decodes_2_empty_frames)
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame1[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame1[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame2[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame2[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     (void)frame_codec_receive_bytes(frame_codec, frame1, sizeof(frame1));
 
@@ -1072,22 +938,10 @@ TEST_FUNCTION(a_call_to_frame_codec_receive_bytes_with_bad_args_between_2_frames
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame1[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame1[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame2[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame2[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     (void)frame_codec_receive_bytes(frame_codec, frame1, sizeof(frame1));
     (void)frame_codec_receive_bytes(frame_codec, NULL, 1);
@@ -1104,33 +958,6 @@ TEST_FUNCTION(a_call_to_frame_codec_receive_bytes_with_bad_args_between_2_frames
     frame_codec_destroy(frame_codec);
 }
 
-/* Tests_SRS_FRAME_CODEC_01_025: [frame_codec_receive_bytes decodes a sequence of bytes into frames and on success it shall return zero.] */
-TEST_FUNCTION(when_getting_the_list_item_value_fails_no_callback_is_invoked)
-{
-    // arrange
-    int result;
-    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    unsigned char frame[] = { 0x00, 0x00, 0x00, 0x08, 0x02, 0x00, 0x01, 0x02 };
-    (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
-    umock_c_reset_all_calls();
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG))
-        .SetReturn(NULL);
-
-    // act
-    result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
-
-    // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    // cleanup
-    (void)frame_codec_unsubscribe(frame_codec, 0);
-    frame_codec_destroy(frame_codec);
-}
-
 /* Tests_SRS_FRAME_CODEC_01_010: [The frame is malformed if the size is less than the size of the frame header (8 bytes).] */
 /* Tests_SRS_FRAME_CODEC_01_103: [Upon any decode error, if an error callback has been passed to frame_codec_create, then the error callback shall be called with the context argument being the frame_codec_error_callback_context argument passed to frame_codec_create.] */
 TEST_FUNCTION(when_frame_size_is_bad_frame_codec_receive_bytes_fails)
@@ -1234,7 +1061,7 @@ TEST_FUNCTION(after_a_frame_decode_error_occurs_due_to_bad_doff_size_a_subsequen
 /* Tests_SRS_FRAME_CODEC_01_025: [frame_codec_receive_bytes decodes a sequence of bytes into frames and on success it shall return zero.] */
 /* Tests_SRS_FRAME_CODEC_01_031: [When a complete frame is successfully decoded it shall be indicated to the upper layer by invoking the on_frame_received passed to frame_codec_subscribe.] */
 /* Tests_SRS_FRAME_CODEC_01_099: [A pointer to the frame_body bytes shall also be passed to the on_frame_received.] */
-/* Tests_SRS_FRAME_CODEC_01_102: [frame_codec_receive_bytes shall allocate memory to hold the frame_body bytes.] */
+/* Tests_SRS_FRAME_CODEC_01_113: [ When a complete and valid frame is contained in the bytes passed to frame_codec_receive_bytes, the frame shall be indicated to the subscriber directly from those bytes, without copying it. ]*/
 TEST_FUNCTION(receiving_a_frame_with_1_byte_frame_body_succeeds)
 {
     // arrange
@@ -1244,15 +1071,9 @@ TEST_FUNCTION(receiving_a_frame_with_1_byte_frame_body_succeeds)
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[8], 1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1277,17 +1098,13 @@ TEST_FUNCTION(when_allocating_type_specific_data_fails_frame_codec_receive_bytes
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
         .SetReturn(NULL);
 
     STRICT_EXPECTED_CALL(test_frame_codec_decode_error(TEST_ERROR_CONTEXT));
 
     // act
-    result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
+    result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame) - 1);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
@@ -1312,7 +1129,7 @@ TEST_FUNCTION(when_allocating_type_specific_data_fails_a_subsequent_decode_Call_
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
         .SetReturn(NULL);
 
-    (void)frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
+    (void)frame_codec_receive_bytes(frame_codec, frame, sizeof(frame) - 1);
     umock_c_reset_all_calls();
 
     // act
@@ -1337,15 +1154,9 @@ TEST_FUNCTION(a_frame_with_2_bytes_received_together_with_the_header_passes_the_
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 2))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[sizeof(frame) - 2], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1370,22 +1181,10 @@ TEST_FUNCTION(two_empty_frames_received_in_the_same_call_yields_2_callbacks)
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[6], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
         .ValidateArgumentBuffer(2, &frame[14], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1410,24 +1209,12 @@ TEST_FUNCTION(two_frames_with_1_byte_each_received_in_the_same_call_yields_2_cal
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[8], 1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(2, &frame[15], 2)
         .ValidateArgumentBuffer(4, &frame[17], 1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1441,25 +1228,65 @@ TEST_FUNCTION(two_frames_with_1_byte_each_received_in_the_same_call_yields_2_cal
     frame_codec_destroy(frame_codec);
 }
 
-/* frame_codec_subscribe */
+/* Tests_SRS_FRAME_CODEC_01_029: [The sequence of bytes does not have to be a complete frame, frame_codec shall be responsible for maintaining decoding state between frame_codec_receive_bytes calls.] */
+/* Tests_SRS_FRAME_CODEC_01_102: [frame_codec_receive_bytes shall allocate memory to hold the frame_body bytes.] */
+/* Tests_SRS_FRAME_CODEC_01_114: [ The memory holding the frame bytes shall be kept and reused for the following frames, and shall only be reallocated when a frame does not fit in it. ]*/
+TEST_FUNCTION(frames_split_across_calls_reuse_the_memory_allocated_for_the_first_frame)
+{
+    // arrange
+    int result;
+    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
+    unsigned char frame1[] = { 0x00, 0x00, 0x00, 0x09, 0x02, 0x00, 0x01, 0x02, 0x42 };
+    unsigned char frame2[] = { 0x00, 0x00, 0x00, 0x08, 0x02, 0x00, 0x03, 0x04 };
+    (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
+    umock_c_reset_all_calls();
 
-/* Tests_SRS_FRAME_CODEC_01_033: [frame_codec_subscribe subscribes for a certain type of frame received by the frame_codec instance identified by frame_codec.] */
-/* Tests_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
-TEST_FUNCTION(frame_codec_subscribe_with_valid_args_succeeds)
+    STRICT_EXPECTED_CALL(gballoc_malloc(9 - 6));
+    STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(2, &frame1[6], 2)
+        .ValidateArgumentBuffer(4, &frame1[8], 1);
+    STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 0))
+        .ValidateArgumentBuffer(2, &frame2[6], 2);
+
+    (void)frame_codec_receive_bytes(frame_codec, frame1, 4);
+    (void)frame_codec_receive_bytes(frame_codec, frame1 + 4, sizeof(frame1) - 4);
+    (void)frame_codec_receive_bytes(frame_codec, frame2, 5);
+
+    // act
+    result = frame_codec_receive_bytes(frame_codec, frame2 + 5, sizeof(frame2) - 5);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    (void)frame_codec_unsubscribe(frame_codec, 0);
+    frame_codec_destroy(frame_codec);
+}
+
+/* Tests_SRS_FRAME_CODEC_01_114: [ The memory holding the frame bytes shall be kept and reused for the following frames, and shall only be reallocated when a frame does not fit in it. ]*/
+TEST_FUNCTION(a_split_frame_bigger_than_the_previous_ones_reallocates_the_frame_memory)
 {
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
+    unsigned char frame1[] = { 0x00, 0x00, 0x00, 0x08, 0x02, 0x00, 0x01, 0x02 };
+    unsigned char frame2[] = { 0x00, 0x00, 0x00, 0x0A, 0x02, 0x00, 0x03, 0x04, 0x42, 0x43 };
+    (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
+    (void)frame_codec_receive_bytes(frame_codec, frame1, 6);
+    (void)frame_codec_receive_bytes(frame_codec, frame1 + 6, sizeof(frame1) - 6);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(10 - 6));
+    STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 2))
+        .ValidateArgumentBuffer(2, &frame2[6], 2)
+        .ValidateArgumentBuffer(4, &frame2[8], 2);
+
+    (void)frame_codec_receive_bytes(frame_codec, frame2, 7);
 
     // act
-    result = frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
+    result = frame_codec_receive_bytes(frame_codec, frame2 + 7, sizeof(frame2) - 7);
 
     // assert
     ASSERT_ARE_EQUAL(int, 0, result);
@@ -1470,24 +1297,25 @@ TEST_FUNCTION(frame_codec_subscribe_with_valid_args_succeeds)
     frame_codec_destroy(frame_codec);
 }
 
-/* Tests_SRS_FRAME_CODEC_01_033: [frame_codec_subscribe subscribes for a certain type of frame received by the frame_codec instance identified by frame_codec.] */
-/* Tests_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
-TEST_FUNCTION(when_list_find_returns_NULL_a_new_subscription_is_created)
+/* Tests_SRS_FRAME_CODEC_01_031: [When a complete frame is successfully decoded it shall be indicated to the upper layer by invoking the on_frame_received passed to frame_codec_subscribe.] */
+/* Tests_SRS_FRAME_CODEC_01_100: [If the frame body size is 0, the frame_body pointer passed to on_frame_received shall be NULL.] */
+TEST_FUNCTION(a_split_frame_with_an_extended_header_and_no_body_is_indicated_when_its_last_byte_is_received)
 {
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
+    unsigned char frame[] = { 0x00, 0x00, 0x00, 0x0C, 0x03, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+    (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1)
-        .SetReturn(NULL);
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 6, NULL, 0))
+        .ValidateArgumentBuffer(2, &frame[6], 6);
+
+    (void)frame_codec_receive_bytes(frame_codec, frame, sizeof(frame) - 1);
 
     // act
-    result = frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
+    result = frame_codec_receive_bytes(frame_codec, &frame[sizeof(frame) - 1], 1);
 
     // assert
     ASSERT_ARE_EQUAL(int, 0, result);
@@ -1498,24 +1326,21 @@ TEST_FUNCTION(when_list_find_returns_NULL_a_new_subscription_is_created)
     frame_codec_destroy(frame_codec);
 }
 
-/* Tests_SRS_FRAME_CODEC_01_037: [If any failure occurs while performing the subscribe operation, frame_codec_subscribe shall return a non-zero value.] */
-TEST_FUNCTION(when_list_item_get_value_returns_NULL_subscribe_fails)
+/* Tests_SRS_FRAME_CODEC_01_112: [ The frame is malformed if the data offset points past the end of the frame. ]*/
+/* Tests_SRS_FRAME_CODEC_01_103: [Upon any decode error, if an error callback has been passed to frame_codec_create, then the error callback shall be called with the context argument being the frame_codec_error_callback_context argument passed to frame_codec_create.] */
+TEST_FUNCTION(when_the_doff_points_past_the_end_of_the_frame_frame_codec_receive_bytes_fails)
 {
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
+    unsigned char frame[] = { 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x01, 0x02 };
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG))
-        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_frame_codec_decode_error(TEST_ERROR_CONTEXT));
 
     // act
-    result = frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
+    result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
@@ -1526,6 +1351,31 @@ TEST_FUNCTION(when_list_item_get_value_returns_NULL_subscribe_fails)
     frame_codec_destroy(frame_codec);
 }
 
+/* frame_codec_subscribe */
+
+/* Tests_SRS_FRAME_CODEC_01_033: [frame_codec_subscribe subscribes for a certain type of frame received by the frame_codec instance identified by frame_codec.] */
+/* Tests_SRS_FRAME_CODEC_01_087: [On success, frame_codec_subscribe shall return zero.] */
+TEST_FUNCTION(frame_codec_subscribe_with_valid_args_succeeds)
+{
+    // arrange
+    int result;
+    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    (void)frame_codec_unsubscribe(frame_codec, 0);
+    frame_codec_destroy(frame_codec);
+}
+
 /* Tests_SRS_FRAME_CODEC_01_034: [If any of the frame_codec or on_frame_received arguments is NULL, frame_codec_subscribe shall return a non-zero value.] */
 TEST_FUNCTION(when_frame_codec_is_NULL_frame_codec_subscribe_fails)
 {
@@ -1567,9 +1417,6 @@ TEST_FUNCTION(when_a_frame_type_that_has_no_subscribers_is_received_no_callback_
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1592,8 +1439,6 @@ TEST_FUNCTION(when_no_subscribe_is_done_no_callback_is_called)
     unsigned char frame[] = { 0x00, 0x00, 0x00, 0x08, 0x02, 0x01, 0x00, 0x00 };
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1617,15 +1462,9 @@ TEST_FUNCTION(when_2_subscriptions_exist_and_first_one_matches_the_callback_is_i
     (void)frame_codec_subscribe(frame_codec, 1, on_frame_received_2, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_1(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 2))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[sizeof(frame) - 2], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1651,16 +1490,9 @@ TEST_FUNCTION(when_2_subscriptions_exist_and_second_one_matches_the_callback_is_
     (void)frame_codec_subscribe(frame_codec, 1, on_frame_received_2, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_2(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 2))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[sizeof(frame) - 2], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1681,14 +1513,9 @@ TEST_FUNCTION(when_frame_codec_subscribe_is_called_twice_for_the_same_frame_type
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_subscribe(frame_codec, 0, on_frame_received_2, frame_codec);
@@ -1713,15 +1540,9 @@ TEST_FUNCTION(the_callbacks_for_the_2nd_frame_codec_subscribe_for_the_same_frame
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_2, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(on_frame_received_2(frame_codec, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, 2))
         .ValidateArgumentBuffer(2, &frame[6], 2)
         .ValidateArgumentBuffer(4, &frame[sizeof(frame) - 2], 2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1741,11 +1562,8 @@ TEST_FUNCTION(when_allocating_memory_for_the_subscription_fails_frame_codec_subs
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
         .SetReturn(NULL);
 
@@ -1760,33 +1578,6 @@ TEST_FUNCTION(when_allocating_memory_for_the_subscription_fails_frame_codec_subs
     frame_codec_destroy(frame_codec);
 }
 
-/* Tests_SRS_FRAME_CODEC_01_037: [If any failure occurs while performing the subscribe operation, frame_codec_subscribe shall return a non-zero value.] */
-TEST_FUNCTION(when_adding_the_subscription_fails_then_frame_codec_subscribe_fails)
-{
-    // arrange
-    int result;
-    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
-    umock_c_reset_all_calls();
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_LIST_HANDLE, IGNORED_PTR_ARG))
-        .SetReturn(NULL);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
-    // act
-    result = frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
-
-    // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    // cleanup
-    frame_codec_destroy(frame_codec);
-}
-
 /* frame_codec_unsubscribe */
 
 /* Tests_SRS_FRAME_CODEC_01_038: [frame_codec_unsubscribe removes a previous subscription for frames of type type and on success it shall return 0.] */
@@ -1795,16 +1586,10 @@ TEST_FUNCTION(removing_an_existing_subscription_succeeds)
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_unsubscribe(frame_codec, 0);
@@ -1828,8 +1613,6 @@ TEST_FUNCTION(removing_an_existing_subscription_does_not_trigger_callback_when_a
     (void)frame_codec_unsubscribe(frame_codec, 0);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame[5], 1);
 
     // act
     result = frame_codec_receive_bytes(frame_codec, frame, sizeof(frame));
@@ -1861,35 +1644,8 @@ TEST_FUNCTION(frame_codec_unsubscribe_with_no_subscribe_call_has_been_made_fails
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-
-    // act
-    result = frame_codec_unsubscribe(frame_codec, 0);
-
-    // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    // cleanup
-    frame_codec_destroy(frame_codec);
-}
-
-/* Tests_SRS_FRAME_CODEC_01_041: [If any failure occurs while performing the unsubscribe operation, frame_codec_unsubscribe shall return a non-zero value.] */
-TEST_FUNCTION(when_list_remove_matching_item_fails_then_frame_codec_unsubscribe_fails)
-{
-    // arrange
-    int result;
-    FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
-    umock_c_reset_all_calls();
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1)
-        .SetReturn(NULL);
 
     // act
     result = frame_codec_unsubscribe(frame_codec, 0);
@@ -1908,17 +1664,11 @@ TEST_FUNCTION(unsubscribe_one_of_2_subscriptions_succeeds)
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     (void)frame_codec_subscribe(frame_codec, 1, on_frame_received_2, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_unsubscribe(frame_codec, 0);
@@ -1938,18 +1688,11 @@ TEST_FUNCTION(unsubscribe_2nd_out_of_2_subscriptions_succeeds)
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 1;
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     (void)frame_codec_subscribe(frame_codec, 1, on_frame_received_2, frame_codec);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_unsubscribe(frame_codec, 1);
@@ -1969,15 +1712,11 @@ TEST_FUNCTION(subscribe_unsubscribe_subscribe_succeeds)
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     (void)frame_codec_unsubscribe(frame_codec, 0);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
 
     // act
     result = frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
@@ -1997,13 +1736,10 @@ TEST_FUNCTION(subscribe_unsubscribe_unsubscribe_fails)
     // arrange
     int result;
     FRAME_CODEC_HANDLE frame_codec = frame_codec_create(test_frame_codec_decode_error, TEST_ERROR_CONTEXT);
-    uint8_t frame_type = 0;
     (void)frame_codec_subscribe(frame_codec, 0, on_frame_received_1, frame_codec);
     (void)frame_codec_unsubscribe(frame_codec, 0);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(3, &frame_type, 1);
 
     // act
     result = frame_codec_unsubscribe(frame_codec, 0);
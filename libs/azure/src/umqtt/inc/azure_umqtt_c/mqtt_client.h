@@ -5,6 +5,7 @@
 #define MQTT_CLIENT_H
 
 #include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_umqtt_c/mqttconst.h"
 #include "azure_umqtt_c/mqtt_message.h"
@@ -48,6 +49,29 @@ typedef void(*ON_MQTT_ERROR_CALLBACK)(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EVE
 typedef void(*ON_MQTT_MESSAGE_RECV_CALLBACK)(MQTT_MESSAGE_HANDLE msgHandle, void* callbackCtx);
 typedef void(*ON_MQTT_DISCONNECTED_CALLBACK)(void* callbackCtx);
 
+/* Idle mode, for links where every radio wake-up costs power (GPRS). The client sends a PINGREQ after pingInterval
+   seconds without traffic instead of waiting for keepAliveInterval, starting at minPingIntervalSec and growing by
+   pingIntervalStepSec each time a probe is answered, up to keepAliveInterval. A packet sent after such a silence is a
+   probe as well, so outbound data stands in for the PINGREQ. When a probe is not answered the interval goes back to
+   the last one that worked and stops growing. Traffic after more than radioTailMs of silence is one radio wake-up. */
+typedef struct MQTT_CLIENT_IDLE_OPTIONS_TAG
+{
+    uint16_t minPingIntervalSec;
+    uint16_t pingIntervalStepSec;
+    uint32_t radioTailMs;
+} MQTT_CLIENT_IDLE_OPTIONS;
+
+typedef struct MQTT_CLIENT_RADIO_STATISTICS_TAG
+{
+    uint32_t radioWakeUps;
+    uint32_t pingsSent;
+    uint16_t pingIntervalSec;
+    bool pingIntervalSettled;
+    bool radioAwake;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+} MQTT_CLIENT_RADIO_STATISTICS;
+
 MOCKABLE_FUNCTION(, MQTT_CLIENT_HANDLE, mqtt_client_init, ON_MQTT_MESSAGE_RECV_CALLBACK, msgRecv, ON_MQTT_OPERATION_CALLBACK, opCallback, void*, opCallbackCtx, ON_MQTT_ERROR_CALLBACK, onErrorCallBack, void*, errorCBCtx);
 MOCKABLE_FUNCTION(, void, mqtt_client_deinit, MQTT_CLIENT_HANDLE, handle);
 
@@ -59,8 +83,30 @@ MOCKABLE_FUNCTION(, int, mqtt_client_unsubscribe, MQTT_CLIENT_HANDLE, handle, ui
 
 MOCKABLE_FUNCTION(, int, mqtt_client_publish, MQTT_CLIENT_HANDLE, handle, MQTT_MESSAGE_HANDLE, msgHandle);
 
+/* Publishing through a template only encodes the topic suffix and packet id, and sends the header and the payload
+   in one gather send. The payload is not copied by the client. */
+MOCKABLE_FUNCTION(, MQTT_PUBLISH_TEMPLATE_HANDLE, mqtt_client_create_publish_template, QOS_VALUE, qosValue, const char*, topicPrefix);
+MOCKABLE_FUNCTION(, void, mqtt_client_destroy_publish_template, MQTT_PUBLISH_TEMPLATE_HANDLE, publishTemplate);
+MOCKABLE_FUNCTION(, int, mqtt_client_publish_with_template, MQTT_CLIENT_HANDLE, handle, MQTT_PUBLISH_TEMPLATE_HANDLE, publishTemplate, uint16_t, packetId, const char*, topicSuffix, const uint8_t*, payload, size_t, payloadLength);
+/* Sends a PUBLISH again with the DUP flag set, for a QOS 1 message that was not acknowledged; packetId has to be the
+   one of the first attempt. */
+MOCKABLE_FUNCTION(, int, mqtt_client_republish_with_template, MQTT_CLIENT_HANDLE, handle, MQTT_PUBLISH_TEMPLATE_HANDLE, publishTemplate, uint16_t, packetId, const char*, topicSuffix, const uint8_t*, payload, size_t, payloadLength);
+
 MOCKABLE_FUNCTION(, void, mqtt_client_dowork, MQTT_CLIENT_HANDLE, handle);
 
+/* Bytes of MQTT packets sent to and received from the IO since mqtt_client_init; TLS or WebSocket framing is not included. */
+MOCKABLE_FUNCTION(, int, mqtt_client_get_traffic, MQTT_CLIENT_HANDLE, handle, uint64_t*, bytesSent, uint64_t*, bytesReceived);
+
+/* Lowers msToNextWork to the milliseconds left until mqtt_client_dowork has keep-alive work to do (a PINGREQ to send
+   or a PINGRESP that is overdue); msToNextWork is left as is when there is no such work. */
+MOCKABLE_FUNCTION(, int, mqtt_client_get_next_work_time, MQTT_CLIENT_HANDLE, handle, tickcounter_ms_t*, msToNextWork);
+
+/* Turns the idle mode on, or off when idleOptions is NULL. The learned ping interval is kept across reconnects. */
+MOCKABLE_FUNCTION(, int, mqtt_client_set_idle_options, MQTT_CLIENT_HANDLE, handle, const MQTT_CLIENT_IDLE_OPTIONS*, idleOptions);
+
+/* Radio wake-ups are only counted in idle mode; radioAwake tells whether the last traffic is less than radioTailMs old. */
+MOCKABLE_FUNCTION(, int, mqtt_client_get_radio_statistics, MQTT_CLIENT_HANDLE, handle, MQTT_CLIENT_RADIO_STATISTICS*, statistics);
+
 MOCKABLE_FUNCTION(, void, mqtt_client_set_trace, MQTT_CLIENT_HANDLE, handle, bool, traceOn, bool, rawBytesOn);
 
 #ifdef __cplusplus
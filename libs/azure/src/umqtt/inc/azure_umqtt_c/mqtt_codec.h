@@ -38,6 +38,12 @@ MOCKABLE_FUNCTION(, BUFFER_HANDLE, mqtt_codec_ping);
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, mqtt_codec_subscribe, uint16_t, packetId, SUBSCRIBE_PAYLOAD*, subscribeList, size_t, count, STRING_HANDLE, trace_log);
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, mqtt_codec_unsubscribe, uint16_t, packetId, const char**, unsubscribeList, size_t, count, STRING_HANDLE, trace_log);
 
+/* The fixed header, topic length, topic prefix and packet id of a PUBLISH packet are kept in one buffer; building a packet
+   only writes the topic suffix, packet id and lengths, and returns the header bytes to be sent ahead of the payload. */
+MOCKABLE_FUNCTION(, MQTT_PUBLISH_TEMPLATE_HANDLE, mqtt_codec_publish_template_create, QOS_VALUE, qosValue, bool, serverRetain, const char*, topicPrefix);
+MOCKABLE_FUNCTION(, void, mqtt_codec_publish_template_destroy, MQTT_PUBLISH_TEMPLATE_HANDLE, publishTemplate);
+MOCKABLE_FUNCTION(, int, mqtt_codec_publish_template_build, MQTT_PUBLISH_TEMPLATE_HANDLE, publishTemplate, bool, duplicateMsg, uint16_t, packetId, const char*, topicSuffix, size_t, payloadLen, BUFFER_SEGMENT*, header, STRING_HANDLE, trace_log);
+
 MOCKABLE_FUNCTION(, int, mqtt_codec_bytesReceived, MQTTCODEC_HANDLE, handle, const unsigned char*, buffer, size_t, size);
 
 #ifdef __cplusplus
@@ -43,6 +43,9 @@ DEFINE_ENUM(CONTROL_PACKET_TYPE, CONTROL_PACKET_TYPE_VALUES)
 
 DEFINE_ENUM(QOS_VALUE, QOS_VALUE_VALUES)
 
+/* A PUBLISH packet prepared once for one topic prefix and QOS; see mqtt_codec_publish_template_create. */
+typedef struct MQTT_PUBLISH_TEMPLATE_TAG* MQTT_PUBLISH_TEMPLATE_HANDLE;
+
 typedef struct APP_PAYLOAD_TAG
 {
     uint8_t* message;
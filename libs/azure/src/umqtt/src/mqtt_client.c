@@ -55,8 +55,87 @@ typedef struct MQTT_CLIENT_TAG
     bool rawBytesTrace;
     tickcounter_ms_t timeSincePing;
     uint16_t maxPingRespTime;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    uint32_t pingsSent;
+    bool idleMode;
+    MQTT_CLIENT_IDLE_OPTIONS idleOptions;
+    uint16_t pingIntervalSec;
+    uint16_t lastGoodPingIntervalSec;
+    bool pingIntervalSettled;
+    bool probePending;
+    bool activitySeen;
+    tickcounter_ms_t lastActivityMs;
+    uint32_t radioWakeUps;
 } MQTT_CLIENT;
 
+static uint16_t get_ping_interval(MQTT_CLIENT* mqtt_client)
+{
+    return (mqtt_client->idleMode && mqtt_client->pingIntervalSec < mqtt_client->keepAliveInterval) ? mqtt_client->pingIntervalSec : mqtt_client->keepAliveInterval;
+}
+
+static void on_radio_activity(MQTT_CLIENT* mqtt_client, tickcounter_ms_t current_ms)
+{
+    if (!mqtt_client->activitySeen || (current_ms - mqtt_client->lastActivityMs) > mqtt_client->idleOptions.radioTailMs)
+    {
+        mqtt_client->radioWakeUps++;
+    }
+    mqtt_client->activitySeen = true;
+    mqtt_client->lastActivityMs = current_ms;
+}
+
+static void track_outgoing_packet(MQTT_CLIENT* mqtt_client)
+{
+    if (mqtt_client->idleMode)
+    {
+        /* Codes_SRS_MQTT_CLIENT_01_020: [ In idle mode a packet sent after at least the ping interval without traffic shall be a probe, unless the interval is settled or has reached keepAliveInterval. ] */
+        if (mqtt_client->activitySeen && !mqtt_client->pingIntervalSettled && mqtt_client->pingIntervalSec < mqtt_client->keepAliveInterval &&
+            (mqtt_client->packetSendTimeMs - mqtt_client->lastActivityMs) >= (tickcounter_ms_t)mqtt_client->pingIntervalSec * 1000)
+        {
+            mqtt_client->probePending = true;
+        }
+        on_radio_activity(mqtt_client, mqtt_client->packetSendTimeMs);
+    }
+}
+
+static void track_incoming_bytes(MQTT_CLIENT* mqtt_client)
+{
+    tickcounter_ms_t current_ms;
+    if (mqtt_client->idleMode && tickcounter_get_current_ms(mqtt_client->packetTickCntr, &current_ms) == 0)
+    {
+        /* Codes_SRS_MQTT_CLIENT_01_021: [ When bytes are received while a probe is pending, the ping interval shall grow by pingIntervalStepSec, up to keepAliveInterval. ] */
+        if (mqtt_client->probePending)
+        {
+            uint32_t nextInterval = (uint32_t)mqtt_client->pingIntervalSec + mqtt_client->idleOptions.pingIntervalStepSec;
+            mqtt_client->lastGoodPingIntervalSec = mqtt_client->pingIntervalSec;
+            mqtt_client->pingIntervalSec = (nextInterval < mqtt_client->keepAliveInterval) ? (uint16_t)nextInterval : mqtt_client->keepAliveInterval;
+            mqtt_client->probePending = false;
+        }
+        on_radio_activity(mqtt_client, current_ms);
+    }
+}
+
+static void track_lost_connection(MQTT_CLIENT* mqtt_client)
+{
+    if (mqtt_client->idleMode)
+    {
+        if (mqtt_client->probePending)
+        {
+            // The NAT dropped the connection during the probe, so the last interval that worked is the one to keep
+            mqtt_client->pingIntervalSec = (mqtt_client->lastGoodPingIntervalSec != 0) ? mqtt_client->lastGoodPingIntervalSec : mqtt_client->idleOptions.minPingIntervalSec;
+            mqtt_client->pingIntervalSettled = true;
+        }
+        else if (mqtt_client->pingIntervalSettled)
+        {
+            // An interval that used to work failed, the network changed: learn it again
+            mqtt_client->pingIntervalSec = mqtt_client->idleOptions.minPingIntervalSec;
+            mqtt_client->lastGoodPingIntervalSec = 0;
+            mqtt_client->pingIntervalSettled = false;
+        }
+        mqtt_client->probePending = false;
+    }
+}
+
 static void on_connection_closed(void* context)
 {
     MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)context;
@@ -135,6 +214,8 @@ static uint16_t byteutil_read_uint16(uint8_t** buffer, size_t byteLen)
     return result;
 }
 
+/* Returns the string as a view into buffer: the string is moved over its 2 byte length and null terminated,
+   so it needs no allocation and the bytes that follow it are left untouched. */
 static char* byteutil_readUTF(uint8_t** buffer, size_t* byteLen)
 {
     char* result = NULL;
@@ -146,14 +227,11 @@ static char* byteutil_readUTF(uint8_t** buffer, size_t* byteLen)
     // not being asked to read a string longer than buffer passed in.
     if ((stringLen > 0) && ((size_t)(stringLen + (*buffer - bufferInitial)) <= *byteLen))
     {
-        result = (char*)malloc(stringLen + 1);
-        if (result != NULL)
-        {
-            (void)memcpy(result, *buffer, stringLen);
-            result[stringLen] = '\0';
-            *buffer += stringLen;
-            *byteLen = stringLen;
-         }
+        result = (char*)(*buffer - 2);
+        (void)memmove(result, *buffer, stringLen);
+        result[stringLen] = '\0';
+        *buffer += stringLen;
+        *byteLen = stringLen;
     }
     else
     {
@@ -373,6 +451,8 @@ static int sendPacketItem(MQTT_CLIENT* mqtt_client, const unsigned char* data, s
         }
         else
         {
+            mqtt_client->bytesSent += length;
+            track_outgoing_packet(mqtt_client);
 #ifdef ENABLE_RAW_TRACE
             logOutgoingRawTrace(mqtt_client, (const uint8_t*)data, length);
 #endif
@@ -381,6 +461,45 @@ static int sendPacketItem(MQTT_CLIENT* mqtt_client, const unsigned char* data, s
     return result;
 }
 
+static int sendPacketSegments(MQTT_CLIENT* mqtt_client, const BUFFER_SEGMENT* segments, size_t segmentCount)
+{
+    int result;
+
+    if (tickcounter_get_current_ms(mqtt_client->packetTickCntr, &mqtt_client->packetSendTimeMs) != 0)
+    {
+        LogError("Failure getting current ms tickcounter");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = xio_send_segments(mqtt_client->xioHandle, segments, segmentCount, sendComplete, mqtt_client);
+        if (result != 0)
+        {
+            /* Codes_SRS_MQTT_CLIENT_01_029: [ If xio_send_segments fails, the segments before the failing one may already be queued as a truncated packet, so mqtt_client_publish_with_template shall report MQTT_CLIENT_CONNECTION_ERROR to the error callback and close the connection. ] */
+            LogError("%d: Failure sending control packet segments, closing the connection", result);
+            track_lost_connection(mqtt_client);
+            set_error_callback(mqtt_client, MQTT_CLIENT_CONNECTION_ERROR);
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t index;
+            for (index = 0; index < segmentCount; index++)
+            {
+                mqtt_client->bytesSent += segments[index].size;
+            }
+            track_outgoing_packet(mqtt_client);
+#ifdef ENABLE_RAW_TRACE
+            for (index = 0; index < segmentCount; index++)
+            {
+                logOutgoingRawTrace(mqtt_client, segments[index].data, segments[index].size);
+            }
+#endif
+        }
+    }
+    return result;
+}
+
 static void onOpenComplete(void* context, IO_OPEN_RESULT open_result)
 {
     MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)context;
@@ -438,6 +557,8 @@ static void onBytesReceived(void* context, const unsigned char* buffer, size_t s
     MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)context;
     if (mqtt_client != NULL)
     {
+        mqtt_client->bytesReceived += size;
+        track_incoming_bytes(mqtt_client);
         if (mqtt_codec_bytesReceived(mqtt_client->codec_handle, buffer, size) != 0)
         {
             set_error_callback(mqtt_client, MQTT_CLIENT_PARSE_ERROR);
@@ -456,6 +577,8 @@ static void onIoError(void* context)
     {
         /*Codes_SRS_MQTT_CLIENT_07_032: [If the actionResult parameter is of type MQTT_CLIENT_ON_DISCONNECT the the msgInfo value shall be NULL.]*/
         /* Codes_SRS_MQTT_CLIENT_07_036: [ If an error is encountered by the ioHandle the mqtt_client shall call xio_close. ] */
+        /* Codes_SRS_MQTT_CLIENT_01_022: [ If the connection is lost while a probe is pending, the ping interval shall go back to the last interval that was answered, or to minPingIntervalSec when none was, and stop growing. ] */
+        track_lost_connection(mqtt_client);
         set_error_callback(mqtt_client, MQTT_CLIENT_CONNECTION_ERROR);
     }
     else
@@ -703,8 +826,6 @@ static void ProcessPublishMessage(MQTT_CLIENT* mqtt_client, uint8_t* initialPos,
         {
             STRING_delete(trace_log);
         }
-
-        free(topicName);
     }
 }
 
@@ -989,6 +1110,9 @@ int mqtt_client_connect(MQTT_CLIENT_HANDLE handle, XIO_HANDLE xioHandle, MQTT_CL
         mqtt_client->qosValue = mqttOptions->qualityOfServiceValue;
         mqtt_client->keepAliveInterval = mqttOptions->keepAliveInterval;
         mqtt_client->maxPingRespTime = (DEFAULT_MAX_PING_RESPONSE_TIME < mqttOptions->keepAliveInterval/2) ? DEFAULT_MAX_PING_RESPONSE_TIME : mqttOptions->keepAliveInterval/2;
+        // The silence before the CONNECT says nothing about the NAT of the new connection
+        mqtt_client->activitySeen = false;
+        mqtt_client->probePending = false;
         if (cloneMqttOptions(mqtt_client, mqttOptions) != 0)
         {
             LogError("Error: Clone Mqtt Options failed");
@@ -1075,6 +1199,78 @@ int mqtt_client_publish(MQTT_CLIENT_HANDLE handle, MQTT_MESSAGE_HANDLE msgHandle
     return result;
 }
 
+MQTT_PUBLISH_TEMPLATE_HANDLE mqtt_client_create_publish_template(QOS_VALUE qosValue, const char* topicPrefix)
+{
+    /* Codes_SRS_MQTT_CLIENT_01_001: [ mqtt_client_create_publish_template shall create the template with mqtt_codec_publish_template_create, without the retain flag, and return it. ] */
+    return mqtt_codec_publish_template_create(qosValue, false, topicPrefix);
+}
+
+void mqtt_client_destroy_publish_template(MQTT_PUBLISH_TEMPLATE_HANDLE publishTemplate)
+{
+    /* Codes_SRS_MQTT_CLIENT_01_002: [ mqtt_client_destroy_publish_template shall destroy the template with mqtt_codec_publish_template_destroy. ] */
+    mqtt_codec_publish_template_destroy(publishTemplate);
+}
+
+static int publish_with_template(MQTT_CLIENT_HANDLE handle, MQTT_PUBLISH_TEMPLATE_HANDLE publishTemplate, bool duplicateMsg, uint16_t packetId, const char* topicSuffix, const uint8_t* payload, size_t payloadLength)
+{
+    int result;
+    MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)handle;
+    if (mqtt_client == NULL || publishTemplate == NULL || (payload == NULL && payloadLength > 0))
+    {
+        /* Codes_SRS_MQTT_CLIENT_01_003: [ If handle or publishTemplate is NULL, or payload is NULL while payloadLength is not 0, mqtt_client_publish_with_template shall return a non-zero value. ] */
+        LogError("Invalid parameter specified mqtt_client: %p, publishTemplate: %p, payload: %p", mqtt_client, publishTemplate, payload);
+        result = __FAILURE__;
+    }
+    else
+    {
+        STRING_HANDLE trace_log = construct_trace_log_handle(mqtt_client);
+        BUFFER_SEGMENT segments[2];
+
+        /* Codes_SRS_MQTT_CLIENT_01_004: [ mqtt_client_publish_with_template shall build the PUBLISH header with mqtt_codec_publish_template_build. ] */
+        if (mqtt_codec_publish_template_build(publishTemplate, duplicateMsg, packetId, topicSuffix, payloadLength, &segments[0], trace_log) != 0)
+        {
+            /* Codes_SRS_MQTT_CLIENT_01_005: [ If any failure is encountered, mqtt_client_publish_with_template shall return a non-zero value. ] */
+            LogError("Error: mqtt_codec_publish_template_build failed");
+            result = __FAILURE__;
+        }
+        else
+        {
+            mqtt_client->packetState = PUBLISH_TYPE;
+
+            /* Codes_SRS_MQTT_CLIENT_01_006: [ mqtt_client_publish_with_template shall pass the header and the payload to a single xio_send_segments call, which sends them with one write of the transport when they fit in its gather buffer. ] */
+            segments[1].data = payload;
+            segments[1].size = payloadLength;
+            if (sendPacketSegments(mqtt_client, segments, 2) != 0)
+            {
+                /* Codes_SRS_MQTT_CLIENT_01_005: [ If any failure is encountered, mqtt_client_publish_with_template shall return a non-zero value. ] */
+                LogError("Error: mqtt_client_publish_with_template send failed");
+                result = __FAILURE__;
+            }
+            else
+            {
+                log_outgoing_trace(mqtt_client, trace_log);
+                result = 0;
+            }
+        }
+        if (trace_log != NULL)
+        {
+            STRING_delete(trace_log);
+        }
+    }
+    return result;
+}
+
+int mqtt_client_publish_with_template(MQTT_CLIENT_HANDLE handle, MQTT_PUBLISH_TEMPLATE_HANDLE publishTemplate, uint16_t packetId, const char* topicSuffix, const uint8_t* payload, size_t payloadLength)
+{
+    return publish_with_template(handle, publishTemplate, false, packetId, topicSuffix, payload, payloadLength);
+}
+
+int mqtt_client_republish_with_template(MQTT_CLIENT_HANDLE handle, MQTT_PUBLISH_TEMPLATE_HANDLE publishTemplate, uint16_t packetId, const char* topicSuffix, const uint8_t* payload, size_t payloadLength)
+{
+    /* Codes_SRS_MQTT_CLIENT_01_028: [ mqtt_client_republish_with_template shall do the same as mqtt_client_publish_with_template with the DUP flag set in the PUBLISH header. ] */
+    return publish_with_template(handle, publishTemplate, true, packetId, topicSuffix, payload, payloadLength);
+}
+
 int mqtt_client_subscribe(MQTT_CLIENT_HANDLE handle, uint16_t packetId, SUBSCRIBE_PAYLOAD* subscribeList, size_t count)
 {
     int result;
@@ -1260,12 +1456,17 @@ void mqtt_client_dowork(MQTT_CLIENT_HANDLE handle)
                 if (mqtt_client->timeSincePing > 0 && ((current_ms - mqtt_client->timeSincePing)/1000) > mqtt_client->maxPingRespTime)
                 {
                     // We haven't gotten a ping response in the alloted time
+                    /* Codes_SRS_MQTT_CLIENT_01_022: [ If the connection is lost while a probe is pending, the ping interval shall go back to the last interval that was answered, or to minPingIntervalSec when none was, and stop growing. ] */
+                    /* Codes_SRS_MQTT_CLIENT_01_023: [ If a PINGREQ is not answered while the ping interval is settled, the ping interval shall start again from minPingIntervalSec. ] */
+                    track_lost_connection(mqtt_client);
                     set_error_callback(mqtt_client, MQTT_CLIENT_NO_PING_RESPONSE);
                     mqtt_client->timeSincePing = 0;
                     mqtt_client->packetSendTimeMs = 0;
                     mqtt_client->packetState = UNKNOWN_TYPE;
                 }
-                else if (((current_ms - mqtt_client->packetSendTimeMs) / 1000) >= mqtt_client->keepAliveInterval)
+                /* Codes_SRS_MQTT_CLIENT_01_019: [ In idle mode mqtt_client_dowork shall also send a PINGREQ once the ping interval has passed since the last packet was sent or received. ] */
+                else if (((current_ms - mqtt_client->packetSendTimeMs) / 1000) >= mqtt_client->keepAliveInterval ||
+                    (mqtt_client->idleMode && mqtt_client->activitySeen && ((current_ms - mqtt_client->lastActivityMs) / 1000) >= get_ping_interval(mqtt_client)))
                 {
                     /*Codes_SRS_MQTT_CLIENT_07_026: [if keepAliveInternal is > 0 and the send time is greater than the MQTT KeepAliveInterval then it shall construct an MQTT PINGREQ packet.]*/
                     BUFFER_HANDLE pingPacket = mqtt_codec_ping();
@@ -1275,6 +1476,7 @@ void mqtt_client_dowork(MQTT_CLIENT_HANDLE handle)
                         (void)sendPacketItem(mqtt_client, BUFFER_u_char(pingPacket), size);
                         BUFFER_delete(pingPacket);
                         (void)tickcounter_get_current_ms(mqtt_client->packetTickCntr, &mqtt_client->timeSincePing);
+                        mqtt_client->pingsSent++;
 
                         if (mqtt_client->logTrace)
                         {
@@ -1289,6 +1491,155 @@ void mqtt_client_dowork(MQTT_CLIENT_HANDLE handle)
     }
 }
 
+int mqtt_client_get_traffic(MQTT_CLIENT_HANDLE handle, uint64_t* bytesSent, uint64_t* bytesReceived)
+{
+    int result;
+    /* Codes_SRS_MQTT_CLIENT_01_007: [ If handle, bytesSent or bytesReceived is NULL, mqtt_client_get_traffic shall return a non-zero value. ] */
+    if (handle == NULL || bytesSent == NULL || bytesReceived == NULL)
+    {
+        LogError("Invalid parameter specified mqtt_client: %p, bytesSent: %p, bytesReceived: %p", handle, bytesSent, bytesReceived);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_MQTT_CLIENT_01_008: [ mqtt_client_get_traffic shall return in bytesSent the number of bytes handed to the IO with xio_send or xio_send_segments, and in bytesReceived the number of bytes received from the IO, since mqtt_client_init. ] */
+        MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)handle;
+        *bytesSent = mqtt_client->bytesSent;
+        *bytesReceived = mqtt_client->bytesReceived;
+        result = 0;
+    }
+    return result;
+}
+
+static void lower_to_deadline(tickcounter_ms_t* msToNextWork, tickcounter_ms_t current_ms, tickcounter_ms_t deadline_ms)
+{
+    tickcounter_ms_t msLeft = (deadline_ms > current_ms) ? (deadline_ms - current_ms) : 0;
+    if (msLeft < *msToNextWork)
+    {
+        *msToNextWork = msLeft;
+    }
+}
+
+int mqtt_client_get_next_work_time(MQTT_CLIENT_HANDLE handle, tickcounter_ms_t* msToNextWork)
+{
+    int result;
+    /* Codes_SRS_MQTT_CLIENT_01_009: [ If handle or msToNextWork is NULL, mqtt_client_get_next_work_time shall return a non-zero value. ] */
+    if (handle == NULL || msToNextWork == NULL)
+    {
+        LogError("Invalid parameter specified mqtt_client: %p, msToNextWork: %p", handle, msToNextWork);
+        result = __FAILURE__;
+    }
+    else
+    {
+        MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)handle;
+        tickcounter_ms_t current_ms;
+
+        /* Codes_SRS_MQTT_CLIENT_01_010: [ If the client is not connected or keepAliveInterval is 0, mqtt_client_get_next_work_time shall leave msToNextWork unchanged and return 0. ] */
+        if (mqtt_client->xioHandle == NULL || !mqtt_client->socketConnected || !mqtt_client->clientConnected || mqtt_client->keepAliveInterval == 0)
+        {
+            result = 0;
+        }
+        /* Codes_SRS_MQTT_CLIENT_01_011: [ If tickcounter_get_current_ms fails, mqtt_client_get_next_work_time shall return a non-zero value. ] */
+        else if (tickcounter_get_current_ms(mqtt_client->packetTickCntr, &current_ms) != 0)
+        {
+            LogError("Error: tickcounter_get_current_ms failed");
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_MQTT_CLIENT_01_012: [ mqtt_client_get_next_work_time shall lower msToNextWork to the milliseconds left until keepAliveInterval seconds have passed since the last packet was sent. ] */
+            lower_to_deadline(msToNextWork, current_ms, mqtt_client->packetSendTimeMs + (tickcounter_ms_t)mqtt_client->keepAliveInterval * 1000);
+
+            /* Codes_SRS_MQTT_CLIENT_01_024: [ In idle mode mqtt_client_get_next_work_time shall also lower msToNextWork to the milliseconds left until the ping interval has passed since the last packet was sent or received. ] */
+            if (mqtt_client->idleMode && mqtt_client->activitySeen)
+            {
+                lower_to_deadline(msToNextWork, current_ms, mqtt_client->lastActivityMs + (tickcounter_ms_t)get_ping_interval(mqtt_client) * 1000);
+            }
+
+            /* Codes_SRS_MQTT_CLIENT_01_013: [ If a PINGRESP is pending, mqtt_client_get_next_work_time shall also lower msToNextWork to the milliseconds left until more than maxPingRespTime seconds have passed since the PINGREQ was sent. ] */
+            if (mqtt_client->timeSincePing > 0)
+            {
+                lower_to_deadline(msToNextWork, current_ms, mqtt_client->timeSincePing + ((tickcounter_ms_t)mqtt_client->maxPingRespTime + 1) * 1000);
+            }
+
+            /* Codes_SRS_MQTT_CLIENT_01_014: [ On success mqtt_client_get_next_work_time shall return 0. ] */
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int mqtt_client_set_idle_options(MQTT_CLIENT_HANDLE handle, const MQTT_CLIENT_IDLE_OPTIONS* idleOptions)
+{
+    int result;
+    /* Codes_SRS_MQTT_CLIENT_01_015: [ If handle is NULL, or idleOptions is not NULL and its minPingIntervalSec is 0, mqtt_client_set_idle_options shall return a non-zero value. ] */
+    if (handle == NULL || (idleOptions != NULL && idleOptions->minPingIntervalSec == 0))
+    {
+        LogError("Invalid parameter specified mqtt_client: %p, idleOptions: %p", handle, idleOptions);
+        result = __FAILURE__;
+    }
+    else
+    {
+        MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)handle;
+        if (idleOptions == NULL)
+        {
+            /* Codes_SRS_MQTT_CLIENT_01_016: [ If idleOptions is NULL, mqtt_client_set_idle_options shall turn the idle mode off and the client shall ping every keepAliveInterval again. ] */
+            mqtt_client->idleMode = false;
+        }
+        else
+        {
+            /* Codes_SRS_MQTT_CLIENT_01_017: [ mqtt_client_set_idle_options shall turn the idle mode on with a ping interval of minPingIntervalSec that is not settled. ] */
+            mqtt_client->idleOptions = *idleOptions;
+            mqtt_client->idleMode = true;
+            mqtt_client->pingIntervalSec = idleOptions->minPingIntervalSec;
+            mqtt_client->lastGoodPingIntervalSec = 0;
+            mqtt_client->pingIntervalSettled = false;
+            mqtt_client->probePending = false;
+            if (mqtt_client->socketConnected && !mqtt_client->activitySeen)
+            {
+                // Already connected: the ping interval counts from the last packet sent
+                mqtt_client->activitySeen = true;
+                mqtt_client->lastActivityMs = mqtt_client->packetSendTimeMs;
+            }
+        }
+        /* Codes_SRS_MQTT_CLIENT_01_018: [ On success mqtt_client_set_idle_options shall return 0. ] */
+        result = 0;
+    }
+    return result;
+}
+
+int mqtt_client_get_radio_statistics(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_RADIO_STATISTICS* statistics)
+{
+    int result;
+    tickcounter_ms_t current_ms = 0;
+    MQTT_CLIENT* mqtt_client = (MQTT_CLIENT*)handle;
+    /* Codes_SRS_MQTT_CLIENT_01_025: [ If handle or statistics is NULL, mqtt_client_get_radio_statistics shall return a non-zero value. ] */
+    if (handle == NULL || statistics == NULL)
+    {
+        LogError("Invalid parameter specified mqtt_client: %p, statistics: %p", handle, statistics);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_MQTT_CLIENT_01_026: [ In idle mode, if tickcounter_get_current_ms fails, mqtt_client_get_radio_statistics shall return a non-zero value. ] */
+    else if (mqtt_client->idleMode && tickcounter_get_current_ms(mqtt_client->packetTickCntr, &current_ms) != 0)
+    {
+        LogError("Error: tickcounter_get_current_ms failed");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_MQTT_CLIENT_01_027: [ mqtt_client_get_radio_statistics shall return the radio wake-ups counted in idle mode, the PINGREQs sent, the ping interval in use (keepAliveInterval outside of idle mode), whether it is settled, whether the last traffic in idle mode is at most radioTailMs old, and the counters of mqtt_client_get_traffic. ] */
+        statistics->radioWakeUps = mqtt_client->radioWakeUps;
+        statistics->pingsSent = mqtt_client->pingsSent;
+        statistics->pingIntervalSec = get_ping_interval(mqtt_client);
+        statistics->pingIntervalSettled = mqtt_client->idleMode ? mqtt_client->pingIntervalSettled : true;
+        statistics->radioAwake = mqtt_client->idleMode && mqtt_client->activitySeen && (current_ms - mqtt_client->lastActivityMs) <= mqtt_client->idleOptions.radioTailMs;
+        statistics->bytesSent = mqtt_client->bytesSent;
+        statistics->bytesReceived = mqtt_client->bytesReceived;
+        result = 0;
+    }
+    return result;
+}
+
 void mqtt_client_set_trace(MQTT_CLIENT_HANDLE handle, bool traceOn, bool rawBytesOn)
 {
     AZURE_UNREFERENCED_PARAMETER(handle);
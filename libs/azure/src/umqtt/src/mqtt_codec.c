@@ -38,6 +38,15 @@
 #define UNSUBSCRIBE_FIXED_HEADER_FLAG       0x2
 
 #define MAX_SEND_SIZE                       0xFFFFFF7F
+#define FIXED_HEADER_MAX_SIZE               5
+#define REMAINING_LENGTH_MAX_BYTES          4
+#define REMAINING_LENGTH_MAX_VALUE          0x0FFFFFFF
+#define PUBLISH_TEMPLATE_TOPIC_OFFSET       (FIXED_HEADER_MAX_SIZE + 2)
+
+/* packet buffers up to this size are kept for the next packet, bigger ones are freed once the packet is delivered */
+#ifndef MQTT_CODEC_RETAINED_BUFFER_SIZE
+#define MQTT_CODEC_RETAINED_BUFFER_SIZE     1024
+#endif
 
 #define CODEC_STATE_VALUES      \
     CODEC_STATE_FIXED_HEADER,   \
@@ -55,10 +64,13 @@ typedef struct MQTTCODEC_INSTANCE_TAG
     CODEC_STATE_RESULT codecState;
     size_t bufferOffset;
     int headerFlags;
+    /* holds the packet being received, kept from one packet to the next */
     BUFFER_HANDLE headerData;
+    uint8_t* packetData;
+    size_t packetLength;
     ON_PACKET_COMPLETE_CALLBACK packetComplete;
     void* callContext;
-    uint8_t storeRemainLen[4];
+    size_t remainLen;
     size_t remainLenIndex;
 } MQTTCODEC_INSTANCE;
 
@@ -70,6 +82,17 @@ typedef struct PUBLISH_HEADER_INFO_TAG
     QOS_VALUE qualityOfServiceValue;
 } PUBLISH_HEADER_INFO;
 
+typedef struct MQTT_PUBLISH_TEMPLATE_TAG
+{
+    /* FIXED_HEADER_MAX_SIZE bytes of room for the fixed header, then the topic length, the topic prefix,
+       the topic suffix of the last packet built and the packet id */
+    uint8_t* packet;
+    size_t capacity;
+    size_t prefixLength;
+    QOS_VALUE qualityOfServiceValue;
+    bool serverRetain;
+} MQTT_PUBLISH_TEMPLATE;
+
 static const char* retrieve_qos_value(QOS_VALUE value)
 {
     switch (value)
@@ -369,25 +392,19 @@ static int constructFixedHeader(BUFFER_HANDLE ctrlPacket, CONTROL_PACKET_TYPE pa
             remainSize[index++] = encode;
         } while (packetLen > 0);
 
-        BUFFER_HANDLE fixedHeader = BUFFER_new();
-        if (fixedHeader == NULL)
-        {
-            result = __FAILURE__;
-        }
-        else if (BUFFER_pre_build(fixedHeader, index + 1) != 0)
+        uint8_t fixedHeader[FIXED_HEADER_MAX_SIZE];
+        fixedHeader[0] = (uint8_t)packetType | flags;
+        (void)memcpy(&fixedHeader[1], remainSize, index);
+
+        // The fixed header goes in front of the packet; when the packet was reserved with
+        // FIXED_HEADER_MAX_SIZE bytes of headroom this is a plain copy, no new allocation.
+        if (BUFFER_prepend_build(ctrlPacket, fixedHeader, index + 1) != 0)
         {
-            BUFFER_delete(fixedHeader);
             result = __FAILURE__;
         }
         else
         {
-            uint8_t* iterator = BUFFER_u_char(fixedHeader);
-            *iterator = (uint8_t)packetType | flags;
-            iterator++;
-            (void)memcpy(iterator, remainSize, index);
-
-            result = BUFFER_prepend(ctrlPacket, fixedHeader);
-            BUFFER_delete(fixedHeader);
+            result = 0;
         }
     }
     return result;
@@ -530,84 +547,118 @@ static int constructConnPayload(BUFFER_HANDLE ctrlPacket, const MQTT_CLIENT_OPTI
     return result;
 }
 
-static int prepareheaderDataInfo(MQTTCODEC_INSTANCE* codecData, uint8_t remainLen)
+static int prepareheaderDataInfo(MQTTCODEC_INSTANCE* codecData)
 {
     int result;
-    if (codecData == NULL)
+
+    if (codecData->headerData == NULL)
     {
-        result = __FAILURE__;
+        /* the buffer is kept in reserved mode, so that clearing it after a packet keeps its storage for the next one */
+        if ((codecData->headerData = BUFFER_new()) == NULL)
+        {
+            /* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
+            LogError("Failed BUFFER_new");
+            result = __FAILURE__;
+        }
+        else if (BUFFER_reserve(codecData->headerData, 0, codecData->packetLength) != 0)
+        {
+            /* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
+            LogError("Failed BUFFER_reserve");
+            BUFFER_delete(codecData->headerData);
+            codecData->headerData = NULL;
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
     }
     else
     {
         result = 0;
-        codecData->storeRemainLen[codecData->remainLenIndex++] = remainLen;
-        if (remainLen <= 0x7f)
-        {
-            int multiplier = 1;
-            int totalLen = 0;
-            size_t index = 0;
-            uint8_t encodeByte = 0;
-            do
-            {
-                encodeByte = codecData->storeRemainLen[index++];
-                totalLen += (encodeByte & 127) * multiplier;
-                multiplier *= NEXT_128_CHUNK;
-
-                if (multiplier > 128 * 128 * 128)
-                {
-                    result = __FAILURE__;
-                    break;
-                }
-            } while ((encodeByte & NEXT_128_CHUNK) != 0);
+    }
 
+    if (result == 0)
+    {
+        /* Codes_SRS_MQTT_CODEC_01_002: [ mqtt_codec_bytesReceived shall reuse the buffer of the previous packet when it is big enough. ] */
+        if (BUFFER_pre_build(codecData->headerData, codecData->packetLength) != 0)
+        {
+            /* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
+            LogError("Failed BUFFER_pre_build");
+            result = __FAILURE__;
+        }
+        else if ((codecData->packetData = BUFFER_u_char(codecData->headerData)) == NULL)
+        {
+            /* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
+            LogError("Failed BUFFER_u_char");
+            result = __FAILURE__;
+        }
+        else
+        {
+            codecData->bufferOffset = 0;
             codecData->codecState = CODEC_STATE_VAR_HEADER;
-
-            // Reset remainLen Index
-            codecData->remainLenIndex = 0;
-            memset(codecData->storeRemainLen, 0, 4 * sizeof(uint8_t));
-
-            if (totalLen > 0)
-            {
-                codecData->bufferOffset = 0;
-                codecData->headerData = BUFFER_new();
-                if (codecData->headerData == NULL)
-                {
-                    /* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
-                    LogError("Failed BUFFER_new");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    if (BUFFER_pre_build(codecData->headerData, totalLen) != 0)
-                    {
-                        /* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
-                        LogError("Failed BUFFER_pre_build");
-                        result = __FAILURE__;
-                    }
-
-                }
-            }
         }
     }
+
     return result;
 }
 
 static void completePacketData(MQTTCODEC_INSTANCE* codecData)
 {
-    if (codecData)
+    if (codecData->packetComplete != NULL)
+    {
+        /* Codes_SRS_MQTT_CODEC_01_003: [ The BUFFER_HANDLE given to ON_PACKET_COMPLETE_CALLBACK is owned by the codec and is only valid during the callback; it is NULL for packets without a variable header or payload. ] */
+        codecData->packetComplete(codecData->callContext, codecData->currPacket, codecData->headerFlags, (codecData->packetLength > 0) ? codecData->headerData : NULL);
+    }
+
+    // Clean up data
+    codecData->currPacket = UNKNOWN_TYPE;
+    codecData->codecState = CODEC_STATE_FIXED_HEADER;
+    codecData->headerFlags = 0;
+    codecData->packetData = NULL;
+
+    if (codecData->packetLength > 0)
     {
-        if (codecData->packetComplete != NULL)
+        if (codecData->packetLength > MQTT_CODEC_RETAINED_BUFFER_SIZE)
+        {
+            /* Codes_SRS_MQTT_CODEC_01_004: [ After a packet bigger than MQTT_CODEC_RETAINED_BUFFER_SIZE bytes is delivered, its buffer shall be freed. ] */
+            BUFFER_delete(codecData->headerData);
+            codecData->headerData = NULL;
+        }
+        else
         {
-            codecData->packetComplete(codecData->callContext, codecData->currPacket, codecData->headerFlags, codecData->headerData);
+            /* in reserved mode this only sets the size to 0 and keeps the storage */
+            (void)BUFFER_build(codecData->headerData, NULL, 0);
         }
+    }
+    codecData->packetLength = 0;
+}
 
-        // Clean up data
-        codecData->currPacket = UNKNOWN_TYPE;
-        codecData->codecState = CODEC_STATE_FIXED_HEADER;
-        codecData->headerFlags = 0;
-        BUFFER_delete(codecData->headerData);
-        codecData->headerData = NULL;
+/* Consumes the remaining length bytes available in buffer. Returns non-zero if the remaining length is longer than 4 bytes. */
+static int decodeRemainingLength(MQTTCODEC_INSTANCE* codecData, const unsigned char* buffer, size_t size, size_t* index, bool* isComplete)
+{
+    int result = 0;
+
+    *isComplete = false;
+    while ((*index < size) && !*isComplete)
+    {
+        uint8_t encodeByte = buffer[(*index)++];
+        codecData->remainLen += (size_t)(encodeByte & 0x7F) << (7 * codecData->remainLenIndex);
+        codecData->remainLenIndex++;
+
+        if ((encodeByte & NEXT_128_CHUNK) == 0)
+        {
+            *isComplete = true;
+        }
+        else if (codecData->remainLenIndex == REMAINING_LENGTH_MAX_BYTES)
+        {
+            LogError("Remaining length is longer than %d bytes", REMAINING_LENGTH_MAX_BYTES);
+            result = __FAILURE__;
+            break;
+        }
     }
+
+    return result;
 }
 
 MQTTCODEC_HANDLE mqtt_codec_create(ON_PACKET_COMPLETE_CALLBACK packetComplete, void* callbackCtx)
@@ -625,7 +676,9 @@ MQTTCODEC_HANDLE mqtt_codec_create(ON_PACKET_COMPLETE_CALLBACK packetComplete, v
         result->packetComplete = packetComplete;
         result->callContext = callbackCtx;
         result->headerData = NULL;
-        memset(result->storeRemainLen, 0, 4 * sizeof(uint8_t));
+        result->packetData = NULL;
+        result->packetLength = 0;
+        result->remainLen = 0;
         result->remainLenIndex = 0;
     }
     return result;
@@ -776,7 +829,20 @@ BUFFER_HANDLE mqtt_codec_publish(QOS_VALUE qosValue, bool duplicateMsg, bool ser
 
         /* Codes_SRS_MQTT_CODEC_07_007: [mqtt_codec_publish shall return a BUFFER_HANDLE that represents a MQTT PUBLISH message.] */
         result = BUFFER_new();
-        if (result != NULL)
+        if (result == NULL)
+        {
+            /* Codes_SRS_MQTT_CODEC_07_006: [If any error is encountered then mqtt_codec_publish shall return NULL.] */
+            LogError("Failure creating publish buffer");
+        }
+        /* Codes_SRS_MQTT_CODEC_01_001: [mqtt_codec_publish shall reserve room for the largest fixed header in front of the packet and for the whole variable header and payload behind it, so that the packet is built in a single allocation.] */
+        else if (BUFFER_reserve(result, FIXED_HEADER_MAX_SIZE, strlen(topicName) + 2 + ((qosValue != DELIVER_AT_MOST_ONCE) ? 2 : 0) + buffLen) != 0)
+        {
+            /* Codes_SRS_MQTT_CODEC_07_006: [If any error is encountered then mqtt_codec_publish shall return NULL.] */
+            LogError("Failure reserving publish buffer");
+            BUFFER_delete(result);
+            result = NULL;
+        }
+        else
         {
             STRING_HANDLE varible_header_log = NULL;
             if (trace_log != NULL)
@@ -855,6 +921,179 @@ BUFFER_HANDLE mqtt_codec_publish(QOS_VALUE qosValue, bool duplicateMsg, bool ser
     return result;
 }
 
+MQTT_PUBLISH_TEMPLATE_HANDLE mqtt_codec_publish_template_create(QOS_VALUE qosValue, bool serverRetain, const char* topicPrefix)
+{
+    MQTT_PUBLISH_TEMPLATE* result;
+    size_t prefixLength;
+
+    /* Codes_SRS_MQTT_CODEC_01_006: [ If topicPrefix is NULL or longer than 65535 bytes, mqtt_codec_publish_template_create shall return NULL. ] */
+    if (topicPrefix == NULL)
+    {
+        LogError("Invalid parameter specified: topicPrefix is NULL");
+        result = NULL;
+    }
+    else if ((prefixLength = strlen(topicPrefix)) > USHRT_MAX)
+    {
+        LogError("Topic prefix is too long: %lu", (unsigned long)prefixLength);
+        result = NULL;
+    }
+    else if ((result = (MQTT_PUBLISH_TEMPLATE*)malloc(sizeof(MQTT_PUBLISH_TEMPLATE))) == NULL)
+    {
+        /* Codes_SRS_MQTT_CODEC_01_007: [ If any error is encountered, mqtt_codec_publish_template_create shall return NULL. ] */
+        LogError("Failure allocating publish template");
+    }
+    else
+    {
+        /* Codes_SRS_MQTT_CODEC_01_008: [ mqtt_codec_publish_template_create shall allocate room for the largest fixed header, the topic length, topicPrefix and a packet id, and copy topicPrefix in place. ] */
+        result->capacity = PUBLISH_TEMPLATE_TOPIC_OFFSET + prefixLength + 2;
+        if ((result->packet = (uint8_t*)malloc(result->capacity)) == NULL)
+        {
+            /* Codes_SRS_MQTT_CODEC_01_007: [ If any error is encountered, mqtt_codec_publish_template_create shall return NULL. ] */
+            LogError("Failure allocating publish template packet");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            (void)memcpy(result->packet + PUBLISH_TEMPLATE_TOPIC_OFFSET, topicPrefix, prefixLength);
+            result->prefixLength = prefixLength;
+            result->qualityOfServiceValue = qosValue;
+            result->serverRetain = serverRetain;
+        }
+    }
+    return result;
+}
+
+void mqtt_codec_publish_template_destroy(MQTT_PUBLISH_TEMPLATE_HANDLE publishTemplate)
+{
+    /* Codes_SRS_MQTT_CODEC_01_009: [ If publishTemplate is NULL, mqtt_codec_publish_template_destroy shall do nothing, otherwise it shall free all resources used by publishTemplate. ] */
+    if (publishTemplate != NULL)
+    {
+        free(publishTemplate->packet);
+        free(publishTemplate);
+    }
+}
+
+int mqtt_codec_publish_template_build(MQTT_PUBLISH_TEMPLATE_HANDLE publishTemplate, bool duplicateMsg, uint16_t packetId, const char* topicSuffix, size_t payloadLen, BUFFER_SEGMENT* header, STRING_HANDLE trace_log)
+{
+    int result;
+
+    /* Codes_SRS_MQTT_CODEC_01_010: [ If publishTemplate or header is NULL, mqtt_codec_publish_template_build shall return a non-zero value. ] */
+    if (publishTemplate == NULL || header == NULL)
+    {
+        LogError("Invalid parameter specified: publishTemplate: %p, header: %p", publishTemplate, header);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t suffixLength = (topicSuffix == NULL) ? 0 : strlen(topicSuffix);
+        size_t topicLength = publishTemplate->prefixLength + suffixLength;
+        size_t idLength = (publishTemplate->qualityOfServiceValue != DELIVER_AT_MOST_ONCE) ? 2 : 0;
+        size_t packetEnd = PUBLISH_TEMPLATE_TOPIC_OFFSET + topicLength + idLength;
+        size_t remainingLength = (packetEnd - FIXED_HEADER_MAX_SIZE) + payloadLen;
+
+        /* Codes_SRS_MQTT_CODEC_01_011: [ If the topic is longer than 65535 bytes or the packet does not fit the 4 byte remaining length, mqtt_codec_publish_template_build shall return a non-zero value. ] */
+        if (topicLength > USHRT_MAX || payloadLen > REMAINING_LENGTH_MAX_VALUE || remainingLength > REMAINING_LENGTH_MAX_VALUE)
+        {
+            LogError("PUBLISH packet is too long: topic %lu bytes, payload %lu bytes", (unsigned long)topicLength, (unsigned long)payloadLen);
+            result = __FAILURE__;
+        }
+        else
+        {
+            if (packetEnd > publishTemplate->capacity)
+            {
+                /* Codes_SRS_MQTT_CODEC_01_012: [ The template shall grow when topicSuffix does not fit, and keep its size afterwards. ] */
+                uint8_t* packet = (uint8_t*)realloc(publishTemplate->packet, packetEnd);
+                if (packet == NULL)
+                {
+                    LogError("Failure growing publish template packet");
+                }
+                else
+                {
+                    publishTemplate->packet = packet;
+                    publishTemplate->capacity = packetEnd;
+                }
+            }
+
+            if (packetEnd > publishTemplate->capacity)
+            {
+                /* Codes_SRS_MQTT_CODEC_01_013: [ If any error is encountered, mqtt_codec_publish_template_build shall return a non-zero value. ] */
+                result = __FAILURE__;
+            }
+            else
+            {
+                uint8_t remainSize[REMAINING_LENGTH_MAX_BYTES];
+                size_t index = 0;
+                size_t encodeLength = remainingLength;
+                uint8_t headerFlags = 0;
+                uint8_t* iterator = publishTemplate->packet + FIXED_HEADER_MAX_SIZE;
+                uint8_t* packetStart;
+
+                if (duplicateMsg) headerFlags |= PUBLISH_DUP_FLAG;
+                if (publishTemplate->serverRetain) headerFlags |= PUBLISH_QOS_RETAIN;
+                if (publishTemplate->qualityOfServiceValue == DELIVER_AT_LEAST_ONCE)
+                {
+                    headerFlags |= PUBLISH_QOS_AT_LEAST_ONCE;
+                }
+                else if (publishTemplate->qualityOfServiceValue != DELIVER_AT_MOST_ONCE)
+                {
+                    headerFlags |= PUBLISH_QOS_EXACTLY_ONCE;
+                }
+
+                do
+                {
+                    uint8_t encode = encodeLength % 128;
+                    encodeLength /= 128;
+                    if (encodeLength > 0)
+                    {
+                        encode |= NEXT_128_CHUNK;
+                    }
+                    remainSize[index++] = encode;
+                } while (encodeLength > 0);
+
+                /* Codes_SRS_MQTT_CODEC_01_014: [ mqtt_codec_publish_template_build shall write the topic length, topicSuffix after the topic prefix, the packet id when the QOS is not DELIVER_AT_MOST_ONCE, and the fixed header right in front of them. ] */
+                byteutil_writeInt(&iterator, (uint16_t)topicLength);
+                iterator += publishTemplate->prefixLength;
+                if (suffixLength > 0)
+                {
+                    (void)memcpy(iterator, topicSuffix, suffixLength);
+                    iterator += suffixLength;
+                }
+                if (idLength > 0)
+                {
+                    byteutil_writeInt(&iterator, packetId);
+                }
+
+                packetStart = publishTemplate->packet + FIXED_HEADER_MAX_SIZE - (index + 1);
+                packetStart[0] = (uint8_t)PUBLISH_TYPE | headerFlags;
+                (void)memcpy(packetStart + 1, remainSize, index);
+
+                /* Codes_SRS_MQTT_CODEC_01_015: [ On success header shall point at the PUBLISH packet up to the payload, which stays valid until the next call for publishTemplate, and mqtt_codec_publish_template_build shall return 0. ] */
+                header->data = packetStart;
+                header->size = packetEnd - (size_t)(packetStart - publishTemplate->packet);
+
+                if (trace_log != NULL)
+                {
+                    (void)STRING_copy(trace_log, "PUBLISH");
+                    (void)STRING_sprintf(trace_log, " | IS_DUP: %s | RETAIN: %d | QOS: %s | TOPIC_NAME: %.*s", duplicateMsg ? TRUE_CONST : FALSE_CONST,
+                        publishTemplate->serverRetain ? 1 : 0, retrieve_qos_value(publishTemplate->qualityOfServiceValue),
+                        (int)topicLength, (const char*)(publishTemplate->packet + PUBLISH_TEMPLATE_TOPIC_OFFSET));
+                    if (idLength > 0)
+                    {
+                        (void)STRING_sprintf(trace_log, " | PACKET_ID: %"PRIu16, packetId);
+                    }
+                    if (payloadLen > 0)
+                    {
+                        (void)STRING_sprintf(trace_log, " | PAYLOAD_LEN: %zu", payloadLen);
+                    }
+                }
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
 BUFFER_HANDLE mqtt_codec_publishAck(uint16_t packetId)
 {
     /* Codes_SRS_MQTT_CODEC_07_013: [On success mqtt_codec_publishAck shall return a BUFFER_HANDLE representation of a MQTT PUBACK packet.] */
@@ -1066,60 +1305,60 @@ int mqtt_codec_bytesReceived(MQTTCODEC_HANDLE handle, const unsigned char* buffe
     else
     {
         /* Codes_SRS_MQTT_CODEC_07_033: [mqtt_codec_bytesReceived constructs a sequence of bytes into the corresponding MQTT packets and on success returns zero.] */
-        result = 0;
         size_t index = 0;
-        for (index = 0; index < size && result == 0; index++)
+        result = 0;
+        while ((index < size) && (result == 0))
         {
-            uint8_t iterator = ((int8_t*)buffer)[index];
             if (codec_Data->codecState == CODEC_STATE_FIXED_HEADER)
             {
                 if (codec_Data->currPacket == UNKNOWN_TYPE)
                 {
-                    codec_Data->currPacket = processControlPacketType(iterator, &codec_Data->headerFlags);
+                    codec_Data->currPacket = processControlPacketType(buffer[index++], &codec_Data->headerFlags);
+                    codec_Data->remainLen = 0;
+                    codec_Data->remainLenIndex = 0;
                 }
                 else
                 {
-                    if (prepareheaderDataInfo(codec_Data, iterator) != 0)
+                    bool isComplete;
+                    if (decodeRemainingLength(codec_Data, buffer, size, &index, &isComplete) != 0)
                     {
                         /* Codes_SRS_MQTT_CODEC_07_035: [If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value.] */
                         codec_Data->currPacket = PACKET_TYPE_ERROR;
                         result = __FAILURE__;
                     }
-                    if (codec_Data->currPacket == PINGRESP_TYPE)
+                    else if (isComplete)
                     {
-                        /* Codes_SRS_MQTT_CODEC_07_034: [Upon a constructing a complete MQTT packet mqtt_codec_bytesReceived shall call the ON_PACKET_COMPLETE_CALLBACK function.] */
-                        completePacketData(codec_Data);
+                        codec_Data->packetLength = codec_Data->remainLen;
+                        if (codec_Data->packetLength == 0)
+                        {
+                            /* Codes_SRS_MQTT_CODEC_07_034: [Upon a constructing a complete MQTT packet mqtt_codec_bytesReceived shall call the ON_PACKET_COMPLETE_CALLBACK function.] */
+                            completePacketData(codec_Data);
+                        }
+                        else if (prepareheaderDataInfo(codec_Data) != 0)
+                        {
+                            /* Codes_SRS_MQTT_CODEC_07_035: [If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value.] */
+                            codec_Data->currPacket = PACKET_TYPE_ERROR;
+                            result = __FAILURE__;
+                        }
                     }
                 }
             }
             else if (codec_Data->codecState == CODEC_STATE_VAR_HEADER)
             {
-                if (codec_Data->headerData == NULL)
+                /* Codes_SRS_MQTT_CODEC_01_005: [ mqtt_codec_bytesReceived shall copy all the bytes of the current packet that are available in buffer at once. ] */
+                size_t copySize = codec_Data->packetLength - codec_Data->bufferOffset;
+                if (copySize > size - index)
                 {
-                    codec_Data->codecState = CODEC_STATE_PAYLOAD;
+                    copySize = size - index;
                 }
-                else
-                {
-                    uint8_t* dataBytes = BUFFER_u_char(codec_Data->headerData);
-                    if (dataBytes == NULL)
-                    {
-                        /* Codes_SRS_MQTT_CODEC_07_035: [If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value.] */
-                        codec_Data->currPacket = PACKET_TYPE_ERROR;
-                        result = __FAILURE__;
-                    }
-                    else
-                    {
-                        // Increment the data
-                        dataBytes += codec_Data->bufferOffset++;
-                        *dataBytes = iterator;
+                (void)memcpy(codec_Data->packetData + codec_Data->bufferOffset, buffer + index, copySize);
+                codec_Data->bufferOffset += copySize;
+                index += copySize;
 
-                        size_t totalLen = BUFFER_length(codec_Data->headerData);
-                        if (codec_Data->bufferOffset >= totalLen)
-                        {
-                            /* Codes_SRS_MQTT_CODEC_07_034: [Upon a constructing a complete MQTT packet mqtt_codec_bytesReceived shall call the ON_PACKET_COMPLETE_CALLBACK function.] */
-                            completePacketData(codec_Data);
-                        }
-                    }
+                if (codec_Data->bufferOffset == codec_Data->packetLength)
+                {
+                    /* Codes_SRS_MQTT_CODEC_07_034: [Upon a constructing a complete MQTT packet mqtt_codec_bytesReceived shall call the ON_PACKET_COMPLETE_CALLBACK function.] */
+                    completePacketData(codec_Data);
                 }
             }
             else
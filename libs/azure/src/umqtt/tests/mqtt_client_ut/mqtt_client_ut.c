@@ -92,6 +92,7 @@ static const TICK_COUNTER_HANDLE TEST_COUNTER_HANDLE = (TICK_COUNTER_HANDLE)0x12
 static const MQTTCODEC_HANDLE TEST_MQTTCODEC_HANDLE = (MQTTCODEC_HANDLE)0x13;
 static const MQTT_MESSAGE_HANDLE TEST_MESSAGE_HANDLE = (MQTT_MESSAGE_HANDLE)0x14;
 static BUFFER_HANDLE TEST_BUFFER_HANDLE = (BUFFER_HANDLE)0x15;
+static const MQTT_PUBLISH_TEMPLATE_HANDLE TEST_PUBLISH_TEMPLATE_HANDLE = (MQTT_PUBLISH_TEMPLATE_HANDLE)0x16;
 static const uint16_t TEST_KEEP_ALIVE_INTERVAL = 20;
 static const uint16_t TEST_PACKET_ID = (uint16_t)0x1234;
 static const unsigned char* TEST_BUFFER_U_CHAR = (const unsigned char*)0x19;
@@ -156,6 +157,16 @@ extern "C" {
         return 0;
     }
 
+    static int my_xio_send_segments(XIO_HANDLE xio, const BUFFER_SEGMENT* segments, size_t segment_count, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+    {
+        (void)xio;
+        (void)segments;
+        (void)segment_count;
+        g_sendComplete = on_send_complete;
+        g_onSendCtx = callback_context;
+        return 0;
+    }
+
     static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
     {
         (void)tick_counter;
@@ -285,6 +296,9 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(ON_SEND_COMPLETE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MQTT_MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MQTT_PUBLISH_TEMPLATE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const BUFFER_SEGMENT*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_SEGMENT*, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_IO_OPEN_COMPLETE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_BYTES_RECEIVED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_IO_ERROR, void*);
@@ -312,6 +326,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(xio_open, __FAILURE__);
     REGISTER_GLOBAL_MOCK_HOOK(xio_send, my_xio_send);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(xio_send, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_send_segments, my_xio_send_segments);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(xio_send_segments, __FAILURE__);
 
     REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_get_current_ms, __FAILURE__);
@@ -324,6 +340,10 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_RETURN(mqtt_codec_publish, TEST_BUFFER_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mqtt_codec_publish, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(mqtt_codec_publish_template_create, TEST_PUBLISH_TEMPLATE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mqtt_codec_publish_template_create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(mqtt_codec_publish_template_build, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mqtt_codec_publish_template_build, __FAILURE__);
     REGISTER_GLOBAL_MOCK_RETURN(mqtt_codec_subscribe, TEST_BUFFER_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mqtt_codec_subscribe, NULL);
     REGISTER_GLOBAL_MOCK_RETURN(mqtt_codec_unsubscribe, TEST_BUFFER_HANDLE);
@@ -425,7 +445,6 @@ static void setup_publish_callback_mocks(unsigned char* PUBLISH_RESP, size_t len
 {
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_RESP);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_create_in_place(TEST_PACKET_ID, IGNORED_PTR_ARG, qos_value, IGNORED_PTR_ARG, TEST_APP_PAYLOAD.length));
     STRICT_EXPECTED_CALL(mqttmessage_setIsDuplicateMsg(IGNORED_PTR_ARG, true));
     STRICT_EXPECTED_CALL(mqttmessage_setIsRetained(IGNORED_PTR_ARG, true));
@@ -436,7 +455,6 @@ static void setup_publish_callback_mocks(unsigned char* PUBLISH_RESP, size_t len
     EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 }
 
 static void setup_mqtt_clear_options_mocks(MQTT_CLIENT_OPTIONS* mqttOptions)
@@ -1597,6 +1615,167 @@ TEST_FUNCTION(mqtt_client_publish_succeeds)
     mqtt_client_deinit(mqttHandle);
 }
 
+/* Tests_SRS_MQTT_CLIENT_01_001: [ mqtt_client_create_publish_template shall create the template with mqtt_codec_publish_template_create, without the retain flag, and return it. ] */
+TEST_FUNCTION(mqtt_client_create_publish_template_succeeds)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, TEST_TOPIC_NAME));
+
+    // act
+    MQTT_PUBLISH_TEMPLATE_HANDLE result = mqtt_client_create_publish_template(DELIVER_AT_LEAST_ONCE, TEST_TOPIC_NAME);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, TEST_PUBLISH_TEMPLATE_HANDLE, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_002: [ mqtt_client_destroy_publish_template shall destroy the template with mqtt_codec_publish_template_destroy. ] */
+TEST_FUNCTION(mqtt_client_destroy_publish_template_succeeds)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_destroy(TEST_PUBLISH_TEMPLATE_HANDLE));
+
+    // act
+    mqtt_client_destroy_publish_template(TEST_PUBLISH_TEMPLATE_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_003: [ If handle or publishTemplate is NULL, or payload is NULL while payloadLength is not 0, mqtt_client_publish_with_template shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_publish_with_template_handle_NULL_fail)
+{
+    // arrange
+
+    // act
+    int result = mqtt_client_publish_with_template(NULL, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_003: [ If handle or publishTemplate is NULL, or payload is NULL while payloadLength is not 0, mqtt_client_publish_with_template shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_publish_with_template_payload_NULL_fail)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", NULL, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_005: [ If any failure is encountered, mqtt_client_publish_with_template shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_publish_with_template_build_fail)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_build(TEST_PUBLISH_TEMPLATE_HANDLE, false, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.length, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(__FAILURE__);
+
+    // act
+    int result = mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_005: [ If any failure is encountered, mqtt_client_publish_with_template shall return a non-zero value. ] */
+/* Tests_SRS_MQTT_CLIENT_01_029: [ If xio_send_segments fails, the segments before the failing one may already be queued as a truncated packet, so mqtt_client_publish_with_template shall report MQTT_CLIENT_CONNECTION_ERROR to the error callback and close the connection. ] */
+TEST_FUNCTION(mqtt_client_publish_with_template_xio_send_segments_fails)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_build(TEST_PUBLISH_TEMPLATE_HANDLE, false, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.length, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG));
+    EXPECTED_CALL(xio_send_segments(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(__FAILURE__);
+
+    // act
+    int result = mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(g_errorCallbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_004: [ mqtt_client_publish_with_template shall build the PUBLISH header with mqtt_codec_publish_template_build. ] */
+/* Tests_SRS_MQTT_CLIENT_01_006: [ mqtt_client_publish_with_template shall pass the header and the payload to a single xio_send_segments call, which sends them with one write of the transport when they fit in its gather buffer. ] */
+TEST_FUNCTION(mqtt_client_publish_with_template_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_build(TEST_PUBLISH_TEMPLATE_HANDLE, false, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.length, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG));
+    EXPECTED_CALL(xio_send_segments(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    int result = mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_028: [ mqtt_client_republish_with_template shall do the same as mqtt_client_publish_with_template with the DUP flag set in the PUBLISH header. ] */
+TEST_FUNCTION(mqtt_client_republish_with_template_sets_dup_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_build(TEST_PUBLISH_TEMPLATE_HANDLE, true, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.length, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG));
+    EXPECTED_CALL(xio_send_segments(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    int result = mqtt_client_republish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_003: [ If handle or publishTemplate is NULL, or payload is NULL while payloadLength is not 0, mqtt_client_publish_with_template shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_republish_with_template_handle_NULL_fail)
+{
+    // arrange
+
+    // act
+    int result = mqtt_client_republish_with_template(NULL, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 TEST_FUNCTION(mqtt_client_disconnect_handle_NULL_fail)
 {
     // arrange
@@ -2204,8 +2383,9 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_EXACTLY_ONCE_fail)
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-    unsigned char PUBLISH_RESP[] ={ 0x00, 0x0a, 0x74, 0x6f, 0x70, 0x69, 0x63, 0x20, 0x4e, 0x61, 0x6d, 0x65, 0x12, 0x34, \
+    const unsigned char PUBLISH_VALUE[] ={ 0x00, 0x0a, 0x74, 0x6f, 0x70, 0x69, 0x63, 0x20, 0x4e, 0x61, 0x6d, 0x65, 0x12, 0x34, \
         0x4d, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x73, 0x65, 0x6e, 0x64 };
+    unsigned char PUBLISH_RESP[sizeof(PUBLISH_VALUE)];
     size_t length = sizeof(PUBLISH_RESP) / sizeof(PUBLISH_RESP[0]);
 
     uint8_t flag = 0x0d;
@@ -2220,7 +2400,7 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_EXACTLY_ONCE_fail)
     umock_c_negative_tests_snapshot();
 
     // act
-    size_t calls_cannot_fail[] = { 0, 1, 7, 8, 11, 12, 13 };
+    size_t calls_cannot_fail[] = { 0, 1, 6, 7, 10, 11 };
     size_t count = umock_c_negative_tests_call_count();
     for (size_t index = 0; index < count; index++)
     {
@@ -2232,11 +2412,14 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_EXACTLY_ONCE_fail)
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
+        // the topic name is read in place, so every run needs the packet as received
+        (void)memcpy(PUBLISH_RESP, PUBLISH_VALUE, sizeof(PUBLISH_VALUE));
+
         char tmp_msg[64];
         sprintf(tmp_msg, "IoTHubClient_LL_Create failure in test %zu/%zu", index, count);
         g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
 
-        if (index == 2 || index == 3 || index == 4 || index == 5 || index == 6)
+        if (index == 2 || index == 3 || index == 4 || index == 5)
             ASSERT_IS_TRUE(g_errorCallbackInvoked);
     }
 
@@ -2261,7 +2444,6 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_LEAST_ONCE_succeeds)
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_RESP);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_create_in_place(TEST_PACKET_ID, IGNORED_PTR_ARG, DELIVER_AT_LEAST_ONCE, IGNORED_PTR_ARG, TEST_APP_PAYLOAD.length));
     STRICT_EXPECTED_CALL(mqttmessage_setIsDuplicateMsg(IGNORED_PTR_ARG, true));
     STRICT_EXPECTED_CALL(mqttmessage_setIsRetained(IGNORED_PTR_ARG, false));
@@ -2272,7 +2454,6 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_LEAST_ONCE_succeeds)
     EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
@@ -2301,7 +2482,6 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_LEAST_ONCE_no_body_suc
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_RESP);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_create_in_place(TEST_PACKET_ID, IGNORED_PTR_ARG, DELIVER_AT_LEAST_ONCE, IGNORED_PTR_ARG, 0));
     STRICT_EXPECTED_CALL(mqttmessage_setIsDuplicateMsg(IGNORED_PTR_ARG, true));
     STRICT_EXPECTED_CALL(mqttmessage_setIsRetained(IGNORED_PTR_ARG, false));
@@ -2312,7 +2492,6 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_LEAST_ONCE_no_body_suc
     EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
@@ -2341,12 +2520,10 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_MOST_ONCE_succeeds)
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_VALUE);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_create_in_place(0, IGNORED_PTR_ARG, DELIVER_AT_MOST_ONCE, IGNORED_PTR_ARG, 22));
     STRICT_EXPECTED_CALL(mqttmessage_setIsDuplicateMsg(IGNORED_PTR_ARG, false));
     STRICT_EXPECTED_CALL(mqttmessage_setIsRetained(IGNORED_PTR_ARG, false));
     STRICT_EXPECTED_CALL(mqttmessage_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
@@ -2375,12 +2552,10 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_MOST_ONCE_with_two_zer
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_VALUE);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_create_in_place(0, IGNORED_PTR_ARG, DELIVER_AT_MOST_ONCE, IGNORED_PTR_ARG, 2));
     STRICT_EXPECTED_CALL(mqttmessage_setIsDuplicateMsg(IGNORED_PTR_ARG, false));
     STRICT_EXPECTED_CALL(mqttmessage_setIsRetained(IGNORED_PTR_ARG, false));
     STRICT_EXPECTED_CALL(mqttmessage_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
@@ -2408,12 +2583,10 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_AT_MOST_ONCE_no_body_succ
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_VALUE);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mqttmessage_create_in_place(0, IGNORED_PTR_ARG, DELIVER_AT_MOST_ONCE, IGNORED_PTR_ARG, 0));
     STRICT_EXPECTED_CALL(mqttmessage_setIsDuplicateMsg(IGNORED_PTR_ARG, false));
     STRICT_EXPECTED_CALL(mqttmessage_setIsRetained(IGNORED_PTR_ARG, false));
     STRICT_EXPECTED_CALL(mqttmessage_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
@@ -2708,8 +2881,6 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_too_short_packetID_fails)
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_RESP);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
 
     // act
@@ -2738,8 +2909,6 @@ TEST_FUNCTION(mqtt_client_recvCompleteCallback_PUBLISH_packetId_is_zero_fails)
     BUFFER_HANDLE publish_handle = TEST_BUFFER_HANDLE;
     STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
     STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(PUBLISH_RESP);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_packetComplete(mqttHandle, PUBLISH_TYPE, flag, publish_handle);
@@ -2880,6 +3049,625 @@ TEST_FUNCTION(mqtt_client_set_trace_traceOn_NULL_fail)
     // cleanup
 }
 
+/* Tests_SRS_MQTT_CLIENT_01_007: [ If handle, bytesSent or bytesReceived is NULL, mqtt_client_get_traffic shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_get_traffic_handle_NULL_fail)
+{
+    // arrange
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+
+    // act
+    int result = mqtt_client_get_traffic(NULL, &bytesSent, &bytesReceived);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_007: [ If handle, bytesSent or bytesReceived is NULL, mqtt_client_get_traffic shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_get_traffic_bytesReceived_NULL_fail)
+{
+    // arrange
+    uint64_t bytesSent;
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = mqtt_client_get_traffic(mqttHandle, &bytesSent, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_008: [ mqtt_client_get_traffic shall return in bytesSent the number of bytes handed to the IO with xio_send or xio_send_segments, and in bytesReceived the number of bytes received from the IO, since mqtt_client_init. ] */
+TEST_FUNCTION(mqtt_client_get_traffic_counts_received_bytes_succeeds)
+{
+    // arrange
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    MQTT_CLIENT_OPTIONS mqttOptions = { 0 };
+    SetupMqttLibOptions(&mqttOptions, TEST_CLIENT_ID, TEST_WILL_MSG, TEST_WILL_TOPIC, TEST_USERNAME, TEST_PASSWORD, TEST_KEEP_ALIVE_INTERVAL, false, true, DELIVER_AT_MOST_ONCE);
+    (void)mqtt_client_connect(mqttHandle, TEST_IO_HANDLE, &mqttOptions);
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = mqtt_client_get_traffic(mqttHandle, &bytesSent, &bytesReceived);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(bytesReceived == 2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+static MQTT_CLIENT_HANDLE create_connected_client(uint16_t keepAliveInterval)
+{
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+
+    MQTT_CLIENT_OPTIONS mqttOptions = { 0 };
+    SetupMqttLibOptions(&mqttOptions, TEST_CLIENT_ID, NULL, NULL, TEST_USERNAME, TEST_PASSWORD, keepAliveInterval, false, true, DELIVER_AT_MOST_ONCE);
+
+    unsigned char CONNACK_RESP[] = { 0x1, 0x0 };
+    size_t length = sizeof(CONNACK_RESP) / sizeof(CONNACK_RESP[0]);
+    BUFFER_HANDLE connack_handle = TEST_BUFFER_HANDLE;
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(CONNACK_RESP);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
+
+    (void)mqtt_client_connect(mqttHandle, TEST_IO_HANDLE, &mqttOptions);
+    g_openComplete(g_onCompleteCtx, IO_OPEN_OK);
+    g_packetComplete(mqttHandle, CONNACK_TYPE, 0, connack_handle);
+    umock_c_reset_all_calls();
+
+    return mqttHandle;
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_029: [ If xio_send_segments fails, the segments before the failing one may already be queued as a truncated packet, so mqtt_client_publish_with_template shall report MQTT_CLIENT_CONNECTION_ERROR to the error callback and close the connection. ] */
+TEST_FUNCTION(mqtt_client_publish_with_template_xio_send_segments_fails_on_a_connected_client_closes_the_connection)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_connected_client(TEST_KEEP_ALIVE_INTERVAL);
+
+    STRICT_EXPECTED_CALL(mqtt_codec_publish_template_build(TEST_PUBLISH_TEMPLATE_HANDLE, false, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.length, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG));
+    EXPECTED_CALL(xio_send_segments(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(__FAILURE__);
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    for (size_t index = 0; index < MAX_CLOSE_RETRIES; index++)
+    {
+        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(CLOSE_SLEEP_VALUE));
+    }
+
+    // act
+    int result = mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(g_errorCallbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_009: [ If handle or msToNextWork is NULL, mqtt_client_get_next_work_time shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_get_next_work_time_handle_NULL_fail)
+{
+    // arrange
+    tickcounter_ms_t msToNextWork = 100000;
+
+    // act
+    int result = mqtt_client_get_next_work_time(NULL, &msToNextWork);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_010: [ If the client is not connected or keepAliveInterval is 0, mqtt_client_get_next_work_time shall leave msToNextWork unchanged and return 0. ] */
+TEST_FUNCTION(mqtt_client_get_next_work_time_not_connected_succeeds)
+{
+    // arrange
+    tickcounter_ms_t msToNextWork = 100000;
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = mqtt_client_get_next_work_time(mqttHandle, &msToNextWork);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(msToNextWork == 100000);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_011: [ If tickcounter_get_current_ms fails, mqtt_client_get_next_work_time shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_get_next_work_time_tickcounter_fails)
+{
+    // arrange
+    tickcounter_ms_t msToNextWork = 100000;
+    MQTT_CLIENT_HANDLE mqttHandle = create_connected_client(TEST_KEEP_ALIVE_INTERVAL);
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG)).IgnoreArgument(2).SetReturn(__FAILURE__);
+
+    // act
+    int result = mqtt_client_get_next_work_time(mqttHandle, &msToNextWork);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_012: [ mqtt_client_get_next_work_time shall lower msToNextWork to the milliseconds left until keepAliveInterval seconds have passed since the last packet was sent. ] */
+/* Tests_SRS_MQTT_CLIENT_01_014: [ On success mqtt_client_get_next_work_time shall return 0. ] */
+TEST_FUNCTION(mqtt_client_get_next_work_time_keep_alive_succeeds)
+{
+    // arrange
+    tickcounter_ms_t msToNextWork = 100000;
+    tickcounter_ms_t msShorter = 1000;
+    MQTT_CLIENT_HANDLE mqttHandle = create_connected_client(TEST_KEEP_ALIVE_INTERVAL);
+
+    g_current_ms = 5000;
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG)).IgnoreArgument(2);
+
+    // act
+    int result = mqtt_client_get_next_work_time(mqttHandle, &msToNextWork);
+    int result_shorter = mqtt_client_get_next_work_time(mqttHandle, &msShorter);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, result_shorter);
+    ASSERT_IS_TRUE(msToNextWork == (TEST_KEEP_ALIVE_INTERVAL * 1000 - 5000));
+    ASSERT_IS_TRUE(msShorter == 1000);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_013: [ If a PINGRESP is pending, mqtt_client_get_next_work_time shall also lower msToNextWork to the milliseconds left until more than maxPingRespTime seconds have passed since the PINGREQ was sent. ] */
+TEST_FUNCTION(mqtt_client_get_next_work_time_ping_pending_succeeds)
+{
+    // arrange
+    tickcounter_ms_t msToNextWork = 100000;
+    MQTT_CLIENT_HANDLE mqttHandle = create_connected_client(TEST_KEEP_ALIVE_INTERVAL);
+
+    // sends the PINGREQ
+    g_current_ms = TEST_KEEP_ALIVE_INTERVAL * 2 * 1000;
+    mqtt_client_dowork(mqttHandle);
+
+    g_current_ms += 5000;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG)).IgnoreArgument(2);
+
+    // act
+    int result = mqtt_client_get_next_work_time(mqttHandle, &msToNextWork);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    // maxPingRespTime is half the keep alive interval; the PINGRESP is overdue once more than that many seconds passed
+    ASSERT_IS_TRUE(msToNextWork == ((TEST_KEEP_ALIVE_INTERVAL / 2 + 1) * 1000 - 5000));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+static const uint16_t TEST_IDLE_KEEP_ALIVE_INTERVAL = 1000;
+static const MQTT_CLIENT_IDLE_OPTIONS TEST_IDLE_OPTIONS = { 60, 60, 5000 };
+
+static MQTT_CLIENT_HANDLE create_idle_client(void)
+{
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    (void)mqtt_client_set_idle_options(mqttHandle, &TEST_IDLE_OPTIONS);
+
+    MQTT_CLIENT_OPTIONS mqttOptions = { 0 };
+    SetupMqttLibOptions(&mqttOptions, TEST_CLIENT_ID, NULL, NULL, TEST_USERNAME, TEST_PASSWORD, TEST_IDLE_KEEP_ALIVE_INTERVAL, false, true, DELIVER_AT_MOST_ONCE);
+
+    unsigned char CONNACK_RESP[] = { 0x1, 0x0 };
+    size_t length = sizeof(CONNACK_RESP) / sizeof(CONNACK_RESP[0]);
+    BUFFER_HANDLE connack_handle = TEST_BUFFER_HANDLE;
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE)).SetReturn(CONNACK_RESP);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE)).SetReturn(length);
+
+    // CONNECT at 0 s, CONNACK at 1 s
+    (void)mqtt_client_connect(mqttHandle, TEST_IO_HANDLE, &mqttOptions);
+    g_openComplete(g_onCompleteCtx, IO_OPEN_OK);
+    g_current_ms = 1000;
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+    g_packetComplete(mqttHandle, CONNACK_TYPE, 0, connack_handle);
+    umock_c_reset_all_calls();
+
+    return mqttHandle;
+}
+
+static void receive_ping_response(MQTT_CLIENT_HANDLE mqttHandle)
+{
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+    g_packetComplete(mqttHandle, PINGRESP_TYPE, 0, NULL);
+}
+
+static MQTT_CLIENT_RADIO_STATISTICS get_radio_statistics(MQTT_CLIENT_HANDLE mqttHandle)
+{
+    MQTT_CLIENT_RADIO_STATISTICS statistics;
+    ASSERT_ARE_EQUAL(int, 0, mqtt_client_get_radio_statistics(mqttHandle, &statistics));
+    return statistics;
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_015: [ If handle is NULL, or idleOptions is not NULL and its minPingIntervalSec is 0, mqtt_client_set_idle_options shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_set_idle_options_handle_NULL_fail)
+{
+    // arrange
+
+    // act
+    int result = mqtt_client_set_idle_options(NULL, &TEST_IDLE_OPTIONS);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_015: [ If handle is NULL, or idleOptions is not NULL and its minPingIntervalSec is 0, mqtt_client_set_idle_options shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_set_idle_options_min_ping_interval_0_fail)
+{
+    // arrange
+    MQTT_CLIENT_IDLE_OPTIONS idleOptions = { 0, 60, 5000 };
+    MQTT_CLIENT_HANDLE mqttHandle = mqtt_client_init(TestRecvCallback, TestOpCallback, NULL, TestErrorCallback, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = mqtt_client_set_idle_options(mqttHandle, &idleOptions);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_017: [ mqtt_client_set_idle_options shall turn the idle mode on with a ping interval of minPingIntervalSec that is not settled. ] */
+/* Tests_SRS_MQTT_CLIENT_01_018: [ On success mqtt_client_set_idle_options shall return 0. ] */
+TEST_FUNCTION(mqtt_client_set_idle_options_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_connected_client(TEST_IDLE_KEEP_ALIVE_INTERVAL);
+
+    // act
+    int result = mqtt_client_set_idle_options(mqttHandle, &TEST_IDLE_OPTIONS);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 60, (int)statistics.pingIntervalSec);
+    ASSERT_IS_FALSE(statistics.pingIntervalSettled);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_016: [ If idleOptions is NULL, mqtt_client_set_idle_options shall turn the idle mode off and the client shall ping every keepAliveInterval again. ] */
+TEST_FUNCTION(mqtt_client_set_idle_options_NULL_turns_idle_mode_off_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+
+    // act
+    int result = mqtt_client_set_idle_options(mqttHandle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    g_current_ms = 120 * 1000;
+    mqtt_client_dowork(mqttHandle);
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, (int)TEST_IDLE_KEEP_ALIVE_INTERVAL, (int)statistics.pingIntervalSec);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.pingsSent);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_019: [ In idle mode mqtt_client_dowork shall also send a PINGREQ once the ping interval has passed since the last packet was sent or received. ] */
+TEST_FUNCTION(mqtt_client_dowork_idle_pings_after_ping_interval_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+
+    // act
+    g_current_ms = 60999;
+    mqtt_client_dowork(mqttHandle);
+    uint32_t pingsBefore = get_radio_statistics(mqttHandle).pingsSent;
+    g_current_ms = 61000;
+    mqtt_client_dowork(mqttHandle);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, (int)pingsBefore);
+    ASSERT_ARE_EQUAL(int, 1, (int)get_radio_statistics(mqttHandle).pingsSent);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_020: [ In idle mode a packet sent after at least the ping interval without traffic shall be a probe, unless the interval is settled or has reached keepAliveInterval. ] */
+/* Tests_SRS_MQTT_CLIENT_01_021: [ When bytes are received while a probe is pending, the ping interval shall grow by pingIntervalStepSec, up to keepAliveInterval. ] */
+TEST_FUNCTION(mqtt_client_idle_answered_ping_grows_ping_interval_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+
+    // act
+    g_current_ms = 61000;
+    mqtt_client_dowork(mqttHandle);
+    g_current_ms = 61500;
+    receive_ping_response(mqttHandle);
+
+    // assert
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 120, (int)statistics.pingIntervalSec);
+    ASSERT_IS_FALSE(statistics.pingIntervalSettled);
+
+    // the next PINGREQ is 120 s after the PINGRESP
+    g_current_ms = 181499;
+    mqtt_client_dowork(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 1, (int)get_radio_statistics(mqttHandle).pingsSent);
+    g_current_ms = 181500;
+    mqtt_client_dowork(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 2, (int)get_radio_statistics(mqttHandle).pingsSent);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_020: [ In idle mode a packet sent after at least the ping interval without traffic shall be a probe, unless the interval is settled or has reached keepAliveInterval. ] */
+/* Tests_SRS_MQTT_CLIENT_01_021: [ When bytes are received while a probe is pending, the ping interval shall grow by pingIntervalStepSec, up to keepAliveInterval. ] */
+TEST_FUNCTION(mqtt_client_idle_answered_publish_is_a_probe_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+
+    // act
+    g_current_ms = 90000;
+    (void)mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+    g_current_ms = 91000;
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+
+    // assert
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 120, (int)statistics.pingIntervalSec);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.pingsSent);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_020: [ In idle mode a packet sent after at least the ping interval without traffic shall be a probe, unless the interval is settled or has reached keepAliveInterval. ] */
+TEST_FUNCTION(mqtt_client_idle_publish_before_ping_interval_is_no_probe_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+
+    // act
+    g_current_ms = 30000;
+    (void)mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+    g_current_ms = 31000;
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 60, (int)get_radio_statistics(mqttHandle).pingIntervalSec);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_021: [ When bytes are received while a probe is pending, the ping interval shall grow by pingIntervalStepSec, up to keepAliveInterval. ] */
+TEST_FUNCTION(mqtt_client_idle_ping_interval_stops_at_keep_alive_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+    tickcounter_ms_t lastTrafficMs = 1000;
+    size_t index;
+
+    // act
+    for (index = 0; index < 20; index++)
+    {
+        lastTrafficMs += (tickcounter_ms_t)get_radio_statistics(mqttHandle).pingIntervalSec * 1000;
+        g_current_ms = lastTrafficMs;
+        mqtt_client_dowork(mqttHandle);
+        receive_ping_response(mqttHandle);
+    }
+
+    // assert
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, (int)TEST_IDLE_KEEP_ALIVE_INTERVAL, (int)statistics.pingIntervalSec);
+    ASSERT_ARE_EQUAL(int, 20, (int)statistics.pingsSent);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_022: [ If the connection is lost while a probe is pending, the ping interval shall go back to the last interval that was answered, or to minPingIntervalSec when none was, and stop growing. ] */
+TEST_FUNCTION(mqtt_client_idle_unanswered_probe_settles_ping_interval_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+    g_current_ms = 61000;
+    mqtt_client_dowork(mqttHandle);
+    g_current_ms = 61500;
+    receive_ping_response(mqttHandle);
+    g_current_ms = 181500;
+    mqtt_client_dowork(mqttHandle);
+
+    // act
+    g_current_ms = 181500 + 81 * 1000;
+    mqtt_client_dowork(mqttHandle);
+
+    // assert
+    ASSERT_IS_TRUE(g_errorCallbackInvoked);
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 60, (int)statistics.pingIntervalSec);
+    ASSERT_IS_TRUE(statistics.pingIntervalSettled);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_022: [ If the connection is lost while a probe is pending, the ping interval shall go back to the last interval that was answered, or to minPingIntervalSec when none was, and stop growing. ] */
+TEST_FUNCTION(mqtt_client_idle_io_error_during_probe_settles_ping_interval_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+    g_current_ms = 90000;
+    (void)mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+
+    // act
+    g_ioError(g_ioErrorCtx);
+
+    // assert
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 60, (int)statistics.pingIntervalSec);
+    ASSERT_IS_TRUE(statistics.pingIntervalSettled);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_020: [ In idle mode a packet sent after at least the ping interval without traffic shall be a probe, unless the interval is settled or has reached keepAliveInterval. ] */
+/* Tests_SRS_MQTT_CLIENT_01_023: [ If a PINGREQ is not answered while the ping interval is settled, the ping interval shall start again from minPingIntervalSec. ] */
+TEST_FUNCTION(mqtt_client_idle_settled_ping_interval_failure_learns_again_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+    g_current_ms = 61000;
+    mqtt_client_dowork(mqttHandle);
+    g_current_ms = 61500;
+    receive_ping_response(mqttHandle);
+    g_current_ms = 181500;
+    mqtt_client_dowork(mqttHandle);
+    g_current_ms = 181500 + 81 * 1000;
+    mqtt_client_dowork(mqttHandle);
+
+    // settled at 60 s: a ping after 60 s of silence is no probe anymore
+    g_current_ms = 300000;
+    (void)mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+    g_bytesRecv(g_bytesRecvCtx, TEST_BUFFER_U_CHAR, 1);
+    ASSERT_ARE_EQUAL(int, 60, (int)get_radio_statistics(mqttHandle).pingIntervalSec);
+
+    // act
+    g_ioError(g_ioErrorCtx);
+
+    // assert
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+    ASSERT_ARE_EQUAL(int, 60, (int)statistics.pingIntervalSec);
+    ASSERT_IS_FALSE(statistics.pingIntervalSettled);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_024: [ In idle mode mqtt_client_get_next_work_time shall also lower msToNextWork to the milliseconds left until the ping interval has passed since the last packet was sent or received. ] */
+TEST_FUNCTION(mqtt_client_get_next_work_time_idle_succeeds)
+{
+    // arrange
+    tickcounter_ms_t msToNextWork = 10 * 60 * 1000;
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+    g_current_ms = 5000;
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG)).IgnoreArgument(2);
+
+    // act
+    int result = mqtt_client_get_next_work_time(mqttHandle, &msToNextWork);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    // the CONNACK arrived at 1 s
+    ASSERT_IS_TRUE(msToNextWork == 56000);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_025: [ If handle or statistics is NULL, mqtt_client_get_radio_statistics shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_get_radio_statistics_handle_NULL_fail)
+{
+    // arrange
+    MQTT_CLIENT_RADIO_STATISTICS statistics;
+
+    // act
+    int result = mqtt_client_get_radio_statistics(NULL, &statistics);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_026: [ In idle mode, if tickcounter_get_current_ms fails, mqtt_client_get_radio_statistics shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_client_get_radio_statistics_tickcounter_fails)
+{
+    // arrange
+    MQTT_CLIENT_RADIO_STATISTICS statistics;
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_COUNTER_HANDLE, IGNORED_PTR_ARG)).IgnoreArgument(2).SetReturn(__FAILURE__);
+
+    // act
+    int result = mqtt_client_get_radio_statistics(mqttHandle, &statistics);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
+/* Tests_SRS_MQTT_CLIENT_01_027: [ mqtt_client_get_radio_statistics shall return the radio wake-ups counted in idle mode, the PINGREQs sent, the ping interval in use (keepAliveInterval outside of idle mode), whether it is settled, whether the last traffic in idle mode is at most radioTailMs old, and the counters of mqtt_client_get_traffic. ] */
+TEST_FUNCTION(mqtt_client_get_radio_statistics_counts_radio_wake_ups_succeeds)
+{
+    // arrange
+    MQTT_CLIENT_HANDLE mqttHandle = create_idle_client();
+
+    // PINGREQ and PINGRESP share one wake-up, a publish 3 s later still finds the radio up
+    g_current_ms = 61000;
+    mqtt_client_dowork(mqttHandle);
+    g_current_ms = 61500;
+    receive_ping_response(mqttHandle);
+    g_current_ms = 64500;
+    (void)mqtt_client_publish_with_template(mqttHandle, TEST_PUBLISH_TEMPLATE_HANDLE, TEST_PACKET_ID, "suffix", TEST_APP_PAYLOAD.message, TEST_APP_PAYLOAD.length);
+    g_current_ms = 66000;
+    MQTT_CLIENT_RADIO_STATISTICS awake = get_radio_statistics(mqttHandle);
+    g_current_ms = 69501;
+
+    // act
+    MQTT_CLIENT_RADIO_STATISTICS statistics = get_radio_statistics(mqttHandle);
+
+    // assert
+    // the CONNECT woke the radio once
+    ASSERT_ARE_EQUAL(int, 2, (int)statistics.radioWakeUps);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.pingsSent);
+    ASSERT_IS_TRUE(awake.radioAwake);
+    ASSERT_IS_FALSE(statistics.radioAwake);
+    ASSERT_IS_TRUE(statistics.bytesReceived == 2);
+    ASSERT_IS_TRUE(statistics.bytesSent > 0);
+
+    // cleanup
+    mqtt_client_deinit(mqttHandle);
+}
+
 TEST_FUNCTION(mqtt_client_trace_CONNACK_succeeds)
 {
     // arrange
@@ -24,6 +24,11 @@ extern "C" {
         return malloc(size);
     }
 
+    void* my_gballoc_realloc(void* ptr, size_t size)
+    {
+        return realloc(ptr, size);
+    }
+
     void my_gballoc_free(void* ptr)
     {
         free(ptr);
@@ -154,6 +159,8 @@ extern int real_BUFFER_build(BUFFER_HANDLE handle, const unsigned char* source,
 extern int real_BUFFER_enlarge(BUFFER_HANDLE handle, size_t enlargeSize);
 extern int real_BUFFER_pre_build(BUFFER_HANDLE handle, size_t size);
 extern int real_BUFFER_prepend(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2);
+extern int real_BUFFER_reserve(BUFFER_HANDLE handle, size_t headroom, size_t capacity);
+extern int real_BUFFER_prepend_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size);
 extern void real_BUFFER_delete(BUFFER_HANDLE s);
 extern unsigned char* real_BUFFER_u_char(BUFFER_HANDLE handle);
 extern size_t real_BUFFER_length(BUFFER_HANDLE handle);
@@ -187,6 +194,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
 
     REGISTER_GLOBAL_MOCK_HOOK(STRING_new, my_STRING_new);
@@ -200,6 +209,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_enlarge, real_BUFFER_enlarge);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_pre_build, real_BUFFER_pre_build);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_prepend, real_BUFFER_prepend);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_reserve, real_BUFFER_reserve);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_prepend_build, real_BUFFER_prepend_build);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, real_BUFFER_delete);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_u_char, real_BUFFER_u_char);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_length, real_BUFFER_length);
@@ -255,6 +266,16 @@ static void TestOnCompleteCallback(void* context, CONTROL_PACKET_TYPE packet, in
     }
 }
 
+static void TestOnNoDataCompleteCallback(void* context, CONTROL_PACKET_TYPE packet, int flags, BUFFER_HANDLE headerData)
+{
+    (void)context;
+    (void)flags;
+    if (packet == g_curr_packet_type && headerData == NULL)
+    {
+        g_callbackInvoked = true;
+    }
+}
+
 /* Tests_SRS_MQTT_CODEC_07_002: [On success mqtt_codec_create shall return a MQTTCODEC_HANDLE value.] */
 TEST_FUNCTION(mqtt_codec_create_succeed)
 {
@@ -363,11 +384,7 @@ TEST_FUNCTION(mqtt_codec_connect_second_succeeds)
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -402,11 +419,7 @@ TEST_FUNCTION(mqtt_codec_connect_succeeds)
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -441,11 +454,7 @@ TEST_FUNCTION(mqtt_codec_connect_no_password_succeeds)
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -486,11 +495,7 @@ TEST_FUNCTION(mqtt_codec_connect_Large_Data_succeeds)
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -608,6 +613,7 @@ TEST_FUNCTION(mqtt_codec_publish_construct_BUFFER_enlarge_fail)
 {
     // arrange
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
@@ -620,11 +626,59 @@ TEST_FUNCTION(mqtt_codec_publish_construct_BUFFER_enlarge_fail)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+/* Tests_SRS_MQTT_CODEC_07_006: [If any error is encountered then mqtt_codec_publish shall return NULL.] */
+TEST_FUNCTION(mqtt_codec_publish_BUFFER_reserve_fails)
+{
+    // arrange
+    EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    BUFFER_HANDLE handle = mqtt_codec_publish(DELIVER_AT_LEAST_ONCE, true, false, TEST_PACKET_ID, TEST_TOPIC_NAME, TEST_MESSAGE, TEST_MESSAGE_LEN, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(handle);
+}
+
+/* Tests_SRS_MQTT_CODEC_01_001: [mqtt_codec_publish shall reserve room for the largest fixed header in front of the packet and for the whole variable header and payload behind it, so that the packet is built in a single allocation.] */
+TEST_FUNCTION(mqtt_codec_publish_reserves_header_and_packet_size)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, 5, 2 + 10 + 2 + TEST_MESSAGE_LEN))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 2))
+        .IgnoreArgument(1)
+        .IgnoreArgument(2);
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+
+    // act
+    BUFFER_HANDLE handle = mqtt_codec_publish(DELIVER_AT_LEAST_ONCE, true, false, TEST_PACKET_ID, TEST_TOPIC_NAME, TEST_MESSAGE, TEST_MESSAGE_LEN, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(size_t, 2 + 2 + 10 + 2 + TEST_MESSAGE_LEN, real_BUFFER_length(handle));
+
+    // cleanup
+    real_BUFFER_delete(handle);
+}
+
 /* Tests_SRS_MQTT_CODEC_07_006: [If any error is encountered then mqtt_codec_publish shall return NULL.] */
 TEST_FUNCTION(mqtt_codec_publish_BUFFER_enlarge_fails)
 {
     // arrange
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
@@ -645,6 +699,7 @@ TEST_FUNCTION(mqtt_codec_publish_constructFixedHeader_fails)
 {
     // arrange
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
@@ -654,10 +709,8 @@ TEST_FUNCTION(mqtt_codec_publish_constructFixedHeader_fails)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
 
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
 
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
 
     // act
@@ -675,18 +728,15 @@ TEST_FUNCTION(mqtt_codec_publish_msgBuffer_NULL_succeeds)
     const unsigned char PUBLISH_VALUE[] = { 0x38, 0x0c, 0x00, 0x0a, 0x74, 0x6f, 0x70, 0x69, 0x63, 0x20, 0x4e, 0x61, 0x6d, 0x65 };
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
 
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -712,6 +762,7 @@ TEST_FUNCTION(mqtt_codec_publish_succeeds)
         0x73, 0x73, 0x61, 0x67, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x73, 0x65, 0x6e, 0x64 };
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
@@ -720,12 +771,8 @@ TEST_FUNCTION(mqtt_codec_publish_succeeds)
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -751,6 +798,7 @@ TEST_FUNCTION(mqtt_codec_publish_trace_succeeds)
         0x73, 0x73, 0x61, 0x67, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x73, 0x65, 0x6e, 0x64 };
 
     STRICT_EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
@@ -759,11 +807,7 @@ TEST_FUNCTION(mqtt_codec_publish_trace_succeeds)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(STRING_copy(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
@@ -790,6 +834,7 @@ TEST_FUNCTION(mqtt_codec_publish_second_succeeds)
     const unsigned char PUBLISH_VALUE[] = { 0x30, 0x1c, 0x00, 0x04, 0x6d, 0x73, 0x67, 0x41, 0x54, 0x68, 0x69, 0x73, 0x20, 0x69, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x70, 0x70, 0x20, 0x6d, 0x73, 0x67, 0x20, 0x41, 0x2e };
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
@@ -798,12 +843,8 @@ TEST_FUNCTION(mqtt_codec_publish_second_succeeds)
     EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -821,6 +862,182 @@ TEST_FUNCTION(mqtt_codec_publish_second_succeeds)
     real_BUFFER_delete(handle);
 }
 
+/* Tests_SRS_MQTT_CODEC_01_006: [ If topicPrefix is NULL or longer than 65535 bytes, mqtt_codec_publish_template_create shall return NULL. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_create_topicPrefix_NULL_fail)
+{
+    // arrange
+
+    // act
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, NULL);
+
+    // assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CODEC_01_007: [ If any error is encountered, mqtt_codec_publish_template_create shall return NULL. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_create_packet_malloc_fail)
+{
+    // arrange
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, "topic ");
+
+    // assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CODEC_01_008: [ mqtt_codec_publish_template_create shall allocate room for the largest fixed header, the topic length, topicPrefix and a packet id, and copy topicPrefix in place. ] */
+/* Tests_SRS_MQTT_CODEC_01_009: [ If publishTemplate is NULL, mqtt_codec_publish_template_destroy shall do nothing, otherwise it shall free all resources used by publishTemplate. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_create_succeeds)
+{
+    // arrange
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(5 + 2 + 6 + 2));
+
+    // act
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, "topic ");
+
+    // assert
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    umock_c_reset_all_calls();
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    mqtt_codec_publish_template_destroy(handle);
+    mqtt_codec_publish_template_destroy(NULL);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CODEC_01_010: [ If publishTemplate or header is NULL, mqtt_codec_publish_template_build shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_build_publishTemplate_NULL_fail)
+{
+    // arrange
+    BUFFER_SEGMENT header;
+
+    // act
+    int result = mqtt_codec_publish_template_build(NULL, false, TEST_PACKET_ID, "Name", TEST_MESSAGE_LEN, &header, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_MQTT_CODEC_01_014: [ mqtt_codec_publish_template_build shall write the topic length, topicSuffix after the topic prefix, the packet id when the QOS is not DELIVER_AT_MOST_ONCE, and the fixed header right in front of them. ] */
+/* Tests_SRS_MQTT_CODEC_01_015: [ On success header shall point at the PUBLISH packet up to the payload, which stays valid until the next call for publishTemplate, and mqtt_codec_publish_template_build shall return 0. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_build_succeeds)
+{
+    // arrange
+    /* same packet as mqtt_codec_publish_succeeds, up to the payload */
+    const unsigned char PUBLISH_HEADER_VALUE[] = { 0x3a, 0x1d, 0x00, 0x0a, 0x74, 0x6f, 0x70, 0x69, 0x63, 0x20, 0x4e, 0x61, 0x6d, 0x65, 0x12, 0x34 };
+    BUFFER_SEGMENT header;
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, "topic ");
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    int result = mqtt_codec_publish_template_build(handle, true, TEST_PACKET_ID, "Name", TEST_MESSAGE_LEN, &header, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(PUBLISH_HEADER_VALUE), header.size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(header.data, PUBLISH_HEADER_VALUE, header.size));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_publish_template_destroy(handle);
+}
+
+/* Tests_SRS_MQTT_CODEC_01_014: [ mqtt_codec_publish_template_build shall write the topic length, topicSuffix after the topic prefix, the packet id when the QOS is not DELIVER_AT_MOST_ONCE, and the fixed header right in front of them. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_build_at_most_once_succeeds)
+{
+    // arrange
+    /* same packet as mqtt_codec_publish_second_succeeds, up to the payload */
+    const unsigned char PUBLISH_HEADER_VALUE[] = { 0x30, 0x1c, 0x00, 0x04, 0x6d, 0x73, 0x67, 0x41 };
+    BUFFER_SEGMENT header;
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_MOST_ONCE, false, "ms");
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(STRING_copy(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    int result = mqtt_codec_publish_template_build(handle, false, 12, "gA", APP_NAME_A_LEN, &header, TEST_TRACE_STRING_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(PUBLISH_HEADER_VALUE), header.size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(header.data, PUBLISH_HEADER_VALUE, header.size));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_publish_template_destroy(handle);
+}
+
+/* Tests_SRS_MQTT_CODEC_01_012: [ The template shall grow when topicSuffix does not fit, and keep its size afterwards. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_build_grows_once)
+{
+    // arrange
+    char topicSuffix[301];
+    BUFFER_SEGMENT header;
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, "a");
+    (void)memset(topicSuffix, 'b', sizeof(topicSuffix) - 1);
+    topicSuffix[sizeof(topicSuffix) - 1] = '\0';
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    int result = mqtt_codec_publish_template_build(handle, false, TEST_PACKET_ID, topicSuffix, 0, &header, NULL);
+    int second_result = mqtt_codec_publish_template_build(handle, false, TEST_PACKET_ID, topicSuffix + 1, 0, &header, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, second_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    /* remaining length 2 + 300 + 2 = 304, encoded on 2 bytes */
+    ASSERT_ARE_EQUAL(size_t, 3 + 304, header.size);
+    ASSERT_ARE_EQUAL(int, 0x32, header.data[0]);
+    ASSERT_ARE_EQUAL(int, 0xb0, header.data[1]);
+    ASSERT_ARE_EQUAL(int, 0x02, header.data[2]);
+    ASSERT_ARE_EQUAL(int, 0x01, header.data[3]);
+    ASSERT_ARE_EQUAL(int, 0x2c, header.data[4]);
+    ASSERT_ARE_EQUAL(int, 'a', header.data[5]);
+
+    // cleanup
+    mqtt_codec_publish_template_destroy(handle);
+}
+
+/* Tests_SRS_MQTT_CODEC_01_013: [ If any error is encountered, mqtt_codec_publish_template_build shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_codec_publish_template_build_realloc_fail)
+{
+    // arrange
+    char topicSuffix[301];
+    BUFFER_SEGMENT header;
+    MQTT_PUBLISH_TEMPLATE_HANDLE handle = mqtt_codec_publish_template_create(DELIVER_AT_LEAST_ONCE, false, "a");
+    (void)memset(topicSuffix, 'b', sizeof(topicSuffix) - 1);
+    topicSuffix[sizeof(topicSuffix) - 1] = '\0';
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(NULL);
+
+    // act
+    int result = mqtt_codec_publish_template_build(handle, false, TEST_PACKET_ID, topicSuffix, 0, &header, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_publish_template_destroy(handle);
+}
+
 /* Tests_SRS_MQTT_CODEC_07_013: [On success mqtt_codec_publishAck shall return a BUFFER_HANDLE representation of a MQTT PUBACK packet.] */
 TEST_FUNCTION(mqtt_codec_publish_ack_pre_build_fail)
 {
@@ -1077,10 +1294,8 @@ TEST_FUNCTION(mqtt_codec_subscribe_constructFixedHeader_fails)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
 
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
 
     // act
@@ -1109,11 +1324,7 @@ TEST_FUNCTION(mqtt_codec_subscribe_succeeds)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -1149,11 +1360,7 @@ TEST_FUNCTION(mqtt_codec_subscribe_trace_succeeds)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
@@ -1236,9 +1443,7 @@ TEST_FUNCTION(mqtt_codec_unsubscribe_constructFixedHeader_fails)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
 
     // act
@@ -1266,11 +1471,7 @@ TEST_FUNCTION(mqtt_codec_unsubscribe_succeeds)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
 
     // act
@@ -1305,11 +1506,7 @@ TEST_FUNCTION(mqtt_codec_unsubscribe_trace_succeeds)
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
     EXPECTED_CALL(STRING_copy(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
@@ -1398,7 +1595,8 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_buffer_BUFFER_pre_build_fails)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG).SetReturn(__FAILURE__));
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
 
     // act
     result = mqtt_codec_bytesReceived(handle, UNSUBACK_RESP, length);
@@ -1458,12 +1656,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_connack_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     g_curr_packet_type = CONNACK_TYPE;
 
@@ -1497,12 +1693,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_connack_auth_reject_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     g_curr_packet_type = CONNACK_TYPE;
 
@@ -1540,13 +1734,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_2_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (size_t index = 0; index < testData.Length; index++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
 
     // act
@@ -1579,12 +1770,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_puback_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     g_curr_packet_type = PUBACK_TYPE;
 
@@ -1616,7 +1805,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_pingresp_succeed)
     MQTTCODEC_HANDLE handle = mqtt_codec_create(TestOnCompleteCallback, &testData);
 
     umock_c_reset_all_calls();
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
 
     g_curr_packet_type = PINGRESP_TYPE;
 
@@ -1638,7 +1826,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_pingresp_succeed)
 TEST_FUNCTION(mqtt_codec_bytesReceived_publish_long_message_succeed)
 {
     // arrange
-    size_t i;
     g_curr_packet_type = PUBLISH_TYPE;
 
     unsigned char PUBLISH[] = {
@@ -1667,13 +1854,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_long_message_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (i = 0; i < testData.Length; i++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     for (size_t index = 0; index < length; index++)
@@ -1695,7 +1879,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_long_message_succeed)
 TEST_FUNCTION(mqtt_codec_bytesReceived_publish_succeed)
 {
     // arrange
-    size_t i;
     g_curr_packet_type = PUBLISH_TYPE;
 
     //                            1    2     3     4     T     o     p     i     c     10    11    d     a     t     a     sp    M     s     g
@@ -1710,13 +1893,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (i = 0; i < testData.Length; i++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     for (size_t index = 0; index < length; index++)
@@ -1738,7 +1918,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_succeed)
 TEST_FUNCTION(mqtt_codec_bytesReceived_publish_full_succeed)
 {
     // arrange
-    size_t i;
     g_curr_packet_type = PUBLISH_TYPE;
 
     //                            1    2     3     4     T     o     p     i     c     10    11    d     a     t     a     sp    M     s     g
@@ -1754,13 +1933,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_full_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (i = 0; i < testData.Length; i++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     mqtt_codec_bytesReceived(handle, PUBLISH, length);
@@ -1778,7 +1954,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_full_succeed)
 TEST_FUNCTION(mqtt_codec_bytesReceived_publish_second_succeed)
 {
     // arrange
-    size_t i;
     g_curr_packet_type = PUBLISH_TYPE;
 
     //                            1    2     3     4     T     o     p     i     c     10    11    d     a     t     a     sp    M     s     g
@@ -1794,13 +1969,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_second_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (i = 0; i < testData.Length; i++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     for (size_t index = 0; index < length; index++)
@@ -1822,7 +1994,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_publish_second_succeed)
 TEST_FUNCTION(mqtt_codec_bytesReceived_suback_succeed)
 {
     // arrange
-    size_t i;
     g_curr_packet_type = SUBACK_TYPE;
 
     unsigned char SUBACK_RESP[] = { 0x90, 0x5, 0x12, 0x34, 0x01, 0x80, 0x02 };
@@ -1836,13 +2007,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_suback_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (i = 0; i < testData.Length; i++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     for (size_t index = 0; index < length; index++)
@@ -1864,7 +2032,6 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_suback_succeed)
 TEST_FUNCTION(mqtt_codec_bytesReceived_unsuback_succeed)
 {
     // arrange
-    size_t i;
     g_curr_packet_type = UNSUBACK_TYPE;
 
     unsigned char UNSUBACK_RESP[] = { 0xB0, 0x5, 0x12, 0x34, 0x01, 0x80, 0x02 };
@@ -1878,13 +2045,10 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_unsuback_succeed)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    for (i = 0; i < testData.Length; i++)
-    {
-        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    }
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     for (size_t index = 0; index < length; index++)
@@ -1901,6 +2065,167 @@ TEST_FUNCTION(mqtt_codec_bytesReceived_unsuback_succeed)
     mqtt_codec_destroy(handle);
 }
 
+/* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_codec_bytesReceived_BUFFER_reserve_fails)
+{
+    // arrange
+    int result;
+    g_curr_packet_type = UNSUBACK_TYPE;
+
+    unsigned char UNSUBACK_RESP[] = { 0xB0, 0x5, 0x12, 0x34, 0x01, 0x80, 0x02 };
+    size_t length = sizeof(UNSUBACK_RESP) / sizeof(UNSUBACK_RESP[0]);
+
+    TEST_COMPLETE_DATA_INSTANCE testData = { 0 };
+    testData.dataHeader = UNSUBACK_RESP + FIXED_HEADER_SIZE;
+    testData.Length = length - FIXED_HEADER_SIZE;
+    MQTTCODEC_HANDLE handle = mqtt_codec_create(TestOnCompleteCallback, &testData);
+
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(__FAILURE__);
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    result = mqtt_codec_bytesReceived(handle, UNSUBACK_RESP, length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_IS_FALSE(g_callbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_destroy(handle);
+}
+
+/* Codes_SRS_MQTT_CODEC_07_035: [ If any error is encountered then the packet state will be marked as error and mqtt_codec_bytesReceived shall return a non-zero value. ] */
+TEST_FUNCTION(mqtt_codec_bytesReceived_remaining_length_too_long_fails)
+{
+    // arrange
+    int result;
+    g_curr_packet_type = PUBLISH_TYPE;
+
+    unsigned char PUBLISH[] = { 0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    size_t length = sizeof(PUBLISH) / sizeof(PUBLISH[0]);
+
+    TEST_COMPLETE_DATA_INSTANCE testData = { 0 };
+    MQTTCODEC_HANDLE handle = mqtt_codec_create(TestOnCompleteCallback, &testData);
+
+    umock_c_reset_all_calls();
+
+    // act
+    result = mqtt_codec_bytesReceived(handle, PUBLISH, length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_IS_FALSE(g_callbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_destroy(handle);
+}
+
+/* Codes_SRS_MQTT_CODEC_01_002: [ mqtt_codec_bytesReceived shall reuse the buffer of the previous packet when it is big enough. ] */
+/* Codes_SRS_MQTT_CODEC_01_005: [ mqtt_codec_bytesReceived shall copy all the bytes of the current packet that are available in buffer at once. ] */
+TEST_FUNCTION(mqtt_codec_bytesReceived_second_packet_reuses_buffer_succeed)
+{
+    // arrange
+    g_curr_packet_type = PUBACK_TYPE;
+
+    unsigned char PUBACK_RESP[] = { 0x40, 0x2, 0x12, 0x34, 0x40, 0x2, 0x12, 0x34 };
+    size_t length = sizeof(PUBACK_RESP) / sizeof(PUBACK_RESP[0]);
+
+    TEST_COMPLETE_DATA_INSTANCE testData = { 0 };
+    testData.dataHeader = PUBACK_RESP + FIXED_HEADER_SIZE;
+    testData.Length = 2;
+
+    MQTTCODEC_HANDLE handle = mqtt_codec_create(TestOnCompleteCallback, &testData);
+    (void)mqtt_codec_bytesReceived(handle, PUBACK_RESP, length / 2);
+    g_callbackInvoked = false;
+
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    int result = mqtt_codec_bytesReceived(handle, PUBACK_RESP + (length / 2), length / 2);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(g_callbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_destroy(handle);
+}
+
+/* Codes_SRS_MQTT_CODEC_01_003: [ The BUFFER_HANDLE given to ON_PACKET_COMPLETE_CALLBACK is owned by the codec and is only valid during the callback; it is NULL for packets without a variable header or payload. ] */
+TEST_FUNCTION(mqtt_codec_bytesReceived_zero_length_packet_succeed)
+{
+    // arrange
+    g_curr_packet_type = UNSUBACK_TYPE;
+
+    unsigned char UNSUBACK_RESP[] = { 0xB0, 0x0 };
+    size_t length = sizeof(UNSUBACK_RESP) / sizeof(UNSUBACK_RESP[0]);
+
+    MQTTCODEC_HANDLE handle = mqtt_codec_create(TestOnNoDataCompleteCallback, NULL);
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = mqtt_codec_bytesReceived(handle, UNSUBACK_RESP, length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(g_callbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_destroy(handle);
+}
+
+/* Codes_SRS_MQTT_CODEC_01_004: [ After a packet bigger than MQTT_CODEC_RETAINED_BUFFER_SIZE bytes is delivered, its buffer shall be freed. ] */
+TEST_FUNCTION(mqtt_codec_bytesReceived_large_packet_frees_buffer_succeed)
+{
+    // arrange
+    size_t index;
+    g_curr_packet_type = PUBLISH_TYPE;
+
+    // remaining length of 2000 bytes: topic "T" followed by the payload
+    unsigned char PUBLISH[3 + 2000] = { 0x30, 0xD0, 0x0F, 0x00, 0x01, 0x54 };
+    for (index = 6; index < sizeof(PUBLISH); index++)
+    {
+        PUBLISH[index] = (unsigned char)index;
+    }
+
+    TEST_COMPLETE_DATA_INSTANCE testData = { 0 };
+    testData.dataHeader = PUBLISH + 3;
+    testData.Length = sizeof(PUBLISH) - 3;
+
+    MQTTCODEC_HANDLE handle = mqtt_codec_create(TestOnCompleteCallback, &testData);
+
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(BUFFER_new());
+    EXPECTED_CALL(BUFFER_reserve(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    int result = mqtt_codec_bytesReceived(handle, PUBLISH, sizeof(PUBLISH));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(g_callbackInvoked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    mqtt_codec_destroy(handle);
+}
+
 /* Tests_SRS_MQTT_CODEC_07_009: [mqtt_codec_connect shall construct a BUFFER_HANDLE that represents a MQTT CONNECT packet.] */
 TEST_FUNCTION(mqtt_codec_connect_trace_succeeds)
 {
@@ -1929,11 +2254,7 @@ TEST_FUNCTION(mqtt_codec_connect_trace_succeeds)
         .IgnoreArgument_s1()
         .IgnoreArgument_s2();
     EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_new());
-    EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_prepend(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_prepend_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
         .IgnoreArgument_s1()
         .IgnoreArgument_s2();
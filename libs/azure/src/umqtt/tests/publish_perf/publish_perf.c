@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Measures telemetry PUBLISH throughput of mqtt_client, once building every packet with mqtt_message and
+   mqtt_codec_publish and once through a publish template. The broker is an in-process stand-in IO that
+   accepts every send at once and counts the bytes, so only the client side cost is measured. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_umqtt_c/mqtt_client.h"
+#include "azure_umqtt_c/mqtt_message.h"
+
+#define PERF_MESSAGES       200000
+#define PERF_TOPIC_PREFIX   "devices/perf-device/messages/events/"
+/* what the IoT Hub transport appends for a message with one user property and content type/encoding */
+#define PERF_TOPIC_SUFFIX   "temperatureAlert=false&%24.ct=application%2Fjson&%24.ce=utf-8"
+#define PERF_PAYLOAD        "{\"deviceId\":\"perf-device\",\"temperature\":21.5,\"humidity\":48.25}"
+
+typedef struct STANDIN_IO_TAG
+{
+    size_t bytes_sent;
+} STANDIN_IO;
+
+static STANDIN_IO standin_io;
+
+static CONCRETE_IO_HANDLE standin_create(void* io_create_parameters)
+{
+    (void)io_create_parameters;
+    return &standin_io;
+}
+
+static void standin_destroy(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+}
+
+static int standin_open(CONCRETE_IO_HANDLE concrete_io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    (void)concrete_io;
+    (void)on_bytes_received;
+    (void)on_bytes_received_context;
+    (void)on_io_error;
+    (void)on_io_error_context;
+    on_io_open_complete(on_io_open_complete_context, IO_OPEN_OK);
+    return 0;
+}
+
+static int standin_close(CONCRETE_IO_HANDLE concrete_io, ON_IO_CLOSE_COMPLETE on_io_close_complete, void* callback_context)
+{
+    (void)concrete_io;
+    if (on_io_close_complete != NULL)
+    {
+        on_io_close_complete(callback_context);
+    }
+    return 0;
+}
+
+static int standin_send(CONCRETE_IO_HANDLE concrete_io, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    STANDIN_IO* io = (STANDIN_IO*)concrete_io;
+    (void)buffer;
+    io->bytes_sent += size;
+    if (on_send_complete != NULL)
+    {
+        on_send_complete(callback_context, IO_SEND_OK);
+    }
+    return 0;
+}
+
+static void standin_dowork(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+}
+
+static int standin_setoption(CONCRETE_IO_HANDLE concrete_io, const char* optionName, const void* value)
+{
+    (void)concrete_io;
+    (void)optionName;
+    (void)value;
+    return 0;
+}
+
+static OPTIONHANDLER_HANDLE standin_retrieveoptions(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+    return NULL;
+}
+
+static const IO_INTERFACE_DESCRIPTION standin_io_interface_description =
+{
+    standin_retrieveoptions,
+    standin_create,
+    standin_destroy,
+    standin_open,
+    standin_close,
+    standin_send,
+    standin_dowork,
+    standin_setoption
+};
+
+static void on_operation_complete(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EVENT_RESULT actionResult, const void* msgInfo, void* callbackCtx)
+{
+    (void)handle;
+    (void)actionResult;
+    (void)msgInfo;
+    (void)callbackCtx;
+}
+
+static void on_error(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EVENT_ERROR error, void* callbackCtx)
+{
+    (void)handle;
+    (void)error;
+    (void)callbackCtx;
+}
+
+static void on_message_received(MQTT_MESSAGE_HANDLE msgHandle, void* callbackCtx)
+{
+    (void)msgHandle;
+    (void)callbackCtx;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, double start, size_t bytes)
+{
+    double elapsed = now_seconds() - start;
+    (void)printf("%-24s %10.0f msgs/s %8.1f ns/msg %8lu bytes/msg\n", name,
+        PERF_MESSAGES / elapsed, elapsed * 1e9 / PERF_MESSAGES, (unsigned long)(bytes / PERF_MESSAGES));
+}
+
+/* the topic is put together per message, the way the transport did before publish templates */
+static int publish_with_message(MQTT_CLIENT_HANDLE mqtt_client, uint16_t packet_id, const uint8_t* payload, size_t payload_length)
+{
+    int result;
+    STRING_HANDLE topic = STRING_construct(PERF_TOPIC_PREFIX);
+    if (topic == NULL)
+    {
+        result = 1;
+    }
+    else
+    {
+        MQTT_MESSAGE_HANDLE message;
+        if (STRING_concat(topic, PERF_TOPIC_SUFFIX) != 0 ||
+            (message = mqttmessage_create_in_place(packet_id, STRING_c_str(topic), DELIVER_AT_LEAST_ONCE, payload, payload_length)) == NULL)
+        {
+            result = 1;
+        }
+        else
+        {
+            result = mqtt_client_publish(mqtt_client, message);
+            mqttmessage_destroy(message);
+        }
+        STRING_delete(topic);
+    }
+    return result;
+}
+
+static int publish_with_template(MQTT_CLIENT_HANDLE mqtt_client, MQTT_PUBLISH_TEMPLATE_HANDLE publish_template, uint16_t packet_id, const uint8_t* payload, size_t payload_length)
+{
+    int result;
+    STRING_HANDLE topic_suffix = STRING_construct(PERF_TOPIC_SUFFIX);
+    if (topic_suffix == NULL)
+    {
+        result = 1;
+    }
+    else
+    {
+        result = mqtt_client_publish_with_template(mqtt_client, publish_template, packet_id, STRING_c_str(topic_suffix), payload, payload_length);
+        STRING_delete(topic_suffix);
+    }
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+    const uint8_t* payload = (const uint8_t*)PERF_PAYLOAD;
+    size_t payload_length = strlen(PERF_PAYLOAD);
+    XIO_HANDLE xio = xio_create(&standin_io_interface_description, NULL);
+    MQTT_CLIENT_HANDLE mqtt_client = mqtt_client_init(on_message_received, on_operation_complete, NULL, on_error, NULL);
+    MQTT_PUBLISH_TEMPLATE_HANDLE publish_template = mqtt_client_create_publish_template(DELIVER_AT_LEAST_ONCE, PERF_TOPIC_PREFIX);
+    MQTT_CLIENT_OPTIONS options;
+
+    (void)memset(&options, 0, sizeof(options));
+    options.clientId = "perf-device";
+    options.keepAliveInterval = 240;
+    options.useCleanSession = true;
+    options.qualityOfServiceValue = DELIVER_AT_LEAST_ONCE;
+
+    if (xio == NULL || mqtt_client == NULL || publish_template == NULL || mqtt_client_connect(mqtt_client, xio, &options) != 0)
+    {
+        (void)printf("failed to set up the client\n");
+        result = 1;
+    }
+    else
+    {
+        size_t i;
+        size_t bytes;
+        double start;
+
+        bytes = standin_io.bytes_sent;
+        start = now_seconds();
+        for (i = 0; i < PERF_MESSAGES && result == 0; i++)
+        {
+            result = publish_with_message(mqtt_client, (uint16_t)(i + 1), payload, payload_length);
+        }
+        report("mqtt_client_publish", start, standin_io.bytes_sent - bytes);
+
+        bytes = standin_io.bytes_sent;
+        start = now_seconds();
+        for (i = 0; i < PERF_MESSAGES && result == 0; i++)
+        {
+            result = publish_with_template(mqtt_client, publish_template, (uint16_t)(i + 1), payload, payload_length);
+        }
+        report("publish_with_template", start, standin_io.bytes_sent - bytes);
+
+        if (result != 0)
+        {
+            (void)printf("publishing failed\n");
+        }
+    }
+
+    mqtt_client_destroy_publish_template(publish_template);
+    mqtt_client_deinit(mqtt_client);
+    xio_destroy(xio);
+    return result;
+}